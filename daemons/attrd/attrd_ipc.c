@@ -571,6 +571,10 @@ attrd_ipc_dispatch(qb_ipcs_connection_t * c, void *data, size_t size)
                            CRM_EX_PROTOCOL);
         return 0;
 
+    } else if (pcmk__ipc_handle_common_request(client, id, flags, xml)) {
+        pcmk__xml_free(xml);
+        return 0;
+
     } else {
         pcmk__request_t request = {
             .ipc_client     = client,
@@ -89,6 +89,7 @@ cib_ipc_closed(qb_ipcs_connection_t * c)
         return 0;
     }
     crm_trace("Connection %p", c);
+    based_free_notify_filters(client);
     pcmk__free_client(client);
     return 0;
 }
@@ -277,7 +278,21 @@ cib_common_callback_worker(uint32_t id, uint32_t flags, xmlNode * op_request,
 
         } else if (pcmk__str_eq(type, PCMK__VALUE_CIB_DIFF_NOTIFY,
                                 pcmk__str_none)) {
-            bit = cib_notify_diff;
+            int rc = pcmk_rc_ok;
+
+            if (on_off) {
+                rc = based_set_notify_filters(cib_client, op_request);
+            } else {
+                based_free_notify_filters(cib_client);
+            }
+
+            if (rc == pcmk_rc_ok) {
+                bit = cib_notify_diff;
+            } else {
+                crm_warn("Ignoring invalid %s registration from client %s: %s",
+                         type, pcmk__client_name(cib_client), pcmk_rc_str(rc));
+                status = CRM_EX_INVALID_PARAM;
+            }
 
         } else {
             status = CRM_EX_INVALID_PARAM;
@@ -327,6 +342,11 @@ cib_common_callback(qb_ipcs_connection_t * c, void *data, size_t size, gboolean
     } else if(cib_client == NULL) {
         crm_trace("Invalid client %p", c);
         return 0;
+
+    } else if (pcmk__ipc_handle_common_request(cib_client, id, flags,
+                                               op_request)) {
+        pcmk__xml_free(op_request);
+        return 0;
     }
 
     if (pcmk_is_set(call_options, cib_sync_call)) {
@@ -362,7 +382,9 @@ cib_common_callback(qb_ipcs_connection_t * c, void *data, size_t size, gboolean
     CRM_LOG_ASSERT(cib_client->user != NULL);
     pcmk__update_acl_user(op_request, PCMK__XA_CIB_USER, cib_client->user);
 
+    based_stats_begin(cib_client, size);
     cib_common_callback_worker(id, flags, op_request, cib_client, privileged);
+    based_stats_end(cib_client, op_request);
     pcmk__xml_free(op_request);
 
     return 0;
@@ -477,6 +499,11 @@ process_ping_reply(xmlNode *reply)
                 crm_trace("End of differences");
             }
 
+            if (pcmk__xe_attr_is_true(pong, PCMK__XA_CIB_DELTA_SYNC)) {
+                // Peer can accept only the patchsets it's missing
+                based_add_delta_sync_version(reply, remote_cib);
+            }
+
             pcmk__xml_free(remote_cib);
             sync_our_cib(reply, FALSE);
         }
@@ -1144,6 +1171,14 @@ cib_process_command(xmlNode *request, const cib__operation_t *operation,
             }
         }
 
+        if (rc != pcmk_ok) {
+            // Activation failed, so history no longer leads to the_cib
+            based_record_patchset(NULL);
+
+        } else if (*cib_diff != NULL) {
+            based_record_patchset(*cib_diff);
+        }
+
         if ((rc == pcmk_ok) && contains_config_change(*cib_diff)) {
             cib_read_config(config_hash, result_cib);
         }
@@ -1228,7 +1263,9 @@ cib_peer_callback(xmlNode * msg, void *private_data)
     }
 
     /* crm_log_xml_trace(msg, "Peer[inbound]"); */
+    based_stats_begin(NULL, 0);
     cib_process_request(msg, TRUE, NULL);
+    based_stats_end(NULL, msg);
     return;
 
   bail:
@@ -1372,6 +1409,8 @@ terminate_cib(const char *caller, int fast)
     }
 
     uninitializeCib();
+    based_free_patchset_history();
+    based_stats_free();
 
     if (fast > 0) {
         /* Quit fast on error */
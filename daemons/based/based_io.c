@@ -339,6 +339,13 @@ activateCibXml(xmlNode * new_cib, gboolean to_disk, const char *op)
         xmlNode *saved_cib = the_cib;
 
         pcmk__assert(new_cib != saved_cib);
+
+        /* Index elements by ID, so that requests addressing a single element
+         * don't need to search the whole CIB. This only marks the CIB (which
+         * is usually already marked, as a copy of a marked CIB); the index is
+         * built on the first lookup by ID and then updated incrementally.
+         */
+        pcmk__xml_doc_index_ids(new_cib->doc);
         the_cib = new_cib;
         pcmk__xml_free(saved_cib);
         if (cib_writes_enabled && cib_status == pcmk_ok && to_disk) {
@@ -35,10 +35,23 @@
 /* Maximum number of diffs to ignore while waiting for a resync */
 #define MAX_DIFF_RETRY 5
 
+/* Maximum number of recently committed patchsets to keep for bringing peers
+ * that are only slightly behind up to date without sending the entire CIB
+ */
+#define MAX_SYNC_HISTORY 100
+
 bool based_is_primary = false;
 
 xmlNode *the_cib = NULL;
 
+// Recently committed patchsets, for partial resyncs
+static cib__patchset_ring_t *sync_history = NULL;
+
+/* Set when a partial resync from a peer fails, so we ask for the entire CIB
+ * next time, and cleared when we receive it
+ */
+static bool delta_sync_failed = false;
+
 int
 cib_process_shutdown_req(const char *op, int options, const char *section, xmlNode * req,
                          xmlNode * input, xmlNode * existing_cib, xmlNode ** result_cib,
@@ -114,6 +127,145 @@ cib_process_readwrite(const char *op, int options, const char *section, xmlNode
  */
 static int sync_in_progress = 0;
 
+/*!
+ * \internal
+ * \brief Record a committed patchset for partial resyncs of peers
+ *
+ * \param[in] patchset  Patchset for a change just made to the CIB (or \c NULL
+ *                      if the CIB changed in a way not described by a
+ *                      patchset)
+ */
+void
+based_record_patchset(const xmlNode *patchset)
+{
+    if (sync_history == NULL) {
+        sync_history = cib__patchset_ring_new(MAX_SYNC_HISTORY);
+    }
+    cib__patchset_ring_add(sync_history, patchset);
+}
+
+//! Free all recorded patchsets
+void
+based_free_patchset_history(void)
+{
+    cib__patchset_ring_free(sync_history);
+    sync_history = NULL;
+}
+
+/*!
+ * \internal
+ * \brief Add a CIB version to a message so a peer can send only what's missing
+ *
+ * \param[in,out] msg  Sync request (or ping reply) to add version to
+ * \param[in]     cib  CIB whose version should be added
+ */
+void
+based_add_delta_sync_version(xmlNode *msg, const xmlNode *cib)
+{
+    static const char *fields[] = {
+        PCMK_XA_ADMIN_EPOCH,
+        PCMK_XA_EPOCH,
+        PCMK_XA_NUM_UPDATES,
+    };
+
+    if (cib == NULL) {
+        return;
+    }
+    for (int lpc = 0; lpc < PCMK__NELEM(fields); lpc++) {
+        const char *value = crm_element_value(cib, fields[lpc]);
+
+        if (value == NULL) {
+            return;
+        }
+        crm_xml_add(msg, fields[lpc], value);
+    }
+    pcmk__xe_set_bool_attr(msg, PCMK__XA_CIB_DELTA_SYNC, true);
+}
+
+/*!
+ * \internal
+ * \brief Add the patchsets a peer is missing to a sync, if possible
+ *
+ * \param[in]     request  Sync request from peer
+ * \param[in,out] wrapper  Call data of replace request to add patchsets to
+ *
+ * \return true if patchsets were added, otherwise false (in which case the
+ *         entire CIB must be sent)
+ */
+static bool
+add_delta_sync_chain(const xmlNode *request, xmlNode *wrapper)
+{
+    int peer_version[] = { 0, 0, 0 };
+    int our_version[] = { 0, 0, 0 };
+    const char *host = crm_element_value(request, PCMK__XA_SRC);
+
+    if (!pcmk__xe_attr_is_true(request, PCMK__XA_CIB_DELTA_SYNC)
+        || (crm_element_value_int(request, PCMK_XA_ADMIN_EPOCH,
+                                  &peer_version[0]) != 0)
+        || (crm_element_value_int(request, PCMK_XA_EPOCH,
+                                  &peer_version[1]) != 0)
+        || (crm_element_value_int(request, PCMK_XA_NUM_UPDATES,
+                                  &peer_version[2]) != 0)) {
+        return false;
+    }
+
+    cib_version_details(the_cib, &our_version[0], &our_version[1],
+                        &our_version[2]);
+
+    if (cib__patchset_ring_chain(sync_history, peer_version, our_version,
+                                 wrapper) != pcmk_rc_ok) {
+        crm_debug("Sending entire CIB to %s: no patchset history from "
+                  "%d.%d.%d to %d.%d.%d", host,
+                  peer_version[0], peer_version[1], peer_version[2],
+                  our_version[0], our_version[1], our_version[2]);
+        return false;
+    }
+
+    crm_info("Sending %s the patchsets from %d.%d.%d to %d.%d.%d instead "
+             "of the entire CIB", host,
+             peer_version[0], peer_version[1], peer_version[2],
+             our_version[0], our_version[1], our_version[2]);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Apply a partial resync from a peer
+ *
+ * \param[in]     req           Replace request from peer
+ * \param[in]     input         Patchsets from \p req
+ * \param[in]     existing_cib  Current CIB
+ * \param[in,out] result_cib    Where to store resulting CIB
+ *
+ * \return Legacy Pacemaker return code
+ * \note On failure, this requests a full resync.
+ */
+static int
+apply_delta_sync(const xmlNode *req, const xmlNode *input,
+                 xmlNode *existing_cib, xmlNode **result_cib)
+{
+    const char *peer = crm_element_value(req, PCMK__XA_SRC);
+    const char *digest = crm_element_value(req, PCMK__XA_DIGEST);
+    xmlNode *patched = pcmk__xml_copy(NULL, existing_cib);
+    int rc = cib__apply_patchset_chain(patched, input, digest);
+
+    if (rc != pcmk_rc_ok) {
+        crm_notice("Could not apply partial CIB resync from %s (%s); "
+                   "requesting entire CIB", peer, pcmk_rc_str(rc));
+        pcmk__xml_free(patched);
+        delta_sync_failed = true;
+        send_sync_request(NULL);
+        return pcmk_rc2legacy(rc);
+    }
+
+    if (*result_cib != existing_cib) {
+        pcmk__xml_free(*result_cib);
+    }
+    *result_cib = patched;
+    sync_in_progress = 0;
+    return pcmk_ok;
+}
+
 void
 send_sync_request(const char *host)
 {
@@ -127,6 +279,10 @@ send_sync_request(const char *host)
     crm_xml_add(sync_me, PCMK__XA_CIB_OP, PCMK__CIB_REQUEST_SYNC_TO_ONE);
     crm_xml_add(sync_me, PCMK__XA_CIB_DELEGATED_FROM, OUR_NODENAME);
 
+    if (!delta_sync_failed) {
+        based_add_delta_sync_version(sync_me, the_cib);
+    }
+
     if (host != NULL) {
         peer = pcmk__get_node(0, host, NULL, pcmk__node_search_cluster_member);
     }
@@ -150,6 +306,7 @@ cib_process_ping(const char *op, int options, const char *section, xmlNode * req
     crm_xml_add(*answer, PCMK_XA_CRM_FEATURE_SET, CRM_FEATURE_SET);
     crm_xml_add(*answer, PCMK__XA_DIGEST, digest);
     crm_xml_add(*answer, PCMK__XA_CIB_PING_ID, seq);
+    pcmk__xe_set_bool_attr(*answer, PCMK__XA_CIB_DELTA_SYNC, true);
 
     wrapper = pcmk__xe_create(*answer, PCMK__XE_CIB_CALLDATA);
 
@@ -350,11 +507,19 @@ cib_process_replace_svr(const char *op, int options, const char *section, xmlNod
                         xmlNode * input, xmlNode * existing_cib, xmlNode ** result_cib,
                         xmlNode ** answer)
 {
-    int rc =
-        cib_process_replace(op, options, section, req, input, existing_cib, result_cib, answer);
+    int rc = pcmk_ok;
+
+    if (pcmk__xe_is(input, PCMK__XE_CIB_PATCHSETS)) {
+        *answer = NULL;
+        return apply_delta_sync(req, input, existing_cib, result_cib);
+    }
+
+    rc = cib_process_replace(op, options, section, req, input, existing_cib,
+                             result_cib, answer);
 
     if ((rc == pcmk_ok) && pcmk__xe_is(input, PCMK_XE_CIB)) {
         sync_in_progress = 0;
+        delta_sync_failed = false;
     }
     return rc;
 }
@@ -410,6 +575,7 @@ sync_our_cib(xmlNode * request, gboolean all)
 {
     int result = pcmk_ok;
     char *digest = NULL;
+    uint64_t digest_start = 0;
     const char *host = crm_element_value(request, PCMK__XA_SRC);
     const char *op = crm_element_value(request, PCMK__XA_CIB_OP);
     pcmk__node_status_t *peer = NULL;
@@ -438,11 +604,15 @@ sync_our_cib(xmlNode * request, gboolean all)
     pcmk__xe_set_bool_attr(replace_request, PCMK__XA_CIB_UPDATE, true);
 
     crm_xml_add(replace_request, PCMK_XA_CRM_FEATURE_SET, CRM_FEATURE_SET);
+    digest_start = cib__cost_phase_start();
     digest = pcmk__digest_xml(the_cib, true);
+    cib__cost_phase_end(cib__cost_diff, digest_start);
     crm_xml_add(replace_request, PCMK__XA_DIGEST, digest);
 
     wrapper = pcmk__xe_create(replace_request, PCMK__XE_CIB_CALLDATA);
-    pcmk__xml_copy(wrapper, the_cib);
+    if (all || !add_delta_sync_chain(request, wrapper)) {
+        pcmk__xml_copy(wrapper, the_cib);
+    }
 
     if (!all) {
         peer = pcmk__get_node(0, host, NULL, pcmk__node_search_cluster_member);
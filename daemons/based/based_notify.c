@@ -35,8 +35,137 @@ struct cib_notification_s {
     const xmlNode *msg;
     struct iovec *iov;
     int32_t iov_size;
+
+    // For diff notifications to clients with filters
+    cib__diff_changes_t *changes;   // Parsed patchset (if filterable)
+    GHashTable *filtered;           // Match string -> cib_notification_s
 };
 
+/*!
+ * \internal
+ * \brief Set (or clear) a client's CIB diff notification filters
+ *
+ * \param[in,out] client   Client that requested diff notifications
+ * \param[in]     request  Notification registration request
+ *
+ * \return Standard Pacemaker return code
+ * \note If \p request has no filters, the client receives all changes.
+ */
+int
+based_set_notify_filters(pcmk__client_t *client, const xmlNode *request)
+{
+    GList *filters = NULL;
+    int rc = cib__notify_filters_from_xml(request, &filters);
+
+    if (rc != pcmk_rc_ok) {
+        return rc;
+    }
+
+    based_free_notify_filters(client);
+    client->userdata = filters;
+    if (filters != NULL) {
+        crm_debug("Client %s wants only changes matching %u filter%s",
+                  pcmk__client_name(client), g_list_length(filters),
+                  pcmk__plural_s(g_list_length(filters)));
+    }
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Free a client's CIB diff notification filters
+ *
+ * \param[in,out] client  Client to free filters for
+ */
+void
+based_free_notify_filters(pcmk__client_t *client)
+{
+    g_list_free_full((GList *) client->userdata, cib__notify_filter_free);
+    client->userdata = NULL;
+}
+
+static void
+free_notification(gpointer data)
+{
+    struct cib_notification_s *update = data;
+
+    pcmk__xml_free((xmlNode *) update->msg);
+    pcmk_free_ipc_event(update->iov);
+    free(update);
+}
+
+/*!
+ * \internal
+ * \brief Get the notification to send a client with diff notification filters
+ *
+ * A filtered notification is built only once for all clients whose filters
+ * select the same changes.
+ *
+ * \param[in,out] update  Full notification
+ * \param[in]     client  Client to filter notification for
+ *
+ * \return Notification to send (which may be \p update), or \c NULL if no
+ *         changes in the notification match the client's filters
+ */
+static struct cib_notification_s *
+filtered_notification(struct cib_notification_s *update,
+                      const pcmk__client_t *client)
+{
+    guint n_matched = 0;
+    char *match = NULL;
+    struct cib_notification_s *filtered = NULL;
+
+    if ((client->userdata == NULL) || (update->changes == NULL)) {
+        return update;
+    }
+
+    match = cib__diff_changes_match(update->changes, client->userdata,
+                                    &n_matched);
+    if (n_matched == 0) {
+        crm_trace("Not notifying client %s: no changes match its filters",
+                  pcmk__client_name(client));
+        free(match);
+        return NULL;
+    }
+    if (n_matched == cib__diff_changes_count(update->changes)) {
+        free(match);
+        return update;
+    }
+
+    if (update->filtered == NULL) {
+        update->filtered = pcmk__strkey_table(free, free_notification);
+    }
+    filtered = g_hash_table_lookup(update->filtered, match);
+
+    if (filtered == NULL) {
+        xmlNode *msg = pcmk__xml_copy(NULL, (xmlNode *) update->msg);
+        xmlNode *wrapper = pcmk__xe_first_child(msg,
+                                                PCMK__XE_CIB_UPDATE_RESULT,
+                                                NULL, NULL);
+        ssize_t bytes = 0;
+
+        pcmk__xml_free(pcmk__xe_first_child(wrapper, NULL, NULL, NULL));
+        pcmk__xe_set_bool_attr(msg, PCMK__XA_CIB_NOTIFY_FILTERED, true);
+        cib__diff_changes_subset(update->changes, match, wrapper);
+
+        filtered = pcmk__assert_alloc(1, sizeof(struct cib_notification_s));
+        filtered->msg = msg;
+        if (pcmk__ipc_prepare_iov(0, msg, 0, &(filtered->iov),
+                                  &bytes) == pcmk_rc_ok) {
+            filtered->iov_size = bytes;
+        }
+        crm_trace("Filtered diff notification to %u of %u changes "
+                  "(%" PRId32 " of %" PRId32 " bytes)",
+                  n_matched, cib__diff_changes_count(update->changes),
+                  filtered->iov_size, update->iov_size);
+        g_hash_table_insert(update->filtered, match, filtered);
+
+    } else {
+        free(match);
+    }
+    return filtered;
+}
+
 static void
 cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
 {
@@ -58,7 +187,8 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
     if (pcmk_is_set(client->flags, cib_notify_diff)
         && pcmk__str_eq(type, PCMK__VALUE_CIB_DIFF_NOTIFY, pcmk__str_none)) {
 
-        do_send = TRUE;
+        update = filtered_notification(update, client);
+        do_send = (update != NULL);
 
     } else if (pcmk_is_set(client->flags, cib_notify_confirm)
                && pcmk__str_eq(type, PCMK__VALUE_CIB_UPDATE_CONFIRMATION,
@@ -77,8 +207,21 @@ cib_notify_send_one(gpointer key, gpointer value, gpointer user_data)
     }
 
     if (do_send) {
+        cib__request_cost_t *cost = cib__request_cost();
+
+        if (cost != NULL) {
+            cost->notifications++;
+        }
+
         switch (PCMK__CLIENT_TYPE(client)) {
             case pcmk__client_ipc:
+                if (update->iov == NULL) {
+                    rc = EINVAL;
+                    crm_warn("Could not notify client %s: %s " QB_XS " id=%s",
+                             pcmk__client_name(client), pcmk_rc_str(rc),
+                             client->id);
+                    break;
+                }
                 rc = pcmk__ipc_send_iov(client, update->iov,
                                         crm_ipc_server_event);
                 if (rc != pcmk_rc_ok) {
@@ -114,8 +257,28 @@ cib_notify_send(const xmlNode *xml)
         update.msg = xml;
         update.iov = iov;
         update.iov_size = bytes;
+        update.changes = NULL;
+        update.filtered = NULL;
+
+        if (pcmk__str_eq(crm_element_value(xml, PCMK__XA_SUBT),
+                         PCMK__VALUE_CIB_DIFF_NOTIFY, pcmk__str_none)) {
+            xmlNode *wrapper = pcmk__xe_first_child(xml,
+                                                    PCMK__XE_CIB_UPDATE_RESULT,
+                                                    NULL, NULL);
+
+            update.changes = cib__diff_changes_new(pcmk__xe_first_child(wrapper,
+                                                                        NULL,
+                                                                        NULL,
+                                                                        NULL));
+        }
+
         pcmk__foreach_ipc_client(cib_notify_send_one, &update);
 
+        if (update.filtered != NULL) {
+            g_hash_table_destroy(update.filtered);
+        }
+        cib__diff_changes_free(update.changes);
+
     } else {
         crm_notice("Could not notify clients: %s " QB_XS " rc=%d",
                    pcmk_rc_str(rc), rc);
@@ -140,10 +303,12 @@ cib_diff_notify(const char *op, int result, const char *call_id,
 
     xmlNode *update_msg = NULL;
     xmlNode *wrapper = NULL;
+    uint64_t notify_start = 0;
 
     if (diff == NULL) {
         return;
     }
+    notify_start = cib__cost_phase_start();
 
     if (result != pcmk_ok) {
         log_level = LOG_WARNING;
@@ -195,4 +360,6 @@ cib_diff_notify(const char *op, int result, const char *call_id,
     crm_log_xml_trace(update_msg, "diff-notify");
     cib_notify_send(update_msg);
     pcmk__xml_free(update_msg);
+
+    cib__cost_phase_end(cib__cost_notify, notify_start);
 }
@@ -364,6 +364,7 @@ cib_remote_connection_destroy(gpointer user_data)
         close(csock);
     }
 
+    based_free_notify_filters(client);
     pcmk__free_client(client);
 
     crm_trace("Freed the cib client");
@@ -409,7 +410,9 @@ cib_handle_remote_msg(pcmk__client_t *client, xmlNode *command)
     }
 
     crm_log_xml_trace(command, "Remote command: ");
+    based_stats_begin(client, 0);
     cib_common_callback_worker(0, 0, command, client, TRUE);
+    based_stats_end(client, command);
 }
 
 static int
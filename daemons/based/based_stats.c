@@ -0,0 +1,141 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <inttypes.h>           // PRIu64
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/cib/internal.h>
+#include <crm/common/xml.h>
+
+#include <pacemaker-based.h>
+
+// How long (in seconds) request costs are kept for "cibadmin --stats"
+#define STATS_WINDOW_S 300
+
+// Log requests that use at least this much CPU time (in microseconds)
+#define SLOW_REQUEST_US 1000000
+
+// Costs of recent requests, by client and by operation type
+static cib__stats_t *request_stats = NULL;
+
+// Accounting for the request currently being processed
+static cib__request_cost_t request_cost;
+static uint64_t cpu_start = 0;
+static uint64_t bytes_sent_start = 0;
+static bool accounting = false;
+
+/*!
+ * \internal
+ * \brief Start accounting for a request from a client or peer
+ *
+ * \param[in] client    IPC or remote client that sent request (\c NULL if peer)
+ * \param[in] bytes_in  Size of request as received (0 if unknown)
+ *
+ * \note Each call must be paired with a call to \c based_stats_end(). Requests
+ *       processed in between (such as those within a transaction) count as
+ *       part of the request being accounted.
+ */
+void
+based_stats_begin(const pcmk__client_t *client, size_t bytes_in)
+{
+    CRM_CHECK(!accounting, return);
+
+    memset(&request_cost, 0, sizeof(request_cost));
+    request_cost.requests = 1;
+    request_cost.bytes_in = bytes_in;
+    bytes_sent_start = (client != NULL)? client->bytes_sent : 0;
+
+    cib__set_request_cost(&request_cost);
+    accounting = true;
+    cpu_start = cib__thread_cpu_us();
+}
+
+/*!
+ * \internal
+ * \brief Finish accounting for a request and add its cost to the table
+ *
+ * \param[in] client   IPC or remote client that sent request (\c NULL if peer)
+ * \param[in] request  Request XML
+ */
+void
+based_stats_end(const pcmk__client_t *client, const xmlNode *request)
+{
+    uint64_t cpu_end = cib__thread_cpu_us();
+
+    if (!accounting) {
+        return;
+    }
+    accounting = false;
+    cib__set_request_cost(NULL);
+
+    request_cost.cpu_us = (cpu_end > cpu_start)? (cpu_end - cpu_start) : 0;
+    if (client != NULL) {
+        // Includes any notifications this client subscribed to
+        request_cost.bytes_out = client->bytes_sent - bytes_sent_start;
+    }
+
+    if (request_cost.cpu_us >= SLOW_REQUEST_US) {
+        crm_info("%s request from %s used %.3fs of CPU time (ACLs %.3fs, "
+                 "diff %.3fs, %" PRIu64 " notifications %.3fs)",
+                 pcmk__s(crm_element_value(request, PCMK__XA_CIB_OP),
+                         "unknown"),
+                 pcmk__s(crm_element_value(request, PCMK__XA_CIB_CLIENTNAME),
+                         "unknown client"),
+                 request_cost.cpu_us / 1e6, request_cost.acl_us / 1e6,
+                 request_cost.diff_us / 1e6, request_cost.notifications,
+                 request_cost.notify_us / 1e6);
+    }
+
+    if (request_stats == NULL) {
+        request_stats = cib__stats_new(STATS_WINDOW_S);
+    }
+    cib__stats_record(request_stats,
+                      crm_element_value(request, PCMK__XA_CIB_CLIENTNAME),
+                      crm_element_value(request, PCMK__XA_CIB_OP),
+                      &request_cost, time(NULL));
+}
+
+/*!
+ * \internal
+ * \brief Free request statistics
+ */
+void
+based_stats_free(void)
+{
+    g_clear_pointer(&request_stats, cib__stats_free);
+}
+
+int
+cib_process_stats(const char *op, int options, const char *section,
+                  xmlNode *req, xmlNode *input, xmlNode *existing_cib,
+                  xmlNode **result_cib, xmlNode **answer)
+{
+    int limit = 0;
+
+    if (input != NULL) {
+        crm_element_value_int(input, PCMK__XA_LIMIT, &limit);
+    }
+    if (limit < 0) {
+        return -EINVAL;
+    }
+
+    if (request_stats == NULL) {
+        request_stats = cib__stats_new(STATS_WINDOW_S);
+    }
+    *answer = cib__stats_xml(request_stats, (guint) limit, time(NULL));
+    return pcmk_ok;
+}
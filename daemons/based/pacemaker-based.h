@@ -120,14 +120,26 @@ int cib_process_commit_transaction(const char *op, int options,
 int cib_process_schemas(const char *op, int options, const char *section,
                         xmlNode *req, xmlNode *input, xmlNode *existing_cib,
                         xmlNode **result_cib, xmlNode **answer);
+int cib_process_stats(const char *op, int options, const char *section,
+                      xmlNode *req, xmlNode *input, xmlNode *existing_cib,
+                      xmlNode **result_cib, xmlNode **answer);
 
 void send_sync_request(const char *host);
+void based_record_patchset(const xmlNode *patchset);
+void based_free_patchset_history(void);
+void based_add_delta_sync_version(xmlNode *msg, const xmlNode *cib);
 int sync_our_cib(xmlNode *request, gboolean all);
 
 cib__op_fn_t based_get_op_function(const cib__operation_t *operation);
 void cib_diff_notify(const char *op, int result, const char *call_id,
                      const char *client_id, const char *client_name,
                      const char *origin, xmlNode *update, xmlNode *diff);
+int based_set_notify_filters(pcmk__client_t *client, const xmlNode *request);
+void based_free_notify_filters(pcmk__client_t *client);
+
+void based_stats_begin(const pcmk__client_t *client, size_t bytes_in);
+void based_stats_end(const pcmk__client_t *client, const xmlNode *request);
+void based_stats_free(void);
 
 static inline const char *
 cib_config_lookup(const char *opt)
@@ -46,13 +46,17 @@ handle_cib_disconnect(gpointer user_data)
     }
 }
 
+/*!
+ * \internal
+ * \brief Re-read the controller configuration if it changed
+ *
+ * \param[in] event  Type of CIB notification
+ * \param[in] msg    CIB diff notification (changing the configuration section)
+ */
 static void
-do_cib_updated(const char *event, xmlNode * msg)
+cib_config_updated(const char *event, xmlNode *msg)
 {
     const xmlNode *patchset = NULL;
-    const char *client_name = NULL;
-
-    crm_debug("Received CIB diff notification: DC=%s", pcmk__btoa(AM_I_DC));
 
     if (cib__get_notify_patchset(msg, &patchset) != pcmk_rc_ok) {
         return;
@@ -63,6 +67,58 @@ do_cib_updated(const char *event, xmlNode * msg)
 
         controld_trigger_config();
     }
+}
+
+/*!
+ * \internal
+ * \brief Register for notifications of CIB configuration changes
+ *
+ * Most CIB changes are resource history updates in the status section, so
+ * the configuration watcher is called only for changes to the configuration
+ * section.
+ *
+ * \param[in,out] cib_conn  CIB connection
+ *
+ * \return Legacy Pacemaker return code
+ */
+static int
+add_config_callback(cib_t *cib_conn)
+{
+    cib__notify_filter_t *filter = NULL;
+    int rc = cib__notify_filter_new(PCMK_XE_CONFIGURATION, NULL, NULL, NULL,
+                                    &filter);
+
+    if (rc != pcmk_rc_ok) {
+        return pcmk_rc2legacy(rc);
+    }
+    rc = cib__add_filtered_notify_callback(cib_conn, cib_config_updated,
+                                           filter);
+    cib__notify_filter_free(filter);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Start a new join if an unsafe client changed nodes or status (as DC)
+ *
+ * This needs to see status changes, which are most CIB changes, so it is
+ * registered only while this node is the DC (when the transitioner needs to see
+ * them anyway). Other nodes get only the configuration changes they watch.
+ *
+ * \param[in] event  Type of CIB notification
+ * \param[in] msg    CIB diff notification
+ */
+void
+controld_check_unsafe_cib_change(const char *event, xmlNode *msg)
+{
+    const xmlNode *patchset = NULL;
+    const char *client_name = NULL;
+
+    crm_debug("Received CIB diff notification: DC=%s", pcmk__btoa(AM_I_DC));
+
+    if (cib__get_notify_patchset(msg, &patchset) != pcmk_rc_ok) {
+        return;
+    }
 
     if (!AM_I_DC) {
         // We're not in control of the join sequence
@@ -106,7 +162,9 @@ controld_disconnect_cib_manager(void)
     controld_clear_fsa_input_flags(R_CIB_CONNECTED);
 
     cib_conn->cmds->del_notify_callback(cib_conn, PCMK__VALUE_CIB_DIFF_NOTIFY,
-                                        do_cib_updated);
+                                        controld_check_unsafe_cib_change);
+    cib_conn->cmds->del_notify_callback(cib_conn, PCMK__VALUE_CIB_DIFF_NOTIFY,
+                                        cib_config_updated);
     cib_free_callbacks(cib_conn);
 
     if (cib_conn->state != cib_disconnected) {
@@ -127,7 +185,6 @@ do_cib_control(long long action,
     cib_t *cib_conn = controld_globals.cib_conn;
 
     void (*dnotify_fn) (gpointer user_data) = handle_cib_disconnect;
-    void (*update_cb) (const char *event, xmlNodePtr msg) = do_cib_updated;
 
     int rc = pcmk_ok;
 
@@ -172,10 +229,8 @@ do_cib_control(long long action,
                                                       dnotify_fn) != pcmk_ok) {
         crm_err("Could not set dnotify callback");
 
-    } else if (cib_conn->cmds->add_notify_callback(cib_conn,
-                                                   PCMK__VALUE_CIB_DIFF_NOTIFY,
-                                                   update_cb) != pcmk_ok) {
-        crm_err("Could not set CIB notification callback (update)");
+    } else if (add_config_callback(cib_conn) != pcmk_ok) {
+        crm_err("Could not set CIB notification callback (configuration)");
 
     } else {
         controld_set_fsa_input_flags(R_CIB_CONNECTED);
@@ -706,6 +761,34 @@ controld_add_resource_history_xml_as(const char *func, xmlNode *parent,
     return;
 }
 
+/*!
+ * \internal
+ * \brief Convert a node's resource history update to compact format if enabled
+ *
+ * \param[in,out] lrm        Node's \c PCMK__XE_LRM element in an update
+ * \param[in]     node_name  Node whose history \p lrm is
+ *
+ * \note Compact history is written only if the
+ *       \c PCMK_OPT_RESOURCE_HISTORY_FORMAT cluster option enables it and the
+ *       DC supports it. The DC has the oldest feature set in the cluster, so
+ *       every node can then read it.
+ */
+void
+controld_compact_resource_history(xmlNode *lrm, const char *node_name)
+{
+    lrm_state_t *lrm_state = NULL;
+
+    if (!pcmk_is_set(controld_globals.flags, controld_compact_history)
+        || (compare_version(controld_globals.dc_version, "3.21.0") < 0)) {
+        return;
+    }
+
+    // Digest use counts help decide which digests to share across updates
+    lrm_state = controld_get_executor_state(node_name, false);
+    pcmk__compact_history(lrm, node_name,
+                          (lrm_state == NULL)? NULL : lrm_state->history_digests);
+}
+
 /*!
  * \internal
  * \brief Record an action as pending in the CIB, if appropriate
@@ -872,6 +955,7 @@ controld_update_resource_history(const char *node_name,
     xmlNode *update = NULL;
     xmlNode *xml = NULL;
     int call_opt = crmd_cib_smart_opt();
+    xmlNode *lrm = NULL;
     const char *node_id = NULL;
     const char *container = NULL;
 
@@ -899,11 +983,11 @@ controld_update_resource_history(const char *node_name,
     crm_xml_add(xml, PCMK_XA_CRM_DEBUG_ORIGIN, __func__);
 
     //     <lrm ...>
-    xml = pcmk__xe_create(xml, PCMK__XE_LRM);
-    crm_xml_add(xml, PCMK_XA_ID, node_id);
+    lrm = pcmk__xe_create(xml, PCMK__XE_LRM);
+    crm_xml_add(lrm, PCMK_XA_ID, node_id);
 
     //       <lrm_resources>
-    xml = pcmk__xe_create(xml, PCMK__XE_LRM_RESOURCES);
+    xml = pcmk__xe_create(lrm, PCMK__XE_LRM_RESOURCES);
 
     //         <lrm_resource ...>
     xml = pcmk__xe_create(xml, PCMK__XE_LRM_RESOURCE);
@@ -932,6 +1016,7 @@ controld_update_resource_history(const char *node_name,
 
     //           <lrm_resource_op ...> (possibly more than one)
     controld_add_resource_history_xml(xml, rsc, op, node_name);
+    controld_compact_resource_history(lrm, node_name);
 
     /* Update CIB asynchronously. Even if it fails, the resource state should be
      * discovered during the next election. Worst case, the node is wrongly
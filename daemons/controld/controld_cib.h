@@ -83,6 +83,8 @@ void controld_add_resource_history_xml_as(const char *func, xmlNode *parent,
     controld_add_resource_history_xml_as(__func__, (parent), (rsc),     \
                                          (op), (node_name))
 
+void controld_compact_resource_history(xmlNode *lrm, const char *node_name);
+
 bool controld_record_pending_op(const char *node_name,
                                 const lrmd_rsc_info_t *rsc,
                                 lrmd_event_data_t *op);
@@ -100,6 +102,7 @@ void controld_delete_action_history_by_key(const char *rsc_id, const char *node,
                                            const char *key, int call_id);
 
 void controld_disconnect_cib_manager(void);
+void controld_check_unsafe_cib_change(const char *event, xmlNode *msg);
 
 int crmd_cib_smart_opt(void);
 
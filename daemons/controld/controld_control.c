@@ -187,6 +187,7 @@ crmd_exit(crm_exit_t exit_code)
 
     controld_close_attrd_ipc();
     controld_shutdown_schedulerd_ipc();
+    controld_cleanup_fencing_updates();
     controld_disconnect_fencer(TRUE);
 
     if ((exit_code == CRM_EX_OK) && (controld_globals.mainloop == NULL)) {
@@ -389,6 +390,10 @@ dispatch_controller_ipc(qb_ipcs_connection_t * c, void *data, size_t size)
                            CRM_EX_PROTOCOL);
         return 0;
     }
+    if (pcmk__ipc_handle_common_request(client, id, flags, msg)) {
+        pcmk__xml_free(msg);
+        return 0;
+    }
     pcmk__ipc_send_ack(client, id, flags, PCMK__XE_ACK, NULL,
                        CRM_EX_INDETERMINATE);
 
@@ -595,6 +600,13 @@ config_query_callback(xmlNode * msg, int call_id, int rc, xmlNode * output, void
         controld_clear_global_flags(controld_shutdown_lock_enabled);
     }
 
+    value = g_hash_table_lookup(config_hash, PCMK_OPT_RESOURCE_HISTORY_FORMAT);
+    if (pcmk__str_eq(value, PCMK_VALUE_COMPACT, pcmk__str_casei)) {
+        controld_set_global_flags(controld_compact_history);
+    } else {
+        controld_clear_global_flags(controld_compact_history);
+    }
+
     value = g_hash_table_lookup(config_hash, PCMK_OPT_SHUTDOWN_LOCK_LIMIT);
     pcmk_parse_interval_spec(value, &controld_globals.shutdown_lock_limit);
     controld_globals.shutdown_lock_limit /= 1000;
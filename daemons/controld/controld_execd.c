@@ -599,6 +599,7 @@ controld_query_executor_state(void)
 
     /* Build a list of active (not always running) resources */
     build_active_RAs(lrm_state, rsc_list);
+    controld_compact_resource_history(xml_data, lrm_state->node_name);
 
     crm_log_xml_trace(xml_state, "Current executor state");
 
@@ -1695,6 +1696,120 @@ construct_op(const lrm_state_t *lrm_state, const xmlNode *rsc_op,
     return op;
 }
 
+/* While a batch of requests is being handled, direct acknowledgements are
+ * collected into a single reply per destination
+ */
+static struct {
+    bool active;
+    char *to_host;
+    char *to_sys;
+    xmlNode *update;            // Node state update to send
+    xmlNode *lrm_resources;     // Where in update to add resource history
+} ack_batch = { false, NULL, NULL, NULL, NULL, };
+
+/*!
+ * \internal
+ * \brief Send a node state update with resource history as an event result
+ *
+ * \param[in] to_host  Host to send result to
+ * \param[in] to_sys   IPC name to send result
+ * \param[in] update   Node state update to send
+ */
+static void
+send_direct_ack(const char *to_host, const char *to_sys, xmlNode *update)
+{
+    /* We don't have the original message ID, so use "direct-ack" (we just need
+     * something non-NULL for this to create a reply)
+     *
+     * @TODO It would be better to use the server, message ID, and task from the
+     * original request when callers have it available
+     */
+    xmlNode *reply = pcmk__new_message(pcmk_ipc_controld, "direct-ack",
+                                       CRM_SYSTEM_LRMD, to_host, to_sys,
+                                       CRM_OP_INVOKE_LRM, update);
+
+    crm_log_xml_trace(update, "[direct ACK]");
+
+    if (relay_message(reply, TRUE) == FALSE) {
+        crm_log_xml_err(reply, "Unable to route reply");
+    }
+    pcmk__xml_free(reply);
+}
+
+// Send any acknowledgements collected so far in the current batch
+static void
+flush_ack_batch(void)
+{
+    if (ack_batch.update != NULL) {
+        send_direct_ack(ack_batch.to_host, ack_batch.to_sys, ack_batch.update);
+        g_clear_pointer(&ack_batch.update, pcmk__xml_free);
+    }
+    ack_batch.lrm_resources = NULL;
+    g_clear_pointer(&ack_batch.to_host, free);
+    g_clear_pointer(&ack_batch.to_sys, free);
+}
+
+/*!
+ * \internal
+ * \brief Start combining direct event acknowledgements into one reply
+ *
+ * \note Callers must call controld_end_ack_batch() when done.
+ */
+void
+controld_begin_ack_batch(void)
+{
+    flush_ack_batch();
+    ack_batch.active = true;
+}
+
+/*!
+ * \internal
+ * \brief Send any combined direct event acknowledgements
+ */
+void
+controld_end_ack_batch(void)
+{
+    flush_ack_batch();
+    ack_batch.active = false;
+}
+
+/*!
+ * \internal
+ * \brief Get the resource list to add a direct acknowledgement to
+ *
+ * \param[in] to_host  Host to send result to
+ * \param[in] to_sys   IPC name to send result
+ *
+ * \return PCMK__XE_LRM_RESOURCES element in a new or batched update
+ */
+static xmlNode *
+ack_resources(const char *to_host, const char *to_sys)
+{
+    pcmk__node_status_t *peer = controld_get_local_node_status();
+    xmlNode *update = NULL;
+    xmlNode *iter = NULL;
+
+    if (ack_batch.active && (ack_batch.update != NULL)
+        && pcmk__str_eq(to_host, ack_batch.to_host, pcmk__str_casei)
+        && pcmk__str_eq(to_sys, ack_batch.to_sys, pcmk__str_none)) {
+        return ack_batch.lrm_resources;
+    }
+
+    update = create_node_state_update(peer, node_update_none, NULL, __func__);
+    iter = pcmk__xe_create(update, PCMK__XE_LRM);
+    crm_xml_add(iter, PCMK_XA_ID, controld_globals.our_uuid);
+    iter = pcmk__xe_create(iter, PCMK__XE_LRM_RESOURCES);
+
+    if (ack_batch.active) {
+        flush_ack_batch();
+        ack_batch.to_host = pcmk__str_copy(to_host);
+        ack_batch.to_sys = pcmk__str_copy(to_sys);
+        ack_batch.update = update;
+        ack_batch.lrm_resources = iter;
+    }
+    return iter;
+}
+
 /*!
  * \internal
  * \brief Send a (synthesized) event result
@@ -1713,9 +1828,7 @@ controld_ack_event_directly(const char *to_host, const char *to_sys,
                             const lrmd_rsc_info_t *rsc, lrmd_event_data_t *op,
                             const char *rsc_id)
 {
-    xmlNode *reply = NULL;
-    xmlNode *update, *iter;
-    pcmk__node_status_t *peer = NULL;
+    xmlNode *iter = NULL;
 
     CRM_CHECK(op != NULL, return);
     if (op->rsc_id == NULL) {
@@ -1727,13 +1840,7 @@ controld_ack_event_directly(const char *to_host, const char *to_sys,
         to_sys = CRM_SYSTEM_TENGINE;
     }
 
-    peer = controld_get_local_node_status();
-    update = create_node_state_update(peer, node_update_none, NULL,
-                                      __func__);
-
-    iter = pcmk__xe_create(update, PCMK__XE_LRM);
-    crm_xml_add(iter, PCMK_XA_ID, controld_globals.our_uuid);
-    iter = pcmk__xe_create(iter, PCMK__XE_LRM_RESOURCES);
+    iter = ack_resources(to_host, to_sys);
     iter = pcmk__xe_create(iter, PCMK__XE_LRM_RESOURCE);
 
     crm_xml_add(iter, PCMK_XA_ID, op->rsc_id);
@@ -1741,27 +1848,17 @@ controld_ack_event_directly(const char *to_host, const char *to_sys,
     controld_add_resource_history_xml(iter, rsc, op,
                                       controld_globals.cluster->priv->node_name);
 
-    /* We don't have the original message ID, so use "direct-ack" (we just need
-     * something non-NULL for this to create a reply)
-     *
-     * @TODO It would be better to use the server, message ID, and task from the
-     * original request when callers have it available
-     */
-    reply = pcmk__new_message(pcmk_ipc_controld, "direct-ack", CRM_SYSTEM_LRMD,
-                              to_host, to_sys, CRM_OP_INVOKE_LRM, update);
-
-    crm_log_xml_trace(update, "[direct ACK]");
-
-    crm_debug("ACK'ing resource op " PCMK__OP_FMT " from %s: %s",
+    crm_debug("ACK'ing resource op " PCMK__OP_FMT " from %s%s",
               op->rsc_id, op->op_type, op->interval_ms, op->user_data,
-              crm_element_value(reply, PCMK_XA_REFERENCE));
+              (ack_batch.active? " (batched)" : ""));
 
-    if (relay_message(reply, TRUE) == FALSE) {
-        crm_log_xml_err(reply, "Unable to route reply");
-    }
+    if (!ack_batch.active) {
+        // node_state > lrm > lrm_resources > lrm_resource
+        xmlNode *update = iter->parent->parent->parent;
 
-    pcmk__xml_free(update);
-    pcmk__xml_free(reply);
+        send_direct_ack(to_host, to_sys, update);
+        pcmk__xml_free(update);
+    }
 }
 
 gboolean
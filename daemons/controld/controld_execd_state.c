@@ -121,6 +121,7 @@ lrm_state_create(const char *node_name)
     state->active_ops = pcmk__strkey_table(free, free_recurring_op);
     state->resource_history = pcmk__strkey_table(NULL, history_free);
     state->metadata_cache = metadata_cache_new();
+    state->history_digests = pcmk__strkey_table(free, NULL);
 
     g_hash_table_insert(lrm_state_table, (char *)state->node_name, state);
     return state;
@@ -222,6 +223,9 @@ internal_lrm_state_destroy(gpointer data)
         g_hash_table_destroy(lrm_state->active_ops);
     }
     metadata_cache_free(lrm_state->metadata_cache);
+    if (lrm_state->history_digests != NULL) {
+        g_hash_table_destroy(lrm_state->history_digests);
+    }
 
     free((char *)lrm_state->node_name);
     free(lrm_state);
@@ -404,7 +408,21 @@ controld_connect_local_executor(lrm_state_t *lrm_state)
     rc = pcmk_legacy2rc(rc);
 
     if (rc == pcmk_rc_ok) {
+        int filter_rc = pcmk_rc_ok;
+
         lrm_state->num_lrm_register_fails = 0;
+
+        /* lrm_op_callback() uses only action results from the local executor,
+         * so don't make it send us anything else
+         */
+        filter_rc = lrmd__set_notify_filter(lrm_state->conn,
+                                            lrmd__notify_exec_ok
+                                            |lrmd__notify_exec_failed,
+                                            NULL, NULL);
+        if (filter_rc != pcmk_rc_ok) {
+            crm_debug("Receiving all local executor notifications: %s",
+                      pcmk_rc_str(filter_rc));
+        }
     } else {
         lrm_state->num_lrm_register_fails++;
     }
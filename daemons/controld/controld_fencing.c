@@ -207,11 +207,231 @@ cib_fencing_updated(xmlNode *msg, int call_id, int rc, xmlNode *output,
     }
 }
 
+/*
+ * fencing update coalescing
+ *
+ * Recording that a node was fenced takes a node state modification and a
+ * deletion of the node's resource history and transient attributes. When many
+ * nodes are fenced at about the same time (for example, after the loss of a
+ * site), the updates for all of them are combined into one atomic CIB
+ * transaction, so the CIB changes (and the transition aborts it can trigger)
+ * happen once rather than twice per node.
+ *
+ * A fencing action in the transition graph is not confirmed until its update
+ * has been sent, so no action that depends on the fencing (such as a remote
+ * node start or a probe, which would record resource history that the
+ * deletion would then wipe) can be executed before it. If the update is
+ * discarded because the CIB is disconnected, the action fails instead. Anything
+ * else that depends on the CIB reflecting the fencing (a new scheduler run or
+ * an unfencing action) flushes pending updates first.
+ */
+
+// How long to wait for more fencing results before writing to the CIB
+#define FENCING_UPDATE_DELAY_MS 100
+
+static cib__status_batch_t *fencing_updates = NULL;
+static mainloop_timer_t *fencing_update_timer = NULL;
+
+/*!
+ * \internal
+ * \brief Confirm or fail graph actions whose fencing updates were flushed
+ *
+ * \param[in] updates  Fencing updates that were flushed
+ * \param[in] sent     If true, the updates were sent to the CIB, so confirm
+ *                     their actions. Otherwise, the updates were discarded, so
+ *                     fail the actions (the fencing was not recorded, so
+ *                     nothing that depends on it may run) and abort the
+ *                     transition.
+ */
+static void
+confirm_fencing_actions(const GList *updates, bool sent)
+{
+    pcmk__graph_t *graph = controld_globals.transition_graph;
+    bool updated = false;
+    bool failed = false;
+
+    if ((graph == NULL) || graph->complete) {
+        return;
+    }
+
+    for (const GList *iter = updates; iter != NULL; iter = iter->next) {
+        const cib__status_update_t *update = iter->data;
+        pcmk__graph_action_t *action = NULL;
+
+        if (update->tag < 0) {
+            continue; // Update is not for a graph action
+        }
+
+        action = controld_get_action(update->tag);
+        if ((action == NULL)
+            || pcmk_is_set(action->flags, pcmk__graph_action_confirmed)) {
+            continue;
+        }
+
+        if (sent) {
+            te_action_confirmed(action, NULL);
+        } else {
+            crm_warn("Failing fence action %d because its result could not "
+                     "be recorded in the CIB", action->id);
+            pcmk__set_graph_action_flags(action, pcmk__graph_action_failed);
+            failed = true;
+        }
+        pcmk__update_graph(graph, action);
+        updated = true;
+    }
+
+    if (failed) {
+        abort_transition(PCMK_SCORE_INFINITY, pcmk__graph_restart,
+                         "Fencing result not recorded", NULL);
+    }
+    if (updated) {
+        trigger_graph();
+    }
+}
+
+/*!
+ * \internal
+ * \brief Write any pending fencing updates to the CIB
+ */
+void
+controld_flush_fencing_updates(void)
+{
+    static pcmk__metric_t transaction_metric =
+        PCMK__METRIC(pcmk__metric_counter, "controld_fencing_cib_updates",
+                     "Number of CIB updates recording fencing results");
+    static pcmk__metric_t node_metric =
+        PCMK__METRIC(pcmk__metric_counter, "controld_fencing_nodes_recorded",
+                     "Number of fenced nodes recorded in the CIB");
+
+    cib_t *cib = controld_globals.cib_conn;
+    const GList *updates = cib__status_batch_updates(fencing_updates);
+    char *desc = NULL;
+    int call_id = 0;
+    int rc = pcmk_rc_ok;
+    bool sent = true;
+
+    if (updates == NULL) {
+        return;
+    }
+    mainloop_timer_stop(fencing_update_timer);
+
+    if ((cib == NULL) || (cib->state == cib_disconnected)) {
+        crm_warn("Discarding fencing updates because CIB is disconnected");
+        sent = false;
+        goto done;
+    }
+
+    rc = cib__status_batch_send(cib, fencing_updates, &call_id, &desc);
+    if (rc == pcmk_rc_ok) {
+        // Delay processing the trigger until the update completes
+        crm_debug("Sending fencing update %d for %s", call_id, desc);
+        fsa_register_cib_callback(call_id, desc, cib_fencing_updated);
+        pcmk__metric_add(&transaction_metric, 1);
+        pcmk__metric_add(&node_metric, g_list_length((GList *) updates));
+        goto done;
+    }
+
+    crm_warn("Sending fencing updates separately because CIB transaction "
+             "could not be started: %s", pcmk_rc_str(rc));
+
+    for (const GList *iter = updates; iter != NULL; iter = iter->next) {
+        const cib__status_update_t *update = iter->data;
+        const char *target = pcmk__s(update->name,
+                                     pcmk__xe_id(update->node_state));
+
+        call_id = cib->cmds->modify(cib, PCMK_XE_STATUS, update->node_state,
+                                    cib_can_create);
+        fsa_register_cib_callback(call_id, pcmk__str_copy(target),
+                                  cib_fencing_updated);
+
+        if (update->name != NULL) {
+            controld_delete_node_state(update->name, controld_section_all,
+                                       cib_none);
+        }
+        pcmk__metric_add(&transaction_metric, 1);
+        pcmk__metric_add(&node_metric, 1);
+    }
+
+  done:
+    confirm_fencing_actions(updates, sent);
+    cib__status_batch_clear(fencing_updates);
+}
+
+static gboolean
+fencing_update_timer_cb(gpointer user_data)
+{
+    controld_flush_fencing_updates();
+    return FALSE;
+}
+
+/*!
+ * \internal
+ * \brief Queue a fencing update to be written to the CIB shortly
+ *
+ * \param[in]     node_name   Name of fenced node (or NULL if unknown)
+ * \param[in,out] node_state  Node state update (takes ownership)
+ * \param[in]     action_id   ID of graph action to confirm once the update has
+ *                            been sent (or -1 if none)
+ */
 static void
+queue_fencing_update(const char *node_name, xmlNode *node_state, int action_id)
+{
+    char *xpath = NULL;
+
+    if (fencing_updates == NULL) {
+        fencing_updates = cib__status_batch_new();
+    }
+    if (node_name != NULL) {
+        controld_node_state_deletion_strings(node_name, controld_section_all,
+                                             &xpath, NULL);
+    }
+    cib__status_batch_add(fencing_updates, node_name, node_state, xpath,
+                          action_id);
+    free(xpath);
+
+    if (fencing_update_timer == NULL) {
+        fencing_update_timer = mainloop_timer_add("fencing_update",
+                                                  FENCING_UPDATE_DELAY_MS,
+                                                  FALSE,
+                                                  fencing_update_timer_cb,
+                                                  NULL);
+    }
+    if (!mainloop_timer_running(fencing_update_timer)) {
+        mainloop_timer_start(fencing_update_timer);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Write pending fencing updates and free fencing update resources
+ */
+void
+controld_cleanup_fencing_updates(void)
+{
+    controld_flush_fencing_updates();
+    cib__status_batch_free(fencing_updates);
+    fencing_updates = NULL;
+    mainloop_timer_del(fencing_update_timer);
+    fencing_update_timer = NULL;
+}
+
+/* end fencing update coalescing */
+
+/*!
+ * \internal
+ * \brief Queue a CIB update recording that a node was fenced
+ *
+ * \param[in] action  Fencing action that succeeded (or NULL if none)
+ * \param[in] target  Name of fenced node
+ * \param[in] uuid    XML ID of fenced node
+ *
+ * \return true if an update was queued (in which case \p action will be
+ *         confirmed once it has been sent), otherwise false
+ */
+static bool
 send_stonith_update(pcmk__graph_action_t *action, const char *target,
                     const char *uuid)
 {
-    int rc = pcmk_ok;
     pcmk__node_status_t *peer = NULL;
 
     /* We (usually) rely on the membership layer to do node_update_cluster,
@@ -223,8 +443,8 @@ send_stonith_update(pcmk__graph_action_t *action, const char *target,
     /* zero out the node-status & remove all LRM status info */
     xmlNode *node_state = NULL;
 
-    CRM_CHECK(target != NULL, return);
-    CRM_CHECK(uuid != NULL, return);
+    CRM_CHECK(target != NULL, return false);
+    CRM_CHECK(uuid != NULL, return false);
 
     /* Make sure the membership and join caches are accurate.
      * Try getting any existing node cache entry also by node uuid in case it
@@ -232,7 +452,7 @@ send_stonith_update(pcmk__graph_action_t *action, const char *target,
      */
     peer = pcmk__get_node(0, target, uuid, pcmk__node_search_any);
 
-    CRM_CHECK(peer != NULL, return);
+    CRM_CHECK(peer != NULL, return false);
 
     if (peer->state == NULL) {
         /* Usually, we rely on the membership layer to update the cluster state
@@ -263,22 +483,10 @@ send_stonith_update(pcmk__graph_action_t *action, const char *target,
     /* Force our known ID */
     crm_xml_add(node_state, PCMK_XA_ID, uuid);
 
-    rc = controld_globals.cib_conn->cmds->modify(controld_globals.cib_conn,
-                                                 PCMK_XE_STATUS, node_state,
-                                                 cib_can_create);
-
-    /* Delay processing the trigger until the update completes */
-    crm_debug("Sending fencing update %d for %s", rc, target);
-    fsa_register_cib_callback(rc, pcmk__str_copy(target), cib_fencing_updated);
-
-    // Make sure it sticks
-    /* controld_globals.cib_conn->cmds->bump_epoch(controld_globals.cib_conn,
-     *                                             cib_none);
-     */
-
-    controld_delete_node_state(peer->name, controld_section_all, cib_none);
-    pcmk__xml_free(node_state);
-    return;
+    crm_debug("Queuing fencing update for %s", target);
+    queue_fencing_update(peer->name, node_state,
+                         ((action == NULL)? -1 : action->id));
+    return true;
 }
 
 /*!
@@ -855,7 +1063,6 @@ tengine_stonith_callback(stonith_t *stonith, stonith_callback_data_t *data)
 
         crm_info("Fence operation %d for %s succeeded", data->call_id, target);
         if (!(pcmk_is_set(action->flags, pcmk__graph_action_confirmed))) {
-            te_action_confirmed(action, NULL);
             if (pcmk__str_eq(PCMK_ACTION_ON, op, pcmk__str_casei)) {
                 const char *value = NULL;
                 char *now = pcmk__ttoa(time(NULL));
@@ -886,11 +1093,26 @@ tengine_stonith_callback(stonith_t *stonith, stonith_callback_data_t *data)
                 update_attrd(target, CRM_ATTR_DIGESTS_SECURE, value, NULL,
                              is_remote_node);
 
-            } else if (!(pcmk_is_set(action->flags, pcmk__graph_action_sent_update))) {
-                send_stonith_update(action, target, uuid);
+            } else if (pcmk_is_set(action->flags,
+                                   pcmk__graph_action_sent_update)) {
+                // Confirmation is waiting for the queued fencing update
+                st_fail_count_reset(target);
+                goto bail;
+
+            } else {
                 pcmk__set_graph_action_flags(action,
                                              pcmk__graph_action_sent_update);
+
+                /* The action will be confirmed (and the graph updated) once
+                 * the fencing update has been sent, so nothing that depends
+                 * on the fencing can run before the node's history is cleared
+                 */
+                if (send_stonith_update(action, target, uuid)) {
+                    st_fail_count_reset(target);
+                    goto bail;
+                }
             }
+            te_action_confirmed(action, NULL);
         }
         st_fail_count_reset(target);
 
@@ -995,6 +1217,13 @@ controld_execute_fence_action(pcmk__graph_t *graph,
                priority_delay ? " priority_delay=" : "",
                priority_delay ? priority_delay : "");
 
+    /* Unfencing results are recorded as node attributes, which a pending
+     * fencing update for the same node would delete if it were written later
+     */
+    if (pcmk__str_eq(type, PCMK_ACTION_ON, pcmk__str_casei)) {
+        controld_flush_fencing_updates();
+    }
+
     /* Passing NULL means block until we can connect... */
     controld_timer_fencer_connect(NULL);
 
@@ -25,6 +25,10 @@ int controld_execute_fence_action(pcmk__graph_t *graph,
                                   pcmk__graph_action_t *action);
 bool controld_verify_stonith_watchdog_timeout(const char *value);
 
+// fencing update coalescing
+void controld_flush_fencing_updates(void);
+void controld_cleanup_fencing_updates(void);
+
 // stonith cleanup list
 void add_stonith_cleanup(const char *target);
 void remove_stonith_cleanup(const char *target);
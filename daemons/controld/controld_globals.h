@@ -131,6 +131,9 @@ enum controld_flags {
 
     //! Lock resources to the local node when it shuts down cleanly
     controld_shutdown_lock_enabled  = (1 << 5),
+
+    //! Record resource history in the CIB in compact format
+    controld_compact_history        = (1 << 6),
 };
 
 #  define controld_set_global_flags(flags_to_set) do {                      \
@@ -594,6 +594,11 @@ do_dc_join_filter_offer(long long action,
     } else {
         crm_update_peer_join(__func__, join_node, controld_join_integrated);
         pcmk__update_peer_expected(__func__, join_node, CRMD_JOINSTATE_MEMBER);
+
+        // Peers that support it may be sent resource actions in batches
+        controld_set_peer_accepts_batches(join_from,
+                                          pcmk__xe_attr_is_true(join_ack->msg,
+                                                                PCMK__XA_INVOKE_BATCHES));
     }
 
     count = crmd_join_phase_count(controld_join_integrated);
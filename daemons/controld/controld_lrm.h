@@ -75,6 +75,7 @@ typedef struct lrm_state_s {
     GHashTable *deletion_ops;
     GHashTable *rsc_info_cache;
     GHashTable *metadata_cache; // key = class[:provider]:agent, value = ra_metadata_s
+    GHashTable *history_digests; // key = digest, value = times recorded
 
     int num_lrm_register_fails;
 } lrm_state_t;
@@ -169,6 +170,8 @@ void process_lrm_event(lrm_state_t *lrm_state, lrmd_event_data_t *op,
 void controld_ack_event_directly(const char *to_host, const char *to_sys,
                                  const lrmd_rsc_info_t *rsc,
                                  lrmd_event_data_t *op, const char *rsc_id);
+void controld_begin_ack_batch(void);
+void controld_end_ack_batch(void);
 void controld_rc2event(lrmd_event_data_t *event, int rc);
 void controld_trigger_delete_refresh(const char *from_sys, const char *rsc_id);
 
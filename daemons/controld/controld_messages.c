@@ -1291,6 +1291,63 @@ handle_shutdown_request(xmlNode * stored_msg)
     return I_NULL;
 }
 
+/*!
+ * \internal
+ * \brief Execute each resource action in a batched request from the DC
+ *
+ * \param[in] msg  Request with PCMK__CONTROLD_CMD_INVOKE_BATCH as task
+ */
+static void
+invoke_lrm_batch(const xmlNode *msg)
+{
+    xmlNode *wrapper = pcmk__xe_first_child(msg, PCMK__XE_CRM_XML, NULL, NULL);
+    xmlNode *ops = pcmk__xe_first_child(wrapper, PCMK__XE_RSC_OPS, NULL, NULL);
+    xmlNode *request = NULL;
+    int count = 0;
+
+    if (ops == NULL) {
+        crm_warn("Ignoring batched resource action request without actions");
+        return;
+    }
+
+    /* Each action is handled as if it arrived in its own request, with the
+     * same header as the batch. Acknowledgements that are sent directly are
+     * combined into a single reply.
+     */
+    request = pcmk__xe_create(NULL, (const char *) msg->name);
+    pcmk__xe_copy_attrs(request, msg, pcmk__xaf_none);
+    crm_xml_add(request, PCMK__XA_CRM_TASK, CRM_OP_INVOKE_LRM);
+
+    controld_begin_ack_batch();
+    for (xmlNode *rsc_op = pcmk__xe_first_child(ops, PCMK__XE_RSC_OP, NULL,
+                                                NULL);
+         rsc_op != NULL; rsc_op = pcmk__xe_next(rsc_op, PCMK__XE_RSC_OP)) {
+
+        ha_msg_input_t fsa_input = {
+            .msg = request,
+            .xml = rsc_op,
+        };
+        fsa_data_t fsa_data = {
+            .id = 0,
+            .actions = 0,
+            .data = &fsa_input,
+            .fsa_input = I_MESSAGE,
+            .fsa_cause = C_IPC_MESSAGE,
+            .origin = __func__,
+            .data_type = fsa_dt_ha_msg,
+        };
+
+        do_lrm_invoke(A_LRM_INVOKE, C_IPC_MESSAGE, controld_globals.fsa_state,
+                      I_MESSAGE, &fsa_data);
+        count++;
+    }
+    controld_end_ack_batch();
+
+    crm_debug("Handled %d resource action%s from batched request",
+              count, pcmk__plural_s(count));
+    pcmk__xml_free(request);
+}
+
 static void
 send_msg_via_ipc(xmlNode * msg, const char *sys, const char *src)
 {
@@ -1315,6 +1372,12 @@ send_msg_via_ipc(xmlNode * msg, const char *sys, const char *src)
 
         process_te_message(msg, data);
 
+    } else if (pcmk__str_eq(sys, CRM_SYSTEM_LRMD, pcmk__str_none)
+               && pcmk__str_eq(crm_element_value(msg, PCMK__XA_CRM_TASK),
+                               PCMK__CONTROLD_CMD_INVOKE_BATCH,
+                               pcmk__str_none)) {
+        invoke_lrm_batch(msg);
+
     } else if (pcmk__str_eq(sys, CRM_SYSTEM_LRMD, pcmk__str_none)) {
         fsa_data_t fsa_data;
         ha_msg_input_t fsa_input;
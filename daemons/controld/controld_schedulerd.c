@@ -127,18 +127,32 @@ handle_reply(pcmk_schedulerd_api_reply_t *reply)
     if (msg_ref == NULL) {
         crm_err("%s - Ignoring calculation with no reference", CRM_OP_PECALC);
 
+    } else if (reply->reply_type == pcmk_schedulerd_reply_cancelled) {
+        if (pcmk__str_eq(msg_ref, controld_globals.fsa_pe_ref,
+                         pcmk__str_none)) {
+            /* We only ever supersede a calculation we no longer want, so this
+             * shouldn't happen, but don't wait for a graph that isn't coming
+             */
+            crm_warn("%s calculation %s was unexpectedly abandoned",
+                     CRM_OP_PECALC, msg_ref);
+            controld_expect_sched_reply(NULL);
+            register_fsa_input(C_FSA_INTERNAL, I_PE_CALC, NULL);
+        } else {
+            crm_debug("%s calculation %s was abandoned by the scheduler",
+                      CRM_OP_PECALC, msg_ref);
+        }
+
     } else if (pcmk__str_eq(msg_ref, controld_globals.fsa_pe_ref,
                             pcmk__str_none)) {
         ha_msg_input_t fsa_input;
-        xmlNode *crm_data_node;
+        pcmk__graph_t *graph = NULL;
 
         controld_stop_sched_timer();
 
-        /* do_te_invoke (which will eventually process the fsa_input we are constructing
-         * here) requires that fsa_input.xml be non-NULL.  That will only happen if
-         * copy_ha_msg_input (which is called by register_fsa_input_adv) sees the
-         * fsa_input.msg that it is expecting. The scheduler's IPC dispatch function
-         * gave us the values we need, we just need to put them into XML.
+        /* do_te_invoke (which will eventually process the fsa_input we are
+         * constructing here) needs the reference and graph input. The
+         * scheduler's IPC dispatch function gave us the values we need, we just
+         * need to put them into XML.
          *
          * The name of the top level element here is irrelevant.  Nothing checks it.
          */
@@ -147,8 +161,23 @@ handle_reply(pcmk_schedulerd_api_reply_t *reply)
         crm_xml_add(fsa_input.msg, PCMK__XA_CRM_TGRAPH_IN,
                     reply->data.graph.input);
 
-        crm_data_node = pcmk__xe_create(fsa_input.msg, PCMK__XE_CRM_XML);
-        pcmk__xml_copy(crm_data_node, reply->data.graph.tgraph);
+        /* Unpack the graph straight from the parsed reply, rather than copying
+         * the graph XML into the FSA input (which register_fsa_input_later()
+         * would copy again) just to unpack it later. If that fails, pass the
+         * XML along as before so do_te_invoke() handles the problem.
+         */
+        if (reply->data.graph.tgraph != NULL) {
+            graph = pcmk__unpack_graph(reply->data.graph.tgraph,
+                                       reply->data.graph.input);
+        }
+        if (graph != NULL) {
+            controld_set_unpacked_graph(msg_ref, graph);
+        } else {
+            xmlNode *crm_data_node = pcmk__xe_create(fsa_input.msg,
+                                                     PCMK__XE_CRM_XML);
+
+            pcmk__xml_copy(crm_data_node, reply->data.graph.tgraph);
+        }
         register_fsa_input_later(C_IPC_MESSAGE, I_PE_SUCCESS, &fsa_input);
 
         pcmk__xml_free(fsa_input.msg);
@@ -359,11 +388,27 @@ do_pe_invoke(long long action,
         return;
     }
 
+    // The scheduler must see the results of any fencing so far
+    controld_flush_fencing_updates();
+
     fsa_pe_query = cib_conn->cmds->query(cib_conn, NULL, NULL, cib_none);
 
     crm_debug("Query %d: Requesting the current CIB: %s", fsa_pe_query,
               fsa_state2string(controld_globals.fsa_state));
 
+    /* Any calculation still in progress is now obsolete, so let the scheduler
+     * stop working on it rather than wait for the new CIB query to complete
+     */
+    if ((controld_globals.fsa_pe_ref != NULL)
+        && mainloop_timer_running(controld_sched_timer)) {
+        int rc = pcmk_schedulerd_api_cancel(schedulerd_api,
+                                            controld_globals.fsa_pe_ref);
+
+        if (rc != pcmk_rc_ok) {
+            crm_debug("Could not cancel %s calculation %s: %s", CRM_OP_PECALC,
+                      controld_globals.fsa_pe_ref, pcmk_rc_str(rc));
+        }
+    }
     controld_expect_sched_reply(NULL);
     fsa_register_cib_callback(fsa_pe_query, NULL, do_pe_invoke_callback);
 }
@@ -22,6 +22,7 @@
 static GHashTable *te_targets = NULL;
 void send_rsc_command(pcmk__graph_action_t *action);
 static void te_update_job_count(pcmk__graph_action_t *action, int offset);
+static bool te_peer_accepts_batches(const char *target);
 
 static void
 te_start_action_timer(const pcmk__graph_t *graph, pcmk__graph_action_t *action)
@@ -335,6 +336,110 @@ controld_record_action_timeout(pcmk__graph_action_t *action)
     lrmd_free_event(op);
 }
 
+/* Resource actions to be executed by peers that accept batched requests are
+ * collected while the transition graph is executed, then sent as one message
+ * per peer (split if there are more than MAX_BATCH_ACTIONS).
+ */
+#define MAX_BATCH_ACTIONS 64
+
+static pcmk__action_batches_t *action_batches = NULL;
+
+static pcmk__metric_t message_metric =
+    PCMK__METRIC(pcmk__metric_counter, "controld_rsc_action_messages",
+                 "Messages sent to peer controllers to initiate resource "
+                 "actions");
+static pcmk__metric_t batch_size_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "controld_rsc_action_batch_size",
+                 "Number of resource actions per message sent to a peer "
+                 "controller");
+
+/*!
+ * \internal
+ * \brief Fail the actions in a batch that could not be sent
+ *
+ * \param[in,out] actions  Graph actions that could not be sent
+ */
+static void
+fail_action_batch(GList *actions)
+{
+    pcmk__graph_t *graph = controld_globals.transition_graph;
+
+    for (GList *iter = actions; iter != NULL; iter = iter->next) {
+        pcmk__graph_action_t *action = iter->data;
+
+        crm_err("Action %d failed: send", action->id);
+        stop_te_timer(action);
+        pcmk__set_graph_action_flags(action, pcmk__graph_action_failed);
+        te_action_confirmed(action, graph);
+    }
+    abort_transition(PCMK_SCORE_INFINITY, pcmk__graph_restart,
+                     "Action send failed", NULL);
+}
+
+/*!
+ * \internal
+ * \brief Send a batch of resource actions to a peer controller
+ *
+ * \param[in]     router_node  Node whose controller will execute the actions
+ * \param[in,out] ops          \c PCMK__XE_RSC_OPS with the actions' XML
+ * \param[in,out] actions      Graph actions in batch
+ * \param[in]     count        Number of actions in batch
+ * \param[in,out] user_data    Ignored
+ */
+static void
+send_action_batch(const char *router_node, xmlNode *ops, GList *actions,
+                  guint count, void *user_data)
+{
+    const pcmk__node_status_t *node = NULL;
+    xmlNode *cmd = NULL;
+
+    node = pcmk__get_node(0, router_node, NULL,
+                          pcmk__node_search_cluster_member);
+    cmd = pcmk__new_request(pcmk_ipc_controld, CRM_SYSTEM_TENGINE,
+                            router_node, CRM_SYSTEM_LRMD,
+                            PCMK__CONTROLD_CMD_INVOKE_BATCH, ops);
+
+    crm_debug("Sending %u resource action%s to %s in one request",
+              count, pcmk__plural_s(count), router_node);
+
+    if (pcmk__cluster_send_message(node, pcmk_ipc_execd, cmd)) {
+        pcmk__metric_add(&message_metric, 1);
+        pcmk__metric_observe(&batch_size_metric, count);
+    } else {
+        fail_action_batch(actions);
+    }
+    pcmk__xml_free(cmd);
+}
+
+/*!
+ * \internal
+ * \brief Add a resource action to the batch for its peer controller
+ *
+ * \param[in]     router_node  Node whose controller will execute \p action
+ * \param[in,out] action       Resource action to add (with transition key)
+ */
+static void
+batch_rsc_action(const char *router_node, pcmk__graph_action_t *action)
+{
+    if (action_batches == NULL) {
+        action_batches = pcmk__action_batches_new(MAX_BATCH_ACTIONS,
+                                                  send_action_batch, NULL);
+    }
+    pcmk__batch_graph_action(action_batches, router_node, action);
+}
+
+/*!
+ * \internal
+ * \brief Send all batched resource actions to their peer controllers
+ *
+ * This should be called after each pass through the transition graph.
+ */
+void
+controld_send_action_batches(void)
+{
+    pcmk__send_action_batches(action_batches);
+}
+
 /*!
  * \internal
  * \brief Execute a resource action from a transition graph
@@ -404,13 +509,10 @@ execute_rsc_action(pcmk__graph_t *graph, pcmk__graph_action_t *action)
                task, task_uuid, (is_local? " locally" : ""), on_node,
                (no_wait? " without waiting" : ""), action->id);
 
-    cmd = pcmk__new_request(pcmk_ipc_controld, CRM_SYSTEM_TENGINE, router_node,
-                            CRM_SYSTEM_LRMD, CRM_OP_INVOKE_LRM, rsc_op);
-
     if (is_local) {
         /* shortcut local resource commands */
         ha_msg_input_t data = {
-            .msg = cmd,
+            .msg = NULL,    // Set below
             .xml = rsc_op,
         };
 
@@ -424,15 +526,30 @@ execute_rsc_action(pcmk__graph_t *graph, pcmk__graph_action_t *action)
             .origin = __func__,
         };
 
+        cmd = pcmk__new_request(pcmk_ipc_controld, CRM_SYSTEM_TENGINE,
+                                router_node, CRM_SYSTEM_LRMD,
+                                CRM_OP_INVOKE_LRM, rsc_op);
+        data.msg = cmd;
         do_lrm_invoke(A_LRM_INVOKE, C_FSA_INTERNAL, controld_globals.fsa_state,
                       I_NULL, &msg);
 
+    } else if (te_peer_accepts_batches(router_node)) {
+        // Failure to send will be handled when the batch is sent
+        batch_rsc_action(router_node, action);
+
     } else {
         const pcmk__node_status_t *node =
             pcmk__get_node(0, router_node, NULL,
                            pcmk__node_search_cluster_member);
 
+        cmd = pcmk__new_request(pcmk_ipc_controld, CRM_SYSTEM_TENGINE,
+                                router_node, CRM_SYSTEM_LRMD,
+                                CRM_OP_INVOKE_LRM, rsc_op);
         rc = pcmk__cluster_send_message(node, pcmk_ipc_execd, cmd);
+        if (rc) {
+            pcmk__metric_add(&message_metric, 1);
+            pcmk__metric_observe(&batch_size_metric, 1);
+        }
     }
 
     free(counter);
@@ -474,6 +591,7 @@ struct te_peer_s
         char *name;
         int jobs;
         int migrate_jobs;
+        bool accepts_batches;
 };
 
 static void te_peer_free(gpointer p)
@@ -500,13 +618,13 @@ void te_reset_job_counts(void)
     }
 }
 
-static void
-te_update_job_count_on(const char *target, int offset, bool migrate)
+static struct te_peer_s *
+te_get_peer(const char *target)
 {
     struct te_peer_s *r = NULL;
 
-    if(target == NULL || te_targets == NULL) {
-        return;
+    if (te_targets == NULL) {
+        te_targets = pcmk__strkey_table(NULL, te_peer_free);
     }
 
     r = g_hash_table_lookup(te_targets, target);
@@ -515,7 +633,45 @@ te_update_job_count_on(const char *target, int offset, bool migrate)
         r->name = pcmk__str_copy(target);
         g_hash_table_insert(te_targets, r->name, r);
     }
+    return r;
+}
+
+/*!
+ * \internal
+ * \brief Record whether a peer controller accepts batched action requests
+ *
+ * \param[in] target    Name of peer
+ * \param[in] accepts   Whether peer accepts batched requests
+ */
+void
+controld_set_peer_accepts_batches(const char *target, bool accepts)
+{
+    CRM_CHECK(target != NULL, return);
+    te_get_peer(target)->accepts_batches = accepts;
+}
+
+static bool
+te_peer_accepts_batches(const char *target)
+{
+    struct te_peer_s *r = NULL;
+
+    if ((target == NULL) || (te_targets == NULL)) {
+        return false;
+    }
+    r = g_hash_table_lookup(te_targets, target);
+    return (r != NULL) && r->accepts_batches;
+}
+
+static void
+te_update_job_count_on(const char *target, int offset, bool migrate)
+{
+    struct te_peer_s *r = NULL;
+
+    if(target == NULL || te_targets == NULL) {
+        return;
+    }
 
+    r = te_get_peer(target);
     r->jobs += offset;
     if(migrate) {
         r->migrate_jobs += offset;
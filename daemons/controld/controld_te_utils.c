@@ -68,6 +68,7 @@ te_graph_trigger(gpointer user_data)
         controld_globals.transition_graph->batch_limit = throttled_limit;
         graph_rc = pcmk__execute_graph(controld_globals.transition_graph);
         controld_globals.transition_graph->batch_limit = orig_limit;
+        controld_send_action_batches();
 
         if (graph_rc == pcmk__graph_active) {
             crm_trace("Transition not yet complete");
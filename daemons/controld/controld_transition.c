@@ -14,6 +14,58 @@
 
 #include <pacemaker-controld.h>
 
+// Graph unpacked from a scheduler reply, and the calculation it came from
+static pcmk__graph_t *unpacked_graph = NULL;
+static char *unpacked_ref = NULL;
+
+/*!
+ * \internal
+ * \brief Free any transition graph unpacked from a scheduler reply
+ */
+void
+controld_free_unpacked_graph(void)
+{
+    pcmk__free_graph(unpacked_graph);
+    unpacked_graph = NULL;
+    free(unpacked_ref);
+    unpacked_ref = NULL;
+}
+
+/*!
+ * \internal
+ * \brief Save a transition graph unpacked from a scheduler reply
+ *
+ * The scheduler reply has already been parsed, so the graph can be unpacked
+ * directly from it, rather than copying the graph XML into an FSA input only
+ * for A_TE_INVOKE to unpack it later. A_TE_INVOKE for the same calculation will
+ * use the saved graph.
+ *
+ * \param[in]     ref    Reference of scheduler calculation that produced graph
+ * \param[in,out] graph  Unpacked graph (this takes ownership)
+ */
+void
+controld_set_unpacked_graph(const char *ref, pcmk__graph_t *graph)
+{
+    controld_free_unpacked_graph();
+    unpacked_graph = graph;
+    unpacked_ref = pcmk__str_copy(ref);
+}
+
+/*!
+ * \internal
+ * \brief Check whether a saved unpacked graph is for a given calculation
+ *
+ * \param[in] ref  Reference of scheduler calculation
+ *
+ * \return true if a graph unpacked from the reply to \p ref is saved
+ */
+static bool
+have_unpacked_graph(const char *ref)
+{
+    return (unpacked_graph != NULL)
+           && pcmk__str_eq(ref, unpacked_ref, pcmk__str_none);
+}
+
 static pcmk__graph_t *
 create_blank_graph(void)
 {
@@ -38,11 +90,14 @@ do_te_control(long long action,
     if (pcmk_is_set(action, A_TE_STOP)) {
         pcmk__free_graph(controld_globals.transition_graph);
         controld_globals.transition_graph = NULL;
+        controld_free_unpacked_graph();
 
         if (cib_conn != NULL) {
             cib_conn->cmds->del_notify_callback(cib_conn,
                                                 PCMK__VALUE_CIB_DIFF_NOTIFY,
                                                 te_update_diff);
+            cib_conn->cmds->del_notify_callback(cib_conn,
+                PCMK__VALUE_CIB_DIFF_NOTIFY, controld_check_unsafe_cib_change);
         }
 
         controld_clear_fsa_input_flags(R_TE_CONNECTED);
@@ -76,6 +131,12 @@ do_te_control(long long action,
                                                    te_update_diff) != pcmk_ok) {
         crm_err("Could not set CIB notification callback");
         init_ok = FALSE;
+
+    } else if (cib_conn->cmds->add_notify_callback(cib_conn,
+                   PCMK__VALUE_CIB_DIFF_NOTIFY,
+                   controld_check_unsafe_cib_change) != pcmk_ok) {
+        crm_err("Could not set CIB notification callback (join check)");
+        init_ok = FALSE;
     }
 
     if (init_ok) {
@@ -129,7 +190,7 @@ do_te_invoke(long long action,
         const char *graph_input = crm_element_value(input->msg,
                                                     PCMK__XA_CRM_TGRAPH_IN);
 
-        if (graph_data == NULL) {
+        if ((graph_data == NULL) && !have_unpacked_graph(ref)) {
             crm_log_xml_err(input->msg, "Bad command");
             register_fsa_error(C_FSA_INTERNAL, I_FAIL, NULL);
             return;
@@ -157,14 +218,20 @@ do_te_invoke(long long action,
             return;
         }
 
-        CRM_CHECK(graph_data != NULL,
+        CRM_CHECK((graph_data != NULL) || have_unpacked_graph(ref),
                   crm_err("Input raised by %s is invalid", msg_data->origin);
                   crm_log_xml_err(input->msg, "Bad command");
                   return);
 
         pcmk__free_graph(controld_globals.transition_graph);
-        controld_globals.transition_graph = pcmk__unpack_graph(graph_data,
-                                                               graph_input);
+        if (have_unpacked_graph(ref)) {
+            controld_globals.transition_graph = unpacked_graph;
+            unpacked_graph = NULL;
+        } else {
+            controld_globals.transition_graph = pcmk__unpack_graph(graph_data,
+                                                                   graph_input);
+        }
+        controld_free_unpacked_graph();
         CRM_CHECK(controld_globals.transition_graph != NULL,
                   controld_globals.transition_graph = create_blank_graph();
                   return);
@@ -8,6 +8,8 @@
 #ifndef TENGINE__H
 #define TENGINE__H
 
+#include <stdbool.h>                // bool
+
 #include <glib.h>                   // gboolean
 #include <libxml/tree.h>            // xmlNode
 
@@ -49,6 +51,9 @@ void te_update_diff(const char *event, xmlNode *msg);
 void controld_init_transition_trigger(void);
 void controld_destroy_transition_trigger(void);
 
+void controld_set_unpacked_graph(const char *ref, pcmk__graph_t *graph);
+void controld_free_unpacked_graph(void);
+
 void controld_trigger_graph_as(const char *fn, int line);
 void abort_after_delay(int abort_priority, enum pcmk__graph_next abort_action,
                        const char *abort_text, guint delay_ms);
@@ -65,5 +70,7 @@ void abort_transition_graph(int abort_priority,
 
 void te_action_confirmed(pcmk__graph_action_t *action, pcmk__graph_t *graph);
 void te_reset_job_counts(void);
+void controld_set_peer_accepts_batches(const char *target, bool accepts);
+void controld_send_action_batches(void);
 
 #endif
@@ -22,6 +22,7 @@
 #include <crm/cib.h>
 #include <crm/cib/internal.h>
 #include <crm/lrmd.h>
+#include <crm/lrmd_internal.h>
 
 #define SUMMARY "cts-exec-helper - inject commands into the Pacemaker executor and watch for events"
 
@@ -52,6 +53,9 @@ static struct {
     const char *listen;
     gboolean use_tls;
     lrmd_key_value_t *params;
+    uint32_t filter_flags;
+    GList *filter_rscs;
+    GList *filter_actions;
 } options;
 
 static gboolean
@@ -88,6 +92,38 @@ param_key_val_cb(const gchar *option_name, const gchar *optarg, gpointer data, G
     return TRUE;
 }
 
+static gboolean
+filter_cb(const gchar *option_name, const gchar *optarg, gpointer data,
+          GError **error)
+{
+    if (pcmk__str_eq(option_name, "--filter-rsc", pcmk__str_none)) {
+        options.filter_rscs = g_list_append(options.filter_rscs,
+                                            pcmk__str_copy(optarg));
+
+    } else if (pcmk__str_eq(option_name, "--filter-action", pcmk__str_none)) {
+        options.filter_actions = g_list_append(options.filter_actions,
+                                               pcmk__str_copy(optarg));
+
+    } else if (pcmk__str_eq(optarg, "ok", pcmk__str_none)) {
+        options.filter_flags |= lrmd__notify_exec_ok;
+
+    } else if (pcmk__str_eq(optarg, "failed", pcmk__str_none)) {
+        options.filter_flags |= lrmd__notify_exec_failed;
+
+    } else if (pcmk__str_eq(optarg, "rsc", pcmk__str_none)) {
+        options.filter_flags |= lrmd__notify_rsc_changes;
+
+    } else if (pcmk__str_eq(optarg, "connection", pcmk__str_none)) {
+        options.filter_flags |= lrmd__notify_connection;
+
+    } else {
+        g_set_error(error, PCMK__EXITC_ERROR, CRM_EX_USAGE,
+                    "Invalid notification class '%s'", optarg);
+        return FALSE;
+    }
+    return TRUE;
+}
+
 static GOptionEntry basic_entries[] = {
     { "api-call", 'c', 0, G_OPTION_ARG_STRING, &options.api_call,
       "Directly relates to executor API functions",
@@ -117,6 +153,19 @@ static GOptionEntry basic_entries[] = {
       "Use TLS backend for local connection",
       NULL },
 
+    { "filter-rsc", 0, 0, G_OPTION_ARG_CALLBACK, filter_cb,
+      "Only receive notifications about this resource (may be repeated)",
+      "RSC" },
+
+    { "filter-action", 0, 0, G_OPTION_ARG_CALLBACK, filter_cb,
+      "Only receive results of this action (may be repeated)",
+      "ACTION" },
+
+    { "filter-class", 0, 0, G_OPTION_ARG_CALLBACK, filter_cb,
+      "Only receive this class of notifications: ok, failed, rsc, or "
+      "connection (may be repeated)",
+      "CLASS" },
+
     { NULL }
 };
 
@@ -165,6 +214,8 @@ static char event_buf_v0[1024];
 static crm_exit_t
 test_exit(crm_exit_t exit_code)
 {
+    g_list_free_full(options.filter_rscs, free);
+    g_list_free_full(options.filter_actions, free);
     lrmd_api_delete(lrmd_conn);
     return crm_exit(exit_code);
 }
@@ -280,6 +331,23 @@ start_test(gpointer user_data)
     }
     lrmd_conn->cmds->set_callback(lrmd_conn, read_events);
 
+    if ((options.filter_flags != 0) || (options.filter_rscs != NULL)
+        || (options.filter_actions != NULL)) {
+
+        uint32_t flags = options.filter_flags;
+
+        if (flags == 0) {
+            flags = lrmd__notify_all;
+        }
+        rc = lrmd__set_notify_filter(lrmd_conn, flags, options.filter_rscs,
+                                     options.filter_actions);
+        if (rc != pcmk_rc_ok) {
+            print_result("API-CALL FAILURE for 'notify_filter': %s",
+                         pcmk_rc_str(rc));
+            test_exit(CRM_EX_ERROR);
+        }
+    }
+
     if (options.timeout) {
         pcmk__create_timer(options.timeout, timeout_err, NULL);
     }
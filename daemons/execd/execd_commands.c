@@ -19,6 +19,8 @@
 #  include <time.h>  /* clock_gettime */
 #endif
 
+#include <inttypes.h>    // PRIx32
+#include <stdint.h>      // uint32_t, UINT32_MAX
 #include <unistd.h>
 
 #include <crm/crm.h>
@@ -29,6 +31,7 @@
 #include <crm/common/ipc.h>
 #include <crm/common/ipc_internal.h>
 #include <crm/common/xml.h>
+#include <crm/lrmd_internal.h>
 
 #include "pacemaker-execd.h"
 
@@ -89,6 +92,8 @@ typedef struct lrmd_cmd_s {
     time_t epoch_last_run;          // Epoch timestamp of when op last ran
     time_t epoch_rcchange;          // Epoch timestamp of when rc last changed
 
+    pcmk__rusage_t rusage;          // Resource usage of agent's last run
+
     bool first_notify_sent;
     int last_notify_rc;
     int last_notify_op_status;
@@ -549,10 +554,262 @@ create_lrmd_reply(const char *origin, int rc, int call_id)
     return reply;
 }
 
+// Which notifications an executor client wants (stored as client userdata)
+typedef struct {
+    uint32_t flags;         // Group of enum lrmd__notify_flags
+    GHashTable *rsc_ids;    // Resource IDs wanted (or NULL for all)
+    GHashTable *actions;    // Action names wanted (or NULL for all)
+} notify_filter_t;
+
+// A notification being sent to all interested clients
+struct notification_s {
+    xmlNode *xml;           // Notification to send
+    struct iovec *iov;      // IPC event prepared from xml (once needed)
+    bool iov_failed;        // Whether preparing iov failed
+    uint32_t class;         // Notification class (enum lrmd__notify_flags)
+    const char *rsc_id;     // Resource that notification is about (if any)
+    const char *action;     // Action that notification is a result of (if any)
+};
+
+static pcmk__metric_t notify_sent_metric =
+    PCMK__METRIC(pcmk__metric_counter, "execd_notifications_sent_total",
+                 "Notifications sent to executor clients");
+
+static pcmk__metric_t notify_filtered_metric =
+    PCMK__METRIC(pcmk__metric_counter, "execd_notifications_filtered_total",
+                 "Notifications not sent to executor clients because of "
+                 "their notification filters");
+
+/*!
+ * \internal
+ * \brief Free an executor client's notification filter
+ *
+ * \param[in,out] client  Client to free filter for
+ */
+void
+execd_free_notify_filter(pcmk__client_t *client)
+{
+    notify_filter_t *filter = client->userdata;
+
+    if (filter != NULL) {
+        if (filter->rsc_ids != NULL) {
+            g_hash_table_destroy(filter->rsc_ids);
+        }
+        if (filter->actions != NULL) {
+            g_hash_table_destroy(filter->actions);
+        }
+        free(filter);
+        client->userdata = NULL;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the set of values of an attribute of a filter's children
+ *
+ * \param[in] xml      Notification filter XML
+ * \param[in] element  Name of child elements to check
+ * \param[in] attr     Name of attribute to get from each child
+ *
+ * \return Newly allocated set of values (or \c NULL if there are none)
+ */
+static GHashTable *
+filter_values(const xmlNode *xml, const char *element, const char *attr)
+{
+    GHashTable *values = NULL;
+
+    for (const xmlNode *child = pcmk__xe_first_child(xml, element, NULL, NULL);
+         child != NULL; child = pcmk__xe_next(child, element)) {
+
+        const char *value = crm_element_value(child, attr);
+
+        if (value == NULL) {
+            continue;
+        }
+        if (values == NULL) {
+            values = pcmk__strkey_table(free, NULL);
+        }
+        g_hash_table_add(values, pcmk__str_copy(value));
+    }
+    return values;
+}
+
+/*!
+ * \internal
+ * \brief Set (or clear) an executor client's notification filter
+ *
+ * \param[in,out] client   Client that sent request
+ * \param[in]     request  Notification filter request
+ *
+ * \return Legacy Pacemaker return code
+ * \note If \p request has no filter, the client receives all notifications.
+ */
+static int
+process_lrmd_notify_filter(pcmk__client_t *client, const xmlNode *request)
+{
+    const xmlNode *xml = pcmk__xe_first_child(request, PCMK__XE_LRMD_CALLDATA,
+                                              NULL, NULL);
+    notify_filter_t *filter = NULL;
+    long long flags = 0LL;
+
+    xml = pcmk__xe_first_child(xml, PCMK__XE_LRMD_NOTIFY_FILTER, NULL, NULL);
+    if (xml == NULL) {
+        execd_free_notify_filter(client);
+        crm_debug("Client %s wants all notifications",
+                  pcmk__client_name(client));
+        return pcmk_ok;
+    }
+
+    if ((crm_element_value_ll(xml, PCMK__XA_LRMD_NOTIFY_FLAGS, &flags) != 0)
+        || (flags < 0LL) || (flags > UINT32_MAX)) {
+        crm_warn("Ignoring invalid notification filter from client %s",
+                 pcmk__client_name(client));
+        return -EINVAL;
+    }
+
+    filter = pcmk__assert_alloc(1, sizeof(notify_filter_t));
+    filter->flags = (uint32_t) flags;
+    filter->rsc_ids = filter_values(xml, PCMK__XE_LRMD_RSC,
+                                    PCMK__XA_LRMD_RSC_ID);
+    filter->actions = filter_values(xml, PCMK__XE_LRMD_RSC_OP,
+                                    PCMK__XA_LRMD_RSC_ACTION);
+
+    execd_free_notify_filter(client);
+    client->userdata = filter;
+    crm_debug("Client %s wants notifications of class %#.8" PRIx32 " for %s "
+              "resources and %s actions",
+              pcmk__client_name(client), filter->flags,
+              ((filter->rsc_ids == NULL)? "all" : "some"),
+              ((filter->actions == NULL)? "all" : "some"));
+    return pcmk_ok;
+}
+
+/*!
+ * \internal
+ * \brief Prepare a notification for sending to clients
+ *
+ * \param[out]    notification  Notification to initialize
+ * \param[in,out] xml           Notification XML
+ */
+static void
+init_notification(struct notification_s *notification, xmlNode *xml)
+{
+    const char *op = crm_element_value(xml, PCMK__XA_LRMD_OP);
+
+    notification->xml = xml;
+    notification->iov = NULL;
+    notification->iov_failed = false;
+    notification->class = 0;
+    notification->rsc_id = crm_element_value(xml, PCMK__XA_LRMD_RSC_ID);
+    notification->action = NULL;
+
+    if (pcmk__str_eq(op, LRMD_OP_RSC_EXEC, pcmk__str_none)) {
+        int exec_rc = PCMK_OCF_UNKNOWN_ERROR;
+        int status = PCMK_EXEC_ERROR;
+
+        crm_element_value_int(xml, PCMK__XA_LRMD_EXEC_RC, &exec_rc);
+        crm_element_value_int(xml, PCMK__XA_LRMD_EXEC_OP_STATUS, &status);
+        if ((exec_rc == PCMK_OCF_OK) && (status == PCMK_EXEC_DONE)) {
+            notification->class = lrmd__notify_exec_ok;
+        } else {
+            notification->class = lrmd__notify_exec_failed;
+        }
+        notification->action = crm_element_value(xml,
+                                                 PCMK__XA_LRMD_RSC_ACTION);
+
+    } else if (pcmk__str_any_of(op, LRMD_OP_RSC_REG, LRMD_OP_RSC_UNREG,
+                                NULL)) {
+        notification->class = lrmd__notify_rsc_changes;
+
+    } else if (pcmk__str_any_of(op, LRMD_OP_POKE, LRMD_OP_NEW_CLIENT, NULL)) {
+        notification->class = lrmd__notify_connection;
+    }
+}
+
+static void
+clear_notification(struct notification_s *notification)
+{
+    pcmk_free_ipc_event(notification->iov);
+    notification->iov = NULL;
+}
+
+/*!
+ * \internal
+ * \brief Check whether a client's notification filter selects a notification
+ *
+ * \param[in] client        Client to check
+ * \param[in] notification  Notification to check
+ *
+ * \return true if \p client wants \p notification, otherwise false
+ */
+static bool
+notification_wanted(const pcmk__client_t *client,
+                    const struct notification_s *notification)
+{
+    const notify_filter_t *filter = client->userdata;
+
+    if ((filter == NULL) || (notification->class == 0)) {
+        return true; // No filter, or something no filter class covers
+    }
+    if (!pcmk_is_set(filter->flags, notification->class)) {
+        return false;
+    }
+    if (notification->class == lrmd__notify_connection) {
+        return true; // Not about any resource
+    }
+    if ((filter->rsc_ids != NULL)
+        && ((notification->rsc_id == NULL)
+            || !g_hash_table_contains(filter->rsc_ids,
+                                      notification->rsc_id))) {
+        return false;
+    }
+    if ((filter->actions != NULL) && (notification->action != NULL)
+        && !g_hash_table_contains(filter->actions, notification->action)) {
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Send a notification to a local client
+ *
+ * The notification is serialized once, the first time it is sent to an IPC
+ * client, and the result is shared with every other IPC client.
+ *
+ * \param[in,out] client        Client to notify
+ * \param[in,out] notification  Notification to send
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+send_notification(pcmk__client_t *client, struct notification_s *notification)
+{
+    if ((PCMK__CLIENT_TYPE(client) != pcmk__client_ipc)
+        || (client->ipcs == NULL) || notification->iov_failed) {
+        return lrmd_server_send_notify(client, notification->xml);
+    }
+
+    if (notification->iov == NULL) {
+        int rc = pcmk__ipc_prepare_iov(0, notification->xml,
+                                       crm_ipc_default_buffer_size(),
+                                       &(notification->iov), NULL);
+
+        if (rc != pcmk_rc_ok) {
+            pcmk_free_ipc_event(notification->iov);
+            notification->iov = NULL;
+            notification->iov_failed = true;
+            return lrmd_server_send_notify(client, notification->xml);
+        }
+    }
+    crm_trace("Sending notification to client (%s)", client->id);
+    return pcmk__ipc_send_iov(client, notification->iov, crm_ipc_server_event);
+}
+
 static void
 send_client_notify(gpointer key, gpointer value, gpointer user_data)
 {
-    xmlNode *update_msg = user_data;
+    struct notification_s *notification = user_data;
     pcmk__client_t *client = value;
     int rc;
     int log_level = LOG_WARNING;
@@ -572,9 +829,16 @@ send_client_notify(gpointer key, gpointer value, gpointer user_data)
                   pcmk__client_name(client));
         return;
     }
+    if (!notification_wanted(client, notification)) {
+        crm_trace("Skipping notification to client %s: filtered out",
+                  pcmk__client_name(client));
+        pcmk__metric_add(&notify_filtered_metric, 1);
+        return;
+    }
 
-    rc = lrmd_server_send_notify(client, update_msg);
+    rc = send_notification(client, notification);
     if (rc == pcmk_rc_ok) {
+        pcmk__metric_add(&notify_sent_metric, 1);
         return;
     }
 
@@ -593,10 +857,39 @@ send_client_notify(gpointer key, gpointer value, gpointer user_data)
                pcmk__client_name(client), msg, rc);
 }
 
+/*!
+ * \internal
+ * \brief Add an agent's resource usage to an executor notification
+ *
+ * \param[in,out] notify  Notification XML to add to
+ * \param[in]     usage   Resource usage to add (values of 0 are omitted)
+ */
+static void
+add_rusage(xmlNode *notify, const pcmk__rusage_t *usage)
+{
+    if (usage->user_ms > 0) {
+        crm_xml_add_ll(notify, PCMK__XA_LRMD_CPU_USER_TIME, usage->user_ms);
+    }
+    if (usage->system_ms > 0) {
+        crm_xml_add_ll(notify, PCMK__XA_LRMD_CPU_SYSTEM_TIME,
+                       usage->system_ms);
+    }
+    if (usage->max_rss_kb > 0) {
+        crm_xml_add_ll(notify, PCMK__XA_LRMD_MAX_RSS, usage->max_rss_kb);
+    }
+    if (usage->blocks_in > 0) {
+        crm_xml_add_ll(notify, PCMK__XA_LRMD_BLOCKS_IN, usage->blocks_in);
+    }
+    if (usage->blocks_out > 0) {
+        crm_xml_add_ll(notify, PCMK__XA_LRMD_BLOCKS_OUT, usage->blocks_out);
+    }
+}
+
 static void
 send_cmd_complete_notify(lrmd_cmd_t * cmd)
 {
     xmlNode *notify = NULL;
+    struct notification_s notification;
     int exec_time = 0;
     int queue_time = 0;
 
@@ -640,6 +933,7 @@ send_cmd_complete_notify(lrmd_cmd_t * cmd)
     crm_xml_add_int(notify, PCMK__XA_LRMD_EXEC_TIME, exec_time);
     crm_xml_add_int(notify, PCMK__XA_LRMD_QUEUE_TIME, queue_time);
 #endif
+    add_rusage(notify, &(cmd->rusage));
 
     crm_xml_add(notify, PCMK__XA_LRMD_OP, LRMD_OP_RSC_EXEC);
     crm_xml_add(notify, PCMK__XA_LRMD_RSC_ID, cmd->rsc_id);
@@ -672,18 +966,20 @@ send_cmd_complete_notify(lrmd_cmd_t * cmd)
             hash2smartfield((gpointer) key, (gpointer) value, args);
         }
     }
+    init_notification(&notification, notify);
     if ((cmd->client_id != NULL)
         && pcmk_is_set(cmd->call_opts, lrmd_opt_notify_orig_only)) {
 
         pcmk__client_t *client = pcmk__find_client_by_id(cmd->client_id);
 
         if (client != NULL) {
-            send_client_notify(client->id, client, notify);
+            send_client_notify(client->id, client, &notification);
         }
     } else {
-        pcmk__foreach_ipc_client(send_client_notify, notify);
+        pcmk__foreach_ipc_client(send_client_notify, &notification);
     }
 
+    clear_notification(&notification);
     pcmk__xml_free(notify);
 }
 
@@ -693,6 +989,7 @@ send_generic_notify(int rc, xmlNode * request)
     if (pcmk__ipc_client_count() != 0) {
         int call_id = 0;
         xmlNode *notify = NULL;
+        struct notification_s notification;
         xmlNode *rsc_xml = get_xpath_object("//" PCMK__XE_LRMD_RSC, request,
                                             LOG_ERR);
         const char *rsc_id = crm_element_value(rsc_xml, PCMK__XA_LRMD_RSC_ID);
@@ -707,7 +1004,9 @@ send_generic_notify(int rc, xmlNode * request)
         crm_xml_add(notify, PCMK__XA_LRMD_OP, op);
         crm_xml_add(notify, PCMK__XA_LRMD_RSC_ID, rsc_id);
 
-        pcmk__foreach_ipc_client(send_client_notify, notify);
+        init_notification(&notification, notify);
+        pcmk__foreach_ipc_client(send_client_notify, &notification);
+        clear_notification(&notification);
 
         pcmk__xml_free(notify);
     }
@@ -767,7 +1066,7 @@ cmd_finalize(lrmd_cmd_t * cmd, lrmd_rsc_t * rsc)
 }
 
 struct notify_new_client_data {
-    xmlNode *notify;
+    struct notification_s notification;
     pcmk__client_t *new_client;
 };
 
@@ -778,7 +1077,7 @@ notify_one_client(gpointer key, gpointer value, gpointer user_data)
     struct notify_new_client_data *data = user_data;
 
     if (!pcmk__str_eq(client->id, data->new_client->id, pcmk__str_casei)) {
-        send_client_notify(key, (gpointer) client, (gpointer) data->notify);
+        send_client_notify(key, (gpointer) client, &(data->notification));
     }
 }
 
@@ -786,13 +1085,16 @@ void
 notify_of_new_client(pcmk__client_t *new_client)
 {
     struct notify_new_client_data data;
+    xmlNode *notify = pcmk__xe_create(NULL, PCMK__XE_LRMD_NOTIFY);
+
+    crm_xml_add(notify, PCMK__XA_LRMD_ORIGIN, __func__);
+    crm_xml_add(notify, PCMK__XA_LRMD_OP, LRMD_OP_NEW_CLIENT);
 
     data.new_client = new_client;
-    data.notify = pcmk__xe_create(NULL, PCMK__XE_LRMD_NOTIFY);
-    crm_xml_add(data.notify, PCMK__XA_LRMD_ORIGIN, __func__);
-    crm_xml_add(data.notify, PCMK__XA_LRMD_OP, LRMD_OP_NEW_CLIENT);
+    init_notification(&(data.notification), notify);
     pcmk__foreach_ipc_client(notify_one_client, &data);
-    pcmk__xml_free(data.notify);
+    clear_notification(&(data.notification));
+    pcmk__xml_free(notify);
 }
 
 void
@@ -837,6 +1139,7 @@ action_complete(svc_action_t * action)
 #endif
 
     cmd->last_pid = action->pid;
+    cmd->rusage = *services__rusage(action);
 
     // Cast variable instead of function return to keep compilers happy
     code = services_result2ocf(action->standard, cmd->action, action->rc);
@@ -1516,6 +1819,10 @@ process_lrmd_signon(pcmk__client_t *client, xmlNode *request, int call_id,
             // This is a remote connection from a cluster node's controller
             ipc_proxy_add_provider(client);
 
+            if (pcmk__xe_attr_is_true(request, PCMK__XA_LRMD_PROXY_FRAMES)) {
+                pcmk__set_client_flags(client, pcmk__client_proxy_frames);
+            }
+
             /* If this was a register operation, also ask for new schema files but
              * only if it's supported by the protocol version.
              */
@@ -1541,6 +1848,10 @@ process_lrmd_signon(pcmk__client_t *client, xmlNode *request, int call_id,
         crm_xml_add(*reply, PCMK__XA_NODE_START_STATE, start_state);
     }
 
+    if (pcmk_is_set(client->flags, pcmk__client_proxy_frames)) {
+        pcmk__xe_set_bool_attr(*reply, PCMK__XA_LRMD_PROXY_FRAMES, true);
+    }
+
     return rc;
 }
 
@@ -1940,6 +2251,12 @@ process_lrmd_message(pcmk__client_t *client, uint32_t id, xmlNode *request)
             rc = -EACCES;
         }
         do_reply = 1;
+    } else if (pcmk__str_eq(op, LRMD_OP_NOTIFY_FILTER, pcmk__str_none)) {
+        /* Any client may limit its own notifications, since that gives it
+         * nothing it couldn't already see
+         */
+        rc = process_lrmd_notify_filter(client, request);
+        do_reply = 1;
     } else {
         rc = -EOPNOTSUPP;
         do_reply = 1;
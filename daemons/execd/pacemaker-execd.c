@@ -139,6 +139,11 @@ lrmd_ipc_dispatch(qb_ipcs_connection_t * c, void *data, size_t size)
         return 0;
     }
 
+    if (pcmk__ipc_handle_common_request(client, id, flags, request)) {
+        pcmk__xml_free(request);
+        return 0;
+    }
+
     if (!client->name) {
         const char *value = crm_element_value(request,
                                               PCMK__XA_LRMD_CLIENTNAME);
@@ -174,6 +179,7 @@ lrmd_ipc_dispatch(qb_ipcs_connection_t * c, void *data, size_t size)
 void
 lrmd_client_destroy(pcmk__client_t *client)
 {
+    execd_free_notify_filter(client);
     pcmk__free_client(client);
 
 #ifdef PCMK__COMPILE_REMOTE
@@ -12,6 +12,7 @@
 
 #  include <glib.h>
 #  include <crm/common/ipc_internal.h>
+#  include <crm/common/remote_internal.h>
 #  include <crm/lrmd.h>
 #  include <crm/stonith-ng.h>
 
@@ -75,6 +76,8 @@ void lrmd_client_destroy(pcmk__client_t *client);
 
 void client_disconnect_cleanup(const char *client_id);
 
+void execd_free_notify_filter(pcmk__client_t *client);
+
 /*!
  * \brief Don't worry about freeing this connection. It is
  *        taken care of after mainloop exits by the main() function.
@@ -94,6 +97,8 @@ void ipc_proxy_cleanup(void);
 void ipc_proxy_add_provider(pcmk__client_t *client);
 void ipc_proxy_remove_provider(pcmk__client_t *client);
 void ipc_proxy_forward_client(pcmk__client_t *client, xmlNode *xml);
+void ipc_proxy_forward_frame(pcmk__client_t *ipc_proxy,
+                             const pcmk__proxy_frame_t *frame);
 pcmk__client_t *ipc_proxy_get_provider(void);
 int ipc_proxy_shutdown_req(pcmk__client_t *ipc_proxy);
 void remoted_spawn_pidone(int argc, char **argv, char **envp);
@@ -218,6 +218,111 @@ ipc_proxy_forward_client(pcmk__client_t *ipc_proxy, xmlNode *xml)
     }
 }
 
+/*!
+ * \internal
+ * \brief Relay a proxy frame from an IPC provider to a local IPC client
+ *
+ * This is the equivalent of ipc_proxy_forward_client() for messages that the
+ * provider sent as binary frames rather than XML.
+ *
+ * \param[in,out] ipc_proxy  IPC provider that sent \p frame
+ * \param[in]     frame      Proxy frame received from \p ipc_proxy
+ */
+void
+ipc_proxy_forward_frame(pcmk__client_t *ipc_proxy,
+                        const pcmk__proxy_frame_t *frame)
+{
+    pcmk__client_t *ipc_client = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (!pcmk_all_flags_set(ipc_proxy->flags,
+                            pcmk__client_privileged
+                            |pcmk__client_proxy_frames)) {
+        crm_warn("Ignoring proxy frame from client %s that is not an IPC "
+                 "provider", pcmk__client_name(ipc_proxy));
+        return;
+    }
+
+    ipc_client = pcmk__find_client_by_id(frame->session);
+    if (ipc_client == NULL) {
+        xmlNode *msg = pcmk__xe_create(NULL, PCMK__XE_LRMD_IPC_PROXY);
+        crm_xml_add(msg, PCMK__XA_LRMD_IPC_OP, LRMD_IPC_OP_DESTROY);
+        crm_xml_add(msg, PCMK__XA_LRMD_IPC_SESSION, frame->session);
+        lrmd_server_send_notify(ipc_proxy, msg);
+        pcmk__xml_free(msg);
+        return;
+    }
+
+    switch (frame->op) {
+        case pcmk__proxy_event:
+            crm_trace("Sending event to %s", ipc_client->id);
+            rc = pcmk__ipc_send_text(ipc_client, 0, frame->payload,
+                                     crm_ipc_server_event);
+            break;
+
+        case pcmk__proxy_response:
+            crm_trace("Sending response to %d - %s",
+                      ipc_client->request_id, ipc_client->id);
+            rc = pcmk__ipc_send_text(ipc_client, frame->msg_id,
+                                     frame->payload, FALSE);
+            CRM_LOG_ASSERT(frame->msg_id == ipc_client->request_id);
+            ipc_client->request_id = 0;
+            break;
+
+        default:
+            crm_err("Unknown ipc proxy frame type %d", frame->op);
+            break;
+    }
+
+    if (rc != pcmk_rc_ok) {
+        crm_warn("Could not proxy IPC to client %s: %s " QB_XS " rc=%d",
+                 ipc_client->id, pcmk_rc_str(rc), rc);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Relay a local IPC client request to an IPC provider as a frame
+ *
+ * \param[in,out] client     Local IPC client that sent \p data
+ * \param[in,out] ipc_proxy  IPC provider to relay request to
+ * \param[in]     data       Request data read from \p client
+ */
+static void
+ipc_proxy_dispatch_frame(pcmk__client_t *client, pcmk__client_t *ipc_proxy,
+                         void *data)
+{
+    uint32_t id = 0;
+    uint32_t flags = 0;
+    char *text = pcmk__client_data2text(client, data, &id, &flags);
+    pcmk__proxy_frame_t frame = { 0, };
+    int rc = pcmk_rc_ok;
+
+    if (text == NULL) {
+        return;
+    }
+
+    // See ipc_proxy_dispatch()
+    pcmk__set_ipc_flags(flags, pcmk__client_name(client), crm_ipc_proxied);
+    client->request_id = id;
+
+    frame.op = pcmk__proxy_request;
+    frame.msg_id = id;
+    frame.ipc_flags = flags;
+    frame.session = client->id;
+    frame.client = pcmk__client_name(client);
+    frame.user = client->user;
+    frame.payload = text;
+    frame.payload_len = strlen(text) + 1;
+
+    rc = pcmk__remote_send_proxy_frame(ipc_proxy->remote, &frame);
+    if (rc != pcmk_rc_ok) {
+        crm_warn("Could not relay IPC request from client %s: %s "
+                 QB_XS " rc=%d", client->id, pcmk_rc_str(rc), rc);
+    }
+    free(text);
+}
+
 static int32_t
 ipc_proxy_dispatch(qb_ipcs_connection_t * c, void *data, size_t size)
 {
@@ -247,6 +352,13 @@ ipc_proxy_dispatch(qb_ipcs_connection_t * c, void *data, size_t size)
      * This function is receiving a request from connection
      * 1 and forwarding it to connection 2.
      */
+    if (pcmk_is_set(ipc_proxy->flags, pcmk__client_proxy_frames)
+        && (ipc_proxy->remote != NULL)) {
+        // Provider accepts the request text without an XML envelope
+        ipc_proxy_dispatch_frame(client, ipc_proxy, data);
+        return 0;
+    }
+
     request = pcmk__client_data2xml(client, data, &id, &flags);
 
     if (!request) {
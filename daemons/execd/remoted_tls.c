@@ -124,6 +124,16 @@ lrmd_remote_client_msg(gpointer data)
             return -1;
     }
 
+    if (pcmk__remote_message_is_proxy_frame(client->remote)) {
+        pcmk__proxy_frame_t frame = { 0, };
+
+        if (pcmk__remote_message_proxy_frame(client->remote,
+                                             &frame) == pcmk_rc_ok) {
+            ipc_proxy_forward_frame(client, &frame);
+        }
+        return 0;
+    }
+
     request = pcmk__remote_message_xml(client->remote);
     if (request == NULL) {
         return 0;
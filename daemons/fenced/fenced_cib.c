@@ -24,10 +24,35 @@
 
 #include <pacemaker-fenced.h>
 
+/* Local copy of the CIB, without resource operation history (which fenced
+ * doesn't use, and which accounts for most CIB changes)
+ */
 static xmlNode *local_cib = NULL;
 static cib_t *cib_api = NULL;
 static bool have_cib_devices = FALSE;
 
+/*!
+ * \internal
+ * \brief Remove resource operation history from a CIB
+ *
+ * \param[in,out] cib  CIB XML to prune
+ */
+static void
+prune_history(xmlNode *cib)
+{
+    xmlNode *status = pcmk__xe_first_child(cib, PCMK_XE_STATUS, NULL, NULL);
+
+    for (xmlNode *node_state = pcmk__xe_first_child(status,
+                                                    PCMK__XE_NODE_STATE, NULL,
+                                                    NULL);
+         node_state != NULL;
+         node_state = pcmk__xe_next(node_state, PCMK__XE_NODE_STATE)) {
+
+        pcmk__xml_free(pcmk__xe_first_child(node_state, PCMK__XE_LRM, NULL,
+                                            NULL));
+    }
+}
+
 /*!
  * \internal
  * \brief Check whether a node has a specific attribute name/value
@@ -358,6 +383,7 @@ fenced_query_cib(void)
     rc = pcmk_legacy2rc(rc);
     if (rc == pcmk_rc_ok) {
         pcmk__assert(local_cib != NULL);
+        prune_history(local_cib);
     } else {
         crm_err("Couldn't retrieve the CIB: %s " QB_XS " rc=%d",
                 pcmk_rc_str(rc), rc);
@@ -462,6 +488,8 @@ update_cib_cache_cb(const char *event, xmlNode * msg)
 {
     long long timeout_ms_saved = stonith_watchdog_timeout_ms;
     bool need_full_refresh = false;
+    bool nodes_changed = true;
+    bool options_changed = true;
 
     if(!have_cib_devices) {
         crm_trace("Skipping updates until we get a full dump");
@@ -479,6 +507,7 @@ update_cib_cache_cb(const char *event, xmlNode * msg)
         int rc = pcmk_ok;
         xmlNode *wrapper = NULL;
         xmlNode *patchset = NULL;
+        xmlNode *pruned = NULL;
 
         crm_element_value_int(msg, PCMK__XA_CIB_RC, &rc);
         if (rc != pcmk_ok) {
@@ -489,7 +518,28 @@ update_cib_cache_cb(const char *event, xmlNode * msg)
                                        NULL);
         patchset = pcmk__xe_first_child(wrapper, NULL, NULL, NULL);
 
-        rc = xml_apply_patchset(local_cib, patchset, TRUE);
+        /* Our copy has no operation history, so skip changes to it (which
+         * also means the patchset's digest can't be checked)
+         */
+        if (patchset != NULL) {
+            pruned = pcmk__patchset_without(patchset, PCMK__XE_LRM);
+        }
+        if (pruned != NULL) {
+            nodes_changed = pcmk__cib_element_in_patchset(pruned,
+                                                          PCMK_XE_NODES)
+                            || pcmk__cib_element_in_patchset(pruned,
+                                                             PCMK_XE_RESOURCES)
+                            || pcmk__cib_element_in_patchset(pruned,
+                                                             PCMK_XE_STATUS);
+            options_changed = pcmk__cib_element_in_patchset(pruned,
+                                                            PCMK_XE_CRM_CONFIG);
+            rc = xml_apply_patchset(local_cib, pruned, TRUE);
+            pcmk__xml_free(pruned);
+
+        } else if (patchset != NULL) {
+            rc = -EINVAL; // Unsupported patchset format
+        }
+
         switch (rc) {
             case pcmk_ok:
             case -pcmk_err_old_data:
@@ -512,10 +562,16 @@ update_cib_cache_cb(const char *event, xmlNode * msg)
             return;
         }
         need_full_refresh = true;
+        nodes_changed = true;
+        options_changed = true;
     }
 
-    pcmk__refresh_node_caches_from_cib(local_cib);
-    update_stonith_watchdog_timeout_ms(local_cib);
+    if (nodes_changed) {
+        pcmk__refresh_node_caches_from_cib(local_cib);
+    }
+    if (options_changed) {
+        update_stonith_watchdog_timeout_ms(local_cib);
+    }
 
     if (timeout_ms_saved != stonith_watchdog_timeout_ms) {
         need_full_refresh = true;
@@ -539,6 +595,7 @@ init_cib_cache_cb(xmlNode * msg, int call_id, int rc, xmlNode * output, void *us
     crm_info("Updating device list from CIB");
     have_cib_devices = TRUE;
     local_cib = pcmk__xml_copy(NULL, output);
+    prune_history(local_cib);
 
     pcmk__refresh_node_caches_from_cib(local_cib);
     update_stonith_watchdog_timeout_ms(local_cib);
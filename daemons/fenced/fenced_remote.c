@@ -1357,6 +1357,7 @@ initiate_remote_stonith_op(const pcmk__client_t *client, xmlNode *request,
         }
     }
 
+    op->query_start_us = g_get_monotonic_time();
     pcmk__cluster_send_message(NULL, pcmk_ipc_fenced, query);
     pcmk__xml_free(query);
 
@@ -2329,6 +2330,11 @@ add_result(remote_fencing_op_t *op, const char *host, int ndevices,
 int
 process_remote_stonith_query(xmlNode *msg)
 {
+    static pcmk__metric_t rtt_metric =
+        PCMK__METRIC(pcmk__metric_histogram, "fencing_query_rtt_us",
+                     "Time from sending a fencing query to receiving each "
+                     "peer's reply (microseconds)");
+
     int ndevices = 0;
     gboolean host_is_target = FALSE;
     gboolean have_all_replies = FALSE;
@@ -2355,6 +2361,10 @@ process_remote_stonith_query(xmlNode *msg)
         return -EOPNOTSUPP;
     }
 
+    if (op->query_start_us != 0) {
+        pcmk__metric_observe_since(&rtt_metric, op->query_start_us);
+    }
+
     replies_expected = fencing_active_peers();
     if (op->replies_expected < replies_expected) {
         replies_expected = op->replies_expected;
@@ -104,6 +104,10 @@ st_ipc_dispatch(qb_ipcs_connection_t * qbc, void *data, size_t size)
         return 0;
     }
 
+    if (pcmk__ipc_handle_common_request(c, id, flags, request)) {
+        pcmk__xml_free(request);
+        return 0;
+    }
 
     op = crm_element_value(request, PCMK__XA_CRM_TASK);
     if(pcmk__str_eq(op, CRM_OP_RM_NODE_CACHE, pcmk__str_casei)) {
@@ -101,6 +101,8 @@ typedef struct remote_fencing_op_s {
     /*! This timer expires the query request sent out to determine
      * what nodes are contain what devices, and who those devices can fence */
     guint query_timer;
+    /*! When the query was sent (monotonic microseconds), to time replies */
+    gint64 query_start_us;
     /*! This is the default timeout to use for each fencing device if no
      * custom timeout is received in the query. */
     gint base_timeout;
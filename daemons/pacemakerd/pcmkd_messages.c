@@ -223,6 +223,10 @@ pcmk_ipc_dispatch(qb_ipcs_connection_t * qbc, void *data, size_t size)
         pcmk__ipc_send_ack(c, id, flags, PCMK__XE_ACK, NULL, CRM_EX_PROTOCOL);
         return 0;
 
+    } else if (pcmk__ipc_handle_common_request(c, id, flags, msg)) {
+        pcmk__xml_free(msg);
+        return 0;
+
     } else {
         char *log_msg = NULL;
         const char *reason = NULL;
@@ -181,6 +181,8 @@ done:
 void
 pengine_shutdown(int nsig)
 {
+    schedulerd_stop_workers();
+
     if (ipcs != NULL) {
         crm_trace("Closing IPC server");
         mainloop_del_ipc_server(ipcs);
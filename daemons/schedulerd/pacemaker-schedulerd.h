@@ -16,4 +16,9 @@
 extern pcmk__output_t *logger_out;
 extern struct qb_ipcs_service_handlers ipc_callbacks;
 
+bool schedulerd_queue_calculation(const pcmk__request_t *request, int priority);
+bool schedulerd_cancel_calculation(const char *client_id, const char *ref);
+void schedulerd_drop_client_calculations(const char *client_id);
+void schedulerd_stop_workers(void);
+
 #endif
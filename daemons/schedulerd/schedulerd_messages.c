@@ -22,6 +22,9 @@
 
 static GHashTable *schedulerd_handlers = NULL;
 
+// Reference of the most recently abandoned calculation (for logging)
+static char *abandoned_ref = NULL;
+
 static pcmk_scheduler_t *
 init_working_set(void)
 {
@@ -32,8 +35,115 @@ init_working_set(void)
     return scheduler;
 }
 
+/*!
+ * \internal
+ * \brief Check whether a calculation has been superseded (cancellation check)
+ *
+ * Requests from a client are dispatched one at a time, so anything the same
+ * client has sent since the current request (a newer calculation request or a
+ * cancellation) makes the current calculation obsolete.
+ *
+ * \param[in] scheduler  Scheduler data (ignored)
+ * \param[in] user_data  IPC client that requested the calculation
+ *
+ * \return true if the client has a newer request waiting, otherwise false
+ */
+static bool
+calculation_superseded(pcmk_scheduler_t *scheduler, void *user_data)
+{
+    const pcmk__client_t *client = user_data;
+
+    return pcmk__mainloop_ipc_pending(client->ipcs);
+}
+
+/*!
+ * \internal
+ * \brief Create a reply for a calculation that was abandoned
+ *
+ * \param[in,out] request  Calculation request that was abandoned
+ *
+ * \return Newly created reply XML (or NULL on error)
+ */
 static xmlNode *
-handle_pecalc_request(pcmk__request_t *request)
+cancelled_reply(pcmk__request_t *request)
+{
+    xmlNode *reply = pcmk__new_reply(request->xml, NULL);
+
+    if (reply == NULL) {
+        pcmk__format_result(&request->result, CRM_EX_ERROR, PCMK_EXEC_ERROR,
+                            "Failed building cancellation reply for client %s",
+                            pcmk__client_name(request->ipc_client));
+        return NULL;
+    }
+
+    pcmk__xe_set_bool_attr(reply, PCMK__XA_CRM_TGRAPH_CANCELLED, true);
+    pcmk__str_update(&abandoned_ref,
+                     crm_element_value(request->xml, PCMK_XA_REFERENCE));
+    crm_notice("Abandoned calculation %s for %s because it was superseded",
+               abandoned_ref, pcmk__client_name(request->ipc_client));
+    pcmk__set_result(&request->result, CRM_EX_OK, PCMK_EXEC_DONE,
+                     "Calculation abandoned");
+    return reply;
+}
+
+/*!
+ * \internal
+ * \brief Save a scheduler input to disk
+ *
+ * If \c PCMK_scheduler_input_archive is set, add the input to its series'
+ * archive, otherwise (or if that fails) save it to its own compressed file.
+ *
+ * \param[in] series    Name of series that input belongs to
+ * \param[in] seq       Sequence number of input within \p series
+ * \param[in] input     Input to save
+ * \param[in] filename  Name of file to save input to if not archived
+ */
+static void
+save_input(const char *series, unsigned int seq, const xmlNode *input,
+           const char *filename)
+{
+    // Series name -> pcmk__xml_archive_t *
+    static GHashTable *archives = NULL;
+
+    static int interval = -1;
+
+    pcmk__xml_archive_t *archive = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (interval < 0) {
+        const char *value = pcmk__env_option(PCMK__ENV_SCHEDULER_INPUT_ARCHIVE);
+
+        if ((value == NULL)
+            || (pcmk__scan_min_int(value, &interval, 0) != pcmk_rc_ok)) {
+            interval = 0;
+        }
+        archives = pcmk__strkey_table(free, (GDestroyNotify)
+                                            pcmk__xml_archive_free);
+    }
+
+    if (interval > 0) {
+        archive = g_hash_table_lookup(archives, series);
+        if (archive == NULL) {
+            rc = pcmk__xml_archive_open(PCMK_SCHEDULER_INPUT_DIR, series,
+                                        (guint) interval, &archive);
+            if (rc == pcmk_rc_ok) {
+                g_hash_table_insert(archives, pcmk__str_copy(series), archive);
+            }
+        }
+        if (archive != NULL) {
+            rc = pcmk__xml_archive_add(archive, seq, input);
+            if (rc == pcmk_rc_ok) {
+                return;
+            }
+        }
+        crm_warn("Could not archive %s, saving full copy instead: %s",
+                 filename, pcmk_rc_str(rc));
+    }
+    pcmk__xml_write_file(input, filename, true);
+}
+
+static xmlNode *
+calculate_dc_graph(pcmk__request_t *request)
 {
     static struct series_s {
         const char *name;
@@ -91,11 +201,26 @@ handle_pecalc_request(pcmk__request_t *request)
     }
 
     if (process) {
+        scheduler->priv->cancel_check = calculation_superseded;
+        scheduler->priv->cancel_data = request->ipc_client;
         pcmk__schedule_actions(converted,
                                pcmk__sched_no_counts
                                |pcmk__sched_show_utilization, scheduler);
     }
 
+    if (pcmk_is_set(scheduler->flags, pcmk__sched_cancelled)) {
+        /* Nothing was saved for this input, so the next request must not be
+         * treated as a repeat of it
+         */
+        if (!is_repoke) {
+            free(last_digest);
+            last_digest = NULL;
+        }
+        scheduler->input = NULL; // Freed separately as converted
+        reply = cancelled_reply(request);
+        goto done;
+    }
+
     // Get appropriate index into series[] array
     if (pcmk_is_set(scheduler->flags, pcmk__sched_processing_error)
         || pcmk__config_has_error) {
@@ -156,7 +281,7 @@ handle_pecalc_request(pcmk__request_t *request)
         unlink(filename);
         crm_xml_add_ll(xml_data, PCMK_XA_EXECUTION_DATE,
                        (long long) execution_date);
-        pcmk__xml_write_file(xml_data, filename, true);
+        save_input(series[series_id].name, seq, xml_data, filename);
         pcmk__write_series_sequence(PCMK_SCHEDULER_INPUT_DIR, series[series_id].name,
                                     ++seq, series_wrap);
     }
@@ -170,6 +295,68 @@ done:
     return reply;
 }
 
+static xmlNode *
+handle_pecalc_request(pcmk__request_t *request)
+{
+    static pcmk__metric_t dc_metric =
+        PCMK__METRIC(pcmk__metric_histogram, "scheduler_dc_request_us",
+                     "Time to handle DC calculation requests (microseconds)");
+
+    int priority = PCMK__SCHEDULER_PRIORITY_DC;
+    gint64 start_us = 0;
+    xmlNode *reply = NULL;
+
+    /* Requests with a lower priority than the DC's are calculated by worker
+     * processes, so they never delay a DC request
+     */
+    crm_element_value_int(request->xml, PCMK__XA_PRIORITY, &priority);
+    if ((priority < PCMK__SCHEDULER_PRIORITY_DC)
+        && schedulerd_queue_calculation(request, priority)) {
+
+        pcmk__ipc_send_ack(request->ipc_client, request->ipc_id,
+                           request->ipc_flags, PCMK__XE_ACK, NULL,
+                           CRM_EX_INDETERMINATE);
+        pcmk__set_result(&request->result, CRM_EX_OK, PCMK_EXEC_DONE,
+                         "Calculation queued");
+        return NULL;
+    }
+
+    start_us = g_get_monotonic_time();
+    reply = calculate_dc_graph(request);
+    pcmk__metric_observe_since(&dc_metric, start_us);
+    return reply;
+}
+
+static xmlNode *
+handle_cancel_request(pcmk__request_t *request)
+{
+    const char *ref = crm_element_value(request->xml, PCMK__XA_CRM_TGRAPH_REF);
+
+    pcmk__ipc_send_ack(request->ipc_client, request->ipc_id, request->ipc_flags,
+                       PCMK__XE_ACK, NULL, CRM_EX_INDETERMINATE);
+
+    if (schedulerd_cancel_calculation(request->ipc_client->id, ref)) {
+        pcmk__set_result(&request->result, CRM_EX_OK, PCMK_EXEC_DONE, NULL);
+        return NULL;
+    }
+
+    /* Requests are processed in order, so by the time this one is dispatched,
+     * any calculation it refers to has either been abandoned (because this
+     * request was waiting) or has already completed.
+     */
+    if (pcmk__str_eq(ref, abandoned_ref, pcmk__str_none)) {
+        crm_debug("Calculation %s for %s was cancelled", ref,
+                  pcmk__client_name(request->ipc_client));
+    } else {
+        crm_debug("Calculation %s for %s already completed before cancellation",
+                  pcmk__s(ref, "(unspecified)"),
+                  pcmk__client_name(request->ipc_client));
+    }
+
+    pcmk__set_result(&request->result, CRM_EX_OK, PCMK_EXEC_DONE, NULL);
+    return NULL;
+}
+
 static xmlNode *
 handle_unknown_request(pcmk__request_t *request)
 {
@@ -200,6 +387,7 @@ schedulerd_register_handlers(void)
     pcmk__server_command_t handlers[] = {
         { CRM_OP_HELLO, handle_hello_request },
         { CRM_OP_PECALC, handle_pecalc_request },
+        { PCMK__SCHEDULERD_CMD_CANCEL, handle_cancel_request },
         { NULL, handle_unknown_request },
     };
 
@@ -237,6 +425,11 @@ pe_ipc_dispatch(qb_ipcs_connection_t * qbc, void *data, size_t size)
         return 0;
     }
 
+    if (pcmk__ipc_handle_common_request(c, id, flags, msg)) {
+        pcmk__xml_free(msg);
+        return 0;
+    }
+
     sys_to = crm_element_value(msg, PCMK__XA_CRM_SYS_TO);
 
     if (pcmk__str_eq(crm_element_value(msg, PCMK__XA_SUBT),
@@ -310,6 +503,7 @@ pe_ipc_closed(qb_ipcs_connection_t * c)
         return 0;
     }
     crm_trace("Connection %p", c);
+    schedulerd_drop_client_calculations(client->id);
     pcmk__free_client(client);
     return 0;
 }
@@ -0,0 +1,1051 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <crm/crm.h>
+#include <crm/common/mainloop.h>
+#include <crm/common/xml.h>
+#include <pacemaker-internal.h>
+
+#include "pacemaker-schedulerd.h"
+
+/* Calculations requested with a priority below PCMK__SCHEDULER_PRIORITY_DC (for
+ * example, by tools previewing what the cluster would do) are run by a pool of
+ * long-lived worker processes rather than in the daemon itself, so that they
+ * never delay the DC's calculations, which the daemon runs itself (keeping the
+ * state needed to recognize repeated inputs and to number saved inputs, and
+ * updating the daemon's performance metrics). The scheduler libraries keep
+ * process-wide state (configuration error flags, caches, and so forth), so each
+ * worker runs only one calculation at a time, and a runaway calculation can be
+ * memory-limited without affecting the daemon.
+ *
+ * The daemon and each worker exchange XML text terminated by a null byte over
+ * a socket pair: one request, then one reply (which is empty if the worker
+ * could not calculate a result). While a calculation is running, the daemon may
+ * send WORKER_CANCEL to have the worker abandon it, which the worker checks for
+ * at each scheduler phase boundary. A worker exits after WORKER_MAX_JOBS
+ * calculations, to limit the effect of any memory fragmentation or leaks, and
+ * is replaced when needed.
+ */
+
+// Reply attribute used by a worker to report its peak memory usage
+#define WORKER_XA_RSS "worker_rss_kb"
+
+#define DEFAULT_WORKERS         2
+#define DEFAULT_CLIENT_WORKERS  1
+
+#define WORKER_MAX_JOBS         100
+
+// Message sent to a worker to abandon its current calculation
+#define WORKER_CANCEL           "cancel"
+
+typedef struct {
+    char *client_id;        // ID of requesting client (NULL if disconnected)
+    uint32_t ipc_id;        // IPC ID of request
+    char *ref;              // Reference of request
+    xmlNode *request;       // Copy of request XML
+    int priority;           // Requested priority
+    gint64 queued_us;       // When request was queued (monotonic)
+    bool cancelled;         // Whether calculation was cancelled
+} worker_job_t;
+
+typedef struct {
+    pid_t pid;              // Worker process ID
+    int fd;                 // Daemon's end of socket pair with worker
+    mainloop_io_t *source;  // Main loop source for fd
+    GString *output;        // Reply read from worker so far
+    worker_job_t *job;      // Calculation being run (NULL if idle)
+    guint jobs_started;     // Number of calculations given to worker
+    bool closed;            // Whether fd has been drained and closed
+    bool exited;            // Whether worker has been reaped
+} worker_t;
+
+// Calculations waiting for a worker, highest priority first
+static GList *pending_jobs = NULL;
+
+static GList *workers = NULL;
+
+// Limits from the environment (-1 until read)
+static int max_workers = -1;
+static int max_client_workers = -1;
+static int worker_memory_mb = -1;
+
+static pcmk__metric_t busy_metric =
+    PCMK__METRIC(pcmk__metric_gauge, "scheduler_workers_busy",
+                 "Number of scheduler worker processes currently running a "
+                 "calculation");
+
+static pcmk__metric_t queue_wait_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_worker_queue_wait_us",
+                 "Time calculation requests waited for a worker "
+                 "(microseconds)");
+
+static pcmk__metric_t rss_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_worker_rss_kb",
+                 "Peak resident memory of scheduler worker processes (KiB)");
+
+static pcmk__metric_t failure_metric =
+    PCMK__METRIC(pcmk__metric_counter, "scheduler_worker_failures",
+                 "Number of scheduler calculations that failed in a worker "
+                 "process");
+
+static pcmk__metric_t spawn_metric =
+    PCMK__METRIC(pcmk__metric_counter, "scheduler_workers_started",
+                 "Number of scheduler worker processes started");
+
+static void start_pending_jobs(void);
+
+/*!
+ * \internal
+ * \brief Get a non-negative integer limit from an environment option
+ *
+ * \param[in] option         Name of environment option
+ * \param[in] default_value  Value to use if option is unset or invalid
+ *
+ * \return Value of \p option
+ */
+static int
+env_limit(const char *option, int default_value)
+{
+    const char *value = pcmk__env_option(option);
+    int limit = default_value;
+
+    if ((value != NULL)
+        && (pcmk__scan_min_int(value, &limit, 0) != pcmk_rc_ok)) {
+        crm_warn("Using default of %d for PCMK_%s because '%s' is invalid",
+                 default_value, option, value);
+        limit = default_value;
+    }
+    return limit;
+}
+
+static void
+read_limits(void)
+{
+    if (max_workers >= 0) {
+        return;
+    }
+    max_workers = env_limit(PCMK__ENV_SCHEDULER_WORKERS, DEFAULT_WORKERS);
+    max_client_workers = env_limit(PCMK__ENV_SCHEDULER_CLIENT_WORKERS,
+                                   DEFAULT_CLIENT_WORKERS);
+    if (max_client_workers == 0) {
+        max_client_workers = max_workers;
+    }
+    worker_memory_mb = env_limit(PCMK__ENV_SCHEDULER_WORKER_MEMORY, 0);
+    crm_debug("Using up to %d scheduler worker%s (%d per client)",
+              max_workers, pcmk__plural_s(max_workers), max_client_workers);
+}
+
+static void
+free_job(worker_job_t *job)
+{
+    if (job == NULL) {
+        return;
+    }
+    pcmk__xml_free(job->request);
+    free(job->client_id);
+    free(job->ref);
+    free(job);
+}
+
+/*!
+ * \internal
+ * \brief Send a reply for a calculation to its client, if still connected
+ *
+ * \param[in]     job    Calculation that reply is for
+ * \param[in,out] reply  Reply to send
+ */
+static void
+send_job_reply(const worker_job_t *job, xmlNode *reply)
+{
+    pcmk__client_t *client = NULL;
+
+    if (job->client_id == NULL) {
+        return;
+    }
+    client = pcmk__find_client_by_id(job->client_id);
+    if (client == NULL) {
+        crm_trace("Discarding result of calculation %s because client "
+                  "disconnected", job->ref);
+        return;
+    }
+    pcmk__ipc_send_xml(client, job->ipc_id, reply, crm_ipc_server_event);
+}
+
+/*!
+ * \internal
+ * \brief Send a reply indicating that a calculation was cancelled
+ *
+ * \param[in] job  Calculation that reply is for
+ */
+static void
+send_cancelled_reply(const worker_job_t *job)
+{
+    xmlNode *reply = pcmk__new_reply(job->request, NULL);
+
+    if (reply == NULL) {
+        return;
+    }
+    pcmk__xe_set_bool_attr(reply, PCMK__XA_CRM_TGRAPH_CANCELLED, true);
+    send_job_reply(job, reply);
+    pcmk__xml_free(reply);
+}
+
+/*!
+ * \internal
+ * \brief Send a reply indicating that a calculation failed
+ *
+ * \param[in] job     Calculation that reply is for
+ * \param[in] reason  Why the calculation failed
+ */
+static void
+send_error_reply(const worker_job_t *job, const char *reason)
+{
+    xmlNode *reply = pcmk__new_reply(job->request, NULL);
+
+    if (reply == NULL) {
+        return;
+    }
+    crm_xml_add_int(reply, PCMK__XA_RC_CODE, CRM_EX_ERROR);
+    crm_xml_add(reply, PCMK_XA_EXIT_REASON, reason);
+    send_job_reply(job, reply);
+    pcmk__xml_free(reply);
+}
+
+static guint
+busy_workers(void)
+{
+    guint count = 0;
+
+    for (GList *iter = workers; iter != NULL; iter = iter->next) {
+        const worker_t *worker = iter->data;
+
+        if (worker->job != NULL) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*!
+ * \internal
+ * \brief Relay a calculation's result to its client and free the calculation
+ *
+ * \param[in,out] job    Calculation that has finished
+ * \param[in,out] reply  Reply from worker (or NULL if worker failed)
+ * \param[in]     pid    Process ID of worker that ran calculation
+ */
+static void
+finish_job(worker_job_t *job, xmlNode *reply, pid_t pid)
+{
+    const char *value = NULL;
+    long long rss_kb = 0LL;
+
+    if (job->cancelled
+        && ((reply == NULL)
+            || pcmk__xe_attr_is_true(reply, PCMK__XA_CRM_TGRAPH_CANCELLED))) {
+        crm_info("Cancelled calculation %s for client %s", job->ref,
+                 pcmk__s(job->client_id, "(disconnected)"));
+        send_cancelled_reply(job);
+        goto done;
+    }
+
+    if (reply == NULL) {
+        crm_err("Scheduler worker %lld failed calculation %s",
+                (long long) pid, job->ref);
+        pcmk__metric_add(&failure_metric, 1);
+        send_error_reply(job, "Scheduler worker process failed");
+        goto done;
+    }
+
+    value = crm_element_value(reply, WORKER_XA_RSS);
+    if ((value != NULL)
+        && (pcmk__scan_ll(value, &rss_kb, 0LL) == pcmk_rc_ok)) {
+        pcmk__metric_observe(&rss_metric, (uint64_t) QB_MAX(rss_kb, 0LL));
+        pcmk__xe_remove_attr(reply, WORKER_XA_RSS);
+        crm_debug("Scheduler worker %lld completed calculation %s "
+                  "(peak %lld KiB)", (long long) pid, job->ref, rss_kb);
+    }
+    send_job_reply(job, reply);
+
+done:
+    free_job(job);
+}
+
+/*!
+ * \internal
+ * \brief Remove a worker that has exited, failing any calculation it was on
+ *
+ * \param[in,out] worker  Worker to remove
+ */
+static void
+remove_worker(worker_t *worker)
+{
+    worker_job_t *job = worker->job;
+
+    workers = g_list_remove(workers, worker);
+    if (job != NULL) {
+        finish_job(job, NULL, worker->pid);
+    }
+    pcmk__metric_set(&busy_metric, busy_workers());
+    g_string_free(worker->output, TRUE);
+    free(worker);
+    start_pending_jobs();
+}
+
+/*!
+ * \internal
+ * \brief Handle a complete reply from a worker
+ *
+ * \param[in,out] worker  Worker that sent reply
+ * \param[in]     text    Reply XML text (empty if calculation failed)
+ */
+static void
+worker_replied(worker_t *worker, const char *text)
+{
+    worker_job_t *job = worker->job;
+    xmlNode *reply = NULL;
+
+    if (job == NULL) {
+        crm_warn("Ignoring unexpected output from scheduler worker %lld",
+                 (long long) worker->pid);
+        return;
+    }
+    worker->job = NULL;
+    pcmk__metric_set(&busy_metric, busy_workers());
+
+    if (!pcmk__str_empty(text)) {
+        reply = pcmk__xml_parse(text);
+    }
+    finish_job(job, reply, worker->pid);
+    pcmk__xml_free(reply);
+    start_pending_jobs();
+}
+
+static int
+worker_output_dispatch(gpointer user_data)
+{
+    worker_t *worker = user_data;
+    char buffer[4096];
+
+    while (true) {
+        ssize_t rc = read(worker->fd, buffer, sizeof(buffer));
+
+        if (rc > 0) {
+            g_string_append_len(worker->output, buffer, rc);
+
+            // A null byte ends each reply
+            for (const char *end = memchr(worker->output->str, '\0',
+                                          worker->output->len);
+                 end != NULL;
+                 end = memchr(worker->output->str, '\0',
+                              worker->output->len)) {
+
+                char *text = pcmk__str_copy(worker->output->str);
+
+                g_string_erase(worker->output, 0,
+                               (end - worker->output->str) + 1);
+                worker_replied(worker, text);
+                free(text);
+            }
+
+        } else if (rc == 0) {
+            return -1; // End of file
+
+        } else if (errno == EAGAIN) {
+            return 0;
+
+        } else if (errno != EINTR) {
+            crm_warn("Could not read output of scheduler worker %lld: %s",
+                     (long long) worker->pid, strerror(errno));
+            return -1;
+        }
+    }
+}
+
+static void
+worker_output_destroy(gpointer user_data)
+{
+    worker_t *worker = user_data;
+
+    close(worker->fd);
+    worker->fd = -1;
+    worker->source = NULL;
+    worker->closed = true;
+    if (worker->exited) {
+        remove_worker(worker);
+    }
+}
+
+static struct mainloop_fd_callbacks worker_output_callbacks = {
+    .dispatch = worker_output_dispatch,
+    .destroy = worker_output_destroy,
+};
+
+static void
+worker_exited(mainloop_child_t *p, pid_t pid, int core, int signo,
+              int exitcode)
+{
+    worker_t *worker = mainloop_child_userdata(p);
+
+    worker->exited = true;
+    if (((signo != 0) || (exitcode != CRM_EX_OK))
+        && ((worker->job == NULL) || !worker->job->cancelled)) {
+        crm_warn("Scheduler worker %lld %s %d%s",
+                 (long long) pid,
+                 ((signo != 0)? "was terminated by signal" : "exited with"),
+                 ((signo != 0)? signo : exitcode),
+                 (core? " (core dumped)" : ""));
+    }
+    if (worker->closed) {
+        remove_worker(worker);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Write a buffer completely to a socket
+ *
+ * \param[in] fd      Socket to write to (may be nonblocking)
+ * \param[in] buffer  Data to write
+ * \param[in] len     Number of bytes to write
+ *
+ * \return true if everything was written, otherwise false
+ */
+static bool
+write_all(int fd, const char *buffer, size_t len)
+{
+    while (len > 0) {
+        ssize_t rc = send(fd, buffer, len, MSG_NOSIGNAL);
+
+        if (rc < 0) {
+            struct pollfd pfd = { .fd = fd, .events = POLLOUT, };
+
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN) && (poll(&pfd, 1, -1) >= 0)) {
+                continue;
+            }
+            return false;
+        }
+        buffer += rc;
+        len -= rc;
+    }
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Read one null-terminated message from a socket
+ *
+ * \param[in]     fd      Socket to read from (blocking)
+ * \param[in,out] buffer  Where to store message (without terminator)
+ *
+ * \return true if a complete message was read, otherwise false
+ */
+static bool
+read_message(int fd, GString *buffer)
+{
+    g_string_truncate(buffer, 0);
+    while (true) {
+        char c[4096];
+        ssize_t rc = recv(fd, c, sizeof(c), MSG_PEEK);
+        const char *end = NULL;
+        size_t len = 0;
+
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (rc == 0) {
+            return false;
+        }
+
+        // Consume only up to the terminator, leaving any following message
+        end = memchr(c, '\0', rc);
+        len = (end == NULL)? (size_t) rc : (size_t) (end - c) + 1;
+        rc = read(fd, c, len);
+        if (rc < (ssize_t) len) {
+            return false;
+        }
+        if (end != NULL) {
+            g_string_append_len(buffer, c, len - 1);
+            return true;
+        }
+        g_string_append_len(buffer, c, len);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether the daemon has cancelled a worker's calculation
+ *
+ * \param[in] scheduler  Scheduler data (ignored)
+ * \param[in] user_data  Worker's end of socket pair with daemon
+ *
+ * \return true if the calculation should be abandoned, otherwise false
+ */
+static bool
+worker_cancelled(pcmk_scheduler_t *scheduler, void *user_data)
+{
+    int fd = GPOINTER_TO_INT(user_data);
+    struct pollfd pfd = { .fd = fd, .events = POLLIN, };
+    GString *buffer = NULL;
+
+    if (poll(&pfd, 1, 0) <= 0) {
+        return false;
+    }
+
+    /* The daemon sends nothing but a cancellation while a calculation is
+     * running, and if it has closed its end, no one wants the result anyway
+     */
+    buffer = g_string_sized_new(sizeof(WORKER_CANCEL));
+    if (read_message(fd, buffer)) {
+        crm_debug("Abandoning calculation at daemon's request");
+    }
+    g_string_free(buffer, TRUE);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Calculate a transition graph in a worker process
+ *
+ * \param[in] request  Calculation request
+ * \param[in] fd       Worker's end of socket pair with daemon
+ *
+ * \return Newly created reply XML (or NULL on error)
+ */
+static xmlNode *
+calculate_graph(const xmlNode *request, int fd)
+{
+    xmlNode *wrapper = pcmk__xe_first_child(request, PCMK__XE_CRM_XML, NULL,
+                                            NULL);
+    xmlNode *xml_data = pcmk__xe_first_child(wrapper, NULL, NULL, NULL);
+    xmlNode *converted = pcmk__xml_copy(NULL, xml_data);
+    xmlNode *reply = NULL;
+    pcmk_scheduler_t *scheduler = pe_new_working_set();
+
+    pcmk__mem_assert(scheduler);
+    scheduler->priv->out = logger_out;
+
+    if (pcmk__update_configured_schema(&converted, true) != pcmk_rc_ok) {
+        scheduler->priv->graph = pcmk__xe_create(NULL,
+                                                 PCMK__XE_TRANSITION_GRAPH);
+        crm_xml_add_int(scheduler->priv->graph, "transition_id", 0);
+        crm_xml_add_int(scheduler->priv->graph, PCMK_OPT_CLUSTER_DELAY, 0);
+    } else {
+        scheduler->priv->cancel_check = worker_cancelled;
+        scheduler->priv->cancel_data = GINT_TO_POINTER(fd);
+        pcmk__schedule_actions(converted, pcmk__sched_no_counts, scheduler);
+    }
+    scheduler->input = NULL; // Freed separately as converted
+
+    if (pcmk_is_set(scheduler->flags, pcmk__sched_cancelled)) {
+        reply = pcmk__new_reply(request, NULL);
+        if (reply != NULL) {
+            pcmk__xe_set_bool_attr(reply, PCMK__XA_CRM_TGRAPH_CANCELLED, true);
+        }
+    } else {
+        reply = pcmk__new_reply(request, scheduler->priv->graph);
+    }
+    pcmk__xml_free(converted);
+    pe_free_working_set(scheduler);
+    return reply;
+}
+
+/*!
+ * \internal
+ * \brief Run calculations in a worker process, then exit
+ *
+ * \param[in] fd  Worker's end of socket pair with daemon
+ */
+static _Noreturn void
+run_worker(int fd)
+{
+    GString *buffer = g_string_sized_new(4096);
+    int n = 0;
+
+    // Inherited handlers belong to the daemon's main loop
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGINT, SIG_DFL);
+
+    if (worker_memory_mb > 0) {
+        struct rlimit limit;
+
+        limit.rlim_cur = (rlim_t) worker_memory_mb * 1024 * 1024;
+        limit.rlim_max = limit.rlim_cur;
+        if (setrlimit(RLIMIT_AS, &limit) != 0) {
+            crm_warn("Could not limit scheduler worker memory to %d MiB: %s",
+                     worker_memory_mb, strerror(errno));
+        }
+    }
+
+    while (n < WORKER_MAX_JOBS) {
+        xmlNode *request = NULL;
+        xmlNode *reply = NULL;
+        struct rusage usage;
+        bool written = false;
+
+        if (!read_message(fd, buffer)) {
+            break; // Daemon closed its end
+        }
+
+        /* A cancellation that arrives after the calculation it was meant for
+         * has completed needs no reply
+         */
+        if (pcmk__str_eq(buffer->str, WORKER_CANCEL, pcmk__str_none)) {
+            continue;
+        }
+
+        n++;
+        request = pcmk__xml_parse(buffer->str);
+        if (request != NULL) {
+            reply = calculate_graph(request, fd);
+        }
+
+        g_string_truncate(buffer, 0);
+        if (reply != NULL) {
+            if (getrusage(RUSAGE_SELF, &usage) == 0) {
+                crm_xml_add_ll(reply, WORKER_XA_RSS,
+                               (long long) usage.ru_maxrss);
+            }
+            pcmk__xml_string(reply, 0, buffer, 0);
+        }
+        written = write_all(fd, buffer->str, buffer->len + 1);
+
+        pcmk__xml_free(reply);
+        pcmk__xml_free(request);
+        if (!written) {
+            _exit(CRM_EX_ERROR);
+        }
+    }
+
+    /* Exit without freeing anything or running exit handlers, which could
+     * interfere with the daemon's state (such as its IPC server)
+     */
+    _exit(CRM_EX_OK);
+}
+
+/*!
+ * \internal
+ * \brief Start a new worker process
+ *
+ * \return Newly started worker (or NULL on error)
+ */
+static worker_t *
+start_worker(void)
+{
+    int fds[2] = { -1, -1 };
+    worker_t *worker = NULL;
+    pid_t pid = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        crm_err("Could not create socket pair for scheduler worker: %s",
+                strerror(errno));
+        return NULL;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        crm_err("Could not fork scheduler worker: %s", strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return NULL;
+    }
+
+    if (pid == 0) {
+        // Other workers must see end-of-file when the daemon closes its end
+        for (GList *iter = workers; iter != NULL; iter = iter->next) {
+            const worker_t *other = iter->data;
+
+            if (other->fd >= 0) {
+                close(other->fd);
+            }
+        }
+        close(fds[0]);
+        run_worker(fds[1]);
+    }
+
+    close(fds[1]);
+    worker = pcmk__assert_alloc(1, sizeof(worker_t));
+    worker->pid = pid;
+    worker->fd = fds[0];
+    worker->output = g_string_sized_new(1024);
+    pcmk__set_nonblocking(worker->fd);
+    worker->source = mainloop_add_fd("scheduler-worker", G_PRIORITY_DEFAULT,
+                                     worker->fd, worker,
+                                     &worker_output_callbacks);
+    mainloop_child_add_with_flags(pid, 0, "scheduler-worker", worker,
+                                  mainloop_leave_pid_group, worker_exited);
+
+    pcmk__metric_add(&spawn_metric, 1);
+    crm_debug("Started scheduler worker %lld", (long long) pid);
+    return worker;
+}
+
+/*!
+ * \internal
+ * \brief Check whether a worker can be given a calculation
+ *
+ * \param[in] worker  Worker to check
+ *
+ * \return true if \p worker is idle and will not exit soon, otherwise false
+ */
+static bool
+worker_available(const worker_t *worker)
+{
+    return (worker->job == NULL) && !worker->closed && !worker->exited
+           && (worker->jobs_started < WORKER_MAX_JOBS);
+}
+
+/*!
+ * \internal
+ * \brief Give a calculation to a worker
+ *
+ * \param[in,out] worker  Worker to give calculation to
+ * \param[in,out] job     Calculation to run
+ *
+ * \return true if the request was sent to the worker, otherwise false
+ */
+static bool
+assign_job(worker_t *worker, worker_job_t *job)
+{
+    GString *buffer = g_string_sized_new(4096);
+    bool sent = false;
+
+    pcmk__xml_string(job->request, 0, buffer, 0);
+    sent = write_all(worker->fd, buffer->str, buffer->len + 1);
+    g_string_free(buffer, TRUE);
+
+    worker->jobs_started++;
+    if (!sent) {
+        crm_err("Could not send calculation %s to scheduler worker %lld: %s",
+                job->ref, (long long) worker->pid, strerror(errno));
+        mainloop_child_kill(worker->pid);
+        return false;
+    }
+
+    worker->job = job;
+    pcmk__metric_set(&busy_metric, busy_workers());
+    pcmk__metric_observe_since(&queue_wait_metric, job->queued_us);
+    crm_debug("Scheduler worker %lld started calculation %s for client %s",
+              (long long) worker->pid, job->ref,
+              pcmk__s(job->client_id, "(disconnected)"));
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Fail a calculation that could not be given to a worker
+ *
+ * \param[in,out] job  Calculation to fail
+ */
+static void
+fail_job(worker_job_t *job)
+{
+    pcmk__metric_add(&failure_metric, 1);
+    send_error_reply(job, "Could not start scheduler worker process");
+    free_job(job);
+}
+
+static guint
+running_for_client(const char *client_id)
+{
+    guint count = 0;
+
+    for (GList *iter = workers; iter != NULL; iter = iter->next) {
+        const worker_t *worker = iter->data;
+
+        if ((worker->job != NULL)
+            && pcmk__str_eq(worker->job->client_id, client_id,
+                            pcmk__str_none)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*!
+ * \internal
+ * \brief Find an idle worker, starting one if the limit allows
+ *
+ * \return Available worker, or NULL if none is available
+ */
+static worker_t *
+available_worker(void)
+{
+    guint in_use = 0;
+
+    for (GList *iter = workers; iter != NULL; iter = iter->next) {
+        worker_t *worker = iter->data;
+
+        if (worker_available(worker)) {
+            return worker;
+        }
+
+        // A worker that is about to exit no longer counts toward the limit
+        if (worker->job != NULL) {
+            in_use++;
+        }
+    }
+    if (in_use < (guint) max_workers) {
+        worker_t *worker = start_worker();
+
+        if (worker != NULL) {
+            workers = g_list_append(workers, worker);
+        }
+        return worker;
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Start as many pending calculations as the limits allow
+ *
+ * Pending calculations are considered highest priority first. One that can't
+ * be started because its client is at its limit doesn't hold up the others.
+ */
+static void
+start_pending_jobs(void)
+{
+    GList *iter = pending_jobs;
+
+    while (iter != NULL) {
+        worker_job_t *job = iter->data;
+        GList *next = iter->next;
+
+        if (running_for_client(job->client_id) < (guint) max_client_workers) {
+            worker_t *worker = available_worker();
+
+            if ((worker == NULL) && (workers != NULL)) {
+                break; // Wait for a worker to finish
+            }
+            pending_jobs = g_list_delete_link(pending_jobs, iter);
+            if ((worker == NULL) || !assign_job(worker, job)) {
+                fail_job(job);
+            }
+        }
+        iter = next;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Stop a calculation that a worker is running
+ *
+ * The worker is asked to abandon the calculation, which it does at the next
+ * scheduler phase boundary, replying as usual. If the worker can't be asked,
+ * it is killed, and the reply is sent once it has been reaped.
+ *
+ * \param[in,out] worker  Worker running calculation to stop
+ */
+static void
+stop_running_job(worker_t *worker)
+{
+    if (worker->job->cancelled) {
+        return; // Already asked
+    }
+    worker->job->cancelled = true;
+
+    crm_debug("Asking scheduler worker %lld to abandon calculation %s",
+              (long long) worker->pid, worker->job->ref);
+    if (!write_all(worker->fd, WORKER_CANCEL, sizeof(WORKER_CANCEL))) {
+        crm_warn("Could not cancel calculation %s in scheduler worker %lld: "
+                 "%s", worker->job->ref, (long long) worker->pid,
+                 strerror(errno));
+        mainloop_child_kill(worker->pid);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Queue a calculation request to be run by a worker process
+ *
+ * \param[in] request   Calculation request
+ * \param[in] priority  Priority of request (higher runs sooner, and less than
+ *                      \c PCMK__SCHEDULER_PRIORITY_DC)
+ *
+ * \return true if the request was queued, or false if workers are disabled
+ *         (in which case the caller should calculate the request itself)
+ */
+bool
+schedulerd_queue_calculation(const pcmk__request_t *request, int priority)
+{
+    worker_job_t *job = NULL;
+    GList *iter = NULL;
+
+    read_limits();
+    if (max_workers == 0) {
+        return false;
+    }
+
+    job = pcmk__assert_alloc(1, sizeof(worker_job_t));
+    job->client_id = pcmk__str_copy(request->ipc_client->id);
+    job->ipc_id = request->ipc_id;
+    job->ref = crm_element_value_copy(request->xml, PCMK_XA_REFERENCE);
+    job->request = pcmk__xml_copy(NULL, request->xml);
+    job->priority = priority;
+    job->queued_us = g_get_monotonic_time();
+
+    // Insert after any pending calculations of the same or higher priority
+    for (iter = pending_jobs; iter != NULL; iter = iter->next) {
+        const worker_job_t *other = iter->data;
+
+        if (other->priority < priority) {
+            break;
+        }
+    }
+    pending_jobs = g_list_insert_before(pending_jobs, iter, job);
+
+    crm_debug("Queued calculation %s for client %s with priority %d",
+              job->ref, pcmk__client_name(request->ipc_client), priority);
+    start_pending_jobs();
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Remove a pending calculation from a queue if it matches
+ *
+ * \param[in,out] queue      Queue to search
+ * \param[in]     client_id  ID of client that requested calculation
+ * \param[in]     ref        Reference of calculation request
+ *
+ * \return Matching calculation (removed from \p queue), or NULL if none
+ */
+static worker_job_t *
+dequeue_job(GList **queue, const char *client_id, const char *ref)
+{
+    for (GList *iter = *queue; iter != NULL; iter = iter->next) {
+        worker_job_t *job = iter->data;
+
+        if (pcmk__str_eq(job->client_id, client_id, pcmk__str_none)
+            && pcmk__str_eq(job->ref, ref, pcmk__str_none)) {
+
+            *queue = g_list_delete_link(*queue, iter);
+            return job;
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Cancel a calculation being handled by the worker pool
+ *
+ * \param[in] client_id  ID of client that requested calculation
+ * \param[in] ref        Reference of calculation request
+ *
+ * \return true if the calculation was found, otherwise false
+ */
+bool
+schedulerd_cancel_calculation(const char *client_id, const char *ref)
+{
+    worker_job_t *job = dequeue_job(&pending_jobs, client_id, ref);
+
+    if (job != NULL) {
+        crm_info("Cancelled queued calculation %s for client %s",
+                 ref, client_id);
+        send_cancelled_reply(job);
+        free_job(job);
+        return true;
+    }
+
+    for (GList *iter = workers; iter != NULL; iter = iter->next) {
+        worker_t *worker = iter->data;
+
+        if ((worker->job != NULL)
+            && pcmk__str_eq(worker->job->client_id, client_id, pcmk__str_none)
+            && pcmk__str_eq(worker->job->ref, ref, pcmk__str_none)) {
+
+            stop_running_job(worker);
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * \brief Drop all calculations for a client that has disconnected
+ *
+ * \param[in] client_id  ID of disconnected client
+ */
+void
+schedulerd_drop_client_calculations(const char *client_id)
+{
+    GList *iter = pending_jobs;
+    GList *to_stop = NULL;
+
+    while (iter != NULL) {
+        worker_job_t *job = iter->data;
+        GList *next = iter->next;
+
+        if (pcmk__str_eq(job->client_id, client_id, pcmk__str_none)) {
+            pending_jobs = g_list_delete_link(pending_jobs, iter);
+            free_job(job);
+        }
+        iter = next;
+    }
+
+    // Stopping a worker may remove it, so don't iterate workers while stopping
+    for (iter = workers; iter != NULL; iter = iter->next) {
+        worker_t *worker = iter->data;
+
+        if ((worker->job != NULL)
+            && pcmk__str_eq(worker->job->client_id, client_id,
+                            pcmk__str_none)) {
+            to_stop = g_list_prepend(to_stop, worker);
+        }
+    }
+
+    for (iter = to_stop; iter != NULL; iter = iter->next) {
+        worker_t *worker = iter->data;
+
+        free(worker->job->client_id);
+        worker->job->client_id = NULL;
+        stop_running_job(worker);
+    }
+    g_list_free(to_stop);
+}
+
+/*!
+ * \internal
+ * \brief Discard pending calculations and kill all workers (at shutdown)
+ */
+void
+schedulerd_stop_workers(void)
+{
+    g_list_free_full(pending_jobs, (GDestroyNotify) free_job);
+    pending_jobs = NULL;
+
+    for (GList *iter = workers; iter != NULL; iter = iter->next) {
+        const worker_t *worker = iter->data;
+
+        crm_debug("Killing scheduler worker %lld", (long long) worker->pid);
+        kill(worker->pid, SIGKILL);
+    }
+}
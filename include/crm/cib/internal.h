@@ -40,6 +40,7 @@ extern "C" {
 #define PCMK__CIB_REQUEST_SHUTDOWN      "cib_shutdown_req"
 #define PCMK__CIB_REQUEST_COMMIT_TRANSACT   "cib_commit_transact"
 #define PCMK__CIB_REQUEST_SCHEMAS       "cib_schemas"
+#define PCMK__CIB_REQUEST_STATS         "cib_stats"
 
 /*!
  * \internal
@@ -82,6 +83,7 @@ enum cib__op_type {
     cib__op_sync_one,
     cib__op_upgrade,
     cib__op_schemas,
+    cib__op_stats,
 };
 
 gboolean cib_diff_version_details(xmlNode * diff, int *admin_epoch, int *epoch, int *updates,
@@ -98,10 +100,19 @@ typedef struct cib__operation_s {
     uint32_t flags; //!< Group of <tt>enum cib__op_attr</tt> flags
 } cib__operation_t;
 
+//! Restriction on which changes a CIB diff notification subscriber receives
+typedef struct {
+    char *section;      //!< CIB section name (such as \c PCMK_XE_STATUS)
+    char *node_id;      //!< ID of node whose configuration or state is wanted
+    char *element;      //!< Name of changed element type wanted
+    char *xpath_prefix; //!< Absolute path of CIB subtree wanted
+} cib__notify_filter_t;
+
+typedef struct cib__diff_changes_s cib__diff_changes_t;
+
 typedef struct cib_notify_client_s {
     const char *event;
-    const char *obj_id;         /* implement one day */
-    const char *obj_type;       /* implement one day */
+    cib__notify_filter_t *filter;   // Only for diff notifications (optional)
     void (*callback) (const char *event, xmlNode * msg);
 
 } cib_notify_client_t;
@@ -174,6 +185,107 @@ cib__client_triggers_refresh(const char *name)
 
 int cib__get_notify_patchset(const xmlNode *msg, const xmlNode **patchset);
 
+int cib__notify_filter_new(const char *section, const char *node_id,
+                           const char *element, const char *xpath_prefix,
+                           cib__notify_filter_t **filter);
+void cib__notify_filter_free(void *filter);
+void cib__notify_filter_add_xml(const cib__notify_filter_t *filter,
+                                xmlNode *parent);
+int cib__notify_filters_from_xml(const xmlNode *request, GList **filters);
+void cib__add_notify_filters(const cib_t *cib, const char *event,
+                             xmlNode *request);
+int cib__add_filtered_notify_callback(cib_t *cib,
+                                      void (*callback)(const char *event,
+                                                       xmlNode *msg),
+                                      const cib__notify_filter_t *filter);
+
+typedef struct cib__patchset_ring_s cib__patchset_ring_t;
+
+cib__patchset_ring_t *cib__patchset_ring_new(guint max_entries);
+void cib__patchset_ring_clear(cib__patchset_ring_t *ring);
+void cib__patchset_ring_free(cib__patchset_ring_t *ring);
+guint cib__patchset_ring_length(const cib__patchset_ring_t *ring);
+void cib__patchset_ring_add(cib__patchset_ring_t *ring,
+                            const xmlNode *patchset);
+int cib__patchset_ring_chain(const cib__patchset_ring_t *ring,
+                             const int from[3], const int to[3],
+                             xmlNode *parent);
+int cib__apply_patchset_chain(xmlNode *cib, const xmlNode *chain,
+                              const char *digest);
+
+//! Node status update to be sent as part of a batch
+typedef struct {
+    char *name;             //!< Name of node being updated (or NULL)
+    xmlNode *node_state;    //!< Node state update
+    char *delete_xpath;     //!< What to delete afterward (or NULL)
+    int tag;                //!< Caller-defined value
+} cib__status_update_t;
+
+typedef struct cib__status_batch_s cib__status_batch_t;
+
+cib__status_batch_t *cib__status_batch_new(void);
+void cib__status_batch_clear(cib__status_batch_t *batch);
+void cib__status_batch_free(cib__status_batch_t *batch);
+guint cib__status_batch_length(const cib__status_batch_t *batch);
+const GList *cib__status_batch_updates(const cib__status_batch_t *batch);
+void cib__status_batch_add(cib__status_batch_t *batch, const char *name,
+                           xmlNode *node_state, const char *delete_xpath,
+                           int tag);
+int cib__status_batch_send(cib_t *cib, const cib__status_batch_t *batch,
+                           int *call_id, char **desc);
+
+cib__diff_changes_t *cib__diff_changes_new(const xmlNode *diff);
+void cib__diff_changes_free(cib__diff_changes_t *changes);
+guint cib__diff_changes_count(const cib__diff_changes_t *changes);
+char *cib__diff_changes_match(const cib__diff_changes_t *changes,
+                              const GList *filters, guint *n_matched);
+xmlNode *cib__diff_changes_subset(const cib__diff_changes_t *changes,
+                                  const char *match, xmlNode *parent);
+
+//! Resources used by CIB requests (a single request or a sum of requests)
+typedef struct {
+    uint64_t requests;      //!< Number of requests
+    uint64_t cpu_us;        //!< CPU time processing requests (microseconds)
+    uint64_t bytes_in;      //!< Size of requests received
+    uint64_t bytes_out;     //!< Size of replies sent to requesters
+    uint64_t acl_us;        //!< CPU time filtering by ACLs (microseconds)
+    uint64_t diff_us;       //!< CPU time calculating patchsets and digests
+                            //!< (microseconds)
+    uint64_t notify_us;     //!< CPU time notifying clients (microseconds)
+    uint64_t notifications; //!< Number of notifications sent
+} cib__request_cost_t;
+
+//! Parts of CIB request processing that are accounted separately
+enum cib__cost_phase {
+    cib__cost_acl,          //!< Filtering by ACLs
+    cib__cost_diff,         //!< Calculating patchsets and digests
+    cib__cost_notify,       //!< Notifying clients
+};
+
+//! Resources used by one client or operation type within a statistics window
+typedef struct {
+    char *name;                 //!< Client or operation name
+    cib__request_cost_t cost;   //!< Sum of request costs
+} cib__stats_row_t;
+
+typedef struct cib__stats_s cib__stats_t;
+
+uint64_t cib__thread_cpu_us(void);
+void cib__set_request_cost(cib__request_cost_t *cost);
+cib__request_cost_t *cib__request_cost(void);
+uint64_t cib__cost_phase_start(void);
+void cib__cost_phase_end(enum cib__cost_phase phase, uint64_t start_us);
+
+cib__stats_t *cib__stats_new(guint window_s);
+void cib__stats_free(cib__stats_t *stats);
+guint cib__stats_window(const cib__stats_t *stats);
+void cib__stats_record(cib__stats_t *stats, const char *client, const char *op,
+                       const cib__request_cost_t *cost, time_t now);
+GList *cib__stats_top(cib__stats_t *stats, bool by_client, guint limit,
+                      time_t now);
+void cib__stats_row_free(gpointer data);
+xmlNode *cib__stats_xml(cib__stats_t *stats, guint limit, time_t now);
+
 int cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
                    cib__op_fn_t fn, bool is_query, const char *section,
                    xmlNode *req, xmlNode *input, bool manage_counters,
@@ -230,6 +230,12 @@ struct pcmk__action {
     // Actions in a relation with this one (as pcmk__related_action_t *)
     GList *actions_before;
     GList *actions_after;
+
+    /* Combined relation flags of all orderings with each action in
+     * actions_after (key = pcmk_action_t *, value = flags as pointer), so that
+     * duplicate orderings can be detected without scanning the list
+     */
+    GHashTable *after_flags;
 };
 
 char *pcmk__op_key(const char *rsc_id, const char *op_type, guint interval_ms);
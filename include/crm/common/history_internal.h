@@ -11,6 +11,7 @@
 #define PCMK__CRM_COMMON_HISTORY_INTERNAL__H
 
 #include <stdio.h>                  // NULL
+#include <glib.h>                   // GHashTable
 #include <libxml/tree.h>            // xmlNode
 
 #include <crm/common/xml.h>         // crm_element_value()
@@ -46,6 +47,17 @@ pcmk__xe_history_key(const xmlNode *xml)
     }
 }
 
+/* Version of the compact action history encoding, recorded as the first field
+ * of an entry's PCMK__XA_OP_PACKED attribute
+ */
+#define PCMK__HISTORY_PACKED_VERSION 1
+
+void pcmk__compact_history(xmlNode *lrm, const char *node_name,
+                           GHashTable *uses);
+void pcmk__expand_history(xmlNode *lrm, const char *node_name);
+void pcmk__expand_history_entry(xmlNode *xml_op, GHashTable *digests,
+                                const char *node_name);
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,10 +57,23 @@ int pcmk__substitute_secrets(const char *rsc_id, GHashTable *params);
 
 /* internal main loop utilities (from mainloop.c) */
 
+// Resource usage of a reaped child process
+typedef struct {
+    unsigned int user_ms;       // CPU time spent in user mode
+    unsigned int system_ms;     // CPU time spent in kernel mode
+    unsigned int max_rss_kb;    // Peak resident set size (KiB)
+    unsigned int blocks_in;     // File system input operations
+    unsigned int blocks_out;    // File system output operations
+} pcmk__rusage_t;
+
 int pcmk__add_mainloop_ipc(crm_ipc_t *ipc, int priority, void *userdata,
                            const struct ipc_client_callbacks *callbacks,
                            mainloop_io_t **source);
 guint pcmk__mainloop_timer_get_period(const mainloop_timer_t *timer);
+bool pcmk__mainloop_ipc_pending(const qb_ipcs_connection_t *qbc);
+const pcmk__rusage_t *pcmk__mainloop_child_rusage(const mainloop_child_t *child);
+pid_t pcmk__wait_rusage(pid_t pid, int *status, int options,
+                        pcmk__rusage_t *usage);
 
 
 /* internal node-related XML utilities (from nodes.c) */
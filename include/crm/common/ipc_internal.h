@@ -151,6 +151,9 @@ enum pcmk__client_flags {
 
     //! Client TLS handshake is complete
     pcmk__client_tls_handshake_complete = (UINT64_C(1) << 44),
+
+    //! Client accepts proxied IPC as binary frames (see remote_internal.h)
+    pcmk__client_proxy_frames           = (UINT64_C(1) << 45),
 };
 
 #define PCMK__CLIENT_TYPE(client) ((client)->flags & UINT64_C(0xff00000000))
@@ -179,6 +182,15 @@ struct pcmk__client_s {
 
     unsigned int queue_backlog; /* IPC queue length after last flush */
     unsigned int queue_max;     /* Evict client whose queue grows this big */
+    size_t queued_bytes;        /* Total size of events in event_queue */
+    size_t event_offset;        /* Bytes of first queued event already sent,
+                                 * if it is being sent in parts */
+    GQueue *response_queue;     /* Responses not yet (fully) sent */
+    size_t response_offset;     /* Bytes of first queued response already
+                                 * sent, if it is being sent in parts */
+    uint32_t buffer_size;       /* IPC buffer size of connection (0 if
+                                 * unknown) */
+    uint64_t bytes_sent;        /* Total size of IPC messages sent or queued */
 };
 
 #define pcmk__set_client_flags(client, flags_to_set) do {               \
@@ -241,9 +253,15 @@ int pcmk__ipc_prepare_iov(uint32_t request, const xmlNode *message,
                           struct iovec **result, ssize_t *bytes);
 int pcmk__ipc_send_xml(pcmk__client_t *c, uint32_t request,
                        const xmlNode *message, uint32_t flags);
+int pcmk__ipc_send_text(pcmk__client_t *c, uint32_t request,
+                        const char *text, uint32_t flags);
 int pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags);
 xmlNode *pcmk__client_data2xml(pcmk__client_t *c, void *data,
                                uint32_t *id, uint32_t *flags);
+char *pcmk__client_data2text(pcmk__client_t *c, void *data,
+                             uint32_t *id, uint32_t *flags);
+bool pcmk__ipc_handle_common_request(pcmk__client_t *c, uint32_t id,
+                                     uint32_t flags, const xmlNode *request);
 
 int pcmk__client_pid(qb_ipcs_connection_t *c);
 
@@ -277,6 +295,9 @@ const char *pcmk__pcmkd_state_enum2friendly(enum pcmk_pacemakerd_state state);
 const char *pcmk__controld_api_reply2str(enum pcmk_controld_api_reply reply);
 const char *pcmk__pcmkd_api_reply2str(enum pcmk_pacemakerd_api_reply reply);
 
+int pcmk__schedulerd_api_graph(pcmk_ipc_api_t *api, xmlNode *cib, int priority,
+                               char **ref);
+
 #ifdef __cplusplus
 }
 #endif
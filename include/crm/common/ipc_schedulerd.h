@@ -28,6 +28,7 @@ extern "C" {
 enum pcmk_schedulerd_api_reply {
     pcmk_schedulerd_reply_unknown,
     pcmk_schedulerd_reply_graph,
+    pcmk_schedulerd_reply_cancelled,
 };
 
 /*!
@@ -37,7 +38,7 @@ typedef struct {
     enum pcmk_schedulerd_api_reply reply_type;
 
     union {
-        // pcmk__schedulerd_reply_graph
+        // pcmk__schedulerd_reply_graph, pcmk_schedulerd_reply_cancelled
         struct {
             xmlNode *tgraph;
             const char *reference;
@@ -57,6 +58,22 @@ typedef struct {
  */
 int pcmk_schedulerd_api_graph(pcmk_ipc_api_t *api, xmlNode *cib, char **ref);
 
+/*!
+ * \brief Ask the scheduler to abandon a transition graph calculation
+ *
+ * If the calculation identified by \p ref is still in progress, the scheduler
+ * stops it at the next phase boundary and replies to the original request with
+ * a reply of type \c pcmk_schedulerd_reply_cancelled instead of a graph. A new
+ * graph request from the same client supersedes an in-progress one the same
+ * way, so this is needed only when no new request will be sent.
+ *
+ * \param[in,out] api  IPC API connection
+ * \param[in]     ref  Reference ID of the graph request to cancel
+ *
+ * \return Standard Pacemaker return code
+ */
+int pcmk_schedulerd_api_cancel(pcmk_ipc_api_t *api, const char *ref);
+
 #ifdef __cplusplus
 }
 #endif
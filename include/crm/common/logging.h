@@ -10,6 +10,7 @@
 #ifndef PCMK__CRM_COMMON_LOGGING__H
 #define PCMK__CRM_COMMON_LOGGING__H
 
+#include <stdbool.h>            // bool
 #include <stdio.h>
 #include <stdint.h>             // uint8_t, uint32_t
 #include <glib.h>
@@ -135,6 +136,41 @@ pcmk__clip_log_level(int level)
     return level;
 }
 
+/* @COMPAT: Make these internal at a compatibility break. They're used in public
+ * macros for now.
+ */
+extern int pcmk__log_capturing;
+bool pcmk__capturing_logs(void);
+void pcmk__log_capture(const char *file, const char *function, uint32_t line,
+                       uint32_t tags, uint8_t level, const char *format, ...)
+    G_GNUC_PRINTF(6, 7);
+
+/*!
+ * \internal
+ * \brief Capture a log message if the current thread is capturing its logs
+ *
+ * \param[in] file      Source file name to use for message
+ * \param[in] function  Source function name to use for message
+ * \param[in] line      Source line number to use for message
+ * \param[in] tags      Log tags for message
+ * \param[in] level     Priority of message
+ * \param[in] fmt       printf-style format string for message
+ * \param[in] args      Any arguments needed by format string
+ *
+ * \return \c true if the message was captured (in which case it must not be
+ *         logged), otherwise \c false (in which case \p args were not
+ *         evaluated)
+ */
+#define pcmk__log_captured_as(file, function, line, tags, level, fmt, args...) \
+    ((g_atomic_int_get(&pcmk__log_capturing) > 0)                          \
+     && pcmk__capturing_logs()                                             \
+     && (pcmk__log_capture((file), (function), (line), (tags), (level),    \
+                           fmt , ##args), true))
+
+#define pcmk__log_captured(level, tags, fmt, args...)                      \
+    pcmk__log_captured_as(__FILE__, __func__, __LINE__, (tags), (level),   \
+                          fmt , ##args)
+
 /* Using "switch" instead of "if" in these macro definitions keeps
  * static analysis from complaining about constant evaluations
  */
@@ -156,8 +192,11 @@ pcmk__clip_log_level(int level)
             case LOG_NEVER:                                                 \
                 break;                                                      \
             default:                                                        \
-                qb_log_from_external_source(__func__, __FILE__, fmt,        \
-                                            _level, __LINE__, 0 , ##args);  \
+                if (!pcmk__log_captured(_level, 0, fmt , ##args)) {         \
+                    qb_log_from_external_source(__func__, __FILE__, fmt,    \
+                                                _level, __LINE__, 0 ,       \
+                                                ##args);                    \
+                }                                                           \
                 break;                                                      \
         }                                                                   \
     } while (0)
@@ -183,7 +222,8 @@ pcmk__clip_log_level(int level)
                     trace_cs = qb_log_callsite_get(__func__, __FILE__, fmt, \
                                                    _level, __LINE__, 0);    \
                 }                                                           \
-                if (crm_is_callsite_active(trace_cs, _level, 0)) {          \
+                if (crm_is_callsite_active(trace_cs, _level, 0)             \
+                    && !pcmk__log_captured(_level, 0, fmt , ##args)) {      \
                     qb_log_from_external_source(__func__, __FILE__, fmt,    \
                                                 _level, __LINE__, 0 ,       \
                                                 ##args);                    \
@@ -275,8 +315,11 @@ pcmk__clip_log_level(int level)
             case LOG_NEVER:                                                 \
                 break;                                                      \
             default:                                                        \
-                qb_log_from_external_source(function, file, fmt, _level,    \
-                                            line, 0 , ##args);              \
+                if (!pcmk__log_captured_as(file, function, line, 0, _level, \
+                                           fmt , ##args)) {                 \
+                    qb_log_from_external_source(function, file, fmt,        \
+                                                _level, line, 0 , ##args);  \
+                }                                                           \
                 break;                                                      \
         }                                                                   \
     } while (0)
@@ -343,7 +386,9 @@ pcmk__clip_log_level(int level)
                                                        converted_tag);      \
                 }                                                           \
                 if (crm_is_callsite_active(trace_tag_cs, _level,            \
-                                           converted_tag)) {                \
+                                           converted_tag)                   \
+                    && !pcmk__log_captured(_level, converted_tag,           \
+                                           fmt , ##args)) {                 \
                     qb_log_from_external_source(__func__, __FILE__, fmt,    \
                                                 _level, __LINE__,           \
                                                 converted_tag , ##args);    \
@@ -352,19 +397,33 @@ pcmk__clip_log_level(int level)
         }                                                                   \
     } while (0)
 
-#define crm_emerg(fmt, args...)   qb_log(LOG_EMERG,       fmt , ##args)
-#define crm_crit(fmt, args...)    qb_logt(LOG_CRIT,    0, fmt , ##args)
+/*!
+ * \internal
+ * \brief Log a message that is likely to be logged (unless captured)
+ *
+ * \param[in] level  Priority at which to log the message
+ * \param[in] fmt    printf-style format string literal for message
+ * \param[in] args   Any arguments needed by format string
+ */
+#define pcmk__logt(level, fmt, args...) do {                                \
+        if (!pcmk__log_captured((level), 0, fmt , ##args)) {                \
+            qb_logt((level), 0, fmt , ##args);                              \
+        }                                                                   \
+    } while (0)
+
+#define crm_emerg(fmt, args...)   pcmk__logt(LOG_EMERG,   fmt , ##args)
+#define crm_crit(fmt, args...)    pcmk__logt(LOG_CRIT,    fmt , ##args)
 
 // NOTE: sbd (as of at least 1.5.2) uses this
-#define crm_err(fmt, args...)     qb_logt(LOG_ERR,     0, fmt , ##args)
+#define crm_err(fmt, args...)     pcmk__logt(LOG_ERR,     fmt , ##args)
 
 // NOTE: sbd (as of at least 1.5.2) uses this
-#define crm_warn(fmt, args...)    qb_logt(LOG_WARNING, 0, fmt , ##args)
+#define crm_warn(fmt, args...)    pcmk__logt(LOG_WARNING, fmt , ##args)
 
 // NOTE: sbd (as of at least 1.5.2) uses this
-#define crm_notice(fmt, args...)  qb_logt(LOG_NOTICE,  0, fmt , ##args)
+#define crm_notice(fmt, args...)  pcmk__logt(LOG_NOTICE,  fmt , ##args)
 
-#define crm_info(fmt, args...)    qb_logt(LOG_INFO,    0, fmt , ##args)
+#define crm_info(fmt, args...)    pcmk__logt(LOG_INFO,    fmt , ##args)
                                                 //
 // NOTE: sbd (as of at least 1.5.2) uses this
 #define crm_debug(fmt, args...)   do_crm_log_unlikely(LOG_DEBUG, fmt , ##args)
@@ -10,7 +10,11 @@
 #ifndef PCMK__CRM_COMMON_LOGGING_INTERNAL__H
 #define PCMK__CRM_COMMON_LOGGING_INTERNAL__H
 
+#include <stdbool.h>         // bool
+#include <time.h>            // time_t
+
 #include <glib.h>
+#include <libxml/tree.h>     // xmlNode
 
 #include <crm/common/logging.h>
 #include <crm/common/output_internal.h>
@@ -86,6 +90,12 @@ extern bool pcmk__config_has_error;
  */
 extern bool pcmk__config_has_warning;
 
+void pcmk__log_capture_config(bool error, const char *file,
+                              const char *function, uint32_t line,
+                              const char *format, ...) G_GNUC_PRINTF(5, 6);
+void pcmk__capture_logs(GList **captured);
+void pcmk__replay_logs(GList *captured);
+
 /*!
  * \internal
  * \brief Log an error and make crm_verify return failure status
@@ -93,6 +103,11 @@ extern bool pcmk__config_has_warning;
  * \param[in] fmt...  printf(3)-style format string and arguments
  */
 #define pcmk__config_err(fmt...) do {                               \
+        if (pcmk__capturing_logs()) {                               \
+            pcmk__log_capture_config(true, __FILE__, __func__,      \
+                                     __LINE__, fmt);                \
+            break;                                                  \
+        }                                                           \
         pcmk__config_has_error = true;                              \
         if (pcmk__config_error_handler == NULL) {                   \
             crm_err(fmt);                                           \
@@ -108,6 +123,11 @@ extern bool pcmk__config_has_warning;
  * \param[in] fmt...  printf(3)-style format string and arguments
  */
 #define pcmk__config_warn(fmt...) do {                                      \
+        if (pcmk__capturing_logs()) {                                       \
+            pcmk__log_capture_config(false, __FILE__, __func__, __LINE__,   \
+                                     fmt);                                  \
+            break;                                                          \
+        }                                                                   \
         pcmk__config_has_warning = true;                                    \
         if (pcmk__config_warning_handler == NULL) {                         \
             crm_warn(fmt);                                                  \
@@ -231,6 +251,33 @@ void pcmk__add_logfiles(gchar **log_files, pcmk__output_t *out);
 
 void pcmk__free_common_logger(void);
 
+//! Types of trace filter that may be changed while a daemon is running
+enum pcmk__log_filter_type {
+    pcmk__log_filter_function,  //!< Trace messages logged by a function
+    pcmk__log_filter_file,      //!< Trace messages logged by a source file
+    pcmk__log_filter_format,    //!< Trace messages containing format text
+    pcmk__log_filter_tag,       //!< Trace messages with a tag
+};
+
+const char *pcmk__log_filter_type_text(enum pcmk__log_filter_type type);
+int pcmk__parse_log_filter_type(const char *text,
+                                enum pcmk__log_filter_type *type);
+int pcmk__parse_log_level(const char *text, unsigned int *level);
+const char *pcmk__log_level_text(unsigned int level);
+
+int pcmk__add_log_filter(enum pcmk__log_filter_type type, const char *pattern,
+                         guint ttl_s, time_t now);
+int pcmk__remove_log_filter(enum pcmk__log_filter_type type,
+                            const char *pattern);
+void pcmk__clear_log_filters(void);
+bool pcmk__log_filter_active(enum pcmk__log_filter_type type,
+                             const char *pattern);
+void pcmk__override_log_level(unsigned int level, guint ttl_s, time_t now);
+time_t pcmk__expire_log_control(time_t now);
+int pcmk__apply_log_control(const xmlNode *request, time_t now,
+                            char **reason);
+void pcmk__log_control_state(xmlNode *xml, time_t now);
+
 #ifdef __cplusplus
 }
 #endif
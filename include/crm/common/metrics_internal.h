@@ -0,0 +1,103 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#ifndef PCMK__CRM_COMMON_METRICS_INTERNAL__H
+#define PCMK__CRM_COMMON_METRICS_INTERNAL__H
+
+#include <stdint.h>             // int64_t, uint64_t
+
+#include <glib.h>               // gsize, gint64
+#include <libxml/tree.h>        // xmlNode
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Kinds of performance metric
+enum pcmk__metric_type {
+    pcmk__metric_counter,       //!< Count that only increases
+    pcmk__metric_gauge,         //!< Value that may increase or decrease
+    pcmk__metric_histogram,     //!< Distribution of observed values
+};
+
+/* Histograms are log-linear: each power of two is divided into
+ * 2^PCMK__HISTOGRAM_SUB_BITS equal buckets, so any observation is known to
+ * within 12.5% without any configuration of bucket boundaries.
+ */
+#define PCMK__HISTOGRAM_SUB_BITS    3
+#define PCMK__HISTOGRAM_BUCKETS     \
+    ((64 - PCMK__HISTOGRAM_SUB_BITS + 1) << PCMK__HISTOGRAM_SUB_BITS)
+
+/*!
+ * \internal
+ * \brief Performance metric
+ *
+ * Metrics are meant to be statically allocated where they are updated, using
+ * \c PCMK__METRIC(). A metric is registered (so that it is exported) the first
+ * time it is updated. Updates are atomic, so they are safe from any thread
+ * without locking.
+ */
+typedef struct {
+    const char *name;               //!< Name (letters, digits, underscores)
+    const char *help;               //!< Description
+    enum pcmk__metric_type type;    //!< Kind of metric
+
+    // The rest should be accessed only via the functions below
+    gsize registered;               //!< Whether metric has been registered
+    int64_t value;                  //!< Counter or gauge value
+    uint64_t count;                 //!< Number of histogram observations
+    uint64_t sum;                   //!< Sum of histogram observations
+    uint64_t max;                   //!< Largest histogram observation
+    uint64_t *buckets;              //!< Histogram bucket counts
+} pcmk__metric_t;
+
+//! Initializer for a statically allocated metric
+#define PCMK__METRIC(metric_type, metric_name, metric_help) { \
+        .name = (metric_name),                                \
+        .help = (metric_help),                                \
+        .type = (metric_type),                                \
+    }
+
+void pcmk__metric_add(pcmk__metric_t *metric, int64_t delta);
+void pcmk__metric_set(pcmk__metric_t *metric, int64_t value);
+void pcmk__metric_observe(pcmk__metric_t *metric, uint64_t value);
+
+/*!
+ * \internal
+ * \brief Add the time elapsed since a starting point to a histogram
+ *
+ * \param[in,out] metric    Histogram to update
+ * \param[in]     start_us  Starting point from \c g_get_monotonic_time()
+ */
+static inline void
+pcmk__metric_observe_since(pcmk__metric_t *metric, gint64 start_us)
+{
+    gint64 elapsed = g_get_monotonic_time() - start_us;
+
+    pcmk__metric_observe(metric, (elapsed > 0)? (uint64_t) elapsed : 0);
+}
+
+int64_t pcmk__metric_value(const pcmk__metric_t *metric);
+uint64_t pcmk__metric_quantile(const pcmk__metric_t *metric, double quantile);
+
+unsigned int pcmk__histogram_bucket(uint64_t value);
+uint64_t pcmk__histogram_bucket_min(unsigned int bucket);
+uint64_t pcmk__histogram_bucket_max(unsigned int bucket);
+
+void pcmk__metrics_xml(xmlNode *parent);
+char *pcmk__metrics_text(const char *daemon);
+int pcmk__write_metrics(const char *directory, const char *daemon);
+void pcmk__start_metrics_export(const char *daemon);
+void pcmk__reset_metrics(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PCMK__CRM_COMMON_METRICS_INTERNAL__H
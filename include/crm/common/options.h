@@ -55,7 +55,9 @@ extern     "C" {
 #define PCMK_OPT_PE_INPUT_SERIES_MAX            "pe-input-series-max"
 #define PCMK_OPT_PE_WARN_SERIES_MAX             "pe-warn-series-max"
 #define PCMK_OPT_PLACEMENT_STRATEGY             "placement-strategy"
+#define PCMK_OPT_PLACEMENT_SEARCH_LIMIT         "placement-search-limit"
 #define PCMK_OPT_PRIORITY_FENCING_DELAY         "priority-fencing-delay"
+#define PCMK_OPT_RESOURCE_HISTORY_FORMAT        "resource-history-format"
 #define PCMK_OPT_SHUTDOWN_ESCALATION            "shutdown-escalation"
 #define PCMK_OPT_SHUTDOWN_LOCK                  "shutdown-lock"
 #define PCMK_OPT_SHUTDOWN_LOCK_LIMIT            "shutdown-lock-limit"
@@ -135,6 +137,7 @@ extern     "C" {
 #define PCMK_VALUE_BLOCK                        "block"
 #define PCMK_VALUE_BOOLEAN                      "boolean"
 #define PCMK_VALUE_CIB_BOOTSTRAP_OPTIONS        "cib-bootstrap-options"
+#define PCMK_VALUE_COMPACT                      "compact"
 #define PCMK_VALUE_COROSYNC                     "corosync"
 #define PCMK_VALUE_CRASH                        "crash"
 #define PCMK_VALUE_CREATE                       "create"
@@ -154,6 +157,7 @@ extern     "C" {
 #define PCMK_VALUE_FENCE                        "fence"
 #define PCMK_VALUE_FENCING                      "fencing"
 #define PCMK_VALUE_FREEZE                       "freeze"
+#define PCMK_VALUE_FULL                         "full"
 #define PCMK_VALUE_GRANTED                      "granted"
 #define PCMK_VALUE_GREEN                        "green"
 #define PCMK_VALUE_GT                           "gt"
@@ -187,6 +191,7 @@ extern     "C" {
 #define PCMK_VALUE_ONLY_GREEN                   "only-green"
 #define PCMK_VALUE_OPTIONAL                     "Optional"
 #define PCMK_VALUE_OR                           "or"
+#define PCMK_VALUE_PACKED                       "packed"
 #define PCMK_VALUE_PANIC                        "panic"
 #define PCMK_VALUE_PARAM                        "param"
 #define PCMK_VALUE_PENDING                      "pending"
@@ -137,12 +137,15 @@ bool pcmk__valid_stonith_watchdog_timeout(const char *value);
 #define PCMK__ENV_DH_MAX_BITS               "dh_max_bits"
 #define PCMK__ENV_FAIL_FAST                 "fail_fast"
 #define PCMK__ENV_IPC_BUFFER                "ipc_buffer"
+#define PCMK__ENV_IPC_QUEUE_BUDGET          "ipc_queue_budget"
 #define PCMK__ENV_IPC_TYPE                  "ipc_type"
 #define PCMK__ENV_KEY_FILE                  "key_file"
 #define PCMK__ENV_LOGFACILITY               "logfacility"
 #define PCMK__ENV_LOGFILE                   "logfile"
 #define PCMK__ENV_LOGFILE_MODE              "logfile_mode"
 #define PCMK__ENV_LOGPRIORITY               "logpriority"
+#define PCMK__ENV_METRICS_DIRECTORY         "metrics_directory"
+#define PCMK__ENV_METRICS_INTERVAL          "metrics_interval"
 #define PCMK__ENV_NODE_ACTION_LIMIT         "node_action_limit"
 #define PCMK__ENV_NODE_START_STATE          "node_start_state"
 #define PCMK__ENV_PANIC_ACTION              "panic_action"
@@ -151,6 +154,11 @@ bool pcmk__valid_stonith_watchdog_timeout(const char *value);
 #define PCMK__ENV_REMOTE_PID1               "remote_pid1"
 #define PCMK__ENV_REMOTE_PORT               "remote_port"
 #define PCMK__ENV_RESPAWNED                 "respawned"
+#define PCMK__ENV_SCHEDULER_ASSIGN_THREADS  "scheduler_assign_threads"
+#define PCMK__ENV_SCHEDULER_CLIENT_WORKERS  "scheduler_client_workers"
+#define PCMK__ENV_SCHEDULER_INPUT_ARCHIVE   "scheduler_input_archive"
+#define PCMK__ENV_SCHEDULER_WORKER_MEMORY   "scheduler_worker_memory"
+#define PCMK__ENV_SCHEDULER_WORKERS         "scheduler_workers"
 #define PCMK__ENV_SCHEMA_DIRECTORY          "schema_directory"
 #define PCMK__ENV_SERVICE                   "service"
 #define PCMK__ENV_STDERR                    "stderr"
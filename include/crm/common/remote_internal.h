@@ -12,6 +12,7 @@
 
 #include <stdio.h>          // NULL
 #include <stdbool.h>        // bool
+#include <stdint.h>         // uint32_t
 #include <libxml/tree.h>    // xmlNode
 
 #include <crm/common/ipc_internal.h>        // pcmk__client_t
@@ -27,7 +28,41 @@ extern "C" {
 
 typedef struct pcmk__remote_s pcmk__remote_t;
 
+//! Type of IPC message carried by a proxy frame
+enum pcmk__proxy_op {
+    pcmk__proxy_request     = 1,    //!< Request from local client to server
+    pcmk__proxy_response    = 2,    //!< Reply from server to local client
+    pcmk__proxy_event       = 3,    //!< Event from server to local client
+};
+
+/*!
+ * \internal
+ * \brief IPC message forwarded opaquely over a Pacemaker Remote connection
+ *
+ * Instead of wrapping a proxied IPC message in an XML envelope, a proxy frame
+ * carries the original message text after a small binary header, so neither
+ * end needs to parse, copy, and serialize it again.
+ *
+ * \note When received, the string members point into the connection's
+ *       message buffer and are valid only until the next read.
+ */
+typedef struct {
+    enum pcmk__proxy_op op;     //!< Type of message
+    uint32_t msg_id;            //!< IPC request ID (for requests and responses)
+    uint32_t ipc_flags;         //!< Group of enum crm_ipc_flags (requests only)
+    const char *session;        //!< IPC proxy session ID
+    const char *client;         //!< Local client name (requests only, or NULL)
+    const char *user;           //!< Local client user (requests only, or NULL)
+    const char *payload;        //!< IPC message text (null-terminated)
+    size_t payload_len;         //!< Bytes in payload, including terminator
+} pcmk__proxy_frame_t;
+
 int pcmk__remote_send_xml(pcmk__remote_t *remote, const xmlNode *msg);
+int pcmk__remote_send_proxy_frame(pcmk__remote_t *remote,
+                                  const pcmk__proxy_frame_t *frame);
+bool pcmk__remote_message_is_proxy_frame(pcmk__remote_t *remote);
+int pcmk__remote_message_proxy_frame(pcmk__remote_t *remote,
+                                     pcmk__proxy_frame_t *frame);
 int pcmk__remote_ready(const pcmk__remote_t *remote, int timeout_ms);
 int pcmk__read_available_remote_data(pcmk__remote_t *remote);
 int pcmk__read_remote_message(pcmk__remote_t *remote, int timeout_ms);
@@ -137,6 +137,12 @@ enum pcmk__rsc_flags {
     // Whether resource is probed only on nodes marked exclusive
     pcmk__rsc_exclusive_probes       = (1ULL << 20),
 
+    /*
+     * Whether resource's history has been unpacked despite
+     * \c pcmk__sched_no_history (set on topmost collective resource only)
+     */
+    pcmk__rsc_history_unpacked       = (1ULL << 21),
+
     /*
      * Whether resource is multiply active with recovery set to
      * \c PCMK_VALUE_STOP_UNEXPECTED
@@ -126,6 +126,11 @@ enum pcmk__scheduler_flags {
     // Whether the cluster includes any Pacemaker Remote nodes (via CIB)
     pcmk__sched_have_remote_nodes       = (1ULL << 18),
 
+    /*
+     * Whether the scheduling sequence was abandoned at a phase boundary
+     * because the caller's cancellation check reported the input superseded
+     */
+    pcmk__sched_cancelled               = (1ULL << 19),
 
     /* The remaining flags are scheduling options that must be set explicitly */
 
@@ -139,6 +144,15 @@ enum pcmk__scheduler_flags {
     // Whether sensitive resource attributes have been masked
     pcmk__sched_sanitized               = (1ULL << 21),
 
+    /*
+     * Whether to unpack only node membership and state from the CIB status
+     * section, skipping resource history other than that of Pacemaker Remote
+     * connections and their launchers (which determine whether remote and
+     * guest nodes are online). A resource's history can be unpacked later via
+     * pe__unpack_rsc_history().
+     */
+    pcmk__sched_no_history              = (1ULL << 22),
+
     // Skip counting of total, disabled, and blocked resource instances
     pcmk__sched_no_counts               = (1ULL << 23),
 
@@ -170,6 +184,7 @@ struct pcmk__scheduler_private {
     guint shutdown_lock_ms;         // How long to lock resources (in ms)
     guint node_pending_ms;          // Pending join times out after this (in ms)
     const char *placement_strategy; // Value of placement-strategy property
+    int placement_search_limit;     // Packed placement search budget (steps)
     xmlNode *rsc_defaults;          // Configured resource defaults
     xmlNode *op_defaults;           // Configured operation defaults
     GList *resources;               // Resources in cluster
@@ -181,6 +196,7 @@ struct pcmk__scheduler_private {
     xmlNode *failed;                // History entries of failed actions
     GList *param_check;             // History entries that need to be checked
     GList *stop_needed;             // Containers that need stop actions
+    GList *lazy_history;            // Node state entries with skipped history
     GList *location_constraints;    // Location constraints
     GList *colocation_constraints;  // Colocation constraints
     GList *ordering_constraints;    // Ordering constraints
@@ -192,11 +208,20 @@ struct pcmk__scheduler_private {
     time_t recheck_by;              // Hint to controller when to reschedule
     xmlNode *graph;                 // Transition graph
     int synapse_count;              // Number of transition graph synapses
+
+    // If set, called at scheduling phase boundaries (true means abandon run)
+    bool (*cancel_check)(pcmk_scheduler_t *scheduler, void *user_data);
+    void *cancel_data;              // User data to pass to cancel_check()
 };
 
 // Group of enum pcmk__warnings flags for warnings we want to log once
 extern uint32_t pcmk__warnings;
 
+void pcmk__log_capture_sched(pcmk_scheduler_t *scheduler, bool error,
+                             const char *file, const char *function,
+                             uint32_t line, const char *format, ...)
+    G_GNUC_PRINTF(6, 7);
+
 /*!
  * \internal
  * \brief Log a resource-tagged message at info severity
@@ -235,6 +260,11 @@ extern uint32_t pcmk__warnings;
  * \param[in]     fmt...     printf(3)-style format and arguments
  */
 #define pcmk__sched_err(scheduler, fmt...) do {                     \
+        if (pcmk__capturing_logs()) {                               \
+            pcmk__log_capture_sched((scheduler), true, __FILE__,    \
+                                    __func__, __LINE__, fmt);       \
+            break;                                                  \
+        }                                                           \
         pcmk__set_scheduler_flags((scheduler),                      \
                                   pcmk__sched_processing_error);    \
         crm_err(fmt);                                               \
@@ -248,6 +278,11 @@ extern uint32_t pcmk__warnings;
  * \param[in]     fmt...     printf(3)-style format and arguments
  */
 #define pcmk__sched_warn(scheduler, fmt...) do {                    \
+        if (pcmk__capturing_logs()) {                               \
+            pcmk__log_capture_sched((scheduler), false, __FILE__,   \
+                                    __func__, __LINE__, fmt);       \
+            break;                                                  \
+        }                                                           \
         pcmk__set_scheduler_flags((scheduler),                      \
                                   pcmk__sched_processing_warning);  \
         crm_warn(fmt);                                              \
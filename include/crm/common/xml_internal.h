@@ -352,6 +352,9 @@ void pcmk__xml_free(xmlNode *xml);
 void pcmk__xml_free_doc(xmlDoc *doc);
 xmlNode *pcmk__xml_copy(xmlNode *parent, xmlNode *src);
 
+void pcmk__xml_doc_index_ids(xmlDoc *doc);
+bool pcmk__xml_doc_ids_indexed(const xmlDoc *doc);
+
 /*!
  * \internal
  * \enum pcmk__xa_flags
@@ -449,6 +452,8 @@ pcmk__xml_attr_value(const xmlAttr *attr)
 bool pcmk__cib_element_in_patchset(const xmlNode *patchset,
                                    const char *element);
 
+xmlNode *pcmk__patchset_without(const xmlNode *patchset, const char *element);
+
 #ifdef __cplusplus
 }
 #endif
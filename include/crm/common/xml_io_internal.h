@@ -35,6 +35,17 @@ int pcmk__xml_write_fd(const xmlNode *xml, const char *filename, int fd);
 int pcmk__xml_write_file(const xmlNode *xml, const char *filename,
                          bool compress);
 
+//! XML archive (opaque)
+typedef struct pcmk__xml_archive_s pcmk__xml_archive_t;
+
+int pcmk__xml_archive_open(const char *directory, const char *series,
+                           guint interval, pcmk__xml_archive_t **archive);
+int pcmk__xml_archive_add(pcmk__xml_archive_t *archive, unsigned int sequence,
+                          const xmlNode *xml);
+void pcmk__xml_archive_free(pcmk__xml_archive_t *archive);
+int pcmk__xml_archive_read(const char *directory, const char *series,
+                           unsigned int sequence, xmlNode **xml);
+
 #ifdef __cplusplus
 }
 #endif
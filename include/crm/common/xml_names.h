@@ -126,9 +126,12 @@ extern "C" {
 #define PCMK_XE_LAST_FENCED                 "last-fenced"
 #define PCMK_XE_LAST_UPDATE                 "last_update"
 #define PCMK_XE_LIST                        "list"
+#define PCMK_XE_LOG_CONTROL                 "log-control"
 #define PCMK_XE_LONGDESC                    "longdesc"
 #define PCMK_XE_META_ATTRIBUTES             "meta_attributes"
 #define PCMK_XE_METADATA                    "metadata"
+#define PCMK_XE_METRIC                      "metric"
+#define PCMK_XE_METRICS                     "metrics"
 #define PCMK_XE_MODIFICATIONS               "modifications"
 #define PCMK_XE_MODIFY_NODE                 "modify_node"
 #define PCMK_XE_MODIFY_TICKET               "modify_ticket"
@@ -213,6 +216,7 @@ extern "C" {
 #define PCMK_XE_TICKETS                     "tickets"
 #define PCMK_XE_TIMING                      "timing"
 #define PCMK_XE_TIMINGS                     "timings"
+#define PCMK_XE_TRACE_FILTER                "trace-filter"
 #define PCMK_XE_TRANSITION                  "transition"
 #define PCMK_XE_UTILIZATION                 "utilization"
 #define PCMK_XE_UTILIZATIONS                "utilizations"
@@ -237,6 +241,8 @@ extern "C" {
 #define PCMK_XA_AUTHOR                      "author"
 #define PCMK_XA_AUTOMATIC                   "automatic"
 #define PCMK_XA_BLOCKED                     "blocked"
+#define PCMK_XA_BLOCKS_IN                   "blocks-in"
+#define PCMK_XA_BLOCKS_OUT                  "blocks-out"
 #define PCMK_XA_BOOLEAN_OP                  "boolean-op"
 #define PCMK_XA_BUILD                       "build"
 #define PCMK_XA_CACHED                      "cached"
@@ -250,6 +256,8 @@ extern "C" {
 #define PCMK_XA_COMPLETED                   "completed"
 #define PCMK_XA_CONTROL_PORT                "control-port"
 #define PCMK_XA_COUNT                       "count"
+#define PCMK_XA_CPU_SYSTEM_TIME             "cpu-system-time"
+#define PCMK_XA_CPU_USER_TIME               "cpu-user-time"
 #define PCMK_XA_CRM_DEBUG_ORIGIN            "crm-debug-origin"
 #define PCMK_XA_CRM_FEATURE_SET             "crm_feature_set"
 #define PCMK_XA_CRM_TIMESTAMP               "crm-timestamp"
@@ -278,6 +286,7 @@ extern "C" {
 #define PCMK_XA_EXPECTED                    "expected"
 #define PCMK_XA_EXPECTED_UP                 "expected_up"
 #define PCMK_XA_EXPIRES                     "expires"
+#define PCMK_XA_EXPIRES_IN                  "expires-in"
 #define PCMK_XA_EXTENDED_STATUS             "extended-status"
 #define PCMK_XA_FAIL_COUNT                  "fail-count"
 #define PCMK_XA_FAILED                      "failed"
@@ -317,10 +326,13 @@ extern "C" {
 #define PCMK_XA_LAST_UPDATED                "last_updated"
 #define PCMK_XA_LOCKED_TO                   "locked_to"
 #define PCMK_XA_LOCKED_TO_HYPHEN            "locked-to"
+#define PCMK_XA_LOG_LEVEL                   "log-level"
 #define PCMK_XA_LOSS_POLICY                 "loss-policy"
 #define PCMK_XA_MAINTENANCE                 "maintenance"
 #define PCMK_XA_MAINTENANCE_MODE            "maintenance-mode"
 #define PCMK_XA_MANAGED                     "managed"
+#define PCMK_XA_MAX                         "max"
+#define PCMK_XA_MAX_RSS                     "max-rss"
 #define PCMK_XA_MESSAGE                     "message"
 #define PCMK_XA_MINUTES                     "minutes"
 #define PCMK_XA_MIXED_VERSION               "mixed_version"
@@ -351,6 +363,9 @@ extern "C" {
 #define PCMK_XA_ORIGIN                      "origin"
 #define PCMK_XA_ORPHAN                      "orphan"
 #define PCMK_XA_ORPHANED                    "orphaned"
+#define PCMK_XA_P50                         "p50"
+#define PCMK_XA_P90                         "p90"
+#define PCMK_XA_P99                         "p99"
 #define PCMK_XA_PACEMAKERD_STATE            "pacemakerd-state"
 #define PCMK_XA_PATH                        "path"
 #define PCMK_XA_PENDING                     "pending"
@@ -411,6 +426,7 @@ extern "C" {
 #define PCMK_XA_STONITH_ENABLED             "stonith-enabled"
 #define PCMK_XA_STONITH_TIMEOUT_MS          "stonith-timeout-ms"
 #define PCMK_XA_STOP_ALL_RESOURCES          "stop-all-resources"
+#define PCMK_XA_SUM                         "sum"
 #define PCMK_XA_SYMMETRIC_CLUSTER           "symmetric-cluster"
 #define PCMK_XA_SYMMETRICAL                 "symmetrical"
 #define PCMK_XA_SYS_FROM                    "sys_from"
@@ -24,10 +24,14 @@ extern "C" {
 #define PCMK__XE_CIB_CALLBACK           "cib-callback"
 #define PCMK__XE_CIB_CALLDATA           "cib_calldata"
 #define PCMK__XE_CIB_COMMAND            "cib_command"
+#define PCMK__XE_CIB_NOTIFY_FILTER      "cib_notify_filter"
+#define PCMK__XE_CIB_PATCHSETS          "cib_patchsets"
 #define PCMK__XE_CIB_REPLY              "cib-reply"
 #define PCMK__XE_CIB_RESULT             "cib_result"
+#define PCMK__XE_CIB_STATS              "cib_stats"
 #define PCMK__XE_CIB_TRANSACTION        "cib_transaction"
 #define PCMK__XE_CIB_UPDATE_RESULT      "cib_update_result"
+#define PCMK__XE_CLIENT                 "client"
 #define PCMK__XE_COPY                   "copy"
 #define PCMK__XE_CRM_EVENT              "crm_event"
 #define PCMK__XE_CRM_XML                "crm_xml"
@@ -36,8 +40,13 @@ extern "C" {
 #define PCMK__XE_EXIT_NOTIFICATION      "exit-notification"
 #define PCMK__XE_FAILED_UPDATE          "failed_update"
 #define PCMK__XE_GENERATION_TUPLE       "generation_tuple"
+#define PCMK__XE_GET_METRICS            "get_metrics"
 #define PCMK__XE_INPUTS                 "inputs"
+#define PCMK__XE_LOG_CONTROL            "log_control"
+#define PCMK__XE_LOG_FILTER             "log_filter"
 #define PCMK__XE_LRM                    "lrm"
+#define PCMK__XE_LRM_DIGEST             "lrm_digest"
+#define PCMK__XE_LRM_DIGESTS            "lrm_digests"
 #define PCMK__XE_LRM_RESOURCE           "lrm_resource"
 #define PCMK__XE_LRM_RESOURCES          "lrm_resources"
 #define PCMK__XE_LRM_RSC_OP             "lrm_rsc_op"
@@ -47,6 +56,7 @@ extern "C" {
 #define PCMK__XE_LRMD_IPC_MSG           "lrmd_ipc_msg"
 #define PCMK__XE_LRMD_IPC_PROXY         "lrmd_ipc_proxy"
 #define PCMK__XE_LRMD_NOTIFY            "lrmd_notify"
+#define PCMK__XE_LRMD_NOTIFY_FILTER     "lrmd_notify_filter"
 #define PCMK__XE_LRMD_REPLY             "lrmd_reply"
 #define PCMK__XE_LRMD_RSC               "lrmd_rsc"
 #define PCMK__XE_LRMD_RSC_OP            "lrmd_rsc_op"
@@ -63,6 +73,7 @@ extern "C" {
 #define PCMK__XE_PSEUDO_EVENT           "pseudo_event"
 #define PCMK__XE_RESOURCE_SETTINGS      "resource-settings"
 #define PCMK__XE_RSC_OP                 "rsc_op"
+#define PCMK__XE_RSC_OPS                "rsc_ops"
 #define PCMK__XE_SHUTDOWN               "shutdown"
 #define PCMK__XE_SPAN                   "span"
 #define PCMK__XE_ST_ASYNC_TIMEOUT_VALUE "st-async-timeout-value"
@@ -95,6 +106,7 @@ extern "C" {
  */
 
 #define PCMK__XA_ACL_TARGET             "acl_target"
+#define PCMK__XA_ACL_US                 "acl-us"
 #define PCMK__XA_ATTR_CLEAR_INTERVAL    "attr_clear_interval"
 #define PCMK__XA_ATTR_CLEAR_OPERATION   "attr_clear_operation"
 #define PCMK__XA_ATTR_DAMPENING         "attr_dampening"
@@ -114,16 +126,23 @@ extern "C" {
 #define PCMK__XA_ATTR_VERSION           "attr_version"
 #define PCMK__XA_ATTR_WRITER            "attr_writer"
 #define PCMK__XA_ATTRD_IS_FORCE_WRITE   "attrd_is_force_write"
+#define PCMK__XA_BYTES_IN               "bytes-in"
+#define PCMK__XA_BYTES_OUT              "bytes-out"
 #define PCMK__XA_CALL_ID                "call-id"
 #define PCMK__XA_CIB_CALLID             "cib_callid"
 #define PCMK__XA_CIB_CALLOPT            "cib_callopt"
 #define PCMK__XA_CIB_CLIENTID           "cib_clientid"
 #define PCMK__XA_CIB_CLIENTNAME         "cib_clientname"
 #define PCMK__XA_CIB_DELEGATED_FROM     "cib_delegated_from"
+#define PCMK__XA_CIB_DELTA_SYNC         "cib_delta_sync"
 #define PCMK__XA_CIB_HOST               "cib_host"
 #define PCMK__XA_CIB_ISREPLYTO          "cib_isreplyto"
 #define PCMK__XA_CIB_NOTIFY_ACTIVATE    "cib_notify_activate"
+#define PCMK__XA_CIB_NOTIFY_ELEMENT     "cib_notify_element"
+#define PCMK__XA_CIB_NOTIFY_FILTERED    "cib_notify_filtered"
+#define PCMK__XA_CIB_NOTIFY_NODE        "cib_notify_node"
 #define PCMK__XA_CIB_NOTIFY_TYPE        "cib_notify_type"
+#define PCMK__XA_CIB_NOTIFY_XPATH       "cib_notify_xpath"
 #define PCMK__XA_CIB_OP                 "cib_op"
 #define PCMK__XA_CIB_PING_ID            "cib_ping_id"
 #define PCMK__XA_CIB_RC                 "cib_rc"
@@ -137,6 +156,7 @@ extern "C" {
 #define PCMK__XA_CONFIRM                "confirm"
 #define PCMK__XA_CONNECTION_HOST        "connection_host"
 #define PCMK__XA_CONTENT                "content"
+#define PCMK__XA_CPU_US                 "cpu-us"
 #define PCMK__XA_CRMD_STATE             "crmd_state"
 #define PCMK__XA_CRM_HOST_TO            "crm_host_to"
 #define PCMK__XA_CRM_LIMIT_MAX          "crm-limit-max"
@@ -145,9 +165,12 @@ extern "C" {
 #define PCMK__XA_CRM_SYS_FROM           "crm_sys_from"
 #define PCMK__XA_CRM_SYS_TO             "crm_sys_to"
 #define PCMK__XA_CRM_TASK               "crm_task"
+#define PCMK__XA_CRM_TGRAPH_CANCELLED   "crm-tgraph-cancelled"
 #define PCMK__XA_CRM_TGRAPH_IN          "crm-tgraph-in"
+#define PCMK__XA_CRM_TGRAPH_REF         "crm-tgraph-ref"
 #define PCMK__XA_CRM_USER               "crm_user"
 #define PCMK__XA_DC_LEAVING             "dc-leaving"
+#define PCMK__XA_DIFF_US                "diff-us"
 #define PCMK__XA_DIGEST                 "digest"
 #define PCMK__XA_ELECTION_AGE_SEC       "election-age-sec"
 #define PCMK__XA_ELECTION_AGE_NANO_SEC  "election-age-nano-sec"
@@ -157,18 +180,25 @@ extern "C" {
 #define PCMK__XA_HIDDEN                 "hidden"
 #define PCMK__XA_HTTP_EQUIV             "http-equiv"
 #define PCMK__XA_IN_CCM                 "in_ccm"
+#define PCMK__XA_INVOKE_BATCHES         "invoke_batches"
 #define PCMK__XA_IPC_PROTO_VERSION      "ipc-protocol-version"
 #define PCMK__XA_JOIN                   "join"
 #define PCMK__XA_JOIN_ID                "join_id"
+#define PCMK__XA_LIMIT                  "limit"
 #define PCMK__XA_LINE                   "line"
+#define PCMK__XA_LOG_LEVEL              "log_level"
 #define PCMK__XA_LONG_ID                "long-id"
 #define PCMK__XA_LRMD_ALERT_ID          "lrmd_alert_id"
 #define PCMK__XA_LRMD_ALERT_PATH        "lrmd_alert_path"
+#define PCMK__XA_LRMD_BLOCKS_IN         "lrmd_blocks_in"
+#define PCMK__XA_LRMD_BLOCKS_OUT        "lrmd_blocks_out"
 #define PCMK__XA_LRMD_CALLID            "lrmd_callid"
 #define PCMK__XA_LRMD_CALLOPT           "lrmd_callopt"
 #define PCMK__XA_LRMD_CLASS             "lrmd_class"
 #define PCMK__XA_LRMD_CLIENTID          "lrmd_clientid"
 #define PCMK__XA_LRMD_CLIENTNAME        "lrmd_clientname"
+#define PCMK__XA_LRMD_CPU_SYSTEM_TIME   "lrmd_cpu_system_time"
+#define PCMK__XA_LRMD_CPU_USER_TIME     "lrmd_cpu_user_time"
 #define PCMK__XA_LRMD_EXEC_OP_STATUS    "lrmd_exec_op_status"
 #define PCMK__XA_LRMD_EXEC_RC           "lrmd_exec_rc"
 #define PCMK__XA_LRMD_EXEC_TIME         "lrmd_exec_time"
@@ -180,10 +210,13 @@ extern "C" {
 #define PCMK__XA_LRMD_IPC_SESSION       "lrmd_ipc_session"
 #define PCMK__XA_LRMD_IPC_USER          "lrmd_ipc_user"
 #define PCMK__XA_LRMD_IS_IPC_PROVIDER   "lrmd_is_ipc_provider"
+#define PCMK__XA_LRMD_MAX_RSS           "lrmd_max_rss"
+#define PCMK__XA_LRMD_NOTIFY_FLAGS      "lrmd_notify_flags"
 #define PCMK__XA_LRMD_OP                "lrmd_op"
 #define PCMK__XA_LRMD_ORIGIN            "lrmd_origin"
 #define PCMK__XA_LRMD_PROTOCOL_VERSION  "lrmd_protocol_version"
 #define PCMK__XA_LRMD_PROVIDER          "lrmd_provider"
+#define PCMK__XA_LRMD_PROXY_FRAMES      "lrmd_proxy_frames"
 #define PCMK__XA_LRMD_QUEUE_TIME        "lrmd_queue_time"
 #define PCMK__XA_LRMD_RC                "lrmd_rc"
 #define PCMK__XA_LRMD_RCCHANGE_TIME     "lrmd_rcchange_time"
@@ -209,8 +242,11 @@ extern "C" {
 #define PCMK__XA_NODE_IN_MAINTENANCE    "node_in_maintenance"
 #define PCMK__XA_NODE_START_STATE       "node_start_state"
 #define PCMK__XA_NODE_STATE             "node_state"
+#define PCMK__XA_NOTIFICATIONS          "notifications"
+#define PCMK__XA_NOTIFY_US              "notify-us"
 #define PCMK__XA_OP_DIGEST              "op-digest"
 #define PCMK__XA_OP_FORCE_RESTART       "op-force-restart"
+#define PCMK__XA_OP_PACKED              "op-packed"
 #define PCMK__XA_OP_RESTART_DIGEST      "op-restart-digest"
 #define PCMK__XA_OP_SECURE_DIGEST       "op-secure-digest"
 #define PCMK__XA_OP_SECURE_PARAMS       "op-secure-params"
@@ -222,6 +258,7 @@ extern "C" {
 #define PCMK__XA_PRIORITY               "priority"
 #define PCMK__XA_RC_CODE                "rc-code"
 #define PCMK__XA_REAP                   "reap"
+#define PCMK__XA_REQUESTS               "requests"
 
 /* Actions to be executed on Pacemaker Remote nodes are routed through the
  * controller on the cluster node hosting the remote connection. That cluster
@@ -272,7 +309,9 @@ extern "C" {
 #define PCMK__XA_T                      "t"                     // type
 #define PCMK__XA_TRANSITION_KEY         "transition-key"
 #define PCMK__XA_TRANSITION_MAGIC       "transition-magic"
+#define PCMK__XA_TTL                    "ttl"
 #define PCMK__XA_UPTIME                 "uptime"
+#define PCMK__XA_WINDOW                 "window"
 
 // @COMPAT Deprecated since 2.1.7
 #define PCMK__XA_ORDERING               "ordering"
@@ -39,11 +39,13 @@ typedef struct lrmd_key_value_s {
  *
  * Protocol  Pacemaker  Significant changes
  * --------  ---------  -------------------
+ *   1.3       3.0.1    LRMD_OP_NOTIFY_FILTER
  *   1.2       2.1.8    PCMK__CIB_REQUEST_SCHEMAS
  */
-#define LRMD_PROTOCOL_VERSION "1.2"
+#define LRMD_PROTOCOL_VERSION "1.3"
 
 #define LRMD_SUPPORTS_SCHEMA_XFER(x) (compare_version((x), "1.2") >= 0)
+#define LRMD_SUPPORTS_NOTIFY_FILTER(x) (compare_version((x), "1.3") >= 0)
 
 /* The major protocol version the client and server both need to support for
  * the connection to be successful.  This should only ever be the major
@@ -67,6 +69,7 @@ typedef struct lrmd_key_value_s {
 #define LRMD_OP_CHECK             "lrmd_check"
 #define LRMD_OP_ALERT_EXEC        "lrmd_alert_exec"
 #define LRMD_OP_GET_RECURRING     "lrmd_get_recurring"
+#define LRMD_OP_NOTIFY_FILTER     "lrmd_notify_filter"
 
 #define LRMD_IPC_OP_NEW           "new"
 #define LRMD_IPC_OP_DESTROY       "destroy"
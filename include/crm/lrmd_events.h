@@ -96,6 +96,21 @@ typedef struct lrmd_event_data_s {
 
     /*! exit failure reason string from resource agent operation */
     const char *exit_reason;
+
+    /*! CPU time (in milliseconds) agent spent in user mode, if known */
+    unsigned int cpu_user_time;
+
+    /*! CPU time (in milliseconds) agent spent in kernel mode, if known */
+    unsigned int cpu_system_time;
+
+    /*! Agent's peak resident set size (in KiB), if known */
+    unsigned int max_rss;
+
+    /*! Number of file system input operations by agent, if known */
+    unsigned int blocks_in;
+
+    /*! Number of file system output operations by agent, if known */
+    unsigned int blocks_out;
 } lrmd_event_data_t;
 
 lrmd_event_data_t *lrmd_new_event(const char *rsc_id, const char *task,
@@ -10,6 +10,7 @@
 #ifndef PCMK__CRM_LRMD_INTERNAL__H
 #define PCMK__CRM_LRMD_INTERNAL__H
 
+#include <stdbool.h>                    // bool
 #include <stdint.h>                     // uint32_t
 #include <glib.h>                       // GList, GHashTable, gpointer
 #include <libxml/tree.h>                // xmlNode
@@ -54,6 +55,32 @@ void lrmd__reset_result(lrmd_event_data_t *event);
 time_t lrmd__uptime(lrmd_t *lrmd);
 const char *lrmd__node_start_state(lrmd_t *lrmd);
 
+bool lrmd__proxy_frames(const lrmd_t *lrmd);
+int lrmd__proxy_send_frame(lrmd_t *lrmd, const pcmk__proxy_frame_t *frame);
+
+//! Classes of executor notifications a client can subscribe to
+enum lrmd__notify_flags {
+    //! Results of actions that completed with \c PCMK_OCF_OK
+    lrmd__notify_exec_ok        = (UINT32_C(1) << 0),
+
+    //! Results of actions that returned an error or did not complete
+    lrmd__notify_exec_failed    = (UINT32_C(1) << 1),
+
+    //! Resource registrations and unregistrations
+    lrmd__notify_rsc_changes    = (UINT32_C(1) << 2),
+
+    //! Connection pokes and new client connections
+    lrmd__notify_connection     = (UINT32_C(1) << 3),
+};
+
+//! All classes of executor notifications
+#define lrmd__notify_all                                        \
+    (lrmd__notify_exec_ok|lrmd__notify_exec_failed              \
+     |lrmd__notify_rsc_changes|lrmd__notify_connection)
+
+int lrmd__set_notify_filter(lrmd_t *lrmd, uint32_t flags, const GList *rsc_ids,
+                            const GList *actions);
+
 /* Shared functions for IPC proxy back end */
 
 typedef struct remote_proxy_s {
@@ -242,6 +242,8 @@ gboolean get_target_role(const pcmk_resource_t *rsc, enum rsc_role_e *role);
 void pe__set_next_role(pcmk_resource_t *rsc, enum rsc_role_e role,
                        const char *why);
 
+void pe__unpack_rsc_history(pcmk_resource_t *rsc);
+
 extern void destroy_ticket(gpointer data);
 pcmk__ticket_t *ticket_new(const char *ticket_id, pcmk_scheduler_t *scheduler);
 
@@ -11,6 +11,7 @@
 #define PCMK__CRM_SERVICES_INTERNAL__H
 
 #include <crm/services.h>       // svc_action_t
+#include <crm/common/internal.h> // pcmk__rusage_t
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +47,7 @@ svc_action_t *services__create_resource_action(const char *name,
                                                enum svc_action_flags flags);
 
 const char *services__exit_reason(const svc_action_t *action);
+const pcmk__rusage_t *services__rusage(const svc_action_t *action);
 char *services__grab_stdout(svc_action_t *action);
 char *services__grab_stderr(svc_action_t *action);
 
@@ -57,6 +59,9 @@ void services__format_result(svc_action_t *action, int agent_status,
                              enum pcmk_exec_status exec_status,
                              const char *format, ...) G_GNUC_PRINTF(4, 5);
 
+// Only available when built with systemd support
+void services__set_systemd_override_root(const char *dir);
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,6 +41,7 @@
 #include <crm/common/digest_internal.h>
 #include <crm/common/logging.h>
 #include <crm/common/logging_internal.h>
+#include <crm/common/metrics_internal.h>
 #include <crm/common/ipc_internal.h>
 #include <crm/common/options_internal.h>
 #include <crm/common/output_internal.h>
@@ -87,8 +88,20 @@ extern "C" {
 #define PCMK__ATTRD_CMD_CLEAR_FAILURE   "clear-failure"
 #define PCMK__ATTRD_CMD_CONFIRM         "confirm"
 
+#define PCMK__CONTROLD_CMD_INVOKE_BATCH "lrm_invoke_batch"
 #define PCMK__CONTROLD_CMD_NODES        "list-nodes"
 
+#define PCMK__SCHEDULERD_CMD_CANCEL     "pe_calc_cancel"
+
+/* Priorities of scheduler calculation requests. Requests without a priority
+ * (or with at least PCMK__SCHEDULER_PRIORITY_DC) are for the DC's transition
+ * graph and are calculated by a dedicated worker process, in the order
+ * received. Others share the remaining worker processes, highest priority
+ * first.
+ */
+#define PCMK__SCHEDULER_PRIORITY_DC         100
+#define PCMK__SCHEDULER_PRIORITY_DEFAULT    0
+
 #define ST__LEVEL_MIN 1
 #define ST__LEVEL_MAX 9
 
@@ -13,6 +13,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include <glib.h>
+
 #include <crm/crm.h>
 #include <crm/common/output_internal.h>
 #include <crm/common/ipc_controld.h>
@@ -71,6 +73,16 @@ int pcmk__pacemakerd_status(pcmk__output_t *out, const char *ipc_name,
                             unsigned int message_timeout_ms, bool show_output,
                             enum pcmk_pacemakerd_state *state);
 
+// Daemon log settings
+int pcmk__log_control(pcmk__output_t *out, const char *daemon,
+                      const char *log_level, const GList *trace,
+                      const GList *untrace, bool untrace_all, guint ttl_s,
+                      unsigned int message_timeout_ms);
+
+// Daemon performance metrics
+int pcmk__daemon_metrics(pcmk__output_t *out, const char *daemon,
+                         unsigned int message_timeout_ms);
+
 #ifdef __cplusplus
 }
 #endif
@@ -157,6 +157,23 @@ enum pcmk__graph_status {
     pcmk__graph_terminated,
 };
 
+/*!
+ * \internal
+ * \brief Send a batch of graph actions to a node
+ *
+ * \param[in]     node       Name of node whose controller will execute actions
+ * \param[in,out] ops        \c PCMK__XE_RSC_OPS with a copy of each action's
+ *                           XML
+ * \param[in,out] actions    Graph actions in batch (in order added)
+ * \param[in]     count      Number of actions in batch
+ * \param[in,out] user_data  Caller data
+ */
+typedef void (*pcmk__action_batch_fn_t)(const char *node, xmlNode *ops,
+                                        GList *actions, guint count,
+                                        void *user_data);
+
+typedef struct pcmk__action_batches_s pcmk__action_batches_t;
+
 void pcmk__set_graph_functions(pcmk__graph_functions_t *fns);
 pcmk__graph_t *pcmk__unpack_graph(const xmlNode *xml_graph,
                                   const char *reference);
@@ -164,6 +181,13 @@ enum pcmk__graph_status pcmk__execute_graph(pcmk__graph_t *graph);
 void pcmk__update_graph(pcmk__graph_t *graph,
                         const pcmk__graph_action_t *action);
 void pcmk__free_graph(pcmk__graph_t *graph);
+pcmk__action_batches_t *pcmk__action_batches_new(guint max_actions,
+                                                 pcmk__action_batch_fn_t fn,
+                                                 void *user_data);
+void pcmk__action_batches_free(pcmk__action_batches_t *batches);
+void pcmk__batch_graph_action(pcmk__action_batches_t *batches,
+                              const char *node, pcmk__graph_action_t *action);
+void pcmk__send_action_batches(pcmk__action_batches_t *batches);
 const char *pcmk__graph_status2text(enum pcmk__graph_status state);
 void pcmk__log_graph(unsigned int log_level, pcmk__graph_t *graph);
 void pcmk__log_graph_action(int log_level, pcmk__graph_action_t *action);
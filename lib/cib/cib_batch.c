@@ -0,0 +1,213 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdlib.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/cib/internal.h>
+#include <crm/common/xml.h>
+
+struct cib__status_batch_s {
+    GQueue *updates;        // cib__status_update_t, in the order added
+};
+
+static void
+free_status_update(gpointer data)
+{
+    cib__status_update_t *update = data;
+
+    free(update->name);
+    pcmk__xml_free(update->node_state);
+    free(update->delete_xpath);
+    free(update);
+}
+
+/*!
+ * \internal
+ * \brief Create a new batch of node status updates
+ *
+ * \return Newly allocated batch
+ * \note The caller is responsible for freeing the result using
+ *       \c cib__status_batch_free().
+ */
+cib__status_batch_t *
+cib__status_batch_new(void)
+{
+    cib__status_batch_t *batch = pcmk__assert_alloc(1,
+                                                    sizeof(cib__status_batch_t));
+
+    batch->updates = g_queue_new();
+    return batch;
+}
+
+/*!
+ * \internal
+ * \brief Discard all updates in a batch of node status updates
+ *
+ * \param[in,out] batch  Batch to clear
+ */
+void
+cib__status_batch_clear(cib__status_batch_t *batch)
+{
+    if (batch != NULL) {
+        cib__status_update_t *update = NULL;
+
+        while ((update = g_queue_pop_head(batch->updates)) != NULL) {
+            free_status_update(update);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Free a batch of node status updates
+ *
+ * \param[in,out] batch  Batch to free
+ */
+void
+cib__status_batch_free(cib__status_batch_t *batch)
+{
+    if (batch != NULL) {
+        cib__status_batch_clear(batch);
+        g_queue_free(batch->updates);
+        free(batch);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the number of updates in a batch of node status updates
+ *
+ * \param[in] batch  Batch to check
+ *
+ * \return Number of updates in \p batch
+ */
+guint
+cib__status_batch_length(const cib__status_batch_t *batch)
+{
+    return (batch == NULL)? 0 : g_queue_get_length(batch->updates);
+}
+
+/*!
+ * \internal
+ * \brief Get the updates in a batch of node status updates
+ *
+ * \param[in] batch  Batch to check
+ *
+ * \return List of updates (as \c cib__status_update_t) in the order added
+ * \note The list and its contents belong to \p batch.
+ */
+const GList *
+cib__status_batch_updates(const cib__status_batch_t *batch)
+{
+    return (batch == NULL)? NULL : batch->updates->head;
+}
+
+/*!
+ * \internal
+ * \brief Add a node status update to a batch
+ *
+ * \param[in,out] batch         Batch to add to
+ * \param[in]     name          Name of node being updated (or NULL if unknown)
+ * \param[in,out] node_state    Node state update (takes ownership)
+ * \param[in]     delete_xpath  XPath of status entries to delete after
+ *                              \p node_state is applied (or NULL for none)
+ * \param[in]     tag           Caller-defined value to keep with the update
+ */
+void
+cib__status_batch_add(cib__status_batch_t *batch, const char *name,
+                      xmlNode *node_state, const char *delete_xpath, int tag)
+{
+    cib__status_update_t *update = NULL;
+
+    pcmk__assert((batch != NULL) && (node_state != NULL));
+
+    update = pcmk__assert_alloc(1, sizeof(cib__status_update_t));
+    update->name = pcmk__str_copy(name);
+    update->node_state = node_state;
+    update->delete_xpath = pcmk__str_copy(delete_xpath);
+    update->tag = tag;
+    g_queue_push_tail(batch->updates, update);
+}
+
+/*!
+ * \internal
+ * \brief Send all updates in a batch of node status updates as one transaction
+ *
+ * Each node state update is applied to the status section (creating it if
+ * needed), followed by deletion of its XPath if any, in the order the updates
+ * were added. All requests are committed atomically by a single CIB request.
+ *
+ * \param[in,out] cib      CIB connection to use
+ * \param[in]     batch    Batch of updates to send
+ * \param[out]    call_id  Where to store the call ID (or negative legacy
+ *                         Pacemaker return code) of the transaction commit
+ *                         request, or 0 if \p batch is empty
+ * \param[out]    desc     If not NULL, where to store a comma-separated list
+ *                         of the names of updated nodes (for logging)
+ *
+ * \return Standard Pacemaker return code
+ * \note If this returns an error, the transaction could not be started and
+ *       nothing has been sent, so the caller may send the updates individually
+ *       instead. \p batch is left unchanged either way. If \p desc is not
+ *       NULL, the caller is responsible for freeing it.
+ */
+int
+cib__status_batch_send(cib_t *cib, const cib__status_batch_t *batch,
+                       int *call_id, char **desc)
+{
+    GString *names = NULL;
+    int rc = pcmk_ok;
+
+    pcmk__assert((cib != NULL) && (batch != NULL) && (call_id != NULL));
+
+    *call_id = 0;
+    if (desc != NULL) {
+        *desc = NULL;
+    }
+    if (g_queue_is_empty(batch->updates)) {
+        return pcmk_rc_ok;
+    }
+
+    rc = cib->cmds->init_transaction(cib);
+    if (rc != pcmk_ok) {
+        return pcmk_legacy2rc(rc);
+    }
+
+    names = g_string_sized_new(64);
+    for (const GList *iter = batch->updates->head; iter != NULL;
+         iter = iter->next) {
+
+        const cib__status_update_t *update = iter->data;
+
+        cib->cmds->modify(cib, PCMK_XE_STATUS, update->node_state,
+                          cib_can_create|cib_transaction);
+        if (update->delete_xpath != NULL) {
+            cib->cmds->remove(cib, update->delete_xpath, NULL,
+                              cib_xpath|cib_multiple|cib_transaction);
+        }
+        pcmk__add_separated_word(&names, 64,
+                                 pcmk__s(update->name,
+                                         pcmk__xe_id(update->node_state)),
+                                 ", ");
+    }
+
+    *call_id = cib->cmds->end_transaction(cib, true, cib_none);
+
+    if (desc != NULL) {
+        *desc = pcmk__str_copy(names->str);
+    }
+    g_string_free(names, TRUE);
+    return pcmk_rc_ok;
+}
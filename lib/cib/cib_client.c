@@ -51,29 +51,33 @@ ciblib_GCompareFunc(gconstpointer a, gconstpointer b)
 }
 
 static int
-cib_client_add_notify_callback(cib_t * cib, const char *event,
-                               void (*callback) (const char *event,
-                                                 xmlNode * msg))
+add_notify_callback(cib_t *cib, const char *event,
+                    void (*callback) (const char *event, xmlNode *msg),
+                    cib__notify_filter_t *filter)
 {
     GList *list_item = NULL;
     cib_notify_client_t *new_client = NULL;
 
     if ((cib->variant != cib_native) && (cib->variant != cib_remote)) {
+        cib__notify_filter_free(filter);
         return -EPROTONOSUPPORT;
     }
 
-    crm_trace("Adding callback for %s events (%d)",
-              event, g_list_length(cib->notify_list));
+    crm_trace("Adding %scallback for %s events (%d)",
+              ((filter != NULL)? "filtered " : ""), event,
+              g_list_length(cib->notify_list));
 
     new_client = pcmk__assert_alloc(1, sizeof(cib_notify_client_t));
     new_client->event = event;
     new_client->callback = callback;
+    new_client->filter = filter;
 
     list_item = g_list_find_custom(cib->notify_list, new_client,
                                    ciblib_GCompareFunc);
 
     if (list_item != NULL) {
         crm_warn("Callback already present");
+        cib__notify_filter_free(filter);
         free(new_client);
         return -EINVAL;
 
@@ -87,6 +91,51 @@ cib_client_add_notify_callback(cib_t * cib, const char *event,
     return pcmk_ok;
 }
 
+static int
+cib_client_add_notify_callback(cib_t * cib, const char *event,
+                               void (*callback) (const char *event,
+                                                 xmlNode * msg))
+{
+    return add_notify_callback(cib, event, callback, NULL);
+}
+
+/*!
+ * \internal
+ * \brief Register a callback for only some CIB diff notifications
+ *
+ * The CIB manager will send this connection only the changes matching the
+ * filters of its diff callbacks (or all changes, if any diff callback is
+ * unfiltered). Any patchset a callback receives will contain at least one
+ * matching change, but when the CIB manager filters a patchset, it has no
+ * digest and so cannot be applied to a local copy of the CIB.
+ *
+ * \param[in,out] cib       CIB connection
+ * \param[in]     callback  Function to call for matching diff notifications
+ * \param[in]     filter    Which changes \p callback is interested in
+ *
+ * \return Legacy Pacemaker return code
+ */
+int
+cib__add_filtered_notify_callback(cib_t *cib,
+                                  void (*callback)(const char *event,
+                                                   xmlNode *msg),
+                                  const cib__notify_filter_t *filter)
+{
+    cib__notify_filter_t *copy = NULL;
+
+    if (filter != NULL) {
+        int rc = cib__notify_filter_new(filter->section, filter->node_id,
+                                        filter->element, filter->xpath_prefix,
+                                        &copy);
+
+        if (rc != pcmk_rc_ok) {
+            return pcmk_rc2legacy(rc);
+        }
+    }
+    return add_notify_callback(cib, PCMK__VALUE_CIB_DIFF_NOTIFY, callback,
+                               copy);
+}
+
 static int
 get_notify_list_event_count(cib_t *cib, const char *event)
 {
@@ -133,6 +182,7 @@ cib_client_del_notify_callback(cib_t *cib, const char *event,
         cib_notify_client_t *list_client = list_item->data;
 
         cib->notify_list = g_list_remove(cib->notify_list, list_client);
+        cib__notify_filter_free(list_client->filter);
         free(list_client);
 
         crm_trace("Removed callback");
@@ -144,6 +194,12 @@ cib_client_del_notify_callback(cib_t *cib, const char *event,
     if (get_notify_list_event_count(cib, event) == 0) {
         /* When there is not the registration of the event, the processing turns off a notice. */
         cib->cmds->register_notification(cib, event, 0);
+
+    } else if ((list_item != NULL)
+               && pcmk__str_eq(event, PCMK__VALUE_CIB_DIFF_NOTIFY,
+                               pcmk__str_none)) {
+        // Update the CIB manager's filters for the remaining callbacks
+        cib->cmds->register_notification(cib, event, 1);
     }
 
     free(new_client);
@@ -693,6 +749,7 @@ cib_free_notify(cib_t *cib)
             cib_notify_client_t *client = g_list_nth_data(list, 0);
 
             list = g_list_remove(list, client);
+            cib__notify_filter_free(client->filter);
             free(client);
         }
         cib->notify_list = NULL;
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/cib/internal.h>
+#include <crm/common/xml.h>
+
+// A committed patchset and the CIB versions it connects
+typedef struct {
+    int source[3];          // admin_epoch, epoch, num_updates before patchset
+    int target[3];          // admin_epoch, epoch, num_updates after patchset
+    xmlNode *patchset;      // Copy of patchset
+} history_entry_t;
+
+struct cib__patchset_ring_s {
+    guint max_entries;      // Maximum number of patchsets to keep
+    GQueue *entries;        // history_entry_t, oldest first
+    GHashTable *by_source;  // Source version string -> link in entries
+};
+
+static char *
+version_key(const int version[3])
+{
+    return crm_strdup_printf("%d.%d.%d", version[0], version[1], version[2]);
+}
+
+static bool
+versions_equal(const int v1[3], const int v2[3])
+{
+    return (v1[0] == v2[0]) && (v1[1] == v2[1]) && (v1[2] == v2[2]);
+}
+
+static void
+free_history_entry(gpointer data)
+{
+    history_entry_t *entry = data;
+
+    pcmk__xml_free(entry->patchset);
+    free(entry);
+}
+
+/*!
+ * \internal
+ * \brief Create a new ring of recently committed CIB patchsets
+ *
+ * \param[in] max_entries  Maximum number of patchsets to keep (the oldest will
+ *                         be discarded when a new one is added to a full ring)
+ *
+ * \return Newly allocated ring
+ * \note The caller is responsible for freeing the result using
+ *       \c cib__patchset_ring_free().
+ */
+cib__patchset_ring_t *
+cib__patchset_ring_new(guint max_entries)
+{
+    cib__patchset_ring_t *ring = pcmk__assert_alloc(1,
+                                                    sizeof(cib__patchset_ring_t));
+
+    ring->max_entries = QB_MAX(max_entries, 1);
+    ring->entries = g_queue_new();
+    ring->by_source = pcmk__strkey_table(free, NULL);
+    return ring;
+}
+
+/*!
+ * \internal
+ * \brief Discard all patchsets in a CIB patchset ring
+ *
+ * \param[in,out] ring  Ring to clear
+ */
+void
+cib__patchset_ring_clear(cib__patchset_ring_t *ring)
+{
+    if (ring != NULL) {
+        history_entry_t *entry = NULL;
+
+        g_hash_table_remove_all(ring->by_source);
+        while ((entry = g_queue_pop_head(ring->entries)) != NULL) {
+            free_history_entry(entry);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Free a CIB patchset ring
+ *
+ * \param[in,out] ring  Ring to free
+ */
+void
+cib__patchset_ring_free(cib__patchset_ring_t *ring)
+{
+    if (ring != NULL) {
+        cib__patchset_ring_clear(ring);
+        g_queue_free(ring->entries);
+        g_hash_table_destroy(ring->by_source);
+        free(ring);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the number of patchsets in a CIB patchset ring
+ *
+ * \param[in] ring  Ring to check
+ *
+ * \return Number of patchsets in \p ring
+ */
+guint
+cib__patchset_ring_length(const cib__patchset_ring_t *ring)
+{
+    return (ring == NULL)? 0 : g_queue_get_length(ring->entries);
+}
+
+/*!
+ * \internal
+ * \brief Record a committed patchset in a CIB patchset ring
+ *
+ * The ring always holds a contiguous chain of patchsets. If \p patchset does
+ * not start from the version the newest patchset in the ring ended at, the
+ * ring is cleared first. If \p patchset is unusable (for example, it does not
+ * advance the CIB version), the ring is cleared and \p patchset is not added,
+ * because no chain through it could reproduce the CIB.
+ *
+ * \param[in,out] ring      Ring to add patchset to
+ * \param[in]     patchset  Patchset that was just committed
+ */
+void
+cib__patchset_ring_add(cib__patchset_ring_t *ring, const xmlNode *patchset)
+{
+    history_entry_t *entry = NULL;
+    const history_entry_t *newest = NULL;
+    int format = 1;
+
+    CRM_CHECK(ring != NULL, return);
+
+    if (patchset != NULL) {
+        crm_element_value_int(patchset, PCMK_XA_FORMAT, &format);
+    }
+
+    entry = pcmk__assert_alloc(1, sizeof(history_entry_t));
+    if ((format != 2) || !xml_patch_versions(patchset, entry->target,
+                                             entry->source)
+        || versions_equal(entry->source, entry->target)) {
+
+        crm_trace("Clearing CIB patchset history: unusable patchset");
+        free(entry);
+        cib__patchset_ring_clear(ring);
+        return;
+    }
+
+    newest = g_queue_peek_tail(ring->entries);
+    if ((newest != NULL) && !versions_equal(newest->target, entry->source)) {
+        crm_trace("Clearing CIB patchset history: patchset starts at "
+                  "%d.%d.%d but history ends at %d.%d.%d",
+                  entry->source[0], entry->source[1], entry->source[2],
+                  newest->target[0], newest->target[1], newest->target[2]);
+        cib__patchset_ring_clear(ring);
+    }
+
+    while (g_queue_get_length(ring->entries) >= ring->max_entries) {
+        history_entry_t *oldest = g_queue_pop_head(ring->entries);
+        char *key = version_key(oldest->source);
+
+        g_hash_table_remove(ring->by_source, key);
+        free(key);
+        free_history_entry(oldest);
+    }
+
+    entry->patchset = pcmk__xml_copy(NULL, (xmlNode *) patchset);
+    g_queue_push_tail(ring->entries, entry);
+    g_hash_table_insert(ring->by_source, version_key(entry->source),
+                        g_queue_peek_tail_link(ring->entries));
+}
+
+/*!
+ * \internal
+ * \brief Add the chain of patchsets between two CIB versions to XML
+ *
+ * \param[in]     ring    Ring to get patchsets from
+ * \param[in]     from    Version (admin_epoch, epoch, num_updates) to start at
+ * \param[in]     to      Version to end at (normally the current version)
+ * \param[in,out] parent  XML to add a \c PCMK__XE_CIB_PATCHSETS child to
+ *
+ * \return Standard Pacemaker return code (specifically,
+ *         \c pcmk_rc_diff_resync if \p ring has no chain from \p from to
+ *         \p to, in which case nothing is added to \p parent)
+ */
+int
+cib__patchset_ring_chain(const cib__patchset_ring_t *ring, const int from[3],
+                         const int to[3], xmlNode *parent)
+{
+    char *key = NULL;
+    GList *start = NULL;
+    const history_entry_t *newest = NULL;
+    xmlNode *chain = NULL;
+
+    CRM_CHECK((from != NULL) && (to != NULL) && (parent != NULL),
+              return EINVAL);
+
+    if (ring == NULL) {
+        return pcmk_rc_diff_resync;
+    }
+
+    newest = g_queue_peek_tail(ring->entries);
+    if ((newest == NULL) || !versions_equal(newest->target, to)) {
+        crm_trace("No CIB patchset history ending at %d.%d.%d",
+                  to[0], to[1], to[2]);
+        return pcmk_rc_diff_resync;
+    }
+
+    key = version_key(from);
+    start = g_hash_table_lookup(ring->by_source, key);
+    free(key);
+
+    if (start == NULL) {
+        crm_trace("No CIB patchset history starting at %d.%d.%d",
+                  from[0], from[1], from[2]);
+        return pcmk_rc_diff_resync;
+    }
+
+    // The ring is always contiguous, so everything after start is the chain
+    chain = pcmk__xe_create(parent, PCMK__XE_CIB_PATCHSETS);
+    for (GList *iter = start; iter != NULL; iter = iter->next) {
+        const history_entry_t *entry = iter->data;
+
+        pcmk__xml_copy(chain, entry->patchset);
+    }
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Apply a chain of patchsets to a CIB and verify the result
+ *
+ * \param[in,out] cib     CIB to apply patchsets to
+ * \param[in]     chain   \c PCMK__XE_CIB_PATCHSETS element with patchsets to
+ *                        apply, oldest first
+ * \param[in]     digest  Expected digest of \p cib after applying \p chain
+ *
+ * \return Standard Pacemaker return code
+ * \note On error, \p cib may be partially patched, so the caller should apply
+ *       the chain to a copy and discard the copy on error.
+ */
+int
+cib__apply_patchset_chain(xmlNode *cib, const xmlNode *chain,
+                          const char *digest)
+{
+    int n_patchsets = 0;
+    char *calculated = NULL;
+
+    CRM_CHECK((cib != NULL) && pcmk__xe_is(chain, PCMK__XE_CIB_PATCHSETS),
+              return EINVAL);
+
+    if (digest == NULL) {
+        crm_info("Cannot apply CIB patchset chain without a digest to verify");
+        return pcmk_rc_diff_resync;
+    }
+
+    for (xmlNode *patchset = pcmk__xe_first_child(chain, NULL, NULL, NULL);
+         patchset != NULL; patchset = pcmk__xe_next(patchset, NULL)) {
+
+        int rc = xml_apply_patchset(cib, patchset, true);
+
+        if (rc != pcmk_ok) {
+            crm_info("Could not apply patchset %d of CIB patchset chain: %s",
+                     n_patchsets + 1, pcmk_strerror(rc));
+            return pcmk_rc_diff_resync;
+        }
+        n_patchsets++;
+    }
+
+    if (n_patchsets == 0) {
+        crm_info("Cannot apply empty CIB patchset chain");
+        return pcmk_rc_diff_resync;
+    }
+
+    calculated = pcmk__digest_xml(cib, true);
+    if (!pcmk__str_eq(calculated, digest, pcmk__str_casei)) {
+        crm_info("Digest mismatch after applying %d patchset%s: "
+                 "expected %s, calculated %s",
+                 n_patchsets, pcmk__plural_s(n_patchsets), digest, calculated);
+        free(calculated);
+        return pcmk_rc_diff_failed;
+    }
+    free(calculated);
+
+    crm_debug("Applied chain of %d CIB patchset%s (digest %s)",
+              n_patchsets, pcmk__plural_s(n_patchsets), digest);
+    return pcmk_rc_ok;
+}
@@ -0,0 +1,610 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/cib/internal.h>
+#include <crm/common/cib_internal.h>
+#include <crm/common/xml.h>
+
+// Absolute paths of the elements that a node ID can be extracted from
+#define NODE_STATE_PATH "/" PCMK_XE_CIB "/" PCMK_XE_STATUS "/" PCMK__XE_NODE_STATE
+#define NODE_CONFIG_PATH "/" PCMK_XE_CIB "/" PCMK_XE_CONFIGURATION \
+                         "/" PCMK_XE_NODES "/" PCMK_XE_NODE
+
+// What a single change in a patchset affects (parsed once per change)
+typedef struct {
+    const xmlNode *xml;     // Change element in patchset
+    const char *op;         // Change operation (create, modify, etc.)
+    char *path;             // Path of changed (or created) element
+    char *node_id;          // ID of node the change is for (if known)
+    char *element;          // Name of changed (or created) element
+    GHashTable *created;    // Names of all elements in a created subtree
+} change_info_t;
+
+struct cib__diff_changes_s {
+    const xmlNode *diff;    // Patchset that changes were parsed from
+    GPtrArray *changes;     // change_info_t for each change in diff
+};
+
+/*!
+ * \internal
+ * \brief Check whether a path names a simple, absolute CIB location
+ *
+ * A usable path starts with "/cib" and has only element names, each optionally
+ * followed by a single ID predicate of the form [@id='value'].
+ *
+ * \param[in] path  Path to check
+ *
+ * \return true if \p path is usable as a notification filter, otherwise false
+ */
+static bool
+valid_filter_path(const char *path)
+{
+    const char *p = NULL;
+
+    if (!pcmk__starts_with(path, "/" PCMK_XE_CIB)) {
+        return false;
+    }
+
+    for (p = path; *p != '\0'; ) {
+        size_t name_len = 0;
+
+        if (*p++ != '/') {
+            return false;
+        }
+        name_len = strspn(p, "abcdefghijklmnopqrstuvwxyz"
+                             "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-");
+        if (name_len == 0) {
+            return false;
+        }
+        p += name_len;
+
+        if (pcmk__starts_with(p, "[@" PCMK_XA_ID "='")) {
+            const char *end = NULL;
+
+            p += strlen("[@" PCMK_XA_ID "='");
+            end = strchr(p, '\'');
+            if ((end == NULL) || (end[1] != ']')) {
+                return false;
+            }
+            p = end + 2;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Create a new CIB diff notification filter
+ *
+ * A filter matches a change only if all of its specified criteria match.
+ *
+ * \param[in]  section       If not \c NULL, match only changes to this CIB
+ *                           section (any element name supported by
+ *                           \c pcmk__cib_abs_xpath_for())
+ * \param[in]  node_id       If not \c NULL, match only changes to this node's
+ *                           configuration or state
+ * \param[in]  element       If not \c NULL, match only changes to elements of
+ *                           this type
+ * \param[in]  xpath_prefix  If not \c NULL, match only changes at, beneath, or
+ *                           containing this absolute path (which may contain
+ *                           only element names and ID predicates)
+ * \param[out] filter        Where to store newly allocated filter
+ *
+ * \return Standard Pacemaker return code
+ * \note The caller is responsible for freeing \p *filter using
+ *       \c cib__notify_filter_free().
+ */
+int
+cib__notify_filter_new(const char *section, const char *node_id,
+                       const char *element, const char *xpath_prefix,
+                       cib__notify_filter_t **filter)
+{
+    CRM_CHECK(filter != NULL, return EINVAL);
+
+    if ((section != NULL) && (pcmk__cib_abs_xpath_for(section) == NULL)) {
+        return pcmk_rc_bad_input;
+    }
+    if ((xpath_prefix != NULL) && !valid_filter_path(xpath_prefix)) {
+        return pcmk_rc_bad_input;
+    }
+
+    *filter = pcmk__assert_alloc(1, sizeof(cib__notify_filter_t));
+    (*filter)->section = pcmk__str_copy(section);
+    (*filter)->node_id = pcmk__str_copy(node_id);
+    (*filter)->element = pcmk__str_copy(element);
+    (*filter)->xpath_prefix = pcmk__str_copy(xpath_prefix);
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Free a CIB diff notification filter
+ *
+ * \param[in,out] filter  Filter to free
+ */
+void
+cib__notify_filter_free(void *filter)
+{
+    cib__notify_filter_t *f = filter;
+
+    if (f != NULL) {
+        free(f->section);
+        free(f->node_id);
+        free(f->element);
+        free(f->xpath_prefix);
+        free(f);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Add XML for a CIB diff notification filter to a request
+ *
+ * \param[in]     filter  Filter to add
+ * \param[in,out] parent  Notification registration request to add filter to
+ */
+void
+cib__notify_filter_add_xml(const cib__notify_filter_t *filter, xmlNode *parent)
+{
+    xmlNode *xml = pcmk__xe_create(parent, PCMK__XE_CIB_NOTIFY_FILTER);
+
+    crm_xml_add(xml, PCMK__XA_CIB_SECTION, filter->section);
+    crm_xml_add(xml, PCMK__XA_CIB_NOTIFY_NODE, filter->node_id);
+    crm_xml_add(xml, PCMK__XA_CIB_NOTIFY_ELEMENT, filter->element);
+    crm_xml_add(xml, PCMK__XA_CIB_NOTIFY_XPATH, filter->xpath_prefix);
+}
+
+/*!
+ * \internal
+ * \brief Parse all CIB diff notification filters in a registration request
+ *
+ * \param[in]  request  Notification registration request
+ * \param[out] filters  Where to store list of newly allocated filters (which
+ *                      will be \c NULL if the request has no filters)
+ *
+ * \return Standard Pacemaker return code
+ * \note On success, the caller is responsible for freeing \p *filters using
+ *       <tt>g_list_free_full(filters, cib__notify_filter_free)</tt>.
+ */
+int
+cib__notify_filters_from_xml(const xmlNode *request, GList **filters)
+{
+    CRM_CHECK(filters != NULL, return EINVAL);
+    *filters = NULL;
+
+    for (const xmlNode *xml = pcmk__xe_first_child(request,
+                                                   PCMK__XE_CIB_NOTIFY_FILTER,
+                                                   NULL, NULL);
+         xml != NULL; xml = pcmk__xe_next(xml, PCMK__XE_CIB_NOTIFY_FILTER)) {
+
+        cib__notify_filter_t *filter = NULL;
+        const char *section = crm_element_value(xml, PCMK__XA_CIB_SECTION);
+        const char *node_id = crm_element_value(xml, PCMK__XA_CIB_NOTIFY_NODE);
+        const char *element = crm_element_value(xml,
+                                                PCMK__XA_CIB_NOTIFY_ELEMENT);
+        const char *xpath = crm_element_value(xml, PCMK__XA_CIB_NOTIFY_XPATH);
+        int rc = cib__notify_filter_new(section, node_id, element, xpath,
+                                        &filter);
+
+        if (rc != pcmk_rc_ok) {
+            g_list_free_full(*filters, cib__notify_filter_free);
+            *filters = NULL;
+            return rc;
+        }
+        *filters = g_list_prepend(*filters, filter);
+    }
+    *filters = g_list_reverse(*filters);
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Add all of a CIB connection's filters for an event to a request
+ *
+ * The server keeps only the filters from the most recent registration, so
+ * every registration must carry the complete set. If any callback for the
+ * event is unfiltered, no filters are added, so the connection receives every
+ * change.
+ *
+ * \param[in]     cib      CIB connection
+ * \param[in]     event    Notification type being registered
+ * \param[in,out] request  Notification registration request to add filters to
+ */
+void
+cib__add_notify_filters(const cib_t *cib, const char *event, xmlNode *request)
+{
+    for (const GList *iter = cib->notify_list; iter != NULL;
+         iter = iter->next) {
+        const cib_notify_client_t *client = iter->data;
+
+        if (pcmk__str_eq(client->event, event, pcmk__str_none)
+            && (client->filter == NULL)) {
+            return;
+        }
+    }
+
+    for (const GList *iter = cib->notify_list; iter != NULL;
+         iter = iter->next) {
+        const cib_notify_client_t *client = iter->data;
+
+        if (pcmk__str_eq(client->event, event, pcmk__str_none)) {
+            cib__notify_filter_add_xml(client->filter, request);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether one CIB path contains or is contained by another
+ *
+ * \param[in] path1  First path to compare
+ * \param[in] path2  Second path to compare
+ *
+ * \return true if \p path1 and \p path2 are the same, or one is an ancestor of
+ *         the other, otherwise false
+ * \note An unqualified element name is considered an ancestor of the same
+ *       element name with an ID predicate.
+ */
+static bool
+paths_related(const char *path1, const char *path2)
+{
+    size_t len1 = strlen(path1);
+    size_t len2 = strlen(path2);
+    const char *longer = (len1 > len2)? path1 : path2;
+    size_t shorter_len = QB_MIN(len1, len2);
+
+    if (strncmp(path1, path2, shorter_len) != 0) {
+        return false;
+    }
+    return (longer[shorter_len] == '\0') || (longer[shorter_len] == '/')
+           || (longer[shorter_len] == '[');
+}
+
+/*!
+ * \internal
+ * \brief Check whether one CIB path is an ancestor of another
+ *
+ * \param[in] ancestor  Possible ancestor path
+ * \param[in] path      Path to check
+ *
+ * \return true if \p ancestor is a proper ancestor of \p path, otherwise false
+ */
+static bool
+path_is_ancestor(const char *ancestor, const char *path)
+{
+    size_t len = strlen(ancestor);
+
+    return (strlen(path) > len) && (strncmp(ancestor, path, len) == 0)
+           && (path[len] == '/');
+}
+
+/*!
+ * \internal
+ * \brief Get the node ID from a CIB path, if it is beneath a node element
+ *
+ * \param[in] path  Path to check
+ *
+ * \return Newly allocated node ID from \p path, or \c NULL if none
+ */
+static char *
+node_id_from_path(const char *path)
+{
+    static const char *prefixes[] = {
+        NODE_STATE_PATH "[@" PCMK_XA_ID "='",
+        NODE_CONFIG_PATH "[@" PCMK_XA_ID "='",
+    };
+
+    for (int i = 0; i < PCMK__NELEM(prefixes); i++) {
+        if (pcmk__starts_with(path, prefixes[i])) {
+            const char *id = path + strlen(prefixes[i]);
+            const char *end = strchr(id, '\'');
+
+            if (end != NULL) {
+                return strndup(id, end - id);
+            }
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Get the name of the last element in a CIB path
+ *
+ * \param[in] path  Path to check
+ *
+ * \return Newly allocated name of last element in \p path
+ */
+static char *
+element_from_path(const char *path)
+{
+    const char *name = NULL;
+    size_t len = 0;
+    int depth = 0;
+
+    // Find the last '/' that isn't inside a predicate
+    for (const char *p = path; *p != '\0'; p++) {
+        if (*p == '[') {
+            depth++;
+        } else if (*p == ']') {
+            depth--;
+        } else if ((*p == '/') && (depth == 0)) {
+            name = p + 1;
+        }
+    }
+    if (name == NULL) {
+        name = path;
+    }
+    len = strcspn(name, "[");
+    return strndup(name, len);
+}
+
+static void
+add_element_names(const xmlNode *xml, GHashTable *names)
+{
+    g_hash_table_add(names, (gpointer) xml->name);
+    for (const xmlNode *child = pcmk__xe_first_child(xml, NULL, NULL, NULL);
+         child != NULL; child = pcmk__xe_next(child, NULL)) {
+        add_element_names(child, names);
+    }
+}
+
+static void
+free_change_info(gpointer data)
+{
+    change_info_t *info = data;
+
+    free(info->path);
+    free(info->node_id);
+    free(info->element);
+    if (info->created != NULL) {
+        g_hash_table_destroy(info->created);
+    }
+    free(info);
+}
+
+/*!
+ * \internal
+ * \brief Parse the changes in a CIB patchset for notification filtering
+ *
+ * \param[in] diff  Patchset (must persist as long as the result)
+ *
+ * \return Newly allocated parsed changes, or \c NULL if \p diff is not a
+ *         patchset that can be filtered (in which case all subscribers should
+ *         receive it unfiltered)
+ * \note The caller is responsible for freeing the result using
+ *       \c cib__diff_changes_free().
+ */
+cib__diff_changes_t *
+cib__diff_changes_new(const xmlNode *diff)
+{
+    cib__diff_changes_t *changes = NULL;
+    int format = 1;
+
+    if (diff == NULL) {
+        return NULL;
+    }
+    crm_element_value_int(diff, PCMK_XA_FORMAT, &format);
+    if (format != 2) {
+        return NULL;
+    }
+
+    changes = pcmk__assert_alloc(1, sizeof(cib__diff_changes_t));
+    changes->diff = diff;
+    changes->changes = g_ptr_array_new_with_free_func(free_change_info);
+
+    for (const xmlNode *change = pcmk__xe_first_child(diff, PCMK_XE_CHANGE,
+                                                      NULL, NULL);
+         change != NULL; change = pcmk__xe_next(change, PCMK_XE_CHANGE)) {
+
+        change_info_t *info = pcmk__assert_alloc(1, sizeof(change_info_t));
+        const char *path = crm_element_value(change, PCMK_XA_PATH);
+
+        info->xml = change;
+        info->op = crm_element_value(change, PCMK_XA_OPERATION);
+
+        if (pcmk__str_eq(info->op, PCMK_VALUE_CREATE, pcmk__str_none)) {
+            // Use the path of the new element rather than its parent
+            const xmlNode *created = pcmk__xe_first_child(change, NULL, NULL,
+                                                          NULL);
+
+            if (created != NULL) {
+                const char *id = pcmk__xe_id(created);
+
+                if (id != NULL) {
+                    info->path = crm_strdup_printf("%s/%s[@" PCMK_XA_ID "='%s']",
+                                                   pcmk__s(path, ""),
+                                                   (const char *) created->name,
+                                                   id);
+                } else {
+                    info->path = crm_strdup_printf("%s/%s", pcmk__s(path, ""),
+                                                   (const char *) created->name);
+                }
+                info->created = g_hash_table_new(g_str_hash, g_str_equal);
+                add_element_names(created, info->created);
+            }
+        }
+        if (info->path == NULL) {
+            info->path = pcmk__str_copy(pcmk__s(path, ""));
+        }
+        info->node_id = node_id_from_path(info->path);
+        info->element = element_from_path(info->path);
+        g_ptr_array_add(changes->changes, info);
+    }
+    return changes;
+}
+
+/*!
+ * \internal
+ * \brief Free parsed CIB patchset changes
+ *
+ * \param[in,out] changes  Parsed changes to free
+ */
+void
+cib__diff_changes_free(cib__diff_changes_t *changes)
+{
+    if (changes != NULL) {
+        g_ptr_array_free(changes->changes, TRUE);
+        free(changes);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the number of changes in a parsed CIB patchset
+ *
+ * \param[in] changes  Parsed changes
+ *
+ * \return Number of changes in \p changes
+ */
+guint
+cib__diff_changes_count(const cib__diff_changes_t *changes)
+{
+    return (changes == NULL)? 0 : changes->changes->len;
+}
+
+static bool
+filter_matches(const cib__notify_filter_t *filter, const change_info_t *info)
+{
+    if (filter->section != NULL) {
+        const char *section_path = pcmk__cib_abs_xpath_for(filter->section);
+
+        if ((section_path == NULL)
+            || !paths_related(info->path, section_path)) {
+            return false;
+        }
+    }
+
+    if (filter->node_id != NULL) {
+        if (info->node_id != NULL) {
+            if (!pcmk__str_eq(info->node_id, filter->node_id,
+                              pcmk__str_none)) {
+                return false;
+            }
+
+        } else if (!path_is_ancestor(info->path, NODE_STATE_PATH)
+                   && !path_is_ancestor(info->path, NODE_CONFIG_PATH)) {
+            // Not for any node, and doesn't contain any node elements
+            return false;
+        }
+    }
+
+    if (filter->element != NULL) {
+        if (info->created != NULL) {
+            if (!g_hash_table_contains(info->created, filter->element)) {
+                return false;
+            }
+
+        } else if (!pcmk__str_eq(info->op, PCMK_VALUE_DELETE, pcmk__str_none)
+                   && !pcmk__str_eq(info->element, filter->element,
+                                    pcmk__str_none)) {
+            /* A deletion might remove elements of the desired type beneath the
+             * deleted element, so those always match.
+             */
+            return false;
+        }
+    }
+
+    if ((filter->xpath_prefix != NULL)
+        && !paths_related(info->path, filter->xpath_prefix)) {
+        return false;
+    }
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Determine which changes in a parsed patchset match a set of filters
+ *
+ * \param[in]  changes    Parsed changes
+ * \param[in]  filters    List of filters (a change matches if any matches)
+ * \param[out] n_matched  If not \c NULL, where to store number of matches
+ *
+ * \return Newly allocated string with one character per change in \p changes,
+ *         either '1' (matched) or '0' (not matched)
+ * \note The result is suitable as a hash table key, so that the same filtered
+ *       notification can be shared by subscribers with equivalent filters.
+ *       The caller is responsible for freeing it.
+ */
+char *
+cib__diff_changes_match(const cib__diff_changes_t *changes,
+                        const GList *filters, guint *n_matched)
+{
+    guint len = cib__diff_changes_count(changes);
+    char *match = pcmk__assert_alloc(len + 1, sizeof(char));
+    guint count = 0;
+
+    for (guint i = 0; i < len; i++) {
+        const change_info_t *info = g_ptr_array_index(changes->changes, i);
+
+        match[i] = '0';
+        for (const GList *iter = filters; iter != NULL; iter = iter->next) {
+            if (filter_matches((const cib__notify_filter_t *) iter->data,
+                               info)) {
+                match[i] = '1';
+                count++;
+                break;
+            }
+        }
+    }
+
+    if (n_matched != NULL) {
+        *n_matched = count;
+    }
+    return match;
+}
+
+/*!
+ * \internal
+ * \brief Create a copy of a patchset with only selected changes
+ *
+ * \param[in]     changes  Parsed changes
+ * \param[in]     match    Which changes to keep (as returned by
+ *                         \c cib__diff_changes_match())
+ * \param[in,out] parent   If not \c NULL, add the copy as a child of this
+ *
+ * \return Newly created patchset XML with everything in the original except
+ *         unselected changes and the digest (which no longer applies)
+ * \note If \p parent is \c NULL, the caller is responsible for freeing the
+ *       result using \c pcmk__xml_free().
+ */
+xmlNode *
+cib__diff_changes_subset(const cib__diff_changes_t *changes, const char *match,
+                         xmlNode *parent)
+{
+    xmlNode *subset = pcmk__xe_create(parent,
+                                      (const char *) changes->diff->name);
+    guint i = 0;
+
+    pcmk__xe_copy_attrs(subset, changes->diff, pcmk__xaf_none);
+    pcmk__xe_remove_attr(subset, PCMK__XA_DIGEST);
+
+    for (const xmlNode *child = pcmk__xe_first_child(changes->diff, NULL, NULL,
+                                                     NULL);
+         child != NULL; child = pcmk__xe_next(child, NULL)) {
+
+        if (!pcmk__xe_is(child, PCMK_XE_CHANGE)) {
+            pcmk__xml_copy(subset, (xmlNode *) child);
+
+        } else if (match[i++] == '1') {
+            pcmk__xml_copy(subset, (xmlNode *) child);
+        }
+    }
+    return subset;
+}
@@ -128,6 +128,10 @@ static const cib__operation_t cib_ops[] = {
     },
     {
         PCMK__CIB_REQUEST_SCHEMAS, cib__op_schemas, cib__op_attr_local
+    },
+    {
+        PCMK__CIB_REQUEST_STATS, cib__op_stats,
+        cib__op_attr_privileged|cib__op_attr_local
     }
 };
 
@@ -0,0 +1,504 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <limits.h>             // LLONG_MIN
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>               // clock_gettime(), time_t
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/cib/internal.h>
+#include <crm/common/xml.h>
+
+/* Each client and operation type keeps its costs in a ring of slots, one per
+ * interval of the statistics window. Recording a cost into a slot that holds
+ * an interval that has left the window resets the slot first, so the sum of
+ * the slots still in the window covers (roughly) the window's length.
+ */
+#define STATS_SLOTS 10
+
+typedef struct {
+    cib__request_cost_t cost;   // Sum of costs recorded during interval
+    long long interval;         // Interval number (time / slot length)
+} stats_slot_t;
+
+typedef struct {
+    char *name;                     // Client or operation name
+    stats_slot_t slots[STATS_SLOTS];
+} stats_entry_t;
+
+struct cib__stats_s {
+    guint slot_s;           // Length of each slot in seconds
+    long long pruned;       // Interval when expired entries were last removed
+    GHashTable *clients;    // Client name -> stats_entry_t
+    GHashTable *ops;        // Operation name -> stats_entry_t
+};
+
+// Cost of the request currently being processed, if it is being accounted
+static cib__request_cost_t *active_cost = NULL;
+
+/*!
+ * \internal
+ * \brief Get the CPU time used by the calling thread
+ *
+ * \return CPU time used by calling thread in microseconds (or 0 if unknown)
+ */
+uint64_t
+cib__thread_cpu_us(void)
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    struct timespec ts = { 0, };
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return ((uint64_t) ts.tv_sec * UINT64_C(1000000))
+               + ((uint64_t) ts.tv_nsec / UINT64_C(1000));
+    }
+#endif
+    return 0;
+}
+
+/*!
+ * \internal
+ * \brief Set (or clear) where to account the cost of the current request
+ *
+ * While a cost is set, the phases of CIB request processing measured with
+ * \c cib__cost_phase_start() and \c cib__cost_phase_end() are added to it.
+ *
+ * \param[in,out] cost  Cost to add phases to (or \c NULL to stop accounting)
+ */
+void
+cib__set_request_cost(cib__request_cost_t *cost)
+{
+    active_cost = cost;
+}
+
+/*!
+ * \internal
+ * \brief Get the cost of the request currently being accounted
+ *
+ * \return Cost set by \c cib__set_request_cost(), or \c NULL if none
+ */
+cib__request_cost_t *
+cib__request_cost(void)
+{
+    return active_cost;
+}
+
+/*!
+ * \internal
+ * \brief Start measuring a phase of CIB request processing
+ *
+ * \return Value to pass to \c cib__cost_phase_end()
+ * \note This is cheap when no request is being accounted.
+ */
+uint64_t
+cib__cost_phase_start(void)
+{
+    return (active_cost == NULL)? 0 : cib__thread_cpu_us();
+}
+
+/*!
+ * \internal
+ * \brief Add the CPU time used by a phase to the current request's cost
+ *
+ * \param[in] phase     Which phase has ended
+ * \param[in] start_us  Return value of \c cib__cost_phase_start()
+ */
+void
+cib__cost_phase_end(enum cib__cost_phase phase, uint64_t start_us)
+{
+    uint64_t end_us = 0;
+    uint64_t elapsed = 0;
+
+    if ((active_cost == NULL) || (start_us == 0)) {
+        return;
+    }
+
+    end_us = cib__thread_cpu_us();
+    elapsed = (end_us > start_us)? (end_us - start_us) : 0;
+
+    switch (phase) {
+        case cib__cost_acl:
+            active_cost->acl_us += elapsed;
+            break;
+        case cib__cost_diff:
+            active_cost->diff_us += elapsed;
+            break;
+        case cib__cost_notify:
+            active_cost->notify_us += elapsed;
+            break;
+    }
+}
+
+static void
+add_cost(cib__request_cost_t *sum, const cib__request_cost_t *cost)
+{
+    sum->requests += cost->requests;
+    sum->cpu_us += cost->cpu_us;
+    sum->bytes_in += cost->bytes_in;
+    sum->bytes_out += cost->bytes_out;
+    sum->acl_us += cost->acl_us;
+    sum->diff_us += cost->diff_us;
+    sum->notify_us += cost->notify_us;
+    sum->notifications += cost->notifications;
+}
+
+static void
+free_stats_entry(gpointer data)
+{
+    stats_entry_t *entry = data;
+
+    free(entry->name);
+    free(entry);
+}
+
+/*!
+ * \internal
+ * \brief Create a new table of CIB request costs
+ *
+ * \param[in] window_s  Length of time (in seconds) that costs are kept for
+ *
+ * \return Newly allocated table
+ * \note The caller is responsible for freeing the result using
+ *       \c cib__stats_free().
+ */
+cib__stats_t *
+cib__stats_new(guint window_s)
+{
+    cib__stats_t *stats = pcmk__assert_alloc(1, sizeof(cib__stats_t));
+
+    stats->slot_s = QB_MAX(window_s / STATS_SLOTS, 1);
+    stats->pruned = LLONG_MIN;
+    stats->clients = pcmk__strkey_table(NULL, free_stats_entry);
+    stats->ops = pcmk__strkey_table(NULL, free_stats_entry);
+    return stats;
+}
+
+/*!
+ * \internal
+ * \brief Free a table of CIB request costs
+ *
+ * \param[in,out] stats  Table to free
+ */
+void
+cib__stats_free(cib__stats_t *stats)
+{
+    if (stats != NULL) {
+        g_hash_table_destroy(stats->clients);
+        g_hash_table_destroy(stats->ops);
+        free(stats);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the length of time that a table of CIB request costs covers
+ *
+ * \param[in] stats  Table to check
+ *
+ * \return Length of \p stats window in seconds (which may differ slightly from
+ *         the value passed to \c cib__stats_new())
+ */
+guint
+cib__stats_window(const cib__stats_t *stats)
+{
+    CRM_CHECK(stats != NULL, return 0);
+    return stats->slot_s * STATS_SLOTS;
+}
+
+static inline long long
+interval_at(const cib__stats_t *stats, time_t now)
+{
+    return (long long) now / stats->slot_s;
+}
+
+// Whether a slot holds an interval within the window ending with interval
+static inline bool
+slot_current(const stats_slot_t *slot, long long interval)
+{
+    return (slot->interval <= interval)
+           && (slot->interval > interval - STATS_SLOTS);
+}
+
+// Sum an entry's costs within the window ending with the given interval
+static void
+sum_entry(const stats_entry_t *entry, long long interval,
+          cib__request_cost_t *sum)
+{
+    memset(sum, 0, sizeof(cib__request_cost_t));
+
+    for (int i = 0; i < STATS_SLOTS; i++) {
+        if (slot_current(&(entry->slots[i]), interval)) {
+            add_cost(sum, &(entry->slots[i].cost));
+        }
+    }
+}
+
+static gboolean
+entry_expired(gpointer key, gpointer value, gpointer user_data)
+{
+    const stats_entry_t *entry = value;
+    const long long *interval = user_data;
+
+    for (int i = 0; i < STATS_SLOTS; i++) {
+        if (slot_current(&(entry->slots[i]), *interval)) {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/* Drop entries with nothing left in the window, so that short-lived clients
+ * (which may be named after their process IDs) don't accumulate. This is done
+ * at most once per interval.
+ */
+static void
+prune_expired(cib__stats_t *stats, long long interval)
+{
+    if (interval > stats->pruned) {
+        g_hash_table_foreach_remove(stats->clients, entry_expired, &interval);
+        g_hash_table_foreach_remove(stats->ops, entry_expired, &interval);
+        stats->pruned = interval;
+    }
+}
+
+static void
+record_entry(GHashTable *table, const char *name, long long interval,
+             const cib__request_cost_t *cost)
+{
+    stats_entry_t *entry = g_hash_table_lookup(table, name);
+    stats_slot_t *slot = NULL;
+
+    if (entry == NULL) {
+        entry = pcmk__assert_alloc(1, sizeof(stats_entry_t));
+        entry->name = pcmk__str_copy(name);
+        for (int i = 0; i < STATS_SLOTS; i++) {
+            entry->slots[i].interval = LLONG_MIN;
+        }
+        g_hash_table_insert(table, entry->name, entry);
+    }
+
+    slot = &(entry->slots[((interval % STATS_SLOTS) + STATS_SLOTS)
+                          % STATS_SLOTS]);
+    if (slot->interval != interval) {
+        memset(&(slot->cost), 0, sizeof(cib__request_cost_t));
+        slot->interval = interval;
+    }
+    add_cost(&(slot->cost), cost);
+}
+
+/*!
+ * \internal
+ * \brief Add the cost of a CIB request to a table of request costs
+ *
+ * \param[in,out] stats   Table to update
+ * \param[in]     client  Name of client that sent request
+ * \param[in]     op      Name of requested operation
+ * \param[in]     cost    Cost of request
+ * \param[in]     now     Time that request completed
+ */
+void
+cib__stats_record(cib__stats_t *stats, const char *client, const char *op,
+                  const cib__request_cost_t *cost, time_t now)
+{
+    long long interval = 0;
+
+    CRM_CHECK((stats != NULL) && (cost != NULL), return);
+
+    interval = interval_at(stats, now);
+    prune_expired(stats, interval);
+    record_entry(stats->clients, pcmk__s(client, "unknown"), interval, cost);
+    record_entry(stats->ops, pcmk__s(op, "unknown"), interval, cost);
+}
+
+/*!
+ * \internal
+ * \brief Free a row returned by \c cib__stats_top()
+ *
+ * \param[in,out] data  Row to free
+ */
+void
+cib__stats_row_free(gpointer data)
+{
+    cib__stats_row_t *row = data;
+
+    if (row != NULL) {
+        free(row->name);
+        free(row);
+    }
+}
+
+// Most CPU time first, then most requests, then by name
+static gint
+compare_rows(gconstpointer a, gconstpointer b)
+{
+    const cib__stats_row_t *row_a = a;
+    const cib__stats_row_t *row_b = b;
+
+    if (row_a->cost.cpu_us != row_b->cost.cpu_us) {
+        return (row_a->cost.cpu_us > row_b->cost.cpu_us)? -1 : 1;
+    }
+    if (row_a->cost.requests != row_b->cost.requests) {
+        return (row_a->cost.requests > row_b->cost.requests)? -1 : 1;
+    }
+    return strcmp(row_a->name, row_b->name);
+}
+
+// Get all rows of a table with costs in the window, sorted by compare_rows()
+static GList *
+sorted_rows(GHashTable *table, long long interval)
+{
+    GList *rows = NULL;
+    GHashTableIter iter;
+    stats_entry_t *entry = NULL;
+
+    g_hash_table_iter_init(&iter, table);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &entry)) {
+        cib__stats_row_t *row = pcmk__assert_alloc(1,
+                                                   sizeof(cib__stats_row_t));
+
+        sum_entry(entry, interval, &(row->cost));
+        if (row->cost.requests == 0) {
+            free(row);
+            continue;
+        }
+        row->name = pcmk__str_copy(entry->name);
+        rows = g_list_prepend(rows, row);
+    }
+    return g_list_sort(rows, compare_rows);
+}
+
+// Keep only the first limit rows of a list (or all of them if limit is 0)
+static GList *
+truncate_rows(GList *rows, guint limit)
+{
+    GList *rest = NULL;
+
+    if ((limit == 0) || (g_list_length(rows) <= limit)) {
+        return rows;
+    }
+
+    rest = g_list_nth(rows, limit);
+    rest->prev->next = NULL;
+    rest->prev = NULL;
+    g_list_free_full(rest, cib__stats_row_free);
+    return rows;
+}
+
+/*!
+ * \internal
+ * \brief Get the clients or operations that cost the most CPU time
+ *
+ * \param[in,out] stats      Table to check (expired entries will be removed)
+ * \param[in]     by_client  If true, get clients, otherwise operation types
+ * \param[in]     limit      Maximum number of rows to return (0 for all)
+ * \param[in]     now        Current time
+ *
+ * \return List of <tt>cib__stats_row_t *</tt> with costs within the window
+ *         ending at \p now, most CPU time first
+ * \note The caller is responsible for freeing the result using
+ *       <tt>g_list_free_full(result, cib__stats_row_free)</tt>.
+ */
+GList *
+cib__stats_top(cib__stats_t *stats, bool by_client, guint limit, time_t now)
+{
+    long long interval = 0;
+
+    CRM_CHECK(stats != NULL, return NULL);
+
+    interval = interval_at(stats, now);
+    prune_expired(stats, interval);
+    return truncate_rows(sorted_rows((by_client? stats->clients : stats->ops),
+                                     interval),
+                         limit);
+}
+
+static void
+add_cost_xml(xmlNode *xml, const cib__request_cost_t *cost)
+{
+    crm_xml_add_ll(xml, PCMK__XA_REQUESTS, (long long) cost->requests);
+    crm_xml_add_ll(xml, PCMK__XA_CPU_US, (long long) cost->cpu_us);
+    crm_xml_add_ll(xml, PCMK__XA_BYTES_IN, (long long) cost->bytes_in);
+    crm_xml_add_ll(xml, PCMK__XA_BYTES_OUT, (long long) cost->bytes_out);
+    crm_xml_add_ll(xml, PCMK__XA_ACL_US, (long long) cost->acl_us);
+    crm_xml_add_ll(xml, PCMK__XA_DIFF_US, (long long) cost->diff_us);
+    crm_xml_add_ll(xml, PCMK__XA_NOTIFY_US, (long long) cost->notify_us);
+    crm_xml_add_ll(xml, PCMK__XA_NOTIFICATIONS,
+                   (long long) cost->notifications);
+}
+
+static void
+add_rows_xml(xmlNode *parent, const char *element, const GList *rows)
+{
+    for (const GList *iter = rows; iter != NULL; iter = iter->next) {
+        const cib__stats_row_t *row = iter->data;
+        xmlNode *xml = pcmk__xe_create(parent, element);
+
+        crm_xml_add(xml, PCMK_XA_NAME, row->name);
+        add_cost_xml(xml, &(row->cost));
+    }
+}
+
+/*!
+ * \internal
+ * \brief Create XML showing the clients and operations that cost the most
+ *
+ * The result has the window length and the total cost of all requests in the
+ * window as attributes, a \c PCMK__XE_CLIENT child for each of the top
+ * clients, and a \c PCMK_XE_OPERATION child for each of the top operation
+ * types.
+ *
+ * \param[in,out] stats  Table to check (expired entries will be removed)
+ * \param[in]     limit  Maximum number of clients and of operation types to
+ *                       show (0 for all)
+ * \param[in]     now    Current time
+ *
+ * \return Newly created XML
+ * \note The caller is responsible for freeing the result using
+ *       \c pcmk__xml_free().
+ */
+xmlNode *
+cib__stats_xml(cib__stats_t *stats, guint limit, time_t now)
+{
+    xmlNode *xml = NULL;
+    GList *clients = NULL;
+    GList *ops = NULL;
+    cib__request_cost_t total = { 0, };
+    long long interval = 0;
+
+    CRM_CHECK(stats != NULL, return NULL);
+
+    interval = interval_at(stats, now);
+    prune_expired(stats, interval);
+    clients = sorted_rows(stats->clients, interval);
+    ops = truncate_rows(sorted_rows(stats->ops, interval), limit);
+
+    // Every request has exactly one client, so the clients sum to the total
+    for (const GList *iter = clients; iter != NULL; iter = iter->next) {
+        add_cost(&total, &(((const cib__stats_row_t *) iter->data)->cost));
+    }
+    clients = truncate_rows(clients, limit);
+
+    xml = pcmk__xe_create(NULL, PCMK__XE_CIB_STATS);
+    crm_xml_add_int(xml, PCMK__XA_WINDOW, (int) cib__stats_window(stats));
+    add_cost_xml(xml, &total);
+    add_rows_xml(xml, PCMK__XE_CLIENT, clients);
+    add_rows_xml(xml, PCMK_XE_OPERATION, ops);
+
+    g_list_free_full(clients, cib__stats_row_free);
+    g_list_free_full(ops, cib__stats_row_free);
+    return xml;
+}
@@ -217,12 +217,11 @@ should_copy_cib(const char *op, const char *section, int call_options)
     return true;
 }
 
-int
-cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
-               cib__op_fn_t fn, bool is_query, const char *section,
-               xmlNode *req, xmlNode *input, bool manage_counters,
-               bool *config_changed, xmlNode **current_cib,
-               xmlNode **result_cib, xmlNode **diff, xmlNode **output)
+static int
+perform_op(cib_t *cib, const char *op, uint32_t call_options, cib__op_fn_t fn,
+           bool is_query, const char *section, xmlNode *req, xmlNode *input,
+           bool manage_counters, bool *config_changed, xmlNode **current_cib,
+           xmlNode **result_cib, xmlNode **diff, xmlNode **output)
 {
     int rc = pcmk_ok;
     bool check_schema = true;
@@ -234,6 +233,7 @@ cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
 
     const char *user = crm_element_value(req, PCMK__XA_CIB_USER);
     bool with_digest = false;
+    uint64_t diff_start = 0;
 
     crm_trace("Begin %s%s%s op",
               (pcmk_is_set(call_options, cib_dryrun)? "dry run of " : ""),
@@ -258,11 +258,14 @@ cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
     if (is_query) {
         xmlNode *cib_ro = *current_cib;
         xmlNode *cib_filtered = NULL;
+        uint64_t acl_start = cib__cost_phase_start();
+        bool filtered = cib_acl_enabled(cib_ro, user)
+                        && xml_acl_filtered_copy(user, *current_cib,
+                                                 *current_cib, &cib_filtered);
 
-        if (cib_acl_enabled(cib_ro, user)
-            && xml_acl_filtered_copy(user, *current_cib, *current_cib,
-                                     &cib_filtered)) {
+        cib__cost_phase_end(cib__cost_acl, acl_start);
 
+        if (filtered) {
             if (cib_filtered == NULL) {
                 crm_debug("Pre-filtered the entire cib");
                 return -EACCES;
@@ -403,6 +406,7 @@ cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
         }
     }
 
+    diff_start = cib__cost_phase_start();
     local_diff = xml_create_patchset(0, patchset_cib, scratch,
                                      config_changed, manage_counters);
 
@@ -411,8 +415,11 @@ cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
 
     if(local_diff) {
         patchset_process_digest(local_diff, patchset_cib, scratch, with_digest);
+        cib__cost_phase_end(cib__cost_diff, diff_start);
         pcmk__log_xml_patchset(LOG_INFO, local_diff);
         crm_log_xml_trace(local_diff, "raw patch");
+    } else {
+        cib__cost_phase_end(cib__cost_diff, diff_start);
     }
 
     if (make_copy && (local_diff != NULL)) {
@@ -515,13 +522,19 @@ cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
     /* @TODO: This may not work correctly with !make_copy, since we don't
      * keep the original CIB.
      */
-    if ((rc != pcmk_ok) && cib_acl_enabled(patchset_cib, user)
-        && xml_acl_filtered_copy(user, patchset_cib, scratch, result_cib)) {
+    if ((rc != pcmk_ok) && cib_acl_enabled(patchset_cib, user)) {
+        uint64_t acl_start = cib__cost_phase_start();
+        bool filtered = xml_acl_filtered_copy(user, patchset_cib, scratch,
+                                              result_cib);
 
-        if (*result_cib == NULL) {
-            crm_debug("Pre-filtered the entire cib result");
+        cib__cost_phase_end(cib__cost_acl, acl_start);
+
+        if (filtered) {
+            if (*result_cib == NULL) {
+                crm_debug("Pre-filtered the entire cib result");
+            }
+            pcmk__xml_free(scratch);
         }
-        pcmk__xml_free(scratch);
     }
 
     if(diff) {
@@ -535,6 +548,49 @@ cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
     return rc;
 }
 
+int
+cib_perform_op(cib_t *cib, const char *op, uint32_t call_options,
+               cib__op_fn_t fn, bool is_query, const char *section,
+               xmlNode *req, xmlNode *input, bool manage_counters,
+               bool *config_changed, xmlNode **current_cib,
+               xmlNode **result_cib, xmlNode **diff, xmlNode **output)
+{
+    static pcmk__metric_t queries =
+        PCMK__METRIC(pcmk__metric_counter, "cib_queries_total",
+                     "CIB read-only operations performed");
+    static pcmk__metric_t updates =
+        PCMK__METRIC(pcmk__metric_counter, "cib_updates_total",
+                     "CIB modifying operations performed");
+    static pcmk__metric_t failures =
+        PCMK__METRIC(pcmk__metric_counter, "cib_op_failures_total",
+                     "CIB operations that failed");
+    static pcmk__metric_t query_duration =
+        PCMK__METRIC(pcmk__metric_histogram, "cib_query_duration_us",
+                     "Time to perform a CIB read-only operation "
+                     "(microseconds)");
+    static pcmk__metric_t update_duration =
+        PCMK__METRIC(pcmk__metric_histogram, "cib_update_duration_us",
+                     "Time to perform a CIB modifying operation "
+                     "(microseconds)");
+
+    gint64 start = g_get_monotonic_time();
+    int rc = perform_op(cib, op, call_options, fn, is_query, section, req,
+                        input, manage_counters, config_changed, current_cib,
+                        result_cib, diff, output);
+
+    if (is_query) {
+        pcmk__metric_add(&queries, 1);
+        pcmk__metric_observe_since(&query_duration, start);
+    } else {
+        pcmk__metric_add(&updates, 1);
+        pcmk__metric_observe_since(&update_duration, start);
+    }
+    if (rc != pcmk_ok) {
+        pcmk__metric_add(&failures, 1);
+    }
+    return rc;
+}
+
 int
 cib__create_op(cib_t *cib, const char *op, const char *host,
                const char *section, xmlNode *data, int call_options,
@@ -717,6 +773,29 @@ cib_native_notify(gpointer data, gpointer user_data)
         return;
     }
 
+    if (entry->filter != NULL) {
+        /* The CIB manager sends the changes matching any of this connection's
+         * filters (or all changes, if it doesn't support filtering), so check
+         * this callback's own filter.
+         */
+        const xmlNode *patchset = NULL;
+        cib__diff_changes_t *changes = NULL;
+
+        cib__get_notify_patchset(msg, &patchset);
+        changes = cib__diff_changes_new(patchset);
+        if (changes != NULL) {
+            GList filters = { .data = entry->filter, };
+            guint n_matched = 0;
+
+            free(cib__diff_changes_match(changes, &filters, &n_matched));
+            cib__diff_changes_free(changes);
+            if (n_matched == 0) {
+                crm_trace("Skipping callback - no changes match filter");
+                return;
+            }
+        }
+    }
+
     crm_trace("Invoking callback for %p/%s event...", entry, event);
     entry->callback(event, msg);
     crm_trace("Callback invoked...");
@@ -0,0 +1,249 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+#define COMMIT_CALL_ID 42
+
+// Requests seen by the stub CIB connection
+static int transactions_started = 0;
+static int transactions_committed = 0;
+static int modifications = 0;
+static int deletions = 0;
+static int init_rc = pcmk_ok;
+static GString *requests = NULL;
+
+static int
+stub_init_transaction(cib_t *cib)
+{
+    if (init_rc == pcmk_ok) {
+        transactions_started++;
+    }
+    return init_rc;
+}
+
+static int
+stub_modify(cib_t *cib, const char *section, xmlNode *data, int call_options)
+{
+    assert_string_equal(section, PCMK_XE_STATUS);
+    assert_true(pcmk_is_set(call_options, cib_transaction));
+    assert_true(pcmk_is_set(call_options, cib_can_create));
+
+    modifications++;
+    pcmk__add_word(&requests, 64, "modify:");
+    g_string_append(requests, pcmk__xe_id(data));
+    return pcmk_ok;
+}
+
+static int
+stub_remove(cib_t *cib, const char *section, xmlNode *data, int call_options)
+{
+    assert_null(data);
+    assert_true(pcmk_all_flags_set(call_options,
+                                   cib_xpath|cib_multiple|cib_transaction));
+
+    deletions++;
+    pcmk__add_word(&requests, 64, "delete:");
+    g_string_append(requests, section);
+    return pcmk_ok;
+}
+
+static int
+stub_end_transaction(cib_t *cib, bool commit, int call_options)
+{
+    assert_true(commit);
+    transactions_committed++;
+    return COMMIT_CALL_ID;
+}
+
+static cib_api_operations_t stub_cmds = {
+    .modify = stub_modify,
+    .remove = stub_remove,
+    .init_transaction = stub_init_transaction,
+    .end_transaction = stub_end_transaction,
+};
+
+static cib_t stub_cib = {
+    .state = cib_connected_command,
+    .cmds = &stub_cmds,
+};
+
+static int
+reset_stub(void **state)
+{
+    transactions_started = 0;
+    transactions_committed = 0;
+    modifications = 0;
+    deletions = 0;
+    init_rc = pcmk_ok;
+    if (requests != NULL) {
+        g_string_free(requests, TRUE);
+    }
+    requests = g_string_sized_new(64);
+    return 0;
+}
+
+// Queue a fencing result the way the controller records one
+static void
+add_fenced_node(cib__status_batch_t *batch, const char *id, const char *name,
+                int action_id)
+{
+    xmlNode *node_state = pcmk__xe_create(NULL, PCMK__XE_NODE_STATE);
+    char *xpath = NULL;
+
+    crm_xml_add(node_state, PCMK_XA_ID, id);
+    crm_xml_add(node_state, PCMK__XA_JOIN, CRMD_JOINSTATE_DOWN);
+
+    if (name != NULL) {
+        xpath = crm_strdup_printf("//node_state[@uname='%s']/lrm", name);
+    }
+    cib__status_batch_add(batch, name, node_state, xpath, action_id);
+    free(xpath);
+}
+
+static void
+null_batch(void **state)
+{
+    assert_int_equal(cib__status_batch_length(NULL), 0);
+    assert_null(cib__status_batch_updates(NULL));
+    cib__status_batch_clear(NULL);
+    cib__status_batch_free(NULL);
+}
+
+static void
+empty_batch(void **state)
+{
+    cib__status_batch_t *batch = cib__status_batch_new();
+    int call_id = -1;
+    char *desc = NULL;
+
+    assert_int_equal(cib__status_batch_send(&stub_cib, batch, &call_id, &desc),
+                     pcmk_rc_ok);
+    assert_int_equal(call_id, 0);
+    assert_null(desc);
+    assert_int_equal(transactions_started, 0);
+    assert_int_equal(transactions_committed, 0);
+
+    cib__status_batch_free(batch);
+}
+
+static void
+multiple_nodes_one_transaction(void **state)
+{
+    cib__status_batch_t *batch = cib__status_batch_new();
+    const GList *updates = NULL;
+    int call_id = 0;
+    char *desc = NULL;
+
+    // Simulate losing a site of several nodes at about the same time
+    add_fenced_node(batch, "1", "node1", 11);
+    add_fenced_node(batch, "2", "node2", 12);
+    add_fenced_node(batch, "3", "node3", 13);
+    add_fenced_node(batch, "4", "node4", 14);
+    assert_int_equal(cib__status_batch_length(batch), 4);
+
+    assert_int_equal(cib__status_batch_send(&stub_cib, batch, &call_id, &desc),
+                     pcmk_rc_ok);
+    assert_int_equal(call_id, COMMIT_CALL_ID);
+    assert_int_equal(transactions_started, 1);
+    assert_int_equal(transactions_committed, 1);
+    assert_int_equal(modifications, 4);
+    assert_int_equal(deletions, 4);
+    assert_string_equal(desc, "node1, node2, node3, node4");
+
+    // Each node's state is updated before its history is deleted
+    assert_string_equal(requests->str,
+                        "modify:1 delete://node_state[@uname='node1']/lrm "
+                        "modify:2 delete://node_state[@uname='node2']/lrm "
+                        "modify:3 delete://node_state[@uname='node3']/lrm "
+                        "modify:4 delete://node_state[@uname='node4']/lrm");
+
+    // The updates stay available to the caller until cleared
+    updates = cib__status_batch_updates(batch);
+    assert_int_equal(g_list_length((GList *) updates), 4);
+    assert_int_equal(((const cib__status_update_t *) updates->data)->tag, 11);
+    assert_int_equal(((const cib__status_update_t *) updates->next->data)->tag,
+                     12);
+
+    cib__status_batch_clear(batch);
+    assert_int_equal(cib__status_batch_length(batch), 0);
+
+    free(desc);
+    cib__status_batch_free(batch);
+}
+
+static void
+unknown_node_name(void **state)
+{
+    cib__status_batch_t *batch = cib__status_batch_new();
+    int call_id = 0;
+    char *desc = NULL;
+
+    add_fenced_node(batch, "1", "node1", -1);
+    add_fenced_node(batch, "2", NULL, -1);
+
+    assert_int_equal(cib__status_batch_send(&stub_cib, batch, &call_id, &desc),
+                     pcmk_rc_ok);
+    assert_int_equal(call_id, COMMIT_CALL_ID);
+    assert_int_equal(transactions_committed, 1);
+    assert_int_equal(modifications, 2);
+    assert_int_equal(deletions, 1);
+    assert_string_equal(desc, "node1, 2");
+
+    free(desc);
+    cib__status_batch_free(batch);
+}
+
+static void
+transaction_not_started(void **state)
+{
+    cib__status_batch_t *batch = cib__status_batch_new();
+    int call_id = -1;
+    char *desc = NULL;
+
+    add_fenced_node(batch, "1", "node1", -1);
+    add_fenced_node(batch, "2", "node2", -1);
+
+    init_rc = -ENOTCONN;
+    assert_int_equal(cib__status_batch_send(&stub_cib, batch, &call_id, &desc),
+                     ENOTCONN);
+    assert_int_equal(call_id, 0);
+    assert_null(desc);
+    assert_int_equal(transactions_committed, 0);
+    assert_int_equal(modifications, 0);
+    assert_int_equal(deletions, 0);
+
+    // Nothing was sent, so the caller can still send the updates separately
+    assert_int_equal(cib__status_batch_length(batch), 2);
+
+    cib__status_batch_free(batch);
+}
+
+static int
+teardown(void **state)
+{
+    if (requests != NULL) {
+        g_string_free(requests, TRUE);
+        requests = NULL;
+    }
+    return pcmk__xml_test_teardown_group(state);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, teardown,
+                cmocka_unit_test(null_batch),
+                cmocka_unit_test_setup(empty_batch, reset_stub),
+                cmocka_unit_test_setup(multiple_nodes_one_transaction,
+                                       reset_stub),
+                cmocka_unit_test_setup(unknown_node_name, reset_stub),
+                cmocka_unit_test_setup(transaction_not_started, reset_stub))
@@ -0,0 +1,230 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+#define CIB_TEMPLATE                                                        \
+    "<cib admin_epoch='0' epoch='1' num_updates='%d'>"                      \
+      "<configuration>"                                                     \
+        "<crm_config/><nodes/><resources/><constraints/>"                   \
+      "</configuration>"                                                    \
+      "<status>"                                                            \
+        "<node_state id='1' uname='node1' join='%d'/>"                      \
+      "</status>"                                                           \
+    "</cib>"
+
+static xmlNode *
+cib_at(int num_updates)
+{
+    char *s = crm_strdup_printf(CIB_TEMPLATE, num_updates, num_updates);
+    xmlNode *cib = pcmk__xml_parse(s);
+
+    free(s);
+    return cib;
+}
+
+static xmlNode *
+patchset_between(int from, int to)
+{
+    xmlNode *source = cib_at(from);
+    xmlNode *target = cib_at(to);
+    xmlNode *patchset = NULL;
+
+    xml_track_changes(target, NULL, NULL, false);
+    xml_calculate_significant_changes(source, target);
+    patchset = xml_create_patchset(2, source, target, NULL, false);
+
+    pcmk__xml_free(source);
+    pcmk__xml_free(target);
+    return patchset;
+}
+
+// Get the chain of patchsets from one version to another, via a ring
+static xmlNode *
+chain_between(int from, int to)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+    xmlNode *parent = pcmk__xe_create(NULL, PCMK__XE_CIB_CALLDATA);
+    xmlNode *chain = NULL;
+    int from_v[] = { 0, 1, from };
+    int to_v[] = { 0, 1, to };
+
+    for (int i = from; i < to; i++) {
+        xmlNode *patchset = patchset_between(i, i + 1);
+
+        cib__patchset_ring_add(ring, patchset);
+        pcmk__xml_free(patchset);
+    }
+    assert_int_equal(cib__patchset_ring_chain(ring, from_v, to_v, parent),
+                     pcmk_rc_ok);
+    cib__patchset_ring_free(ring);
+
+    chain = pcmk__xe_first_child(parent, PCMK__XE_CIB_PATCHSETS, NULL, NULL);
+    chain = pcmk__xml_copy(NULL, chain);
+    pcmk__xml_free(parent);
+    return chain;
+}
+
+static char *
+digest_at(int num_updates)
+{
+    xmlNode *cib = cib_at(num_updates);
+    char *digest = pcmk__digest_xml(cib, true);
+
+    pcmk__xml_free(cib);
+    return digest;
+}
+
+static void
+invalid_arguments(void **state)
+{
+    xmlNode *cib = cib_at(1);
+    xmlNode *not_chain = pcmk__xe_create(NULL, PCMK_XE_DIFF);
+
+    assert_int_equal(cib__apply_patchset_chain(NULL, not_chain, "x"), EINVAL);
+    assert_int_equal(cib__apply_patchset_chain(cib, NULL, "x"), EINVAL);
+    assert_int_equal(cib__apply_patchset_chain(cib, not_chain, "x"), EINVAL);
+
+    pcmk__xml_free(cib);
+    pcmk__xml_free(not_chain);
+}
+
+static void
+no_digest(void **state)
+{
+    xmlNode *cib = cib_at(1);
+    xmlNode *chain = chain_between(1, 3);
+
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, NULL),
+                     pcmk_rc_diff_resync);
+
+    pcmk__xml_free(cib);
+    pcmk__xml_free(chain);
+}
+
+static void
+empty_chain(void **state)
+{
+    xmlNode *cib = cib_at(1);
+    xmlNode *chain = pcmk__xe_create(NULL, PCMK__XE_CIB_PATCHSETS);
+    char *digest = digest_at(1);
+
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_diff_resync);
+
+    free(digest);
+    pcmk__xml_free(cib);
+    pcmk__xml_free(chain);
+}
+
+static void
+chain_applies(void **state)
+{
+    xmlNode *cib = cib_at(2);
+    xmlNode *chain = chain_between(2, 6);
+    char *digest = digest_at(6);
+    char *result_digest = NULL;
+
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_ok);
+    assert_string_equal(crm_element_value(cib, PCMK_XA_NUM_UPDATES), "6");
+
+    result_digest = pcmk__digest_xml(cib, true);
+    assert_string_equal(result_digest, digest);
+
+    free(result_digest);
+    free(digest);
+    pcmk__xml_free(cib);
+    pcmk__xml_free(chain);
+}
+
+static void
+version_gap(void **state)
+{
+    // CIB is older than the start of the chain
+    xmlNode *cib = cib_at(1);
+    xmlNode *chain = chain_between(2, 6);
+    char *digest = digest_at(6);
+
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_diff_resync);
+    pcmk__xml_free(cib);
+
+    // CIB is newer than the start of the chain
+    cib = cib_at(3);
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_diff_resync);
+
+    free(digest);
+    pcmk__xml_free(cib);
+    pcmk__xml_free(chain);
+}
+
+static void
+missing_patchset(void **state)
+{
+    xmlNode *cib = cib_at(2);
+    xmlNode *chain = chain_between(2, 6);
+    char *digest = digest_at(6);
+
+    // Drop the second patchset (3 -> 4)
+    pcmk__xml_free(pcmk__xe_next(pcmk__xe_first_child(chain, NULL, NULL, NULL),
+                                 NULL));
+
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_diff_resync);
+
+    free(digest);
+    pcmk__xml_free(cib);
+    pcmk__xml_free(chain);
+}
+
+static void
+digest_mismatch(void **state)
+{
+    xmlNode *cib = cib_at(2);
+    xmlNode *chain = chain_between(2, 6);
+    char *digest = digest_at(6);
+    xmlNode *node_state = NULL;
+
+    // The peer's CIB has the right version but diverged content
+    node_state = pcmk__xe_first_child(pcmk__xe_first_child(cib, PCMK_XE_STATUS,
+                                                           NULL, NULL),
+                                      NULL, NULL, NULL);
+    crm_xml_add(node_state, PCMK_XA_UNAME, "node-one");
+
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_diff_failed);
+    pcmk__xml_free(cib);
+
+    // The sender's digest doesn't match its own history
+    cib = cib_at(2);
+    free(digest);
+    digest = digest_at(5);
+    assert_int_equal(cib__apply_patchset_chain(cib, chain, digest),
+                     pcmk_rc_diff_failed);
+
+    free(digest);
+    pcmk__xml_free(cib);
+    pcmk__xml_free(chain);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(invalid_arguments),
+                cmocka_unit_test(no_digest),
+                cmocka_unit_test(empty_chain),
+                cmocka_unit_test(chain_applies),
+                cmocka_unit_test(version_gap),
+                cmocka_unit_test(missing_patchset),
+                cmocka_unit_test(digest_mismatch))
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+#define INITIAL_CIB                                                         \
+    "<cib admin_epoch='0' epoch='1' num_updates='0'>"                       \
+      "<configuration>"                                                     \
+        "<crm_config/><nodes/><resources/><constraints/>"                   \
+      "</configuration>"                                                    \
+      "<status>"                                                            \
+        "<node_state id='1' uname='node1' join='down'/>"                    \
+      "</status>"                                                           \
+    "</cib>"
+
+/* Modify the status section the way the CIB manager processes a client
+ * request: perform the operation, activate the result, and record the
+ * resulting patchset for partial resyncs (or restart the history on failure)
+ */
+static void
+commit_modify(xmlNode **the_cib, cib__patchset_ring_t *ring, const char *join)
+{
+    xmlNode *req = pcmk__xe_create(NULL, PCMK__XE_CIB_COMMAND);
+    xmlNode *input = pcmk__xe_create(NULL, PCMK__XE_NODE_STATE);
+    xmlNode *result_cib = NULL;
+    xmlNode *diff = NULL;
+    xmlNode *output = NULL;
+    bool config_changed = false;
+    int rc = pcmk_ok;
+
+    crm_xml_add(req, PCMK__XA_CIB_OP, PCMK__CIB_REQUEST_MODIFY);
+    crm_xml_add(input, PCMK_XA_ID, "1");
+    crm_xml_add(input, PCMK__XA_JOIN, join);
+
+    rc = cib_perform_op(NULL, PCMK__CIB_REQUEST_MODIFY, cib_none,
+                        cib_process_modify, false, PCMK_XE_STATUS, req, input,
+                        true, &config_changed, the_cib, &result_cib, &diff,
+                        &output);
+    assert_int_equal(rc, pcmk_ok);
+    assert_non_null(diff);
+
+    if (result_cib != *the_cib) {
+        pcmk__xml_free(*the_cib);
+        *the_cib = result_cib;
+    }
+    cib__patchset_ring_add(ring, diff);
+
+    pcmk__xml_free(diff);
+    pcmk__xml_free(output);
+    pcmk__xml_free(input);
+    pcmk__xml_free(req);
+}
+
+static void
+null_ring(void **state)
+{
+    xmlNode *patchset = pcmk__xe_create(NULL, PCMK_XE_DIFF);
+
+    // This should do nothing
+    cib__patchset_ring_add(NULL, patchset);
+    pcmk__xml_free(patchset);
+}
+
+static void
+delta_sync_after_commits(void **state)
+{
+    xmlNode *the_cib = pcmk__xml_parse(INITIAL_CIB);
+    xmlNode *peer_cib = pcmk__xml_copy(NULL, the_cib);
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+    xmlNode *parent = pcmk__xe_create(NULL, PCMK__XE_CIB_CALLDATA);
+    int peer_version[] = { 0, 0, 0 };
+    int our_version[] = { 0, 0, 0 };
+    char *digest = NULL;
+
+    commit_modify(&the_cib, ring, "pending");
+    commit_modify(&the_cib, ring, "member");
+    commit_modify(&the_cib, ring, "down");
+    assert_int_equal(cib__patchset_ring_length(ring), 3);
+
+    cib_version_details(peer_cib, &peer_version[0], &peer_version[1],
+                        &peer_version[2]);
+    cib_version_details(the_cib, &our_version[0], &our_version[1],
+                        &our_version[2]);
+
+    // A peer still at the initial version gets patchsets, not the entire CIB
+    assert_int_equal(cib__patchset_ring_chain(ring, peer_version, our_version,
+                                              parent),
+                     pcmk_rc_ok);
+
+    digest = pcmk__digest_xml(the_cib, true);
+    assert_int_equal(cib__apply_patchset_chain(peer_cib,
+                                               pcmk__xe_first_child(parent,
+                                                   PCMK__XE_CIB_PATCHSETS,
+                                                   NULL, NULL),
+                                               digest),
+                     pcmk_rc_ok);
+    assert_string_equal(crm_element_value(pcmk__xe_first_child(
+                            pcmk_find_cib_element(peer_cib, PCMK_XE_STATUS),
+                            NULL, NULL, NULL), PCMK__XA_JOIN),
+                        "down");
+
+    free(digest);
+    pcmk__xml_free(parent);
+    cib__patchset_ring_free(ring);
+    pcmk__xml_free(peer_cib);
+    pcmk__xml_free(the_cib);
+}
+
+static void
+failed_activation(void **state)
+{
+    xmlNode *the_cib = pcmk__xml_parse(INITIAL_CIB);
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+
+    commit_modify(&the_cib, ring, "pending");
+    commit_modify(&the_cib, ring, "member");
+    assert_int_equal(cib__patchset_ring_length(ring), 2);
+
+    // A change with no usable patchset restarts the history
+    cib__patchset_ring_add(ring, NULL);
+    assert_int_equal(cib__patchset_ring_length(ring), 0);
+
+    // Later commits start a new chain
+    commit_modify(&the_cib, ring, "down");
+    assert_int_equal(cib__patchset_ring_length(ring), 1);
+
+    cib__patchset_ring_free(ring);
+    pcmk__xml_free(the_cib);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_ring),
+                cmocka_unit_test(delta_sync_after_commits),
+                cmocka_unit_test(failed_activation))
@@ -0,0 +1,272 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+#define CIB_TEMPLATE                                                        \
+    "<cib admin_epoch='0' epoch='1' num_updates='%d'>"                      \
+      "<configuration>"                                                     \
+        "<crm_config/><nodes/><resources/><constraints/>"                   \
+      "</configuration>"                                                    \
+      "<status>"                                                            \
+        "<node_state id='1' uname='node1' join='%d'/>"                      \
+      "</status>"                                                           \
+    "</cib>"
+
+static xmlNode *
+cib_at(int num_updates)
+{
+    char *s = crm_strdup_printf(CIB_TEMPLATE, num_updates, num_updates);
+    xmlNode *cib = pcmk__xml_parse(s);
+
+    free(s);
+    return cib;
+}
+
+static xmlNode *
+patchset_between(int from, int to)
+{
+    xmlNode *source = cib_at(from);
+    xmlNode *target = cib_at(to);
+    xmlNode *patchset = NULL;
+
+    xml_track_changes(target, NULL, NULL, false);
+    xml_calculate_significant_changes(source, target);
+    patchset = xml_create_patchset(2, source, target, NULL, false);
+
+    pcmk__xml_free(source);
+    pcmk__xml_free(target);
+    return patchset;
+}
+
+// Add patchsets for each version from "from" to "to" to a ring
+static void
+add_patchsets(cib__patchset_ring_t *ring, int from, int to)
+{
+    for (int i = from; i < to; i++) {
+        xmlNode *patchset = patchset_between(i, i + 1);
+
+        cib__patchset_ring_add(ring, patchset);
+        pcmk__xml_free(patchset);
+    }
+}
+
+static int
+chain_length(const xmlNode *parent)
+{
+    const xmlNode *chain = pcmk__xe_first_child(parent, PCMK__XE_CIB_PATCHSETS,
+                                                NULL, NULL);
+    int n = 0;
+
+    for (const xmlNode *patchset = pcmk__xe_first_child(chain, NULL, NULL,
+                                                        NULL);
+         patchset != NULL; patchset = pcmk__xe_next(patchset, NULL)) {
+        n++;
+    }
+    return n;
+}
+
+static void
+assert_chain(const cib__patchset_ring_t *ring, int from, int to,
+             int expected_rc, int expected_length)
+{
+    xmlNode *parent = pcmk__xe_create(NULL, PCMK__XE_CIB_CALLDATA);
+    int from_v[] = { 0, 1, from };
+    int to_v[] = { 0, 1, to };
+
+    assert_int_equal(cib__patchset_ring_chain(ring, from_v, to_v, parent),
+                     expected_rc);
+    assert_int_equal(chain_length(parent), expected_length);
+    pcmk__xml_free(parent);
+}
+
+static void
+null_ring(void **state)
+{
+    assert_chain(NULL, 1, 2, pcmk_rc_diff_resync, 0);
+}
+
+static void
+empty_ring(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+
+    assert_int_equal(cib__patchset_ring_length(ring), 0);
+    assert_chain(ring, 1, 2, pcmk_rc_diff_resync, 0);
+    cib__patchset_ring_free(ring);
+}
+
+static void
+chain_selection(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+    xmlNode *parent = pcmk__xe_create(NULL, PCMK__XE_CIB_CALLDATA);
+    const xmlNode *chain = NULL;
+    int from_v[] = { 0, 1, 3 };
+    int to_v[] = { 0, 1, 6 };
+    int expected = 3;
+
+    add_patchsets(ring, 1, 6);
+    assert_int_equal(cib__patchset_ring_length(ring), 5);
+
+    // Every start point in the ring gives the rest of the ring
+    assert_chain(ring, 1, 6, pcmk_rc_ok, 5);
+    assert_chain(ring, 4, 6, pcmk_rc_ok, 2);
+    assert_chain(ring, 5, 6, pcmk_rc_ok, 1);
+
+    // Patchsets are in order
+    assert_int_equal(cib__patchset_ring_chain(ring, from_v, to_v, parent),
+                     pcmk_rc_ok);
+    chain = pcmk__xe_first_child(parent, PCMK__XE_CIB_PATCHSETS, NULL, NULL);
+    for (const xmlNode *patchset = pcmk__xe_first_child(chain, NULL, NULL,
+                                                        NULL);
+         patchset != NULL; patchset = pcmk__xe_next(patchset, NULL)) {
+        int add[] = { 0, 0, 0 };
+        int del[] = { 0, 0, 0 };
+
+        assert_true(xml_patch_versions(patchset, add, del));
+        assert_int_equal(del[2], expected);
+        assert_int_equal(add[2], expected + 1);
+        expected++;
+    }
+    assert_int_equal(expected, 6);
+
+    pcmk__xml_free(parent);
+    cib__patchset_ring_free(ring);
+}
+
+static void
+peer_not_behind(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+
+    add_patchsets(ring, 1, 4);
+
+    // Peer is already at (or ahead of) our version
+    assert_chain(ring, 4, 4, pcmk_rc_diff_resync, 0);
+    assert_chain(ring, 5, 4, pcmk_rc_diff_resync, 0);
+
+    cib__patchset_ring_free(ring);
+}
+
+static void
+history_not_current(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+
+    add_patchsets(ring, 1, 4);
+
+    // History must end at our current version
+    assert_chain(ring, 1, 5, pcmk_rc_diff_resync, 0);
+    assert_chain(ring, 1, 3, pcmk_rc_diff_resync, 0);
+
+    cib__patchset_ring_free(ring);
+}
+
+static void
+peer_too_far_behind(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(3);
+
+    add_patchsets(ring, 1, 10);
+    assert_int_equal(cib__patchset_ring_length(ring), 3);
+
+    // Oldest patchsets were discarded
+    assert_chain(ring, 1, 10, pcmk_rc_diff_resync, 0);
+    assert_chain(ring, 6, 10, pcmk_rc_diff_resync, 0);
+    assert_chain(ring, 7, 10, pcmk_rc_ok, 3);
+
+    cib__patchset_ring_free(ring);
+}
+
+static void
+gap_in_history(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+
+    add_patchsets(ring, 1, 4);
+
+    // A patchset that doesn't continue from the last one restarts history
+    add_patchsets(ring, 5, 7);
+    assert_int_equal(cib__patchset_ring_length(ring), 2);
+    assert_chain(ring, 1, 7, pcmk_rc_diff_resync, 0);
+    assert_chain(ring, 3, 7, pcmk_rc_diff_resync, 0);
+    assert_chain(ring, 5, 7, pcmk_rc_ok, 2);
+
+    cib__patchset_ring_free(ring);
+}
+
+static void
+unusable_patchset(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+    xmlNode *patchset = NULL;
+
+    add_patchsets(ring, 1, 4);
+
+    // Unknown change, such as from a failed activation
+    cib__patchset_ring_add(ring, NULL);
+    assert_int_equal(cib__patchset_ring_length(ring), 0);
+
+    // Change that doesn't advance the version
+    add_patchsets(ring, 1, 4);
+    patchset = pcmk__xml_parse("<diff format='2'>"
+                                 "<version>"
+                                   "<source admin_epoch='0' epoch='1'"
+                                          " num_updates='4'/>"
+                                   "<target admin_epoch='0' epoch='1'"
+                                          " num_updates='4'/>"
+                                 "</version>"
+                               "</diff>");
+    cib__patchset_ring_add(ring, patchset);
+    assert_int_equal(cib__patchset_ring_length(ring), 0);
+    pcmk__xml_free(patchset);
+
+    // Wrong format
+    add_patchsets(ring, 1, 4);
+    patchset = pcmk__xml_parse("<diff format='1'/>");
+    cib__patchset_ring_add(ring, patchset);
+    assert_int_equal(cib__patchset_ring_length(ring), 0);
+    pcmk__xml_free(patchset);
+
+    cib__patchset_ring_free(ring);
+}
+
+static void
+clear(void **state)
+{
+    cib__patchset_ring_t *ring = cib__patchset_ring_new(10);
+
+    add_patchsets(ring, 1, 4);
+    cib__patchset_ring_clear(ring);
+    assert_int_equal(cib__patchset_ring_length(ring), 0);
+    assert_chain(ring, 1, 4, pcmk_rc_diff_resync, 0);
+
+    // Ring is still usable
+    add_patchsets(ring, 4, 6);
+    assert_chain(ring, 4, 6, pcmk_rc_ok, 2);
+
+    cib__patchset_ring_free(ring);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_ring),
+                cmocka_unit_test(empty_ring),
+                cmocka_unit_test(chain_selection),
+                cmocka_unit_test(peer_not_behind),
+                cmocka_unit_test(history_not_current),
+                cmocka_unit_test(peer_too_far_behind),
+                cmocka_unit_test(gap_in_history),
+                cmocka_unit_test(unusable_patchset),
+                cmocka_unit_test(clear))
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+
+/* Changes:
+ * 0: result of an operation on node 1
+ * 1: new resource history (including an operation) on node 2
+ * 2: cluster option change
+ * 3: deletion of node 2 from the configuration
+ */
+#define PATCHSET                                                            \
+    "<diff format='2'>"                                                     \
+      "<version>"                                                           \
+        "<source admin_epoch='0' epoch='1' num_updates='1'/>"               \
+        "<target admin_epoch='0' epoch='2' num_updates='0'/>"               \
+      "</version>"                                                          \
+      "<change operation='modify' path=\"/cib/status/node_state[@id='1']"  \
+        "/lrm[@id='1']/lrm_resources/lrm_resource[@id='rsc1']"              \
+        "/lrm_rsc_op[@id='rsc1_last_0']\">"                                 \
+        "<change-list>"                                                     \
+          "<change-attr name='rc-code' operation='set' value='0'/>"         \
+        "</change-list>"                                                    \
+        "<change-result>"                                                   \
+          "<lrm_rsc_op id='rsc1_last_0' rc-code='0'/>"                      \
+        "</change-result>"                                                  \
+      "</change>"                                                           \
+      "<change operation='create' path=\"/cib/status/node_state[@id='2']"   \
+        "/lrm[@id='2']/lrm_resources\" position='0'>"                       \
+        "<lrm_resource id='rsc2'>"                                          \
+          "<lrm_rsc_op id='rsc2_last_0' rc-code='7'/>"                      \
+        "</lrm_resource>"                                                   \
+      "</change>"                                                           \
+      "<change operation='modify' path=\"/cib/configuration/crm_config"     \
+        "/cluster_property_set[@id='opts']/nvpair[@id='opts-x']\">"         \
+        "<change-list>"                                                     \
+          "<change-attr name='value' operation='set' value='true'/>"        \
+        "</change-list>"                                                    \
+        "<change-result>"                                                   \
+          "<nvpair id='opts-x' name='x' value='true'/>"                     \
+        "</change-result>"                                                  \
+      "</change>"                                                           \
+      "<change operation='delete'"                                          \
+        " path=\"/cib/configuration/nodes/node[@id='2']\"/>"                \
+    "</diff>"
+
+static cib__diff_changes_t *changes = NULL;
+static xmlNode *patchset = NULL;
+
+static int
+setup(void **state)
+{
+    pcmk__xml_test_setup_group(state);
+    patchset = pcmk__xml_parse(PATCHSET);
+    changes = cib__diff_changes_new(patchset);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    cib__diff_changes_free(changes);
+    pcmk__xml_free(patchset);
+    pcmk__xml_test_teardown_group(state);
+    return 0;
+}
+
+static void
+assert_match(const char *section, const char *node_id, const char *element,
+             const char *xpath, const char *expected)
+{
+    cib__notify_filter_t *filter = NULL;
+    GList *filters = NULL;
+    char *match = NULL;
+    guint n_matched = 0;
+    guint n_expected = 0;
+
+    assert_int_equal(cib__notify_filter_new(section, node_id, element, xpath,
+                                            &filter),
+                     pcmk_rc_ok);
+    filters = g_list_append(filters, filter);
+
+    match = cib__diff_changes_match(changes, filters, &n_matched);
+    assert_string_equal(match, expected);
+
+    for (const char *c = expected; *c != '\0'; c++) {
+        if (*c == '1') {
+            n_expected++;
+        }
+    }
+    assert_int_equal(n_matched, n_expected);
+
+    free(match);
+    g_list_free_full(filters, cib__notify_filter_free);
+}
+
+static void
+not_v2_patchset(void **state)
+{
+    xmlNode *v1 = pcmk__xml_parse("<diff format='1'/>");
+
+    assert_null(cib__diff_changes_new(NULL));
+    assert_null(cib__diff_changes_new(v1));
+    pcmk__xml_free(v1);
+}
+
+static void
+parsed(void **state)
+{
+    assert_non_null(changes);
+    assert_int_equal(cib__diff_changes_count(changes), 4);
+}
+
+static void
+no_filters(void **state)
+{
+    guint n_matched = 1;
+    char *match = cib__diff_changes_match(changes, NULL, &n_matched);
+
+    assert_string_equal(match, "0000");
+    assert_int_equal(n_matched, 0);
+    free(match);
+}
+
+static void
+empty_filter(void **state)
+{
+    assert_match(NULL, NULL, NULL, NULL, "1111");
+}
+
+static void
+section_filter(void **state)
+{
+    assert_match(PCMK_XE_STATUS, NULL, NULL, NULL, "1100");
+    assert_match(PCMK_XE_CONFIGURATION, NULL, NULL, NULL, "0011");
+    assert_match(PCMK_XE_NODES, NULL, NULL, NULL, "0001");
+    assert_match(PCMK_XE_CRM_CONFIG, NULL, NULL, NULL, "0010");
+    assert_match(PCMK_XE_RESOURCES, NULL, NULL, NULL, "0000");
+}
+
+static void
+node_filter(void **state)
+{
+    assert_match(NULL, "1", NULL, NULL, "1000");
+    assert_match(NULL, "2", NULL, NULL, "0101");
+    assert_match(NULL, "3", NULL, NULL, "0000");
+}
+
+static void
+element_filter(void **state)
+{
+    // The deletion might remove elements of any type
+    assert_match(NULL, NULL, PCMK__XE_LRM_RSC_OP, NULL, "1101");
+    assert_match(NULL, NULL, PCMK__XE_LRM_RESOURCE, NULL, "0101");
+    assert_match(NULL, NULL, PCMK_XE_NVPAIR, NULL, "0011");
+    assert_match(NULL, NULL, PCMK_XE_PRIMITIVE, NULL, "0001");
+}
+
+static void
+xpath_filter(void **state)
+{
+    assert_match(NULL, NULL, NULL, "/cib/configuration/crm_config", "0010");
+    assert_match(NULL, NULL, NULL, "/cib/status/node_state[@id='1']", "1000");
+    assert_match(NULL, NULL, NULL, "/cib/status/node_state", "1100");
+    assert_match(NULL, NULL, NULL,
+                 "/cib/status/node_state[@id='2']/lrm[@id='2']/lrm_resources"
+                 "/lrm_resource[@id='rsc2']/lrm_rsc_op[@id='rsc2_last_0']",
+                 "0100");
+
+    // Deleting an ancestor affects everything beneath it
+    assert_match(NULL, NULL, NULL,
+                 "/cib/configuration/nodes/node[@id='2']"
+                 "/instance_attributes[@id='attrs']", "0001");
+
+    // Similar names aren't confused
+    assert_match(NULL, NULL, NULL, "/cib/status/node_state[@id='10']", "0000");
+}
+
+static void
+combined_criteria(void **state)
+{
+    assert_match(PCMK_XE_STATUS, "2", NULL, NULL, "0100");
+    assert_match(PCMK_XE_CONFIGURATION, "2", NULL, NULL, "0001");
+    assert_match(PCMK_XE_STATUS, NULL, PCMK__XE_LRM_RSC_OP, NULL, "1100");
+}
+
+static void
+multiple_filters(void **state)
+{
+    cib__notify_filter_t *filter = NULL;
+    GList *filters = NULL;
+    char *match = NULL;
+    guint n_matched = 0;
+
+    cib__notify_filter_new(NULL, "1", NULL, NULL, &filter);
+    filters = g_list_append(filters, filter);
+    cib__notify_filter_new(NULL, NULL, NULL, "/cib/configuration/crm_config",
+                           &filter);
+    filters = g_list_append(filters, filter);
+
+    match = cib__diff_changes_match(changes, filters, &n_matched);
+    assert_string_equal(match, "1010");
+    assert_int_equal(n_matched, 2);
+
+    free(match);
+    g_list_free_full(filters, cib__notify_filter_free);
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(not_v2_patchset),
+                cmocka_unit_test(parsed),
+                cmocka_unit_test(no_filters),
+                cmocka_unit_test(empty_filter),
+                cmocka_unit_test(section_filter),
+                cmocka_unit_test(node_filter),
+                cmocka_unit_test(element_filter),
+                cmocka_unit_test(xpath_filter),
+                cmocka_unit_test(combined_criteria),
+                cmocka_unit_test(multiple_filters))
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+
+/* Changes:
+ * 0: result of an operation on node 1
+ * 1: new resource history (including an operation) on node 2
+ * 2: cluster option change
+ * 3: deletion of node 2 from the configuration
+ */
+#define PATCHSET                                                            \
+    "<diff format='2' digest='0123456789abcdef'>"                                                     \
+      "<version>"                                                           \
+        "<source admin_epoch='0' epoch='1' num_updates='1'/>"               \
+        "<target admin_epoch='0' epoch='2' num_updates='0'/>"               \
+      "</version>"                                                          \
+      "<change operation='modify' path=\"/cib/status/node_state[@id='1']"  \
+        "/lrm[@id='1']/lrm_resources/lrm_resource[@id='rsc1']"              \
+        "/lrm_rsc_op[@id='rsc1_last_0']\">"                                 \
+        "<change-list>"                                                     \
+          "<change-attr name='rc-code' operation='set' value='0'/>"         \
+        "</change-list>"                                                    \
+        "<change-result>"                                                   \
+          "<lrm_rsc_op id='rsc1_last_0' rc-code='0'/>"                      \
+        "</change-result>"                                                  \
+      "</change>"                                                           \
+      "<change operation='create' path=\"/cib/status/node_state[@id='2']"   \
+        "/lrm[@id='2']/lrm_resources\" position='0'>"                       \
+        "<lrm_resource id='rsc2'>"                                          \
+          "<lrm_rsc_op id='rsc2_last_0' rc-code='7'/>"                      \
+        "</lrm_resource>"                                                   \
+      "</change>"                                                           \
+      "<change operation='modify' path=\"/cib/configuration/crm_config"     \
+        "/cluster_property_set[@id='opts']/nvpair[@id='opts-x']\">"         \
+        "<change-list>"                                                     \
+          "<change-attr name='value' operation='set' value='true'/>"        \
+        "</change-list>"                                                    \
+        "<change-result>"                                                   \
+          "<nvpair id='opts-x' name='x' value='true'/>"                     \
+        "</change-result>"                                                  \
+      "</change>"                                                           \
+      "<change operation='delete'"                                          \
+        " path=\"/cib/configuration/nodes/node[@id='2']\"/>"                \
+    "</diff>"
+
+static cib__diff_changes_t *changes = NULL;
+static xmlNode *patchset = NULL;
+
+static int
+setup(void **state)
+{
+    pcmk__xml_test_setup_group(state);
+    patchset = pcmk__xml_parse(PATCHSET);
+    changes = cib__diff_changes_new(patchset);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    cib__diff_changes_free(changes);
+    pcmk__xml_free(patchset);
+    pcmk__xml_test_teardown_group(state);
+    return 0;
+}
+
+static char *
+match_for(const char *section, const char *node_id, const char *xpath)
+{
+    cib__notify_filter_t *filter = NULL;
+    GList *filters = NULL;
+    char *match = NULL;
+
+    assert_int_equal(cib__notify_filter_new(section, node_id, NULL, xpath,
+                                            &filter),
+                     pcmk_rc_ok);
+    filters = g_list_append(filters, filter);
+    match = cib__diff_changes_match(changes, filters, NULL);
+    g_list_free_full(filters, cib__notify_filter_free);
+    return match;
+}
+
+static size_t
+xml_bytes(const xmlNode *xml)
+{
+    GString *buffer = g_string_sized_new(1024);
+    size_t bytes = 0;
+
+    pcmk__xml_string(xml, 0, buffer, 0);
+    bytes = buffer->len;
+    g_string_free(buffer, TRUE);
+    return bytes;
+}
+
+static void
+assert_subset_changes(const xmlNode *subset, const char *expected_path)
+{
+    const xmlNode *change = pcmk__xe_first_child(subset, PCMK_XE_CHANGE, NULL,
+                                                 NULL);
+
+    assert_non_null(change);
+    assert_string_equal(crm_element_value(change, PCMK_XA_PATH),
+                        expected_path);
+    assert_null(pcmk__xe_next(change, PCMK_XE_CHANGE));
+}
+
+static void
+subset_keeps_only_matches(void **state)
+{
+    char *match = match_for(NULL, NULL, "/cib/configuration/crm_config");
+    xmlNode *subset = cib__diff_changes_subset(changes, match, NULL);
+    cib__diff_changes_t *subset_changes = NULL;
+
+    assert_non_null(subset);
+    assert_true(pcmk__xe_is(subset, (const char *) patchset->name));
+
+    // Format and version are kept, but the digest no longer applies
+    assert_string_equal(crm_element_value(subset, PCMK_XA_FORMAT), "2");
+    assert_null(crm_element_value(subset, PCMK__XA_DIGEST));
+    assert_non_null(pcmk__xe_first_child(subset, PCMK_XE_VERSION, NULL, NULL));
+
+    assert_subset_changes(subset,
+                          "/cib/configuration/crm_config"
+                          "/cluster_property_set[@id='opts']"
+                          "/nvpair[@id='opts-x']");
+
+    // The subset can itself be parsed and filtered
+    subset_changes = cib__diff_changes_new(subset);
+    assert_int_equal(cib__diff_changes_count(subset_changes), 1);
+    cib__diff_changes_free(subset_changes);
+
+    free(match);
+    pcmk__xml_free(subset);
+}
+
+static void
+subset_added_to_parent(void **state)
+{
+    xmlNode *parent = pcmk__xe_create(NULL, PCMK__XE_CIB_UPDATE_RESULT);
+    char *match = match_for(NULL, "1", NULL);
+    xmlNode *subset = cib__diff_changes_subset(changes, match, parent);
+
+    assert_ptr_equal(pcmk__xe_first_child(parent, NULL, NULL, NULL), subset);
+    assert_subset_changes(subset,
+                          "/cib/status/node_state[@id='1']/lrm[@id='1']"
+                          "/lrm_resources/lrm_resource[@id='rsc1']"
+                          "/lrm_rsc_op[@id='rsc1_last_0']");
+
+    free(match);
+    pcmk__xml_free(parent);
+}
+
+static void
+multiple_subscribers(void **state)
+{
+    /* Subscribers interested in node 1 (by ID or by path), node 2, cluster
+     * options, and everything
+     */
+    char *node1_by_id = match_for(NULL, "1", NULL);
+    char *node1_by_path = match_for(NULL, NULL,
+                                    "/cib/status/node_state[@id='1']");
+    char *node2 = match_for(PCMK_XE_STATUS, "2", NULL);
+    char *options = match_for(PCMK_XE_CRM_CONFIG, NULL, NULL);
+    char *all = match_for(NULL, NULL, NULL);
+    size_t full_bytes = xml_bytes(patchset);
+    xmlNode *subset = NULL;
+
+    // Equivalent filters produce the same key, so one subset can be shared
+    assert_string_equal(node1_by_id, node1_by_path);
+    assert_string_equal(node2, "0100");
+    assert_string_equal(options, "0010");
+
+    // A subscriber that matches every change gets the original patchset
+    assert_string_equal(all, "1111");
+
+    // Each subset is much smaller than the full patchset
+    subset = cib__diff_changes_subset(changes, node1_by_id, NULL);
+    assert_true(xml_bytes(subset) < full_bytes);
+    pcmk__xml_free(subset);
+
+    subset = cib__diff_changes_subset(changes, node2, NULL);
+    assert_subset_changes(subset,
+                          "/cib/status/node_state[@id='2']/lrm[@id='2']"
+                          "/lrm_resources");
+    assert_true(xml_bytes(subset) < full_bytes);
+    pcmk__xml_free(subset);
+
+    subset = cib__diff_changes_subset(changes, options, NULL);
+    assert_true(xml_bytes(subset) < full_bytes);
+    pcmk__xml_free(subset);
+
+    free(node1_by_id);
+    free(node1_by_path);
+    free(node2);
+    free(options);
+    free(all);
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(subset_keeps_only_matches),
+                cmocka_unit_test(subset_added_to_parent),
+                cmocka_unit_test(multiple_subscribers))
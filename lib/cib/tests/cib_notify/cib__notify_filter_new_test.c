@@ -0,0 +1,169 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+
+static void
+null_filter(void **state)
+{
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL, NULL, NULL),
+                     EINVAL);
+}
+
+static void
+invalid_section(void **state)
+{
+    cib__notify_filter_t *filter = NULL;
+
+    assert_int_equal(cib__notify_filter_new(PCMK_XE_PRIMITIVE, NULL, NULL,
+                                            NULL, &filter),
+                     pcmk_rc_bad_input);
+    assert_null(filter);
+
+    assert_int_equal(cib__notify_filter_new("", NULL, NULL, NULL, &filter),
+                     pcmk_rc_bad_input);
+    assert_null(filter);
+}
+
+static void
+invalid_xpath(void **state)
+{
+    cib__notify_filter_t *filter = NULL;
+
+    // Not absolute
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL, "status",
+                                            &filter),
+                     pcmk_rc_bad_input);
+
+    // Not beneath the CIB
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL, "/status",
+                                            &filter),
+                     pcmk_rc_bad_input);
+
+    // Wildcard, descendant axis, non-ID predicate, or unterminated predicate
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL, "/cib/*",
+                                            &filter),
+                     pcmk_rc_bad_input);
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL,
+                                            "/cib//node_state", &filter),
+                     pcmk_rc_bad_input);
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL,
+                                            "/cib/status/node_state[@uname='a']",
+                                            &filter),
+                     pcmk_rc_bad_input);
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL,
+                                            "/cib/status/node_state[@id='1",
+                                            &filter),
+                     pcmk_rc_bad_input);
+    assert_null(filter);
+}
+
+static void
+valid_filters(void **state)
+{
+    cib__notify_filter_t *filter = NULL;
+
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, NULL, NULL, &filter),
+                     pcmk_rc_ok);
+    assert_non_null(filter);
+    assert_null(filter->section);
+    assert_null(filter->node_id);
+    assert_null(filter->element);
+    assert_null(filter->xpath_prefix);
+    cib__notify_filter_free(filter);
+
+    assert_int_equal(cib__notify_filter_new(PCMK_XE_STATUS, "1",
+                                            PCMK__XE_LRM_RSC_OP,
+                                            "/cib/status/node_state[@id='1']"
+                                            "/lrm[@id='1']",
+                                            &filter),
+                     pcmk_rc_ok);
+    assert_string_equal(filter->section, PCMK_XE_STATUS);
+    assert_string_equal(filter->node_id, "1");
+    assert_string_equal(filter->element, PCMK__XE_LRM_RSC_OP);
+    assert_string_equal(filter->xpath_prefix,
+                        "/cib/status/node_state[@id='1']/lrm[@id='1']");
+    cib__notify_filter_free(filter);
+}
+
+static void
+xml_round_trip(void **state)
+{
+    xmlNode *request = pcmk__xe_create(NULL, PCMK__XE_CIB_CALLBACK);
+    cib__notify_filter_t *filter = NULL;
+    GList *filters = NULL;
+
+    // No filters
+    assert_int_equal(cib__notify_filters_from_xml(request, &filters),
+                     pcmk_rc_ok);
+    assert_null(filters);
+
+    assert_int_equal(cib__notify_filter_new(PCMK_XE_STATUS, "1", NULL, NULL,
+                                            &filter),
+                     pcmk_rc_ok);
+    cib__notify_filter_add_xml(filter, request);
+    cib__notify_filter_free(filter);
+
+    assert_int_equal(cib__notify_filter_new(NULL, NULL, PCMK_XE_PRIMITIVE,
+                                            NULL, &filter),
+                     pcmk_rc_ok);
+    cib__notify_filter_add_xml(filter, request);
+    cib__notify_filter_free(filter);
+
+    assert_int_equal(cib__notify_filters_from_xml(request, &filters),
+                     pcmk_rc_ok);
+    assert_int_equal(g_list_length(filters), 2);
+
+    filter = filters->data;
+    assert_string_equal(filter->section, PCMK_XE_STATUS);
+    assert_string_equal(filter->node_id, "1");
+    assert_null(filter->element);
+    assert_null(filter->xpath_prefix);
+
+    filter = filters->next->data;
+    assert_null(filter->section);
+    assert_null(filter->node_id);
+    assert_string_equal(filter->element, PCMK_XE_PRIMITIVE);
+    assert_null(filter->xpath_prefix);
+
+    g_list_free_full(filters, cib__notify_filter_free);
+    pcmk__xml_free(request);
+}
+
+static void
+xml_invalid_filter(void **state)
+{
+    xmlNode *request = pcmk__xe_create(NULL, PCMK__XE_CIB_CALLBACK);
+    xmlNode *xml = NULL;
+    GList *filters = NULL;
+
+    xml = pcmk__xe_create(request, PCMK__XE_CIB_NOTIFY_FILTER);
+    crm_xml_add(xml, PCMK__XA_CIB_SECTION, PCMK_XE_STATUS);
+
+    xml = pcmk__xe_create(request, PCMK__XE_CIB_NOTIFY_FILTER);
+    crm_xml_add(xml, PCMK__XA_CIB_NOTIFY_XPATH, "//primitive");
+
+    assert_int_equal(cib__notify_filters_from_xml(request, &filters),
+                     pcmk_rc_bad_input);
+    assert_null(filters);
+
+    pcmk__xml_free(request);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_filter),
+                cmocka_unit_test(invalid_section),
+                cmocka_unit_test(invalid_xpath),
+                cmocka_unit_test(valid_filters),
+                cmocka_unit_test(xml_round_trip),
+                cmocka_unit_test(xml_invalid_filter))
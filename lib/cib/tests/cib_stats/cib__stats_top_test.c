@@ -0,0 +1,235 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+
+// Start of a 30-second slot in a 300-second window
+#define NOW 30000
+
+static void
+record(cib__stats_t *stats, const char *client, const char *op,
+       uint64_t cpu_us, time_t now)
+{
+    cib__request_cost_t cost = {
+        .requests = 1,
+        .cpu_us = cpu_us,
+        .bytes_in = 100,
+        .bytes_out = 200,
+    };
+
+    cib__stats_record(stats, client, op, &cost, now);
+}
+
+static void
+assert_row(const GList *iter, const char *name, uint64_t requests,
+           uint64_t cpu_us)
+{
+    const cib__stats_row_t *row = NULL;
+
+    assert_non_null(iter);
+    row = iter->data;
+    assert_string_equal(row->name, name);
+    assert_int_equal(row->cost.requests, requests);
+    assert_int_equal(row->cost.cpu_us, cpu_us);
+    assert_int_equal(row->cost.bytes_in, requests * 100);
+    assert_int_equal(row->cost.bytes_out, requests * 200);
+}
+
+static void
+null_stats(void **state)
+{
+    cib__request_cost_t cost = { 0, };
+
+    assert_null(cib__stats_top(NULL, true, 0, NOW));
+    assert_int_equal(cib__stats_window(NULL), 0);
+
+    // These should do nothing
+    cib__stats_record(NULL, "client", PCMK__CIB_REQUEST_QUERY, &cost, NOW);
+    cib__stats_free(NULL);
+}
+
+static void
+window_length(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+
+    assert_int_equal(cib__stats_window(stats), 300);
+    cib__stats_free(stats);
+
+    // The window can't be shorter than one second per slot
+    stats = cib__stats_new(0);
+    assert_int_equal(cib__stats_window(stats), 10);
+    cib__stats_free(stats);
+}
+
+static void
+empty_table(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+
+    assert_null(cib__stats_top(stats, true, 0, NOW));
+    assert_null(cib__stats_top(stats, false, 0, NOW));
+    cib__stats_free(stats);
+}
+
+static void
+known_mix(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    GList *rows = NULL;
+
+    for (int i = 0; i < 3; i++) {
+        record(stats, "crmd", PCMK__CIB_REQUEST_QUERY, 100, NOW + i);
+    }
+    record(stats, "cibadmin", PCMK__CIB_REQUEST_REPLACE, 5000, NOW + 40);
+    record(stats, "attrd", PCMK__CIB_REQUEST_MODIFY, 200, NOW + 70);
+    record(stats, "attrd", PCMK__CIB_REQUEST_QUERY, 200, NOW + 100);
+
+    rows = cib__stats_top(stats, true, 0, NOW + 100);
+    assert_int_equal(g_list_length(rows), 3);
+    assert_row(rows, "cibadmin", 1, 5000);
+    assert_row(rows->next, "attrd", 2, 400);
+    assert_row(rows->next->next, "crmd", 3, 300);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    rows = cib__stats_top(stats, false, 0, NOW + 100);
+    assert_int_equal(g_list_length(rows), 3);
+    assert_row(rows, PCMK__CIB_REQUEST_REPLACE, 1, 5000);
+    assert_row(rows->next, PCMK__CIB_REQUEST_QUERY, 4, 500);
+    assert_row(rows->next->next, PCMK__CIB_REQUEST_MODIFY, 1, 200);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    cib__stats_free(stats);
+}
+
+static void
+limit_rows(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    GList *rows = NULL;
+
+    record(stats, "a", PCMK__CIB_REQUEST_QUERY, 300, NOW);
+    record(stats, "b", PCMK__CIB_REQUEST_QUERY, 200, NOW);
+    record(stats, "c", PCMK__CIB_REQUEST_QUERY, 100, NOW);
+
+    rows = cib__stats_top(stats, true, 2, NOW);
+    assert_int_equal(g_list_length(rows), 2);
+    assert_row(rows, "a", 1, 300);
+    assert_row(rows->next, "b", 1, 200);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    // A limit larger than the table gets everything
+    rows = cib__stats_top(stats, true, 5, NOW);
+    assert_int_equal(g_list_length(rows), 3);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    cib__stats_free(stats);
+}
+
+static void
+ties(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    GList *rows = NULL;
+
+    // Same CPU time: more requests first, then by name
+    record(stats, "b", PCMK__CIB_REQUEST_QUERY, 100, NOW);
+    record(stats, "c", PCMK__CIB_REQUEST_QUERY, 50, NOW);
+    record(stats, "c", PCMK__CIB_REQUEST_QUERY, 50, NOW);
+    record(stats, "a", PCMK__CIB_REQUEST_QUERY, 100, NOW);
+
+    rows = cib__stats_top(stats, true, 0, NOW);
+    assert_row(rows, "c", 2, 100);
+    assert_row(rows->next, "a", 1, 100);
+    assert_row(rows->next->next, "b", 1, 100);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    cib__stats_free(stats);
+}
+
+static void
+unknown_names(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    GList *rows = NULL;
+
+    record(stats, NULL, NULL, 100, NOW);
+
+    rows = cib__stats_top(stats, true, 0, NOW);
+    assert_row(rows, "unknown", 1, 100);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    rows = cib__stats_top(stats, false, 0, NOW);
+    assert_row(rows, "unknown", 1, 100);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    cib__stats_free(stats);
+}
+
+static void
+window_expiry(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    GList *rows = NULL;
+
+    record(stats, "old", PCMK__CIB_REQUEST_QUERY, 100, NOW);
+    record(stats, "new", PCMK__CIB_REQUEST_QUERY, 100, NOW + 150);
+
+    // Still within the window
+    rows = cib__stats_top(stats, true, 0, NOW + 299);
+    assert_int_equal(g_list_length(rows), 2);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    // The first slot has left the window
+    rows = cib__stats_top(stats, true, 0, NOW + 300);
+    assert_int_equal(g_list_length(rows), 1);
+    assert_row(rows, "new", 1, 100);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    // Everything has left the window
+    assert_null(cib__stats_top(stats, true, 0, NOW + 600));
+    assert_null(cib__stats_top(stats, false, 0, NOW + 600));
+
+    cib__stats_free(stats);
+}
+
+static void
+slot_reused(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    GList *rows = NULL;
+
+    /* The first and last requests land in the same slot, so the first must be
+     * discarded when the last is recorded
+     */
+    record(stats, "client", PCMK__CIB_REQUEST_QUERY, 100, NOW);
+    record(stats, "client", PCMK__CIB_REQUEST_QUERY, 50, NOW + 150);
+    record(stats, "client", PCMK__CIB_REQUEST_QUERY, 300, NOW + 300);
+
+    rows = cib__stats_top(stats, true, 0, NOW + 300);
+    assert_row(rows, "client", 2, 350);
+    assert_null(rows->next);
+    g_list_free_full(rows, cib__stats_row_free);
+
+    cib__stats_free(stats);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(null_stats),
+                cmocka_unit_test(window_length),
+                cmocka_unit_test(empty_table),
+                cmocka_unit_test(known_mix),
+                cmocka_unit_test(limit_rows),
+                cmocka_unit_test(ties),
+                cmocka_unit_test(unknown_names),
+                cmocka_unit_test(window_expiry),
+                cmocka_unit_test(slot_reused))
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/cib/internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+#define NOW 30000
+
+static cib__stats_t *
+known_mix(void)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    cib__request_cost_t query = {
+        .requests = 1, .cpu_us = 100, .bytes_in = 50, .bytes_out = 1000,
+        .acl_us = 10,
+    };
+    cib__request_cost_t modify = {
+        .requests = 1, .cpu_us = 700, .bytes_in = 300, .bytes_out = 100,
+        .acl_us = 20, .diff_us = 200, .notify_us = 150, .notifications = 3,
+    };
+
+    cib__stats_record(stats, "crmd", PCMK__CIB_REQUEST_QUERY, &query, NOW);
+    cib__stats_record(stats, "crmd", PCMK__CIB_REQUEST_QUERY, &query, NOW);
+    cib__stats_record(stats, "attrd", PCMK__CIB_REQUEST_MODIFY, &modify, NOW);
+    return stats;
+}
+
+static void
+assert_attr(const xmlNode *xml, const char *name, const char *value)
+{
+    assert_string_equal(crm_element_value(xml, name), value);
+}
+
+static void
+null_stats(void **state)
+{
+    assert_null(cib__stats_xml(NULL, 0, NOW));
+}
+
+static void
+empty_table(void **state)
+{
+    cib__stats_t *stats = cib__stats_new(300);
+    xmlNode *xml = cib__stats_xml(stats, 0, NOW);
+
+    assert_true(pcmk__xe_is(xml, PCMK__XE_CIB_STATS));
+    assert_attr(xml, PCMK__XA_WINDOW, "300");
+    assert_attr(xml, PCMK__XA_REQUESTS, "0");
+    assert_attr(xml, PCMK__XA_CPU_US, "0");
+    assert_null(pcmk__xe_first_child(xml, NULL, NULL, NULL));
+
+    pcmk__xml_free(xml);
+    cib__stats_free(stats);
+}
+
+static void
+all_rows(void **state)
+{
+    cib__stats_t *stats = known_mix();
+    xmlNode *xml = cib__stats_xml(stats, 0, NOW);
+    xmlNode *child = NULL;
+
+    // Totals
+    assert_attr(xml, PCMK__XA_REQUESTS, "3");
+    assert_attr(xml, PCMK__XA_CPU_US, "900");
+    assert_attr(xml, PCMK__XA_BYTES_IN, "400");
+    assert_attr(xml, PCMK__XA_BYTES_OUT, "2100");
+    assert_attr(xml, PCMK__XA_ACL_US, "40");
+    assert_attr(xml, PCMK__XA_DIFF_US, "200");
+    assert_attr(xml, PCMK__XA_NOTIFY_US, "150");
+    assert_attr(xml, PCMK__XA_NOTIFICATIONS, "3");
+
+    // Clients, most expensive first
+    child = pcmk__xe_first_child(xml, PCMK__XE_CLIENT, NULL, NULL);
+    assert_attr(child, PCMK_XA_NAME, "attrd");
+    assert_attr(child, PCMK__XA_REQUESTS, "1");
+    assert_attr(child, PCMK__XA_CPU_US, "700");
+    assert_attr(child, PCMK__XA_NOTIFICATIONS, "3");
+
+    child = pcmk__xe_next(child, PCMK__XE_CLIENT);
+    assert_attr(child, PCMK_XA_NAME, "crmd");
+    assert_attr(child, PCMK__XA_REQUESTS, "2");
+    assert_attr(child, PCMK__XA_CPU_US, "200");
+    assert_attr(child, PCMK__XA_BYTES_OUT, "2000");
+    assert_null(pcmk__xe_next(child, PCMK__XE_CLIENT));
+
+    // Operation types, most expensive first
+    child = pcmk__xe_first_child(xml, PCMK_XE_OPERATION, NULL, NULL);
+    assert_attr(child, PCMK_XA_NAME, PCMK__CIB_REQUEST_MODIFY);
+    assert_attr(child, PCMK__XA_DIFF_US, "200");
+
+    child = pcmk__xe_next(child, PCMK_XE_OPERATION);
+    assert_attr(child, PCMK_XA_NAME, PCMK__CIB_REQUEST_QUERY);
+    assert_attr(child, PCMK__XA_ACL_US, "20");
+    assert_null(pcmk__xe_next(child, PCMK_XE_OPERATION));
+
+    pcmk__xml_free(xml);
+    cib__stats_free(stats);
+}
+
+static void
+limited_rows(void **state)
+{
+    cib__stats_t *stats = known_mix();
+    xmlNode *xml = cib__stats_xml(stats, 1, NOW);
+    xmlNode *child = NULL;
+
+    // Totals still cover every request
+    assert_attr(xml, PCMK__XA_REQUESTS, "3");
+    assert_attr(xml, PCMK__XA_CPU_US, "900");
+
+    child = pcmk__xe_first_child(xml, PCMK__XE_CLIENT, NULL, NULL);
+    assert_attr(child, PCMK_XA_NAME, "attrd");
+    assert_null(pcmk__xe_next(child, PCMK__XE_CLIENT));
+
+    child = pcmk__xe_first_child(xml, PCMK_XE_OPERATION, NULL, NULL);
+    assert_attr(child, PCMK_XA_NAME, PCMK__CIB_REQUEST_MODIFY);
+    assert_null(pcmk__xe_next(child, PCMK_XE_OPERATION));
+
+    pcmk__xml_free(xml);
+    cib__stats_free(stats);
+}
+
+static void
+expired_rows(void **state)
+{
+    cib__stats_t *stats = known_mix();
+    xmlNode *xml = cib__stats_xml(stats, 0, NOW + 300);
+
+    assert_attr(xml, PCMK__XA_REQUESTS, "0");
+    assert_null(pcmk__xe_first_child(xml, NULL, NULL, NULL));
+
+    pcmk__xml_free(xml);
+    cib__stats_free(stats);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_stats),
+                cmocka_unit_test(empty_table),
+                cmocka_unit_test(all_rows),
+                cmocka_unit_test(limited_rows),
+                cmocka_unit_test(expired_rows))
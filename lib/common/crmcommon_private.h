@@ -20,6 +20,7 @@
 
 #include <glib.h>           // G_GNUC_INTERNAL, G_GNUC_PRINTF, gchar, etc.
 #include <libxml/tree.h>    // xmlNode, xmlAttr
+#include <libxml/xpath.h>   // xmlXPathObjectPtr
 #include <qb/qbipcc.h>      // struct qb_ipc_response_header
 
 #include <crm/common/ipc.h>             // pcmk_ipc_api_t, crm_ipc_t, etc.
@@ -63,6 +64,9 @@ typedef struct xml_doc_private_s {
         char *user;
         GList *acls;
         GList *deleted_objs; // List of pcmk__deleted_xml_t
+        bool index_ids;       // Whether to index elements by ID
+        GHashTable *id_index; // ID (lowercased) -> GPtrArray of xmlNode *
+                              // (built on first lookup if index_ids is set)
 } xml_doc_private_t;
 
 // XML private data magic numbers
@@ -102,6 +106,19 @@ void pcmk__xml_free_private_data(xmlNode *xml);
 G_GNUC_INTERNAL
 void pcmk__xml_free_node(xmlNode *xml);
 
+G_GNUC_INTERNAL
+void pcmk__xml_index_add(xmlNode *xml);
+
+G_GNUC_INTERNAL
+void pcmk__xml_index_remove(xmlNode *xml);
+
+G_GNUC_INTERNAL
+int pcmk__xml_index_find(xmlNode *xml, const char *name, const char *id,
+                         bool casei, bool include_root, GList **matches);
+
+G_GNUC_INTERNAL
+xmlXPathObjectPtr pcmk__xml_index_xpath(xmlDoc *doc, const char *path);
+
 G_GNUC_INTERNAL
 xmlDoc *pcmk__xml_new_doc(void);
 
@@ -169,6 +186,18 @@ bool pcmk__xml_is_name_start_char(const char *utf8, int *len);
 G_GNUC_INTERNAL
 bool pcmk__xml_is_name_char(const char *utf8, int *len);
 
+G_GNUC_INTERNAL
+xmlNode *pcmk__xml_archive_read_file(const char *filename);
+
+/*
+ * Logging
+ */
+
+struct qb_log_callsite;
+
+G_GNUC_INTERNAL
+bool pcmk__log_filter_matches(const struct qb_log_callsite *cs);
+
 /*
  * Date/times
  */
@@ -202,6 +231,20 @@ void pcmk__set_time_if_earlier(crm_time_t *target, const crm_time_t *source);
 
 #define PCMK__IPC_VERSION 1
 
+/* Parts of multipart messages use a higher header version, so that older peers
+ * that can't reassemble them reject them rather than parse a fragment
+ */
+#define PCMK__IPC_MULTIPART_VERSION 2
+
+// IPC header flags used only by libcrmcommon (see also enum crm_ipc_flags)
+enum pcmk__ipc_part_flags {
+    //! Message is too big for one IPC buffer and is sent in parts
+    pcmk__ipc_multipart     = (UINT32_C(1) << 4),
+
+    //! Message is the final part of a multipart message
+    pcmk__ipc_multipart_end = (UINT32_C(1) << 5),
+};
+
 #define PCMK__CONTROLD_API_MAJOR "1"
 #define PCMK__CONTROLD_API_MINOR "0"
 
@@ -308,6 +351,10 @@ unsigned int pcmk__ipc_buffer_size(unsigned int max);
 G_GNUC_INTERNAL
 bool pcmk__valid_ipc_header(const pcmk__ipc_header_t *header);
 
+G_GNUC_INTERNAL
+int pcmk__ipc_add_part(GByteArray *parts, const pcmk__ipc_header_t *header,
+                       const char *data);
+
 G_GNUC_INTERNAL
 pcmk__ipc_methods_t *pcmk__attrd_api_methods(void);
 
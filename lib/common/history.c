@@ -0,0 +1,550 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdbool.h>                // bool, true, false
+#include <stdio.h>                  // NULL
+#include <string.h>                 // strchr(), strlen()
+
+#include <glib.h>                   // GHashTable, g_strsplit(), etc.
+#include <libxml/tree.h>            // xmlNode
+
+#include <crm/common/xml.h>
+#include <crm/common/history_internal.h>
+
+/* A compact action history entry is a PCMK__XE_LRM_RSC_OP element that:
+ *
+ * - omits PCMK_XA_OPERATION and PCMK_META_INTERVAL, which can be parsed from
+ *   PCMK__XA_OPERATION_KEY;
+ * - omits PCMK__XA_TRANSITION_MAGIC, which is built from PCMK__XA_OP_STATUS,
+ *   PCMK__XA_RC_CODE, and PCMK__XA_TRANSITION_KEY;
+ * - omits PCMK__META_ON_NODE if it is the name of the node whose history it is
+ *   in;
+ * - combines its timing and resource usage into PCMK__XA_OP_PACKED; and
+ * - replaces any digests it shares with other entries by the IDs of
+ *   PCMK__XE_LRM_DIGEST entries in its node's PCMK__XE_LRM_DIGESTS table.
+ *
+ * PCMK__XA_OP_PACKED holds colon-separated fields: the encoding version, the
+ * entry's call ID, and the value of each attribute in packed_attrs in order
+ * (empty if the attribute is absent, with trailing empty fields dropped).
+ *
+ * The CIB merges attributes when history is updated, so an entry written in
+ * full format over a compact one keeps the stale PCMK__XA_OP_PACKED. The call
+ * ID in it no longer matches the entry's, which tells readers to ignore it.
+ */
+
+// Attributes combined into PCMK__XA_OP_PACKED, in field order
+static const char *packed_attrs[] = {
+    PCMK_XA_LAST_RC_CHANGE,
+    PCMK_XA_EXEC_TIME,
+    PCMK_XA_QUEUE_TIME,
+    PCMK_XA_CPU_USER_TIME,
+    PCMK_XA_CPU_SYSTEM_TIME,
+    PCMK_XA_MAX_RSS,
+    PCMK_XA_BLOCKS_IN,
+    PCMK_XA_BLOCKS_OUT,
+};
+
+// Attributes whose values are stored in the digest table
+static const char *digest_attrs[] = {
+    PCMK__XA_OP_DIGEST,
+    PCMK__XA_OP_RESTART_DIGEST,
+    PCMK__XA_OP_SECURE_DIGEST,
+};
+
+/* A digest table ID is the first 16 hexadecimal digits (64 bits) of the digest
+ * it stands for, which makes collisions within one node's history practically
+ * impossible, while letting each writer choose IDs without reading the table.
+ *
+ * A table entry costs more than the digest itself, so only digests used by
+ * more than one entry are worth moving to the table. Each update that refers
+ * to a table entry carries a copy of it, so references stay valid even if the
+ * table in the CIB is erased in the meantime.
+ */
+#define DIGEST_ID_LEN 16
+
+/*!
+ * \internal
+ * \brief Get the transition magic that an action history entry implies
+ *
+ * \param[in] xml_op  Action history entry
+ *
+ * \return Newly allocated transition magic (or NULL if \p xml_op lacks any of
+ *         the values it is built from)
+ * \note The caller is responsible for freeing the result with \p free().
+ */
+static char *
+implied_magic(const xmlNode *xml_op)
+{
+    const char *status = crm_element_value(xml_op, PCMK__XA_OP_STATUS);
+    const char *rc = crm_element_value(xml_op, PCMK__XA_RC_CODE);
+    const char *key = crm_element_value(xml_op, PCMK__XA_TRANSITION_KEY);
+
+    if ((status == NULL) || (rc == NULL) || (key == NULL)) {
+        return NULL;
+    }
+    return crm_strdup_printf("%s:%s;%s", status, rc, key);
+}
+
+/*!
+ * \internal
+ * \brief Check whether an entry's action name and interval match its key
+ *
+ * \param[in] xml_op  Action history entry
+ *
+ * \return true if \p xml_op's action name and interval can be recreated from
+ *         its operation key exactly as written, otherwise false
+ */
+static bool
+operation_matches_key(const xmlNode *xml_op)
+{
+    const char *task = crm_element_value(xml_op, PCMK_XA_OPERATION);
+    const char *interval = crm_element_value(xml_op, PCMK_META_INTERVAL);
+    char *key_task = NULL;
+    char *key_interval = NULL;
+    guint interval_ms = 0;
+    bool matches = false;
+
+    if ((task == NULL) || (interval == NULL)
+        || !parse_op_key(crm_element_value(xml_op, PCMK__XA_OPERATION_KEY),
+                         NULL, &key_task, &interval_ms)) {
+        return false;
+    }
+
+    key_interval = crm_strdup_printf("%u", interval_ms);
+    matches = pcmk__str_eq(task, key_task, pcmk__str_none)
+              && pcmk__str_eq(interval, key_interval, pcmk__str_none);
+    free(key_task);
+    free(key_interval);
+    return matches;
+}
+
+/*!
+ * \internal
+ * \brief Add a node's digest table entries to a hash table
+ *
+ * \param[in]     table    Node's PCMK__XE_LRM_DIGESTS element
+ * \param[in,out] digests  Table to add entries to (mapping IDs to digests)
+ */
+static void
+load_digests(const xmlNode *table, GHashTable *digests)
+{
+    for (const xmlNode *entry = pcmk__xe_first_child(table,
+                                                     PCMK__XE_LRM_DIGEST,
+                                                     NULL, NULL);
+         entry != NULL; entry = pcmk__xe_next(entry, PCMK__XE_LRM_DIGEST)) {
+
+        const char *id = pcmk__xe_id(entry);
+        const char *digest = crm_element_value(entry, PCMK__XA_DIGEST);
+
+        if ((id != NULL) && (digest != NULL)) {
+            g_hash_table_insert(digests, pcmk__str_copy(id), (gpointer) digest);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Replace an entry's digest with a reference to the digest table
+ *
+ * \param[in,out] xml_op   Action history entry
+ * \param[in]     attr     Name of digest attribute to intern
+ * \param[in,out] lrm      Node's PCMK__XE_LRM element (for the digest table)
+ * \param[in,out] digests  Digest table contents (mapping IDs to digests)
+ * \param[in]     uses     Number of times each digest has been seen
+ */
+static void
+intern_digest(xmlNode *xml_op, const char *attr, xmlNode *lrm,
+              GHashTable *digests, GHashTable *uses)
+{
+    const char *digest = crm_element_value(xml_op, attr);
+    const char *existing = NULL;
+    char *id = NULL;
+
+    if ((digest == NULL) || (strlen(digest) <= DIGEST_ID_LEN)) {
+        return; // Nothing to save
+    }
+
+    id = pcmk__str_copy(digest);
+    id[DIGEST_ID_LEN] = '\0';
+
+    existing = g_hash_table_lookup(digests, id);
+    if (existing == NULL) {
+        xmlNode *table = NULL;
+        xmlNode *entry = NULL;
+
+        if (GPOINTER_TO_UINT(g_hash_table_lookup(uses, digest)) < 2) {
+            free(id);
+            return; // Not shared, so keep it in the entry
+        }
+
+        table = pcmk__xe_first_child(lrm, PCMK__XE_LRM_DIGESTS, NULL, NULL);
+        if (table == NULL) {
+            table = pcmk__xe_create(lrm, PCMK__XE_LRM_DIGESTS);
+        }
+        entry = pcmk__xe_create(table, PCMK__XE_LRM_DIGEST);
+        crm_xml_add(entry, PCMK_XA_ID, id);
+        crm_xml_add(entry, PCMK__XA_DIGEST, digest);
+
+        crm_xml_add(xml_op, attr, id);
+        g_hash_table_insert(digests, id,
+                            (gpointer) crm_element_value(entry,
+                                                         PCMK__XA_DIGEST));
+
+    } else if (pcmk__str_eq(existing, digest, pcmk__str_none)) {
+        crm_xml_add(xml_op, attr, id);
+        free(id);
+
+    } else {
+        crm_warn("Keeping %s digest %s of %s in full because its ID "
+                 "collides with digest %s", attr, digest, pcmk__xe_id(xml_op),
+                 existing);
+        free(id);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether an entry's packed values belong to its current result
+ *
+ * \param[in] xml_op  Action history entry
+ * \param[in] fields  \p xml_op's PCMK__XA_OP_PACKED value split into fields
+ *
+ * \return true if \p fields were written with \p xml_op's current call ID,
+ *         otherwise false
+ */
+static bool
+packed_is_current(const xmlNode *xml_op, gchar **fields)
+{
+    return (g_strv_length(fields) >= 2)
+           && pcmk__str_eq(fields[1],
+                           crm_element_value(xml_op, PCMK__XA_CALL_ID),
+                           pcmk__str_none);
+}
+
+/*!
+ * \internal
+ * \brief Count the digests used by a node's action history entries
+ *
+ * \param[in]     resources  Node's PCMK__XE_LRM_RESOURCES element
+ * \param[in,out] uses       Table to add counts to (mapping digests to counts)
+ */
+static void
+count_digest_uses(const xmlNode *resources, GHashTable *uses)
+{
+    for (const xmlNode *rsc = pcmk__xe_first_child(resources,
+                                                   PCMK__XE_LRM_RESOURCE,
+                                                   NULL, NULL);
+         rsc != NULL; rsc = pcmk__xe_next(rsc, PCMK__XE_LRM_RESOURCE)) {
+
+        for (const xmlNode *xml_op = pcmk__xe_first_child(rsc,
+                                                          PCMK__XE_LRM_RSC_OP,
+                                                          NULL, NULL);
+             xml_op != NULL;
+             xml_op = pcmk__xe_next(xml_op, PCMK__XE_LRM_RSC_OP)) {
+
+            for (int i = 0; i < PCMK__NELEM(digest_attrs); i++) {
+                const char *digest = crm_element_value(xml_op,
+                                                       digest_attrs[i]);
+                guint count = 0;
+
+                if (digest == NULL) {
+                    continue;
+                }
+                count = GPOINTER_TO_UINT(g_hash_table_lookup(uses, digest));
+                g_hash_table_replace(uses, pcmk__str_copy(digest),
+                                     GUINT_TO_POINTER(count + 1));
+            }
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Convert an action history entry to compact format, if possible
+ *
+ * \param[in,out] xml_op     Action history entry
+ * \param[in,out] lrm        Node's PCMK__XE_LRM element (for the digest table)
+ * \param[in,out] digests    Digest table contents (mapping IDs to digests)
+ * \param[in]     uses       Number of times each digest has been seen
+ * \param[in]     node_name  Name of node whose history \p xml_op is in
+ *
+ * \note An entry whose omitted values could not be recreated exactly is left
+ *       in full format.
+ */
+static void
+compact_entry(xmlNode *xml_op, xmlNode *lrm, GHashTable *digests,
+              GHashTable *uses, const char *node_name)
+{
+    const char *call_id = crm_element_value(xml_op, PCMK__XA_CALL_ID);
+    const char *packed = crm_element_value(xml_op, PCMK__XA_OP_PACKED);
+    char *magic = NULL;
+    GString *buf = NULL;
+    size_t len = 0;
+    bool compactable = false;
+
+    if ((call_id == NULL) || (strchr(call_id, ':') != NULL)) {
+        return;
+    }
+
+    if (packed != NULL) {
+        gchar **fields = g_strsplit(packed, ":", 0);
+        bool current = packed_is_current(xml_op, fields);
+
+        g_strfreev(fields);
+        if (current) {
+            return; // Already compact
+        }
+    }
+
+    magic = implied_magic(xml_op);
+    compactable = pcmk__str_eq(magic,
+                               crm_element_value(xml_op,
+                                                 PCMK__XA_TRANSITION_MAGIC),
+                               pcmk__str_none)
+                  && operation_matches_key(xml_op);
+    free(magic);
+
+    for (int i = 0; compactable && (i < PCMK__NELEM(packed_attrs)); i++) {
+        const char *value = crm_element_value(xml_op, packed_attrs[i]);
+
+        compactable = (value == NULL) || (strchr(value, ':') == NULL);
+    }
+    if (!compactable) {
+        return;
+    }
+
+    buf = g_string_sized_new(64);
+    g_string_append_printf(buf, "%d:%s", PCMK__HISTORY_PACKED_VERSION,
+                           call_id);
+    len = buf->len;
+    for (int i = 0; i < PCMK__NELEM(packed_attrs); i++) {
+        const char *value = crm_element_value(xml_op, packed_attrs[i]);
+
+        g_string_append_c(buf, ':');
+        if (value != NULL) {
+            g_string_append(buf, value);
+            len = buf->len;
+            pcmk__xe_remove_attr(xml_op, packed_attrs[i]);
+        }
+    }
+    g_string_truncate(buf, len);
+    crm_xml_add(xml_op, PCMK__XA_OP_PACKED, buf->str);
+    g_string_free(buf, TRUE);
+
+    pcmk__xe_remove_attr(xml_op, PCMK_XA_OPERATION);
+    pcmk__xe_remove_attr(xml_op, PCMK_META_INTERVAL);
+    pcmk__xe_remove_attr(xml_op, PCMK__XA_TRANSITION_MAGIC);
+
+    if ((node_name != NULL)
+        && pcmk__str_eq(crm_element_value(xml_op, PCMK__META_ON_NODE),
+                        node_name, pcmk__str_none)) {
+        pcmk__xe_remove_attr(xml_op, PCMK__META_ON_NODE);
+    }
+
+    for (int i = 0; i < PCMK__NELEM(digest_attrs); i++) {
+        intern_digest(xml_op, digest_attrs[i], lrm, digests, uses);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Convert a node's action history to compact format
+ *
+ * Convert each PCMK__XE_LRM_RSC_OP entry in a node's history that can be
+ * recreated exactly from its compact form. Digests already in the node's
+ * digest table, or seen more than once, are moved to the table. Entries that
+ * are already compact are left alone.
+ *
+ * \param[in,out] lrm        Node's PCMK__XE_LRM element
+ * \param[in]     node_name  Name of node whose history \p lrm is
+ * \param[in,out] uses       Number of times each digest has been seen, mapping
+ *                           digests to counts (or NULL to count only the
+ *                           digests in \p lrm). The digests in \p lrm are
+ *                           added to this, so that a writer that compacts one
+ *                           update at a time can keep it between updates.
+ */
+void
+pcmk__compact_history(xmlNode *lrm, const char *node_name, GHashTable *uses)
+{
+    GHashTable *digests = NULL;
+    GHashTable *local_uses = NULL;
+    xmlNode *resources = NULL;
+
+    pcmk__assert(lrm != NULL);
+
+    if (uses == NULL) {
+        local_uses = pcmk__strkey_table(free, NULL);
+        uses = local_uses;
+    }
+
+    digests = pcmk__strkey_table(free, NULL);
+    load_digests(pcmk__xe_first_child(lrm, PCMK__XE_LRM_DIGESTS, NULL, NULL),
+                 digests);
+
+    resources = pcmk__xe_first_child(lrm, PCMK__XE_LRM_RESOURCES, NULL, NULL);
+    count_digest_uses(resources, uses);
+
+    for (xmlNode *rsc = pcmk__xe_first_child(resources, PCMK__XE_LRM_RESOURCE,
+                                             NULL, NULL);
+         rsc != NULL; rsc = pcmk__xe_next(rsc, PCMK__XE_LRM_RESOURCE)) {
+
+        for (xmlNode *xml_op = pcmk__xe_first_child(rsc, PCMK__XE_LRM_RSC_OP,
+                                                    NULL, NULL);
+             xml_op != NULL;
+             xml_op = pcmk__xe_next(xml_op, PCMK__XE_LRM_RSC_OP)) {
+
+            compact_entry(xml_op, lrm, digests, uses, node_name);
+        }
+    }
+
+    g_hash_table_destroy(digests);
+    if (local_uses != NULL) {
+        g_hash_table_destroy(local_uses);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Convert an action history entry to full format
+ *
+ * \param[in,out] xml_op     Action history entry (in either format)
+ * \param[in]     digests    Node's digest table contents, mapping IDs to
+ *                           digests (or NULL to leave digest references as-is)
+ * \param[in]     node_name  Name of node whose history \p xml_op is in (or
+ *                           NULL if unknown)
+ */
+void
+pcmk__expand_history_entry(xmlNode *xml_op, GHashTable *digests,
+                           const char *node_name)
+{
+    const char *packed = NULL;
+    const char *key = NULL;
+    char *task = NULL;
+    char *magic = NULL;
+    guint interval_ms = 0;
+    gchar **fields = NULL;
+    long long version = 0LL;
+    int n_fields = 0;
+
+    pcmk__assert(xml_op != NULL);
+
+    packed = crm_element_value(xml_op, PCMK__XA_OP_PACKED);
+    if (packed == NULL) {
+        return; // Already full
+    }
+
+    fields = g_strsplit(packed, ":", 0);
+    n_fields = g_strv_length(fields);
+
+    if ((pcmk__scan_ll(fields[0], &version, 0LL) != pcmk_rc_ok)
+        || (version != PCMK__HISTORY_PACKED_VERSION)) {
+        crm_warn("Cannot read action history entry %s: Unsupported compact "
+                 "format %s", pcmk__xe_id(xml_op), pcmk__s(fields[0], ""));
+        goto done;
+    }
+
+    if (!packed_is_current(xml_op, fields)) {
+        // Left behind when the entry was last written in full format
+        pcmk__xe_remove_attr(xml_op, PCMK__XA_OP_PACKED);
+        goto done;
+    }
+
+    for (int i = 0; (i < PCMK__NELEM(packed_attrs)) && (i + 2 < n_fields);
+         i++) {
+        if (!pcmk__str_empty(fields[i + 2])) {
+            crm_xml_add(xml_op, packed_attrs[i], fields[i + 2]);
+        }
+    }
+
+    key = crm_element_value(xml_op, PCMK__XA_OPERATION_KEY);
+    if (parse_op_key(key, NULL, &task, &interval_ms)) {
+        crm_xml_add(xml_op, PCMK_XA_OPERATION, task);
+        crm_xml_add_ms(xml_op, PCMK_META_INTERVAL, interval_ms);
+        free(task);
+    } else {
+        crm_warn("Cannot determine action for history entry %s from "
+                 "invalid key '%s'", pcmk__xe_id(xml_op), pcmk__s(key, ""));
+    }
+
+    magic = implied_magic(xml_op);
+    crm_xml_add(xml_op, PCMK__XA_TRANSITION_MAGIC, magic);
+    free(magic);
+
+    if ((node_name != NULL)
+        && (crm_element_value(xml_op, PCMK__META_ON_NODE) == NULL)) {
+        crm_xml_add(xml_op, PCMK__META_ON_NODE, node_name);
+    }
+
+    for (int i = 0; (digests != NULL) && (i < PCMK__NELEM(digest_attrs));
+         i++) {
+        const char *id = crm_element_value(xml_op, digest_attrs[i]);
+        const char *digest = NULL;
+
+        if (id != NULL) {
+            digest = g_hash_table_lookup(digests, id);
+        }
+        if (digest != NULL) {
+            crm_xml_add(xml_op, digest_attrs[i], digest);
+        }
+    }
+
+    pcmk__xe_remove_attr(xml_op, PCMK__XA_OP_PACKED);
+
+done:
+    g_strfreev(fields);
+}
+
+/*!
+ * \internal
+ * \brief Convert a node's action history to full format
+ *
+ * Convert each compact PCMK__XE_LRM_RSC_OP entry in a node's history to the
+ * equivalent full entry, then drop the node's digest table, so that code
+ * reading the history needs to handle only the full format.
+ *
+ * \param[in,out] lrm        Node's PCMK__XE_LRM element
+ * \param[in]     node_name  Name of node whose history \p lrm is (or NULL if
+ *                           unknown)
+ */
+void
+pcmk__expand_history(xmlNode *lrm, const char *node_name)
+{
+    GHashTable *digests = NULL;
+    xmlNode *table = NULL;
+    xmlNode *resources = NULL;
+
+    pcmk__assert(lrm != NULL);
+
+    table = pcmk__xe_first_child(lrm, PCMK__XE_LRM_DIGESTS, NULL, NULL);
+    if (table != NULL) {
+        digests = pcmk__strkey_table(free, NULL);
+        load_digests(table, digests);
+    }
+
+    resources = pcmk__xe_first_child(lrm, PCMK__XE_LRM_RESOURCES, NULL, NULL);
+    for (xmlNode *rsc = pcmk__xe_first_child(resources, PCMK__XE_LRM_RESOURCE,
+                                             NULL, NULL);
+         rsc != NULL; rsc = pcmk__xe_next(rsc, PCMK__XE_LRM_RESOURCE)) {
+
+        for (xmlNode *xml_op = pcmk__xe_first_child(rsc, PCMK__XE_LRM_RSC_OP,
+                                                    NULL, NULL);
+             xml_op != NULL;
+             xml_op = pcmk__xe_next(xml_op, PCMK__XE_LRM_RSC_OP)) {
+
+            pcmk__expand_history_entry(xml_op, digests, node_name);
+        }
+    }
+
+    if (table != NULL) {
+        g_hash_table_destroy(digests);
+        pcmk__xml_free(table);
+    }
+}
@@ -825,6 +825,8 @@ struct crm_ipc_s {
     char *buffer;
     char *server_name;          // server IPC name being connected to
     qb_ipcc_connection_t *ipc;
+    GByteArray *event_parts;    // multipart event received so far
+    GByteArray *reply_parts;    // multipart reply received so far
 };
 
 /*!
@@ -982,6 +984,12 @@ crm_ipc_destroy(crm_ipc_t * client)
             crm_trace("Destroying inactive %s IPC connection",
                       client->server_name);
         }
+        if (client->event_parts != NULL) {
+            g_byte_array_free(client->event_parts, TRUE);
+        }
+        if (client->reply_parts != NULL) {
+            g_byte_array_free(client->reply_parts, TRUE);
+        }
         free(client->buffer);
         free(client->server_name);
         free(client);
@@ -1114,20 +1122,145 @@ crm_ipc_decompress(crm_ipc_t * client)
     return pcmk_rc_ok;
 }
 
+/*!
+ * \internal
+ * \brief Shrink a generic IPC object's buffer back to the IPC buffer size
+ *
+ * The buffer grows as needed to hold decompressed or reassembled messages.
+ * Once such a message has been consumed, release the extra memory rather than
+ * keeping the largest size ever seen for the life of the connection.
+ *
+ * \param[in,out] client  IPC object whose buffer is about to be read into
+ */
+static void
+shrink_buffer(crm_ipc_t *client)
+{
+    if (client->buf_size > client->max_buf_size) {
+        crm_trace("Shrinking %s IPC buffer from %u to %u bytes",
+                  client->server_name, client->buf_size,
+                  client->max_buf_size);
+        client->buffer = pcmk__realloc(client->buffer, client->max_buf_size);
+        client->buf_size = client->max_buf_size;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Process a message just read into a generic IPC object's buffer
+ *
+ * Decompress the message if needed. If it is one part of a multipart message,
+ * add it to the parts received so far instead, and once the last part arrives,
+ * replace the buffer contents with the complete message.
+ *
+ * \param[in,out] client  IPC object that message was read into
+ * \param[in,out] parts   Parts of multipart message received so far
+ * \param[in,out] bytes   Size of message read (updated to size of complete
+ *                        message if reassembled)
+ *
+ * \return Standard Pacemaker return code (specifically, \c EAGAIN if more
+ *         parts are needed to complete a multipart message)
+ */
+static int
+process_buffer(crm_ipc_t *client, GByteArray **parts, ssize_t *bytes)
+{
+    pcmk__ipc_header_t *header = (pcmk__ipc_header_t *)(void*)client->buffer;
+    unsigned int new_buf_size = 0;
+    char *complete = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (!pcmk_is_set(header->flags, pcmk__ipc_multipart)) {
+        return crm_ipc_decompress(client);
+    }
+
+    if (!pcmk__valid_ipc_header(header)) {
+        return EBADMSG;
+    }
+    if (*parts == NULL) {
+        *parts = g_byte_array_sized_new(header->size_uncompressed);
+    }
+
+    rc = pcmk__ipc_add_part(*parts, header,
+                            client->buffer + sizeof(pcmk__ipc_header_t));
+    if (rc == EAGAIN) {
+        return rc;
+    }
+    if (rc == pcmk_rc_ok) {
+        new_buf_size = QB_MAX(sizeof(pcmk__ipc_header_t) + (*parts)->len,
+                              client->max_buf_size);
+        complete = pcmk__assert_alloc(1, new_buf_size);
+
+        memcpy(complete, client->buffer, sizeof(pcmk__ipc_header_t));
+        memcpy(complete + sizeof(pcmk__ipc_header_t), (*parts)->data,
+               (*parts)->len);
+
+        header = (pcmk__ipc_header_t *)(void*)complete;
+        header->qb.size = sizeof(pcmk__ipc_header_t) + (*parts)->len;
+        pcmk__clear_ipc_flags(header->flags, client->server_name,
+                              pcmk__ipc_multipart|pcmk__ipc_multipart_end);
+
+        free(client->buffer);
+        client->buf_size = new_buf_size;
+        client->buffer = complete;
+        *bytes = header->qb.size;
+    }
+    g_byte_array_free(*parts, TRUE);
+    *parts = NULL;
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Read any remaining parts of a reply already in an IPC object's buffer
+ *
+ * \param[in,out] client      IPC object that reply was read into
+ * \param[in,out] bytes       Size of reply (updated to size of complete reply)
+ * \param[in]     ms_timeout  Give up on each part after this much time
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+finish_reply(crm_ipc_t *client, ssize_t *bytes, int ms_timeout)
+{
+    int rc = process_buffer(client, &(client->reply_parts), bytes);
+
+    while (rc == EAGAIN) {
+        *bytes = qb_ipcc_recv(client->ipc, client->buffer, client->buf_size,
+                              ms_timeout);
+        if (*bytes < 0) {
+            return (int) -*bytes;
+        }
+        rc = process_buffer(client, &(client->reply_parts), bytes);
+    }
+    return rc;
+}
+
 long
 crm_ipc_read(crm_ipc_t * client)
 {
     pcmk__ipc_header_t *header = NULL;
+    int rc = pcmk_rc_ok;
 
     pcmk__assert((client != NULL) && (client->ipc != NULL)
                  && (client->buffer != NULL));
 
-    client->buffer[0] = 0;
-    client->msg_size = qb_ipcc_event_recv(client->ipc, client->buffer,
-                                          client->buf_size, 0);
-    if (client->msg_size >= 0) {
-        int rc = crm_ipc_decompress(client);
+    shrink_buffer(client);
+    do {
+        ssize_t bytes = 0;
 
+        client->buffer[0] = 0;
+        client->msg_size = qb_ipcc_event_recv(client->ipc, client->buffer,
+                                              client->buf_size, 0);
+        if (client->msg_size < 0) {
+            break;
+        }
+
+        // Keep reading as long as parts of a multipart event are available
+        bytes = client->msg_size;
+        rc = process_buffer(client, &(client->event_parts), &bytes);
+        client->msg_size = (int) bytes;
+    } while (rc == EAGAIN);
+
+    if (client->msg_size >= 0) {
         if (rc != pcmk_rc_ok) {
             return pcmk_rc2legacy(rc);
         }
@@ -1201,14 +1334,18 @@ internal_ipc_get_reply(crm_ipc_t *client, int request_id, int ms_timeout,
     /* get the reply */
     crm_trace("Waiting on reply to %s IPC message %d",
               client->server_name, request_id);
+    shrink_buffer(client);
     do {
 
         *bytes = qb_ipcc_recv(client->ipc, client->buffer, client->buf_size, 1000);
         if (*bytes > 0) {
             pcmk__ipc_header_t *hdr = NULL;
 
-            rc = crm_ipc_decompress(client);
-            if (rc != pcmk_rc_ok) {
+            rc = process_buffer(client, &(client->reply_parts), bytes);
+            if (rc == EAGAIN) {
+                // Wait for the remaining parts of a multipart reply
+                continue;
+            } else if (rc != pcmk_rc_ok) {
                 return rc;
             }
 
@@ -1237,6 +1374,10 @@ internal_ipc_get_reply(crm_ipc_t *client, int request_id, int ms_timeout,
 
     } while (time(NULL) < timeout);
 
+    if (rc == EAGAIN) {
+        // Any remaining parts will be read with the next reply
+        *bytes = -ETIMEDOUT;
+    }
     if (*bytes < 0) {
         rc = (int) -*bytes; // System errno
     }
@@ -1285,7 +1426,12 @@ crm_ipc_send(crm_ipc_t *client, const xmlNode *message,
     }
 
     if (client->need_reply) {
+        shrink_buffer(client);
         qb_rc = qb_ipcc_recv(client->ipc, client->buffer, client->buf_size, ms_timeout);
+        if ((qb_rc > 0)
+            && (finish_reply(client, &qb_rc, ms_timeout) != pcmk_rc_ok)) {
+            qb_rc = -EAGAIN;
+        }
         if (qb_rc < 0) {
             crm_warn("Sending %s IPC disabled until pending reply received",
                      client->server_name);
@@ -1308,6 +1454,17 @@ crm_ipc_send(crm_ipc_t *client, const xmlNode *message,
     }
 
     header = iov[0].iov_base;
+    if (pcmk_is_set(header->flags, pcmk__ipc_multipart)) {
+        // Only servers split messages into parts
+        crm_err("Could not compress %u-byte %s IPC request into less than IPC "
+                "limit of %u bytes; set PCMK_ipc_buffer to higher value "
+                "(%u bytes suggested)", header->size_uncompressed,
+                client->server_name, client->max_buf_size,
+                2 * header->size_uncompressed);
+        crm_log_xml_trace(message, "EMSGSIZE");
+        pcmk_free_ipc_event(iov);
+        return -EMSGSIZE;
+    }
     pcmk__set_ipc_flags(header->flags, client->server_name, flags);
 
     if (pcmk_is_set(flags, crm_ipc_proxied)) {
@@ -1367,10 +1524,19 @@ crm_ipc_send(crm_ipc_t *client, const xmlNode *message,
 
     } else {
         // No timeout, and client response needed
+        shrink_buffer(client);
         do {
             qb_rc = qb_ipcc_sendv_recv(client->ipc, iov, 2, client->buffer,
                                        client->buf_size, -1);
         } while ((qb_rc == -EAGAIN) && crm_ipc_connected(client));
+
+        if (qb_rc > 0) {
+            int part_rc = finish_reply(client, &qb_rc, -1);
+
+            if (part_rc != pcmk_rc_ok) {
+                qb_rc = -part_rc;
+            }
+        }
         rc = (int) qb_rc; // Negative system errno, or size of reply received
     }
 
@@ -110,14 +110,71 @@ pcmk__valid_ipc_header(const pcmk__ipc_header_t *header)
         crm_err("IPC message without header");
         return false;
 
-    } else if (header->version > PCMK__IPC_VERSION) {
+    } else if (header->version > PCMK__IPC_MULTIPART_VERSION) {
         crm_err("Filtering incompatible v%d IPC message (only versions <= %d supported)",
-                header->version, PCMK__IPC_VERSION);
+                header->version, PCMK__IPC_MULTIPART_VERSION);
         return false;
     }
     return true;
 }
 
+/*!
+ * \internal
+ * \brief Add one part of a multipart IPC message to the parts received so far
+ *
+ * \param[in,out] parts   Payload received so far (cleared on error)
+ * \param[in]     header  Header of newly received part
+ * \param[in]     data    Payload of newly received part
+ *
+ * \return Standard Pacemaker return code (specifically, \c pcmk_rc_ok if
+ *         \p parts now holds the complete message, or \c EAGAIN if more
+ *         parts are needed to complete it)
+ */
+int
+pcmk__ipc_add_part(GByteArray *parts, const pcmk__ipc_header_t *header,
+                   const char *data)
+{
+    uint32_t len = 0;
+
+    CRM_CHECK((parts != NULL) && (header != NULL) && (data != NULL)
+              && (header->qb.size >= sizeof(pcmk__ipc_header_t)),
+              return EINVAL);
+
+    len = header->qb.size - sizeof(pcmk__ipc_header_t);
+
+    if (!pcmk_is_set(header->flags, pcmk__ipc_multipart)
+        || (header->size_compressed != 0)
+        || ((parts->len + len) > header->size_uncompressed)) {
+
+        crm_err("Discarding multipart IPC message after invalid %u-byte part "
+                "(%u of %u bytes received)",
+                len, parts->len, header->size_uncompressed);
+        g_byte_array_set_size(parts, 0);
+        return EBADMSG;
+    }
+
+    g_byte_array_append(parts, (const guint8 *) data, len);
+    if (!pcmk_is_set(header->flags, pcmk__ipc_multipart_end)) {
+        crm_trace("Received %u-byte part of IPC message %d (%u of %u bytes)",
+                  len, header->qb.id, parts->len, header->size_uncompressed);
+        return EAGAIN;
+    }
+
+    if ((parts->len == 0) || (parts->len != header->size_uncompressed)
+        || (parts->data[parts->len - 1] != '\0')) {
+
+        crm_err("Discarding incomplete multipart IPC message "
+                "(%u of %u bytes received)",
+                parts->len, header->size_uncompressed);
+        g_byte_array_set_size(parts, 0);
+        return EBADMSG;
+    }
+
+    crm_trace("Reassembled %u-byte IPC message %d",
+              parts->len, header->qb.id);
+    return pcmk_rc_ok;
+}
+
 const char *
 pcmk__client_type_str(uint64_t client_type)
 {
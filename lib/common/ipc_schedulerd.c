@@ -83,6 +83,7 @@ dispatch(pcmk_ipc_api_t *api, xmlNode *reply)
         pcmk_schedulerd_reply_unknown
     };
     const char *value = NULL;
+    int rc = CRM_EX_OK;
 
     if (pcmk__xe_is(reply, PCMK__XE_ACK)) {
         return false;
@@ -118,7 +119,25 @@ dispatch(pcmk_ipc_api_t *api, xmlNode *reply)
 
     value = crm_element_value(reply, PCMK__XA_CRM_TASK);
 
-    if (pcmk__str_eq(value, CRM_OP_PECALC, pcmk__str_none)) {
+    // A calculation that failed has an exit status instead of a graph
+    if ((crm_element_value_int(reply, PCMK__XA_RC_CODE, &rc) == 0)
+        && (rc != CRM_EX_OK)) {
+        reply_data.reply_type = pcmk_schedulerd_reply_graph;
+        reply_data.data.graph.reference = crm_element_value(reply,
+                                                            PCMK_XA_REFERENCE);
+        crm_info("Calculation %s failed in schedulerd: %s",
+                 reply_data.data.graph.reference,
+                 pcmk__s(crm_element_value(reply, PCMK_XA_EXIT_REASON),
+                         crm_exit_str((crm_exit_t) rc)));
+        status = (crm_exit_t) rc;
+
+    } else if (pcmk__str_eq(value, CRM_OP_PECALC, pcmk__str_none)
+        && pcmk__xe_attr_is_true(reply, PCMK__XA_CRM_TGRAPH_CANCELLED)) {
+        reply_data.reply_type = pcmk_schedulerd_reply_cancelled;
+        reply_data.data.graph.reference = crm_element_value(reply,
+                                                            PCMK_XA_REFERENCE);
+
+    } else if (pcmk__str_eq(value, CRM_OP_PECALC, pcmk__str_none)) {
         reply_data.reply_type = pcmk_schedulerd_reply_graph;
         reply_data.data.graph.reference = crm_element_value(reply,
                                                             PCMK_XA_REFERENCE);
@@ -153,7 +172,8 @@ pcmk__schedulerd_api_methods(void)
 }
 
 static int
-do_schedulerd_api_call(pcmk_ipc_api_t *api, const char *task, xmlNode *cib, char **ref)
+do_schedulerd_api_call(pcmk_ipc_api_t *api, const char *task, xmlNode *cib,
+                       const char *target_ref, int priority, char **ref)
 {
     schedulerd_api_private_t *private;
     xmlNode *cmd = NULL;
@@ -174,13 +194,19 @@ do_schedulerd_api_call(pcmk_ipc_api_t *api, const char *task, xmlNode *cib, char
     free(sender_system);
 
     if (cmd) {
+        crm_xml_add(cmd, PCMK__XA_CRM_TGRAPH_REF, target_ref);
+        if (priority < PCMK__SCHEDULER_PRIORITY_DC) {
+            crm_xml_add_int(cmd, PCMK__XA_PRIORITY, priority);
+        }
         rc = pcmk__send_ipc_request(api, cmd);
         if (rc != pcmk_rc_ok) {
             crm_debug("Couldn't send request to schedulerd: %s rc=%d",
                       pcmk_rc_str(rc), rc);
         }
 
-        *ref = strdup(crm_element_value(cmd, PCMK_XA_REFERENCE));
+        if (ref != NULL) {
+            *ref = strdup(crm_element_value(cmd, PCMK_XA_REFERENCE));
+        }
         pcmk__xml_free(cmd);
     } else {
         rc = ENOMSG;
@@ -192,5 +218,47 @@ do_schedulerd_api_call(pcmk_ipc_api_t *api, const char *task, xmlNode *cib, char
 int
 pcmk_schedulerd_api_graph(pcmk_ipc_api_t *api, xmlNode *cib, char **ref)
 {
-    return do_schedulerd_api_call(api, CRM_OP_PECALC, cib, ref);
+    return do_schedulerd_api_call(api, CRM_OP_PECALC, cib, NULL,
+                                  PCMK__SCHEDULER_PRIORITY_DC, ref);
+}
+
+/*!
+ * \internal
+ * \brief Request a scheduler calculation with a given priority
+ *
+ * Unlike \c pcmk_schedulerd_api_graph(), which is meant for the DC, this is
+ * meant for other clients (such as tools that preview what the cluster would
+ * do). The scheduler will run the calculation in a worker process, so it
+ * neither waits for nor delays the DC's calculations, and will not save the
+ * input to disk.
+ *
+ * \param[in,out] api       Scheduler IPC object
+ * \param[in]     cib       CIB to calculate transition graph for
+ * \param[in]     priority  Priority of request relative to other non-DC
+ *                          requests (higher is more urgent; must be less than
+ *                          \c PCMK__SCHEDULER_PRIORITY_DC)
+ * \param[out]    ref       Where to store request reference (the caller is
+ *                          responsible for freeing this)
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__schedulerd_api_graph(pcmk_ipc_api_t *api, xmlNode *cib, int priority,
+                           char **ref)
+{
+    if (priority >= PCMK__SCHEDULER_PRIORITY_DC) {
+        return EINVAL;
+    }
+    return do_schedulerd_api_call(api, CRM_OP_PECALC, cib, NULL, priority,
+                                  ref);
+}
+
+int
+pcmk_schedulerd_api_cancel(pcmk_ipc_api_t *api, const char *ref)
+{
+    if (pcmk__str_empty(ref)) {
+        return EINVAL;
+    }
+    return do_schedulerd_api_call(api, PCMK__SCHEDULERD_CMD_CANCEL, NULL, ref,
+                                  PCMK__SCHEDULER_PRIORITY_DC, NULL);
 }
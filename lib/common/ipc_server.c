@@ -11,6 +11,7 @@
 
 #include <stdio.h>
 #include <errno.h>
+#include <time.h>
 #include <bzlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -24,8 +25,35 @@
 /* Evict clients whose event queue grows this large (by default) */
 #define PCMK_IPC_DEFAULT_QUEUE_MAX 500
 
+/* By default, evict the client with the largest backlog when events queued for
+ * all clients exceed this many bytes (or this many IPC buffers, if larger)
+ */
+#define PCMK_IPC_DEFAULT_QUEUE_BUDGET   (32 * 1024 * 1024)
+#define PCMK_IPC_QUEUE_BUDGET_BUFFERS   16
+
+/* How long (in milliseconds) to wait before resuming a response that a client
+ * was not ready for (the client is blocked waiting for it)
+ */
+#define PCMK_IPC_RESPONSE_RETRY_MS      100
+
 static GHashTable *client_connections = NULL;
 
+// Total size of events queued for all IPC clients
+static size_t queued_event_bytes = 0;
+
+static pcmk__metric_t requests_metric =
+    PCMK__METRIC(pcmk__metric_counter, "ipc_requests_total",
+                 "IPC requests received from clients");
+static pcmk__metric_t queued_events_metric =
+    PCMK__METRIC(pcmk__metric_gauge, "ipc_queued_events",
+                 "IPC events queued for all clients");
+static pcmk__metric_t queued_bytes_metric =
+    PCMK__METRIC(pcmk__metric_gauge, "ipc_queued_bytes",
+                 "Size of IPC events queued for all clients");
+static pcmk__metric_t backlog_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "ipc_client_backlog",
+                 "IPC events left queued for a client after sending");
+
 /*!
  * \internal
  * \brief Count IPC clients
@@ -175,6 +203,8 @@ client_from_connection(qb_ipcs_connection_t *c, void *key, uid_t uid_client)
         client->ipcs = c;
         pcmk__set_client_flags(client, pcmk__client_ipc);
         client->pid = pcmk__client_pid(c);
+        client->buffer_size = (uint32_t)
+                              QB_MAX(qb_ipcs_connection_get_buffer_size(c), 0);
         if (key == NULL) {
             key = c;
         }
@@ -271,6 +301,42 @@ free_event(gpointer data)
     pcmk_free_ipc_event((struct iovec *) data);
 }
 
+static inline size_t
+event_size(const struct iovec *event)
+{
+    return event[0].iov_len + event[1].iov_len;
+}
+
+/*!
+ * \internal
+ * \brief Get the largest message that can be sent to a client in one piece
+ *
+ * \param[in] c  Client to check
+ *
+ * \return IPC buffer size of \p c's connection if known, otherwise the
+ *         default IPC buffer size
+ */
+static inline uint32_t
+client_buffer_size(const pcmk__client_t *c)
+{
+    return (c->buffer_size > 0)? c->buffer_size : crm_ipc_default_buffer_size();
+}
+
+static struct iovec *
+copy_event(const struct iovec *iov)
+{
+    struct iovec *iov_copy = pcmk__new_ipc_event();
+
+    iov_copy[0].iov_len = iov[0].iov_len;
+    iov_copy[0].iov_base = malloc(iov[0].iov_len);
+    memcpy(iov_copy[0].iov_base, iov[0].iov_base, iov[0].iov_len);
+
+    iov_copy[1].iov_len = iov[1].iov_len;
+    iov_copy[1].iov_base = malloc(iov[1].iov_len);
+    memcpy(iov_copy[1].iov_base, iov[1].iov_base, iov[1].iov_len);
+    return iov_copy;
+}
+
 static void
 add_event(pcmk__client_t *c, struct iovec *iov)
 {
@@ -278,6 +344,77 @@ add_event(pcmk__client_t *c, struct iovec *iov)
         c->event_queue = g_queue_new();
     }
     g_queue_push_tail(c->event_queue, iov);
+    c->queued_bytes += event_size(iov);
+    queued_event_bytes += event_size(iov);
+
+    pcmk__metric_add(&queued_events_metric, 1);
+    pcmk__metric_set(&queued_bytes_metric, (int64_t) queued_event_bytes);
+}
+
+/*!
+ * \internal
+ * \brief Remove the first event from a client's event queue
+ *
+ * \param[in,out] c  Client to remove event for
+ *
+ * \return Removed event (or NULL if queue was empty)
+ */
+static struct iovec *
+remove_event(pcmk__client_t *c)
+{
+    struct iovec *event = NULL;
+
+    if (c->event_queue != NULL) {
+        event = g_queue_pop_head(c->event_queue);
+    }
+    if (event != NULL) {
+        c->queued_bytes -= event_size(event);
+        queued_event_bytes -= event_size(event);
+        c->event_offset = 0;
+
+        pcmk__metric_add(&queued_events_metric, -1);
+        pcmk__metric_set(&queued_bytes_metric, (int64_t) queued_event_bytes);
+    }
+    return event;
+}
+
+/*!
+ * \internal
+ * \brief Free all events queued for a client
+ *
+ * \param[in,out] c  Client to drop events for
+ */
+static void
+drop_events(pcmk__client_t *c)
+{
+    if (c->event_queue != NULL) {
+        guint n_events = g_queue_get_length(c->event_queue);
+
+        crm_debug("Destroying %u events", n_events);
+        g_queue_free_full(c->event_queue, free_event);
+        c->event_queue = NULL;
+        pcmk__metric_add(&queued_events_metric, -((int64_t) n_events));
+    }
+    queued_event_bytes -= c->queued_bytes;
+    pcmk__metric_set(&queued_bytes_metric, (int64_t) queued_event_bytes);
+    c->queued_bytes = 0;
+    c->event_offset = 0;
+}
+
+/*!
+ * \internal
+ * \brief Free all responses that have not been (fully) sent to a client
+ *
+ * \param[in,out] c  Client to drop responses for
+ */
+static void
+drop_responses(pcmk__client_t *c)
+{
+    if (c->response_queue != NULL) {
+        g_queue_free_full(c->response_queue, free_event);
+        c->response_queue = NULL;
+    }
+    c->response_offset = 0;
 }
 
 void
@@ -304,10 +441,8 @@ pcmk__free_client(pcmk__client_t *c)
         g_source_remove(c->event_timer);
     }
 
-    if (c->event_queue) {
-        crm_debug("Destroying %d events", g_queue_get_length(c->event_queue));
-        g_queue_free_full(c->event_queue, free_event);
-    }
+    drop_events(c);
+    drop_responses(c);
 
     free(c->id);
     free(c->name);
@@ -383,27 +518,30 @@ pcmk__client_pid(qb_ipcs_connection_t *c)
 
 /*!
  * \internal
- * \brief Retrieve message XML from data read from client IPC
+ * \brief Retrieve message text from data read from client IPC
  *
- * \param[in,out]  c       IPC client connection
- * \param[in]      data    Data read from client connection
- * \param[out]     id      Where to store message ID from libqb header
- * \param[out]     flags   Where to store flags from libqb header
+ * \param[in,out]  c             IPC client connection
+ * \param[in]      data          Data read from client connection
+ * \param[out]     id            Where to store message ID from libqb header
+ * \param[out]     flags         Where to store flags from libqb header
+ * \param[out]     uncompressed  Where to store newly allocated buffer if the
+ *                                data had to be decompressed (caller must free)
  *
- * \return Message XML on success, NULL otherwise
+ * \return Message text on success (pointing into \p data or
+ *         \p *uncompressed), NULL otherwise
  */
-xmlNode *
-pcmk__client_data2xml(pcmk__client_t *c, void *data, uint32_t *id,
-                      uint32_t *flags)
+static const char *
+client_data2text(pcmk__client_t *c, void *data, uint32_t *id, uint32_t *flags,
+                 char **uncompressed)
 {
-    xmlNode *xml = NULL;
-    char *uncompressed = NULL;
     char *text = ((char *)data) + sizeof(pcmk__ipc_header_t);
     pcmk__ipc_header_t *header = data;
 
+    *uncompressed = NULL;
     if (!pcmk__valid_ipc_header(header)) {
         return NULL;
     }
+    pcmk__metric_add(&requests_metric, 1);
 
     if (id) {
         *id = ((struct qb_ipc_response_header *)data)->id;
@@ -412,6 +550,13 @@ pcmk__client_data2xml(pcmk__client_t *c, void *data, uint32_t *id,
         *flags = header->flags;
     }
 
+    if (pcmk_is_set(header->flags, pcmk__ipc_multipart)) {
+        // Only servers split messages into parts
+        crm_err("Ignoring multipart IPC message from client %s",
+                pcmk__client_name(c));
+        return NULL;
+    }
+
     if (pcmk_is_set(header->flags, crm_ipc_proxied)) {
         /* Mark this client as being the endpoint of a proxy connection.
          * Proxy connections responses are sent on the event channel, to avoid
@@ -423,25 +568,50 @@ pcmk__client_data2xml(pcmk__client_t *c, void *data, uint32_t *id,
     if (header->size_compressed) {
         int rc = 0;
         unsigned int size_u = 1 + header->size_uncompressed;
-        uncompressed = pcmk__assert_alloc(1, size_u);
+        *uncompressed = pcmk__assert_alloc(1, size_u);
 
         crm_trace("Decompressing message data %u bytes into %u bytes",
                   header->size_compressed, size_u);
 
-        rc = BZ2_bzBuffToBuffDecompress(uncompressed, &size_u, text, header->size_compressed, 1, 0);
-        text = uncompressed;
+        rc = BZ2_bzBuffToBuffDecompress(*uncompressed, &size_u, text, header->size_compressed, 1, 0);
+        text = *uncompressed;
 
         rc = pcmk__bzlib2rc(rc);
 
         if (rc != pcmk_rc_ok) {
             crm_err("Decompression failed: %s " QB_XS " rc=%d",
                     pcmk_rc_str(rc), rc);
-            free(uncompressed);
+            g_clear_pointer(uncompressed, free);
             return NULL;
         }
     }
 
     pcmk__assert(text[header->size_uncompressed - 1] == 0);
+    return text;
+}
+
+/*!
+ * \internal
+ * \brief Retrieve message XML from data read from client IPC
+ *
+ * \param[in,out]  c       IPC client connection
+ * \param[in]      data    Data read from client connection
+ * \param[out]     id      Where to store message ID from libqb header
+ * \param[out]     flags   Where to store flags from libqb header
+ *
+ * \return Message XML on success, NULL otherwise
+ */
+xmlNode *
+pcmk__client_data2xml(pcmk__client_t *c, void *data, uint32_t *id,
+                      uint32_t *flags)
+{
+    xmlNode *xml = NULL;
+    char *uncompressed = NULL;
+    const char *text = client_data2text(c, data, id, flags, &uncompressed);
+
+    if (text == NULL) {
+        return NULL;
+    }
 
     xml = pcmk__xml_parse(text);
     crm_log_xml_trace(xml, "[IPC received]");
@@ -450,6 +620,33 @@ pcmk__client_data2xml(pcmk__client_t *c, void *data, uint32_t *id,
     return xml;
 }
 
+/*!
+ * \internal
+ * \brief Retrieve message text from data read from client IPC
+ *
+ * This is useful for relaying a client message elsewhere without parsing it.
+ *
+ * \param[in,out]  c       IPC client connection
+ * \param[in]      data    Data read from client connection
+ * \param[out]     id      Where to store message ID from libqb header
+ * \param[out]     flags   Where to store flags from libqb header
+ *
+ * \return Newly allocated message text on success, NULL otherwise
+ * \note The caller is responsible for freeing the result with \p free().
+ */
+char *
+pcmk__client_data2text(pcmk__client_t *c, void *data, uint32_t *id,
+                       uint32_t *flags)
+{
+    char *uncompressed = NULL;
+    const char *text = client_data2text(c, data, id, flags, &uncompressed);
+
+    if ((text == NULL) || (uncompressed != NULL)) {
+        return uncompressed;
+    }
+    return pcmk__str_copy(text);
+}
+
 static int crm_ipcs_flush_events(pcmk__client_t *c);
 
 static gboolean
@@ -458,6 +655,7 @@ crm_ipcs_flush_events_cb(gpointer data)
     pcmk__client_t *c = data;
 
     c->event_timer = 0;
+    flush_responses(c);
     crm_ipcs_flush_events(c);
     return FALSE;
 }
@@ -478,6 +676,202 @@ delay_next_flush(pcmk__client_t *c, unsigned int queue_len)
     c->event_timer = pcmk__create_timer(delay, crm_ipcs_flush_events_cb, c);
 }
 
+/*!
+ * \internal
+ * \brief Get the maximum total size of events queued for all IPC clients
+ *
+ * \return Queue budget in bytes (from PCMK_ipc_queue_budget if valid, otherwise
+ *         the default)
+ */
+static size_t
+event_budget(void)
+{
+    static long long budget = 0LL;
+
+    if (budget == 0LL) {
+        const char *value = pcmk__env_option(PCMK__ENV_IPC_QUEUE_BUDGET);
+        long long default_budget = QB_MAX(PCMK_IPC_DEFAULT_QUEUE_BUDGET,
+                                          PCMK_IPC_QUEUE_BUDGET_BUFFERS
+                                          * (long long)
+                                            crm_ipc_default_buffer_size());
+        int rc = pcmk__scan_ll(value, &budget, default_budget);
+
+        if ((rc != pcmk_rc_ok) || (budget <= 0LL)) {
+            crm_warn("Using %lld as IPC queue budget because '%s' is not "
+                     "a valid value for PCMK_" PCMK__ENV_IPC_QUEUE_BUDGET,
+                     default_budget, value);
+            budget = default_budget;
+        }
+    }
+    return (size_t) budget;
+}
+
+static void
+check_largest_queue(gpointer key, gpointer value, gpointer user_data)
+{
+    pcmk__client_t *client = value;
+    pcmk__client_t **largest = user_data;
+
+    if ((client->ipcs != NULL)
+        && ((*largest == NULL)
+            || (client->queued_bytes > (*largest)->queued_bytes))) {
+        *largest = client;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Evict client with largest backlog if all backlogs exceed the budget
+ *
+ * Each client's queue length is limited separately, but many clients falling
+ * behind on large messages (such as CIB notifications) could still exhaust
+ * memory. When the total size of queued events exceeds the budget, free the
+ * largest backlog and disconnect its client, before memory runs out.
+ *
+ * \param[in] c  Client whose event queue was just flushed
+ *
+ * \return true if \p c was evicted, otherwise false
+ */
+static bool
+enforce_event_budget(const pcmk__client_t *c)
+{
+    pcmk__client_t *largest = NULL;
+    bool evicted_self = false;
+
+    if (queued_event_bytes <= event_budget()) {
+        return false;
+    }
+
+    pcmk__foreach_ipc_client(check_largest_queue, &largest);
+    if ((largest == NULL) || (largest->queued_bytes == 0)) {
+        return false;
+    }
+
+    crm_err("Evicting client with process ID %u due to backlog of %zu bytes "
+            "(IPC queue budget of %zu bytes exceeded by all clients) "
+            QB_XS " %p", largest->pid, largest->queued_bytes, event_budget(),
+            largest->ipcs);
+
+    evicted_self = (largest == c);
+    largest->queue_backlog = 0;
+    drop_events(largest);
+    qb_ipcs_disconnect(largest->ipcs);
+    return evicted_self;
+}
+
+/*!
+ * \internal
+ * \brief Send (the rest of) a multipart message to an IPC client
+ *
+ * \param[in,out] c       Client to send message to
+ * \param[in]     iov     Multipart message prepared by pcmk__ipc_prepare_iov()
+ * \param[in,out] offset  Bytes of message already sent (updated as parts are
+ *                        sent)
+ * \param[in]     event   If true, send parts as events, otherwise as responses
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+send_parts(pcmk__client_t *c, const struct iovec *iov, size_t *offset,
+           bool event)
+{
+    const pcmk__ipc_header_t *header = iov[0].iov_base;
+    const size_t max_part = client_buffer_size(c)
+                            - sizeof(pcmk__ipc_header_t) - 1;
+
+    while (*offset < iov[1].iov_len) {
+        pcmk__ipc_header_t part_header = *header;
+        struct iovec part[2];
+        size_t len = QB_MIN(iov[1].iov_len - *offset, max_part);
+        ssize_t qb_rc = 0;
+
+        if ((*offset + len) == iov[1].iov_len) {
+            pcmk__set_ipc_flags(part_header.flags, "multipart",
+                                pcmk__ipc_multipart_end);
+        }
+        part_header.qb.size = sizeof(pcmk__ipc_header_t) + len;
+
+        part[0].iov_base = &part_header;
+        part[0].iov_len = sizeof(pcmk__ipc_header_t);
+        part[1].iov_base = (char *) iov[1].iov_base + *offset;
+        part[1].iov_len = len;
+
+        if (event) {
+            qb_rc = qb_ipcs_event_sendv(c->ipcs, part, 2);
+        } else {
+            qb_rc = qb_ipcs_response_sendv(c->ipcs, part, 2);
+        }
+        if (qb_rc < 0) {
+            return (int) -qb_rc;
+        }
+        *offset += len;
+    }
+
+    crm_trace("Sent %zu-byte %s %d to %p[%d] in parts",
+              iov[1].iov_len, (event? "event" : "response"), header->qb.id,
+              c->ipcs, c->pid);
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Send client any responses that could not be sent immediately
+ *
+ * Responses are sent in order. A response that is sent in parts resumes with
+ * the first part that has not been sent yet, so the client never receives a
+ * truncated reply when its response buffer fills up.
+ *
+ * \param[in,out] c  Client to flush
+ *
+ * \return Standard Pacemaker return code (\c EAGAIN if the client is not
+ *         ready for the rest of the responses yet)
+ */
+static int
+flush_responses(pcmk__client_t *c)
+{
+    struct iovec *response = NULL;
+
+    while ((c->response_queue != NULL)
+           && ((response = g_queue_peek_head(c->response_queue)) != NULL)) {
+
+        const pcmk__ipc_header_t *header = response[0].iov_base;
+        int rc = pcmk_rc_ok;
+
+        if (pcmk_is_set(header->flags, pcmk__ipc_multipart)) {
+            rc = send_parts(c, response, &(c->response_offset), false);
+
+        } else {
+            ssize_t qb_rc = qb_ipcs_response_sendv(c->ipcs, response, 2);
+
+            if (qb_rc < 0) {
+                rc = (int) -qb_rc;
+            }
+        }
+
+        if (rc == EAGAIN) {
+            crm_trace("Response %d to %p[%d] delayed after %zu of %u bytes",
+                      header->qb.id, c->ipcs, c->pid, c->response_offset,
+                      header->qb.size);
+            return rc;
+        }
+
+        if (rc != pcmk_rc_ok) {
+            crm_notice("Response %d to pid %d failed: %s "
+                       QB_XS " bytes=%u rc=%d ipcs=%p",
+                       header->qb.id, c->pid, pcmk_rc_str(rc),
+                       header->qb.size, rc, c->ipcs);
+            drop_responses(c);
+            return rc;
+        }
+
+        crm_trace("Response %d sent, %u bytes to %p[%d]",
+                  header->qb.id, header->qb.size, c->ipcs, c->pid);
+        pcmk_free_ipc_event(g_queue_pop_head(c->response_queue));
+        c->response_offset = 0;
+    }
+    return pcmk_rc_ok;
+}
+
 /*!
  * \internal
  * \brief Send client any messages in its queue
@@ -518,15 +912,25 @@ crm_ipcs_flush_events(pcmk__client_t *c)
             break;
         }
 
-        qb_rc = qb_ipcs_event_sendv(c->ipcs, event, 2);
-        if (qb_rc < 0) {
-            rc = (int) -qb_rc;
-            break;
+        header = event[0].iov_base;
+        if (pcmk_is_set(header->flags, pcmk__ipc_multipart)) {
+            // Resume where any earlier attempt left off
+            rc = send_parts(c, event, &(c->event_offset), true);
+            if (rc != pcmk_rc_ok) {
+                break;
+            }
+            qb_rc = (ssize_t) event_size(event);
+
+        } else {
+            qb_rc = qb_ipcs_event_sendv(c->ipcs, event, 2);
+            if (qb_rc < 0) {
+                rc = (int) -qb_rc;
+                break;
+            }
         }
-        event = g_queue_pop_head(c->event_queue);
+        event = remove_event(c);
 
         sent++;
-        header = event[0].iov_base;
         if (header->size_compressed) {
             crm_trace("Event %d to %p[%d] (%lld compressed bytes) sent",
                       header->qb.id, c->ipcs, c->pid, (long long) qb_rc);
@@ -539,12 +943,17 @@ crm_ipcs_flush_events(pcmk__client_t *c)
     }
 
     queue_len -= sent;
+    pcmk__metric_observe(&backlog_metric, queue_len);
     if (sent > 0 || queue_len) {
         crm_trace("Sent %d events (%d remaining) for %p[%d]: %s (%lld)",
                   sent, queue_len, c->ipcs, c->pid,
                   pcmk_rc_str(rc), (long long) qb_rc);
     }
 
+    if (enforce_event_budget(c)) {
+        return rc;
+    }
+
     if (queue_len) {
 
         /* Allow clients to briefly fall behind on processing incoming messages,
@@ -571,6 +980,13 @@ crm_ipcs_flush_events(pcmk__client_t *c)
     } else {
         /* Event queue is empty, there is no backlog */
         c->queue_backlog = 0;
+
+        if ((c->response_queue != NULL)
+            && !g_queue_is_empty(c->response_queue)) {
+            // The client is waiting for the rest of a reply, so retry soon
+            c->event_timer = pcmk__create_timer(PCMK_IPC_RESPONSE_RETRY_MS,
+                                                crm_ipcs_flush_events_cb, c);
+        }
     }
 
     return rc;
@@ -578,41 +994,30 @@ crm_ipcs_flush_events(pcmk__client_t *c)
 
 /*!
  * \internal
- * \brief Create an I/O vector for sending an IPC XML message
+ * \brief Create an I/O vector for sending IPC message text
  *
  * \param[in]  request        Identifier for libqb response header
- * \param[in]  message        XML message to send
+ * \param[in]  text           Message text to send
+ * \param[in]  len            Length of \p text (not including terminator)
  * \param[in]  max_send_size  If 0, default IPC buffer size is used
  * \param[out] result         Where to store prepared I/O vector
  * \param[out] bytes          Size of prepared data in bytes
  *
  * \return Standard Pacemaker return code
  */
-int
-pcmk__ipc_prepare_iov(uint32_t request, const xmlNode *message,
-                      uint32_t max_send_size, struct iovec **result,
-                      ssize_t *bytes)
+static int
+prepare_text_iov(uint32_t request, const char *text, size_t len,
+                 uint32_t max_send_size, struct iovec **result, ssize_t *bytes)
 {
     struct iovec *iov;
     unsigned int total = 0;
-    GString *buffer = NULL;
     pcmk__ipc_header_t *header = NULL;
-    int rc = pcmk_rc_ok;
-
-    if ((message == NULL) || (result == NULL)) {
-        rc = EINVAL;
-        goto done;
-    }
 
     header = calloc(1, sizeof(pcmk__ipc_header_t));
     if (header == NULL) {
-       rc = ENOMEM;
-       goto done;
+       return ENOMEM;
     }
 
-    buffer = g_string_sized_new(1024);
-    pcmk__xml_string(message, 0, buffer, 0);
-
     if (max_send_size == 0) {
         max_send_size = crm_ipc_default_buffer_size();
     }
@@ -624,21 +1029,18 @@ pcmk__ipc_prepare_iov(uint32_t request, const xmlNode *message,
     iov[0].iov_base = header;
 
     header->version = PCMK__IPC_VERSION;
-    header->size_uncompressed = 1 + buffer->len;
+    header->size_uncompressed = 1 + len;
     total = iov[0].iov_len + header->size_uncompressed;
 
     if (total < max_send_size) {
-        iov[1].iov_base = pcmk__str_copy(buffer->str);
+        iov[1].iov_base = pcmk__str_copy(text);
         iov[1].iov_len = header->size_uncompressed;
 
     } else {
-        static unsigned int biggest = 0;
-
         char *compressed = NULL;
         unsigned int new_size = 0;
 
-        if (pcmk__compress(buffer->str,
-                           (unsigned int) header->size_uncompressed,
+        if (pcmk__compress(text, (unsigned int) header->size_uncompressed,
                            (unsigned int) max_send_size, &compressed,
                            &new_size) == pcmk_rc_ok) {
 
@@ -648,21 +1050,22 @@ pcmk__ipc_prepare_iov(uint32_t request, const xmlNode *message,
             iov[1].iov_len = header->size_compressed;
             iov[1].iov_base = compressed;
 
-            biggest = QB_MAX(header->size_compressed, biggest);
-
         } else {
-            crm_log_xml_trace(message, "EMSGSIZE");
-            biggest = QB_MAX(header->size_uncompressed, biggest);
+            /* Even compressed, the message won't fit in one IPC buffer. Rather
+             * than require every buffer to be sized for the worst case, send
+             * it uncompressed in parts (servers only; see send_parts()).
+             */
+            crm_debug("Sending %u-byte IPC message in parts because it "
+                      "cannot be compressed into less than IPC limit of "
+                      "%u bytes", header->size_uncompressed, max_send_size);
+            free(compressed);
 
-            crm_err("Could not compress %u-byte message into less than IPC "
-                    "limit of %u bytes; set PCMK_ipc_buffer to higher value "
-                    "(%u bytes suggested)",
-                    header->size_uncompressed, max_send_size, 4 * biggest);
+            pcmk__set_ipc_flags(header->flags, "send data",
+                                pcmk__ipc_multipart);
+            header->version = PCMK__IPC_MULTIPART_VERSION;
 
-            free(compressed);
-            pcmk_free_ipc_event(iov);
-            rc = EMSGSIZE;
-            goto done;
+            iov[1].iov_base = pcmk__str_copy(text);
+            iov[1].iov_len = header->size_uncompressed;
         }
     }
 
@@ -674,11 +1077,41 @@ pcmk__ipc_prepare_iov(uint32_t request, const xmlNode *message,
     if (bytes != NULL) {
         *bytes = header->qb.size;
     }
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Create an I/O vector for sending an IPC XML message
+ *
+ * \param[in]  request        Identifier for libqb response header
+ * \param[in]  message        XML message to send
+ * \param[in]  max_send_size  If 0, default IPC buffer size is used
+ * \param[out] result         Where to store prepared I/O vector
+ * \param[out] bytes          Size of prepared data in bytes
+ *
+ * \return Standard Pacemaker return code
+ * \note If the message is too big for \p max_send_size even when compressed,
+ *       the result is flagged as multipart, and pcmk__ipc_send_iov() will send
+ *       it as a series of parts that each fit in an IPC buffer.
+ */
+int
+pcmk__ipc_prepare_iov(uint32_t request, const xmlNode *message,
+                      uint32_t max_send_size, struct iovec **result,
+                      ssize_t *bytes)
+{
+    GString *buffer = NULL;
+    int rc = pcmk_rc_ok;
 
-done:
-    if (buffer != NULL) {
-        g_string_free(buffer, TRUE);
+    if ((message == NULL) || (result == NULL)) {
+        return EINVAL;
     }
+
+    buffer = g_string_sized_new(1024);
+    pcmk__xml_string(message, 0, buffer, 0);
+    rc = prepare_text_iov(request, buffer->str, buffer->len, max_send_size,
+                          result, bytes);
+    g_string_free(buffer, TRUE);
     return rc;
 }
 
@@ -689,6 +1122,8 @@ pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags)
     static uint32_t id = 1;
     pcmk__ipc_header_t *header = iov[0].iov_base;
 
+    c->bytes_sent += event_size(iov);
+
     if (c->flags & pcmk__client_proxied) {
         /* _ALL_ replies to proxied connections need to be sent as events */
         if (!pcmk_is_set(flags, crm_ipc_server_event)) {
@@ -710,42 +1145,29 @@ pcmk__ipc_send_iov(pcmk__client_t *c, struct iovec *iov, uint32_t flags)
             add_event(c, iov);
 
         } else {
-            struct iovec *iov_copy = pcmk__new_ipc_event();
-
             crm_trace("Sending a copy to %p[%d]", c->ipcs, c->pid);
-            iov_copy[0].iov_len = iov[0].iov_len;
-            iov_copy[0].iov_base = malloc(iov[0].iov_len);
-            memcpy(iov_copy[0].iov_base, iov[0].iov_base, iov[0].iov_len);
-
-            iov_copy[1].iov_len = iov[1].iov_len;
-            iov_copy[1].iov_base = malloc(iov[1].iov_len);
-            memcpy(iov_copy[1].iov_base, iov[1].iov_base, iov[1].iov_len);
-
-            add_event(c, iov_copy);
+            add_event(c, copy_event(iov));
         }
 
     } else {
-        ssize_t qb_rc;
-
         CRM_LOG_ASSERT(header->qb.id != 0);     /* Replying to a specific request */
 
-        qb_rc = qb_ipcs_response_sendv(c->ipcs, iov, 2);
-        if (qb_rc < header->qb.size) {
-            if (qb_rc < 0) {
-                rc = (int) -qb_rc;
-            }
-            crm_notice("Response %d to pid %d failed: %s "
-                       QB_XS " bytes=%u rc=%lld ipcs=%p",
-                       header->qb.id, c->pid, pcmk_rc_str(rc),
-                       header->qb.size, (long long) qb_rc, c->ipcs);
-
-        } else {
-            crm_trace("Response %d sent, %lld bytes to %p[%d]",
-                      header->qb.id, (long long) qb_rc, c->ipcs, c->pid);
+        /* Queue the response behind any that couldn't be sent yet, so that a
+         * response the client isn't ready for (in particular, one sent in
+         * parts) can be resumed later rather than truncated
+         */
+        if (c->response_queue == NULL) {
+            c->response_queue = g_queue_new();
         }
-
-        if (flags & crm_ipc_server_free) {
-            pcmk_free_ipc_event(iov);
+        g_queue_push_tail(c->response_queue,
+                          pcmk_is_set(flags, crm_ipc_server_free)?
+                          iov : copy_event(iov));
+
+        rc = flush_responses(c);
+        if (rc == EAGAIN) {
+            crm_debug("Response %d to pid %d will be sent when the client "
+                      "is ready", header->qb.id, c->pid);
+            rc = pcmk_rc_ok;
         }
     }
 
@@ -771,8 +1193,45 @@ pcmk__ipc_send_xml(pcmk__client_t *c, uint32_t request, const xmlNode *message,
     if (c == NULL) {
         return EINVAL;
     }
-    rc = pcmk__ipc_prepare_iov(request, message, crm_ipc_default_buffer_size(),
-                               &iov, NULL);
+    rc = pcmk__ipc_prepare_iov(request, message, client_buffer_size(c), &iov,
+                               NULL);
+    if (rc == pcmk_rc_ok) {
+        pcmk__set_ipc_flags(flags, "send data", crm_ipc_server_free);
+        rc = pcmk__ipc_send_iov(c, iov, flags);
+    } else {
+        pcmk_free_ipc_event(iov);
+        crm_notice("IPC message to pid %d failed: %s " QB_XS " rc=%d",
+                   c->pid, pcmk_rc_str(rc), rc);
+    }
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Send already serialized message text to an IPC client
+ *
+ * This is useful for relaying a message received from elsewhere without
+ * parsing it.
+ *
+ * \param[in,out] c        IPC client to send to
+ * \param[in]     request  Identifier for libqb response header
+ * \param[in]     text     Message text (null-terminated)
+ * \param[in]     flags    Group of enum crm_ipc_flags
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__ipc_send_text(pcmk__client_t *c, uint32_t request, const char *text,
+                    uint32_t flags)
+{
+    struct iovec *iov = NULL;
+    int rc = pcmk_rc_ok;
+
+    if ((c == NULL) || (text == NULL)) {
+        return EINVAL;
+    }
+    rc = prepare_text_iov(request, text, strlen(text), client_buffer_size(c),
+                          &iov, NULL);
     if (rc == pcmk_rc_ok) {
         pcmk__set_ipc_flags(flags, "send data", crm_ipc_server_free);
         rc = pcmk__ipc_send_iov(c, iov, flags);
@@ -850,6 +1309,99 @@ pcmk__ipc_send_ack_as(const char *function, int line, pcmk__client_t *c,
     return rc;
 }
 
+// Reply to a request handled by pcmk__ipc_handle_common_request()
+static void
+send_common_reply(pcmk__client_t *c, uint32_t id, uint32_t flags,
+                  const xmlNode *reply)
+{
+    pcmk__ipc_send_xml(c, id, reply,
+                       pcmk_is_set(flags, crm_ipc_client_response)?
+                       crm_ipc_flags_none : crm_ipc_server_event);
+}
+
+// Change log settings (privileged clients only) and reply with current ones
+static void
+handle_log_control(pcmk__client_t *c, uint32_t id, uint32_t flags,
+                   const xmlNode *request)
+{
+    time_t now = time(NULL);
+    char *reason = NULL;
+    xmlNode *reply = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (!pcmk_is_set(c->flags, pcmk__client_privileged)) {
+        rc = EACCES;
+        reason = pcmk__str_copy("Changing log settings requires a privileged "
+                                "client");
+    } else {
+        rc = pcmk__apply_log_control(request, now, &reason);
+    }
+
+    if (rc == pcmk_rc_ok) {
+        crm_info("Applied log control request from client %s",
+                 pcmk__client_name(c));
+    } else {
+        crm_notice("Rejected log control request from client %s: %s",
+                   pcmk__client_name(c), pcmk__s(reason, pcmk_rc_str(rc)));
+    }
+
+    reply = pcmk__xe_create(NULL, PCMK__XE_LOG_CONTROL);
+    crm_xml_add_int(reply, PCMK__XA_RC_CODE, rc);
+    crm_xml_add(reply, PCMK_XA_REASON, reason);
+    pcmk__log_control_state(reply, now);
+
+    send_common_reply(c, id, flags, reply);
+    pcmk__xml_free(reply);
+    free(reason);
+}
+
+// Reply with all of this daemon's performance metrics
+static void
+handle_get_metrics(pcmk__client_t *c, uint32_t id, uint32_t flags)
+{
+    xmlNode *reply = pcmk__xe_create(NULL, PCMK_XE_METRICS);
+
+    crm_trace("Sending metrics to client %s", pcmk__client_name(c));
+    crm_xml_add_int(reply, PCMK__XA_RC_CODE, pcmk_rc_ok);
+    pcmk__metrics_xml(reply);
+    send_common_reply(c, id, flags, reply);
+    pcmk__xml_free(reply);
+}
+
+/*!
+ * \internal
+ * \brief Handle a request that every daemon accepts, if that is what it is
+ *
+ * Every daemon accepts certain requests regardless of what else its IPC API
+ * supports: log control requests (to change its log level or trace filters at
+ * run time, from privileged clients only) and metrics requests (to get its
+ * performance metrics). The reply is a \c PCMK__XE_LOG_CONTROL element with
+ * the result and the daemon's current log settings, or a \c PCMK_XE_METRICS
+ * element with a \c PCMK_XE_METRIC child for each metric.
+ *
+ * \param[in,out] c        Client that sent request
+ * \param[in]     id       IPC ID of request
+ * \param[in]     flags    IPC flags of request
+ * \param[in]     request  Request XML
+ *
+ * \return true if \p request was one of these requests (and has been fully
+ *         handled), otherwise false
+ */
+bool
+pcmk__ipc_handle_common_request(pcmk__client_t *c, uint32_t id, uint32_t flags,
+                                const xmlNode *request)
+{
+    if (pcmk__xe_is(request, PCMK__XE_LOG_CONTROL)) {
+        handle_log_control(c, id, flags, request);
+        return true;
+    }
+    if (pcmk__xe_is(request, PCMK__XE_GET_METRICS)) {
+        handle_get_metrics(c, id, flags);
+        return true;
+    }
+    return false;
+}
+
 /*!
  * \internal
  * \brief Add an IPC server to the main loop for the CIB manager API
@@ -0,0 +1,622 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+#include <qb/qblog.h>
+
+#include <crm/crm.h>
+#include <crm/common/xml.h>
+#include "crmcommon_private.h"
+
+/* Trace filters and log level overrides set while a daemon is running (usually
+ * via crmadmin). Unlike the PCMK_trace_* environment variables, these may be
+ * changed at any time, and each may have a time-to-live after which it is
+ * removed automatically, so that verbose tracing does not outlive the
+ * investigation it was enabled for.
+ */
+
+// A trace filter added at run time
+typedef struct {
+    enum pcmk__log_filter_type type;
+    char *pattern;
+    time_t expires;     // When filter is removed automatically (0 for never)
+} log_filter_t;
+
+static GList *log_filters = NULL;       // log_filter_t *, oldest first
+
+// Log level to restore when a temporary override expires
+static unsigned int saved_log_level = 0;
+static time_t level_expires = 0;        // 0 if no temporary override
+
+static guint expiry_timer = 0;
+
+static const char *filter_type_names[] = {
+    [pcmk__log_filter_function] = "function",
+    [pcmk__log_filter_file]     = "file",
+    [pcmk__log_filter_format]   = "format",
+    [pcmk__log_filter_tag]      = "tag",
+};
+
+static const char *log_level_names[] = {
+    [LOG_EMERG]     = "emerg",
+    [LOG_ALERT]     = "alert",
+    [LOG_CRIT]      = "crit",
+    [LOG_ERR]       = "error",
+    [LOG_WARNING]   = "warning",
+    [LOG_NOTICE]    = "notice",
+    [LOG_INFO]      = "info",
+    [LOG_DEBUG]     = "debug",
+    [LOG_TRACE]     = "trace",
+};
+
+/*!
+ * \internal
+ * \brief Get a string representation of a trace filter type
+ *
+ * \param[in] type  Trace filter type
+ *
+ * \return String representation of \p type
+ */
+const char *
+pcmk__log_filter_type_text(enum pcmk__log_filter_type type)
+{
+    if ((unsigned int) type > pcmk__log_filter_tag) {
+        return "unknown";
+    }
+    return filter_type_names[type];
+}
+
+/*!
+ * \internal
+ * \brief Parse a trace filter type from a string
+ *
+ * \param[in]  text  String to parse
+ * \param[out] type  Where to store parsed type
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__parse_log_filter_type(const char *text, enum pcmk__log_filter_type *type)
+{
+    for (int i = 0; i <= pcmk__log_filter_tag; i++) {
+        if (pcmk__str_eq(text, filter_type_names[i], pcmk__str_casei)) {
+            *type = (enum pcmk__log_filter_type) i;
+            return pcmk_rc_ok;
+        }
+    }
+    return pcmk_rc_bad_input;
+}
+
+/*!
+ * \internal
+ * \brief Parse a log level from a name (such as "debug") or number
+ *
+ * \param[in]  text   String to parse
+ * \param[out] level  Where to store parsed level
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__parse_log_level(const char *text, unsigned int *level)
+{
+    long long number = 0LL;
+
+    for (unsigned int i = 0; i <= LOG_TRACE; i++) {
+        if (pcmk__str_eq(text, log_level_names[i], pcmk__str_casei)) {
+            *level = i;
+            return pcmk_rc_ok;
+        }
+    }
+
+    if (!pcmk__str_empty(text) && (strspn(text, "0123456789") == strlen(text))
+        && (pcmk__scan_ll(text, &number, -1LL) == pcmk_rc_ok)
+        && (number >= 0LL) && (number <= LOG_TRACE)) {
+        *level = (unsigned int) number;
+        return pcmk_rc_ok;
+    }
+    return pcmk_rc_bad_input;
+}
+
+/*!
+ * \internal
+ * \brief Get the name of a log level
+ *
+ * \param[in] level  Log level
+ *
+ * \return Name of \p level
+ */
+const char *
+pcmk__log_level_text(unsigned int level)
+{
+    return log_level_names[QB_MIN(level, LOG_TRACE)];
+}
+
+static void
+free_filter(gpointer data)
+{
+    log_filter_t *filter = data;
+
+    free(filter->pattern);
+    free(filter);
+}
+
+static GList *
+find_filter(enum pcmk__log_filter_type type, const char *pattern)
+{
+    for (GList *iter = log_filters; iter != NULL; iter = iter->next) {
+        const log_filter_t *filter = iter->data;
+
+        if ((filter->type == type)
+            && pcmk__str_eq(filter->pattern, pattern, pcmk__str_none)) {
+            return iter;
+        }
+    }
+    return NULL;
+}
+
+static gboolean
+expire_cb(gpointer user_data)
+{
+    expiry_timer = 0;
+    pcmk__expire_log_control(time(NULL));
+    return G_SOURCE_REMOVE;
+}
+
+// Arrange for pcmk__expire_log_control() to run when next needed
+static void
+schedule_expiry(time_t now, time_t next)
+{
+    if (expiry_timer != 0) {
+        g_source_remove(expiry_timer);
+        expiry_timer = 0;
+    }
+    if (next != 0) {
+        expiry_timer = g_timeout_add_seconds(QB_MAX(next - now, 1), expire_cb,
+                                             NULL);
+    }
+}
+
+// Get the time when the next run-time log setting expires (or 0 if none)
+static time_t
+next_expiry(void)
+{
+    time_t next = level_expires;
+
+    for (const GList *iter = log_filters; iter != NULL; iter = iter->next) {
+        const log_filter_t *filter = iter->data;
+
+        if ((filter->expires != 0)
+            && ((next == 0) || (filter->expires < next))) {
+            next = filter->expires;
+        }
+    }
+    return next;
+}
+
+// Re-evaluate which log messages are enabled after a filter change
+static void
+refilter(time_t now)
+{
+    crm_update_callsites();
+    schedule_expiry(now, next_expiry());
+}
+
+/*!
+ * \internal
+ * \brief Enable tracing of log messages matching a pattern
+ *
+ * \param[in] type     What part of a log message to match
+ * \param[in] pattern  Function name, source file name (with or without
+ *                     directory), text contained in format string, or tag
+ * \param[in] ttl_s    Remove filter after this many seconds (0 for never)
+ * \param[in] now      Current time
+ *
+ * \return Standard Pacemaker return code
+ * \note If an identical filter already exists, only its time-to-live is
+ *       updated.
+ */
+int
+pcmk__add_log_filter(enum pcmk__log_filter_type type, const char *pattern,
+                     guint ttl_s, time_t now)
+{
+    GList *existing = NULL;
+    log_filter_t *filter = NULL;
+
+    if (((unsigned int) type > pcmk__log_filter_tag)
+        || pcmk__str_empty(pattern)) {
+        return EINVAL;
+    }
+
+    existing = find_filter(type, pattern);
+    if (existing != NULL) {
+        filter = existing->data;
+    } else {
+        filter = pcmk__assert_alloc(1, sizeof(log_filter_t));
+        filter->type = type;
+        filter->pattern = pcmk__str_copy(pattern);
+        log_filters = g_list_append(log_filters, filter);
+
+        if (type == pcmk__log_filter_tag) {
+            // Tags are compared as quarks, so make sure one exists
+            g_quark_from_string(pattern);
+        }
+    }
+    filter->expires = (ttl_s == 0)? 0 : (now + ttl_s);
+
+    crm_notice("Tracing log messages with %s %s%s%u%s",
+               pcmk__log_filter_type_text(type), pattern,
+               ((ttl_s == 0)? "" : " for "), ttl_s,
+               ((ttl_s == 0)? "" : "s"));
+    refilter(now);
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Disable tracing of log messages matching a pattern
+ *
+ * \param[in] type     What part of a log message to match
+ * \param[in] pattern  Pattern previously passed to \c pcmk__add_log_filter()
+ *
+ * \return Standard Pacemaker return code (specifically, \c ENXIO if no such
+ *         filter exists)
+ */
+int
+pcmk__remove_log_filter(enum pcmk__log_filter_type type, const char *pattern)
+{
+    GList *existing = find_filter(type, pattern);
+
+    if (existing == NULL) {
+        return ENXIO;
+    }
+
+    free_filter(existing->data);
+    log_filters = g_list_delete_link(log_filters, existing);
+    crm_notice("No longer tracing log messages with %s %s",
+               pcmk__log_filter_type_text(type), pattern);
+    refilter(time(NULL));
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Remove all trace filters added at run time
+ */
+void
+pcmk__clear_log_filters(void)
+{
+    if (log_filters != NULL) {
+        g_list_free_full(log_filters, free_filter);
+        log_filters = NULL;
+        crm_notice("Removed all run-time trace filters");
+        refilter(time(NULL));
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether a trace filter is active
+ *
+ * \param[in] type     What part of a log message to match
+ * \param[in] pattern  Pattern to check
+ *
+ * \return true if a filter for \p type and \p pattern is active, otherwise
+ *         false
+ */
+bool
+pcmk__log_filter_active(enum pcmk__log_filter_type type, const char *pattern)
+{
+    return find_filter(type, pattern) != NULL;
+}
+
+/*!
+ * \internal
+ * \brief Check whether a log callsite matches any run-time trace filter
+ *
+ * \param[in] cs  Log callsite to check
+ *
+ * \return true if \p cs should be traced, otherwise false
+ */
+bool
+pcmk__log_filter_matches(const struct qb_log_callsite *cs)
+{
+    for (const GList *iter = log_filters; iter != NULL; iter = iter->next) {
+        const log_filter_t *filter = iter->data;
+        const char *base = NULL;
+
+        switch (filter->type) {
+            case pcmk__log_filter_function:
+                if (pcmk__str_eq(cs->function, filter->pattern,
+                                 pcmk__str_none)) {
+                    return true;
+                }
+                break;
+
+            case pcmk__log_filter_file:
+                if (cs->filename == NULL) {
+                    break;
+                }
+                base = strrchr(cs->filename, '/');
+                base = (base == NULL)? cs->filename : (base + 1);
+                if (pcmk__str_eq(base, filter->pattern, pcmk__str_none)
+                    || pcmk__str_eq(cs->filename, filter->pattern,
+                                    pcmk__str_none)) {
+                    return true;
+                }
+                break;
+
+            case pcmk__log_filter_format:
+                if ((cs->format != NULL)
+                    && (strstr(cs->format, filter->pattern) != NULL)) {
+                    return true;
+                }
+                break;
+
+            case pcmk__log_filter_tag:
+                if ((cs->tags != 0) && (cs->tags != crm_trace_nonlog)
+                    && pcmk__str_eq(g_quark_to_string(cs->tags),
+                                    filter->pattern, pcmk__str_none)) {
+                    return true;
+                }
+                break;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * \brief Change the log level, optionally only for a limited time
+ *
+ * \param[in] level  New log level
+ * \param[in] ttl_s  Restore the level in effect before any temporary change
+ *                   after this many seconds (0 to make the change permanent)
+ * \param[in] now    Current time
+ */
+void
+pcmk__override_log_level(unsigned int level, guint ttl_s, time_t now)
+{
+    if (ttl_s == 0) {
+        level_expires = 0;
+    } else {
+        if (level_expires == 0) {
+            saved_log_level = get_crm_log_level();
+        }
+        level_expires = now + ttl_s;
+    }
+
+    crm_notice("Setting log level to %s%s%u%s",
+               pcmk__log_level_text(level), ((ttl_s == 0)? "" : " for "),
+               ttl_s, ((ttl_s == 0)? "" : "s"));
+    set_crm_log_level(level);
+    schedule_expiry(now, next_expiry());
+}
+
+/*!
+ * \internal
+ * \brief Remove run-time log settings whose time-to-live has passed
+ *
+ * \param[in] now  Current time
+ *
+ * \return Time when the next remaining setting expires (or 0 if none will)
+ * \note Daemons do not need to call this, because it is called from the main
+ *       loop as needed.
+ */
+time_t
+pcmk__expire_log_control(time_t now)
+{
+    bool changed = false;
+    GList *iter = log_filters;
+
+    while (iter != NULL) {
+        GList *next = iter->next;
+        log_filter_t *filter = iter->data;
+
+        if ((filter->expires != 0) && (filter->expires <= now)) {
+            crm_notice("Trace filter for %s %s expired",
+                       pcmk__log_filter_type_text(filter->type),
+                       filter->pattern);
+            free_filter(filter);
+            log_filters = g_list_delete_link(log_filters, iter);
+            changed = true;
+        }
+        iter = next;
+    }
+
+    if ((level_expires != 0) && (level_expires <= now)) {
+        level_expires = 0;
+        crm_notice("Temporary log level expired, restoring %s",
+                   pcmk__log_level_text(saved_log_level));
+        set_crm_log_level(saved_log_level); // Also re-evaluates callsites
+
+    } else if (changed) {
+        crm_update_callsites();
+    }
+
+    schedule_expiry(now, next_expiry());
+    return next_expiry();
+}
+
+// Parse an optional time-to-live attribute in seconds
+static int
+get_ttl(const xmlNode *xml, guint default_ttl, guint *ttl_s)
+{
+    const char *value = crm_element_value(xml, PCMK__XA_TTL);
+    long long ttl = 0LL;
+
+    if (value == NULL) {
+        *ttl_s = default_ttl;
+        return pcmk_rc_ok;
+    }
+    if ((pcmk__scan_ll(value, &ttl, -1LL) != pcmk_rc_ok) || (ttl < 0LL)
+        || (ttl > G_MAXUINT)) {
+        return pcmk_rc_bad_input;
+    }
+    *ttl_s = (guint) ttl;
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Apply a log control request
+ *
+ * A log control request is a \c PCMK__XE_LOG_CONTROL element with an optional
+ * \c PCMK__XA_LOG_LEVEL attribute to change the log level, an optional
+ * \c PCMK__XA_TTL attribute with the default time-to-live in seconds, and any
+ * number of \c PCMK__XE_LOG_FILTER children. Each child has a
+ * \c PCMK_XA_ACTION of "add", "remove", or "clear" (which removes all
+ * filters); added and removed filters also have \c PCMK_XA_TYPE and
+ * \c PCMK_XA_NAME, and added ones may have their own \c PCMK__XA_TTL.
+ *
+ * \param[in]  request  Log control request
+ * \param[in]  now      Current time
+ * \param[out] reason   Where to store reason for any failure
+ *
+ * \return Standard Pacemaker return code
+ * \note Nothing is changed unless the whole request is valid.
+ * \note The caller is responsible for freeing \p *reason.
+ */
+int
+pcmk__apply_log_control(const xmlNode *request, time_t now, char **reason)
+{
+    const char *value = NULL;
+    unsigned int level = 0;
+    guint ttl_s = 0;
+    int rc = pcmk_rc_ok;
+
+    CRM_CHECK(pcmk__xe_is(request, PCMK__XE_LOG_CONTROL) && (reason != NULL),
+              return EINVAL);
+
+    if (get_ttl(request, 0, &ttl_s) != pcmk_rc_ok) {
+        *reason = crm_strdup_printf("Invalid time-to-live '%s'",
+                                    crm_element_value(request, PCMK__XA_TTL));
+        return pcmk_rc_bad_input;
+    }
+
+    value = crm_element_value(request, PCMK__XA_LOG_LEVEL);
+    if ((value != NULL)
+        && (pcmk__parse_log_level(value, &level) != pcmk_rc_ok)) {
+        *reason = crm_strdup_printf("Invalid log level '%s'", value);
+        return pcmk_rc_bad_input;
+    }
+
+    // Validate everything before changing anything
+    for (const xmlNode *filter = pcmk__xe_first_child(request,
+                                                      PCMK__XE_LOG_FILTER,
+                                                      NULL, NULL);
+         filter != NULL; filter = pcmk__xe_next(filter, PCMK__XE_LOG_FILTER)) {
+
+        const char *action = crm_element_value(filter, PCMK_XA_ACTION);
+        const char *type_s = crm_element_value(filter, PCMK_XA_TYPE);
+        enum pcmk__log_filter_type type = pcmk__log_filter_function;
+        guint filter_ttl = 0;
+
+        if (pcmk__str_eq(action, "clear", pcmk__str_none)) {
+            continue;
+        }
+        if (!pcmk__str_any_of(action, "add", "remove", NULL)) {
+            *reason = crm_strdup_printf("Invalid trace filter action '%s'",
+                                        pcmk__s(action, ""));
+            return pcmk_rc_bad_input;
+        }
+        if (pcmk__parse_log_filter_type(type_s, &type) != pcmk_rc_ok) {
+            *reason = crm_strdup_printf("Invalid trace filter type '%s'",
+                                        pcmk__s(type_s, ""));
+            return pcmk_rc_bad_input;
+        }
+        if (pcmk__str_empty(crm_element_value(filter, PCMK_XA_NAME))) {
+            *reason = crm_strdup_printf("Trace filter of type %s has no name",
+                                        type_s);
+            return pcmk_rc_bad_input;
+        }
+        if (get_ttl(filter, ttl_s, &filter_ttl) != pcmk_rc_ok) {
+            *reason = crm_strdup_printf("Invalid time-to-live '%s'",
+                                        crm_element_value(filter,
+                                                          PCMK__XA_TTL));
+            return pcmk_rc_bad_input;
+        }
+    }
+
+    for (const xmlNode *filter = pcmk__xe_first_child(request,
+                                                      PCMK__XE_LOG_FILTER,
+                                                      NULL, NULL);
+         filter != NULL; filter = pcmk__xe_next(filter, PCMK__XE_LOG_FILTER)) {
+
+        const char *action = crm_element_value(filter, PCMK_XA_ACTION);
+        const char *name = crm_element_value(filter, PCMK_XA_NAME);
+        enum pcmk__log_filter_type type = pcmk__log_filter_function;
+        guint filter_ttl = 0;
+
+        if (pcmk__str_eq(action, "clear", pcmk__str_none)) {
+            pcmk__clear_log_filters();
+            continue;
+        }
+
+        pcmk__parse_log_filter_type(crm_element_value(filter, PCMK_XA_TYPE),
+                                    &type);
+        if (pcmk__str_eq(action, "add", pcmk__str_none)) {
+            get_ttl(filter, ttl_s, &filter_ttl);
+            pcmk__add_log_filter(type, name, filter_ttl, now);
+
+        } else if (pcmk__remove_log_filter(type, name) != pcmk_rc_ok) {
+            // Keep going, so the rest of the request still takes effect
+            *reason = crm_strdup_printf("No trace filter for %s %s",
+                                        pcmk__log_filter_type_text(type),
+                                        name);
+            rc = ENXIO;
+        }
+    }
+
+    if (value != NULL) {
+        pcmk__override_log_level(level, ttl_s, now);
+    }
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Add current run-time log settings to XML
+ *
+ * \param[in,out] xml  XML to add \c PCMK__XA_LOG_LEVEL (and \c PCMK__XA_TTL if
+ *                     the level is temporary) and \c PCMK__XE_LOG_FILTER
+ *                     children to
+ * \param[in]     now  Current time
+ */
+void
+pcmk__log_control_state(xmlNode *xml, time_t now)
+{
+    crm_xml_add(xml, PCMK__XA_LOG_LEVEL,
+                pcmk__log_level_text(get_crm_log_level()));
+    if (level_expires != 0) {
+        crm_xml_add_ll(xml, PCMK__XA_TTL,
+                       (long long) QB_MAX(level_expires - now, 0));
+    }
+
+    for (const GList *iter = log_filters; iter != NULL; iter = iter->next) {
+        const log_filter_t *filter = iter->data;
+        xmlNode *child = pcmk__xe_create(xml, PCMK__XE_LOG_FILTER);
+
+        crm_xml_add(child, PCMK_XA_TYPE,
+                    pcmk__log_filter_type_text(filter->type));
+        crm_xml_add(child, PCMK_XA_NAME, filter->pattern);
+        if (filter->expires != 0) {
+            crm_xml_add_ll(child, PCMK__XA_TTL,
+                           (long long) QB_MAX(filter->expires - now, 0));
+        }
+    }
+}
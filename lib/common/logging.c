@@ -15,6 +15,7 @@
 #include <sys/stat.h>
 #include <sys/utsname.h>
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <string.h>
@@ -33,6 +34,8 @@
 #include <crm/crm.h>
 #include <crm/common/mainloop.h>
 
+#include "crmcommon_private.h"
+
 // Use high-resolution (millisecond) timestamps if libqb supports them
 #ifdef QB_FEATURE_LOG_HIRES_TIMESTAMPS
 #define TIMESTAMP_FORMAT_SPEC "%%T"
@@ -59,6 +62,36 @@ pcmk__config_warning_func pcmk__config_warning_handler = NULL;
 void *pcmk__config_error_context = NULL;
 void *pcmk__config_warning_context = NULL;
 
+// Number of threads currently capturing their log messages
+int pcmk__log_capturing = 0;
+
+// Where the current thread's captured messages go (NULL if not capturing)
+static GPrivate log_capture = G_PRIVATE_INIT(NULL);
+
+// What a captured message is
+enum capture_kind {
+    capture_log,            // Ordinary log message
+    capture_config_error,   // Configuration error
+    capture_config_warning, // Configuration warning
+    capture_sched_error,    // Scheduler input error
+    capture_sched_warning,  // Scheduler input warning
+    capture_xml,            // XML to log line by line
+    capture_patchset,       // XML patchset to log line by line
+};
+
+// Log message captured from a thread, to be logged by the main thread
+typedef struct {
+    enum capture_kind kind;
+    const char *file;
+    const char *function;
+    uint32_t line;
+    uint32_t tags;
+    uint8_t level;
+    char *text;                     // Formatted message (or XML prefix)
+    xmlNode *xml;                   // Copy of XML (for XML kinds)
+    pcmk_scheduler_t *scheduler;    // Scheduler data (for scheduler kinds)
+} captured_log_t;
+
 static gboolean crm_tracing_enabled(void);
 
 static void
@@ -625,6 +658,9 @@ crm_log_filter_source(int source, const char *trace_files, const char *trace_fns
                && cs->tags != 0
                && cs->tags != crm_trace_nonlog && g_quark_to_string(cs->tags) != NULL) {
         qb_bit_set(cs->targets, source);
+    } else if (pcmk__log_filter_matches(cs)) {
+        // Trace filter added at run time
+        qb_bit_set(cs->targets, source);
     }
 }
 
@@ -1041,6 +1077,8 @@ crm_log_init(const char *entity, uint8_t level, gboolean daemon, gboolean to_std
         mainloop_add_signal(SIGUSR2, crm_disable_blackbox);
         mainloop_add_signal(SIGTRAP, crm_trigger_blackbox);
 
+        pcmk__start_metrics_export(entity);
+
     } else if (!quiet) {
         crm_log_args(argc, argv);
     }
@@ -1167,6 +1205,310 @@ pcmk__cli_init_logging(const char *name, unsigned int verbosity)
     }
 }
 
+/*!
+ * \internal
+ * \brief Get where the current thread's captured log messages go
+ *
+ * \return List to prepend captured messages to, or NULL if the current thread
+ *         is not capturing its log messages
+ */
+static GList **
+capture_list(void)
+{
+    if (g_atomic_int_get(&pcmk__log_capturing) == 0) {
+        return NULL;
+    }
+    return g_private_get(&log_capture);
+}
+
+/*!
+ * \internal
+ * \brief Capture a log message of a given kind
+ *
+ * \param[in]     kind       What kind of message this is
+ * \param[in,out] scheduler  Scheduler data (for scheduler kinds)
+ * \param[in]     file       Source file name of log call
+ * \param[in]     function   Source function name of log call
+ * \param[in]     line       Source line number of log call
+ * \param[in]     tags       Log tags
+ * \param[in]     level      Priority at which to log the message
+ * \param[in]     format     printf(3)-style format string
+ * \param[in]     ap         Arguments for \p format
+ *
+ * \return Newly captured message (or NULL if the current thread is not
+ *         capturing its log messages)
+ */
+static captured_log_t *
+capture_va(enum capture_kind kind, pcmk_scheduler_t *scheduler,
+           const char *file, const char *function, uint32_t line,
+           uint32_t tags, uint8_t level, const char *format, va_list ap)
+{
+    GList **captured = capture_list();
+    captured_log_t *entry = NULL;
+
+    if (captured == NULL) {
+        return NULL;
+    }
+
+    entry = pcmk__assert_alloc(1, sizeof(captured_log_t));
+    entry->kind = kind;
+    entry->scheduler = scheduler;
+    entry->file = file;
+    entry->function = function;
+    entry->line = line;
+    entry->tags = tags;
+    entry->level = level;
+    if (format != NULL) {
+        pcmk__assert(vasprintf(&entry->text, format, ap) >= 0);
+    }
+    *captured = g_list_prepend(*captured, entry);
+    return entry;
+}
+
+/*!
+ * \internal
+ * \brief Capture XML to be logged, if the current thread is capturing
+ *
+ * \param[in] kind      \c capture_xml or \c capture_patchset
+ * \param[in] file      Source file name of log call
+ * \param[in] function  Source function name of log call
+ * \param[in] line      Source line number of log call
+ * \param[in] tags      Log tags
+ * \param[in] level     Priority at which to log the XML
+ * \param[in] text      Prefix for each line (may be NULL)
+ * \param[in] xml       XML to log (may be NULL)
+ *
+ * \return \c true if the XML was captured, otherwise \c false
+ */
+static bool
+capture_xml_as(enum capture_kind kind, const char *file, const char *function,
+               uint32_t line, uint32_t tags, uint8_t level, const char *text,
+               const xmlNode *xml)
+{
+    GList **captured = capture_list();
+    captured_log_t *entry = NULL;
+
+    if (captured == NULL) {
+        return false;
+    }
+
+    entry = pcmk__assert_alloc(1, sizeof(captured_log_t));
+    entry->kind = kind;
+    entry->file = file;
+    entry->function = function;
+    entry->line = line;
+    entry->tags = tags;
+    entry->level = level;
+    entry->text = pcmk__str_copy(text);
+    if (xml != NULL) {
+        entry->xml = pcmk__xml_copy(NULL, (xmlNode *) xml);
+    }
+    *captured = g_list_prepend(*captured, entry);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Check whether the current thread is capturing its log messages
+ *
+ * \return \c true if the current thread is capturing its log messages,
+ *         otherwise \c false
+ * \note Do not call this function directly. It should be called only from the
+ *       logging macros.
+ */
+bool
+pcmk__capturing_logs(void)
+{
+    return capture_list() != NULL;
+}
+
+/*!
+ * \internal
+ * \brief Capture a log message instead of logging it
+ *
+ * \param[in] file      Source file name of log call
+ * \param[in] function  Source function name of log call
+ * \param[in] line      Source line number of log call
+ * \param[in] tags      Log tags
+ * \param[in] level     Priority at which to log the message
+ * \param[in] format    printf(3)-style format string
+ * \param[in] ...       Arguments for \p format
+ *
+ * \note Do not call this function directly. It should be called only from the
+ *       logging macros, when \c pcmk__capturing_logs() returns \c true.
+ */
+void
+pcmk__log_capture(const char *file, const char *function, uint32_t line,
+                  uint32_t tags, uint8_t level, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    capture_va(capture_log, NULL, file, function, line, tags, level, format,
+               ap);
+    va_end(ap);
+}
+
+/*!
+ * \internal
+ * \brief Capture a configuration error or warning instead of reporting it
+ *
+ * \param[in] error     If \c true, this is an error, otherwise a warning
+ * \param[in] file      Source file name of report
+ * \param[in] function  Source function name of report
+ * \param[in] line      Source line number of report
+ * \param[in] format    printf(3)-style format string
+ * \param[in] ...       Arguments for \p format
+ *
+ * \note Do not call this function directly. It should be called only from the
+ *       \c pcmk__config_err() and \c pcmk__config_warn() macros.
+ */
+void
+pcmk__log_capture_config(bool error, const char *file, const char *function,
+                         uint32_t line, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    capture_va((error? capture_config_error : capture_config_warning), NULL,
+               file, function, line, 0, (error? LOG_ERR : LOG_WARNING),
+               format, ap);
+    va_end(ap);
+}
+
+/*!
+ * \internal
+ * \brief Capture a scheduler input error or warning instead of reporting it
+ *
+ * \param[in,out] scheduler  Scheduler data to flag when message is replayed
+ * \param[in]     error      If \c true, this is an error, otherwise a warning
+ * \param[in]     file       Source file name of report
+ * \param[in]     function   Source function name of report
+ * \param[in]     line       Source line number of report
+ * \param[in]     format     printf(3)-style format string
+ * \param[in]     ...        Arguments for \p format
+ *
+ * \note Do not call this function directly. It should be called only from the
+ *       \c pcmk__sched_err() and \c pcmk__sched_warn() macros.
+ */
+void
+pcmk__log_capture_sched(pcmk_scheduler_t *scheduler, bool error,
+                        const char *file, const char *function, uint32_t line,
+                        const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    capture_va((error? capture_sched_error : capture_sched_warning), scheduler,
+               file, function, line, 0, (error? LOG_ERR : LOG_WARNING),
+               format, ap);
+    va_end(ap);
+}
+
+/*!
+ * \internal
+ * \brief Start or stop capturing the current thread's log messages
+ *
+ * While a thread is capturing, its log messages, configuration errors and
+ * warnings, and scheduler input errors and warnings are recorded instead of
+ * being logged or reported, so that a thread other than the main thread does
+ * not use the (single-threaded) logging library or shared state. The main
+ * thread later replays them with \c pcmk__replay_logs().
+ *
+ * \param[in,out] captured  Where to record captured messages (or NULL to stop
+ *                          capturing)
+ */
+void
+pcmk__capture_logs(GList **captured)
+{
+    bool was_capturing = (g_private_get(&log_capture) != NULL);
+
+    g_private_set(&log_capture, captured);
+    if ((captured != NULL) && !was_capturing) {
+        g_atomic_int_inc(&pcmk__log_capturing);
+    } else if ((captured == NULL) && was_capturing) {
+        (void) g_atomic_int_dec_and_test(&pcmk__log_capturing);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Log and free messages captured by \c pcmk__capture_logs()
+ *
+ * Messages are handled in the order they were captured, as if the thread that
+ * captured them had logged them directly.
+ *
+ * \param[in,out] captured  Captured messages
+ */
+void
+pcmk__replay_logs(GList *captured)
+{
+    captured = g_list_reverse(captured);
+    for (GList *iter = captured; iter != NULL; iter = iter->next) {
+        captured_log_t *entry = iter->data;
+
+        switch (entry->kind) {
+            case capture_config_error:
+                pcmk__config_has_error = true;
+                if (pcmk__config_error_handler != NULL) {
+                    pcmk__config_error_handler(pcmk__config_error_context,
+                                               "%s", entry->text);
+                    break;
+                }
+                do_crm_log_alias(entry->level, entry->file, entry->function,
+                                 entry->line, "%s", entry->text);
+                break;
+
+            case capture_config_warning:
+                pcmk__config_has_warning = true;
+                if (pcmk__config_warning_handler != NULL) {
+                    pcmk__config_warning_handler(pcmk__config_warning_context,
+                                                 "%s", entry->text);
+                    break;
+                }
+                do_crm_log_alias(entry->level, entry->file, entry->function,
+                                 entry->line, "%s", entry->text);
+                break;
+
+            case capture_sched_error:
+                pcmk__set_scheduler_flags(entry->scheduler,
+                                          pcmk__sched_processing_error);
+                do_crm_log_alias(entry->level, entry->file, entry->function,
+                                 entry->line, "%s", entry->text);
+                break;
+
+            case capture_sched_warning:
+                pcmk__set_scheduler_flags(entry->scheduler,
+                                          pcmk__sched_processing_warning);
+                do_crm_log_alias(entry->level, entry->file, entry->function,
+                                 entry->line, "%s", entry->text);
+                break;
+
+            case capture_xml:
+                pcmk_log_xml_as(entry->file, entry->function, entry->line,
+                                entry->tags, entry->level, entry->text,
+                                entry->xml);
+                break;
+
+            case capture_patchset:
+                pcmk__log_xml_patchset_as(entry->file, entry->function,
+                                          entry->line, entry->tags,
+                                          entry->level, entry->xml);
+                break;
+
+            default:
+                qb_log_from_external_source(entry->function, entry->file,
+                                            "%s", entry->level, entry->line,
+                                            entry->tags, entry->text);
+                break;
+        }
+        free(entry->text);
+        pcmk__xml_free(entry->xml);
+        free(entry);
+    }
+    g_list_free(captured);
+}
+
 /*!
  * \brief Log XML line-by-line in a formatted fashion
  *
@@ -1186,6 +1528,11 @@ void
 pcmk_log_xml_as(const char *file, const char *function, uint32_t line,
                 uint32_t tags, uint8_t level, const char *text, const xmlNode *xml)
 {
+    if (capture_xml_as(capture_xml, file, function, line, tags, level, text,
+                       xml)) {
+        return;
+    }
+
     if (xml == NULL) {
         do_crm_log(level, "%s%sNo data to dump as XML",
                    pcmk__s(text, ""), pcmk__str_empty(text)? "" : " ");
@@ -1223,6 +1570,14 @@ void
 pcmk__log_xml_changes_as(const char *file, const char *function, uint32_t line,
                          uint32_t tags, uint8_t level, const xmlNode *xml)
 {
+    /* The change tracking information is not copied, so a captured message
+     * shows the whole XML instead
+     */
+    if (capture_xml_as(capture_xml, file, function, line, tags, level, NULL,
+                       xml)) {
+        return;
+    }
+
     if (xml == NULL) {
         do_crm_log(level, "No XML to dump");
         return;
@@ -1254,6 +1609,11 @@ void
 pcmk__log_xml_patchset_as(const char *file, const char *function, uint32_t line,
                           uint32_t tags, uint8_t level, const xmlNode *patchset)
 {
+    if (capture_xml_as(capture_patchset, file, function, line, tags, level,
+                       NULL, patchset)) {
+        return;
+    }
+
     if (patchset == NULL) {
         do_crm_log(level, "No patchset to dump");
         return;
@@ -9,11 +9,14 @@
 
 #include <crm_internal.h>
 
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 #include <signal.h>
 #include <errno.h>
 
+#include <poll.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
 
 #include <crm/crm.h>
@@ -32,6 +35,9 @@ struct mainloop_child_s {
 
     enum mainloop_child_flags flags;
 
+    // Resource usage, once reaped (all zero if not available)
+    pcmk__rusage_t rusage;
+
     /* Called when a process dies */
     void (*callback) (mainloop_child_t * p, pid_t pid, int core, int signo, int exitcode);
 };
@@ -413,6 +419,9 @@ mainloop_destroy_signal(int sig)
 
 static qb_array_t *gio_map = NULL;
 
+// Key = libqb dispatch data (such as a connection), value = adaptor in gio_map
+static GHashTable *gio_by_data = NULL;
+
 void
 mainloop_cleanup(void) 
 {
@@ -420,6 +429,10 @@ mainloop_cleanup(void)
         qb_array_free(gio_map);
         gio_map = NULL;
     }
+    if (gio_by_data != NULL) {
+        g_hash_table_destroy(gio_by_data);
+        gio_by_data = NULL;
+    }
 
     for (int sig = 0; sig < NSIG; ++sig) {
         mainloop_destroy_signal_entry(sig);
@@ -431,6 +444,7 @@ mainloop_cleanup(void)
  */
 struct gio_to_qb_poll {
     int32_t is_used;
+    int32_t fd;
     guint source;
     int32_t events;
     void *data;
@@ -464,6 +478,10 @@ gio_poll_destroy(gpointer data)
     if (adaptor->is_used == 0) {
         crm_trace("Marking adaptor %p unused", adaptor);
         adaptor->source = 0;
+        if ((gio_by_data != NULL)
+            && (g_hash_table_lookup(gio_by_data, adaptor->data) == adaptor)) {
+            g_hash_table_remove(gio_by_data, adaptor->data);
+        }
     }
 }
 
@@ -545,10 +563,16 @@ gio_poll_dispatch_update(enum qb_loop_priority p, int32_t fd, int32_t evts,
     evts |= (G_IO_HUP | G_IO_NVAL | G_IO_ERR);
 
     adaptor->fn = fn;
+    adaptor->fd = fd;
     adaptor->events = evts;
     adaptor->data = data;
     adaptor->p = p;
     adaptor->is_used++;
+
+    if (gio_by_data == NULL) {
+        gio_by_data = g_hash_table_new(NULL, NULL);
+    }
+    g_hash_table_insert(gio_by_data, data, adaptor);
     adaptor->source =
         g_io_add_watch_full(channel, conv_prio_libqb2glib(p), evts,
                             gio_read_socket, adaptor, gio_poll_destroy);
@@ -601,6 +625,39 @@ gio_poll_dispatch_del(int32_t fd)
     return 0;
 }
 
+/*!
+ * \internal
+ * \brief Check whether an IPC server connection has an unread request waiting
+ *
+ * \param[in] qbc  libqb IPC server connection to check
+ *
+ * \return true if at least one request from \p qbc is waiting to be
+ *         dispatched, otherwise false
+ *
+ * \note This does not read or dispatch anything, so it is safe to call while
+ *       a request from the same connection is being processed. libqb notifies
+ *       the server of each request via the connection's socket (even for
+ *       shared-memory IPC), so a readable socket means an unread request.
+ */
+bool
+pcmk__mainloop_ipc_pending(const qb_ipcs_connection_t *qbc)
+{
+    const struct gio_to_qb_poll *adaptor = NULL;
+    struct pollfd pfd = { .events = POLLIN, };
+
+    if ((qbc == NULL) || (gio_by_data == NULL)) {
+        return false;
+    }
+
+    adaptor = g_hash_table_lookup(gio_by_data, qbc);
+    if ((adaptor == NULL) || (adaptor->is_used == 0)) {
+        return false;
+    }
+
+    pfd.fd = adaptor->fd;
+    return (poll(&pfd, 1, 0) > 0) && pcmk_is_set(pfd.revents, POLLIN);
+}
+
 struct qb_ipcs_poll_handlers gio_poll_funcs = {
     .job_add = NULL,
     .dispatch_add = gio_poll_dispatch_add,
@@ -1042,6 +1099,89 @@ mainloop_clear_child_userdata(mainloop_child_t * child)
     child->privatedata = NULL;
 }
 
+/*!
+ * \internal
+ * \brief Get the resource usage of a reaped child process
+ *
+ * \param[in] child  Child process to check
+ *
+ * \return Resource usage of \p child (all zero if not reaped or not available)
+ * \note This is meaningful only from within the child's callback.
+ */
+const pcmk__rusage_t *
+pcmk__mainloop_child_rusage(const mainloop_child_t *child)
+{
+    pcmk__assert(child != NULL);
+    return &(child->rusage);
+}
+
+#ifdef HAVE_WAIT4
+// Convert a struct timeval to milliseconds, capped at UINT_MAX
+static unsigned int
+timeval2ms(const struct timeval *tv)
+{
+    long long ms = (tv->tv_sec * 1000LL) + (tv->tv_usec / 1000);
+
+    if (ms <= 0) {
+        return 0;
+    }
+    return (ms > UINT_MAX)? UINT_MAX : (unsigned int) ms;
+}
+
+// Convert a long to unsigned int, clamped to [0, UINT_MAX]
+static unsigned int
+long2uint(long value)
+{
+    if (value <= 0) {
+        return 0;
+    }
+    return ((unsigned long) value > UINT_MAX)? UINT_MAX : (unsigned int) value;
+}
+#endif // HAVE_WAIT4
+
+/*!
+ * \internal
+ * \brief Wait for a child process, collecting its resource usage if possible
+ *
+ * This is a drop-in replacement for waitpid() that additionally fills in the
+ * resource usage (including that of any descendants it waited for) of a child
+ * that was reaped, using wait4() where available.
+ *
+ * \param[in]  pid      Process ID to wait for (as for waitpid())
+ * \param[out] status   Where to store exit status (as for waitpid())
+ * \param[in]  options  Wait options (as for waitpid())
+ * \param[out] usage    Where to store resource usage (all zero if the child
+ *                      was not reaped or usage is not available)
+ *
+ * \return Same as waitpid()
+ */
+pid_t
+pcmk__wait_rusage(pid_t pid, int *status, int options, pcmk__rusage_t *usage)
+{
+    pid_t rc = 0;
+#ifdef HAVE_WAIT4
+    struct rusage ru;
+#endif
+
+    pcmk__assert(usage != NULL);
+    memset(usage, 0, sizeof(pcmk__rusage_t));
+
+#ifdef HAVE_WAIT4
+    memset(&ru, 0, sizeof(ru));
+    rc = wait4(pid, status, options, &ru);
+    if (rc > 0) {
+        usage->user_ms = timeval2ms(&(ru.ru_utime));
+        usage->system_ms = timeval2ms(&(ru.ru_stime));
+        usage->max_rss_kb = long2uint(ru.ru_maxrss); // KiB on Linux and BSDs
+        usage->blocks_in = long2uint(ru.ru_inblock);
+        usage->blocks_out = long2uint(ru.ru_oublock);
+    }
+#else
+    rc = waitpid(pid, status, options);
+#endif
+    return rc;
+}
+
 /* good function name */
 static void
 child_free(mainloop_child_t *child)
@@ -1112,7 +1252,7 @@ child_waitpid(mainloop_child_t *child, int flags)
     int exitcode = 0;
     bool callback_needed = true;
 
-    rc = waitpid(child->pid, &status, flags);
+    rc = pcmk__wait_rusage(child->pid, &status, flags, &(child->rusage));
     if (rc == 0) { // WNOHANG in flags, and child status is not available
         crm_trace("Child process %d (%s) still active",
                   child->pid, child->desc);
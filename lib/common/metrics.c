@@ -0,0 +1,525 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <errno.h>
+#include <math.h>               // ceil()
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>             // unlink()
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/common/metrics_internal.h>
+#include <crm/common/xml.h>
+
+// Default interval between exports of metrics to a file, in seconds
+#define DEFAULT_EXPORT_INTERVAL 60
+
+// Quantiles reported for histograms
+static const double quantiles[] = { 0.5, 0.9, 0.99 };
+static const char *quantile_names[] = { PCMK_XA_P50, PCMK_XA_P90, PCMK_XA_P99 };
+
+/* All registered metrics. The list is protected by a lock, but that is taken
+ * only when a metric is first used, and when metrics are exported.
+ */
+G_LOCK_DEFINE_STATIC(registry);
+static GList *registry = NULL;
+
+static char *export_directory = NULL;
+static char *export_daemon = NULL;
+
+static const char *
+metric_type_text(enum pcmk__metric_type type)
+{
+    switch (type) {
+        case pcmk__metric_counter:
+            return "counter";
+        case pcmk__metric_gauge:
+            return "gauge";
+        case pcmk__metric_histogram:
+            // Exported like a Prometheus summary (quantiles, sum, and count)
+            return "summary";
+    }
+    return "untyped";
+}
+
+// Register a metric the first time it is used
+static void
+ensure_registered(pcmk__metric_t *metric)
+{
+    if (g_once_init_enter(&(metric->registered))) {
+        if (metric->type == pcmk__metric_histogram) {
+            metric->buckets = pcmk__assert_alloc(PCMK__HISTOGRAM_BUCKETS,
+                                                 sizeof(uint64_t));
+        }
+        G_LOCK(registry);
+        registry = g_list_prepend(registry, metric);
+        G_UNLOCK(registry);
+        g_once_init_leave(&(metric->registered), 1);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Add to a counter or gauge
+ *
+ * \param[in,out] metric  Metric to update
+ * \param[in]     delta   Amount to add (must not be negative for counters)
+ */
+void
+pcmk__metric_add(pcmk__metric_t *metric, int64_t delta)
+{
+    CRM_CHECK((metric != NULL) && (metric->type != pcmk__metric_histogram),
+              return);
+    CRM_CHECK((delta >= 0) || (metric->type == pcmk__metric_gauge), return);
+
+    ensure_registered(metric);
+    __atomic_fetch_add(&(metric->value), delta, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \internal
+ * \brief Set the value of a gauge
+ *
+ * \param[in,out] metric  Gauge to update
+ * \param[in]     value   New value
+ */
+void
+pcmk__metric_set(pcmk__metric_t *metric, int64_t value)
+{
+    CRM_CHECK((metric != NULL) && (metric->type == pcmk__metric_gauge),
+              return);
+
+    ensure_registered(metric);
+    __atomic_store_n(&(metric->value), value, __ATOMIC_RELAXED);
+}
+
+/*!
+ * \internal
+ * \brief Add an observation to a histogram
+ *
+ * \param[in,out] metric  Histogram to update
+ * \param[in]     value   Observed value (for example, a duration in
+ *                        microseconds)
+ */
+void
+pcmk__metric_observe(pcmk__metric_t *metric, uint64_t value)
+{
+    uint64_t max = 0;
+
+    CRM_CHECK((metric != NULL) && (metric->type == pcmk__metric_histogram),
+              return);
+
+    ensure_registered(metric);
+    __atomic_fetch_add(&(metric->buckets[pcmk__histogram_bucket(value)]), 1,
+                       __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(metric->sum), value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&(metric->count), 1, __ATOMIC_RELAXED);
+
+    max = __atomic_load_n(&(metric->max), __ATOMIC_RELAXED);
+    while ((value > max)
+           && !__atomic_compare_exchange_n(&(metric->max), &max, value, true,
+                                           __ATOMIC_RELAXED,
+                                           __ATOMIC_RELAXED)) {
+        // max was updated with the current value, so just retry
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the current value of a metric
+ *
+ * \param[in] metric  Metric to check
+ *
+ * \return Value of \p metric if a counter or gauge, or number of observations
+ *         if a histogram
+ */
+int64_t
+pcmk__metric_value(const pcmk__metric_t *metric)
+{
+    CRM_CHECK(metric != NULL, return 0);
+
+    if (metric->type == pcmk__metric_histogram) {
+        return (int64_t) __atomic_load_n(&(metric->count), __ATOMIC_RELAXED);
+    }
+    return __atomic_load_n(&(metric->value), __ATOMIC_RELAXED);
+}
+
+/*!
+ * \internal
+ * \brief Get the histogram bucket that a value belongs in
+ *
+ * Values below 2^PCMK__HISTOGRAM_SUB_BITS each get their own bucket. Above
+ * that, each power of two is split into 2^PCMK__HISTOGRAM_SUB_BITS buckets of
+ * equal width.
+ *
+ * \param[in] value  Value to check
+ *
+ * \return Index of bucket for \p value
+ */
+unsigned int
+pcmk__histogram_bucket(uint64_t value)
+{
+    unsigned int msb = 0;
+    unsigned int shift = 0;
+
+    if (value < (UINT64_C(1) << PCMK__HISTOGRAM_SUB_BITS)) {
+        return (unsigned int) value;
+    }
+
+    msb = 63 - (unsigned int) __builtin_clzll(value);
+    shift = msb - PCMK__HISTOGRAM_SUB_BITS;
+    return ((shift + 1) << PCMK__HISTOGRAM_SUB_BITS)
+           + (unsigned int) ((value >> shift)
+                             & ((1U << PCMK__HISTOGRAM_SUB_BITS) - 1));
+}
+
+/*!
+ * \internal
+ * \brief Get the smallest value that belongs in a histogram bucket
+ *
+ * \param[in] bucket  Index of bucket
+ *
+ * \return Smallest value in \p bucket
+ */
+uint64_t
+pcmk__histogram_bucket_min(unsigned int bucket)
+{
+    unsigned int group = bucket >> PCMK__HISTOGRAM_SUB_BITS;
+    uint64_t sub = bucket & ((1U << PCMK__HISTOGRAM_SUB_BITS) - 1);
+
+    CRM_CHECK(bucket < PCMK__HISTOGRAM_BUCKETS, return UINT64_MAX);
+
+    if (group == 0) {
+        return sub;
+    }
+    return ((UINT64_C(1) << PCMK__HISTOGRAM_SUB_BITS) + sub) << (group - 1);
+}
+
+/*!
+ * \internal
+ * \brief Get the largest value that belongs in a histogram bucket
+ *
+ * \param[in] bucket  Index of bucket
+ *
+ * \return Largest value in \p bucket
+ */
+uint64_t
+pcmk__histogram_bucket_max(unsigned int bucket)
+{
+    unsigned int group = bucket >> PCMK__HISTOGRAM_SUB_BITS;
+
+    CRM_CHECK(bucket < PCMK__HISTOGRAM_BUCKETS, return UINT64_MAX);
+
+    if (group == 0) {
+        return bucket;
+    }
+    return pcmk__histogram_bucket_min(bucket) + (UINT64_C(1) << (group - 1))
+           - 1;
+}
+
+/*!
+ * \internal
+ * \brief Estimate a quantile of the values observed by a histogram
+ *
+ * \param[in] metric    Histogram to check
+ * \param[in] quantile  Quantile to estimate (between 0 and 1)
+ *
+ * \return Upper bound of the bucket containing \p quantile (but no more than
+ *         the largest observed value), or 0 if nothing has been observed
+ */
+uint64_t
+pcmk__metric_quantile(const pcmk__metric_t *metric, double quantile)
+{
+    uint64_t count = 0;
+    uint64_t target = 0;
+    uint64_t seen = 0;
+    uint64_t max = 0;
+
+    CRM_CHECK((metric != NULL) && (metric->type == pcmk__metric_histogram)
+              && (quantile >= 0.0) && (quantile <= 1.0), return 0);
+
+    if (metric->buckets == NULL) {
+        return 0;
+    }
+
+    /* Buckets may be updated while we look at them, so count the observations
+     * from the buckets themselves rather than using metric->count.
+     */
+    for (unsigned int i = 0; i < PCMK__HISTOGRAM_BUCKETS; i++) {
+        count += __atomic_load_n(&(metric->buckets[i]), __ATOMIC_RELAXED);
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    target = QB_MAX((uint64_t) ceil(quantile * (double) count), 1);
+    max = __atomic_load_n(&(metric->max), __ATOMIC_RELAXED);
+
+    for (unsigned int i = 0; i < PCMK__HISTOGRAM_BUCKETS; i++) {
+        seen += __atomic_load_n(&(metric->buckets[i]), __ATOMIC_RELAXED);
+        if (seen >= target) {
+            return QB_MIN(pcmk__histogram_bucket_max(i), max);
+        }
+    }
+    return max;
+}
+
+static gint
+compare_metric_names(gconstpointer a, gconstpointer b)
+{
+    return strcmp(((const pcmk__metric_t *) a)->name,
+                  ((const pcmk__metric_t *) b)->name);
+}
+
+// Get a copy of the registry sorted by name (caller must free with g_list_free)
+static GList *
+sorted_metrics(void)
+{
+    GList *metrics = NULL;
+
+    G_LOCK(registry);
+    metrics = g_list_copy(registry);
+    G_UNLOCK(registry);
+    return g_list_sort(metrics, compare_metric_names);
+}
+
+/*!
+ * \internal
+ * \brief Add all registered metrics to XML
+ *
+ * \param[in,out] parent  XML to add a \c PCMK_XE_METRIC child to for each
+ *                        metric
+ */
+void
+pcmk__metrics_xml(xmlNode *parent)
+{
+    GList *metrics = sorted_metrics();
+
+    for (const GList *iter = metrics; iter != NULL; iter = iter->next) {
+        const pcmk__metric_t *metric = iter->data;
+        xmlNode *xml = pcmk__xe_create(parent, PCMK_XE_METRIC);
+
+        crm_xml_add(xml, PCMK_XA_NAME, metric->name);
+        crm_xml_add(xml, PCMK_XA_TYPE, metric_type_text(metric->type));
+        crm_xml_add(xml, PCMK_XA_DESCRIPTION, metric->help);
+
+        if (metric->type != pcmk__metric_histogram) {
+            crm_xml_add_ll(xml, PCMK_XA_VALUE, pcmk__metric_value(metric));
+            continue;
+        }
+
+        crm_xml_add_ll(xml, PCMK_XA_COUNT, pcmk__metric_value(metric));
+        crm_xml_add_ll(xml, PCMK_XA_SUM,
+                       (long long) __atomic_load_n(&(metric->sum),
+                                                   __ATOMIC_RELAXED));
+        crm_xml_add_ll(xml, PCMK_XA_MAX,
+                       (long long) __atomic_load_n(&(metric->max),
+                                                   __ATOMIC_RELAXED));
+        for (int i = 0; i < PCMK__NELEM(quantiles); i++) {
+            crm_xml_add_ll(xml, quantile_names[i],
+                           (long long) pcmk__metric_quantile(metric,
+                                                             quantiles[i]));
+        }
+    }
+    g_list_free(metrics);
+}
+
+/*!
+ * \internal
+ * \brief Format all registered metrics as Prometheus text exposition
+ *
+ * \param[in] daemon  Daemon name to use as the value of a "daemon" label
+ *
+ * \return Newly allocated string with metrics
+ * \note The caller is responsible for freeing the result using \c free().
+ */
+char *
+pcmk__metrics_text(const char *daemon)
+{
+    GString *text = g_string_sized_new(1024);
+    GList *metrics = sorted_metrics();
+    char *result = NULL;
+
+    daemon = pcmk__s(daemon, crm_system_name);
+
+    for (const GList *iter = metrics; iter != NULL; iter = iter->next) {
+        const pcmk__metric_t *metric = iter->data;
+
+        g_string_append_printf(text, "# HELP pacemaker_%s %s\n"
+                               "# TYPE pacemaker_%s %s\n",
+                               metric->name, pcmk__s(metric->help, ""),
+                               metric->name, metric_type_text(metric->type));
+
+        if (metric->type != pcmk__metric_histogram) {
+            g_string_append_printf(text,
+                                   "pacemaker_%s{daemon=\"%s\"} %lld\n",
+                                   metric->name, pcmk__s(daemon, ""),
+                                   (long long) pcmk__metric_value(metric));
+            continue;
+        }
+
+        for (int i = 0; i < PCMK__NELEM(quantiles); i++) {
+            g_string_append_printf(text,
+                                   "pacemaker_%s{daemon=\"%s\",quantile=\"%g\"}"
+                                   " %llu\n",
+                                   metric->name, pcmk__s(daemon, ""),
+                                   quantiles[i],
+                                   (unsigned long long)
+                                   pcmk__metric_quantile(metric,
+                                                         quantiles[i]));
+        }
+        g_string_append_printf(text,
+                               "pacemaker_%s_sum{daemon=\"%s\"} %llu\n"
+                               "pacemaker_%s_count{daemon=\"%s\"} %lld\n",
+                               metric->name, pcmk__s(daemon, ""),
+                               (unsigned long long)
+                               __atomic_load_n(&(metric->sum),
+                                               __ATOMIC_RELAXED),
+                               metric->name, pcmk__s(daemon, ""),
+                               (long long) pcmk__metric_value(metric));
+    }
+    g_list_free(metrics);
+
+    result = pcmk__str_copy(text->str);
+    g_string_free(text, TRUE);
+    return result;
+}
+
+/*!
+ * \internal
+ * \brief Write all registered metrics to a file
+ *
+ * The file is named after the daemon, with a ".prom" extension, and is
+ * replaced atomically, so that it may be read at any time (for example, by the
+ * Prometheus node exporter's textfile collector).
+ *
+ * \param[in] directory  Directory to write file in
+ * \param[in] daemon     Daemon name
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__write_metrics(const char *directory, const char *daemon)
+{
+    char *filename = NULL;
+    char *tmp_filename = NULL;
+    char *text = NULL;
+    FILE *fp = NULL;
+    int rc = pcmk_rc_ok;
+
+    CRM_CHECK(!pcmk__str_empty(directory) && !pcmk__str_empty(daemon),
+              return EINVAL);
+
+    filename = crm_strdup_printf("%s/%s.prom", directory, daemon);
+    tmp_filename = crm_strdup_printf("%s.tmp", filename);
+
+    fp = fopen(tmp_filename, "w");
+    if (fp == NULL) {
+        rc = errno;
+        goto done;
+    }
+
+    text = pcmk__metrics_text(daemon);
+    if (fputs(text, fp) == EOF) {
+        rc = errno;
+    }
+    if ((fclose(fp) != 0) && (rc == pcmk_rc_ok)) {
+        rc = errno;
+    }
+    if ((rc == pcmk_rc_ok) && (rename(tmp_filename, filename) < 0)) {
+        rc = errno;
+    }
+    if (rc != pcmk_rc_ok) {
+        unlink(tmp_filename);
+    }
+
+done:
+    if (rc != pcmk_rc_ok) {
+        crm_warn("Could not export metrics to %s: %s",
+                 filename, pcmk_rc_str(rc));
+    }
+    free(text);
+    free(tmp_filename);
+    free(filename);
+    return rc;
+}
+
+static gboolean
+export_metrics(gpointer user_data)
+{
+    pcmk__write_metrics(export_directory, export_daemon);
+    return G_SOURCE_CONTINUE;
+}
+
+/*!
+ * \internal
+ * \brief Periodically export metrics to a file, if configured
+ *
+ * If the \c PCMK__ENV_METRICS_DIRECTORY environment variable is set, write
+ * this daemon's metrics to a file in that directory every
+ * \c PCMK__ENV_METRICS_INTERVAL seconds, from the main loop.
+ *
+ * \param[in] daemon  Daemon name
+ */
+void
+pcmk__start_metrics_export(const char *daemon)
+{
+    const char *directory = pcmk__env_option(PCMK__ENV_METRICS_DIRECTORY);
+    const char *interval_s = pcmk__env_option(PCMK__ENV_METRICS_INTERVAL);
+    long long interval = DEFAULT_EXPORT_INTERVAL;
+
+    if (pcmk__str_empty(directory) || pcmk__str_empty(daemon)
+        || (export_directory != NULL)) {
+        return;
+    }
+
+    if ((interval_s != NULL)
+        && ((pcmk__scan_ll(interval_s, &interval, DEFAULT_EXPORT_INTERVAL)
+             != pcmk_rc_ok) || (interval <= 0LL) || (interval > G_MAXUINT))) {
+        crm_warn("Using default metrics export interval of %ds instead of "
+                 "invalid value '%s'", DEFAULT_EXPORT_INTERVAL, interval_s);
+        interval = DEFAULT_EXPORT_INTERVAL;
+    }
+
+    export_directory = pcmk__str_copy(directory);
+    export_daemon = pcmk__str_copy(daemon);
+    g_timeout_add_seconds((guint) interval, export_metrics, NULL);
+    crm_info("Exporting metrics to %s/%s.prom every %llds",
+             directory, daemon, interval);
+}
+
+/*!
+ * \internal
+ * \brief Reset all registered metrics to zero
+ */
+void
+pcmk__reset_metrics(void)
+{
+    G_LOCK(registry);
+    for (GList *iter = registry; iter != NULL; iter = iter->next) {
+        pcmk__metric_t *metric = iter->data;
+
+        __atomic_store_n(&(metric->value), 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&(metric->count), 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&(metric->sum), 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&(metric->max), 0, __ATOMIC_RELAXED);
+        if (metric->buckets != NULL) {
+            memset(metric->buckets, 0,
+                   PCMK__HISTOGRAM_BUCKETS * sizeof(uint64_t));
+        }
+    }
+    G_UNLOCK(registry);
+}
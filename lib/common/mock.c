@@ -459,4 +459,138 @@ __wrap_strdup(const char *s)
     return NULL;
 }
 
+
+/* qb_ipcs_event_sendv()
+ *
+ * If pcmk__mock_qb_ipcs_event_sendv is set to true, later calls to
+ * qb_ipcs_event_sendv() will not send anything and must be preceded by:
+ *
+ *     expect_*(__wrap_qb_ipcs_event_sendv, c[, ...]);
+ *     expect_*(__wrap_qb_ipcs_event_sendv, iov[, ...]);
+ *     expect_*(__wrap_qb_ipcs_event_sendv, iov_len[, ...]);
+ *     will_return(__wrap_qb_ipcs_event_sendv, errno_to_set);
+ *
+ * expect_* functions: https://api.cmocka.org/group__cmocka__param.html
+ *
+ * The mocked function will return the total size of the I/O vector if
+ * errno_to_set is 0, and -errno_to_set otherwise. If errno_to_set is 0 and
+ * pcmk__mock_qb_ipcs_event_sent is not NULL, the contents of the I/O vector
+ * will be appended to it as a GBytes object, so tests can examine exactly what
+ * would have been sent.
+ */
+
+bool pcmk__mock_qb_ipcs_event_sendv = false;
+GPtrArray *pcmk__mock_qb_ipcs_event_sent = NULL;
+
+ssize_t
+__wrap_qb_ipcs_event_sendv(qb_ipcs_connection_t *c, const struct iovec *iov,
+                           size_t iov_len)
+{
+    int err = 0;
+    ssize_t total = 0;
+
+    if (!pcmk__mock_qb_ipcs_event_sendv) {
+        return __real_qb_ipcs_event_sendv(c, iov, iov_len);
+    }
+
+    check_expected_ptr(c);
+    check_expected_ptr(iov);
+    check_expected(iov_len);
+    err = mock_type(int);
+
+    if (err != 0) {
+        return -err;
+    }
+    for (size_t i = 0; i < iov_len; i++) {
+        total += iov[i].iov_len;
+    }
+    if (pcmk__mock_qb_ipcs_event_sent != NULL) {
+        GByteArray *sent = g_byte_array_sized_new(total);
+
+        for (size_t i = 0; i < iov_len; i++) {
+            g_byte_array_append(sent, iov[i].iov_base, iov[i].iov_len);
+        }
+        g_ptr_array_add(pcmk__mock_qb_ipcs_event_sent,
+                        g_byte_array_free_to_bytes(sent));
+    }
+    return total;
+}
+
+
+/* qb_ipcs_response_sendv()
+ *
+ * If pcmk__mock_qb_ipcs_response_sendv is set to true, later calls to
+ * qb_ipcs_response_sendv() will not send anything and must be preceded by:
+ *
+ *     expect_*(__wrap_qb_ipcs_response_sendv, c[, ...]);
+ *     expect_*(__wrap_qb_ipcs_response_sendv, iov[, ...]);
+ *     expect_*(__wrap_qb_ipcs_response_sendv, iov_len[, ...]);
+ *     will_return(__wrap_qb_ipcs_response_sendv, errno_to_set);
+ *
+ * expect_* functions: https://api.cmocka.org/group__cmocka__param.html
+ *
+ * This behaves like the qb_ipcs_event_sendv() mock, except that what would
+ * have been sent is appended to pcmk__mock_qb_ipcs_response_sent.
+ */
+
+bool pcmk__mock_qb_ipcs_response_sendv = false;
+GPtrArray *pcmk__mock_qb_ipcs_response_sent = NULL;
+
+ssize_t
+__wrap_qb_ipcs_response_sendv(qb_ipcs_connection_t *c,
+                              const struct iovec *iov, size_t iov_len)
+{
+    int err = 0;
+    ssize_t total = 0;
+
+    if (!pcmk__mock_qb_ipcs_response_sendv) {
+        return __real_qb_ipcs_response_sendv(c, iov, iov_len);
+    }
+
+    check_expected_ptr(c);
+    check_expected_ptr(iov);
+    check_expected(iov_len);
+    err = mock_type(int);
+
+    if (err != 0) {
+        return -err;
+    }
+    for (size_t i = 0; i < iov_len; i++) {
+        total += iov[i].iov_len;
+    }
+    if (pcmk__mock_qb_ipcs_response_sent != NULL) {
+        GByteArray *sent = g_byte_array_sized_new(total);
+
+        for (size_t i = 0; i < iov_len; i++) {
+            g_byte_array_append(sent, iov[i].iov_base, iov[i].iov_len);
+        }
+        g_ptr_array_add(pcmk__mock_qb_ipcs_response_sent,
+                        g_byte_array_free_to_bytes(sent));
+    }
+    return total;
+}
+
+
+/* qb_ipcs_disconnect()
+ *
+ * If pcmk__mock_qb_ipcs_disconnect is set to true, later calls to
+ * qb_ipcs_disconnect() will do nothing and must be preceded by:
+ *
+ *     expect_*(__wrap_qb_ipcs_disconnect, c[, ...]);
+ *
+ * expect_* functions: https://api.cmocka.org/group__cmocka__param.html
+ */
+
+bool pcmk__mock_qb_ipcs_disconnect = false;
+
+void
+__wrap_qb_ipcs_disconnect(qb_ipcs_connection_t *c)
+{
+    if (!pcmk__mock_qb_ipcs_disconnect) {
+        __real_qb_ipcs_disconnect(c);
+        return;
+    }
+    check_expected_ptr(c);
+}
+
 // LCOV_EXCL_STOP
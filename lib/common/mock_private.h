@@ -19,6 +19,10 @@
 #include <sys/utsname.h>
 #include <unistd.h>
 #include <grp.h>                    // struct group
+#include <sys/uio.h>                // struct iovec
+
+#include <glib.h>                   // GPtrArray
+#include <qb/qbipcs.h>              // qb_ipcs_connection_t
 
 #include <crm/common/results.h>     // _Noreturn
 
@@ -90,6 +94,26 @@ extern bool pcmk__mock_strdup;
 char *__real_strdup(const char *s);
 char *__wrap_strdup(const char *s);
 
+extern bool pcmk__mock_qb_ipcs_event_sendv;
+extern GPtrArray *pcmk__mock_qb_ipcs_event_sent;
+ssize_t __real_qb_ipcs_event_sendv(qb_ipcs_connection_t *c,
+                                   const struct iovec *iov, size_t iov_len);
+ssize_t __wrap_qb_ipcs_event_sendv(qb_ipcs_connection_t *c,
+                                   const struct iovec *iov, size_t iov_len);
+
+extern bool pcmk__mock_qb_ipcs_response_sendv;
+extern GPtrArray *pcmk__mock_qb_ipcs_response_sent;
+ssize_t __real_qb_ipcs_response_sendv(qb_ipcs_connection_t *c,
+                                      const struct iovec *iov,
+                                      size_t iov_len);
+ssize_t __wrap_qb_ipcs_response_sendv(qb_ipcs_connection_t *c,
+                                      const struct iovec *iov,
+                                      size_t iov_len);
+
+extern bool pcmk__mock_qb_ipcs_disconnect;
+void __real_qb_ipcs_disconnect(qb_ipcs_connection_t *c);
+void __wrap_qb_ipcs_disconnect(qb_ipcs_connection_t *c);
+
 #ifdef __cplusplus
 }
 #endif
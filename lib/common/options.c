@@ -388,6 +388,21 @@ static const pcmk__cluster_option_t cluster_options[] = {
             "2x cores)"),
         NULL,
     },
+    {
+        PCMK_OPT_RESOURCE_HISTORY_FORMAT, NULL, PCMK_VALUE_SELECT,
+            PCMK_VALUE_FULL ", " PCMK_VALUE_COMPACT,
+        PCMK_VALUE_FULL, NULL,
+        pcmk__opt_controld,
+        N_("How nodes record resource action history in the CIB status "
+            "section"),
+        N_("With \"compact\", each node records action results with values "
+            "that can be derived from other attributes omitted, timing and "
+            "resource usage combined into a single attribute, and parameter "
+            "digests stored once per node. This greatly reduces the size of "
+            "the CIB in clusters with many resources. Pacemaker tools read "
+            "both formats, but set this only after all nodes have been "
+            "upgraded to a version that supports it."),
+    },
     {
         PCMK_OPT_BATCH_LIMIT, NULL, PCMK_VALUE_INTEGER, NULL,
         "0", pcmk__valid_int,
@@ -529,12 +544,25 @@ static const pcmk__cluster_option_t cluster_options[] = {
     {
         PCMK_OPT_PLACEMENT_STRATEGY, NULL, PCMK_VALUE_SELECT,
             PCMK_VALUE_DEFAULT ", " PCMK_VALUE_UTILIZATION ", "
-                PCMK_VALUE_MINIMAL ", " PCMK_VALUE_BALANCED,
+                PCMK_VALUE_MINIMAL ", " PCMK_VALUE_BALANCED ", "
+                PCMK_VALUE_PACKED,
         PCMK_VALUE_DEFAULT, pcmk__valid_placement_strategy,
         pcmk__opt_schedulerd,
         N_("How the cluster should allocate resources to nodes"),
         NULL,
     },
+    {
+        PCMK_OPT_PLACEMENT_SEARCH_LIMIT, NULL, PCMK_VALUE_INTEGER, NULL,
+        "100000", pcmk__valid_int,
+        pcmk__opt_schedulerd,
+        N_("Maximum number of relocations to consider when improving a packed "
+           "placement"),
+        N_("Only used when \"placement-strategy\" is set to \"packed\". "
+           "After an initial best-fit placement, the scheduler searches for "
+           "resource relocations that let more resources run, until no "
+           "improvement is found or this many candidate relocations have been "
+           "considered. A value of 0 or less disables the search."),
+    },
 
     { NULL, },
 };
@@ -1317,7 +1345,8 @@ pcmk__valid_placement_strategy(const char *value)
 {
     return pcmk__strcase_any_of(value,
                                 PCMK_VALUE_DEFAULT, PCMK_VALUE_UTILIZATION,
-                                PCMK_VALUE_MINIMAL, PCMK_VALUE_BALANCED, NULL);
+                                PCMK_VALUE_MINIMAL, PCMK_VALUE_BALANCED,
+                                PCMK_VALUE_PACKED, NULL);
 }
 
 /*!
@@ -877,3 +877,122 @@ pcmk__cib_element_in_patchset(const xmlNode *patchset, const char *element)
     free(element_regex);
     return rc;
 }
+
+/*!
+ * \internal
+ * \brief Check whether an XPath has a step for a given element name
+ *
+ * \param[in] xpath  Absolute XPath from a patchset change
+ * \param[in] name   Element name to check for
+ *
+ * \return \c true if some step of \p xpath selects an element named \p name,
+ *         otherwise \c false
+ */
+static bool
+xpath_has_step(const char *xpath, const char *name)
+{
+    size_t len = strlen(name);
+
+    for (const char *step = strchr(xpath, '/'); step != NULL;
+         step = strchr(step + 1, '/')) {
+
+        if ((strncmp(step + 1, name, len) == 0)
+            && ((step[len + 1] == '\0') || (step[len + 1] == '/')
+                || (step[len + 1] == '['))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * \brief Free all descendants of an element that have a given name
+ *
+ * \param[in,out] xml   Element whose descendants should be checked
+ * \param[in]     name  Name of elements to free
+ */
+static void
+remove_named_descendants(xmlNode *xml, const char *name)
+{
+    xmlNode *child = pcmk__xe_first_child(xml, NULL, NULL, NULL);
+
+    while (child != NULL) {
+        xmlNode *next = pcmk__xe_next(child, NULL);
+
+        if (pcmk__xe_is(child, name)) {
+            pcmk__xml_free(child);
+        } else {
+            remove_named_descendants(child, name);
+        }
+        child = next;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Copy a CIB patchset, leaving out changes within a given element
+ *
+ * This is useful for keeping a partial copy of the CIB (one without any
+ * \p element) up to date without the cost of applying changes that would be
+ * thrown away. Changes whose path goes through an element named \p element are
+ * dropped, and any such elements are removed from newly created subtrees.
+ *
+ * \param[in] patchset  CIB XML patchset (format 2)
+ * \param[in] element   Name of element to leave out
+ *
+ * \return Newly allocated copy of \p patchset without any changes within
+ *         \p element, or \c NULL if \p patchset is not a supported format
+ * \note The result has no digest, since it would not match the partial CIB.
+ *       The caller is responsible for freeing the result with
+ *       \c pcmk__xml_free().
+ */
+xmlNode *
+pcmk__patchset_without(const xmlNode *patchset, const char *element)
+{
+    xmlNode *pruned = NULL;
+    int format = 1;
+
+    pcmk__assert((patchset != NULL) && (element != NULL));
+
+    crm_element_value_int(patchset, PCMK_XA_FORMAT, &format);
+    if (format != 2) {
+        crm_warn("Unknown patch format: %d", format);
+        return NULL;
+    }
+
+    pruned = pcmk__xe_create(NULL, (const char *) patchset->name);
+    pcmk__xe_copy_attrs(pruned, patchset, pcmk__xaf_none);
+    pcmk__xe_remove_attr(pruned, PCMK__XA_DIGEST);
+
+    for (const xmlNode *child = pcmk__xe_first_child(patchset, NULL, NULL,
+                                                     NULL);
+         child != NULL; child = pcmk__xe_next(child, NULL)) {
+
+        const char *xpath = crm_element_value(child, PCMK_XA_PATH);
+        xmlNode *copy = NULL;
+
+        if (!pcmk__xe_is(child, PCMK_XE_CHANGE)) {
+            // Version information
+            pcmk__xml_copy(pruned, child);
+            continue;
+        }
+
+        if ((xpath != NULL) && xpath_has_step(xpath, element)) {
+            continue;
+        }
+
+        copy = pcmk__xml_copy(pruned, child);
+        if (pcmk__str_eq(crm_element_value(child, PCMK_XA_OPERATION),
+                         PCMK_VALUE_CREATE, pcmk__str_none)) {
+            xmlNode *created = pcmk__xe_first_child(copy, NULL, NULL, NULL);
+
+            if (pcmk__xe_is(created, element)) {
+                pcmk__xml_free(copy);
+            } else {
+                remove_named_descendants(created, element);
+            }
+        }
+    }
+    return pruned;
+}
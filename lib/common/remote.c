@@ -82,6 +82,27 @@ struct remote_header_v0 {
 
 } __attribute__ ((packed));
 
+/* Set in a remote message header's flags if the payload is a proxy frame
+ * rather than XML. Frames are sent only to peers that have said they support
+ * them.
+ */
+#define REMOTE_FLAG_PROXY_FRAME UINT64_C(0x1)
+
+/* A proxy frame payload is this header, followed by the session ID, client
+ * name, and user name (each null-terminated, with lengths including the
+ * terminator, and 0 for a NULL string), followed by the proxied message text.
+ */
+struct proxy_frame_header {
+    uint32_t endian;
+    uint32_t op;
+    uint32_t msg_id;
+    uint32_t ipc_flags;
+    uint32_t session_len;
+    uint32_t client_len;
+    uint32_t user_len;
+    uint32_t payload_len;
+} __attribute__ ((packed));
+
 /*!
  * \internal
  * \brief Retrieve remote message header, in local endianness
@@ -285,6 +306,202 @@ pcmk__remote_send_xml(pcmk__remote_t *remote, const xmlNode *msg)
     return rc;
 }
 
+// Length of a proxy frame string including terminator (or 0 for NULL)
+static inline uint32_t
+frame_strlen(const char *s)
+{
+    return (s == NULL)? 0 : (uint32_t) (strlen(s) + 1);
+}
+
+/*!
+ * \internal
+ * \brief Send an IPC message over a Pacemaker Remote connection as a frame
+ *
+ * \param[in,out] remote  Pacemaker Remote connection to use
+ * \param[in]     frame   Proxy frame to send
+ *
+ * \return Standard Pacemaker return code
+ * \note The caller is responsible for ensuring that the peer supports frames.
+ */
+int
+pcmk__remote_send_proxy_frame(pcmk__remote_t *remote,
+                              const pcmk__proxy_frame_t *frame)
+{
+    static uint64_t id = 0;
+    int rc = pcmk_rc_ok;
+    struct iovec iov[3];
+    struct remote_header_v0 header = { 0, };
+    struct proxy_frame_header *frame_header = NULL;
+    char *strings = NULL;
+    size_t frame_len = sizeof(struct proxy_frame_header);
+
+    CRM_CHECK((remote != NULL) && (frame != NULL) && (frame->session != NULL)
+              && (frame->payload != NULL) && (frame->payload_len > 0)
+              && (frame->payload[frame->payload_len - 1] == '\0'),
+              return EINVAL);
+
+    frame_len += frame_strlen(frame->session) + frame_strlen(frame->client)
+                 + frame_strlen(frame->user);
+    frame_header = pcmk__assert_alloc(1, frame_len);
+    frame_header->endian = ENDIAN_LOCAL;
+    frame_header->op = (uint32_t) frame->op;
+    frame_header->msg_id = frame->msg_id;
+    frame_header->ipc_flags = frame->ipc_flags;
+    frame_header->session_len = frame_strlen(frame->session);
+    frame_header->client_len = frame_strlen(frame->client);
+    frame_header->user_len = frame_strlen(frame->user);
+    frame_header->payload_len = (uint32_t) frame->payload_len;
+
+    strings = (char *) (frame_header + 1);
+    if (frame->session != NULL) {
+        memcpy(strings, frame->session, frame_header->session_len);
+        strings += frame_header->session_len;
+    }
+    if (frame->client != NULL) {
+        memcpy(strings, frame->client, frame_header->client_len);
+        strings += frame_header->client_len;
+    }
+    if (frame->user != NULL) {
+        memcpy(strings, frame->user, frame_header->user_len);
+    }
+
+    iov[0].iov_base = &header;
+    iov[0].iov_len = sizeof(struct remote_header_v0);
+    iov[1].iov_base = frame_header;
+    iov[1].iov_len = frame_len;
+    iov[2].iov_base = (void *) frame->payload;
+    iov[2].iov_len = frame->payload_len;
+
+    header.id = ++id;
+    header.endian = ENDIAN_LOCAL;
+    header.version = REMOTE_MSG_VERSION;
+    header.flags = REMOTE_FLAG_PROXY_FRAME;
+    header.payload_offset = iov[0].iov_len;
+    header.payload_uncompressed = iov[1].iov_len + iov[2].iov_len;
+    header.size_total = iov[0].iov_len + header.payload_uncompressed;
+
+    rc = remote_send_iovs(remote, iov, 3);
+    if (rc != pcmk_rc_ok) {
+        crm_err("Could not send remote proxy frame: %s " QB_XS " rc=%d",
+                pcmk_rc_str(rc), rc);
+    }
+    free(frame_header);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Check whether the buffered remote connection message is a proxy frame
+ *
+ * \param[in,out] remote  Remote connection possibly with message available
+ *
+ * \return true if a complete proxy frame is buffered, otherwise false
+ */
+bool
+pcmk__remote_message_is_proxy_frame(pcmk__remote_t *remote)
+{
+    struct remote_header_v0 *header = localized_remote_header(remote);
+
+    return (header != NULL)
+           && (remote->buffer_offset >= header->size_total)
+           && pcmk_is_set(header->flags, REMOTE_FLAG_PROXY_FRAME);
+}
+
+// Get the next string from a received proxy frame (or NULL if empty)
+static const char *
+next_frame_string(const char **pos, uint32_t len)
+{
+    const char *s = *pos;
+
+    if (len == 0) {
+        return NULL;
+    }
+    *pos += len;
+    return s;
+}
+
+/*!
+ * \internal
+ * \brief Obtain the proxy frame from the currently buffered remote message
+ *
+ * \param[in,out] remote  Remote connection with proxy frame available
+ * \param[out]    frame   Where to store frame contents
+ *
+ * \return Standard Pacemaker return code
+ * \note This effectively removes the message from the connection buffer, but
+ *       the string members of \p frame point into the buffer and are valid
+ *       only until the next read from \p remote.
+ */
+int
+pcmk__remote_message_proxy_frame(pcmk__remote_t *remote,
+                                 pcmk__proxy_frame_t *frame)
+{
+    struct remote_header_v0 *header = NULL;
+    struct proxy_frame_header *frame_header = NULL;
+    const char *pos = NULL;
+    size_t frame_len = sizeof(struct proxy_frame_header);
+
+    CRM_CHECK((remote != NULL) && (frame != NULL), return EINVAL);
+
+    if (!pcmk__remote_message_is_proxy_frame(remote)) {
+        return ENOMSG;
+    }
+    header = localized_remote_header(remote);
+
+    // Take ownership of the buffer
+    remote->buffer_offset = 0;
+
+    if (header->payload_uncompressed < frame_len) {
+        crm_err("Ignoring truncated remote proxy frame");
+        return EBADMSG;
+    }
+
+    frame_header = (struct proxy_frame_header *)
+                   (remote->buffer + header->payload_offset);
+    if (frame_header->endian != ENDIAN_LOCAL) {
+        frame_header->op = __swab32(frame_header->op);
+        frame_header->msg_id = __swab32(frame_header->msg_id);
+        frame_header->ipc_flags = __swab32(frame_header->ipc_flags);
+        frame_header->session_len = __swab32(frame_header->session_len);
+        frame_header->client_len = __swab32(frame_header->client_len);
+        frame_header->user_len = __swab32(frame_header->user_len);
+        frame_header->payload_len = __swab32(frame_header->payload_len);
+    }
+
+    frame_len += (size_t) frame_header->session_len
+                 + frame_header->client_len + frame_header->user_len
+                 + frame_header->payload_len;
+    if ((frame_header->session_len == 0) || (frame_header->payload_len == 0)
+        || (frame_len != header->payload_uncompressed)) {
+        crm_err("Ignoring malformed remote proxy frame");
+        return EBADMSG;
+    }
+
+    pos = (const char *) (frame_header + 1);
+    frame->op = (enum pcmk__proxy_op) frame_header->op;
+    frame->msg_id = frame_header->msg_id;
+    frame->ipc_flags = frame_header->ipc_flags;
+    frame->session = next_frame_string(&pos, frame_header->session_len);
+    frame->client = next_frame_string(&pos, frame_header->client_len);
+    frame->user = next_frame_string(&pos, frame_header->user_len);
+    frame->payload = next_frame_string(&pos, frame_header->payload_len);
+    frame->payload_len = frame_header->payload_len;
+
+    if ((frame->session[frame_header->session_len - 1] != '\0')
+        || ((frame->client != NULL)
+            && (frame->client[frame_header->client_len - 1] != '\0'))
+        || ((frame->user != NULL)
+            && (frame->user[frame_header->user_len - 1] != '\0'))
+        || (frame->payload[frame->payload_len - 1] != '\0')) {
+        crm_err("Ignoring remote proxy frame with unterminated string");
+        return EBADMSG;
+    }
+
+    crm_trace("Received %zu-byte proxy frame for session %s",
+              frame->payload_len, frame->session);
+    return pcmk_rc_ok;
+}
+
 /*!
  * \internal
  * \brief Obtain the XML from the currently buffered remote connection message
@@ -304,6 +521,15 @@ pcmk__remote_message_xml(pcmk__remote_t *remote)
         return NULL;
     }
 
+    if (pcmk_is_set(header->flags, REMOTE_FLAG_PROXY_FRAME)) {
+        // Frames must be obtained with pcmk__remote_message_proxy_frame()
+        if (remote->buffer_offset >= header->size_total) {
+            crm_err("Discarding unexpected remote proxy frame");
+            remote->buffer_offset = 0;
+        }
+        return NULL;
+    }
+
     /* Support compression on the receiving end now, in case we ever want to add it later */
     if (header->payload_compressed) {
         int rc = 0;
@@ -13,6 +13,8 @@
 #include <string.h>     // strcpy(), strdup()
 #include <sys/types.h>  // size_t
 
+#include <glib.h>       // GPrivate, g_private_get(), g_private_set()
+
 int pcmk__score_red = 0;
 int pcmk__score_green = 0;
 int pcmk__score_yellow = 0;
@@ -94,15 +96,22 @@ pcmk_parse_score(const char *score_s, int *score, int default_score)
  * \param[in] score  Score to display
  *
  * \return Pointer to static memory containing string representation of \p score
- * \note Subsequent calls to this function will overwrite the returned value, so
- *       it should be used only in a local context such as a printf()-style
- *       statement.
+ * \note Subsequent calls to this function (from the same thread) will
+ *       overwrite the returned value, so it should be used only in a local
+ *       context such as a printf()-style statement.
  */
 const char *
 pcmk_readable_score(int score)
 {
-    // The longest possible result is "-INFINITY"
-    static char score_s[sizeof(PCMK_VALUE_MINUS_INFINITY)];
+    // Each thread gets its own buffer, since the scheduler may use threads
+    static GPrivate buffer = G_PRIVATE_INIT(free);
+    char *score_s = g_private_get(&buffer);
+
+    if (score_s == NULL) {
+        // The longest possible result is "-INFINITY"
+        score_s = pcmk__assert_alloc(1, sizeof(PCMK_VALUE_MINUS_INFINITY));
+        g_private_set(&buffer, score_s);
+    }
 
     if (score >= PCMK_SCORE_INFINITY) {
         strcpy(score_s, PCMK_VALUE_INFINITY);
@@ -112,7 +121,7 @@ pcmk_readable_score(int score)
 
     } else {
         // Range is limited to +/-1000000, so no chance of overflow
-        snprintf(score_s, sizeof(score_s), "%d", score);
+        snprintf(score_s, sizeof(PCMK_VALUE_MINUS_INFINITY), "%d", score);
     }
 
     return score_s;
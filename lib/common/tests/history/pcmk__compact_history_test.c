@@ -0,0 +1,338 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+#include <crm/common/history_internal.h>
+
+#define NODE_NAME       "node1"
+#define SHARED_DIGEST   "0123456789abcdef0123456789abcdef"
+
+static xmlNode *
+create_lrm(void)
+{
+    xmlNode *lrm = pcmk__xe_create(NULL, PCMK__XE_LRM);
+
+    crm_xml_add(lrm, PCMK_XA_ID, "1");
+    pcmk__xe_create(lrm, PCMK__XE_LRM_RESOURCES);
+    return lrm;
+}
+
+// Add a full-format entry like the controller records for a completed action
+static xmlNode *
+add_entry(xmlNode *lrm, const char *rsc_id, const char *task, guint interval_ms,
+          int call_id, const char *digest)
+{
+    xmlNode *resources = pcmk__xe_first_child(lrm, PCMK__XE_LRM_RESOURCES,
+                                              NULL, NULL);
+    xmlNode *rsc = pcmk__xe_first_child(resources, PCMK__XE_LRM_RESOURCE,
+                                        PCMK_XA_ID, rsc_id);
+    xmlNode *xml_op = NULL;
+    char *key = pcmk__op_key(rsc_id, task, interval_ms);
+    char *magic = NULL;
+
+    if (rsc == NULL) {
+        rsc = pcmk__xe_create(resources, PCMK__XE_LRM_RESOURCE);
+        crm_xml_add(rsc, PCMK_XA_ID, rsc_id);
+        crm_xml_add(rsc, PCMK_XA_CLASS, PCMK_RESOURCE_CLASS_OCF);
+        crm_xml_add(rsc, PCMK_XA_PROVIDER, "heartbeat");
+        crm_xml_add(rsc, PCMK_XA_TYPE, "Dummy");
+    }
+
+    magic = crm_strdup_printf("0:0;3:%d:0:6f5b5e2c-7a48-4d6c-8d3a-9c4d0a1b2c3d",
+                              call_id);
+    xml_op = pcmk__xe_create(rsc, PCMK__XE_LRM_RSC_OP);
+    crm_xml_add(xml_op, PCMK_XA_ID, key);
+    crm_xml_add(xml_op, PCMK__XA_OPERATION_KEY, key);
+    crm_xml_add(xml_op, PCMK_XA_OPERATION, task);
+    crm_xml_add(xml_op, PCMK_XA_CRM_DEBUG_ORIGIN, "do_update_resource");
+    crm_xml_add(xml_op, PCMK_XA_CRM_FEATURE_SET, CRM_FEATURE_SET);
+    crm_xml_add(xml_op, PCMK__XA_TRANSITION_KEY, strchr(magic, ';') + 1);
+    crm_xml_add(xml_op, PCMK__XA_TRANSITION_MAGIC, magic);
+    crm_xml_add(xml_op, PCMK__META_ON_NODE, NODE_NAME);
+    crm_xml_add_int(xml_op, PCMK__XA_CALL_ID, call_id);
+    crm_xml_add_int(xml_op, PCMK__XA_RC_CODE, 0);
+    crm_xml_add_int(xml_op, PCMK__XA_OP_STATUS, 0);
+    crm_xml_add_ms(xml_op, PCMK_META_INTERVAL, interval_ms);
+    crm_xml_add(xml_op, PCMK_XA_LAST_RC_CHANGE, "1735689600");
+    crm_xml_add(xml_op, PCMK_XA_EXEC_TIME, "21");
+    crm_xml_add(xml_op, PCMK_XA_QUEUE_TIME, "0");
+    crm_xml_add(xml_op, PCMK__XA_OP_DIGEST, digest);
+
+    free(key);
+    free(magic);
+    return xml_op;
+}
+
+static void
+assert_same_attrs(const xmlNode *xml1, const xmlNode *xml2)
+{
+    int n1 = 0;
+    int n2 = 0;
+
+    for (const xmlAttr *attr = pcmk__xe_first_attr(xml1); attr != NULL;
+         attr = attr->next) {
+
+        const char *name = (const char *) attr->name;
+
+        assert_string_equal(crm_element_value(xml1, name),
+                            pcmk__s(crm_element_value(xml2, name), "<missing>"));
+        n1++;
+    }
+    for (const xmlAttr *attr = pcmk__xe_first_attr(xml2); attr != NULL;
+         attr = attr->next) {
+        n2++;
+    }
+    assert_int_equal(n1, n2);
+}
+
+static void
+null_lrm_asserts(void **state)
+{
+    pcmk__assert_asserts(pcmk__compact_history(NULL, NODE_NAME, NULL));
+    pcmk__assert_asserts(pcmk__expand_history(NULL, NODE_NAME));
+}
+
+static void
+empty_history(void **state)
+{
+    xmlNode *lrm = pcmk__xe_create(NULL, PCMK__XE_LRM);
+
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+    assert_null(pcmk__xe_first_child(lrm, NULL, NULL, NULL));
+    pcmk__expand_history(lrm, NODE_NAME);
+    assert_null(pcmk__xe_first_child(lrm, NULL, NULL, NULL));
+    pcmk__xml_free(lrm);
+}
+
+static void
+round_trip(void **state)
+{
+    xmlNode *lrm = create_lrm();
+    xmlNode *orig = NULL;
+    xmlNode *resources = NULL;
+    xmlNode *orig_resources = NULL;
+    xmlNode *xml_op = NULL;
+
+    add_entry(lrm, "rsc1", PCMK_ACTION_START, 0, 5, SHARED_DIGEST);
+    xml_op = add_entry(lrm, "rsc1", PCMK_ACTION_MONITOR, 10000, 6,
+                       "fedcba9876543210fedcba9876543210");
+    crm_xml_add(xml_op, PCMK_XA_CPU_USER_TIME, "3");
+    crm_xml_add(xml_op, PCMK_XA_BLOCKS_OUT, "8");
+    add_entry(lrm, "rsc2", PCMK_ACTION_START, 0, 7, SHARED_DIGEST);
+    orig = pcmk__xml_copy(NULL, lrm);
+
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+
+    resources = pcmk__xe_first_child(lrm, PCMK__XE_LRM_RESOURCES, NULL, NULL);
+    xml_op = pcmk__xe_first_child(resources, PCMK__XE_LRM_RESOURCE, NULL, NULL);
+    xml_op = pcmk__xe_first_child(xml_op, PCMK__XE_LRM_RSC_OP, NULL, NULL);
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_OP_PACKED),
+                        "1:5:1735689600:21:0");
+    assert_null(crm_element_value(xml_op, PCMK_XA_OPERATION));
+    assert_null(crm_element_value(xml_op, PCMK_META_INTERVAL));
+    assert_null(crm_element_value(xml_op, PCMK__XA_TRANSITION_MAGIC));
+    assert_null(crm_element_value(xml_op, PCMK__META_ON_NODE));
+    assert_null(crm_element_value(xml_op, PCMK_XA_EXEC_TIME));
+
+    // Values that other code looks up by XPath are kept
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_CALL_ID), "5");
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_RC_CODE), "0");
+
+    pcmk__expand_history(lrm, NODE_NAME);
+    assert_null(pcmk__xe_first_child(lrm, PCMK__XE_LRM_DIGESTS, NULL, NULL));
+
+    orig_resources = pcmk__xe_first_child(orig, PCMK__XE_LRM_RESOURCES, NULL,
+                                          NULL);
+    for (xmlNode *rsc = pcmk__xe_first_child(orig_resources,
+                                             PCMK__XE_LRM_RESOURCE, NULL, NULL);
+         rsc != NULL; rsc = pcmk__xe_next(rsc, PCMK__XE_LRM_RESOURCE)) {
+
+        xmlNode *copy = pcmk__xe_first_child(resources, PCMK__XE_LRM_RESOURCE,
+                                             PCMK_XA_ID, pcmk__xe_id(rsc));
+
+        assert_non_null(copy);
+        assert_same_attrs(rsc, copy);
+
+        for (xmlNode *op = pcmk__xe_first_child(rsc, PCMK__XE_LRM_RSC_OP, NULL,
+                                                NULL);
+             op != NULL; op = pcmk__xe_next(op, PCMK__XE_LRM_RSC_OP)) {
+
+            assert_same_attrs(op, pcmk__xe_first_child(copy,
+                                                       PCMK__XE_LRM_RSC_OP,
+                                                       PCMK_XA_ID,
+                                                       pcmk__xe_id(op)));
+        }
+    }
+
+    pcmk__xml_free(orig);
+    pcmk__xml_free(lrm);
+}
+
+static void
+shared_digests_interned(void **state)
+{
+    xmlNode *lrm = create_lrm();
+    xmlNode *shared1 = add_entry(lrm, "rsc1", PCMK_ACTION_START, 0, 2,
+                                 SHARED_DIGEST);
+    xmlNode *shared2 = add_entry(lrm, "rsc2", PCMK_ACTION_START, 0, 3,
+                                 SHARED_DIGEST);
+    xmlNode *unique = add_entry(lrm, "rsc3", PCMK_ACTION_START, 0, 4,
+                                "00000000000000000000000000000000");
+    xmlNode *table = NULL;
+
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+
+    table = pcmk__xe_first_child(lrm, PCMK__XE_LRM_DIGESTS, NULL, NULL);
+    assert_non_null(table);
+    assert_non_null(pcmk__xe_first_child(table, PCMK__XE_LRM_DIGEST,
+                                         PCMK_XA_ID, "0123456789abcdef"));
+    assert_null(pcmk__xe_next(pcmk__xe_first_child(table, NULL, NULL, NULL),
+                              NULL));
+
+    assert_string_equal(crm_element_value(shared1, PCMK__XA_OP_DIGEST),
+                        "0123456789abcdef");
+    assert_string_equal(crm_element_value(shared2, PCMK__XA_OP_DIGEST),
+                        "0123456789abcdef");
+    assert_string_equal(crm_element_value(unique, PCMK__XA_OP_DIGEST),
+                        "00000000000000000000000000000000");
+
+    pcmk__expand_history(lrm, NODE_NAME);
+    assert_string_equal(crm_element_value(shared2, PCMK__XA_OP_DIGEST),
+                        SHARED_DIGEST);
+    pcmk__xml_free(lrm);
+}
+
+static void
+uses_kept_between_calls(void **state)
+{
+    GHashTable *uses = pcmk__strkey_table(free, NULL);
+    xmlNode *lrm1 = create_lrm();
+    xmlNode *lrm2 = create_lrm();
+    xmlNode *xml_op = NULL;
+
+    add_entry(lrm1, "rsc1", PCMK_ACTION_START, 0, 2, SHARED_DIGEST);
+    pcmk__compact_history(lrm1, NODE_NAME, uses);
+    assert_null(pcmk__xe_first_child(lrm1, PCMK__XE_LRM_DIGESTS, NULL, NULL));
+
+    // A later update with the same digest uses (and carries) the table
+    xml_op = add_entry(lrm2, "rsc2", PCMK_ACTION_START, 0, 3, SHARED_DIGEST);
+    pcmk__compact_history(lrm2, NODE_NAME, uses);
+    assert_non_null(pcmk__xe_first_child(lrm2, PCMK__XE_LRM_DIGESTS, NULL,
+                                         NULL));
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_OP_DIGEST),
+                        "0123456789abcdef");
+
+    pcmk__xml_free(lrm1);
+    pcmk__xml_free(lrm2);
+    g_hash_table_destroy(uses);
+}
+
+static void
+underivable_entries_kept(void **state)
+{
+    xmlNode *lrm = create_lrm();
+    xmlNode *migrate = add_entry(lrm, "rsc1", PCMK_ACTION_MIGRATE_TO, 0, 2,
+                                 NULL);
+    xmlNode *bad_magic = add_entry(lrm, "rsc2", PCMK_ACTION_START, 0, 3, NULL);
+    xmlNode *bad_interval = add_entry(lrm, "rsc3", PCMK_ACTION_MONITOR, 10000,
+                                      4, NULL);
+
+    // A migration recorded on the target keeps its on_node
+    crm_xml_add(migrate, PCMK__META_ON_NODE, "node2");
+    crm_xml_add(bad_magic, PCMK__XA_TRANSITION_MAGIC, "2:1;3:3:0:other");
+    crm_xml_add(bad_interval, PCMK_META_INTERVAL, "10s");
+
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+
+    assert_non_null(crm_element_value(migrate, PCMK__XA_OP_PACKED));
+    assert_string_equal(crm_element_value(migrate, PCMK__META_ON_NODE),
+                        "node2");
+    assert_null(crm_element_value(bad_magic, PCMK__XA_OP_PACKED));
+    assert_string_equal(crm_element_value(bad_magic, PCMK__XA_TRANSITION_MAGIC),
+                        "2:1;3:3:0:other");
+    assert_null(crm_element_value(bad_interval, PCMK__XA_OP_PACKED));
+    assert_string_equal(crm_element_value(bad_interval, PCMK_META_INTERVAL),
+                        "10s");
+
+    pcmk__xml_free(lrm);
+}
+
+static void
+compacting_is_idempotent(void **state)
+{
+    xmlNode *lrm = create_lrm();
+    xmlNode *once = NULL;
+    char *text1 = NULL;
+    char *text2 = NULL;
+    GString *buffer = g_string_sized_new(1024);
+
+    add_entry(lrm, "rsc1", PCMK_ACTION_START, 0, 2, SHARED_DIGEST);
+    add_entry(lrm, "rsc2", PCMK_ACTION_START, 0, 3, SHARED_DIGEST);
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+    once = pcmk__xml_copy(NULL, lrm);
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+
+    pcmk__xml_string(once, 0, buffer, 0);
+    text1 = pcmk__str_copy(buffer->str);
+    g_string_truncate(buffer, 0);
+    pcmk__xml_string(lrm, 0, buffer, 0);
+    text2 = pcmk__str_copy(buffer->str);
+    assert_string_equal(text1, text2);
+
+    free(text1);
+    free(text2);
+    g_string_free(buffer, TRUE);
+    pcmk__xml_free(once);
+    pcmk__xml_free(lrm);
+}
+
+static void
+history_shrinks(void **state)
+{
+    xmlNode *lrm = create_lrm();
+    GString *buffer = g_string_sized_new(1024 * 1024);
+    size_t full_size = 0;
+
+    // Many resources of one type, as in a large cluster
+    for (int i = 0; i < 500; i++) {
+        char *rsc_id = crm_strdup_printf("rsc%d", i);
+
+        add_entry(lrm, rsc_id, PCMK_ACTION_START, 0, (2 * i) + 2,
+                  SHARED_DIGEST);
+        add_entry(lrm, rsc_id, PCMK_ACTION_MONITOR, 10000, (2 * i) + 3,
+                  SHARED_DIGEST);
+        free(rsc_id);
+    }
+
+    pcmk__xml_string(lrm, 0, buffer, 0);
+    full_size = buffer->len;
+    pcmk__compact_history(lrm, NODE_NAME, NULL);
+    g_string_truncate(buffer, 0);
+    pcmk__xml_string(lrm, 0, buffer, 0);
+
+    // At least a quarter smaller
+    assert_true((buffer->len * 4) < (full_size * 3));
+
+    g_string_free(buffer, TRUE);
+    pcmk__xml_free(lrm);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_lrm_asserts),
+                cmocka_unit_test(empty_history),
+                cmocka_unit_test(round_trip),
+                cmocka_unit_test(shared_digests_interned),
+                cmocka_unit_test(uses_kept_between_calls),
+                cmocka_unit_test(underivable_entries_kept),
+                cmocka_unit_test(compacting_is_idempotent),
+                cmocka_unit_test(history_shrinks))
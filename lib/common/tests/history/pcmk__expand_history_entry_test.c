@@ -0,0 +1,131 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+#include <crm/common/history_internal.h>
+
+#define COMPACT_OP                                                          \
+    "<" PCMK__XE_LRM_RSC_OP " " PCMK_XA_ID "=\"rsc1_monitor_10000\""        \
+        " " PCMK__XA_OPERATION_KEY "=\"rsc1_monitor_10000\""                \
+        " " PCMK__XA_TRANSITION_KEY "=\"4:2:0:abc\""                        \
+        " " PCMK__XA_CALL_ID "=\"12\""                                      \
+        " " PCMK__XA_RC_CODE "=\"7\""                                       \
+        " " PCMK__XA_OP_STATUS "=\"0\""                                     \
+        " " PCMK__XA_OP_DIGEST "=\"0123456789abcdef\""                      \
+        " " PCMK__XA_OP_PACKED "=\"1:12:1735689600:5::2\"/>"
+
+static void
+null_op_asserts(void **state)
+{
+    pcmk__assert_asserts(pcmk__expand_history_entry(NULL, NULL, "node1"));
+}
+
+static void
+full_entry_unchanged(void **state)
+{
+    xmlNode *xml_op = pcmk__xe_create(NULL, PCMK__XE_LRM_RSC_OP);
+
+    crm_xml_add(xml_op, PCMK__XA_CALL_ID, "3");
+    pcmk__expand_history_entry(xml_op, NULL, "node1");
+    assert_null(crm_element_value(xml_op, PCMK__META_ON_NODE));
+    assert_null(crm_element_value(xml_op, PCMK__XA_TRANSITION_MAGIC));
+    pcmk__xml_free(xml_op);
+}
+
+static void
+compact_entry_expanded(void **state)
+{
+    xmlNode *xml_op = pcmk__xml_parse(COMPACT_OP);
+    GHashTable *digests = pcmk__strkey_table(free, NULL);
+
+    g_hash_table_insert(digests, pcmk__str_copy("0123456789abcdef"),
+                        "0123456789abcdef0123456789abcdef");
+    pcmk__expand_history_entry(xml_op, digests, "node1");
+
+    assert_null(crm_element_value(xml_op, PCMK__XA_OP_PACKED));
+    assert_string_equal(crm_element_value(xml_op, PCMK_XA_OPERATION),
+                        PCMK_ACTION_MONITOR);
+    assert_string_equal(crm_element_value(xml_op, PCMK_META_INTERVAL),
+                        "10000");
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_TRANSITION_MAGIC),
+                        "0:7;4:2:0:abc");
+    assert_string_equal(crm_element_value(xml_op, PCMK__META_ON_NODE),
+                        "node1");
+    assert_string_equal(crm_element_value(xml_op, PCMK_XA_LAST_RC_CHANGE),
+                        "1735689600");
+    assert_string_equal(crm_element_value(xml_op, PCMK_XA_EXEC_TIME), "5");
+    assert_null(crm_element_value(xml_op, PCMK_XA_QUEUE_TIME));
+    assert_string_equal(crm_element_value(xml_op, PCMK_XA_CPU_USER_TIME),
+                        "2");
+    assert_null(crm_element_value(xml_op, PCMK_XA_CPU_SYSTEM_TIME));
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_OP_DIGEST),
+                        "0123456789abcdef0123456789abcdef");
+
+    g_hash_table_destroy(digests);
+    pcmk__xml_free(xml_op);
+}
+
+static void
+unknown_node_or_digests(void **state)
+{
+    xmlNode *xml_op = pcmk__xml_parse(COMPACT_OP);
+
+    pcmk__expand_history_entry(xml_op, NULL, NULL);
+    assert_null(crm_element_value(xml_op, PCMK__XA_OP_PACKED));
+    assert_null(crm_element_value(xml_op, PCMK__META_ON_NODE));
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_OP_DIGEST),
+                        "0123456789abcdef");
+    pcmk__xml_free(xml_op);
+}
+
+static void
+stale_packed_ignored(void **state)
+{
+    xmlNode *xml_op = pcmk__xml_parse(COMPACT_OP);
+
+    // Entry rewritten in full format, leaving the old packed values behind
+    crm_xml_add(xml_op, PCMK__XA_CALL_ID, "13");
+    crm_xml_add(xml_op, PCMK_XA_EXEC_TIME, "9");
+
+    pcmk__expand_history_entry(xml_op, NULL, "node1");
+    assert_null(crm_element_value(xml_op, PCMK__XA_OP_PACKED));
+    assert_string_equal(crm_element_value(xml_op, PCMK_XA_EXEC_TIME), "9");
+    assert_null(crm_element_value(xml_op, PCMK_XA_LAST_RC_CHANGE));
+    assert_null(crm_element_value(xml_op, PCMK__META_ON_NODE));
+    pcmk__xml_free(xml_op);
+}
+
+static void
+unsupported_version(void **state)
+{
+    xmlNode *xml_op = pcmk__xml_parse(COMPACT_OP);
+
+    crm_xml_add(xml_op, PCMK__XA_OP_PACKED, "2:12:1735689600");
+    pcmk__expand_history_entry(xml_op, NULL, "node1");
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_OP_PACKED),
+                        "2:12:1735689600");
+    assert_null(crm_element_value(xml_op, PCMK_XA_LAST_RC_CHANGE));
+
+    crm_xml_add(xml_op, PCMK__XA_OP_PACKED, "x");
+    pcmk__expand_history_entry(xml_op, NULL, "node1");
+    assert_string_equal(crm_element_value(xml_op, PCMK__XA_OP_PACKED), "x");
+    pcmk__xml_free(xml_op);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_op_asserts),
+                cmocka_unit_test(full_entry_unchanged),
+                cmocka_unit_test(compact_entry_expanded),
+                cmocka_unit_test(unknown_node_or_digests),
+                cmocka_unit_test(stale_packed_ignored),
+                cmocka_unit_test(unsupported_version))
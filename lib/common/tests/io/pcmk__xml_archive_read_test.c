@@ -0,0 +1,331 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml_comment_internal.h>
+
+#define SERIES      "pe-input"
+#define INTERVAL    5
+#define WRAP        20
+
+static char *directory = NULL;
+
+static int
+setup(void **state)
+{
+    directory = crm_strdup_printf("%s/archive-test-XXXXXX",
+                                  pcmk__get_tmpdir());
+    assert_non_null(mkdtemp(directory));
+    return 0;
+}
+
+static void
+remove_all(const char *path)
+{
+    GDir *dir = g_dir_open(path, 0, NULL);
+    const char *name = NULL;
+
+    if (dir == NULL) {
+        unlink(path);
+        return;
+    }
+    while ((name = g_dir_read_name(dir)) != NULL) {
+        char *child = crm_strdup_printf("%s/%s", path, name);
+
+        remove_all(child);
+        free(child);
+    }
+    g_dir_close(dir);
+    rmdir(path);
+}
+
+static int
+teardown(void **state)
+{
+    remove_all(directory);
+    free(directory);
+    directory = NULL;
+    return 0;
+}
+
+static char *
+serialize(const xmlNode *xml)
+{
+    GString *buffer = g_string_sized_new(1024);
+    char *text = NULL;
+
+    pcmk__xml_string(xml, pcmk__xml_fmt_pretty, buffer, 0);
+    text = pcmk__str_copy(buffer->str);
+    g_string_free(buffer, TRUE);
+    return text;
+}
+
+static guint
+count_files(void)
+{
+    char *path = crm_strdup_printf("%s/" SERIES ".archive", directory);
+    GDir *dir = g_dir_open(path, 0, NULL);
+    guint count = 0;
+
+    assert_non_null(dir);
+    while (g_dir_read_name(dir) != NULL) {
+        count++;
+    }
+    g_dir_close(dir);
+    free(path);
+    return count;
+}
+
+static xmlNode *
+new_input(void)
+{
+    xmlNode *cib = pcmk__xe_create(NULL, PCMK_XE_CIB);
+    xmlNode *configuration = pcmk__xe_create(cib, PCMK_XE_CONFIGURATION);
+
+    crm_xml_add(cib, PCMK_XA_ADMIN_EPOCH, "0");
+    crm_xml_add(cib, PCMK_XA_EPOCH, "1");
+    crm_xml_add(cib, PCMK_XA_NUM_UPDATES, "0");
+    pcmk__xe_create(configuration, PCMK_XE_CRM_CONFIG);
+    pcmk__xe_create(configuration, PCMK_XE_NODES);
+    pcmk__xe_create(configuration, PCMK_XE_RESOURCES);
+    pcmk__xe_create(configuration, PCMK_XE_CONSTRAINTS);
+    pcmk__xe_create(cib, PCMK_XE_STATUS);
+    return cib;
+}
+
+// Pick a random element below (or at) xml
+static xmlNode *
+random_element(GRand *rand, xmlNode *xml)
+{
+    while (g_rand_int_range(rand, 0, 3) != 0) {
+        int n_children = 0;
+        xmlNode *child = NULL;
+
+        for (child = pcmk__xe_first_child(xml, NULL, NULL, NULL);
+             child != NULL; child = pcmk__xe_next(child, NULL)) {
+            n_children++;
+        }
+        if (n_children == 0) {
+            break;
+        }
+
+        child = pcmk__xe_first_child(xml, NULL, NULL, NULL);
+        for (int i = g_rand_int_range(rand, 0, n_children); i > 0; i--) {
+            child = pcmk__xe_next(child, NULL);
+        }
+        xml = child;
+    }
+    return xml;
+}
+
+// Make a few random changes to a document, like a cluster would
+static void
+mutate(GRand *rand, xmlNode *cib, int n)
+{
+    int changes = g_rand_int_range(rand, 1, 6);
+
+    crm_xml_add_int(cib, PCMK_XA_NUM_UPDATES, n);
+
+    for (int i = 0; i < changes; i++) {
+        xmlNode *xml = random_element(rand, cib);
+        char *value = crm_strdup_printf("value-%d-%d", n, i);
+
+        switch (g_rand_int_range(rand, 0, 6)) {
+            case 0:
+            case 1:
+                crm_xml_add(xml, "attr", value);
+                break;
+
+            case 2:
+                crm_xml_set_id(pcmk__xe_create(xml, "child"), "child-%d-%d",
+                               n, i);
+                break;
+
+            case 3:
+                // Keep the top-level sections
+                if ((xml != cib) && (xml->parent != cib)) {
+                    pcmk__xml_free(xml);
+                }
+                break;
+
+            case 4:
+                pcmk__xe_remove_attr(xml, "attr");
+                break;
+
+            default:
+                // Patchsets may not reproduce comments exactly
+                if (g_rand_int_range(rand, 0, 4) == 0) {
+                    xmlAddChild(xml, pcmk__xc_create(cib->doc, value));
+                } else {
+                    crm_xml_add(xml, PCMK_XA_ID, value);
+                }
+                break;
+        }
+        free(value);
+    }
+}
+
+static void
+invalid_arguments(void **state)
+{
+    xmlNode *xml = NULL;
+
+    assert_int_equal(pcmk__xml_archive_read(NULL, SERIES, 0, &xml), EINVAL);
+    assert_int_equal(pcmk__xml_archive_read("/tmp", NULL, 0, &xml), EINVAL);
+    assert_int_equal(pcmk__xml_archive_read("/tmp", SERIES, 0, NULL), EINVAL);
+}
+
+static void
+no_archive(void **state)
+{
+    xmlNode *xml = NULL;
+    char *filename = pcmk__series_filename(directory, SERIES, 0, true);
+
+    assert_int_equal(pcmk__xml_archive_read(directory, SERIES, 0, &xml),
+                     ENOENT);
+    assert_null(xml);
+    assert_null(pcmk__xml_read(filename));
+    free(filename);
+}
+
+static void
+missing_sequence(void **state)
+{
+    pcmk__xml_archive_t *archive = NULL;
+    xmlNode *input = new_input();
+    xmlNode *xml = NULL;
+
+    assert_int_equal(pcmk__xml_archive_open(directory, SERIES, INTERVAL,
+                                            &archive), pcmk_rc_ok);
+    assert_int_equal(pcmk__xml_archive_add(archive, 0, input), pcmk_rc_ok);
+    assert_int_equal(pcmk__xml_archive_read(directory, SERIES, 1, &xml),
+                     ENOENT);
+    assert_null(xml);
+
+    pcmk__xml_archive_free(archive);
+    pcmk__xml_free(input);
+}
+
+static void
+same_content_stored_once(void **state)
+{
+    pcmk__xml_archive_t *archive = NULL;
+    xmlNode *input = new_input();
+    char *expected = serialize(input);
+
+    assert_int_equal(pcmk__xml_archive_open(directory, SERIES, INTERVAL,
+                                            &archive), pcmk_rc_ok);
+    for (unsigned int seq = 0; seq < 3; seq++) {
+        assert_int_equal(pcmk__xml_archive_add(archive, seq, input),
+                         pcmk_rc_ok);
+    }
+    pcmk__xml_archive_free(archive);
+
+    // Index and a single full snapshot
+    assert_int_equal(count_files(), 2);
+
+    for (unsigned int seq = 0; seq < 3; seq++) {
+        xmlNode *xml = NULL;
+        char *actual = NULL;
+
+        assert_int_equal(pcmk__xml_archive_read(directory, SERIES, seq, &xml),
+                         pcmk_rc_ok);
+        actual = serialize(xml);
+        assert_string_equal(actual, expected);
+        free(actual);
+        pcmk__xml_free(xml);
+    }
+
+    free(expected);
+    pcmk__xml_free(input);
+}
+
+static void
+reconstruct_random_inputs(void **state)
+{
+    GRand *rand = g_rand_new_with_seed(20240101);
+    pcmk__xml_archive_t *archive = NULL;
+    xmlNode *input = new_input();
+    char *expected[WRAP] = { NULL, };
+
+    assert_int_equal(pcmk__xml_archive_open(directory, SERIES, INTERVAL,
+                                            &archive), pcmk_rc_ok);
+
+    // Go around the series several times, reopening the archive midway
+    for (int n = 0; n < (WRAP * 4) + 7; n++) {
+        unsigned int seq = n % WRAP;
+
+        if (n == (WRAP * 2) + 3) {
+            pcmk__xml_archive_free(archive);
+            archive = NULL;
+            assert_int_equal(pcmk__xml_archive_open(directory, SERIES,
+                                                    INTERVAL, &archive),
+                             pcmk_rc_ok);
+        }
+
+        mutate(rand, input, n);
+        free(expected[seq]);
+        expected[seq] = serialize(input);
+        assert_int_equal(pcmk__xml_archive_add(archive, seq, input),
+                         pcmk_rc_ok);
+    }
+    pcmk__xml_archive_free(archive);
+
+    // Superseded snapshots and deltas must have been removed
+    assert_true(count_files() <= (1 + WRAP + INTERVAL));
+
+    for (int i = 0; i < WRAP * 2; i++) {
+        unsigned int seq = g_rand_int_range(rand, 0, WRAP);
+        xmlNode *xml = NULL;
+        char *actual = NULL;
+
+        if ((i % 2) == 0) {
+            assert_int_equal(pcmk__xml_archive_read(directory, SERIES, seq,
+                                                    &xml),
+                             pcmk_rc_ok);
+        } else {
+            // The usual file name must work for tools that read inputs
+            char *filename = pcmk__series_filename(directory, SERIES, seq,
+                                                   true);
+
+            xml = pcmk__xml_read(filename);
+            free(filename);
+        }
+
+        assert_non_null(xml);
+        actual = serialize(xml);
+        assert_string_equal(actual, expected[seq]);
+        free(actual);
+        pcmk__xml_free(xml);
+    }
+
+    for (int seq = 0; seq < WRAP; seq++) {
+        free(expected[seq]);
+    }
+    pcmk__xml_free(input);
+    g_rand_free(rand);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(invalid_arguments),
+                cmocka_unit_test_setup_teardown(no_archive, setup, teardown),
+                cmocka_unit_test_setup_teardown(missing_sequence, setup,
+                                                teardown),
+                cmocka_unit_test_setup_teardown(same_content_stored_once,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(reconstruct_random_inputs,
+                                                setup, teardown))
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <crm/common/unittest_internal.h>
+#include "crmcommon_private.h"
+
+#define MESSAGE "<test id=\"multipart\"/>"
+
+static int
+add_part(GByteArray *parts, uint32_t flags, const char *data, uint32_t len)
+{
+    pcmk__ipc_header_t header = { 0, };
+
+    header.qb.size = sizeof(pcmk__ipc_header_t) + len;
+    header.qb.id = 1;
+    header.size_uncompressed = sizeof(MESSAGE);
+    header.flags = flags;
+    header.version = PCMK__IPC_MULTIPART_VERSION;
+    return pcmk__ipc_add_part(parts, &header, data);
+}
+
+static void
+null_args(void **state)
+{
+    GByteArray *parts = g_byte_array_new();
+    pcmk__ipc_header_t header = { 0, };
+
+    header.qb.size = sizeof(pcmk__ipc_header_t);
+    assert_int_equal(pcmk__ipc_add_part(NULL, &header, MESSAGE), EINVAL);
+    assert_int_equal(pcmk__ipc_add_part(parts, NULL, MESSAGE), EINVAL);
+    assert_int_equal(pcmk__ipc_add_part(parts, &header, NULL), EINVAL);
+    g_byte_array_free(parts, TRUE);
+}
+
+static void
+reassemble(void **state)
+{
+    GByteArray *parts = g_byte_array_new();
+
+    assert_int_equal(add_part(parts, pcmk__ipc_multipart, MESSAGE, 5), EAGAIN);
+    assert_int_equal(add_part(parts, pcmk__ipc_multipart, MESSAGE + 5, 10),
+                     EAGAIN);
+    assert_int_equal(add_part(parts,
+                              pcmk__ipc_multipart|pcmk__ipc_multipart_end,
+                              MESSAGE + 15, sizeof(MESSAGE) - 15),
+                     pcmk_rc_ok);
+
+    assert_int_equal(parts->len, sizeof(MESSAGE));
+    assert_string_equal((const char *) parts->data, MESSAGE);
+    g_byte_array_free(parts, TRUE);
+}
+
+static void
+single_part(void **state)
+{
+    GByteArray *parts = g_byte_array_new();
+
+    assert_int_equal(add_part(parts,
+                              pcmk__ipc_multipart|pcmk__ipc_multipart_end,
+                              MESSAGE, sizeof(MESSAGE)),
+                     pcmk_rc_ok);
+    assert_string_equal((const char *) parts->data, MESSAGE);
+    g_byte_array_free(parts, TRUE);
+}
+
+static void
+not_multipart(void **state)
+{
+    GByteArray *parts = g_byte_array_new();
+
+    assert_int_equal(add_part(parts, pcmk__ipc_multipart, MESSAGE, 5), EAGAIN);
+    assert_int_equal(add_part(parts, crm_ipc_server_event, MESSAGE + 5, 5),
+                     EBADMSG);
+    assert_int_equal(parts->len, 0);
+    g_byte_array_free(parts, TRUE);
+}
+
+static void
+too_much_data(void **state)
+{
+    GByteArray *parts = g_byte_array_new();
+
+    assert_int_equal(add_part(parts, pcmk__ipc_multipart, MESSAGE, 15),
+                     EAGAIN);
+    assert_int_equal(add_part(parts, pcmk__ipc_multipart, MESSAGE, 15),
+                     EBADMSG);
+    assert_int_equal(parts->len, 0);
+    g_byte_array_free(parts, TRUE);
+}
+
+static void
+too_little_data(void **state)
+{
+    GByteArray *parts = g_byte_array_new();
+
+    assert_int_equal(add_part(parts, pcmk__ipc_multipart, MESSAGE, 5), EAGAIN);
+    assert_int_equal(add_part(parts,
+                              pcmk__ipc_multipart|pcmk__ipc_multipart_end,
+                              MESSAGE + 5, 5),
+                     EBADMSG);
+    assert_int_equal(parts->len, 0);
+
+    // Parts end at the right size but without a terminating null byte
+    assert_int_equal(add_part(parts,
+                              pcmk__ipc_multipart|pcmk__ipc_multipart_end,
+                              "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx",
+                              sizeof(MESSAGE)),
+                     EBADMSG);
+    assert_int_equal(parts->len, 0);
+    g_byte_array_free(parts, TRUE);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(null_args),
+                cmocka_unit_test(reassemble),
+                cmocka_unit_test(single_part),
+                cmocka_unit_test(not_multipart),
+                cmocka_unit_test(too_much_data),
+                cmocka_unit_test(too_little_data))
@@ -0,0 +1,529 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <crm/common/ipc_internal.h>
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+
+#include "crmcommon_private.h"
+#include "mock_private.h"
+
+// Total size of events that can be queued for all clients before eviction
+#define BUDGET 1000000
+
+// Stand-ins for libqb connections (only their addresses are used)
+static int conn1 = 0;
+static int conn2 = 0;
+
+static pcmk__client_t *
+new_client(int *conn)
+{
+    pcmk__client_t *client = pcmk__new_unauth_client(conn);
+
+    client->ipcs = (qb_ipcs_connection_t *) conn;
+    pcmk__set_client_flags(client, pcmk__client_ipc);
+    return client;
+}
+
+/*!
+ * \internal
+ * \brief Create an event with a large, hard-to-compress attribute value
+ *
+ * \param[in] len  Length of attribute value
+ *
+ * \return Newly created XML
+ */
+static xmlNode *
+new_event(size_t len)
+{
+    xmlNode *xml = pcmk__xe_create(NULL, "test");
+    char *value = pcmk__assert_alloc(len + 1, sizeof(char));
+    uint32_t seed = 12345;
+
+    for (size_t i = 0; i < len; i++) {
+        seed = (seed * 1103515245) + 12345;
+        value[i] = "0123456789abcdef"[(seed >> 16) & 0xf];
+    }
+    crm_xml_add(xml, PCMK_XA_VALUE, value);
+    free(value);
+    return xml;
+}
+
+static void
+expect_sendv(int *conn, int err)
+{
+    expect_value(__wrap_qb_ipcs_event_sendv, c, conn);
+    expect_any(__wrap_qb_ipcs_event_sendv, iov);
+    expect_value(__wrap_qb_ipcs_event_sendv, iov_len, 2);
+    will_return(__wrap_qb_ipcs_event_sendv, err);
+}
+
+static void
+expect_response_sendv(int *conn, int err)
+{
+    expect_value(__wrap_qb_ipcs_response_sendv, c, conn);
+    expect_any(__wrap_qb_ipcs_response_sendv, iov);
+    expect_value(__wrap_qb_ipcs_response_sendv, iov_len, 2);
+    will_return(__wrap_qb_ipcs_response_sendv, err);
+}
+
+// Number of parts needed to send text that doesn't fit in one IPC buffer
+static guint
+parts_for_buffer(const GString *text, uint32_t buffer_size)
+{
+    size_t max_part = buffer_size - sizeof(pcmk__ipc_header_t) - 1;
+
+    return (guint) ((text->len + max_part) / max_part);
+}
+
+static guint
+expected_parts(const GString *text)
+{
+    return parts_for_buffer(text, crm_ipc_default_buffer_size());
+}
+
+static int
+send_event(pcmk__client_t *client, xmlNode *xml)
+{
+    struct iovec *iov = NULL;
+
+    assert_int_equal(pcmk__ipc_prepare_iov(0, xml, 0, &iov, NULL),
+                     pcmk_rc_ok);
+    return pcmk__ipc_send_iov(client, iov,
+                              crm_ipc_server_event|crm_ipc_server_free);
+}
+
+static int
+send_response(pcmk__client_t *client, uint32_t request, xmlNode *xml)
+{
+    struct iovec *iov = NULL;
+
+    assert_int_equal(pcmk__ipc_prepare_iov(request, xml,
+                                           (client->buffer_size > 0)?
+                                           client->buffer_size : 0,
+                                           &iov, NULL),
+                     pcmk_rc_ok);
+    return pcmk__ipc_send_iov(client, iov, crm_ipc_server_free);
+}
+
+// Reassemble parts sent as responses, checking that each fits in a buffer
+static void
+assert_response_parts(guint first, guint n_parts, uint32_t buffer_size,
+                      const GString *expected)
+{
+    GByteArray *parts = g_byte_array_new();
+
+    assert_int_equal(pcmk__mock_qb_ipcs_response_sent->len, first + n_parts);
+
+    for (guint i = first; i < (first + n_parts); i++) {
+        gsize size = 0;
+        const char *data = g_bytes_get_data(pcmk__mock_qb_ipcs_response_sent->pdata[i],
+                                            &size);
+        const pcmk__ipc_header_t *header = (const pcmk__ipc_header_t *) data;
+        int expected_rc = (i < (first + n_parts - 1))? EAGAIN : pcmk_rc_ok;
+
+        assert_true(size < buffer_size);
+        assert_int_equal(header->qb.size, size);
+        assert_true(pcmk_is_set(header->flags, pcmk__ipc_multipart));
+        assert_false(pcmk_is_set(header->flags, crm_ipc_server_event));
+        assert_int_equal(pcmk__ipc_add_part(parts, header,
+                                            data + sizeof(*header)),
+                         expected_rc);
+    }
+    assert_string_equal((const char *) parts->data, expected->str);
+    g_byte_array_free(parts, TRUE);
+}
+
+static int
+setup_group(void **state)
+{
+    char *budget = pcmk__itoa(BUDGET);
+
+    setenv("PCMK_" PCMK__ENV_IPC_QUEUE_BUDGET, budget, 1);
+    free(budget);
+    return pcmk__xml_test_setup_group(state);
+}
+
+static int
+setup(void **state)
+{
+    pcmk__mock_qb_ipcs_event_sendv = true;
+    pcmk__mock_qb_ipcs_response_sendv = true;
+    pcmk__mock_qb_ipcs_disconnect = true;
+    pcmk__mock_qb_ipcs_event_sent = g_ptr_array_new_with_free_func(
+                                        (GDestroyNotify) g_bytes_unref);
+    pcmk__mock_qb_ipcs_response_sent = g_ptr_array_new_with_free_func(
+                                           (GDestroyNotify) g_bytes_unref);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    pcmk__mock_qb_ipcs_event_sendv = false;
+    pcmk__mock_qb_ipcs_response_sendv = false;
+    pcmk__mock_qb_ipcs_disconnect = false;
+    g_ptr_array_free(pcmk__mock_qb_ipcs_event_sent, TRUE);
+    pcmk__mock_qb_ipcs_event_sent = NULL;
+    g_ptr_array_free(pcmk__mock_qb_ipcs_response_sent, TRUE);
+    pcmk__mock_qb_ipcs_response_sent = NULL;
+    return 0;
+}
+
+static void
+small_event_sent_whole(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(100);
+    const pcmk__ipc_header_t *header = NULL;
+
+    expect_sendv(&conn1, 0);
+    assert_int_equal(send_event(client, xml), pcmk_rc_ok);
+
+    assert_int_equal(pcmk__mock_qb_ipcs_event_sent->len, 1);
+    header = g_bytes_get_data(pcmk__mock_qb_ipcs_event_sent->pdata[0], NULL);
+    assert_false(pcmk_is_set(header->flags, pcmk__ipc_multipart));
+    assert_int_equal(header->version, PCMK__IPC_VERSION);
+    assert_int_equal(client->queued_bytes, 0);
+
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+static void
+large_event_sent_in_parts(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(4 * crm_ipc_default_buffer_size());
+    GString *expected = g_string_sized_new(1024);
+    GByteArray *parts = g_byte_array_new();
+    guint n_parts = 0;
+
+    pcmk__xml_string(xml, 0, expected, 0);
+    n_parts = expected_parts(expected);
+    assert_true(n_parts > 4);
+
+    for (guint i = 0; i < n_parts; i++) {
+        expect_sendv(&conn1, 0);
+    }
+    assert_int_equal(send_event(client, xml), pcmk_rc_ok);
+    assert_int_equal(pcmk__mock_qb_ipcs_event_sent->len, n_parts);
+
+    for (guint i = 0; i < n_parts; i++) {
+        gsize size = 0;
+        const char *data = g_bytes_get_data(pcmk__mock_qb_ipcs_event_sent->pdata[i],
+                                            &size);
+        const pcmk__ipc_header_t *header = (const pcmk__ipc_header_t *) data;
+
+        // Every part must fit in an IPC buffer
+        assert_true(size < crm_ipc_default_buffer_size());
+        assert_int_equal(header->qb.size, size);
+        assert_int_equal(header->version, PCMK__IPC_MULTIPART_VERSION);
+        assert_true(pcmk_is_set(header->flags, pcmk__ipc_multipart));
+        assert_true(pcmk_is_set(header->flags, crm_ipc_server_event));
+
+        if (i < (n_parts - 1)) {
+            assert_false(pcmk_is_set(header->flags, pcmk__ipc_multipart_end));
+            assert_int_equal(pcmk__ipc_add_part(parts, header,
+                                                data + sizeof(*header)),
+                             EAGAIN);
+        } else {
+            assert_true(pcmk_is_set(header->flags, pcmk__ipc_multipart_end));
+            assert_int_equal(pcmk__ipc_add_part(parts, header,
+                                                data + sizeof(*header)),
+                             pcmk_rc_ok);
+        }
+    }
+    assert_string_equal((const char *) parts->data, expected->str);
+    assert_int_equal(client->queued_bytes, 0);
+
+    g_byte_array_free(parts, TRUE);
+    g_string_free(expected, TRUE);
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+static void
+parts_resume_after_eagain(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(4 * crm_ipc_default_buffer_size());
+    xmlNode *small = new_event(100);
+    GString *text = g_string_sized_new(1024);
+    guint n_parts = 0;
+
+    pcmk__xml_string(xml, 0, text, 0);
+    n_parts = expected_parts(text);
+
+    // First part goes out, then the client falls behind
+    expect_sendv(&conn1, 0);
+    expect_sendv(&conn1, EAGAIN);
+    assert_int_equal(send_event(client, xml), EAGAIN);
+
+    assert_int_equal(pcmk__mock_qb_ipcs_event_sent->len, 1);
+    assert_int_equal(g_queue_get_length(client->event_queue), 1);
+    assert_true(client->event_offset > 0);
+    assert_true(client->queued_bytes > 0);
+
+    // Skip the delay before retrying, and queue another event behind it
+    g_source_remove(client->event_timer);
+    client->event_timer = 0;
+
+    // The remaining parts go out, then the small event, with no part resent
+    for (guint i = 0; i < n_parts; i++) {
+        expect_sendv(&conn1, 0);
+    }
+    assert_int_equal(send_event(client, small), pcmk_rc_ok);
+
+    assert_int_equal(pcmk__mock_qb_ipcs_event_sent->len, n_parts + 1);
+    assert_int_equal(g_queue_get_length(client->event_queue), 0);
+    assert_int_equal(client->event_offset, 0);
+    assert_int_equal(client->queued_bytes, 0);
+
+    g_string_free(text, TRUE);
+    pcmk__xml_free(xml);
+    pcmk__xml_free(small);
+    pcmk__free_client(client);
+}
+
+static void
+budget_evicts_largest(void **state)
+{
+    pcmk__client_t *client1 = new_client(&conn1);
+    pcmk__client_t *client2 = new_client(&conn2);
+    xmlNode *large = new_event(BUDGET / 10);
+    xmlNode *small = new_event(100);
+    size_t event_bytes = 0;
+
+    // Neither client is keeping up
+    expect_sendv(&conn2, EAGAIN);
+    assert_int_equal(send_event(client2, small), EAGAIN);
+
+    expect_sendv(&conn1, EAGAIN);
+    assert_int_equal(send_event(client1, large), EAGAIN);
+    event_bytes = client1->queued_bytes;
+
+    // Queue as many events as fit in the budget (retries are delayed)
+    while ((client1->queued_bytes + client2->queued_bytes + event_bytes)
+           <= BUDGET) {
+        assert_int_equal(send_event(client1, large), pcmk_rc_ok);
+    }
+    assert_true(g_queue_get_length(client1->event_queue) > 1);
+
+    // The next event exceeds the budget, and client1 has the largest backlog
+    expect_value(__wrap_qb_ipcs_disconnect, c, &conn1);
+    assert_int_equal(send_event(client1, large), pcmk_rc_ok);
+
+    assert_null(client1->event_queue);
+    assert_int_equal(client1->queued_bytes, 0);
+    assert_int_equal(g_queue_get_length(client2->event_queue), 1);
+    assert_true(client2->queued_bytes > 0);
+
+    pcmk__xml_free(large);
+    pcmk__xml_free(small);
+    pcmk__free_client(client1);
+    pcmk__free_client(client2);
+}
+
+static void
+small_response_sent_whole(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(100);
+    const pcmk__ipc_header_t *header = NULL;
+
+    expect_response_sendv(&conn1, 0);
+    assert_int_equal(send_response(client, 7, xml), pcmk_rc_ok);
+
+    assert_int_equal(pcmk__mock_qb_ipcs_response_sent->len, 1);
+    header = g_bytes_get_data(pcmk__mock_qb_ipcs_response_sent->pdata[0],
+                              NULL);
+    assert_int_equal(header->qb.id, 7);
+    assert_false(pcmk_is_set(header->flags, pcmk__ipc_multipart));
+    assert_true(g_queue_is_empty(client->response_queue));
+
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+static void
+large_response_sent_in_parts(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(4 * crm_ipc_default_buffer_size());
+    GString *expected = g_string_sized_new(1024);
+    guint n_parts = 0;
+
+    pcmk__xml_string(xml, 0, expected, 0);
+    n_parts = expected_parts(expected);
+
+    for (guint i = 0; i < n_parts; i++) {
+        expect_response_sendv(&conn1, 0);
+    }
+    assert_int_equal(send_response(client, 7, xml), pcmk_rc_ok);
+
+    assert_response_parts(0, n_parts, crm_ipc_default_buffer_size(),
+                          expected);
+    assert_true(g_queue_is_empty(client->response_queue));
+    assert_int_equal(client->response_offset, 0);
+
+    g_string_free(expected, TRUE);
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+static void
+response_parts_resume_after_eagain(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(4 * crm_ipc_default_buffer_size());
+    GString *expected = g_string_sized_new(1024);
+    guint n_parts = 0;
+
+    pcmk__xml_string(xml, 0, expected, 0);
+    n_parts = expected_parts(expected);
+
+    // First part goes out, then the client's response buffer is full
+    expect_response_sendv(&conn1, 0);
+    expect_response_sendv(&conn1, EAGAIN);
+    assert_int_equal(send_response(client, 7, xml), pcmk_rc_ok);
+
+    assert_int_equal(pcmk__mock_qb_ipcs_response_sent->len, 1);
+    assert_int_equal(g_queue_get_length(client->response_queue), 1);
+    assert_true(client->response_offset > 0);
+
+    // When the scheduled retry runs, the remaining parts go out, none resent
+    assert_true(client->event_timer != 0);
+    for (guint i = 1; i < n_parts; i++) {
+        expect_response_sendv(&conn1, 0);
+    }
+    while (client->event_timer != 0) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+
+    assert_response_parts(0, n_parts, crm_ipc_default_buffer_size(),
+                          expected);
+    assert_true(g_queue_is_empty(client->response_queue));
+    assert_int_equal(client->response_offset, 0);
+
+    g_string_free(expected, TRUE);
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+static void
+responses_stay_in_order(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(4 * crm_ipc_default_buffer_size());
+    xmlNode *small = new_event(100);
+    GString *expected = g_string_sized_new(1024);
+    const pcmk__ipc_header_t *header = NULL;
+    guint n_parts = 0;
+
+    pcmk__xml_string(xml, 0, expected, 0);
+    n_parts = expected_parts(expected);
+
+    expect_response_sendv(&conn1, EAGAIN);
+    assert_int_equal(send_response(client, 7, xml), pcmk_rc_ok);
+    assert_int_equal(pcmk__mock_qb_ipcs_response_sent->len, 0);
+
+    // A later response waits for the earlier one to be sent completely
+    g_source_remove(client->event_timer);
+    client->event_timer = 0;
+    for (guint i = 0; i < n_parts; i++) {
+        expect_response_sendv(&conn1, 0);
+    }
+    expect_response_sendv(&conn1, 0);
+    assert_int_equal(send_response(client, 8, small), pcmk_rc_ok);
+
+    assert_response_parts(0, n_parts, crm_ipc_default_buffer_size(),
+                          expected);
+    assert_int_equal(pcmk__mock_qb_ipcs_response_sent->len, n_parts + 1);
+    header = g_bytes_get_data(pcmk__mock_qb_ipcs_response_sent->pdata[n_parts],
+                              NULL);
+    assert_int_equal(header->qb.id, 8);
+
+    g_string_free(expected, TRUE);
+    pcmk__xml_free(xml);
+    pcmk__xml_free(small);
+    pcmk__free_client(client);
+}
+
+static void
+failed_response_dropped(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(4 * crm_ipc_default_buffer_size());
+
+    expect_response_sendv(&conn1, 0);
+    expect_response_sendv(&conn1, ENOTCONN);
+    assert_int_equal(send_response(client, 7, xml), ENOTCONN);
+
+    assert_null(client->response_queue);
+    assert_int_equal(client->response_offset, 0);
+
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+static void
+parts_sized_for_connection(void **state)
+{
+    pcmk__client_t *client = new_client(&conn1);
+    xmlNode *xml = new_event(crm_ipc_default_buffer_size());
+    GString *expected = g_string_sized_new(1024);
+    guint n_parts = 0;
+
+    // This connection has a smaller buffer than the default
+    client->buffer_size = crm_ipc_default_buffer_size() / 4;
+
+    pcmk__xml_string(xml, 0, expected, 0);
+    n_parts = parts_for_buffer(expected, client->buffer_size);
+    assert_true(n_parts > expected_parts(expected));
+
+    for (guint i = 0; i < n_parts; i++) {
+        expect_response_sendv(&conn1, 0);
+    }
+    assert_int_equal(send_response(client, 7, xml), pcmk_rc_ok);
+    assert_response_parts(0, n_parts, client->buffer_size, expected);
+
+    g_string_free(expected, TRUE);
+    pcmk__xml_free(xml);
+    pcmk__free_client(client);
+}
+
+PCMK__UNIT_TEST(setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test_setup_teardown(small_event_sent_whole,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(large_event_sent_in_parts,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(parts_resume_after_eagain,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(budget_evicts_largest,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(small_response_sent_whole,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(large_response_sent_in_parts,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(response_parts_resume_after_eagain,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(responses_stay_in_order,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(failed_response_dropped,
+                                                setup, teardown),
+                cmocka_unit_test_setup_teardown(parts_sized_for_connection,
+                                                setup, teardown))
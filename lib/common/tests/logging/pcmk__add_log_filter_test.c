@@ -0,0 +1,138 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <qb/qblog.h>
+
+#include <crm/common/unittest_internal.h>
+
+#include "crmcommon_private.h"
+
+#define NOW 1000
+
+static int
+teardown(void **state)
+{
+    pcmk__clear_log_filters();
+    return 0;
+}
+
+static struct qb_log_callsite
+callsite(const char *function, const char *filename, const char *format,
+         const char *tag)
+{
+    struct qb_log_callsite cs = {
+        .function = function,
+        .filename = filename,
+        .format = format,
+        .priority = LOG_TRACE,
+        .tags = (tag == NULL)? 0 : g_quark_from_string(tag),
+    };
+
+    return cs;
+}
+
+static void
+invalid_arguments(void **state)
+{
+    assert_int_equal(pcmk__add_log_filter(pcmk__log_filter_function, NULL, 0,
+                                          NOW),
+                     EINVAL);
+    assert_int_equal(pcmk__add_log_filter(pcmk__log_filter_function, "", 0,
+                                          NOW),
+                     EINVAL);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, ""));
+}
+
+static void
+add_and_remove(void **state)
+{
+    assert_int_equal(pcmk__add_log_filter(pcmk__log_filter_function, "fn", 0,
+                                          NOW),
+                     pcmk_rc_ok);
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_function, "fn"));
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_file, "fn"));
+
+    // Adding the same filter again is not an error
+    assert_int_equal(pcmk__add_log_filter(pcmk__log_filter_function, "fn", 0,
+                                          NOW),
+                     pcmk_rc_ok);
+
+    assert_int_equal(pcmk__remove_log_filter(pcmk__log_filter_function, "fn"),
+                     pcmk_rc_ok);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "fn"));
+    assert_int_equal(pcmk__remove_log_filter(pcmk__log_filter_function, "fn"),
+                     ENXIO);
+}
+
+static void
+match_function(void **state)
+{
+    struct qb_log_callsite cs = callsite("unpack_config", "unpack.c",
+                                         "Unpacking %s", NULL);
+
+    assert_false(pcmk__log_filter_matches(&cs));
+    pcmk__add_log_filter(pcmk__log_filter_function, "unpack", 0, NOW);
+    assert_false(pcmk__log_filter_matches(&cs));
+    pcmk__add_log_filter(pcmk__log_filter_function, "unpack_config", 0, NOW);
+    assert_true(pcmk__log_filter_matches(&cs));
+}
+
+static void
+match_file(void **state)
+{
+    struct qb_log_callsite with_dir = callsite("f", "lib/pengine/unpack.c",
+                                               "text", NULL);
+    struct qb_log_callsite without_dir = callsite("f", "unpack.c", "text",
+                                                  NULL);
+
+    pcmk__add_log_filter(pcmk__log_filter_file, "unpack.c", 0, NOW);
+    assert_true(pcmk__log_filter_matches(&with_dir));
+    assert_true(pcmk__log_filter_matches(&without_dir));
+
+    pcmk__clear_log_filters();
+    pcmk__add_log_filter(pcmk__log_filter_file, "lib/pengine/unpack.c", 0,
+                         NOW);
+    assert_true(pcmk__log_filter_matches(&with_dir));
+    assert_false(pcmk__log_filter_matches(&without_dir));
+}
+
+static void
+match_format(void **state)
+{
+    struct qb_log_callsite cs = callsite("f", "file.c",
+                                         "Resource %s is now active", NULL);
+
+    pcmk__add_log_filter(pcmk__log_filter_format, "inactive", 0, NOW);
+    assert_false(pcmk__log_filter_matches(&cs));
+    pcmk__add_log_filter(pcmk__log_filter_format, "now active", 0, NOW);
+    assert_true(pcmk__log_filter_matches(&cs));
+}
+
+static void
+match_tag(void **state)
+{
+    struct qb_log_callsite tagged = callsite("f", "file.c", "text", "rsc1");
+    struct qb_log_callsite untagged = callsite("f", "file.c", "text", NULL);
+
+    pcmk__add_log_filter(pcmk__log_filter_tag, "rsc2", 0, NOW);
+    assert_false(pcmk__log_filter_matches(&tagged));
+    pcmk__add_log_filter(pcmk__log_filter_tag, "rsc1", 0, NOW);
+    assert_true(pcmk__log_filter_matches(&tagged));
+    assert_false(pcmk__log_filter_matches(&untagged));
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test_teardown(invalid_arguments, teardown),
+                cmocka_unit_test_teardown(add_and_remove, teardown),
+                cmocka_unit_test_teardown(match_function, teardown),
+                cmocka_unit_test_teardown(match_file, teardown),
+                cmocka_unit_test_teardown(match_format, teardown),
+                cmocka_unit_test_teardown(match_tag, teardown))
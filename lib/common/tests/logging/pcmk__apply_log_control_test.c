@@ -0,0 +1,173 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+
+#define NOW 1000
+
+static int
+teardown(void **state)
+{
+    pcmk__clear_log_filters();
+    pcmk__expire_log_control(G_MAXINT);
+    set_crm_log_level(LOG_INFO);
+    return 0;
+}
+
+static xmlNode *
+new_request(const char *level, const char *ttl)
+{
+    xmlNode *request = pcmk__xe_create(NULL, PCMK__XE_LOG_CONTROL);
+
+    crm_xml_add(request, PCMK__XA_LOG_LEVEL, level);
+    crm_xml_add(request, PCMK__XA_TTL, ttl);
+    return request;
+}
+
+static void
+add_filter(xmlNode *request, const char *action, const char *type,
+           const char *name)
+{
+    xmlNode *filter = pcmk__xe_create(request, PCMK__XE_LOG_FILTER);
+
+    crm_xml_add(filter, PCMK_XA_ACTION, action);
+    crm_xml_add(filter, PCMK_XA_TYPE, type);
+    crm_xml_add(filter, PCMK_XA_NAME, name);
+}
+
+static void
+assert_rejected(xmlNode *request)
+{
+    char *reason = NULL;
+
+    assert_int_equal(pcmk__apply_log_control(request, NOW, &reason),
+                     pcmk_rc_bad_input);
+    assert_non_null(reason);
+    free(reason);
+    pcmk__xml_free(request);
+
+    // Nothing may have been applied
+    assert_int_equal(get_crm_log_level(), LOG_INFO);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "fn"));
+}
+
+static void
+invalid_requests(void **state)
+{
+    xmlNode *request = NULL;
+
+    set_crm_log_level(LOG_INFO);
+
+    assert_rejected(new_request("loud", NULL));
+    assert_rejected(new_request("debug", "soon"));
+
+    request = new_request("debug", NULL);
+    add_filter(request, "add", "function", "fn");
+    add_filter(request, "replace", "function", "other");
+    assert_rejected(request);
+
+    request = new_request("debug", NULL);
+    add_filter(request, "add", "function", "fn");
+    add_filter(request, "add", "line", "42");
+    assert_rejected(request);
+
+    request = new_request("debug", NULL);
+    add_filter(request, "add", "function", "fn");
+    add_filter(request, "add", "tag", NULL);
+    assert_rejected(request);
+}
+
+static void
+query(void **state)
+{
+    xmlNode *request = new_request(NULL, NULL);
+    xmlNode *reply = pcmk__xe_create(NULL, PCMK__XE_LOG_CONTROL);
+    char *reason = NULL;
+
+    set_crm_log_level(LOG_NOTICE);
+    pcmk__add_log_filter(pcmk__log_filter_file, "unpack.c", 60, NOW);
+
+    assert_int_equal(pcmk__apply_log_control(request, NOW, &reason),
+                     pcmk_rc_ok);
+    assert_null(reason);
+    assert_int_equal(get_crm_log_level(), LOG_NOTICE);
+
+    pcmk__log_control_state(reply, NOW + 20);
+    assert_string_equal(crm_element_value(reply, PCMK__XA_LOG_LEVEL),
+                        "notice");
+    assert_null(crm_element_value(reply, PCMK__XA_TTL));
+    assert_string_equal(crm_element_value(reply->children, PCMK_XA_TYPE),
+                        "file");
+    assert_string_equal(crm_element_value(reply->children, PCMK_XA_NAME),
+                        "unpack.c");
+    assert_string_equal(crm_element_value(reply->children, PCMK__XA_TTL),
+                        "40");
+
+    pcmk__xml_free(request);
+    pcmk__xml_free(reply);
+}
+
+static void
+apply_with_ttl(void **state)
+{
+    xmlNode *request = new_request("trace", "300");
+    char *reason = NULL;
+
+    set_crm_log_level(LOG_INFO);
+    add_filter(request, "add", "function", "fn");
+    add_filter(request, "add", "format", "Unpacking");
+    crm_xml_add(request->last, PCMK__XA_TTL, "0");
+
+    assert_int_equal(pcmk__apply_log_control(request, NOW, &reason),
+                     pcmk_rc_ok);
+    assert_null(reason);
+    assert_int_equal(get_crm_log_level(), LOG_TRACE);
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_function, "fn"));
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_format,
+                                        "Unpacking"));
+
+    pcmk__expire_log_control(NOW + 300);
+    assert_int_equal(get_crm_log_level(), LOG_INFO);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "fn"));
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_format,
+                                        "Unpacking"));
+
+    pcmk__xml_free(request);
+}
+
+static void
+clear_and_remove(void **state)
+{
+    xmlNode *request = new_request(NULL, NULL);
+    char *reason = NULL;
+
+    pcmk__add_log_filter(pcmk__log_filter_function, "old1", 0, NOW);
+    pcmk__add_log_filter(pcmk__log_filter_function, "old2", 0, NOW);
+    add_filter(request, "clear", NULL, NULL);
+    add_filter(request, "add", "tag", "rsc1");
+    add_filter(request, "remove", "tag", "rsc2");
+
+    // A missing filter is reported, but the rest of the request applies
+    assert_int_equal(pcmk__apply_log_control(request, NOW, &reason), ENXIO);
+    assert_non_null(reason);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "old1"));
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "old2"));
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_tag, "rsc1"));
+
+    free(reason);
+    pcmk__xml_free(request);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test_teardown(invalid_requests, teardown),
+                cmocka_unit_test_teardown(query, teardown),
+                cmocka_unit_test_teardown(apply_with_ttl, teardown),
+                cmocka_unit_test_teardown(clear_and_remove, teardown))
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+
+#include <crm/common/unittest_internal.h>
+
+static GString *handled = NULL;
+
+G_GNUC_PRINTF(2, 3)
+static void
+handle_config_message(void *ctx, const char *msg, ...)
+{
+    va_list ap;
+
+    va_start(ap, msg);
+    g_string_append_vprintf(handled, msg, ap);
+    g_string_append_c(handled, '\n');
+    va_end(ap);
+}
+
+// Forget any messages handled by previous tests
+static void
+reset(void)
+{
+    g_string_truncate(handled, 0);
+    pcmk__config_has_error = false;
+    pcmk__config_has_warning = false;
+}
+
+static int
+setup(void **state)
+{
+    handled = g_string_new(NULL);
+    pcmk__set_config_error_handler(handle_config_message, NULL);
+    pcmk__set_config_warning_handler(handle_config_message, NULL);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    pcmk__set_config_error_handler(NULL, NULL);
+    pcmk__set_config_warning_handler(NULL, NULL);
+    g_string_free(handled, TRUE);
+    handled = NULL;
+    return 0;
+}
+
+static void
+not_capturing(void **state)
+{
+    GList *captured = NULL;
+
+    reset();
+
+    assert_false(pcmk__capturing_logs());
+    pcmk__capture_logs(&captured);
+    assert_true(pcmk__capturing_logs());
+    pcmk__capture_logs(NULL);
+    assert_false(pcmk__capturing_logs());
+    assert_null(captured);
+
+    // Messages are handled immediately when not capturing
+    pcmk__config_err("direct %d", 1);
+    assert_true(pcmk__config_has_error);
+    assert_string_equal(handled->str, "direct 1\n");
+}
+
+static void
+capture_and_replay(void **state)
+{
+    GList *captured = NULL;
+
+    reset();
+
+    pcmk__capture_logs(&captured);
+    crm_err("not %s", "shown");
+    pcmk__config_warn("first %d", 1);
+    crm_info("also not %s", "shown");
+    pcmk__config_err("second %d", 2);
+    pcmk__capture_logs(NULL);
+
+    // Nothing is handled (or flagged) until the messages are replayed
+    assert_int_equal(g_list_length(captured), 4);
+    assert_false(pcmk__config_has_error);
+    assert_false(pcmk__config_has_warning);
+    assert_string_equal(handled->str, "");
+
+    pcmk__replay_logs(captured);
+    assert_true(pcmk__config_has_error);
+    assert_true(pcmk__config_has_warning);
+    assert_string_equal(handled->str, "first 1\nsecond 2\n");
+}
+
+static gpointer
+capture_in_thread(gpointer data)
+{
+    GList **captured = data;
+
+    pcmk__capture_logs(captured);
+    pcmk__config_err("from thread");
+    pcmk__capture_logs(NULL);
+    return NULL;
+}
+
+static void
+capture_is_per_thread(void **state)
+{
+    GList *captured = NULL;
+    GThread *thread = NULL;
+
+    reset();
+
+    thread = g_thread_new("capture", capture_in_thread, &captured);
+    g_thread_join(thread);
+    assert_false(pcmk__capturing_logs());
+    assert_int_equal(g_list_length(captured), 1);
+    assert_false(pcmk__config_has_error);
+
+    // The main thread was not capturing meanwhile
+    pcmk__config_warn("from main");
+    assert_string_equal(handled->str, "from main\n");
+
+    pcmk__replay_logs(captured);
+    assert_true(pcmk__config_has_error);
+    assert_string_equal(handled->str, "from main\nfrom thread\n");
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(not_capturing),
+                cmocka_unit_test(capture_and_replay),
+                cmocka_unit_test(capture_is_per_thread))
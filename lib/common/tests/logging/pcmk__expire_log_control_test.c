@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+
+#define NOW 1000
+
+static int
+teardown(void **state)
+{
+    pcmk__clear_log_filters();
+    pcmk__expire_log_control(G_MAXINT);
+    set_crm_log_level(LOG_INFO);
+    return 0;
+}
+
+static void
+nothing_to_expire(void **state)
+{
+    assert_int_equal(pcmk__expire_log_control(NOW), 0);
+
+    pcmk__add_log_filter(pcmk__log_filter_function, "permanent", 0, NOW);
+    assert_int_equal(pcmk__expire_log_control(NOW + 1000000), 0);
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_function,
+                                        "permanent"));
+}
+
+static void
+filters_expire(void **state)
+{
+    pcmk__add_log_filter(pcmk__log_filter_function, "short", 10, NOW);
+    pcmk__add_log_filter(pcmk__log_filter_function, "long", 60, NOW);
+    pcmk__add_log_filter(pcmk__log_filter_function, "forever", 0, NOW);
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 9), NOW + 10);
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_function, "short"));
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 10), NOW + 60);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "short"));
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_function, "long"));
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 60), 0);
+    assert_false(pcmk__log_filter_active(pcmk__log_filter_function, "long"));
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_function,
+                                        "forever"));
+}
+
+static void
+readding_filter_extends_ttl(void **state)
+{
+    pcmk__add_log_filter(pcmk__log_filter_tag, "rsc1", 10, NOW);
+    pcmk__add_log_filter(pcmk__log_filter_tag, "rsc1", 10, NOW + 5);
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 10), NOW + 15);
+    assert_true(pcmk__log_filter_active(pcmk__log_filter_tag, "rsc1"));
+}
+
+static void
+level_override_expires(void **state)
+{
+    set_crm_log_level(LOG_NOTICE);
+
+    pcmk__override_log_level(LOG_TRACE, 30, NOW);
+    assert_int_equal(get_crm_log_level(), LOG_TRACE);
+
+    // A second temporary change must not lose the original level
+    pcmk__override_log_level(LOG_DEBUG, 30, NOW + 10);
+    assert_int_equal(get_crm_log_level(), LOG_DEBUG);
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 39), NOW + 40);
+    assert_int_equal(get_crm_log_level(), LOG_DEBUG);
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 40), 0);
+    assert_int_equal(get_crm_log_level(), LOG_NOTICE);
+}
+
+static void
+permanent_level_cancels_override(void **state)
+{
+    set_crm_log_level(LOG_NOTICE);
+
+    pcmk__override_log_level(LOG_TRACE, 30, NOW);
+    pcmk__override_log_level(LOG_INFO, 0, NOW + 10);
+
+    assert_int_equal(pcmk__expire_log_control(NOW + 100), 0);
+    assert_int_equal(get_crm_log_level(), LOG_INFO);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test_teardown(nothing_to_expire, teardown),
+                cmocka_unit_test_teardown(filters_expire, teardown),
+                cmocka_unit_test_teardown(readding_filter_extends_ttl,
+                                          teardown),
+                cmocka_unit_test_teardown(level_override_expires, teardown),
+                cmocka_unit_test_teardown(permanent_level_cancels_override,
+                                          teardown))
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+
+static void
+invalid_input(void **state)
+{
+    unsigned int level = 0;
+
+    assert_int_equal(pcmk__parse_log_level(NULL, &level), pcmk_rc_bad_input);
+    assert_int_equal(pcmk__parse_log_level("", &level), pcmk_rc_bad_input);
+    assert_int_equal(pcmk__parse_log_level("loud", &level), pcmk_rc_bad_input);
+    assert_int_equal(pcmk__parse_log_level("-1", &level), pcmk_rc_bad_input);
+    assert_int_equal(pcmk__parse_log_level("9", &level), pcmk_rc_bad_input);
+    assert_int_equal(pcmk__parse_log_level("3x", &level), pcmk_rc_bad_input);
+}
+
+static void
+names(void **state)
+{
+    unsigned int level = 0;
+
+    assert_int_equal(pcmk__parse_log_level("emerg", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_EMERG);
+    assert_int_equal(pcmk__parse_log_level("error", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_ERR);
+    assert_int_equal(pcmk__parse_log_level("Notice", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_NOTICE);
+    assert_int_equal(pcmk__parse_log_level("TRACE", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_TRACE);
+}
+
+static void
+numbers(void **state)
+{
+    unsigned int level = 0;
+
+    assert_int_equal(pcmk__parse_log_level("0", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_EMERG);
+    assert_int_equal(pcmk__parse_log_level("7", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_DEBUG);
+    assert_int_equal(pcmk__parse_log_level("8", &level), pcmk_rc_ok);
+    assert_int_equal(level, LOG_TRACE);
+}
+
+static void
+level_text(void **state)
+{
+    assert_string_equal(pcmk__log_level_text(LOG_WARNING), "warning");
+    assert_string_equal(pcmk__log_level_text(LOG_TRACE), "trace");
+    assert_string_equal(pcmk__log_level_text(LOG_TRACE + 5), "trace");
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(invalid_input),
+                cmocka_unit_test(names),
+                cmocka_unit_test(numbers),
+                cmocka_unit_test(level_text))
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <crm/common/mainloop.h>
+#include <crm/common/unittest_internal.h>
+
+#define BURN_CPU_MS     250
+#define BURN_MEMORY_KB  (64 * 1024)
+
+static GMainLoop *loop = NULL;
+static pcmk__rusage_t reaped_usage;
+static int reaped_exitcode = -1;
+
+static void
+child_done(mainloop_child_t *child, pid_t pid, int core, int signo,
+           int exitcode)
+{
+    reaped_usage = *pcmk__mainloop_child_rusage(child);
+    reaped_exitcode = exitcode;
+    g_main_loop_quit(loop);
+}
+
+static gboolean
+give_up(gpointer user_data)
+{
+    g_main_loop_quit(loop);
+    return G_SOURCE_REMOVE;
+}
+
+// Run the main loop until a child process started by a test is reaped
+static void
+reap(pid_t pid, const char *desc)
+{
+    guint timer = 0;
+
+    assert_true(pid > 0);
+    memset(&reaped_usage, 0, sizeof(reaped_usage));
+    reaped_exitcode = -1;
+
+    mainloop_child_add(pid, 0, desc, NULL, child_done);
+    timer = g_timeout_add_seconds(10, give_up, NULL);
+    g_main_loop_run(loop);
+    g_source_remove(timer);
+
+    assert_int_equal(reaped_exitcode, 0);
+}
+
+static void
+null_child(void **state)
+{
+    pcmk__assert_asserts(pcmk__mainloop_child_rusage(NULL));
+}
+
+// Stand-in for an agent that uses a lot of CPU
+static void
+cpu_burner(void **state)
+{
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        while (clock() < ((BURN_CPU_MS * CLOCKS_PER_SEC) / 1000)) {
+            // Keep busy
+        }
+        _exit(0);
+    }
+    reap(pid, "cpu-burner");
+
+#ifdef HAVE_WAIT4
+    assert_true((reaped_usage.user_ms + reaped_usage.system_ms)
+                >= (BURN_CPU_MS - 20));
+    assert_true(reaped_usage.user_ms >= (BURN_CPU_MS / 2));
+#else
+    assert_int_equal(reaped_usage.user_ms, 0);
+#endif
+}
+
+// Stand-in for an agent that uses a lot of memory
+static void
+memory_burner(void **state)
+{
+    pid_t pid = fork();
+
+    if (pid == 0) {
+        char *buf = malloc(BURN_MEMORY_KB * 1024);
+
+        if (buf == NULL) {
+            _exit(1);
+        }
+
+        // Touch every page, and use the result so it isn't optimized away
+        memset(buf, 1, BURN_MEMORY_KB * 1024);
+        _exit(buf[BURN_MEMORY_KB] - 1);
+    }
+    reap(pid, "memory-burner");
+
+#ifdef HAVE_WAIT4
+    assert_true(reaped_usage.max_rss_kb >= BURN_MEMORY_KB);
+#else
+    assert_int_equal(reaped_usage.max_rss_kb, 0);
+#endif
+}
+
+static int
+setup(void **state)
+{
+    loop = g_main_loop_new(NULL, FALSE);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    g_main_loop_unref(loop);
+    loop = NULL;
+    return 0;
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(null_child),
+                cmocka_unit_test(cpu_burner),
+                cmocka_unit_test(memory_burner))
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <crm/common/unittest_internal.h>
+
+#define BURN_CPU_MS     250
+#define BURN_MEMORY_KB  (64 * 1024)
+
+// Stand-in for an agent that uses a lot of CPU
+static pid_t
+fork_cpu_burner(void)
+{
+    pid_t pid = fork();
+
+    assert_true(pid >= 0);
+    if (pid == 0) {
+        while (clock() < ((BURN_CPU_MS * CLOCKS_PER_SEC) / 1000)) {
+            // Keep busy
+        }
+        _exit(0);
+    }
+    return pid;
+}
+
+// Stand-in for an agent that uses a lot of memory
+static pid_t
+fork_memory_burner(void)
+{
+    pid_t pid = fork();
+
+    assert_true(pid >= 0);
+    if (pid == 0) {
+        char *buf = malloc(BURN_MEMORY_KB * 1024);
+
+        if (buf == NULL) {
+            _exit(1);
+        }
+        // Touch every page, and use the result so it isn't optimized away
+        memset(buf, 1, BURN_MEMORY_KB * 1024);
+        _exit(buf[BURN_MEMORY_KB] - 1);
+    }
+    return pid;
+}
+
+static void
+null_usage(void **state)
+{
+    int status = 0;
+
+    pcmk__assert_asserts(pcmk__wait_rusage(getpid(), &status, WNOHANG, NULL));
+}
+
+static void
+not_reaped(void **state)
+{
+    int status = 0;
+    pid_t pid = fork_cpu_burner();
+    pcmk__rusage_t usage = { 1, 1, 1, 1, 1 };
+
+    kill(pid, SIGSTOP);
+
+    // A child that is still running has no usage yet
+    assert_int_equal(pcmk__wait_rusage(pid, &status, WNOHANG, &usage), 0);
+    assert_int_equal(usage.user_ms, 0);
+    assert_int_equal(usage.system_ms, 0);
+    assert_int_equal(usage.max_rss_kb, 0);
+    assert_int_equal(usage.blocks_in, 0);
+    assert_int_equal(usage.blocks_out, 0);
+
+    kill(pid, SIGKILL);
+    assert_int_equal(pcmk__wait_rusage(pid, &status, 0, &usage), pid);
+    assert_true(WIFSIGNALED(status));
+}
+
+static void
+cpu_burner(void **state)
+{
+#ifdef HAVE_WAIT4
+    int status = 0;
+    pid_t pid = fork_cpu_burner();
+    pcmk__rusage_t usage;
+
+    assert_int_equal(pcmk__wait_rusage(pid, &status, 0, &usage), pid);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(WEXITSTATUS(status), 0);
+
+    // Allow for clock granularity, but most of the time must be user time
+    assert_true((usage.user_ms + usage.system_ms) >= (BURN_CPU_MS - 20));
+    assert_true(usage.user_ms >= (BURN_CPU_MS / 2));
+    assert_true(usage.max_rss_kb > 0);
+#else
+    skip();
+#endif
+}
+
+static void
+memory_burner(void **state)
+{
+#ifdef HAVE_WAIT4
+    int status = 0;
+    pid_t pid = fork_memory_burner();
+    pcmk__rusage_t usage;
+
+    assert_int_equal(pcmk__wait_rusage(pid, &status, 0, &usage), pid);
+    assert_true(WIFEXITED(status));
+    assert_int_equal(WEXITSTATUS(status), 0);
+    assert_true(usage.max_rss_kb >= BURN_MEMORY_KB);
+#else
+    skip();
+#endif
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(null_usage),
+                cmocka_unit_test(not_reaped),
+                cmocka_unit_test(cpu_burner),
+                cmocka_unit_test(memory_burner))
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdint.h>
+
+#include <crm/common/unittest_internal.h>
+
+static void
+small_values(void **state)
+{
+    for (uint64_t value = 0; value < 8; value++) {
+        assert_int_equal(pcmk__histogram_bucket(value), value);
+        assert_int_equal(pcmk__histogram_bucket_min(value), value);
+        assert_int_equal(pcmk__histogram_bucket_max(value), value);
+    }
+}
+
+static void
+known_buckets(void **state)
+{
+    assert_int_equal(pcmk__histogram_bucket(8), 8);
+    assert_int_equal(pcmk__histogram_bucket(15), 15);
+    assert_int_equal(pcmk__histogram_bucket(16), 16);
+    assert_int_equal(pcmk__histogram_bucket(17), 16);
+    assert_int_equal(pcmk__histogram_bucket(18), 17);
+    assert_int_equal(pcmk__histogram_bucket(50), 28);
+    assert_int_equal(pcmk__histogram_bucket_min(28), 48);
+    assert_int_equal(pcmk__histogram_bucket_max(28), 51);
+    assert_int_equal(pcmk__histogram_bucket(UINT64_MAX),
+                     PCMK__HISTOGRAM_BUCKETS - 1);
+    assert_true(pcmk__histogram_bucket_max(PCMK__HISTOGRAM_BUCKETS - 1)
+                == UINT64_MAX);
+}
+
+static void
+buckets_are_contiguous(void **state)
+{
+    assert_int_equal(pcmk__histogram_bucket_min(0), 0);
+
+    for (unsigned int i = 0; i < PCMK__HISTOGRAM_BUCKETS - 1; i++) {
+        uint64_t min = pcmk__histogram_bucket_min(i);
+        uint64_t max = pcmk__histogram_bucket_max(i);
+
+        assert_true(min <= max);
+        assert_true(pcmk__histogram_bucket_min(i + 1) == max + 1);
+        assert_int_equal(pcmk__histogram_bucket(min), i);
+        assert_int_equal(pcmk__histogram_bucket(max), i);
+    }
+}
+
+static void
+relative_error_is_bounded(void **state)
+{
+    for (uint64_t value = 8; value < (UINT64_C(1) << 40);
+         value = (value * 3) + 1) {
+        unsigned int bucket = pcmk__histogram_bucket(value);
+        uint64_t min = pcmk__histogram_bucket_min(bucket);
+        uint64_t max = pcmk__histogram_bucket_max(bucket);
+
+        assert_true((min <= value) && (value <= max));
+        assert_true((max - min) <= (value / 8));
+    }
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(small_values),
+                cmocka_unit_test(known_buckets),
+                cmocka_unit_test(buckets_are_contiguous),
+                cmocka_unit_test(relative_error_is_bounded))
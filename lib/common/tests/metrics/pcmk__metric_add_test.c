@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+
+static pcmk__metric_t counter =
+    PCMK__METRIC(pcmk__metric_counter, "test_total", "Test counter");
+static pcmk__metric_t gauge =
+    PCMK__METRIC(pcmk__metric_gauge, "test_level", "Test gauge");
+
+static int
+reset(void **state)
+{
+    pcmk__reset_metrics();
+    return 0;
+}
+
+static void
+unused_metric(void **state)
+{
+    pcmk__metric_t unused =
+        PCMK__METRIC(pcmk__metric_counter, "unused_total", "Unused counter");
+
+    assert_int_equal(pcmk__metric_value(&unused), 0);
+}
+
+static void
+add_to_counter(void **state)
+{
+    pcmk__metric_add(&counter, 1);
+    pcmk__metric_add(&counter, 0);
+    pcmk__metric_add(&counter, 41);
+    assert_int_equal(pcmk__metric_value(&counter), 42);
+}
+
+static void
+add_to_gauge(void **state)
+{
+    pcmk__metric_add(&gauge, 10);
+    pcmk__metric_add(&gauge, -3);
+    assert_int_equal(pcmk__metric_value(&gauge), 7);
+
+    pcmk__metric_add(&gauge, -10);
+    assert_int_equal(pcmk__metric_value(&gauge), -3);
+}
+
+static void
+set_gauge(void **state)
+{
+    pcmk__metric_add(&gauge, 5);
+    pcmk__metric_set(&gauge, 100);
+    assert_int_equal(pcmk__metric_value(&gauge), 100);
+}
+
+static void
+reset_metrics(void **state)
+{
+    pcmk__metric_add(&counter, 5);
+    pcmk__metric_set(&gauge, 5);
+    pcmk__reset_metrics();
+    assert_int_equal(pcmk__metric_value(&counter), 0);
+    assert_int_equal(pcmk__metric_value(&gauge), 0);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(unused_metric),
+                cmocka_unit_test_setup(add_to_counter, reset),
+                cmocka_unit_test_setup(add_to_gauge, reset),
+                cmocka_unit_test_setup(set_gauge, reset),
+                cmocka_unit_test_setup(reset_metrics, reset))
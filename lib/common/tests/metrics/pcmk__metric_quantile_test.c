@@ -0,0 +1,90 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+
+static pcmk__metric_t histogram =
+    PCMK__METRIC(pcmk__metric_histogram, "test_us", "Test histogram");
+
+static int
+reset(void **state)
+{
+    pcmk__reset_metrics();
+    return 0;
+}
+
+static void
+no_observations(void **state)
+{
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.5), 0);
+    assert_int_equal(pcmk__metric_value(&histogram), 0);
+}
+
+static void
+single_observation(void **state)
+{
+    pcmk__metric_observe(&histogram, 1000);
+
+    assert_int_equal(pcmk__metric_value(&histogram), 1);
+
+    // The largest observed value caps the bucket's upper bound
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.0), 1000);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.5), 1000);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 1.0), 1000);
+}
+
+static void
+exact_small_values(void **state)
+{
+    for (uint64_t value = 1; value <= 4; value++) {
+        pcmk__metric_observe(&histogram, value);
+    }
+
+    assert_int_equal(pcmk__metric_value(&histogram), 4);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.25), 1);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.5), 2);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.75), 3);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 1.0), 4);
+}
+
+static void
+approximate_values(void **state)
+{
+    for (uint64_t value = 1; value <= 1000; value++) {
+        pcmk__metric_observe(&histogram, value);
+    }
+
+    assert_int_equal(pcmk__metric_value(&histogram), 1000);
+    assert_in_range(pcmk__metric_quantile(&histogram, 0.5), 500, 500 + 500 / 8);
+    assert_in_range(pcmk__metric_quantile(&histogram, 0.9), 900, 900 + 900 / 8);
+    assert_in_range(pcmk__metric_quantile(&histogram, 0.99), 990, 1000);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 1.0), 1000);
+}
+
+static void
+outliers(void **state)
+{
+    for (int i = 0; i < 99; i++) {
+        pcmk__metric_observe(&histogram, 10);
+    }
+    pcmk__metric_observe(&histogram, 1000000);
+
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.5), 10);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 0.99), 10);
+    assert_int_equal(pcmk__metric_quantile(&histogram, 1.0), 1000000);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test_setup(no_observations, reset),
+                cmocka_unit_test_setup(single_observation, reset),
+                cmocka_unit_test_setup(exact_small_values, reset),
+                cmocka_unit_test_setup(approximate_values, reset),
+                cmocka_unit_test_setup(outliers, reset))
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <crm/common/unittest_internal.h>
+
+static pcmk__metric_t requests =
+    PCMK__METRIC(pcmk__metric_counter, "test_requests_total", "Requests");
+static pcmk__metric_t duration =
+    PCMK__METRIC(pcmk__metric_histogram, "test_duration_us", "Duration");
+
+static void
+no_metrics(void **state)
+{
+    char *text = pcmk__metrics_text("test");
+
+    assert_string_equal(text, "");
+    free(text);
+}
+
+static void
+prometheus_format(void **state)
+{
+    char *text = NULL;
+
+    pcmk__metric_add(&requests, 3);
+    pcmk__metric_observe(&duration, 10);
+    text = pcmk__metrics_text("test");
+
+    // Metrics are sorted by name, and histograms are shown as summaries
+    assert_string_equal(text,
+        "# HELP pacemaker_test_duration_us Duration\n"
+        "# TYPE pacemaker_test_duration_us summary\n"
+        "pacemaker_test_duration_us{daemon=\"test\",quantile=\"0.5\"} 10\n"
+        "pacemaker_test_duration_us{daemon=\"test\",quantile=\"0.9\"} 10\n"
+        "pacemaker_test_duration_us{daemon=\"test\",quantile=\"0.99\"} 10\n"
+        "pacemaker_test_duration_us_sum{daemon=\"test\"} 10\n"
+        "pacemaker_test_duration_us_count{daemon=\"test\"} 1\n"
+        "# HELP pacemaker_test_requests_total Requests\n"
+        "# TYPE pacemaker_test_requests_total counter\n"
+        "pacemaker_test_requests_total{daemon=\"test\"} 3\n");
+    free(text);
+}
+
+// Must run after prometheus_format()
+static void
+reset_metrics_stay_registered(void **state)
+{
+    char *text = NULL;
+
+    pcmk__reset_metrics();
+    text = pcmk__metrics_text("test");
+    assert_non_null(strstr(text,
+                           "pacemaker_test_requests_total{daemon=\"test\"}"
+                           " 0\n"));
+    assert_non_null(strstr(text,
+                           "pacemaker_test_duration_us_count{daemon=\"test\"}"
+                           " 0\n"));
+    free(text);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test(no_metrics),
+                cmocka_unit_test(prometheus_format),
+                cmocka_unit_test(reset_metrics_stay_registered))
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+
+#define ORIG_CIB                                                            \
+    "<" PCMK_XE_CIB " " PCMK_XA_ADMIN_EPOCH "=\"0\""                        \
+                    " " PCMK_XA_EPOCH "=\"1\""                              \
+                    " " PCMK_XA_NUM_UPDATES "=\"0\">"                       \
+      "<" PCMK_XE_CONFIGURATION ">"                                         \
+        "<" PCMK_XE_CRM_CONFIG "/>"                                         \
+        "<" PCMK_XE_NODES ">"                                               \
+          "<" PCMK_XE_NODE " " PCMK_XA_ID "=\"1\""                          \
+                           " " PCMK_XA_UNAME "=\"node-1\"/>"                \
+        "</" PCMK_XE_NODES ">"                                              \
+        "<" PCMK_XE_RESOURCES "/>"                                          \
+        "<" PCMK_XE_CONSTRAINTS "/>"                                        \
+      "</" PCMK_XE_CONFIGURATION ">"                                        \
+      "<" PCMK_XE_STATUS ">"                                                \
+        "<" PCMK__XE_NODE_STATE " " PCMK_XA_ID "=\"1\""                     \
+                                " " PCMK_XA_UNAME "=\"node-1\">"            \
+          "<" PCMK__XE_LRM " " PCMK_XA_ID "=\"1\">"                         \
+            "<" PCMK__XE_LRM_RESOURCES ">"                                  \
+              "<" PCMK__XE_LRM_RESOURCE " " PCMK_XA_ID "=\"rsc1\"/>"        \
+            "</" PCMK__XE_LRM_RESOURCES ">"                                 \
+          "</" PCMK__XE_LRM ">"                                             \
+        "</" PCMK__XE_NODE_STATE ">"                                        \
+      "</" PCMK_XE_STATUS ">"                                               \
+    "</" PCMK_XE_CIB ">"
+
+#define XPATH_RSC1                                                          \
+    "//" PCMK__XE_LRM_RESOURCE "[@" PCMK_XA_ID "='rsc1']"
+
+// Free any PCMK__XE_LRM elements in a CIB
+static void
+prune(xmlNode *cib)
+{
+    xmlNode *lrm = NULL;
+
+    while ((lrm = get_xpath_object("//" PCMK__XE_LRM, cib,
+                                   LOG_NEVER)) != NULL) {
+        pcmk__xml_free(lrm);
+    }
+}
+
+static char *
+xml_text(const xmlNode *xml)
+{
+    GString *buffer = g_string_sized_new(1024);
+
+    pcmk__xml_string(xml, 0, buffer, 0);
+    return g_string_free(buffer, FALSE);
+}
+
+static void
+assert_same_xml(const xmlNode *xml1, const xmlNode *xml2)
+{
+    char *text1 = xml_text(xml1);
+    char *text2 = xml_text(xml2);
+
+    assert_string_equal(text1, text2);
+    free(text1);
+    free(text2);
+}
+
+static void
+null_args_assert(void **state)
+{
+    xmlNode *patchset = pcmk__xe_create(NULL, PCMK_XE_DIFF);
+
+    crm_xml_add_int(patchset, PCMK_XA_FORMAT, 2);
+    pcmk__assert_asserts(pcmk__patchset_without(NULL, PCMK__XE_LRM));
+    pcmk__assert_asserts(pcmk__patchset_without(patchset, NULL));
+    pcmk__xml_free(patchset);
+}
+
+static void
+unsupported_format(void **state)
+{
+    xmlNode *patchset = pcmk__xe_create(NULL, PCMK_XE_DIFF);
+
+    crm_xml_add_int(patchset, PCMK_XA_FORMAT, 1);
+    assert_null(pcmk__patchset_without(patchset, PCMK__XE_LRM));
+    pcmk__xml_free(patchset);
+}
+
+// Ways to change the CIB, as a stream of updates would
+enum change {
+    add_op,
+    update_op,
+    delete_op,
+    add_node_state,
+    add_transient_attr,
+    add_node,
+    delete_lrm,
+};
+
+static void
+make_change(xmlNode *cib, enum change change, int i)
+{
+    xmlNode *rsc = get_xpath_object(XPATH_RSC1, cib, LOG_NEVER);
+    xmlNode *xml = NULL;
+    char *id = crm_strdup_printf("%d", i);
+
+    switch (change) {
+        case add_op:
+            xml = pcmk__xe_create(rsc, PCMK__XE_LRM_RSC_OP);
+            crm_xml_add(xml, PCMK_XA_ID, id);
+            crm_xml_add_int(xml, PCMK__XA_CALL_ID, i);
+            break;
+
+        case update_op:
+            xml = pcmk__xe_first_child(rsc, PCMK__XE_LRM_RSC_OP, NULL, NULL);
+            crm_xml_add_int(xml, PCMK__XA_CALL_ID, i);
+            break;
+
+        case delete_op:
+            pcmk__xml_free(pcmk__xe_first_child(rsc, PCMK__XE_LRM_RSC_OP, NULL,
+                                                NULL));
+            break;
+
+        case add_node_state:
+            xml = get_xpath_object("//" PCMK_XE_STATUS, cib, LOG_NEVER);
+            xml = pcmk__xe_create(xml, PCMK__XE_NODE_STATE);
+            crm_xml_add(xml, PCMK_XA_ID, id);
+            xml = pcmk__xe_create(xml, PCMK__XE_LRM);
+            crm_xml_add(xml, PCMK_XA_ID, id);
+            pcmk__xe_create(xml, PCMK__XE_LRM_RESOURCES);
+            break;
+
+        case add_transient_attr:
+            xml = get_xpath_object("//" PCMK__XE_NODE_STATE, cib, LOG_NEVER);
+            xml = pcmk__xe_create(xml, PCMK__XE_TRANSIENT_ATTRIBUTES);
+            crm_xml_add(xml, PCMK_XA_ID, id);
+            break;
+
+        case add_node:
+            xml = get_xpath_object("//" PCMK_XE_NODES, cib, LOG_NEVER);
+            xml = pcmk__xe_create(xml, PCMK_XE_NODE);
+            crm_xml_add(xml, PCMK_XA_ID, id);
+            break;
+
+        case delete_lrm:
+            xml = get_xpath_object("//" PCMK__XE_NODE_STATE
+                                   "[@" PCMK_XA_ID "='1']/" PCMK__XE_LRM,
+                                   cib, LOG_NEVER);
+            pcmk__xml_free(xml);
+            break;
+    }
+    free(id);
+}
+
+/*!
+ * \internal
+ * \brief Make a change to a CIB, and apply it to a pruned copy
+ *
+ * \param[in,out] cib     CIB to change (replaced with changed version)
+ * \param[in,out] mirror  Copy of \p cib without PCMK__XE_LRM elements
+ * \param[in]     change  Change to make
+ * \param[in]     i       Number to use in new IDs and values
+ *
+ * \return Number of changes (other than the version) in the pruned patchset
+ */
+static int
+replay_change(xmlNode **cib, xmlNode *mirror, enum change change, int i)
+{
+    xmlNode *target = pcmk__xml_copy(NULL, *cib);
+    xmlNode *patchset = NULL;
+    xmlNode *pruned = NULL;
+    xmlNode *expected = NULL;
+    int n_changes = 0;
+
+    make_change(target, change, i);
+    xml_track_changes(target, NULL, NULL, false);
+    xml_calculate_significant_changes(*cib, target);
+    patchset = xml_create_patchset(2, *cib, target, NULL, true);
+    assert_non_null(patchset);
+    xml_accept_changes(target);
+    patchset_process_digest(patchset, *cib, target, true);
+
+    pruned = pcmk__patchset_without(patchset, PCMK__XE_LRM);
+    assert_non_null(pruned);
+    assert_null(crm_element_value(pruned, PCMK__XA_DIGEST));
+    assert_int_equal(xml_apply_patchset(mirror, pruned, true), pcmk_ok);
+
+    // The mirror must match a freshly pruned copy of the new CIB
+    expected = pcmk__xml_copy(NULL, target);
+    prune(expected);
+    assert_same_xml(mirror, expected);
+
+    for (xmlNode *child = pcmk__xe_first_child(pruned, PCMK_XE_CHANGE, NULL,
+                                               NULL);
+         child != NULL; child = pcmk__xe_next(child, PCMK_XE_CHANGE)) {
+
+        // Don't count the update of the CIB version
+        if (!pcmk__str_eq(crm_element_value(child, PCMK_XA_PATH),
+                          "/" PCMK_XE_CIB, pcmk__str_none)) {
+            n_changes++;
+        }
+    }
+
+    pcmk__xml_free(expected);
+    pcmk__xml_free(pruned);
+    pcmk__xml_free(patchset);
+    pcmk__xml_free(*cib);
+    *cib = target;
+    return n_changes;
+}
+
+static void
+history_changes_dropped(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(ORIG_CIB);
+    xmlNode *mirror = pcmk__xml_copy(NULL, cib);
+    char *before = NULL;
+    char *after = NULL;
+
+    prune(mirror);
+    before = xml_text(mirror);
+
+    /* Replay a stream of operation history updates. None of them should
+     * change the mirror or leave anything in the pruned patchsets to apply.
+     */
+    for (int i = 1; i <= 100; i++) {
+        assert_int_equal(replay_change(&cib, mirror, add_op, i), 0);
+        assert_int_equal(replay_change(&cib, mirror, update_op, i), 0);
+        if ((i % 2) == 0) {
+            assert_int_equal(replay_change(&cib, mirror, delete_op, i), 0);
+        }
+    }
+
+    // Only the version changed
+    crm_xml_add(mirror, PCMK_XA_NUM_UPDATES, "0");
+    after = xml_text(mirror);
+    assert_string_equal(before, after);
+
+    free(before);
+    free(after);
+    pcmk__xml_free(mirror);
+    pcmk__xml_free(cib);
+}
+
+static void
+other_changes_kept(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(ORIG_CIB);
+    xmlNode *mirror = pcmk__xml_copy(NULL, cib);
+
+    prune(mirror);
+
+    // New node state is kept, but its history is not
+    assert_int_equal(replay_change(&cib, mirror, add_node_state, 2), 1);
+    assert_non_null(get_xpath_object("//" PCMK__XE_NODE_STATE
+                                     "[@" PCMK_XA_ID "='2']", mirror,
+                                     LOG_NEVER));
+
+    assert_int_equal(replay_change(&cib, mirror, add_transient_attr, 3), 1);
+    assert_int_equal(replay_change(&cib, mirror, add_node, 4), 1);
+
+    // Mixed history and other changes
+    assert_int_equal(replay_change(&cib, mirror, add_op, 5), 0);
+    assert_int_equal(replay_change(&cib, mirror, delete_lrm, 6), 0);
+
+    pcmk__xml_free(mirror);
+    pcmk__xml_free(cib);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_args_assert),
+                cmocka_unit_test(unsupported_format),
+                cmocka_unit_test(history_changes_dropped),
+                cmocka_unit_test(other_changes_kept))
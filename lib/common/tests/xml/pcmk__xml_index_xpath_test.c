@@ -0,0 +1,332 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <libxml/xpath.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml_io_internal.h>
+
+#include "crmcommon_private.h"
+
+#define CIB_XML                                                             \
+    "<cib epoch='1' num_updates='0' admin_epoch='0'>"                       \
+      "<configuration>"                                                     \
+        "<crm_config/>"                                                     \
+        "<nodes>"                                                           \
+          "<node id='1' uname='node1'/>"                                    \
+          "<node id='2' uname='node2'/>"                                    \
+        "</nodes>"                                                          \
+        "<resources>"                                                       \
+          "<primitive id='rsc1' class='ocf' provider='pacemaker'"           \
+                     " type='Dummy'>"                                       \
+            "<meta_attributes id='rsc1-meta'>"                              \
+              "<nvpair id='rsc1-meta-target-role' name='target-role'"       \
+                     " value='Started'/>"                                   \
+            "</meta_attributes>"                                            \
+          "</primitive>"                                                    \
+          "<primitive id='RSC1' class='ocf' provider='pacemaker'"           \
+                     " type='Dummy'/>"                                      \
+          "<group id='grp'>"                                                \
+            "<primitive id='rsc2' class='ocf' provider='pacemaker'"         \
+                       " type='Dummy'/>"                                    \
+          "</group>"                                                        \
+        "</resources>"                                                      \
+        "<constraints/>"                                                    \
+      "</configuration>"                                                    \
+      "<status>"                                                            \
+        "<node_state id='1' uname='node1'>"                                 \
+          "<lrm id='1'>"                                                    \
+            "<lrm_resources>"                                               \
+              "<lrm_resource id='rsc1' type='Dummy' class='ocf'/>"          \
+            "</lrm_resources>"                                              \
+          "</lrm>"                                                          \
+        "</node_state>"                                                     \
+        "<node_state id='2' uname='node2'>"                                 \
+          "<lrm id='2'>"                                                    \
+            "<lrm_resources>"                                               \
+              "<lrm_resource id='rsc1' type='Dummy' class='ocf'/>"          \
+            "</lrm_resources>"                                              \
+          "</lrm>"                                                          \
+        "</node_state>"                                                     \
+      "</status>"                                                           \
+    "</cib>"
+
+// XPath expressions that the index can handle
+static const char *supported[] = {
+    "//primitive[@id='rsc1']",
+    "//primitive[@id=\"rsc1\"]",
+    "//primitive[@id='RSC1']",
+    "//primitive[@id='rsc2']",
+    "//primitive[@id='missing']",
+    "//*[@id='rsc1']",
+    "//*[@id='1']",
+    "//node[@id='1']",
+    "//node_state[@id='2']",
+    "//lrm_resource[@id='rsc1']",
+    "//nvpair[@id='rsc1-meta-target-role']",
+    "//cib[@id='x']",
+    "//group/primitive[@id='rsc2']",
+    "//resources/primitive[@id='rsc2']",
+    "//node_state[@id='2']/lrm/lrm_resources/lrm_resource[@id='rsc1']",
+    "/cib/configuration/resources/primitive[@id='rsc1']",
+    "/cib/configuration/resources/primitive[@id='rsc2']",
+    "/cib/configuration/resources/group[@id='grp']/primitive[@id='rsc2']",
+    "/cib/configuration/resources/group[@id='other']/primitive[@id='rsc2']",
+    "/cib/configuration/resources/primitive[@id='rsc1']"
+        "/meta_attributes[@id='rsc1-meta']"
+        "/nvpair[@id='rsc1-meta-target-role']",
+    "/cib/*/resources/*[@id='rsc1']",
+    "/configuration/resources/primitive[@id='rsc1']",
+    "/cib/status/node_state/lrm/lrm_resources/lrm_resource[@id='rsc1']",
+};
+
+// XPath expressions that the index can't handle
+static const char *unsupported[] = {
+    "//primitive",
+    "//primitive[@class='ocf']",
+    "//primitive[@id='rsc1' and @type='Dummy']",
+    "//primitive[@id='rsc1'][1]",
+    "//primitive[@id='rsc1']/@type",
+    "//primitive[@id='rsc1']//nvpair[@id='rsc1-meta-target-role']",
+    "//primitive[@id='rsc1'",
+    "//primitive[@id=rsc1]",
+    "//primitive[ @id='rsc1']",
+    "primitive[@id='rsc1']",
+    "/cib/configuration/resources/primitive",
+    "//primitive[@id='rsc1'] | //primitive[@id='rsc2']",
+};
+
+// Evaluate an XPath expression without using the index
+static xmlXPathObjectPtr
+evaluate(xmlNode *xml, const char *path)
+{
+    xmlXPathContextPtr ctx = xmlXPathNewContext(xml->doc);
+    xmlXPathObjectPtr result = NULL;
+
+    assert_non_null(ctx);
+    result = xmlXPathEvalExpression((pcmkXmlStr) path, ctx);
+    xmlXPathFreeContext(ctx);
+    assert_non_null(result);
+    return result;
+}
+
+static void
+assert_same_results(xmlNode *xml, const char *path)
+{
+    xmlXPathObjectPtr indexed = pcmk__xml_index_xpath(xml->doc, path);
+    xmlXPathObjectPtr expected = evaluate(xml, path);
+    int n_expected = numXpathResults(expected);
+
+    assert_non_null(indexed);
+    assert_int_equal(numXpathResults(indexed), n_expected);
+    for (int i = 0; i < n_expected; i++) {
+        assert_ptr_equal(indexed->nodesetval->nodeTab[i],
+                         expected->nodesetval->nodeTab[i]);
+    }
+
+    freeXpathObject(indexed);
+    freeXpathObject(expected);
+}
+
+static void
+assert_all_same_results(xmlNode *xml)
+{
+    for (int i = 0; i < PCMK__NELEM(supported); i++) {
+        assert_same_results(xml, supported[i]);
+    }
+}
+
+static void
+not_indexed(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+
+    assert_false(pcmk__xml_doc_ids_indexed(cib->doc));
+    assert_null(pcmk__xml_index_xpath(cib->doc, supported[0]));
+    pcmk__xml_free(cib);
+}
+
+static void
+unsupported_paths(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+
+    pcmk__xml_doc_index_ids(cib->doc);
+    for (int i = 0; i < PCMK__NELEM(unsupported); i++) {
+        assert_null(pcmk__xml_index_xpath(cib->doc, unsupported[i]));
+    }
+    pcmk__xml_free(cib);
+}
+
+static void
+same_as_xpath(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+
+    pcmk__xml_doc_index_ids(cib->doc);
+    assert_true(pcmk__xml_doc_ids_indexed(cib->doc));
+    assert_all_same_results(cib);
+    pcmk__xml_free(cib);
+}
+
+static void
+same_after_changes(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+    xmlNode *resources = NULL;
+    xmlNode *xml = NULL;
+
+    pcmk__xml_doc_index_ids(cib->doc);
+    resources = get_xpath_object("//resources", cib, LOG_NEVER);
+    assert_non_null(resources);
+
+    // Create a new element, then give it an ID
+    xml = pcmk__xe_create(resources, PCMK_XE_PRIMITIVE);
+    crm_xml_add(xml, PCMK_XA_ID, "rsc2");
+    assert_all_same_results(cib);
+
+    // Change an existing ID
+    crm_xml_add(xml, PCMK_XA_ID, "rsc3");
+    assert_all_same_results(cib);
+    crm_xml_add(xml, PCMK_XA_ID, "rsc1");
+    assert_all_same_results(cib);
+
+    // Remove an ID
+    pcmk__xe_remove_attr(xml, PCMK_XA_ID);
+    assert_all_same_results(cib);
+
+    // Copy a subtree with IDs into the document
+    xml = get_xpath_object("//group", cib, LOG_NEVER);
+    pcmk__xml_copy(resources, xml);
+    assert_all_same_results(cib);
+
+    // Free a subtree with IDs
+    pcmk__xml_free(xml);
+    assert_all_same_results(cib);
+    xml = get_xpath_object("//meta_attributes", cib, LOG_NEVER);
+    pcmk__xml_free(xml);
+    assert_all_same_results(cib);
+
+    pcmk__xml_free(cib);
+}
+
+static void
+copies_are_indexed(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+    xmlNode *copy = NULL;
+    xmlNode *section = NULL;
+
+    pcmk__xml_doc_index_ids(cib->doc);
+
+    // A copy of the whole document is indexed
+    copy = pcmk__xml_copy(NULL, cib);
+    assert_true(pcmk__xml_doc_ids_indexed(copy->doc));
+    assert_all_same_results(copy);
+    pcmk__xml_free(copy);
+
+    // A copy that is changed before its first lookup is indexed correctly
+    copy = pcmk__xml_copy(NULL, cib);
+    section = get_xpath_object("//group", copy, LOG_NEVER);
+    crm_xml_add(section, PCMK_XA_ID, "grp2");
+    pcmk__xml_free(get_xpath_object("//meta_attributes", copy, LOG_NEVER));
+    assert_all_same_results(copy);
+    pcmk__xml_free(copy);
+
+    // A copy of part of the document is not
+    section = get_xpath_object("//status", cib, LOG_NEVER);
+    copy = pcmk__xml_copy(NULL, section);
+    assert_false(pcmk__xml_doc_ids_indexed(copy->doc));
+    pcmk__xml_free(copy);
+
+    pcmk__xml_free(cib);
+}
+
+static void
+built_on_first_lookup(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+    xmlNode *copy = NULL;
+    const xml_doc_private_t *docpriv = NULL;
+
+    pcmk__xml_doc_index_ids(cib->doc);
+    docpriv = cib->doc->_private;
+    assert_null(docpriv->id_index);
+
+    // Copying does not build the index
+    copy = pcmk__xml_copy(NULL, cib);
+    docpriv = copy->doc->_private;
+    assert_null(docpriv->id_index);
+
+    // Searching by ID does
+    assert_non_null(get_xpath_object("//primitive[@id='rsc1']", copy,
+                                     LOG_NEVER));
+    assert_non_null(docpriv->id_index);
+
+    pcmk__xml_free(copy);
+    pcmk__xml_free(cib);
+}
+
+static void
+matching_uses_index(void **state)
+{
+    xmlNode *cib = pcmk__xml_parse(CIB_XML);
+    xmlNode *resources = NULL;
+    xmlNode *update = pcmk__xe_create(NULL, PCMK_XE_PRIMITIVE);
+    xmlNode *search = pcmk__xe_create(NULL, PCMK_XE_PRIMITIVE);
+    xmlNode *xml = NULL;
+
+    pcmk__xml_doc_index_ids(cib->doc);
+    resources = get_xpath_object("//resources", cib, LOG_NEVER);
+
+    // Update matches IDs exactly
+    crm_xml_add(update, PCMK_XA_ID, "RSC1");
+    crm_xml_add(update, PCMK_XA_DESCRIPTION, "updated");
+    assert_int_equal(pcmk__xe_update_match(resources, update, pcmk__xaf_none),
+                     pcmk_rc_ok);
+    xml = get_xpath_object("//primitive[@id='RSC1']", cib, LOG_NEVER);
+    assert_string_equal(crm_element_value(xml, PCMK_XA_DESCRIPTION),
+                        "updated");
+    xml = get_xpath_object("//primitive[@id='rsc1']", cib, LOG_NEVER);
+    assert_null(crm_element_value(xml, PCMK_XA_DESCRIPTION));
+
+    crm_xml_add(update, PCMK_XA_ID, "missing");
+    assert_int_equal(pcmk__xe_update_match(resources, update, pcmk__xaf_none),
+                     ENXIO);
+
+    // Deletion matches attributes case-insensitively, in document order
+    crm_xml_add(search, PCMK_XA_ID, "Rsc1");
+    assert_int_equal(pcmk__xe_delete_match(resources, search), pcmk_rc_ok);
+    assert_null(get_xpath_object("//primitive[@id='rsc1']", cib, LOG_NEVER));
+    assert_non_null(get_xpath_object("//primitive[@id='RSC1']", cib,
+                                     LOG_NEVER));
+    assert_all_same_results(cib);
+
+    // Deletion doesn't match elements outside the given subtree
+    crm_xml_add(search, PCMK_XA_ID, "rsc2");
+    xml = get_xpath_object("//status", cib, LOG_NEVER);
+    assert_int_equal(pcmk__xe_delete_match(xml, search), ENXIO);
+    assert_int_equal(pcmk__xe_delete_match(resources, search), pcmk_rc_ok);
+    assert_all_same_results(cib);
+
+    pcmk__xml_free(search);
+    pcmk__xml_free(update);
+    pcmk__xml_free(cib);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(not_indexed),
+                cmocka_unit_test(unsupported_paths),
+                cmocka_unit_test(same_as_xpath),
+                cmocka_unit_test(same_after_changes),
+                cmocka_unit_test(copies_are_indexed),
+                cmocka_unit_test(built_on_first_lookup),
+                cmocka_unit_test(matching_uses_index))
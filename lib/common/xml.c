@@ -260,6 +260,7 @@ new_private_data(xmlNode *node, void *user_data)
 
                     new_private_data((xmlNode *) iter, user_data);
                 }
+                pcmk__xml_index_add(node);
             }
             break;
 
@@ -300,12 +301,18 @@ free_private_data(xmlNode *node, void *user_data)
     }
 
     if (node->type == XML_DOCUMENT_NODE) {
-        reset_xml_private_data((xml_doc_private_t *) node->_private);
+        xml_doc_private_t *docpriv = node->_private;
+
+        reset_xml_private_data(docpriv);
+        if (docpriv->id_index != NULL) {
+            g_hash_table_destroy(docpriv->id_index);
+        }
 
     } else {
         xml_node_private_t *nodepriv = node->_private;
 
         pcmk__assert(nodepriv->check == PCMK__XML_NODE_PRIVATE_MAGIC);
+        pcmk__xml_index_remove(node);
 
         for (xmlAttr *iter = pcmk__xe_first_attr(node); iter != NULL;
              iter = iter->next) {
@@ -817,6 +824,15 @@ pcmk__xml_copy(xmlNode *parent, xmlNode *src)
         pcmk__assert(src->type == XML_ELEMENT_NODE);
 
         doc = pcmk__xml_new_doc();
+
+        /* A copy of an entire indexed document is indexed too (the index is
+         * built when first used, not while copying)
+         */
+        if ((src->doc != NULL) && (xmlDocGetRootElement(src->doc) == src)
+            && pcmk__xml_doc_ids_indexed(src->doc)) {
+            pcmk__xml_doc_index_ids(doc);
+        }
+
         copy = xmlDocCopyNode(src, doc, 1);
         pcmk__mem_assert(copy);
 
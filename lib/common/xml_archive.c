@@ -0,0 +1,795 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <errno.h>
+#include <limits.h>             // UINT_MAX
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>             // access(), unlink()
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/crm.h>
+#include <crm/common/xml.h>
+#include "crmcommon_private.h"
+
+/* An XML archive holds a numbered series of XML documents (such as scheduler
+ * inputs) in the directory <series>.archive. Each distinct document is stored
+ * once, named by the digest of its serialized form, either as a full snapshot
+ * (<digest>.bz2) or as a v2 patchset against the document added before it
+ * (<digest>.delta.bz2). An append-only index file records how each digest is
+ * stored and which digest each sequence number currently has; later lines
+ * override earlier ones.
+ */
+
+#define ARCHIVE_INDEX       "index"
+#define ARCHIVE_FULL_EXT    ".bz2"
+#define ARCHIVE_DELTA_EXT   ".delta.bz2"
+
+// Compact the index once it has this many more lines than live entries
+#define ARCHIVE_INDEX_SLACK 256
+
+// How a document with a particular digest is stored
+typedef struct {
+    char *digest;   // Digest of serialized document
+    char *base;     // Digest of document that delta applies to (NULL if full)
+    bool live;      // Whether needed to reconstruct any indexed document
+} archive_object_t;
+
+struct pcmk__xml_archive_s {
+    char *path;             // Archive directory
+    guint interval;         // Maximum documents per full snapshot
+    guint index_lines;      // Number of lines in index file
+    GHashTable *inputs;     // Sequence number -> digest
+    GHashTable *objects;    // Digest -> archive_object_t
+    xmlNode *last;          // Most recently added document, as a reader sees it
+    char *last_digest;      // Digest of last
+};
+
+static void
+free_object(gpointer data)
+{
+    archive_object_t *obj = data;
+
+    free(obj->digest);
+    free(obj->base);
+    free(obj);
+}
+
+static archive_object_t *
+add_object(GHashTable *objects, const char *digest, const char *base)
+{
+    archive_object_t *obj = pcmk__assert_alloc(1, sizeof(archive_object_t));
+
+    obj->digest = pcmk__str_copy(digest);
+    obj->base = pcmk__str_copy(base);
+    g_hash_table_replace(objects, obj->digest, obj);
+    return obj;
+}
+
+static archive_object_t *
+base_object(GHashTable *objects, const archive_object_t *obj)
+{
+    if (obj->base == NULL) {
+        return NULL;
+    }
+    return g_hash_table_lookup(objects, obj->base);
+}
+
+static char *
+object_filename(const char *path, const archive_object_t *obj)
+{
+    return crm_strdup_printf("%s/%s%s", path, obj->digest,
+                             ((obj->base == NULL)? ARCHIVE_FULL_EXT
+                                                 : ARCHIVE_DELTA_EXT));
+}
+
+// Digests are used in file names, so accept nothing but lowercase hex
+static bool
+valid_digest(const char *digest)
+{
+    return !pcmk__str_empty(digest)
+           && (strspn(digest, "0123456789abcdef") == strlen(digest));
+}
+
+// Serialize XML exactly as pcmk__xml_write_file() does
+static GString *
+serialize(const xmlNode *xml)
+{
+    GString *buffer = g_string_sized_new(1024);
+
+    pcmk__xml_string(xml, pcmk__xml_fmt_pretty, buffer, 0);
+    return buffer;
+}
+
+// Parse serialized XML exactly as pcmk__xml_read() would
+static xmlNode *
+read_back(const char *text)
+{
+    xmlNode *xml = pcmk__xml_parse(text);
+
+    if (xml != NULL) {
+        pcmk__strip_xml_text(xml);
+    }
+    return xml;
+}
+
+/*!
+ * \internal
+ * \brief Count the deltas between an archived document and a full snapshot
+ *
+ * \param[in] objects  Archive objects table
+ * \param[in] digest   Digest of document to check
+ *
+ * \return Number of patchsets that must be applied to a full snapshot to get
+ *         the document with \p digest, or \c G_MAXUINT if it cannot be
+ *         reconstructed
+ */
+static guint
+delta_depth(GHashTable *objects, const char *digest)
+{
+    guint limit = g_hash_table_size(objects);
+    const archive_object_t *obj = g_hash_table_lookup(objects, digest);
+
+    for (guint depth = 0; (obj != NULL) && (depth < limit); depth++) {
+        if (obj->base == NULL) {
+            return depth;
+        }
+        obj = base_object(objects, obj);
+    }
+    return G_MAXUINT;
+}
+
+/*!
+ * \internal
+ * \brief Parse an archive index file
+ *
+ * \param[in]     path     Archive directory
+ * \param[in,out] inputs   Table to add sequence number mappings to
+ * \param[in,out] objects  Table to add stored documents to
+ * \param[out]    lines    Where to store number of lines in index
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+load_index(const char *path, GHashTable *inputs, GHashTable *objects,
+           guint *lines)
+{
+    char *filename = crm_strdup_printf("%s/" ARCHIVE_INDEX, path);
+    char *contents = NULL;
+    gchar **entries = NULL;
+    int rc = pcmk__file_contents(filename, &contents);
+
+    *lines = 0;
+    if ((rc != pcmk_rc_ok) || (contents == NULL)) {
+        goto done;
+    }
+
+    entries = g_strsplit(contents, "\n", 0);
+    for (gchar **entry = entries; *entry != NULL; entry++) {
+        gchar **fields = NULL;
+        guint n_fields = 0;
+        long long seq = 0LL;
+
+        if (pcmk__str_empty(*entry)) {
+            continue;
+        }
+        (*lines)++;
+
+        fields = g_strsplit(*entry, " ", 0);
+        n_fields = g_strv_length(fields);
+
+        if ((n_fields == 3) && pcmk__str_eq(fields[0], "input", pcmk__str_none)
+            && (pcmk__scan_ll(fields[1], &seq, -1LL) == pcmk_rc_ok)
+            && (seq >= 0LL) && (seq <= UINT_MAX) && valid_digest(fields[2])) {
+
+            g_hash_table_replace(inputs, GUINT_TO_POINTER((guint) seq),
+                                 pcmk__str_copy(fields[2]));
+
+        } else if ((n_fields == 3)
+                   && pcmk__str_eq(fields[0], "object", pcmk__str_none)
+                   && valid_digest(fields[1])
+                   && pcmk__str_eq(fields[2], "full", pcmk__str_none)) {
+
+            add_object(objects, fields[1], NULL);
+
+        } else if ((n_fields == 4)
+                   && pcmk__str_eq(fields[0], "object", pcmk__str_none)
+                   && valid_digest(fields[1])
+                   && pcmk__str_eq(fields[2], "delta", pcmk__str_none)
+                   && valid_digest(fields[3])) {
+
+            add_object(objects, fields[1], fields[3]);
+
+        } else {
+            // Most likely a partial line written before a crash
+            crm_warn("Ignoring invalid entry in %s: %s", filename, *entry);
+        }
+        g_strfreev(fields);
+    }
+    g_strfreev(entries);
+
+done:
+    free(contents);
+    free(filename);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Reconstruct an archived document
+ *
+ * \param[in]  path     Archive directory
+ * \param[in]  objects  Archive objects table
+ * \param[in]  digest   Digest of document to reconstruct
+ * \param[out] xml      Where to store reconstructed document
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+reconstruct(const char *path, GHashTable *objects, const char *digest,
+            xmlNode **xml)
+{
+    GList *chain = NULL;
+    guint depth = delta_depth(objects, digest);
+    const archive_object_t *obj = g_hash_table_lookup(objects, digest);
+    xmlNode *result = NULL;
+    GString *buffer = NULL;
+    char *calculated = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (depth == G_MAXUINT) {
+        crm_info("Archive %s has no full snapshot for %s", path, digest);
+        return ENOENT;
+    }
+
+    // Build the chain of stored objects from the full snapshot to the target
+    for (guint i = 0; i <= depth; i++) {
+        chain = g_list_prepend(chain, (gpointer) obj);
+        obj = base_object(objects, obj);
+    }
+
+    for (GList *iter = chain; iter != NULL; iter = iter->next) {
+        char *filename = object_filename(path, iter->data);
+        xmlNode *stored = NULL;
+
+        if (access(filename, R_OK) != 0) {
+            rc = errno;
+            crm_info("Could not access %s: %s", filename, strerror(rc));
+            free(filename);
+            goto done;
+        }
+
+        stored = pcmk__xml_read(filename);
+        if (stored == NULL) {
+            crm_info("Could not parse %s", filename);
+            free(filename);
+            rc = pcmk_rc_unpack_error;
+            goto done;
+        }
+        free(filename);
+
+        if (result == NULL) {
+            result = stored;
+            continue;
+        }
+
+        rc = pcmk_legacy2rc(xml_apply_patchset(result, stored, false));
+        pcmk__xml_free(stored);
+        if (rc != pcmk_rc_ok) {
+            goto done;
+        }
+    }
+
+    buffer = serialize(result);
+    calculated = crm_md5sum(buffer->str);
+    if (!pcmk__str_eq(calculated, digest, pcmk__str_none)) {
+        crm_info("Digest mismatch reconstructing %s in %s: calculated %s",
+                 digest, path, calculated);
+        rc = pcmk_rc_diff_failed;
+    }
+
+done:
+    g_list_free(chain);
+    if (buffer != NULL) {
+        g_string_free(buffer, TRUE);
+    }
+    free(calculated);
+    if (rc == pcmk_rc_ok) {
+        *xml = result;
+    } else {
+        pcmk__xml_free(result);
+    }
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Read a document from an XML archive
+ *
+ * \param[in]  directory  Directory containing archive
+ * \param[in]  series     Name of series (for example, "pe-input")
+ * \param[in]  sequence   Sequence number of document to read
+ * \param[out] xml        Where to store reconstructed document
+ *
+ * \return Standard Pacemaker return code (specifically, \c ENOENT if there is
+ *         no archive or it does not contain \p sequence)
+ * \note On success, the caller is responsible for freeing \p *xml using
+ *       \c pcmk__xml_free(). The reconstructed document serializes to exactly
+ *       the bytes that were archived.
+ */
+int
+pcmk__xml_archive_read(const char *directory, const char *series,
+                       unsigned int sequence, xmlNode **xml)
+{
+    char *path = NULL;
+    GHashTable *inputs = NULL;
+    GHashTable *objects = NULL;
+    const char *digest = NULL;
+    guint lines = 0;
+    int rc = pcmk_rc_ok;
+
+    CRM_CHECK((directory != NULL) && (series != NULL) && (xml != NULL)
+              && (*xml == NULL), return EINVAL);
+
+    path = crm_strdup_printf("%s/%s.archive", directory, series);
+    inputs = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, free);
+    objects = pcmk__strkey_table(NULL, free_object);
+
+    rc = load_index(path, inputs, objects, &lines);
+    if (rc != pcmk_rc_ok) {
+        goto done;
+    }
+
+    digest = g_hash_table_lookup(inputs, GUINT_TO_POINTER(sequence));
+    if (digest == NULL) {
+        rc = ENOENT;
+        goto done;
+    }
+    rc = reconstruct(path, objects, digest, xml);
+
+done:
+    g_hash_table_destroy(inputs);
+    g_hash_table_destroy(objects);
+    free(path);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Read a series file from an XML archive if it is archived
+ *
+ * \param[in] filename  Name of a series file that does not exist, in the form
+ *                      <directory>/<series>-<sequence>[.bz2] (for example,
+ *                      /var/lib/pacemaker/pengine/pe-input-5.bz2)
+ *
+ * \return Reconstructed document on success, otherwise \c NULL
+ */
+xmlNode *
+pcmk__xml_archive_read_file(const char *filename)
+{
+    gchar *directory = g_path_get_dirname(filename);
+    gchar *series = g_path_get_basename(filename);
+    char *sequence = NULL;
+    long long seq = 0LL;
+    xmlNode *xml = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (g_str_has_suffix(series, ".bz2")) {
+        series[strlen(series) - 4] = '\0';
+    }
+
+    sequence = strrchr(series, '-');
+    if ((sequence == NULL) || (sequence == series) || (sequence[1] == '\0')
+        || (strspn(sequence + 1, "0123456789") != strlen(sequence + 1))
+        || (pcmk__scan_ll(sequence + 1, &seq, -1LL) != pcmk_rc_ok)
+        || (seq > UINT_MAX)) {
+        goto done; // Not a series file
+    }
+    *sequence = '\0';
+
+    rc = pcmk__xml_archive_read(directory, series, (unsigned int) seq, &xml);
+    if (rc == pcmk_rc_ok) {
+        crm_debug("Reconstructed %s from archive", filename);
+
+    } else if (rc != ENOENT) {
+        crm_warn("Could not reconstruct %s from archive: %s",
+                 filename, pcmk_rc_str(rc));
+    }
+
+done:
+    g_free(directory);
+    g_free(series);
+    return xml;
+}
+
+/*!
+ * \internal
+ * \brief Open an XML archive for adding documents
+ *
+ * \param[in]  directory  Directory to create archive in (must exist)
+ * \param[in]  series     Name of series (for example, "pe-input")
+ * \param[in]  interval   Store a full snapshot at least once this many
+ *                        documents (other documents will be stored as
+ *                        patchsets against the previous document)
+ * \param[out] archive    Where to store newly allocated archive
+ *
+ * \return Standard Pacemaker return code
+ * \note On success, the caller is responsible for freeing \p *archive using
+ *       \c pcmk__xml_archive_free().
+ */
+int
+pcmk__xml_archive_open(const char *directory, const char *series,
+                       guint interval, pcmk__xml_archive_t **archive)
+{
+    pcmk__xml_archive_t *new_archive = NULL;
+    int rc = pcmk_rc_ok;
+
+    CRM_CHECK((directory != NULL) && (series != NULL) && (archive != NULL)
+              && (*archive == NULL), return EINVAL);
+
+    new_archive = pcmk__assert_alloc(1, sizeof(pcmk__xml_archive_t));
+    new_archive->path = crm_strdup_printf("%s/%s.archive", directory, series);
+    new_archive->interval = QB_MAX(interval, 1);
+    new_archive->inputs = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                                NULL, free);
+    new_archive->objects = pcmk__strkey_table(NULL, free_object);
+
+    rc = pcmk__build_path(new_archive->path, 0750);
+    if (rc != pcmk_rc_ok) {
+        crm_err("Could not create %s: %s", new_archive->path, pcmk_rc_str(rc));
+        pcmk__xml_archive_free(new_archive);
+        return rc;
+    }
+
+    rc = load_index(new_archive->path, new_archive->inputs,
+                    new_archive->objects, &new_archive->index_lines);
+    if ((rc != pcmk_rc_ok) && (rc != ENOENT)) {
+        crm_err("Could not load index of %s: %s",
+                new_archive->path, pcmk_rc_str(rc));
+        pcmk__xml_archive_free(new_archive);
+        return rc;
+    }
+
+    // Forget anything a crash left behind without an index entry using it
+    remove_dead_objects(new_archive);
+
+    crm_debug("Opened %s with %u document%s",
+              new_archive->path, g_hash_table_size(new_archive->inputs),
+              pcmk__plural_s(g_hash_table_size(new_archive->inputs)));
+    *archive = new_archive;
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Free an XML archive object (the archive remains on disk)
+ *
+ * \param[in,out] archive  Archive to free
+ */
+void
+pcmk__xml_archive_free(pcmk__xml_archive_t *archive)
+{
+    if (archive != NULL) {
+        g_hash_table_destroy(archive->inputs);
+        g_hash_table_destroy(archive->objects);
+        pcmk__xml_free(archive->last);
+        free(archive->last_digest);
+        free(archive->path);
+        free(archive);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Create a patchset between two documents that a reader can apply
+ *
+ * \param[in] base  Document to create patchset against
+ * \param[in] xml   Document to create patchset for
+ * \param[in] text  \p xml serialized as it would be written to disk
+ *
+ * \return Patchset that, after being written to disk and read back, transforms
+ *         \p base into a document that serializes to exactly \p text, or
+ *         \c NULL if no such patchset could be created
+ */
+static xmlNode *
+verified_delta(const xmlNode *base, const xmlNode *xml, const GString *text)
+{
+    xmlNode *source = pcmk__xml_copy(NULL, (xmlNode *) base);
+    xmlNode *target = pcmk__xml_copy(NULL, (xmlNode *) xml);
+    xmlNode *patchset = NULL;
+    xmlNode *result = NULL;
+    GString *buffer = NULL;
+
+    xml_track_changes(target, NULL, NULL, false);
+    xml_calculate_changes(source, target);
+    patchset = xml_create_patchset(2, source, target, NULL, false);
+    pcmk__xml_free(source);
+    pcmk__xml_free(target);
+    if (patchset == NULL) {
+        return NULL;
+    }
+
+    // Apply the patchset the same way a reader will, after a round trip
+    buffer = serialize(patchset);
+    pcmk__xml_free(patchset);
+    patchset = read_back(buffer->str);
+    g_string_free(buffer, TRUE);
+    buffer = NULL;
+
+    source = pcmk__xml_copy(NULL, (xmlNode *) base);
+    if ((patchset != NULL)
+        && (xml_apply_patchset(source, patchset, false) == pcmk_ok)) {
+
+        buffer = serialize(source);
+        if (g_string_equal(buffer, text)) {
+            result = patchset;
+            patchset = NULL;
+        } else {
+            crm_trace("Patchset does not reproduce document exactly");
+        }
+        g_string_free(buffer, TRUE);
+    }
+    pcmk__xml_free(source);
+    pcmk__xml_free(patchset);
+    return result;
+}
+
+/*!
+ * \internal
+ * \brief Write lines to an archive's index
+ *
+ * \param[in,out] archive  Archive to write index of
+ * \param[in]     lines    Newline-terminated lines to write
+ * \param[in]     replace  If true, replace the whole index with \p lines
+ *                         (atomically), otherwise append them
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+write_index(pcmk__xml_archive_t *archive, const GString *lines, bool replace)
+{
+    char *filename = crm_strdup_printf("%s/" ARCHIVE_INDEX, archive->path);
+    char *tmp_filename = NULL;
+    FILE *fp = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (replace) {
+        tmp_filename = crm_strdup_printf("%s.tmp", filename);
+        fp = fopen(tmp_filename, "w");
+    } else {
+        fp = fopen(filename, "a");
+    }
+    if (fp == NULL) {
+        rc = errno;
+        goto done;
+    }
+
+    if ((fputs(lines->str, fp) == EOF) || (fflush(fp) != 0)
+        || (fsync(fileno(fp)) < 0)) {
+        rc = errno;
+    }
+    if ((fclose(fp) != 0) && (rc == pcmk_rc_ok)) {
+        rc = errno;
+    }
+
+    if (replace && (rc == pcmk_rc_ok) && (rename(tmp_filename, filename) < 0)) {
+        rc = errno;
+    }
+    if ((tmp_filename != NULL) && (rc != pcmk_rc_ok)) {
+        unlink(tmp_filename);
+    }
+
+done:
+    if (rc != pcmk_rc_ok) {
+        crm_err("Could not write %s: %s", filename, pcmk_rc_str(rc));
+    }
+    free(tmp_filename);
+    free(filename);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Delete stored documents that are no longer needed
+ *
+ * A stored document is needed if some sequence number maps to it, or if it is
+ * in the chain of patchsets leading to such a document.
+ *
+ * \param[in,out] archive  Archive to clean up
+ */
+static void
+remove_dead_objects(pcmk__xml_archive_t *archive)
+{
+    GHashTableIter iter;
+    const char *digest = NULL;
+    archive_object_t *obj = NULL;
+
+    g_hash_table_iter_init(&iter, archive->objects);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &obj)) {
+        obj->live = false;
+    }
+
+    g_hash_table_iter_init(&iter, archive->inputs);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &digest)) {
+        for (obj = g_hash_table_lookup(archive->objects, digest);
+             (obj != NULL) && !obj->live;
+             obj = base_object(archive->objects, obj)) {
+            obj->live = true;
+        }
+    }
+
+    g_hash_table_iter_init(&iter, archive->objects);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &obj)) {
+        if (!obj->live) {
+            char *filename = object_filename(archive->path, obj);
+
+            crm_trace("Removing unneeded %s", filename);
+            unlink(filename);
+            free(filename);
+            g_hash_table_iter_remove(&iter);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Rewrite an archive's index with only its current entries
+ *
+ * \param[in,out] archive  Archive to compact index of
+ */
+static void
+compact_index(pcmk__xml_archive_t *archive)
+{
+    GString *lines = g_string_sized_new(1024);
+    GHashTableIter iter;
+    gpointer key = NULL;
+    gpointer value = NULL;
+    guint n_lines = 0;
+
+    g_hash_table_iter_init(&iter, archive->objects);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        const archive_object_t *obj = value;
+
+        if (obj->base == NULL) {
+            g_string_append_printf(lines, "object %s full\n", obj->digest);
+        } else {
+            g_string_append_printf(lines, "object %s delta %s\n",
+                                   obj->digest, obj->base);
+        }
+        n_lines++;
+    }
+
+    g_hash_table_iter_init(&iter, archive->inputs);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+        g_string_append_printf(lines, "input %u %s\n",
+                               GPOINTER_TO_UINT(key), (const char *) value);
+        n_lines++;
+    }
+
+    if (write_index(archive, lines, true) == pcmk_rc_ok) {
+        crm_debug("Compacted index of %s from %u to %u lines",
+                  archive->path, archive->index_lines, n_lines);
+        archive->index_lines = n_lines;
+    }
+    g_string_free(lines, TRUE);
+}
+
+/*!
+ * \internal
+ * \brief Add a document to an XML archive
+ *
+ * If the archive already has a document with the same content, only the
+ * sequence number mapping is recorded. Otherwise, the document is stored as a
+ * patchset against the previously added document, unless that would not
+ * reproduce it exactly or a full snapshot is due. Stored documents that are no
+ * longer needed afterward (because \p sequence previously mapped to them) are
+ * removed.
+ *
+ * \param[in,out] archive   Archive to add document to
+ * \param[in]     sequence  Sequence number to store document as (any document
+ *                          previously stored as this number is replaced)
+ * \param[in]     xml       Document to add
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__xml_archive_add(pcmk__xml_archive_t *archive, unsigned int sequence,
+                      const xmlNode *xml)
+{
+    GString *text = NULL;
+    GString *lines = NULL;
+    char *digest = NULL;
+    archive_object_t *obj = NULL;
+    int rc = pcmk_rc_ok;
+
+    CRM_CHECK((archive != NULL) && (xml != NULL), return EINVAL);
+
+    text = serialize(xml);
+    digest = crm_md5sum(text->str);
+    lines = g_string_sized_new(256);
+
+    if (g_hash_table_lookup(archive->objects, digest) != NULL) {
+        crm_trace("Document %u for %s has same content as %s",
+                  sequence, archive->path, digest);
+
+    } else {
+        xmlNode *patchset = NULL;
+        char *filename = NULL;
+
+        if ((archive->last != NULL)
+            && (delta_depth(archive->objects,
+                            archive->last_digest) < archive->interval - 1)) {
+            patchset = verified_delta(archive->last, xml, text);
+        }
+
+        obj = pcmk__assert_alloc(1, sizeof(archive_object_t));
+        obj->digest = pcmk__str_copy(digest);
+        if (patchset != NULL) {
+            obj->base = pcmk__str_copy(archive->last_digest);
+        }
+        filename = object_filename(archive->path, obj);
+
+        rc = pcmk__xml_write_file(((patchset != NULL)? patchset : xml),
+                                  filename, true);
+        pcmk__xml_free(patchset);
+        if (rc != pcmk_rc_ok) {
+            crm_err("Could not write %s: %s", filename, pcmk_rc_str(rc));
+            unlink(filename);
+            free(filename);
+            free_object(obj);
+            goto done;
+        }
+        free(filename);
+
+        if (obj->base == NULL) {
+            g_string_append_printf(lines, "object %s full\n", digest);
+        } else {
+            g_string_append_printf(lines, "object %s delta %s\n",
+                                   digest, obj->base);
+        }
+        g_hash_table_replace(archive->objects, obj->digest, obj);
+    }
+
+    g_string_append_printf(lines, "input %u %s\n", sequence, digest);
+    g_hash_table_replace(archive->inputs, GUINT_TO_POINTER(sequence),
+                         pcmk__str_copy(digest));
+
+    pcmk__xml_free(archive->last);
+    archive->last = read_back(text->str);
+    free(archive->last_digest);
+    archive->last_digest = digest;
+    digest = NULL;
+
+    if (write_index(archive, lines, false) == pcmk_rc_ok) {
+        archive->index_lines += (obj == NULL)? 1 : 2;
+    } else {
+        // Rewriting the whole index may still succeed
+        archive->index_lines = G_MAXUINT;
+    }
+
+    remove_dead_objects(archive);
+
+    if (archive->index_lines > (g_hash_table_size(archive->inputs)
+                                + g_hash_table_size(archive->objects)
+                                + ARCHIVE_INDEX_SLACK)) {
+        compact_index(archive);
+    }
+
+done:
+    free(digest);
+    g_string_free(lines, TRUE);
+    g_string_free(text, TRUE);
+    return rc;
+}
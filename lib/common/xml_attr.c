@@ -65,6 +65,10 @@ pcmk__xa_remove(xmlAttr *attr, bool force)
         pcmk__set_xml_flags((xml_node_private_t *) attr->_private,
                             pcmk__xf_deleted);
     } else {
+        if (pcmk__str_eq((const char *) attr->name, PCMK_XA_ID,
+                         pcmk__str_none)) {
+            pcmk__xml_index_remove(element);
+        }
         pcmk__xml_free_private_data((xmlNode *) attr);
         xmlRemoveProp(attr);
     }
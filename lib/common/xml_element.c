@@ -647,6 +647,29 @@ done:
     free(trace_s);
 }
 
+// Check whether an element matches a search element (see below)
+static bool
+xe_matches_search(const xmlNode *xml, const xmlNode *search)
+{
+    if (!pcmk__xe_is(search, (const char *) xml->name)) {
+        // No match: either not both elements, or different element types
+        return false;
+    }
+
+    for (const xmlAttr *attr = pcmk__xe_first_attr(search); attr != NULL;
+         attr = attr->next) {
+
+        const char *search_val = pcmk__xml_attr_value(attr);
+        const char *xml_val = crm_element_value(xml, (const char *) attr->name);
+
+        if (!pcmk__str_eq(search_val, xml_val, pcmk__str_casei)) {
+            // No match: an attr in xml doesn't match the attr in search
+            return false;
+        }
+    }
+    return true;
+}
+
 /*!
  * \internal
  * \brief Delete an XML subtree if it matches a search element
@@ -670,23 +693,10 @@ delete_xe_if_matching(xmlNode *xml, void *user_data)
 {
     xmlNode *search = user_data;
 
-    if (!pcmk__xe_is(search, (const char *) xml->name)) {
-        // No match: either not both elements, or different element types
+    if (!xe_matches_search(xml, search)) {
         return true;
     }
 
-    for (const xmlAttr *attr = pcmk__xe_first_attr(search); attr != NULL;
-         attr = attr->next) {
-
-        const char *search_val = pcmk__xml_attr_value(attr);
-        const char *xml_val = crm_element_value(xml, (const char *) attr->name);
-
-        if (!pcmk__str_eq(search_val, xml_val, pcmk__str_casei)) {
-            // No match: an attr in xml doesn't match the attr in search
-            return true;
-        }
-    }
-
     crm_log_xml_trace(xml, "delete-match");
     crm_log_xml_trace(search, "delete-search");
     pcmk__xml_free(xml);
@@ -716,9 +726,29 @@ delete_xe_if_matching(xmlNode *xml, void *user_data)
 int
 pcmk__xe_delete_match(xmlNode *xml, xmlNode *search)
 {
+    GList *candidates = NULL;
+
     // See @COMPAT comment in pcmk__xe_replace_match()
     CRM_CHECK((xml != NULL) && (search != NULL), return EINVAL);
 
+    // If the document is indexed by ID, check only elements with that ID
+    if ((pcmk__xe_id(search) != NULL)
+        && (pcmk__xml_index_find(xml, (const char *) search->name,
+                                 pcmk__xe_id(search), true, false,
+                                 &candidates) == pcmk_rc_ok)) {
+        int rc = ENXIO;
+
+        for (GList *iter = candidates; iter != NULL; iter = iter->next) {
+            if (xe_matches_search(iter->data, search)) {
+                delete_xe_if_matching(iter->data, search);
+                rc = pcmk_rc_ok;
+                break;
+            }
+        }
+        g_list_free(candidates);
+        return rc;
+    }
+
     for (xml = pcmk__xe_first_child(xml, NULL, NULL, NULL); xml != NULL;
          xml = pcmk__xe_next(xml, NULL)) {
 
@@ -837,8 +867,27 @@ pcmk__xe_replace_match(xmlNode *xml, xmlNode *replace)
      * cib_process_delete(). Behavior can change at a major version release if
      * desired.
      */
+    const char *replace_id = NULL;
+    GList *candidates = NULL;
+
     CRM_CHECK((xml != NULL) && (replace != NULL), return EINVAL);
 
+    // If the document is indexed by ID, check only elements with that ID
+    replace_id = pcmk__xe_id(replace);
+    if ((replace_id != NULL)
+        && (pcmk__xml_index_find(xml, (const char *) replace->name,
+                                 replace_id, false, false,
+                                 &candidates) == pcmk_rc_ok)) {
+        int rc = ENXIO;
+
+        if (candidates != NULL) {
+            replace_xe_if_matching(candidates->data, replace);
+            rc = pcmk_rc_ok;
+        }
+        g_list_free(candidates);
+        return rc;
+    }
+
     for (xml = pcmk__xe_first_child(xml, NULL, NULL, NULL); xml != NULL;
          xml = pcmk__xe_next(xml, NULL)) {
 
@@ -936,9 +985,26 @@ pcmk__xe_update_match(xmlNode *xml, xmlNode *update, uint32_t flags)
         .update = update,
         .flags = flags,
     };
+    const char *update_id = NULL;
+    GList *candidates = NULL;
 
     CRM_CHECK((xml != NULL) && (update != NULL), return EINVAL);
 
+    // If the document is indexed by ID, check only elements with that ID
+    update_id = pcmk__xe_id(update);
+    if ((update_id != NULL)
+        && (pcmk__xml_index_find(xml, (const char *) update->name, update_id,
+                                 false, true, &candidates) == pcmk_rc_ok)) {
+        int rc = ENXIO;
+
+        if (candidates != NULL) {
+            update_xe_if_matching(candidates->data, &data);
+            rc = pcmk_rc_ok;
+        }
+        g_list_free(candidates);
+        return rc;
+    }
+
     if (!pcmk__xml_tree_foreach(xml, update_xe_if_matching, &data)) {
         // Found and updated an element
         return pcmk_rc_ok;
@@ -1016,6 +1082,7 @@ crm_xml_add(xmlNode *node, const char *name, const char *value)
 {
     // @TODO Replace with internal function that returns the new attribute
     bool dirty = FALSE;
+    bool is_id = false;
     xmlAttr *attr = NULL;
 
     CRM_CHECK(node != NULL, return NULL);
@@ -1038,8 +1105,18 @@ crm_xml_add(xmlNode *node, const char *name, const char *value)
         return NULL;
     }
 
+    // Keep the document's ID index (if any) current
+    is_id = (strcmp(name, PCMK_XA_ID) == 0);
+    if (is_id) {
+        pcmk__xml_index_remove(node);
+    }
+
     attr = xmlSetProp(node, (pcmkXmlStr) name, (pcmkXmlStr) value);
 
+    if (is_id) {
+        pcmk__xml_index_add(node);
+    }
+
     /* If the attribute already exists, this does nothing. Attribute values
      * don't get private data.
      */
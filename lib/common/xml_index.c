@@ -0,0 +1,454 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU Lesser General Public License
+ * version 2.1 or later (LGPLv2.1+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdbool.h>
+#include <string.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+#include <libxml/xpath.h>
+#include <libxml/xpathInternals.h>  // xmlXPathNodeSetAdd(), etc.
+
+#include <crm/common/xml.h>
+#include <crm/common/xml_internal.h>
+#include "crmcommon_private.h"
+
+/* An XML document may keep an index of its elements by ID, so that elements
+ * can be found without searching the entire document. IDs are not necessarily
+ * unique (for example, the same resource ID appears in the status section once
+ * per node), so the index maps each ID to an array of all elements with that
+ * ID. The index is keyed by lowercased ID so that case-insensitive searches can
+ * use it too.
+ *
+ * Enabling the index for a document (or copying an entire document that has it
+ * enabled) only marks the document. The index itself is built the first time
+ * it is used for a lookup, so documents that are copied but never searched by
+ * ID (such as the working copies the CIB manager makes for each request) do not
+ * pay for it. Once built, the index is kept up to date as elements are created
+ * and freed and as IDs are set and removed. Elements in the index are always
+ * attached to the document.
+ */
+
+// Get a document's ID index (or NULL if not built)
+static GHashTable *
+id_index(const xmlDoc *doc)
+{
+    const xml_doc_private_t *docpriv = NULL;
+
+    if (doc == NULL) {
+        return NULL;
+    }
+    docpriv = doc->_private;
+    return (docpriv == NULL)? NULL : docpriv->id_index;
+}
+
+/*!
+ * \internal
+ * \brief Add an element to its document's ID index, if enabled
+ *
+ * \param[in] xml  Element to add (if it has an ID)
+ */
+void
+pcmk__xml_index_add(xmlNode *xml)
+{
+    GHashTable *index = id_index(xml->doc);
+    const char *id = NULL;
+    gchar *key = NULL;
+    GPtrArray *elements = NULL;
+
+    if ((index == NULL) || (xml->type != XML_ELEMENT_NODE)) {
+        return;
+    }
+    id = pcmk__xe_id(xml);
+    if (id == NULL) {
+        return;
+    }
+
+    key = g_ascii_strdown(id, -1);
+    elements = g_hash_table_lookup(index, key);
+    if (elements == NULL) {
+        elements = g_ptr_array_sized_new(1);
+        g_hash_table_insert(index, key, elements);
+    } else {
+        g_free(key);
+        for (guint i = 0; i < elements->len; i++) {
+            if (g_ptr_array_index(elements, i) == xml) {
+                return; // Already indexed
+            }
+        }
+    }
+    g_ptr_array_add(elements, xml);
+}
+
+/*!
+ * \internal
+ * \brief Remove an element from its document's ID index, if enabled
+ *
+ * \param[in] xml  Element to remove (indexed under its current ID)
+ */
+void
+pcmk__xml_index_remove(xmlNode *xml)
+{
+    GHashTable *index = id_index(xml->doc);
+    const char *id = NULL;
+    gchar *key = NULL;
+    GPtrArray *elements = NULL;
+
+    if ((index == NULL) || (xml->type != XML_ELEMENT_NODE)) {
+        return;
+    }
+    id = pcmk__xe_id(xml);
+    if (id == NULL) {
+        return;
+    }
+
+    key = g_ascii_strdown(id, -1);
+    elements = g_hash_table_lookup(index, key);
+    if ((elements != NULL) && g_ptr_array_remove_fast(elements, xml)
+        && (elements->len == 0)) {
+        g_hash_table_remove(index, key);
+    }
+    g_free(key);
+}
+
+static bool
+index_element(xmlNode *xml, void *user_data)
+{
+    pcmk__xml_index_add(xml);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Get a document's ID index for a lookup, building it if needed
+ *
+ * \param[in,out] doc  Document to get index for
+ *
+ * \return ID index of \p doc, or NULL if \p doc is not indexed
+ */
+static GHashTable *
+lookup_index(xmlDoc *doc)
+{
+    xml_doc_private_t *docpriv = NULL;
+
+    if ((doc == NULL) || (doc->_private == NULL)) {
+        return NULL;
+    }
+
+    docpriv = doc->_private;
+    if ((docpriv->id_index == NULL) && docpriv->index_ids) {
+        docpriv->id_index =
+            pcmk__strkey_table(g_free, (GDestroyNotify) g_ptr_array_unref);
+        pcmk__xml_tree_foreach(xmlDocGetRootElement(doc), index_element, NULL);
+    }
+    return docpriv->id_index;
+}
+
+/*!
+ * \internal
+ * \brief Index a document's elements by ID, and keep the index up to date
+ *
+ * The index is built when first used.
+ *
+ * \param[in,out] doc  Document to index (if not already indexed)
+ */
+void
+pcmk__xml_doc_index_ids(xmlDoc *doc)
+{
+    CRM_CHECK((doc != NULL) && (doc->_private != NULL), return);
+
+    ((xml_doc_private_t *) doc->_private)->index_ids = true;
+}
+
+/*!
+ * \internal
+ * \brief Check whether a document's elements are indexed by ID
+ *
+ * \param[in] doc  Document to check
+ *
+ * \return \c true if \p doc is indexed (whether or not the index has been
+ *         built yet), otherwise \c false
+ */
+bool
+pcmk__xml_doc_ids_indexed(const xmlDoc *doc)
+{
+    const xml_doc_private_t *docpriv = NULL;
+
+    if (doc == NULL) {
+        return false;
+    }
+    docpriv = doc->_private;
+    return (docpriv != NULL) && docpriv->index_ids;
+}
+
+// Check whether an element is (or is a descendant of) another element
+static bool
+is_within(const xmlNode *xml, const xmlNode *ancestor, bool include_root)
+{
+    if (!include_root) {
+        if (xml == ancestor) {
+            return false;
+        }
+    }
+    for (; xml != NULL; xml = xml->parent) {
+        if (xml == ancestor) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// GCompareFunc to sort elements in document order
+static gint
+compare_document_order(gconstpointer a, gconstpointer b)
+{
+    switch (xmlXPathCmpNodes((xmlNode *) a, (xmlNode *) b)) {
+        case 1:
+            return -1;
+        case -1:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Use an ID index to find elements with a given name and ID in a tree
+ *
+ * \param[in]  xml           Root of tree to search
+ * \param[in]  name          Element name to match (or \c NULL to match any)
+ * \param[in]  id            ID to match
+ * \param[in]  casei         If \c true, match \p id case-insensitively
+ * \param[in]  include_root  If \c true, \p xml itself may match
+ * \param[out] matches       Where to store list of matching elements, in
+ *                           document order (the list itself must be freed by
+ *                           the caller with \c g_list_free())
+ *
+ * \return Standard Pacemaker return code (specifically, \c ENOTSUP if the
+ *         document containing \p xml is not indexed)
+ */
+int
+pcmk__xml_index_find(xmlNode *xml, const char *name, const char *id,
+                     bool casei, bool include_root, GList **matches)
+{
+    GHashTable *index = NULL;
+    GPtrArray *elements = NULL;
+    gchar *key = NULL;
+
+    CRM_CHECK((xml != NULL) && (id != NULL) && (matches != NULL),
+              return EINVAL);
+
+    *matches = NULL;
+    index = lookup_index(xml->doc);
+    if (index == NULL) {
+        return ENOTSUP;
+    }
+
+    key = g_ascii_strdown(id, -1);
+    elements = g_hash_table_lookup(index, key);
+    g_free(key);
+    if (elements == NULL) {
+        return pcmk_rc_ok;
+    }
+
+    for (guint i = 0; i < elements->len; i++) {
+        xmlNode *candidate = g_ptr_array_index(elements, i);
+
+        if (((name == NULL) || pcmk__xe_is(candidate, name))
+            && pcmk__str_eq(pcmk__xe_id(candidate), id,
+                            (casei? pcmk__str_casei : pcmk__str_none))
+            && is_within(candidate, xml, include_root)) {
+
+            *matches = g_list_prepend(*matches, candidate);
+        }
+    }
+    *matches = g_list_sort(*matches, compare_document_order);
+    return pcmk_rc_ok;
+}
+
+//! One location step of an XPath expression that can use an ID index
+struct id_step {
+    char *name;     //!< Element name (or NULL for any)
+    char *id;       //!< ID that element must have (or NULL for any)
+};
+
+static void
+free_id_step(gpointer data)
+{
+    struct id_step *step = data;
+
+    free(step->name);
+    free(step->id);
+    free(step);
+}
+
+/*!
+ * \internal
+ * \brief Parse an XPath expression into steps, if it can use an ID index
+ *
+ * Only absolute location paths whose steps are element names (or \c "*"),
+ * each with at most an ID predicate, and whose last step has an ID predicate,
+ * are supported. The path may start with \c "//" instead of \c "/". For
+ * example, \c "//primitive[@id='rsc1']" and
+ * \c "/cib/configuration/resources/primitive[@id='rsc1']/meta_attributes"
+ * \c "[@id='rsc1-meta']" are supported.
+ *
+ * \param[in]  path      XPath expression to parse
+ * \param[out] anywhere  Where to store whether the path starts with \c "//"
+ *
+ * \return List of <tt>struct id_step</tt>, or \c NULL if \p path is not
+ *         supported
+ */
+static GList *
+parse_id_xpath(const char *path, bool *anywhere)
+{
+    static const char *predicate = "[@" PCMK_XA_ID "=";
+    const size_t predicate_len = strlen(predicate);
+    GList *steps = NULL;
+    const char *p = path;
+
+    if (pcmk__starts_with(p, "//")) {
+        *anywhere = true;
+        p += 2;
+    } else if (*p == '/') {
+        *anywhere = false;
+        p++;
+    } else {
+        return NULL;
+    }
+
+    while (true) {
+        struct id_step *step = pcmk__assert_alloc(1, sizeof(struct id_step));
+        size_t len = 0;
+
+        steps = g_list_append(steps, step);
+
+        if (*p == '*') {
+            p++;
+        } else {
+            len = strspn(p, "abcdefghijklmnopqrstuvwxyz"
+                            "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-.:");
+            if (len == 0) {
+                goto unsupported;
+            }
+            step->name = strndup(p, len);
+            p += len;
+        }
+
+        if (strncmp(p, predicate, predicate_len) == 0) {
+            char quote = p[predicate_len];
+            const char *end = NULL;
+
+            if ((quote != '\'') && (quote != '"')) {
+                goto unsupported;
+            }
+            p += predicate_len + 1;
+            end = strchr(p, quote);
+            if ((end == NULL) || (end[1] != ']')) {
+                goto unsupported;
+            }
+            step->id = strndup(p, end - p);
+            p = end + 2;
+        }
+
+        if (*p == '\0') {
+            break;
+        }
+        if ((*p != '/') || (p[1] == '/')) {
+            goto unsupported;
+        }
+        p++;
+    }
+
+    if (((struct id_step *) g_list_last(steps)->data)->id != NULL) {
+        return steps;
+    }
+
+unsupported:
+    g_list_free_full(steps, free_id_step);
+    return NULL;
+}
+
+// Check whether an element is reached by a parsed XPath expression
+static bool
+matches_steps(const xmlNode *xml, const GList *last_step, bool anywhere)
+{
+    for (const GList *iter = last_step; iter != NULL; iter = iter->prev) {
+        const struct id_step *step = iter->data;
+
+        if ((xml == NULL) || (xml->type != XML_ELEMENT_NODE)
+            || ((step->name != NULL) && !pcmk__xe_is(xml, step->name))
+            || ((step->id != NULL)
+                && !pcmk__str_eq(pcmk__xe_id(xml), step->id,
+                                 pcmk__str_none))) {
+            return false;
+        }
+        xml = xml->parent;
+    }
+
+    // An absolute path's first step must be the root element
+    return anywhere || ((xml != NULL) && (xml->type == XML_DOCUMENT_NODE));
+}
+
+/*!
+ * \internal
+ * \brief Evaluate a simple ID-based XPath expression using an ID index
+ *
+ * \param[in] doc   Document to search
+ * \param[in] path  XPath expression to evaluate
+ *
+ * \return XPath result equivalent to evaluating \p path against \p doc, or
+ *         \c NULL if \p doc is not indexed or \p path is not simple enough
+ *         to use the index (see \c parse_id_xpath())
+ * \note The caller is responsible for freeing a non-<tt>NULL</tt> result with
+ *       \c freeXpathObject().
+ */
+xmlXPathObjectPtr
+pcmk__xml_index_xpath(xmlDoc *doc, const char *path)
+{
+    bool anywhere = false;
+    GList *steps = NULL;
+    GList *last_step = NULL;
+    GList *candidates = NULL;
+    xmlNodeSet *nodeset = NULL;
+    xmlNode *root = xmlDocGetRootElement(doc);
+
+    if ((root == NULL) || !pcmk__xml_doc_ids_indexed(doc)) {
+        return NULL;
+    }
+    steps = parse_id_xpath(path, &anywhere);
+    if (steps == NULL) {
+        return NULL;
+    }
+    last_step = g_list_last(steps);
+
+    pcmk__xml_index_find(root, ((struct id_step *) last_step->data)->name,
+                         ((struct id_step *) last_step->data)->id, false,
+                         true, &candidates);
+
+    nodeset = xmlXPathNodeSetCreate(NULL);
+    pcmk__mem_assert(nodeset);
+    for (const GList *iter = candidates; iter != NULL; iter = iter->next) {
+        xmlNode *candidate = iter->data;
+
+        if (matches_steps(candidate, last_step, anywhere)) {
+            xmlXPathNodeSetAdd(nodeset, candidate);
+        }
+    }
+
+    crm_trace("Used ID index for %s (%d match%s)",
+              path, nodeset->nodeNr, pcmk__plural_alt(nodeset->nodeNr,
+                                                      "", "es"));
+    g_list_free(candidates);
+    g_list_free_full(steps, free_id_step);
+    return xmlXPathWrapNodeSet(nodeset);
+}
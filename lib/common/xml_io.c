@@ -9,10 +9,12 @@
 
 #include <crm_internal.h>
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
+#include <unistd.h>                     // access()
 
 #include <bzlib.h>
 #include <libxml/parser.h>
@@ -94,7 +96,9 @@ done:
  *
  * \param[in] filename  Name of file containing XML (\c NULL or \c "-" for
  *                      \c stdin); if \p filename ends in \c ".bz2", the file
- *                      will be decompressed using \c bzip2
+ *                      will be decompressed using \c bzip2; if it does not
+ *                      exist but names a file in an XML archive (see
+ *                      \c pcmk__xml_archive_read()), it will be reconstructed
  *
  * \return XML tree parsed from the given file on success, otherwise \c NULL
  */
@@ -107,6 +111,14 @@ pcmk__xml_read(const char *filename)
     xmlParserCtxt *ctxt = NULL;
     const xmlError *last_error = NULL;
 
+    // A missing series file may have been stored in an XML archive instead
+    if (!use_stdin && (access(filename, F_OK) < 0) && (errno == ENOENT)) {
+        xml = pcmk__xml_archive_read_file(filename);
+        if (xml != NULL) {
+            return xml;
+        }
+    }
+
     // Create a parser context
     ctxt = xmlNewParserCtxt();
     CRM_CHECK(ctxt != NULL, return NULL);
@@ -146,6 +146,12 @@ xpath_search(const xmlNode *xml_top, const char *path)
     CRM_CHECK(xml_top != NULL, return NULL);
     CRM_CHECK(strlen(path) > 0, return NULL);
 
+    // Simple searches by ID don't need to scan an indexed document
+    xpathObj = pcmk__xml_index_xpath(xml_top->doc, path);
+    if (xpathObj != NULL) {
+        return xpathObj;
+    }
+
     xpathCtx = xmlXPathNewContext(xml_top->doc);
     pcmk__mem_assert(xpathCtx);
 
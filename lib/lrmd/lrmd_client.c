@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdint.h>         // uint32_t, uint64_t
+#include <limits.h>         // UINT_MAX
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
@@ -100,6 +101,9 @@ typedef struct lrmd_private_s {
     void (*proxy_callback)(lrmd_t *lrmd, void *userdata, xmlNode *msg);
     void *proxy_callback_userdata;
     char *peer_version;
+
+    // Whether peer accepts proxied IPC as binary frames
+    bool proxy_frames;
 } lrmd_private_t;
 
 static int process_lrmd_handshake_reply(xmlNode *reply, lrmd_private_t *native);
@@ -231,6 +235,11 @@ lrmd_copy_event(lrmd_event_data_t * event)
     copy->t_rcchange = event->t_rcchange;
     copy->exec_time = event->exec_time;
     copy->queue_time = event->queue_time;
+    copy->cpu_user_time = event->cpu_user_time;
+    copy->cpu_system_time = event->cpu_system_time;
+    copy->max_rss = event->max_rss;
+    copy->blocks_in = event->blocks_in;
+    copy->blocks_out = event->blocks_out;
     copy->connection_rc = event->connection_rc;
     copy->params = pcmk__str_table_dup(event->params);
 
@@ -260,6 +269,28 @@ lrmd_free_event(lrmd_event_data_t *event)
     free(event);
 }
 
+/*!
+ * \internal
+ * \brief Get a resource usage value from an executor notification
+ *
+ * \param[in] msg   Notification XML
+ * \param[in] name  Name of attribute with value
+ *
+ * \return Value of \p name in \p msg (or 0 if not present or invalid)
+ */
+static unsigned int
+rusage_value(const xmlNode *msg, const char *name)
+{
+    long long value = 0LL;
+
+    if ((pcmk__scan_ll(crm_element_value(msg, name), &value,
+                       0LL) != pcmk_rc_ok)
+        || (value < 0LL) || (value > UINT_MAX)) {
+        return 0;
+    }
+    return (unsigned int) value;
+}
+
 static void
 lrmd_dispatch_internal(gpointer data, gpointer user_data)
 {
@@ -325,6 +356,13 @@ lrmd_dispatch_internal(gpointer data, gpointer user_data)
         CRM_LOG_ASSERT(queue_time >= 0);
         event.queue_time = QB_MAX(0, queue_time);
 
+        event.cpu_user_time = rusage_value(msg, PCMK__XA_LRMD_CPU_USER_TIME);
+        event.cpu_system_time = rusage_value(msg,
+                                             PCMK__XA_LRMD_CPU_SYSTEM_TIME);
+        event.max_rss = rusage_value(msg, PCMK__XA_LRMD_MAX_RSS);
+        event.blocks_in = rusage_value(msg, PCMK__XA_LRMD_BLOCKS_IN);
+        event.blocks_out = rusage_value(msg, PCMK__XA_LRMD_BLOCKS_OUT);
+
         event.op_type = crm_element_value(msg, PCMK__XA_LRMD_RSC_ACTION);
         event.user_data = crm_element_value(msg,
                                             PCMK__XA_LRMD_RSC_USERDATA_STR);
@@ -383,6 +421,71 @@ remote_executor_connected(lrmd_t * lrmd)
     return (native->remote->tls_session != NULL);
 }
 
+/*!
+ * \internal
+ * \brief Convert a received proxy frame to an IPC proxy notification
+ *
+ * \param[in] frame  Proxy frame received from Pacemaker Remote
+ *
+ * \return Newly allocated notification XML, or NULL on error
+ */
+static xmlNode *
+proxy_frame2xml(const pcmk__proxy_frame_t *frame)
+{
+    xmlNode *msg = NULL;
+    xmlNode *wrapper = NULL;
+    xmlNode *request = NULL;
+
+    if (frame->op != pcmk__proxy_request) {
+        crm_err("Ignoring unexpected proxy frame type %d", frame->op);
+        return NULL;
+    }
+
+    request = pcmk__xml_parse(frame->payload);
+    if (request == NULL) {
+        crm_err("Ignoring unparsable proxied request for session %s",
+                frame->session);
+        return NULL;
+    }
+
+    msg = pcmk__xe_create(NULL, PCMK__XE_LRMD_IPC_PROXY);
+    crm_xml_add(msg, PCMK__XA_LRMD_REMOTE_MSG_TYPE, "notify");
+    crm_xml_add(msg, PCMK__XA_LRMD_IPC_OP, LRMD_IPC_OP_REQUEST);
+    crm_xml_add(msg, PCMK__XA_LRMD_IPC_SESSION, frame->session);
+    crm_xml_add(msg, PCMK__XA_LRMD_IPC_CLIENT, frame->client);
+    crm_xml_add(msg, PCMK__XA_LRMD_IPC_USER, frame->user);
+    crm_xml_add_int(msg, PCMK__XA_LRMD_IPC_MSG_ID, (int) frame->msg_id);
+    crm_xml_add_int(msg, PCMK__XA_LRMD_IPC_MSG_FLAGS, (int) frame->ipc_flags);
+
+    wrapper = pcmk__xe_create(msg, PCMK__XE_LRMD_IPC_MSG);
+    pcmk__xml_copy(wrapper, request);
+    pcmk__xml_free(request);
+    return msg;
+}
+
+/*!
+ * \internal
+ * \brief Obtain the XML from the currently buffered Pacemaker Remote message
+ *
+ * \param[in,out] native  Executor connection private data
+ *
+ * \return Newly allocated message XML, or NULL if none is available
+ */
+static xmlNode *
+remote_message_xml(lrmd_private_t *native)
+{
+    pcmk__proxy_frame_t frame = { 0, };
+
+    if (!pcmk__remote_message_is_proxy_frame(native->remote)) {
+        return pcmk__remote_message_xml(native->remote);
+    }
+    if (pcmk__remote_message_proxy_frame(native->remote,
+                                         &frame) != pcmk_rc_ok) {
+        return NULL;
+    }
+    return proxy_frame2xml(&frame);
+}
+
 static void
 handle_remote_msg(xmlNode *xml, lrmd_t *lrmd)
 {
@@ -479,7 +582,7 @@ lrmd_tls_dispatch(gpointer userdata)
     /* If rc is ETIME, there was nothing to read but we may already have a
      * full message in the buffer
      */
-    xml = pcmk__remote_message_xml(native->remote);
+    xml = remote_message_xml(native);
 
     if (xml == NULL) {
         return 0;
@@ -692,7 +795,7 @@ read_remote_reply(lrmd_t *lrmd, int total_timeout, int expected_reply_id,
 
     for (*reply = NULL; *reply == NULL; ) {
 
-        *reply = pcmk__remote_message_xml(native->remote);
+        *reply = remote_message_xml(native);
         if (*reply == NULL) {
             /* read some more off the tls buffer if we still have time left. */
             if (remaining_timeout) {
@@ -709,7 +812,7 @@ read_remote_reply(lrmd_t *lrmd, int total_timeout, int expected_reply_id,
                 return rc;
             }
 
-            *reply = pcmk__remote_message_xml(native->remote);
+            *reply = remote_message_xml(native);
             if (*reply == NULL) {
                 return ENOMSG;
             }
@@ -1013,6 +1116,7 @@ lrmd_handshake_hello_msg(const char *name, bool is_proxy)
     /* advertise that we are a proxy provider */
     if (is_proxy) {
         pcmk__xe_set_bool_attr(hello, PCMK__XA_LRMD_IS_IPC_PROVIDER, true);
+        pcmk__xe_set_bool_attr(hello, PCMK__XA_LRMD_PROXY_FRAMES, true);
     }
 
     return hello;
@@ -1058,6 +1162,8 @@ process_lrmd_handshake_reply(xmlNode *reply, lrmd_private_t *native)
         crm_trace("Obtained registration token: %s", tmp_ticket);
         native->token = strdup(tmp_ticket);
         native->peer_version = strdup(version?version:"1.0"); /* Included since 1.1 */
+        native->proxy_frames = pcmk__xe_attr_is_true(reply,
+                                                     PCMK__XA_LRMD_PROXY_FRAMES);
         rc = pcmk_rc_ok;
     }
 
@@ -2056,6 +2162,117 @@ lrmd_internal_proxy_send(lrmd_t * lrmd, xmlNode *msg)
     return lrmd_send_xml_no_reply(lrmd, msg);
 }
 
+/*!
+ * \internal
+ * \brief Check whether an executor connection accepts proxy frames
+ *
+ * \param[in] lrmd  Executor connection
+ *
+ * \return true if \p lrmd is a Pacemaker Remote connection whose peer said it
+ *         accepts proxied IPC as binary frames, otherwise false
+ */
+bool
+lrmd__proxy_frames(const lrmd_t *lrmd)
+{
+    const lrmd_private_t *native = NULL;
+
+    if (lrmd == NULL) {
+        return false;
+    }
+    native = lrmd->lrmd_private;
+    return (native->type == pcmk__client_tls) && native->proxy_frames;
+}
+
+/*!
+ * \internal
+ * \brief Send a proxied IPC message to Pacemaker Remote as a binary frame
+ *
+ * \param[in,out] lrmd   Executor connection (must accept frames)
+ * \param[in]     frame  Proxy frame to send
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+lrmd__proxy_send_frame(lrmd_t *lrmd, const pcmk__proxy_frame_t *frame)
+{
+    lrmd_private_t *native = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (!lrmd__proxy_frames(lrmd) || !remote_executor_connected(lrmd)) {
+        return ENOTCONN;
+    }
+    native = lrmd->lrmd_private;
+
+    // Unlike XML proxy messages, frames do not get a reply
+    rc = pcmk__remote_send_proxy_frame(native->remote, frame);
+    if (rc != pcmk_rc_ok) {
+        crm_err("Disconnecting because proxy frame could not be sent to "
+                "Pacemaker Remote: %s", pcmk_rc_str(rc));
+        lrmd_tls_disconnect(lrmd);
+    }
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Limit which notifications the executor sends to a connection
+ *
+ * \param[in,out] lrmd     Executor connection
+ * \param[in]     flags    Group of <tt>enum lrmd__notify_flags</tt> indicating
+ *                         which classes of notifications are wanted
+ * \param[in]     rsc_ids  If not \c NULL, only send action results and
+ *                         resource changes for these resource IDs
+ * \param[in]     actions  If not \c NULL, only send results of these actions
+ *                         (such as \c PCMK_ACTION_MONITOR)
+ *
+ * \return Standard Pacemaker return code
+ * \note The filter replaces any earlier one and lasts as long as the
+ *       connection. Passing \c lrmd__notify_all with no lists restores the
+ *       default of receiving all notifications.
+ * \note A TLS client that checks its connection with poke_connection() must
+ *       keep \c lrmd__notify_connection, because the executor answers a poke
+ *       over TLS with a notification.
+ */
+int
+lrmd__set_notify_filter(lrmd_t *lrmd, uint32_t flags, const GList *rsc_ids,
+                        const GList *actions)
+{
+    lrmd_private_t *native = NULL;
+    xmlNode *data = NULL;
+    int rc = pcmk_ok;
+
+    if (lrmd == NULL) {
+        return EINVAL;
+    }
+    if (!lrmd_api_is_connected(lrmd)) {
+        return ENOTCONN;
+    }
+    native = lrmd->lrmd_private;
+    if (!LRMD_SUPPORTS_NOTIFY_FILTER(native->peer_version)) {
+        return EOPNOTSUPP;
+    }
+
+    data = pcmk__xe_create(NULL, PCMK__XE_LRMD_NOTIFY_FILTER);
+    crm_xml_add(data, PCMK__XA_LRMD_ORIGIN, __func__);
+    crm_xml_add_ll(data, PCMK__XA_LRMD_NOTIFY_FLAGS, (long long) flags);
+
+    for (const GList *iter = rsc_ids; iter != NULL; iter = iter->next) {
+        xmlNode *rsc = pcmk__xe_create(data, PCMK__XE_LRMD_RSC);
+
+        crm_xml_add(rsc, PCMK__XA_LRMD_RSC_ID, (const char *) iter->data);
+    }
+    for (const GList *iter = actions; iter != NULL; iter = iter->next) {
+        xmlNode *op = pcmk__xe_create(data, PCMK__XE_LRMD_RSC_OP);
+
+        crm_xml_add(op, PCMK__XA_LRMD_RSC_ACTION, (const char *) iter->data);
+    }
+
+    rc = lrmd_send_command(lrmd, LRMD_OP_NOTIFY_FILTER, data, NULL, 0, 0,
+                           true);
+    pcmk__xml_free(data);
+    return pcmk_legacy2rc(rc);
+}
+
 static int
 stonith_get_metadata(const char *provider, const char *type, char **output)
 {
@@ -134,6 +134,34 @@ remote_proxy_dispatch(const char *buffer, ssize_t length, gpointer userdata)
     uint32_t flags = 0;
     remote_proxy_t *proxy = userdata;
 
+    if (lrmd__proxy_frames(proxy->lrm)) {
+        /* The remote node accepts the message text as is, so there is no need
+         * to parse it and wrap it in XML
+         */
+        pcmk__proxy_frame_t frame = {
+            .op = pcmk__proxy_event,
+            .session = proxy->session_id,
+            .payload = buffer,
+            .payload_len = strlen(buffer) + 1,
+        };
+
+        flags = crm_ipc_buffer_flags(proxy->ipc);
+        if (flags & crm_ipc_proxied_relay_response) {
+            crm_trace("Passing response back to %.8s on %s as frame: "
+                      "%.200s - request id: %d", proxy->session_id,
+                      proxy->node_name, buffer, proxy->last_request_id);
+            frame.op = pcmk__proxy_response;
+            frame.msg_id = (uint32_t) proxy->last_request_id;
+            proxy->last_request_id = 0;
+
+        } else {
+            crm_trace("Passing event back to %.8s on %s as frame: %.200s",
+                      proxy->session_id, proxy->node_name, buffer);
+        }
+        lrmd__proxy_send_frame(proxy->lrm, &frame);
+        return 1;
+    }
+
     xml = pcmk__xml_parse(buffer);
     if (xml == NULL) {
         crm_warn("Received a NULL msg from IPC service.");
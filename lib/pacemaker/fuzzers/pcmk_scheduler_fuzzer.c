@@ -0,0 +1,808 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+/* Structure-aware fuzzing of the scheduler
+ *
+ * Rather than parsing the fuzzer input as XML (which would spend nearly all of
+ * its time in the XML parser), the input bytes are used as a sequence of
+ * choices to generate a well-formed CIB: cluster options, nodes and their
+ * states, primitives, groups, clones, bundles, location/colocation/ordering
+ * constraints (with and without resource sets), and resource histories. Small
+ * changes to the input thus make small changes to the CIB, which lets
+ * libFuzzer's mutation and minimization work well.
+ *
+ * Each generated CIB is scheduled twice, and the fuzzer aborts if:
+ *
+ * - the two resulting transition graphs differ (non-determinism), or
+ * - the CIB takes a measurable time to schedule, and scheduling a CIB with
+ *   SCALE_COPIES copies of the resources, constraints, and histories takes
+ *   more than SCALE_TOLERANCE times longer than linear growth would predict.
+ *
+ * Crashes and assertion failures are of course caught by libFuzzer itself.
+ *
+ * If the PCMK_FUZZ_FIXTURE_DIR environment variable is set to a directory
+ * name, problem inputs are saved there as scheduler regression test inputs
+ * (see cts/scheduler/xml) named fuzz-<digest>.xml. Non-deterministic and slow
+ * inputs are first minimized by removing each element that isn't needed to
+ * reproduce the problem. Crashing inputs can't be detected in advance, so
+ * when the variable is set, every input is saved before being scheduled; use
+ * it when replaying a single (ideally already minimized via libFuzzer's
+ * -minimize_crash=1) crash file.
+ */
+
+#include <crm_internal.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <glib.h>
+#include <libxml/tree.h>
+
+#include <crm/common/xml.h>
+#include <crm/lrmd_internal.h>
+#include <crm/pengine/status.h>
+#include <pacemaker-internal.h>
+
+// Environment variable naming directory to save problem inputs to
+#define FIXTURE_DIR_ENV     "PCMK_FUZZ_FIXTURE_DIR"
+
+// Limits on generated CIB contents
+#define MAX_NODES           8
+#define MAX_RESOURCES       12  // Top-level resources per copy
+#define MAX_CONSTRAINTS     12  // Constraints per copy
+#define MAX_HISTORY         3   // History entries per resource per node
+
+// Fixed "now" so that scheduling doesn't depend on the current time
+#define FUZZ_NOW            ((time_t) 1704067200)   // 2024-01-01 00:00:00 UTC
+
+// Superlinear runtime detection
+#define SCALE_COPIES        8       // Copies of resources in scaled input
+#define SCALE_MIN_US        1000    // Don't check unscaled runs faster than
+#define SCALE_FLOOR_US      200000  // Never flag scaled runs faster than
+#define SCALE_TOLERANCE     4       // Allowed slowdown beyond linear growth
+
+#define FUZZ_ORIGIN         "scheduler_fuzzer"
+
+enum fuzz_problem {
+    fuzz_nondeterministic,
+    fuzz_superlinear,
+};
+
+// Fuzzer input, consumed one choice at a time
+struct fuzz_input {
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+};
+
+// State while generating a CIB
+struct cib_gen {
+    struct fuzz_input *input;
+    xmlNode *resources;
+    xmlNode *constraints;
+    GPtrArray *node_names;  // Node names (char *)
+    GPtrArray *histories;   // lrm_resources element for each node (xmlNode *)
+    GPtrArray *rsc_ids;     // Top-level resource IDs in current copy (char *)
+    GPtrArray *primitives;  // Primitive IDs in current copy (char *)
+    const char *suffix;     // Suffix for IDs in current copy
+    int call_id;            // Last history call ID used
+};
+
+static const char *no_quorum_policies[] = {
+    PCMK_VALUE_STOP, PCMK_VALUE_IGNORE, PCMK_VALUE_FREEZE, PCMK_VALUE_DEMOTE,
+};
+
+static const char *placement_strategies[] = {
+    PCMK_VALUE_DEFAULT, PCMK_VALUE_UTILIZATION, PCMK_VALUE_BALANCED,
+    PCMK_VALUE_MINIMAL, PCMK_VALUE_PACKED,
+};
+
+static const char *target_roles[] = {
+    PCMK_ROLE_STARTED, PCMK_ROLE_STOPPED, PCMK_ROLE_UNPROMOTED,
+    PCMK_ROLE_PROMOTED,
+};
+
+static const char *scores[] = {
+    PCMK_VALUE_INFINITY, PCMK_VALUE_MINUS_INFINITY, "100", "-100", "0",
+};
+
+static const char *order_kinds[] = {
+    PCMK_VALUE_MANDATORY, PCMK_VALUE_OPTIONAL, PCMK_VALUE_SERIALIZE,
+};
+
+static const char *history_actions[] = {
+    PCMK_ACTION_START, PCMK_ACTION_STOP, PCMK_ACTION_MONITOR,
+    PCMK_ACTION_PROMOTE, PCMK_ACTION_DEMOTE, PCMK_ACTION_MIGRATE_TO,
+    PCMK_ACTION_MIGRATE_FROM,
+};
+
+static const enum ocf_exitcode history_rcs[] = {
+    PCMK_OCF_OK, PCMK_OCF_UNKNOWN_ERROR, PCMK_OCF_NOT_RUNNING,
+    PCMK_OCF_RUNNING_PROMOTED,
+};
+
+static const enum pcmk_exec_status history_statuses[] = {
+    PCMK_EXEC_DONE, PCMK_EXEC_ERROR, PCMK_EXEC_TIMEOUT, PCMK_EXEC_PENDING,
+};
+
+static pcmk__output_t *logger_out = NULL;
+
+/*!
+ * \internal
+ * \brief Consume one choice from fuzzer input
+ *
+ * \param[in,out] input  Fuzzer input
+ * \param[in]     n      Number of possible choices (at most 256)
+ *
+ * \return Choice in the range 0 to \p n - 1 (0 once input is exhausted)
+ */
+static unsigned int
+choose(struct fuzz_input *input, unsigned int n)
+{
+    if (input->pos >= input->size) {
+        return 0;
+    }
+    return input->data[input->pos++] % n;
+}
+
+#define choose_from(input, array) (array)[choose((input), PCMK__NELEM(array))]
+
+/*!
+ * \internal
+ * \brief Choose an ID from a list of IDs
+ *
+ * \param[in,out] input  Fuzzer input
+ * \param[in]     ids    List of IDs (must not be empty)
+ *
+ * \return Chosen ID
+ */
+static const char *
+choose_id(struct fuzz_input *input, const GPtrArray *ids)
+{
+    return g_ptr_array_index(ids, choose(input, ids->len));
+}
+
+static void
+add_cluster_options(struct cib_gen *gen, xmlNode *crm_config)
+{
+    xmlNode *set = pcmk__xe_create(crm_config, PCMK_XE_CLUSTER_PROPERTY_SET);
+
+    crm_xml_add(set, PCMK_XA_ID, "cib-bootstrap-options");
+    crm_create_nvpair_xml(set, NULL, PCMK_OPT_STONITH_ENABLED,
+                          pcmk__btoa(choose(gen->input, 2) == 0));
+    crm_create_nvpair_xml(set, NULL, PCMK_OPT_SYMMETRIC_CLUSTER,
+                          pcmk__btoa(choose(gen->input, 4) != 0));
+    crm_create_nvpair_xml(set, NULL, PCMK_OPT_NO_QUORUM_POLICY,
+                          choose_from(gen->input, no_quorum_policies));
+    crm_create_nvpair_xml(set, NULL, PCMK_OPT_PLACEMENT_STRATEGY,
+                          choose_from(gen->input, placement_strategies));
+}
+
+static void
+add_int_nvpair(xmlNode *parent, const char *name, int value)
+{
+    char *value_s = pcmk__itoa(value);
+
+    crm_create_nvpair_xml(parent, NULL, name, value_s);
+    free(value_s);
+}
+
+static void
+add_utilization(struct cib_gen *gen, xmlNode *parent)
+{
+    xmlNode *utilization = NULL;
+
+    if (choose(gen->input, 4) != 0) {
+        return;
+    }
+    utilization = pcmk__xe_create(parent, PCMK_XE_UTILIZATION);
+    pcmk__xe_set_id(utilization, "%s-utilization", pcmk__xe_id(parent));
+    add_int_nvpair(utilization, "cpu", 1 + choose(gen->input, 8));
+}
+
+static void
+add_nodes(struct cib_gen *gen, xmlNode *nodes, xmlNode *status)
+{
+    unsigned int n_nodes = 1 + choose(gen->input, MAX_NODES);
+
+    for (unsigned int i = 1; i <= n_nodes; i++) {
+        xmlNode *node = pcmk__xe_create(nodes, PCMK_XE_NODE);
+        xmlNode *state = pcmk__xe_create(status, PCMK__XE_NODE_STATE);
+        xmlNode *lrm = pcmk__xe_create(state, PCMK__XE_LRM);
+        char *name = crm_strdup_printf("node%u", i);
+
+        crm_xml_add(node, PCMK_XA_ID, name);
+        crm_xml_add(node, PCMK_XA_UNAME, name);
+        add_utilization(gen, node);
+
+        crm_xml_add(state, PCMK_XA_ID, name);
+        crm_xml_add(state, PCMK_XA_UNAME, name);
+        switch (choose(gen->input, 4)) {
+            case 0: // Cleanly down
+                crm_xml_add(state, PCMK__XA_IN_CCM, PCMK_VALUE_FALSE);
+                crm_xml_add(state, PCMK_XA_CRMD, PCMK_VALUE_OFFLINE);
+                crm_xml_add(state, PCMK__XA_JOIN, CRMD_JOINSTATE_DOWN);
+                crm_xml_add(state, PCMK_XA_EXPECTED, CRMD_JOINSTATE_DOWN);
+                break;
+            case 1: // Lost unexpectedly (unclean)
+                crm_xml_add(state, PCMK__XA_IN_CCM, PCMK_VALUE_FALSE);
+                crm_xml_add(state, PCMK_XA_CRMD, PCMK_VALUE_OFFLINE);
+                crm_xml_add(state, PCMK__XA_JOIN, CRMD_JOINSTATE_MEMBER);
+                crm_xml_add(state, PCMK_XA_EXPECTED, CRMD_JOINSTATE_MEMBER);
+                break;
+            default: // Up
+                crm_xml_add(state, PCMK__XA_IN_CCM, PCMK_VALUE_TRUE);
+                crm_xml_add(state, PCMK_XA_CRMD, PCMK_VALUE_ONLINE);
+                crm_xml_add(state, PCMK__XA_JOIN, CRMD_JOINSTATE_MEMBER);
+                crm_xml_add(state, PCMK_XA_EXPECTED, CRMD_JOINSTATE_MEMBER);
+                break;
+        }
+
+        crm_xml_add(lrm, PCMK_XA_ID, name);
+        g_ptr_array_add(gen->histories,
+                        pcmk__xe_create(lrm, PCMK__XE_LRM_RESOURCES));
+        g_ptr_array_add(gen->node_names, name);
+    }
+}
+
+static void
+add_meta_attributes(struct cib_gen *gen, xmlNode *rsc, bool promotable)
+{
+    xmlNode *meta = NULL;
+
+    if (!promotable && (choose(gen->input, 2) == 0)) {
+        return;
+    }
+
+    meta = pcmk__xe_create(rsc, PCMK_XE_META_ATTRIBUTES);
+    pcmk__xe_set_id(meta, "%s-meta_attributes", pcmk__xe_id(rsc));
+
+    if (promotable) {
+        crm_create_nvpair_xml(meta, NULL, PCMK_META_PROMOTABLE,
+                              PCMK_VALUE_TRUE);
+    }
+    if (choose(gen->input, 2) == 0) {
+        crm_create_nvpair_xml(meta, NULL, PCMK_META_TARGET_ROLE,
+                              choose_from(gen->input, target_roles));
+    }
+    if (choose(gen->input, 2) == 0) {
+        crm_create_nvpair_xml(meta, NULL, PCMK_META_RESOURCE_STICKINESS,
+                              choose_from(gen->input, scores));
+    }
+    if (choose(gen->input, 4) == 0) {
+        add_int_nvpair(meta, PCMK_META_MIGRATION_THRESHOLD,
+                       1 + choose(gen->input, 3));
+    }
+    if (choose(gen->input, 4) == 0) {
+        crm_create_nvpair_xml(meta, NULL, PCMK_META_INTERLEAVE,
+                              PCMK_VALUE_TRUE);
+    }
+}
+
+static xmlNode *
+add_primitive(struct cib_gen *gen, xmlNode *parent, bool stateful)
+{
+    xmlNode *rsc = pcmk__xe_create(parent, PCMK_XE_PRIMITIVE);
+    xmlNode *ops = NULL;
+    xmlNode *op = NULL;
+
+    pcmk__xe_set_id(rsc, "rsc%u%s", gen->primitives->len + 1, gen->suffix);
+    crm_xml_add(rsc, PCMK_XA_CLASS, PCMK_RESOURCE_CLASS_OCF);
+    crm_xml_add(rsc, PCMK_XA_PROVIDER, "pacemaker");
+    crm_xml_add(rsc, PCMK_XA_TYPE, (stateful? "Stateful" : "Dummy"));
+    add_meta_attributes(gen, rsc, false);
+    add_utilization(gen, rsc);
+
+    ops = pcmk__xe_create(rsc, PCMK_XE_OPERATIONS);
+    op = pcmk__xe_create(ops, PCMK_XE_OP);
+    pcmk__xe_set_id(op, "%s-monitor-10s", pcmk__xe_id(rsc));
+    crm_xml_add(op, PCMK_XA_NAME, PCMK_ACTION_MONITOR);
+    crm_xml_add(op, PCMK_XA_INTERVAL, "10s");
+
+    g_ptr_array_add(gen->primitives, pcmk__str_copy(pcmk__xe_id(rsc)));
+    return rsc;
+}
+
+static void
+add_resource(struct cib_gen *gen)
+{
+    unsigned int n = gen->rsc_ids->len + 1;
+    xmlNode *rsc = NULL;
+
+    switch (choose(gen->input, 4)) {
+        case 0:
+            rsc = pcmk__xe_create(gen->resources, PCMK_XE_GROUP);
+            pcmk__xe_set_id(rsc, "group%u%s", n, gen->suffix);
+            add_meta_attributes(gen, rsc, false);
+            for (unsigned int i = choose(gen->input, 3); i <= 3; i++) {
+                add_primitive(gen, rsc, false);
+            }
+            break;
+
+        case 1:
+            {
+                bool promotable = (choose(gen->input, 2) == 0);
+
+                rsc = pcmk__xe_create(gen->resources, PCMK_XE_CLONE);
+                pcmk__xe_set_id(rsc, "clone%u%s", n, gen->suffix);
+                add_meta_attributes(gen, rsc, promotable);
+                add_primitive(gen, rsc, promotable);
+            }
+            break;
+
+        case 2:
+            {
+                xmlNode *child = NULL;
+
+                rsc = pcmk__xe_create(gen->resources, PCMK_XE_BUNDLE);
+                pcmk__xe_set_id(rsc, "bundle%u%s", n, gen->suffix);
+                add_meta_attributes(gen, rsc, false);
+
+                child = pcmk__xe_create(rsc, PCMK_XE_DOCKER);
+                crm_xml_add(child, PCMK_XA_IMAGE, "pcmktest:fuzz");
+                crm_xml_add_int(child, PCMK_XA_REPLICAS,
+                                1 + choose(gen->input, 3));
+
+                child = pcmk__xe_create(rsc, PCMK_XE_NETWORK);
+                crm_xml_add(child, PCMK_XA_CONTROL_PORT, "3121");
+
+                if (choose(gen->input, 2) == 0) {
+                    add_primitive(gen, rsc, false);
+                }
+            }
+            break;
+
+        default:
+            rsc = add_primitive(gen, gen->resources, false);
+            break;
+    }
+    g_ptr_array_add(gen->rsc_ids, pcmk__str_copy(pcmk__xe_id(rsc)));
+}
+
+static void
+add_resource_set(struct cib_gen *gen, xmlNode *constraint)
+{
+    xmlNode *set = pcmk__xe_create(constraint, PCMK_XE_RESOURCE_SET);
+
+    pcmk__xe_set_id(set, "%s-set", pcmk__xe_id(constraint));
+    pcmk__xe_set_bool_attr(set, PCMK_XA_SEQUENTIAL,
+                           (choose(gen->input, 2) == 0));
+    for (unsigned int i = choose(gen->input, 3); i <= 3; i++) {
+        xmlNode *ref = pcmk__xe_create(set, PCMK_XE_RESOURCE_REF);
+
+        crm_xml_add(ref, PCMK_XA_ID, choose_id(gen->input, gen->rsc_ids));
+    }
+}
+
+static void
+add_constraint(struct cib_gen *gen, unsigned int n)
+{
+    bool use_set = (choose(gen->input, 4) == 0);
+    xmlNode *constraint = NULL;
+
+    switch (choose(gen->input, 3)) {
+        case 0:
+            constraint = pcmk__xe_create(gen->constraints,
+                                         PCMK_XE_RSC_LOCATION);
+            pcmk__xe_set_id(constraint, "location%u%s", n, gen->suffix);
+            crm_xml_add(constraint, PCMK_XA_NODE,
+                        choose_id(gen->input, gen->node_names));
+            crm_xml_add(constraint, PCMK_XA_SCORE,
+                        choose_from(gen->input, scores));
+            if (use_set) {
+                add_resource_set(gen, constraint);
+            } else {
+                crm_xml_add(constraint, PCMK_XA_RSC,
+                            choose_id(gen->input, gen->rsc_ids));
+            }
+            break;
+
+        case 1:
+            constraint = pcmk__xe_create(gen->constraints,
+                                         PCMK_XE_RSC_COLOCATION);
+            pcmk__xe_set_id(constraint, "colocation%u%s", n, gen->suffix);
+            crm_xml_add(constraint, PCMK_XA_SCORE,
+                        choose_from(gen->input, scores));
+            if (use_set) {
+                add_resource_set(gen, constraint);
+            } else {
+                crm_xml_add(constraint, PCMK_XA_RSC,
+                            choose_id(gen->input, gen->rsc_ids));
+                crm_xml_add(constraint, PCMK_XA_WITH_RSC,
+                            choose_id(gen->input, gen->rsc_ids));
+                if (choose(gen->input, 4) == 0) {
+                    crm_xml_add(constraint, PCMK_XA_WITH_RSC_ROLE,
+                                PCMK_ROLE_PROMOTED);
+                }
+            }
+            break;
+
+        default:
+            constraint = pcmk__xe_create(gen->constraints, PCMK_XE_RSC_ORDER);
+            pcmk__xe_set_id(constraint, "order%u%s", n, gen->suffix);
+            crm_xml_add(constraint, PCMK_XA_KIND,
+                        choose_from(gen->input, order_kinds));
+            if (use_set) {
+                add_resource_set(gen, constraint);
+            } else {
+                crm_xml_add(constraint, PCMK_XA_FIRST,
+                            choose_id(gen->input, gen->rsc_ids));
+                crm_xml_add(constraint, PCMK_XA_THEN,
+                            choose_id(gen->input, gen->rsc_ids));
+            }
+            break;
+    }
+}
+
+static void
+add_history(struct cib_gen *gen, const char *rsc_id, xmlNode *lrm_resources,
+            const char *node_name)
+{
+    xmlNode *lrm_rsc = pcmk__xe_create(lrm_resources, PCMK__XE_LRM_RESOURCE);
+
+    crm_xml_add(lrm_rsc, PCMK_XA_ID, rsc_id);
+    crm_xml_add(lrm_rsc, PCMK_XA_CLASS, PCMK_RESOURCE_CLASS_OCF);
+    crm_xml_add(lrm_rsc, PCMK_XA_PROVIDER, "pacemaker");
+    crm_xml_add(lrm_rsc, PCMK_XA_TYPE, "Dummy");
+
+    for (unsigned int i = choose(gen->input, MAX_HISTORY); i < MAX_HISTORY;
+         i++) {
+
+        const char *task = choose_from(gen->input, history_actions);
+        guint interval_ms = 0;
+        lrmd_event_data_t *op = NULL;
+
+        if (pcmk__str_eq(task, PCMK_ACTION_MONITOR, pcmk__str_none)
+            && (choose(gen->input, 2) == 0)) {
+            interval_ms = 10000;
+        }
+
+        op = lrmd_new_event(rsc_id, task, interval_ms);
+        lrmd__set_result(op, choose_from(gen->input, history_rcs),
+                         choose_from(gen->input, history_statuses), NULL);
+        op->call_id = ++(gen->call_id);
+        op->t_run = FUZZ_NOW - 60 + gen->call_id;
+        op->t_rcchange = op->t_run;
+        pcmk__create_history_xml(lrm_rsc, op, CRM_FEATURE_SET, PCMK_OCF_OK,
+                                 node_name, FUZZ_ORIGIN);
+        lrmd_free_event(op);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Generate one copy of resources, constraints, and histories
+ *
+ * \param[in,out] gen  CIB generation state
+ */
+static void
+add_copy(struct cib_gen *gen)
+{
+    unsigned int n_resources = 1 + choose(gen->input, MAX_RESOURCES);
+    unsigned int n_constraints = choose(gen->input, MAX_CONSTRAINTS + 1);
+
+    g_ptr_array_set_size(gen->rsc_ids, 0);
+    g_ptr_array_set_size(gen->primitives, 0);
+
+    for (unsigned int i = 0; i < n_resources; i++) {
+        add_resource(gen);
+    }
+    for (unsigned int i = 1; i <= n_constraints; i++) {
+        add_constraint(gen, i);
+    }
+    for (unsigned int i = 0; i < gen->primitives->len; i++) {
+        for (unsigned int j = 0; j < gen->node_names->len; j++) {
+            if (choose(gen->input, 4) == 0) {
+                add_history(gen, g_ptr_array_index(gen->primitives, i),
+                            g_ptr_array_index(gen->histories, j),
+                            g_ptr_array_index(gen->node_names, j));
+            }
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Generate a CIB from fuzzer input
+ *
+ * \param[in] data    Fuzzer input
+ * \param[in] size    Size of \p data
+ * \param[in] copies  Number of copies of resources, constraints, and histories
+ *                    to generate (each from the same input)
+ *
+ * \return Newly allocated CIB XML
+ */
+static xmlNode *
+generate_cib(const uint8_t *data, size_t size, unsigned int copies)
+{
+    struct fuzz_input input = { data, size, 0 };
+    struct cib_gen gen = {
+        .input = &input,
+        .node_names = g_ptr_array_new_with_free_func(free),
+        .histories = g_ptr_array_new(),
+        .rsc_ids = g_ptr_array_new_with_free_func(free),
+        .primitives = g_ptr_array_new_with_free_func(free),
+    };
+    xmlNode *cib = pcmk__xe_create(NULL, PCMK_XE_CIB);
+    xmlNode *config = pcmk__xe_create(cib, PCMK_XE_CONFIGURATION);
+    xmlNode *crm_config = pcmk__xe_create(config, PCMK_XE_CRM_CONFIG);
+    xmlNode *nodes = pcmk__xe_create(config, PCMK_XE_NODES);
+    xmlNode *status = NULL;
+    size_t copy_start = 0;
+
+    gen.resources = pcmk__xe_create(config, PCMK_XE_RESOURCES);
+    gen.constraints = pcmk__xe_create(config, PCMK_XE_CONSTRAINTS);
+    status = pcmk__xe_create(cib, PCMK_XE_STATUS);
+
+    crm_xml_add(cib, PCMK_XA_VALIDATE_WITH, "pacemaker-4.0");
+    crm_xml_add(cib, PCMK_XA_CRM_FEATURE_SET, CRM_FEATURE_SET);
+    crm_xml_add_int(cib, PCMK_XA_ADMIN_EPOCH, 0);
+    crm_xml_add_int(cib, PCMK_XA_EPOCH, 1);
+    crm_xml_add_int(cib, PCMK_XA_NUM_UPDATES, 0);
+    crm_xml_add_ll(cib, PCMK_XA_EXECUTION_DATE, (long long) FUZZ_NOW);
+
+    add_cluster_options(&gen, crm_config);
+    pcmk__xe_set_bool_attr(cib, PCMK_XA_HAVE_QUORUM,
+                           (choose(&input, 4) != 0));
+    add_nodes(&gen, nodes, status);
+
+    copy_start = input.pos;
+    for (unsigned int i = 0; i < copies; i++) {
+        char *suffix = (i == 0)? pcmk__str_copy("")
+                                : crm_strdup_printf("-copy%u", i);
+
+        input.pos = copy_start;
+        gen.suffix = suffix;
+        add_copy(&gen);
+        free(suffix);
+    }
+
+    g_ptr_array_free(gen.node_names, TRUE);
+    g_ptr_array_free(gen.histories, TRUE);
+    g_ptr_array_free(gen.rsc_ids, TRUE);
+    g_ptr_array_free(gen.primitives, TRUE);
+    return cib;
+}
+
+/*!
+ * \internal
+ * \brief Schedule a CIB
+ *
+ * \param[in]  cib         CIB to schedule
+ * \param[out] elapsed_us  Where to store scheduling time (microseconds)
+ *
+ * \return Newly allocated digest of resulting transition graph (or NULL if the
+ *         CIB could not be unpacked)
+ */
+static char *
+schedule(const xmlNode *cib, gint64 *elapsed_us)
+{
+    pcmk_scheduler_t *scheduler = pe_new_working_set();
+    gint64 start = g_get_monotonic_time();
+    char *digest = NULL;
+
+    pcmk__mem_assert(scheduler);
+    scheduler->priv->out = logger_out;
+
+    // Unpack status first so that our fixed "now" is used
+    scheduler->input = pcmk__xml_copy(NULL, (xmlNode *) cib);
+    scheduler->priv->now = pcmk__copy_timet(FUZZ_NOW);
+    pcmk__set_scheduler_flags(scheduler, pcmk__sched_no_counts);
+
+    if (cluster_status(scheduler)) {
+        pcmk__schedule_actions(NULL, pcmk__sched_no_counts, scheduler);
+        if (scheduler->priv->graph != NULL) {
+            digest = pcmk__digest_xml(scheduler->priv->graph, false);
+        }
+    }
+
+    *elapsed_us = g_get_monotonic_time() - start;
+    pe_free_working_set(scheduler);
+    return digest;
+}
+
+/*!
+ * \internal
+ * \brief Check whether scheduling a CIB gives different results across runs
+ *
+ * \param[in] cib  CIB to check
+ *
+ * \return true if two runs produced different transition graphs
+ */
+static bool
+is_nondeterministic(const xmlNode *cib)
+{
+    gint64 elapsed_us = 0;
+    char *digest1 = schedule(cib, &elapsed_us);
+    char *digest2 = schedule(cib, &elapsed_us);
+    bool differ = !pcmk__str_eq(digest1, digest2, pcmk__str_null_matches);
+
+    free(digest1);
+    free(digest2);
+    return differ;
+}
+
+/*!
+ * \internal
+ * \brief Check whether scheduling a CIB is slower than allowed
+ *
+ * \param[in] cib       CIB to check
+ * \param[in] limit_us  Maximum allowed scheduling time (microseconds)
+ *
+ * \return true if scheduling \p cib took longer than \p limit_us
+ */
+static bool
+is_slow(const xmlNode *cib, gint64 limit_us)
+{
+    gint64 elapsed_us = 0;
+
+    free(schedule(cib, &elapsed_us));
+    return elapsed_us > limit_us;
+}
+
+/*!
+ * \internal
+ * \brief Remove elements from a CIB that aren't needed to reproduce a problem
+ *
+ * Try removing each element below the top-level sections (starting from the
+ * end, so constraints and histories go before the resources they reference),
+ * keeping the removal only if the problem still occurs.
+ *
+ * \param[in,out] cib       CIB to minimize
+ * \param[in]     problem   Problem to preserve
+ * \param[in]     limit_us  For \c fuzz_superlinear, scheduling time to exceed
+ */
+static void
+minimize(xmlNode *cib, enum fuzz_problem problem, gint64 limit_us)
+{
+    GPtrArray *candidates = g_ptr_array_new();
+
+    // Collect elements at least two levels below the sections
+    for (xmlNode *section = pcmk__xe_first_child(cib, NULL, NULL, NULL);
+         section != NULL; section = pcmk__xe_next(section, NULL)) {
+
+        for (xmlNode *child = pcmk__xe_first_child(section, NULL, NULL, NULL);
+             child != NULL; child = pcmk__xe_next(child, NULL)) {
+
+            for (xmlNode *xml = pcmk__xe_first_child(child, NULL, NULL, NULL);
+                 xml != NULL; xml = pcmk__xe_next(xml, NULL)) {
+
+                g_ptr_array_add(candidates, xml);
+            }
+        }
+    }
+
+    for (guint i = candidates->len; i > 0; i--) {
+        xmlNode *xml = g_ptr_array_index(candidates, i - 1);
+        xmlNode *parent = xml->parent;
+        xmlNode *next = xml->next;
+        bool still = false;
+
+        xmlUnlinkNode(xml);
+        if (problem == fuzz_nondeterministic) {
+            still = is_nondeterministic(cib);
+        } else {
+            still = is_slow(cib, limit_us);
+        }
+
+        if (still) {
+            pcmk__xml_free(xml);
+        } else if (next != NULL) {
+            xmlAddPrevSibling(next, xml);
+        } else {
+            xmlAddChild(parent, xml);
+        }
+    }
+    g_ptr_array_free(candidates, TRUE);
+}
+
+/*!
+ * \internal
+ * \brief Save a CIB as a scheduler regression test input, if requested
+ *
+ * \param[in] cib  CIB to save
+ */
+static void
+save_fixture(const xmlNode *cib)
+{
+    const char *dir = getenv(FIXTURE_DIR_ENV);
+    char *digest = NULL;
+    char *filename = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (pcmk__str_empty(dir)) {
+        return;
+    }
+
+    digest = pcmk__digest_xml((xmlNode *) cib, false);
+    filename = crm_strdup_printf("%s/fuzz-%.8s.xml", dir, digest);
+    rc = pcmk__xml_write_file(cib, filename, false);
+    if (rc == pcmk_rc_ok) {
+        fprintf(stderr, "Saved scheduler input as %s\n", filename);
+    } else {
+        fprintf(stderr, "Could not save scheduler input as %s: %s\n",
+                filename, pcmk_rc_str(rc));
+    }
+    free(digest);
+    free(filename);
+}
+
+/*!
+ * \internal
+ * \brief Report a problem input and abort
+ *
+ * \param[in,out] cib       Problem input (will be minimized)
+ * \param[in]     problem   Type of problem
+ * \param[in]     limit_us  For \c fuzz_superlinear, scheduling time exceeded
+ */
+static void
+report(xmlNode *cib, enum fuzz_problem problem, gint64 limit_us)
+{
+    if (problem == fuzz_nondeterministic) {
+        fprintf(stderr, "Scheduler results differ between runs\n");
+    } else {
+        fprintf(stderr,
+                "Scheduler runtime grows superlinearly with input size "
+                "(over %lldus for %d copies)\n",
+                (long long) limit_us, SCALE_COPIES);
+    }
+    if (!pcmk__str_empty(getenv(FIXTURE_DIR_ENV))) {
+        minimize(cib, problem, limit_us);
+        save_fixture(cib);
+    }
+    abort();
+}
+
+int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    xmlNode *cib = NULL;
+    gint64 elapsed_us = 0;
+    char *digest1 = NULL;
+    char *digest2 = NULL;
+
+    // Have at least enough data for some resources
+    if (size < 8) {
+        return -1; // Do not add input to testing corpus
+    }
+
+    if (logger_out == NULL) {
+        pcmk__assert(pcmk__log_output_new(&logger_out) == pcmk_rc_ok);
+        pe__register_messages(logger_out);
+        pcmk__register_lib_messages(logger_out);
+    }
+
+    cib = generate_cib(data, size, 1);
+    save_fixture(cib);
+
+    digest1 = schedule(cib, &elapsed_us);
+    digest2 = schedule(cib, &elapsed_us);
+    if (!pcmk__str_eq(digest1, digest2, pcmk__str_null_matches)) {
+        report(cib, fuzz_nondeterministic, 0);
+    }
+    free(digest1);
+    free(digest2);
+
+    if (elapsed_us >= SCALE_MIN_US) {
+        gint64 limit_us = elapsed_us * SCALE_COPIES * SCALE_TOLERANCE;
+
+        pcmk__xml_free(cib);
+        cib = generate_cib(data, size, SCALE_COPIES);
+        limit_us = QB_MAX(limit_us, SCALE_FLOOR_US);
+        if (is_slow(cib, limit_us)) {
+            report(cib, fuzz_superlinear, limit_us);
+        }
+    }
+
+    pcmk__xml_free(cib);
+    return 0;
+}
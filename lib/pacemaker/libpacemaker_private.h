@@ -1051,6 +1051,10 @@ bool pcmk__assign_resource(pcmk_resource_t *rsc, pcmk_node_t *node, bool force,
 G_GNUC_INTERNAL
 void pcmk__unassign_resource(pcmk_resource_t *rsc);
 
+G_GNUC_INTERNAL
+void pcmk__track_assigned_resource(pcmk__node_private_t *node_priv,
+                                   pcmk_resource_t *rsc, bool assigned);
+
 G_GNUC_INTERNAL
 bool pcmk__threshold_reached(pcmk_resource_t *rsc, const pcmk_node_t *node,
                              pcmk_resource_t **failed);
@@ -1065,6 +1069,16 @@ G_GNUC_INTERNAL
 gint pcmk__cmp_instance_number(gconstpointer a, gconstpointer b);
 
 
+// Parallel assignment of independent resources (pcmk_sched_components.c)
+
+G_GNUC_INTERNAL
+bool pcmk__assign_components(pcmk_scheduler_t *scheduler);
+
+G_GNUC_INTERNAL
+bool pcmk__defer_assignment_tracking(pcmk__node_private_t *node_priv,
+                                     pcmk_resource_t *rsc, bool assigned);
+
+
 // Functions related to probes (pcmk_sched_probes.c)
 
 G_GNUC_INTERNAL
@@ -1110,6 +1124,9 @@ void pcmk__release_node_capacity(GHashTable *current_utilization,
 G_GNUC_INTERNAL
 const pcmk_node_t *pcmk__ban_insufficient_capacity(pcmk_resource_t *rsc);
 
+G_GNUC_INTERNAL
+GHashTable *pcmk__plan_packed_placement(pcmk_scheduler_t *scheduler);
+
 G_GNUC_INTERNAL
 void pcmk__create_utilization_constraints(pcmk_resource_t *rsc,
                                           const GList *allowed_nodes);
@@ -9,6 +9,9 @@
 
 #include <crm_internal.h>
 
+#include <stdlib.h>             // free()
+#include <string.h>             // strchr(), strndup()
+
 #include <libxml/tree.h>        // xmlNode
 
 #include <pacemaker.h>
@@ -900,3 +903,253 @@ pcmk_list_nodes(xmlNodePtr *xml, const char *node_types)
     pcmk__xml_output_finish(out, pcmk_rc2exitc(rc), xml);
     return rc;
 }
+
+// Add a trace filter action given as "TYPE:NAME" to a log control request
+static int
+add_trace_filter(pcmk__output_t *out, xmlNode *request, const char *action,
+                 const char *spec)
+{
+    const char *colon = strchr(spec, ':');
+    char *type_s = NULL;
+    enum pcmk__log_filter_type type = pcmk__log_filter_function;
+    xmlNode *filter = NULL;
+
+    if ((colon == NULL) || (colon[1] == '\0')) {
+        out->err(out, "error: Trace filter '%s' is not of the form TYPE:NAME",
+                 spec);
+        return pcmk_rc_bad_input;
+    }
+
+    type_s = strndup(spec, colon - spec);
+    if (pcmk__parse_log_filter_type(type_s, &type) != pcmk_rc_ok) {
+        out->err(out, "error: Trace filter type '%s' is not one of function, "
+                 "file, format, or tag", type_s);
+        free(type_s);
+        return pcmk_rc_bad_input;
+    }
+    free(type_s);
+
+    filter = pcmk__xe_create(request, PCMK__XE_LOG_FILTER);
+    crm_xml_add(filter, PCMK_XA_ACTION, action);
+    crm_xml_add(filter, PCMK_XA_TYPE, pcmk__log_filter_type_text(type));
+    crm_xml_add(filter, PCMK_XA_NAME, colon + 1);
+    return pcmk_rc_ok;
+}
+
+// Daemons contacted when "all" is requested, in start-up order
+static const enum pcmk_ipc_server all_daemons[] = {
+    pcmk_ipc_pacemakerd,
+    pcmk_ipc_based,
+    pcmk_ipc_fenced,
+    pcmk_ipc_execd,
+    pcmk_ipc_attrd,
+    pcmk_ipc_schedulerd,
+    pcmk_ipc_controld,
+};
+
+/*!
+ * \internal
+ * \brief Send a request that every daemon accepts, and show the reply
+ *
+ * \param[in,out] out                 Output object
+ * \param[in]     server              Daemon to send request to
+ * \param[in]     request             Request to send
+ * \param[in]     reply_name          Expected element name of reply
+ * \param[in]     message             Name of output message to show reply with
+ * \param[in]     what                Description of request (for errors)
+ * \param[in]     message_timeout_ms  How long to wait for reply
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+send_common_request(pcmk__output_t *out, enum pcmk_ipc_server server,
+                    const xmlNode *request, const char *reply_name,
+                    const char *message, const char *what,
+                    unsigned int message_timeout_ms)
+{
+    const char *name = pcmk__server_ipc_name(server);
+    crm_ipc_t *ipc = crm_ipc_new(name, 0);
+    xmlNode *reply = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (ipc == NULL) {
+        out->err(out, "error: Could not connect to %s: %s",
+                 pcmk__server_log_name(server), pcmk_rc_str(ENOMEM));
+        return ENOMEM;
+    }
+
+    rc = pcmk__connect_generic_ipc(ipc);
+    if (rc != pcmk_rc_ok) {
+        out->err(out, "error: Could not connect to %s: %s",
+                 pcmk__server_log_name(server), pcmk_rc_str(rc));
+        crm_ipc_destroy(ipc);
+        return rc;
+    }
+
+    rc = crm_ipc_send(ipc, request, crm_ipc_client_response,
+                      (int) message_timeout_ms, &reply);
+    if (rc < 0) {
+        rc = pcmk_legacy2rc(rc);
+        out->err(out, "error: Could not send %s request to %s: %s",
+                 what, pcmk__server_log_name(server), pcmk_rc_str(rc));
+
+    } else if (!pcmk__xe_is(reply, reply_name)) {
+        rc = pcmk_rc_schema_validation;
+        out->err(out, "error: Unexpected reply to %s request from %s",
+                 what, pcmk__server_log_name(server));
+
+    } else {
+        rc = pcmk_rc_ok;
+        crm_element_value_int(reply, PCMK__XA_RC_CODE, &rc);
+        out->message(out, message, name, reply);
+    }
+
+    pcmk__xml_free(reply);
+    crm_ipc_close(ipc);
+    crm_ipc_destroy(ipc);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Change or show the log settings of running daemons
+ *
+ * \param[in,out] out                 Output object
+ * \param[in]     daemon              Name of daemon to contact (for example,
+ *                                    "pacemaker-fenced"), or "all"
+ * \param[in]     log_level           New log level (or NULL to leave as is)
+ * \param[in]     trace               "TYPE:NAME" trace filters to add
+ * \param[in]     untrace             "TYPE:NAME" trace filters to remove
+ * \param[in]     untrace_all         If true, remove all trace filters first
+ * \param[in]     ttl_s               Undo changes after this many seconds (0
+ *                                    to keep them until the daemon exits)
+ * \param[in]     message_timeout_ms  How long to wait for each reply
+ *
+ * \return Standard Pacemaker return code
+ * \note With no changes requested, this shows the current settings.
+ */
+int
+pcmk__log_control(pcmk__output_t *out, const char *daemon,
+                  const char *log_level, const GList *trace,
+                  const GList *untrace, bool untrace_all, guint ttl_s,
+                  unsigned int message_timeout_ms)
+{
+    enum pcmk_ipc_server server = pcmk_ipc_unknown;
+    unsigned int level = 0;
+    xmlNode *request = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (!pcmk__str_eq(daemon, "all", pcmk__str_none)) {
+        server = pcmk__parse_server(daemon);
+        if (server == pcmk_ipc_unknown) {
+            out->err(out, "error: Unknown daemon '%s'", pcmk__s(daemon, ""));
+            return pcmk_rc_bad_input;
+        }
+    }
+
+    if ((log_level != NULL)
+        && (pcmk__parse_log_level(log_level, &level) != pcmk_rc_ok)) {
+        out->err(out, "error: Invalid log level '%s'", log_level);
+        return pcmk_rc_bad_input;
+    }
+
+    request = pcmk__xe_create(NULL, PCMK__XE_LOG_CONTROL);
+    if (log_level != NULL) {
+        crm_xml_add(request, PCMK__XA_LOG_LEVEL, pcmk__log_level_text(level));
+    }
+    if (ttl_s > 0) {
+        crm_xml_add_ll(request, PCMK__XA_TTL, (long long) ttl_s);
+    }
+
+    if (untrace_all) {
+        xmlNode *filter = pcmk__xe_create(request, PCMK__XE_LOG_FILTER);
+
+        crm_xml_add(filter, PCMK_XA_ACTION, "clear");
+    }
+    for (const GList *iter = untrace; iter != NULL; iter = iter->next) {
+        rc = add_trace_filter(out, request, "remove", iter->data);
+        if (rc != pcmk_rc_ok) {
+            goto done;
+        }
+    }
+    for (const GList *iter = trace; iter != NULL; iter = iter->next) {
+        rc = add_trace_filter(out, request, "add", iter->data);
+        if (rc != pcmk_rc_ok) {
+            goto done;
+        }
+    }
+
+    if (server != pcmk_ipc_unknown) {
+        rc = send_common_request(out, server, request, PCMK__XE_LOG_CONTROL,
+                                 "log-control", "log control",
+                                 message_timeout_ms);
+        goto done;
+    }
+
+    for (int i = 0; i < PCMK__NELEM(all_daemons); i++) {
+        int daemon_rc = send_common_request(out, all_daemons[i], request,
+                                            PCMK__XE_LOG_CONTROL,
+                                            "log-control", "log control",
+                                            message_timeout_ms);
+
+        // Report the first failure, but still try the remaining daemons
+        if (rc == pcmk_rc_ok) {
+            rc = daemon_rc;
+        }
+    }
+
+done:
+    pcmk__xml_free(request);
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Show the performance metrics of running daemons
+ *
+ * \param[in,out] out                 Output object
+ * \param[in]     daemon              Name of daemon to contact (for example,
+ *                                    "pacemaker-fenced"), or "all"
+ * \param[in]     message_timeout_ms  How long to wait for each reply
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+pcmk__daemon_metrics(pcmk__output_t *out, const char *daemon,
+                     unsigned int message_timeout_ms)
+{
+    enum pcmk_ipc_server server = pcmk_ipc_unknown;
+    xmlNode *request = NULL;
+    int rc = pcmk_rc_ok;
+
+    if (!pcmk__str_eq(daemon, "all", pcmk__str_none)) {
+        server = pcmk__parse_server(daemon);
+        if (server == pcmk_ipc_unknown) {
+            out->err(out, "error: Unknown daemon '%s'", pcmk__s(daemon, ""));
+            return pcmk_rc_bad_input;
+        }
+    }
+
+    request = pcmk__xe_create(NULL, PCMK__XE_GET_METRICS);
+
+    if (server != pcmk_ipc_unknown) {
+        rc = send_common_request(out, server, request, PCMK_XE_METRICS,
+                                 "daemon-metrics", "metrics",
+                                 message_timeout_ms);
+    } else {
+        for (int i = 0; i < PCMK__NELEM(all_daemons); i++) {
+            int daemon_rc = send_common_request(out, all_daemons[i], request,
+                                                PCMK_XE_METRICS,
+                                                "daemon-metrics", "metrics",
+                                                message_timeout_ms);
+
+            // Report the first failure, but still try the remaining daemons
+            if (rc == pcmk_rc_ok) {
+                rc = daemon_rc;
+            }
+        }
+    }
+
+    pcmk__xml_free(request);
+    return rc;
+}
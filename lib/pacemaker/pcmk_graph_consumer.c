@@ -519,6 +519,176 @@ pcmk__execute_graph(pcmk__graph_t *graph)
 }
 
 
+/*
+ * Functions for batching graph actions
+ */
+
+// Resource actions to be sent to one node in a single message
+struct action_batch {
+    char *node;         // Node whose controller will execute the actions
+    xmlNode *ops;       // PCMK__XE_RSC_OPS with a copy of each action's XML
+    GList *actions;     // Graph actions in batch (in reverse order)
+    guint count;        // Number of actions in batch
+};
+
+struct pcmk__action_batches_s {
+    guint max_actions;                  // Split batches at this many actions
+    pcmk__action_batch_fn_t send_fn;    // Function to send a batch
+    void *user_data;                    // Caller data to pass to send_fn
+    GHashTable *by_node;                // Node name -> struct action_batch
+    GQueue *order;                      // struct action_batch, by first use
+};
+
+static void
+free_action_batch(gpointer data)
+{
+    struct action_batch *batch = data;
+
+    free(batch->node);
+    pcmk__xml_free(batch->ops);
+    g_list_free(batch->actions);
+    free(batch);
+}
+
+/*!
+ * \internal
+ * \brief Send any actions in a batch, leaving the batch empty
+ *
+ * \param[in,out] batches  Batch collection that \p batch is part of
+ * \param[in,out] batch    Batch to send
+ */
+static void
+send_action_batch(pcmk__action_batches_t *batches, struct action_batch *batch)
+{
+    xmlNode *ops = batch->ops;
+    GList *actions = g_list_reverse(batch->actions);
+    guint count = batch->count;
+
+    if (count == 0) {
+        return;
+    }
+
+    // Reset the batch first, in case the send function adds to it
+    batch->ops = pcmk__xe_create(NULL, PCMK__XE_RSC_OPS);
+    batch->actions = NULL;
+    batch->count = 0;
+
+    crm_trace("Sending %u graph action%s to %s in one batch",
+              count, pcmk__plural_s(count), batch->node);
+    batches->send_fn(batch->node, ops, actions, count, batches->user_data);
+
+    pcmk__xml_free(ops);
+    g_list_free(actions);
+}
+
+/*!
+ * \internal
+ * \brief Create a new collection of per-node graph action batches
+ *
+ * \param[in] max_actions  Send a node's batch when it reaches this many
+ *                         actions (0 for no limit)
+ * \param[in] send_fn      Function to call to send a batch
+ * \param[in] user_data    Caller data to pass to \p send_fn
+ *
+ * \return Newly allocated batch collection
+ * \note The caller is responsible for freeing the result using
+ *       \c pcmk__action_batches_free().
+ */
+pcmk__action_batches_t *
+pcmk__action_batches_new(guint max_actions, pcmk__action_batch_fn_t send_fn,
+                         void *user_data)
+{
+    pcmk__action_batches_t *batches = NULL;
+
+    pcmk__assert(send_fn != NULL);
+
+    batches = pcmk__assert_alloc(1, sizeof(pcmk__action_batches_t));
+    batches->max_actions = max_actions;
+    batches->send_fn = send_fn;
+    batches->user_data = user_data;
+    batches->by_node = pcmk__strkey_table(NULL, free_action_batch);
+    batches->order = g_queue_new();
+    return batches;
+}
+
+/*!
+ * \internal
+ * \brief Free a collection of graph action batches without sending them
+ *
+ * \param[in,out] batches  Batch collection to free
+ */
+void
+pcmk__action_batches_free(pcmk__action_batches_t *batches)
+{
+    if (batches != NULL) {
+        g_queue_free(batches->order);
+        g_hash_table_destroy(batches->by_node);
+        free(batches);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Add a graph action to the batch for the node that will execute it
+ *
+ * If the node's batch is already full, it is sent before the action is added,
+ * so that the send function is never called while an action is half set up.
+ *
+ * \param[in,out] batches  Batch collection to add to
+ * \param[in]     node     Name of node whose controller will execute \p action
+ * \param[in,out] action   Graph action to add
+ */
+void
+pcmk__batch_graph_action(pcmk__action_batches_t *batches, const char *node,
+                         pcmk__graph_action_t *action)
+{
+    struct action_batch *batch = NULL;
+
+    pcmk__assert((batches != NULL) && (node != NULL) && (action != NULL));
+
+    batch = g_hash_table_lookup(batches->by_node, node);
+    if (batch == NULL) {
+        batch = pcmk__assert_alloc(1, sizeof(struct action_batch));
+        batch->node = pcmk__str_copy(node);
+        batch->ops = pcmk__xe_create(NULL, PCMK__XE_RSC_OPS);
+        g_hash_table_insert(batches->by_node, batch->node, batch);
+        g_queue_push_tail(batches->order, batch);
+    }
+
+    if ((batches->max_actions > 0) && (batch->count >= batches->max_actions)) {
+        send_action_batch(batches, batch);
+    }
+
+    pcmk__xml_copy(batch->ops, action->xml);
+    batch->actions = g_list_prepend(batch->actions, action);
+    batch->count++;
+}
+
+/*!
+ * \internal
+ * \brief Send all pending graph action batches
+ *
+ * Batches are sent in the order their nodes were first given an action.
+ *
+ * \param[in,out] batches  Batch collection to send (will be empty afterward)
+ */
+void
+pcmk__send_action_batches(pcmk__action_batches_t *batches)
+{
+    struct action_batch *batch = NULL;
+
+    if (batches == NULL) {
+        return;
+    }
+    for (GList *iter = batches->order->head; iter != NULL; iter = iter->next) {
+        send_action_batch(batches, iter->data);
+    }
+    while ((batch = g_queue_pop_head(batches->order)) != NULL) {
+        g_hash_table_remove(batches->by_node, batch->node);
+    }
+}
+
+
 /*
  * Functions for unpacking transition graph XML into structs
  */
@@ -655,10 +825,11 @@ unpack_synapse(pcmk__graph_t *new_graph, const xmlNode *xml_synapse)
             crm_trace("Adding action %d to synapse %d",
                       new_action->id, new_synapse->id);
             new_graph->num_actions++;
-            new_synapse->actions = g_list_append(new_synapse->actions,
-                                                 new_action);
+            new_synapse->actions = g_list_prepend(new_synapse->actions,
+                                                  new_action);
         }
     }
+    new_synapse->actions = g_list_reverse(new_synapse->actions);
 
     crm_trace("Unpacking synapse %s inputs", pcmk__xe_id(xml_synapse));
 
@@ -685,11 +856,12 @@ unpack_synapse(pcmk__graph_t *new_graph, const xmlNode *xml_synapse)
                 crm_trace("Adding input %d to synapse %d",
                            new_input->id, new_synapse->id);
 
-                new_synapse->inputs = g_list_append(new_synapse->inputs,
-                                                    new_input);
+                new_synapse->inputs = g_list_prepend(new_synapse->inputs,
+                                                     new_input);
             }
         }
     }
+    new_synapse->inputs = g_list_reverse(new_synapse->inputs);
 
     return new_synapse;
 }
@@ -779,7 +951,10 @@ pcmk__unpack_graph(const xmlNode *xml_graph, const char *reference)
         }
     }
 
-    // Unpack each child <synapse> element
+    /* Unpack each child <synapse> element. Graphs can be very large, so build
+     * the list in reverse and fix the order afterward, rather than walking the
+     * whole list to append each synapse.
+     */
     for (const xmlNode *synapse_xml = pcmk__xe_first_child(xml_graph,
                                                            PCMK__XE_SYNAPSE,
                                                            NULL, NULL);
@@ -790,10 +965,11 @@ pcmk__unpack_graph(const xmlNode *xml_graph, const char *reference)
                                                             synapse_xml);
 
         if (new_synapse != NULL) {
-            new_graph->synapses = g_list_append(new_graph->synapses,
-                                                new_synapse);
+            new_graph->synapses = g_list_prepend(new_graph->synapses,
+                                                 new_synapse);
         }
     }
+    new_graph->synapses = g_list_reverse(new_graph->synapses);
 
     crm_debug("Unpacked transition %d from %s: %d actions in %d synapses",
               new_graph->id, new_graph->source, new_graph->num_actions,
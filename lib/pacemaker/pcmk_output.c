@@ -850,6 +850,137 @@ pacemakerd_health_xml(pcmk__output_t *out, va_list args)
     return pcmk_rc_ok;
 }
 
+PCMK__OUTPUT_ARGS("log-control", "const char *", "const xmlNode *")
+static int
+log_control_default(pcmk__output_t *out, va_list args)
+{
+    const char *daemon = va_arg(args, const char *);
+    const xmlNode *reply = va_arg(args, const xmlNode *);
+
+    const char *ttl = crm_element_value(reply, PCMK__XA_TTL);
+    const char *reason = crm_element_value(reply, PCMK_XA_REASON);
+    int rc = pcmk_rc_ok;
+
+    crm_element_value_int(reply, PCMK__XA_RC_CODE, &rc);
+    if (rc != pcmk_rc_ok) {
+        out->err(out, "%s: %s", daemon, pcmk__s(reason, pcmk_rc_str(rc)));
+    }
+
+    out->info(out, "%s: log level %s%s%s%s", daemon,
+              pcmk__s(crm_element_value(reply, PCMK__XA_LOG_LEVEL), "unknown"),
+              ((ttl == NULL)? "" : " (for "), pcmk__s(ttl, ""),
+              ((ttl == NULL)? "" : "s)"));
+
+    for (const xmlNode *filter = pcmk__xe_first_child(reply,
+                                                      PCMK__XE_LOG_FILTER,
+                                                      NULL, NULL);
+         filter != NULL; filter = pcmk__xe_next(filter, PCMK__XE_LOG_FILTER)) {
+
+        ttl = crm_element_value(filter, PCMK__XA_TTL);
+        out->info(out, "%s: tracing %s %s%s%s%s", daemon,
+                  crm_element_value(filter, PCMK_XA_TYPE),
+                  crm_element_value(filter, PCMK_XA_NAME),
+                  ((ttl == NULL)? "" : " (for "), pcmk__s(ttl, ""),
+                  ((ttl == NULL)? "" : "s)"));
+    }
+    return pcmk_rc_ok;
+}
+
+PCMK__OUTPUT_ARGS("log-control", "const char *", "const xmlNode *")
+static int
+log_control_xml(pcmk__output_t *out, va_list args)
+{
+    const char *daemon = va_arg(args, const char *);
+    const xmlNode *reply = va_arg(args, const xmlNode *);
+
+    int rc = pcmk_rc_ok;
+    char *rc_s = NULL;
+    xmlNode *node = NULL;
+
+    crm_element_value_int(reply, PCMK__XA_RC_CODE, &rc);
+    rc_s = pcmk__itoa(pcmk_rc2exitc(rc));
+
+    node = pcmk__output_create_xml_node(out, PCMK_XE_LOG_CONTROL,
+                                        PCMK_XA_NAME, daemon,
+                                        PCMK_XA_RC, rc_s,
+                                        PCMK_XA_REASON,
+                                        crm_element_value(reply,
+                                                          PCMK_XA_REASON),
+                                        PCMK_XA_LOG_LEVEL,
+                                        crm_element_value(reply,
+                                                          PCMK__XA_LOG_LEVEL),
+                                        PCMK_XA_EXPIRES_IN,
+                                        crm_element_value(reply,
+                                                          PCMK__XA_TTL),
+                                        NULL);
+    free(rc_s);
+
+    for (const xmlNode *filter = pcmk__xe_first_child(reply,
+                                                      PCMK__XE_LOG_FILTER,
+                                                      NULL, NULL);
+         filter != NULL; filter = pcmk__xe_next(filter, PCMK__XE_LOG_FILTER)) {
+
+        xmlNode *child = pcmk__xe_create(node, PCMK_XE_TRACE_FILTER);
+
+        crm_xml_add(child, PCMK_XA_TYPE,
+                    crm_element_value(filter, PCMK_XA_TYPE));
+        crm_xml_add(child, PCMK_XA_NAME,
+                    crm_element_value(filter, PCMK_XA_NAME));
+        crm_xml_add(child, PCMK_XA_EXPIRES_IN,
+                    crm_element_value(filter, PCMK__XA_TTL));
+    }
+    return pcmk_rc_ok;
+}
+
+PCMK__OUTPUT_ARGS("daemon-metrics", "const char *", "const xmlNode *")
+static int
+daemon_metrics_default(pcmk__output_t *out, va_list args)
+{
+    const char *daemon = va_arg(args, const char *);
+    const xmlNode *reply = va_arg(args, const xmlNode *);
+
+    for (const xmlNode *metric = pcmk__xe_first_child(reply, PCMK_XE_METRIC,
+                                                      NULL, NULL);
+         metric != NULL; metric = pcmk__xe_next(metric, PCMK_XE_METRIC)) {
+
+        const char *name = crm_element_value(metric, PCMK_XA_NAME);
+
+        if (crm_element_value(metric, PCMK_XA_VALUE) != NULL) {
+            out->info(out, "%s: %s %s", daemon, name,
+                      crm_element_value(metric, PCMK_XA_VALUE));
+            continue;
+        }
+        out->info(out, "%s: %s count=%s p50=%s p90=%s p99=%s max=%s", daemon,
+                  name,
+                  pcmk__s(crm_element_value(metric, PCMK_XA_COUNT), "0"),
+                  pcmk__s(crm_element_value(metric, PCMK_XA_P50), "0"),
+                  pcmk__s(crm_element_value(metric, PCMK_XA_P90), "0"),
+                  pcmk__s(crm_element_value(metric, PCMK_XA_P99), "0"),
+                  pcmk__s(crm_element_value(metric, PCMK_XA_MAX), "0"));
+    }
+    return pcmk_rc_ok;
+}
+
+PCMK__OUTPUT_ARGS("daemon-metrics", "const char *", "const xmlNode *")
+static int
+daemon_metrics_xml(pcmk__output_t *out, va_list args)
+{
+    const char *daemon = va_arg(args, const char *);
+    const xmlNode *reply = va_arg(args, const xmlNode *);
+
+    xmlNode *node = pcmk__output_create_xml_node(out, PCMK_XE_METRICS,
+                                                 PCMK_XA_NAME, daemon,
+                                                 NULL);
+
+    for (const xmlNode *metric = pcmk__xe_first_child(reply, PCMK_XE_METRIC,
+                                                      NULL, NULL);
+         metric != NULL; metric = pcmk__xe_next(metric, PCMK_XE_METRIC)) {
+
+        pcmk__xml_copy(node, (xmlNode *) metric);
+    }
+    return pcmk_rc_ok;
+}
+
 PCMK__OUTPUT_ARGS("profile", "const char *", "clock_t", "clock_t")
 static int
 profile_default(pcmk__output_t *out, va_list args) {
@@ -2643,6 +2774,8 @@ static pcmk__message_entry_t fmt_functions[] = {
     { "crmadmin-node", "default", crmadmin_node },
     { "crmadmin-node", "text", crmadmin_node_text },
     { "crmadmin-node", "xml", crmadmin_node_xml },
+    { "daemon-metrics", "default", daemon_metrics_default },
+    { "daemon-metrics", "xml", daemon_metrics_xml },
     { "dc", "default", dc },
     { "dc", "text", dc_text },
     { "dc", "xml", dc_xml },
@@ -2673,6 +2806,8 @@ static pcmk__message_entry_t fmt_functions[] = {
     { "locations-and-colocations", "xml", locations_and_colocations_xml },
     { "locations-list", "default", locations_list },
     { "locations-list", "xml", locations_list_xml },
+    { "log-control", "default", log_control_default },
+    { "log-control", "xml", log_control_xml },
     { "node-action", "default", node_action },
     { "node-action", "xml", node_action_xml },
     { "node-info", "default", node_info_default },
@@ -1259,6 +1259,26 @@ pcmk__create_history_xml(xmlNode *parent, lrmd_event_data_t *op,
         crm_xml_add_int(xml_op, PCMK_XA_QUEUE_TIME, op->queue_time);
     }
 
+    /* Resource usage is recorded only when the executor reported it. Record
+     * all values together in that case, so that a history entry updated in
+     * place doesn't keep stale values from a previous run.
+     */
+    if ((op->cpu_user_time > 0) || (op->cpu_system_time > 0)
+        || (op->max_rss > 0) || (op->blocks_in > 0) || (op->blocks_out > 0)) {
+
+        crm_trace("Resource usage (" PCMK__OP_FMT "): user=%ums system=%ums "
+                  "max-rss=%uKiB in=%u out=%u",
+                  op->rsc_id, op->op_type, op->interval_ms, op->cpu_user_time,
+                  op->cpu_system_time, op->max_rss, op->blocks_in,
+                  op->blocks_out);
+
+        crm_xml_add_ll(xml_op, PCMK_XA_CPU_USER_TIME, op->cpu_user_time);
+        crm_xml_add_ll(xml_op, PCMK_XA_CPU_SYSTEM_TIME, op->cpu_system_time);
+        crm_xml_add_ll(xml_op, PCMK_XA_MAX_RSS, op->max_rss);
+        crm_xml_add_ll(xml_op, PCMK_XA_BLOCKS_IN, op->blocks_in);
+        crm_xml_add_ll(xml_op, PCMK_XA_BLOCKS_OUT, op->blocks_out);
+    }
+
     if (pcmk__str_any_of(op->op_type, PCMK_ACTION_MIGRATE_TO,
                          PCMK_ACTION_MIGRATE_FROM, NULL)) {
         /* Record PCMK__META_MIGRATE_SOURCE and PCMK__META_MIGRATE_TARGET always
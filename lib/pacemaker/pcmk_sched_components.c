@@ -0,0 +1,746 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <stdarg.h>                 // va_list, va_start(), va_arg(), etc.
+#include <stdbool.h>                // bool, true, false
+#include <stdio.h>                  // vasprintf()
+
+#include <glib.h>                   // GThreadPool, GPrivate, etc.
+
+#include <crm/common/output_internal.h>
+#include <pacemaker-internal.h>
+
+#include "libpacemaker_private.h"
+
+/* Resources that share no colocations, utilization, or Pacemaker Remote nodes
+ * can be assigned independently of each other. With the "minimal" placement
+ * strategy, nodes are compared only by score (and name), so the order in which
+ * such independent sets ("components") are assigned does not matter, and each
+ * can be assigned in its own thread. (The other placement strategies compare
+ * the number of resources already assigned to each node, which ties every
+ * resource's placement to every other's.)
+ *
+ * Worker threads must not change data shared between components. Changes to
+ * nodes' lists of assigned resources, any output, and all log messages
+ * (including configuration and scheduler input errors and warnings, whose
+ * flags are shared) are recorded per top-level resource and replayed afterward
+ * in the usual resource order, so the results are identical to a serial
+ * assignment. (Only libqb's callsite lookups are done in the worker threads,
+ * since filtering messages before capturing them avoids formatting every
+ * trace message.)
+ */
+
+// Type of output deferred until after parallel assignment
+enum deferred_kind {
+    deferred_node_score,        // "node-weight" message
+    deferred_promotion_score,   // "promotion-score" message
+    deferred_info,              // Informational message
+    deferred_transient,         // Transient informational message
+    deferred_err,               // Error message
+};
+
+// Output deferred until after parallel assignment
+typedef struct {
+    enum deferred_kind kind;
+    pcmk_resource_t *rsc;       // Resource that score is for
+    pcmk_node_t *node;          // Copy of node (promotion score only)
+    char *comment;              // Description of scores (node score only)
+    char *node_name;            // Name of node (node score only)
+    char *text;                 // Displayable score, or formatted message
+} deferred_output_t;
+
+// Change to a node's assigned resources deferred until after assignment
+typedef struct {
+    pcmk__node_private_t *node_priv;    // Node's shared private data
+    pcmk_resource_t *rsc;               // Resource assigned or unassigned
+    bool assigned;                      // Whether resource was assigned
+} deferred_tracking_t;
+
+// Assignment of one top-level resource
+typedef struct {
+    pcmk_resource_t *rsc;       // Top-level resource to assign
+    guint component;            // Index representing resource's component
+    GList *output;              // Deferred output (deferred_output_t *)
+    GList *tracking;            // Deferred node changes (deferred_tracking_t *)
+    GList *logs;                // Captured log messages
+} rsc_work_t;
+
+// Resource currently being assigned by this thread (NULL in main thread)
+static GPrivate current_work = G_PRIVATE_INIT(NULL);
+
+/*!
+ * \internal
+ * \brief Get the number of threads to use for resource assignment
+ *
+ * \return Value of PCMK_scheduler_assign_threads environment option, or 1 if
+ *         unset or invalid
+ */
+static int
+assign_threads(void)
+{
+    const char *value = pcmk__env_option(PCMK__ENV_SCHEDULER_ASSIGN_THREADS);
+    int threads = 1;
+
+    if ((value != NULL)
+        && (pcmk__scan_min_int(value, &threads, 0) != pcmk_rc_ok)) {
+        crm_warn("Assigning resources serially because PCMK_%s value '%s' is "
+                 "invalid", PCMK__ENV_SCHEDULER_ASSIGN_THREADS, value);
+        threads = 1;
+    }
+    return threads;
+}
+
+/*!
+ * \internal
+ * \brief Find the representative of a component (compressing the path)
+ *
+ * \param[in,out] parents  Union-find parent indexes
+ * \param[in]     i        Index of element to find component for
+ *
+ * \return Index of representative element of \p i's component
+ */
+static guint
+find_component(guint *parents, guint i)
+{
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+/*!
+ * \internal
+ * \brief Merge two components
+ *
+ * The lower index is kept as the representative, so that the result does not
+ * depend on the order in which elements are merged.
+ *
+ * \param[in,out] parents  Union-find parent indexes
+ * \param[in]     i        Index of element in first component
+ * \param[in]     j        Index of element in second component
+ */
+static void
+merge_components(guint *parents, guint i, guint j)
+{
+    i = find_component(parents, i);
+    j = find_component(parents, j);
+
+    if (i < j) {
+        parents[j] = i;
+    } else if (j < i) {
+        parents[i] = j;
+    }
+}
+
+// Data needed while partitioning resources into components
+struct partition_data {
+    guint *parents;             // Union-find parent indexes
+    GHashTable *rsc_indexes;    // Top-level resource -> index + 1
+    GHashTable *node_indexes;   // Node private data -> index + 1
+};
+
+/*!
+ * \internal
+ * \brief Get the union-find index of a resource's top-level resource
+ *
+ * \param[in] data  Partition data
+ * \param[in] rsc   Resource to check
+ *
+ * \return Union-find index of \p rsc's top-level resource
+ */
+static guint
+rsc_index(const struct partition_data *data, const pcmk_resource_t *rsc)
+{
+    const pcmk_resource_t *top = pe__const_top_resource(rsc, true);
+
+    return GPOINTER_TO_UINT(g_hash_table_lookup(data->rsc_indexes, top)) - 1;
+}
+
+/*!
+ * \internal
+ * \brief Merge a node's component with another
+ *
+ * \param[in,out] data   Partition data
+ * \param[in]     index  Union-find index of element to merge with \p node
+ * \param[in]     node   Node to merge
+ */
+static void
+merge_node(struct partition_data *data, guint index, const pcmk_node_t *node)
+{
+    gpointer value = g_hash_table_lookup(data->node_indexes, node->priv);
+
+    if (value != NULL) {
+        merge_components(data->parents, index, GPOINTER_TO_UINT(value) - 1);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether a node is a Pacemaker Remote node brought up late
+ *
+ * Top-level remote connection resources are assigned before the parallel
+ * phase, so only nodes whose connection is part of another resource (such as
+ * a bundle or a resource with a guest node) can change while other resources
+ * are assigned.
+ *
+ * \param[in] node  Node to check
+ *
+ * \return \c true if \p node's connection resource will be assigned in the
+ *         parallel phase, otherwise \c false
+ */
+static bool
+remote_connection_pending(const pcmk_node_t *node)
+{
+    const pcmk_resource_t *connection = node->priv->remote;
+
+    return (connection != NULL)
+           && !pcmk_is_set(pe__const_top_resource(connection, true)->flags,
+                           pcmk__rsc_is_remote_connection);
+}
+
+/*!
+ * \internal
+ * \brief Merge a resource's component with those of nodes it shares
+ *
+ * A resource that uses utilization (or is unmanaged) changes the shared data
+ * of the nodes it may be assigned to, and the availability of a Pacemaker
+ * Remote node depends on the assignment of its connection, so such resources
+ * must be assigned in the same thread as anything else using those nodes.
+ *
+ * \param[in]     rsc   Resource to check (recursively with its children)
+ * \param[in,out] data  Partition data
+ */
+static void
+merge_shared_nodes(const pcmk_resource_t *rsc, struct partition_data *data)
+{
+    bool uses_nodes = (g_hash_table_size(rsc->priv->utilization) > 0)
+                      || !pcmk_is_set(rsc->flags, pcmk__rsc_managed);
+    guint index = rsc_index(data, rsc);
+    GHashTableIter node_iter;
+    const pcmk_node_t *node = NULL;
+
+    g_hash_table_iter_init(&node_iter, rsc->priv->allowed_nodes);
+    while (g_hash_table_iter_next(&node_iter, NULL, (gpointer *) &node)) {
+        if (uses_nodes || remote_connection_pending(node)) {
+            merge_node(data, index, node);
+        }
+    }
+    if (uses_nodes) {
+        for (const GList *iter = rsc->priv->active_nodes;
+             iter != NULL; iter = iter->next) {
+
+            node = iter->data;
+            merge_node(data, index, node);
+        }
+    }
+
+    for (const GList *iter = rsc->priv->children;
+         iter != NULL; iter = iter->next) {
+
+        merge_shared_nodes((const pcmk_resource_t *) iter->data, data);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Partition resources into independently assignable components
+ *
+ * \param[in] scheduler  Scheduler data
+ *
+ * \return Newly allocated list of rsc_work_t for all top-level resources not
+ *         yet assigned, in resource order, with their components set
+ */
+static GList *
+partition_resources(const pcmk_scheduler_t *scheduler)
+{
+    guint n_rscs = g_list_length(scheduler->priv->resources);
+    guint n_nodes = g_list_length(scheduler->nodes);
+    struct partition_data data = {
+        .parents = pcmk__assert_alloc(n_rscs + n_nodes, sizeof(guint)),
+        .rsc_indexes = g_hash_table_new(NULL, NULL),
+        .node_indexes = g_hash_table_new(NULL, NULL),
+    };
+    GList *all_work = NULL;
+    guint i = 0;
+
+    for (const GList *iter = scheduler->priv->resources;
+         iter != NULL; iter = iter->next) {
+
+        data.parents[i] = i;
+        g_hash_table_insert(data.rsc_indexes, iter->data,
+                            GUINT_TO_POINTER(++i));
+    }
+    for (const GList *iter = scheduler->nodes;
+         iter != NULL; iter = iter->next) {
+
+        const pcmk_node_t *node = iter->data;
+
+        data.parents[i] = i;
+        g_hash_table_insert(data.node_indexes, node->priv,
+                            GUINT_TO_POINTER(++i));
+    }
+
+    // Colocated resources (including implicit colocations) depend on each other
+    for (const GList *iter = scheduler->priv->colocation_constraints;
+         iter != NULL; iter = iter->next) {
+
+        const pcmk__colocation_t *colocation = iter->data;
+
+        merge_components(data.parents, rsc_index(&data, colocation->dependent),
+                         rsc_index(&data, colocation->primary));
+    }
+
+    // Remote nodes depend on their connection resources
+    for (const GList *iter = scheduler->nodes;
+         iter != NULL; iter = iter->next) {
+
+        const pcmk_node_t *node = iter->data;
+
+        if (remote_connection_pending(node)) {
+            merge_node(&data, rsc_index(&data, node->priv->remote), node);
+        }
+    }
+
+    for (const GList *iter = scheduler->priv->resources;
+         iter != NULL; iter = iter->next) {
+
+        merge_shared_nodes((const pcmk_resource_t *) iter->data, &data);
+    }
+
+    i = 0;
+    for (const GList *iter = scheduler->priv->resources;
+         iter != NULL; iter = iter->next) {
+
+        pcmk_resource_t *rsc = iter->data;
+        rsc_work_t *work = NULL;
+
+        if (pcmk_is_set(rsc->flags, pcmk__rsc_is_remote_connection)) {
+            i++;
+            continue; // Already assigned
+        }
+
+        work = pcmk__assert_alloc(1, sizeof(rsc_work_t));
+        work->rsc = rsc;
+        work->component = find_component(data.parents, i++);
+        all_work = g_list_prepend(all_work, work);
+    }
+
+    free(data.parents);
+    g_hash_table_destroy(data.rsc_indexes);
+    g_hash_table_destroy(data.node_indexes);
+    return g_list_reverse(all_work);
+}
+
+/*!
+ * \internal
+ * \brief Compare two components by number of top-level resources
+ *
+ * \param[in] a  List of rsc_work_t for first component
+ * \param[in] b  List of rsc_work_t for second component
+ *
+ * \return Negative if \p a is larger, positive if \p b is larger, otherwise 0
+ */
+static gint
+compare_component_sizes(gconstpointer a, gconstpointer b)
+{
+    guint len_a = g_list_length((GList *) a);
+    guint len_b = g_list_length((GList *) b);
+
+    return (len_a > len_b)? -1 : ((len_a < len_b)? 1 : 0);
+}
+
+/*!
+ * \internal
+ * \brief Group resource work by component
+ *
+ * \param[in] all_work  List of rsc_work_t in resource order
+ *
+ * \return Newly allocated list of lists of rsc_work_t (one list per component,
+ *         each in resource order)
+ */
+static GList *
+group_components(GList *all_work)
+{
+    GHashTable *by_component = g_hash_table_new(NULL, NULL);
+    GList *components = NULL;
+
+    // Go backward, so prepending keeps each component in resource order
+    for (GList *iter = g_list_last(all_work); iter != NULL; iter = iter->prev) {
+        rsc_work_t *work = iter->data;
+        gpointer key = GUINT_TO_POINTER(work->component);
+        GList *component = g_hash_table_lookup(by_component, key);
+
+        g_hash_table_insert(by_component, key,
+                            g_list_prepend(component, work));
+    }
+
+    // Largest components first, so they don't end up running last
+    for (GList *iter = all_work; iter != NULL; iter = iter->next) {
+        rsc_work_t *work = iter->data;
+        gpointer key = GUINT_TO_POINTER(work->component);
+        GList *component = g_hash_table_lookup(by_component, key);
+
+        if (component != NULL) {
+            components = g_list_prepend(components, component);
+            g_hash_table_remove(by_component, key);
+        }
+    }
+    g_hash_table_destroy(by_component);
+    return g_list_sort(components, compare_component_sizes);
+}
+
+/*!
+ * \internal
+ * \brief Record output for the current thread's resource
+ *
+ * \param[in] kind  Type of output
+ *
+ * \return Newly allocated deferred output, or NULL if the current thread is
+ *         not assigning resources
+ */
+static deferred_output_t *
+defer_output(enum deferred_kind kind)
+{
+    rsc_work_t *work = g_private_get(&current_work);
+    deferred_output_t *output = NULL;
+
+    if (work == NULL) {
+        return NULL;
+    }
+    output = pcmk__assert_alloc(1, sizeof(deferred_output_t));
+    output->kind = kind;
+    work->output = g_list_prepend(work->output, output);
+    return output;
+}
+
+/*!
+ * \internal
+ * \brief Record score output instead of showing it (during parallel phase)
+ *
+ * \param[in,out] out         Output object (ignored)
+ * \param[in]     message_id  Message to output
+ * \param[in]     ...         Message arguments
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+defer_message(pcmk__output_t *out, const char *message_id, ...)
+{
+    deferred_output_t *output = NULL;
+    va_list args;
+
+    if (pcmk__str_eq(message_id, "node-weight", pcmk__str_none)) {
+        output = defer_output(deferred_node_score);
+    } else if (pcmk__str_eq(message_id, "promotion-score", pcmk__str_none)) {
+        output = defer_output(deferred_promotion_score);
+    }
+    if (output == NULL) {
+        // Nothing else should be output while assigning resources
+        crm_warn("Dropping unexpected '%s' output during parallel resource "
+                 "assignment", message_id);
+        return EINVAL;
+    }
+
+    va_start(args, message_id);
+    output->rsc = va_arg(args, pcmk_resource_t *);
+    if (output->kind == deferred_node_score) {
+        output->comment = pcmk__str_copy(va_arg(args, const char *));
+        output->node_name = pcmk__str_copy(va_arg(args, const char *));
+    } else {
+        const pcmk_node_t *node = va_arg(args, const pcmk_node_t *);
+
+        // The instance may be assigned elsewhere by the time this is shown
+        if (node != NULL) {
+            output->node = pe__copy_node(node);
+        }
+    }
+    output->text = pcmk__str_copy(va_arg(args, const char *));
+    va_end(args);
+    return pcmk_rc_ok;
+}
+
+/*!
+ * \internal
+ * \brief Record formatted text output for the current thread's resource
+ *
+ * \param[in] kind    Type of output
+ * \param[in] format  printf(3)-style format string
+ * \param[in] args    Arguments for \p format
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+defer_text(enum deferred_kind kind, const char *format, va_list args)
+{
+    deferred_output_t *output = defer_output(kind);
+
+    if (output == NULL) {
+        crm_warn("Dropping unexpected output during parallel resource "
+                 "assignment");
+        return EINVAL;
+    }
+    pcmk__assert(vasprintf(&output->text, format, args) >= 0);
+    return pcmk_rc_ok;
+}
+
+G_GNUC_PRINTF(2, 3)
+static int
+defer_info(pcmk__output_t *out, const char *format, ...)
+{
+    va_list args;
+    int rc = pcmk_rc_ok;
+
+    va_start(args, format);
+    rc = defer_text(deferred_info, format, args);
+    va_end(args);
+    return rc;
+}
+
+G_GNUC_PRINTF(2, 3)
+static int
+defer_transient(pcmk__output_t *out, const char *format, ...)
+{
+    va_list args;
+    int rc = pcmk_rc_ok;
+
+    va_start(args, format);
+    rc = defer_text(deferred_transient, format, args);
+    va_end(args);
+    return rc;
+}
+
+G_GNUC_PRINTF(2, 3)
+static void
+defer_err(pcmk__output_t *out, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    defer_text(deferred_err, format, args);
+    va_end(args);
+}
+
+/*!
+ * \internal
+ * \brief Defer a change to a node's assigned resources, if appropriate
+ *
+ * \param[in,out] node_priv  Private data shared by all copies of node
+ * \param[in]     rsc        Resource being added or removed
+ * \param[in]     assigned   If \c true, \p rsc is being added, otherwise removed
+ *
+ * \return \c true if the change was deferred (because the current thread is
+ *         assigning resources in parallel), otherwise \c false
+ */
+bool
+pcmk__defer_assignment_tracking(pcmk__node_private_t *node_priv,
+                                pcmk_resource_t *rsc, bool assigned)
+{
+    rsc_work_t *work = g_private_get(&current_work);
+    deferred_tracking_t *tracking = NULL;
+
+    if (work == NULL) {
+        return false;
+    }
+
+    tracking = pcmk__assert_alloc(1, sizeof(deferred_tracking_t));
+    tracking->node_priv = node_priv;
+    tracking->rsc = rsc;
+    tracking->assigned = assigned;
+    work->tracking = g_list_prepend(work->tracking, tracking);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Assign all resources in a component (as a thread pool function)
+ *
+ * \param[in,out] data       List of rsc_work_t for component, in order
+ * \param[in]     user_data  Ignored
+ */
+static void
+assign_component(gpointer data, gpointer user_data)
+{
+    for (GList *iter = data; iter != NULL; iter = iter->next) {
+        rsc_work_t *work = iter->data;
+
+        g_private_set(&current_work, work);
+        pcmk__capture_logs(&work->logs);
+        pcmk__rsc_trace(work->rsc, "Assigning %s resource '%s'",
+                        work->rsc->priv->xml->name, work->rsc->id);
+        work->rsc->priv->cmds->assign(work->rsc, NULL, true);
+    }
+    pcmk__capture_logs(NULL);
+    g_private_set(&current_work, NULL);
+}
+
+/*!
+ * \internal
+ * \brief Show deferred output
+ *
+ * \param[in,out] out     Output object to use
+ * \param[in]     output  Deferred output to show
+ */
+static void
+show_deferred_output(pcmk__output_t *out, const deferred_output_t *output)
+{
+    switch (output->kind) {
+        case deferred_node_score:
+            out->message(out, "node-weight", output->rsc, output->comment,
+                         output->node_name, output->text);
+            break;
+        case deferred_promotion_score:
+            out->message(out, "promotion-score", output->rsc, output->node,
+                         output->text);
+            break;
+        case deferred_info:
+            out->info(out, "%s", output->text);
+            break;
+        case deferred_transient:
+            out->transient(out, "%s", output->text);
+            break;
+        case deferred_err:
+            out->err(out, "%s", output->text);
+            break;
+    }
+}
+
+static void
+free_deferred_output(gpointer data)
+{
+    deferred_output_t *output = data;
+
+    pcmk__free_node_copy(output->node);
+    free(output->comment);
+    free(output->node_name);
+    free(output->text);
+    free(output);
+}
+
+/*!
+ * \internal
+ * \brief Apply a top-level resource's deferred work and free it
+ *
+ * \param[in,out] work       Work to finish
+ * \param[in,out] scheduler  Scheduler data
+ */
+static void
+finish_work(rsc_work_t *work, pcmk_scheduler_t *scheduler)
+{
+    pcmk__output_t *out = scheduler->priv->out;
+
+    work->tracking = g_list_reverse(work->tracking);
+    for (const GList *iter = work->tracking; iter != NULL; iter = iter->next) {
+        const deferred_tracking_t *tracking = iter->data;
+
+        pcmk__track_assigned_resource(tracking->node_priv, tracking->rsc,
+                                      tracking->assigned);
+    }
+    g_list_free_full(work->tracking, free);
+
+    pcmk__replay_logs(work->logs);
+
+    work->output = g_list_reverse(work->output);
+    for (const GList *iter = work->output; iter != NULL; iter = iter->next) {
+        show_deferred_output(out, (const deferred_output_t *) iter->data);
+    }
+    g_list_free_full(work->output, free_deferred_output);
+
+    free(work);
+}
+
+/*!
+ * \internal
+ * \brief Assign resources other than remote connections in parallel, if useful
+ *
+ * \param[in,out] scheduler  Scheduler data
+ *
+ * \return \c true if resources were assigned, or \c false if the caller should
+ *         assign them serially instead
+ */
+bool
+pcmk__assign_components(pcmk_scheduler_t *scheduler)
+{
+    int threads = 1;
+    GList *all_work = NULL;
+    GList *components = NULL;
+    guint n_components = 0;
+    GThreadPool *pool = NULL;
+    GError *error = NULL;
+    pcmk__output_t *out = scheduler->priv->out;
+    pcmk__output_t deferring_out;
+
+    if (!pcmk__str_eq(scheduler->priv->placement_strategy, PCMK_VALUE_MINIMAL,
+                      pcmk__str_casei)
+        || pcmk_is_set(scheduler->flags, pcmk__sched_show_utilization)
+
+        /* If fencing is enabled without a device, every resource will be
+         * unmanaged and stay on its current node
+         */
+        || (pcmk_is_set(scheduler->flags, pcmk__sched_fencing_enabled)
+            && !pcmk_is_set(scheduler->flags, pcmk__sched_have_fencing))) {
+        return false;
+    }
+
+    threads = assign_threads();
+    if (threads <= 1) {
+        return false;
+    }
+
+    all_work = partition_resources(scheduler);
+    components = group_components(all_work);
+    n_components = g_list_length(components);
+    if (n_components <= 1) {
+        g_list_free_full(components, (GDestroyNotify) g_list_free);
+        g_list_free_full(all_work, free);
+        return false;
+    }
+
+    threads = QB_MIN(threads, (int) n_components);
+    pool = g_thread_pool_new(assign_component, NULL, threads, TRUE, &error);
+    if (pool == NULL) {
+        crm_warn("Assigning resources serially because threads could not be "
+                 "created: %s", error->message);
+        g_clear_error(&error);
+        g_list_free_full(components, (GDestroyNotify) g_list_free);
+        g_list_free_full(all_work, free);
+        return false;
+    }
+
+    crm_debug("Assigning %u independent sets of resources using %d threads",
+              n_components, threads);
+
+    // Output must not be interleaved, so record it instead
+    if (out != NULL) {
+        deferring_out = *out;
+        deferring_out.message = defer_message;
+        deferring_out.info = defer_info;
+        deferring_out.transient = defer_transient;
+        deferring_out.err = defer_err;
+        scheduler->priv->out = &deferring_out;
+    }
+
+    for (GList *iter = components; iter != NULL; iter = iter->next) {
+        g_thread_pool_push(pool, iter->data, NULL);
+    }
+
+    // Wait for all components to be assigned
+    g_thread_pool_free(pool, FALSE, TRUE);
+    scheduler->priv->out = out;
+
+    // Finish in resource order, as if resources had been assigned serially
+    for (GList *iter = all_work; iter != NULL; iter = iter->next) {
+        finish_work(iter->data, scheduler);
+    }
+    g_list_free(all_work);
+    g_list_free_full(components, (GDestroyNotify) g_list_free);
+    return true;
+}
@@ -364,16 +364,31 @@ pcmk__output_resource_actions(pcmk_resource_t *rsc)
 
 /*!
  * \internal
- * \brief Add a resource to a node's list of assigned resources
+ * \brief Add a resource to or remove it from a node's assigned resources
  *
- * \param[in,out] node  Node to add resource to
- * \param[in]     rsc   Resource to add
+ * \param[in,out] node_priv  Private data shared by all copies of node
+ * \param[in]     rsc        Resource to add or remove
+ * \param[in]     assigned   If \c true, add \p rsc, otherwise remove it
+ *
+ * \note During parallel assignment, the update is deferred until the resource's
+ *       component has been assigned, because the node data is shared.
  */
-static inline void
-add_assigned_resource(pcmk_node_t *node, pcmk_resource_t *rsc)
+void
+pcmk__track_assigned_resource(pcmk__node_private_t *node_priv,
+                              pcmk_resource_t *rsc, bool assigned)
 {
-    node->priv->assigned_resources =
-        g_list_prepend(node->priv->assigned_resources, rsc);
+    if (pcmk__defer_assignment_tracking(node_priv, rsc, assigned)) {
+        return;
+    }
+    if (assigned) {
+        node_priv->assigned_resources =
+            g_list_prepend(node_priv->assigned_resources, rsc);
+        node_priv->num_resources++;
+    } else {
+        node_priv->assigned_resources =
+            g_list_remove(node_priv->assigned_resources, rsc);
+        node_priv->num_resources--;
+    }
 }
 
 /*!
@@ -515,8 +530,7 @@ pcmk__assign_resource(pcmk_resource_t *rsc, pcmk_node_t *node, bool force,
     pcmk__rsc_debug(rsc, "Assigning %s to %s", rsc->id, pcmk__node_name(node));
     rsc->priv->assigned_node = pe__copy_node(node);
 
-    add_assigned_resource(node, rsc);
-    node->priv->num_resources++;
+    pcmk__track_assigned_resource(node->priv, rsc, true);
     node->assign->count++;
     pcmk__consume_node_capacity(node->priv->utilization, rsc);
 
@@ -561,9 +575,7 @@ pcmk__unassign_resource(pcmk_resource_t *rsc)
         /* We're going to free the pcmk_node_t copy, but its priv member is
          * shared and will remain, so update that appropriately first.
          */
-        old->priv->assigned_resources =
-            g_list_remove(old->priv->assigned_resources, rsc);
-        old->priv->num_resources--;
+        pcmk__track_assigned_resource(old->priv, rsc, false);
         pcmk__release_node_capacity(old->priv->utilization, rsc);
         pcmk__free_node_copy(old);
         return;
@@ -392,6 +392,670 @@ pcmk__ban_insufficient_capacity(pcmk_resource_t *rsc)
     return most_capable_node;
 }
 
+
+/*
+ * Functions for planning a packed placement
+ */
+
+// A node that resources may be packed onto
+typedef struct {
+    pcmk_node_t *node;
+    int *free;                      // Free capacity, indexed by attribute
+} packed_bin_t;
+
+// A resource to be packed onto a node
+typedef struct {
+    pcmk_resource_t *rsc;
+    int *need;                      // Required capacity, indexed by attribute
+    double size;                    // Sum of shares of total cluster capacity
+    GList *bins;                    // Best-scored bins (packed_bin_t *)
+    packed_bin_t *current;          // Bin resource is active on, if any
+    packed_bin_t *planned;          // Bin resource is planned for, if any
+    GHashTable *utilization;        // Requirements by name (until indexed)
+} packed_item_t;
+
+struct packing_data {
+    GHashTable *attrs;              // Attribute name -> index + 1
+    double *total;                  // Total capacity, indexed by attribute
+    GPtrArray *bins;                // packed_bin_t *
+    GPtrArray *items;               // packed_item_t *
+    int search_steps;               // Relocations left to consider in search
+    bool exhausted;                 // Whether search ran out of steps
+};
+
+/*!
+ * \internal
+ * \brief Assign an index to each utilization attribute name in a table
+ *
+ * \param[in]     key        Utilization attribute name
+ * \param[in]     value      Ignored
+ * \param[in,out] user_data  Table of attribute indexes
+ */
+static void
+index_attribute(gpointer key, gpointer value, gpointer user_data)
+{
+    GHashTable *attrs = user_data;
+
+    if (!g_hash_table_contains(attrs, key)) {
+        guint attr_index = g_hash_table_size(attrs) + 1;
+
+        g_hash_table_insert(attrs, pcmk__str_copy(key),
+                            GUINT_TO_POINTER(attr_index));
+    }
+}
+
+/*!
+ * \internal
+ * \brief Convert a table of utilization values to an attribute-indexed array
+ *
+ * \param[in] data         Packing data
+ * \param[in] utilization  Utilization values to convert
+ *
+ * \return Newly allocated array with a value for each indexed attribute
+ * \note The caller is responsible for freeing the result with \c free().
+ */
+static int *
+utilization_array(const struct packing_data *data, GHashTable *utilization)
+{
+    GHashTableIter iter;
+    gpointer key = NULL;
+    gpointer attr_index = NULL;
+    int *values = pcmk__assert_alloc(QB_MAX(g_hash_table_size(data->attrs), 1),
+                                     sizeof(int));
+
+    g_hash_table_iter_init(&iter, data->attrs);
+    while (g_hash_table_iter_next(&iter, &key, &attr_index)) {
+        values[GPOINTER_TO_UINT(attr_index) - 1] =
+            utilization_value(g_hash_table_lookup(utilization, key));
+    }
+    return values;
+}
+
+/*!
+ * \internal
+ * \brief Add the utilization of a resource and its descendants to a table
+ *
+ * \param[in]     rsc          Resource with utilization to add
+ * \param[in,out] utilization  Table of utilization values to add to
+ */
+static void
+add_tree_utilization(const pcmk_resource_t *rsc, GHashTable *utilization)
+{
+    pcmk__release_node_capacity(utilization, rsc);
+    for (const GList *iter = rsc->priv->children;
+         iter != NULL; iter = iter->next) {
+        add_tree_utilization((const pcmk_resource_t *) iter->data,
+                             utilization);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Get the bin for a node
+ *
+ * \param[in] data  Packing data
+ * \param[in] node  Node to find bin for
+ *
+ * \return Bin for \p node, or \c NULL if \p node is not a bin
+ */
+static packed_bin_t *
+find_bin(const struct packing_data *data, const pcmk_node_t *node)
+{
+    if (node != NULL) {
+        for (guint i = 0; i < data->bins->len; i++) {
+            packed_bin_t *bin = g_ptr_array_index(data->bins, i);
+
+            if (pcmk__same_node(bin->node, node)) {
+                return bin;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Create a packing item for a resource if it can be packed
+ *
+ * Only top-level primitives and groups that still need to be assigned and have
+ * utilization requirements are packed. Each is limited to the available nodes
+ * where it has its highest score, so that constraints and stickiness always
+ * take precedence over packing.
+ *
+ * \param[in,out] data  Packing data
+ * \param[in]     rsc   Resource to check
+ *
+ * \return Newly allocated item for \p rsc, or \c NULL if \p rsc can't be packed
+ */
+static packed_item_t *
+new_packed_item(struct packing_data *data, pcmk_resource_t *rsc)
+{
+    GHashTable *utilization = NULL;
+    packed_item_t *item = NULL;
+    int best_score = -PCMK_SCORE_INFINITY;
+
+    if ((!pcmk__is_primitive(rsc) && !pcmk__is_group(rsc))
+        || !pcmk_is_set(rsc->flags, pcmk__rsc_unassigned)
+        || !pcmk_is_set(rsc->flags, pcmk__rsc_managed)
+        || pcmk_any_flags_set(rsc->flags, pcmk__rsc_blocked
+                                          |pcmk__rsc_is_remote_connection)) {
+        return NULL;
+    }
+
+    utilization = pcmk__strkey_table(free, free);
+    add_tree_utilization(rsc, utilization);
+    if (g_hash_table_size(utilization) == 0) {
+        g_hash_table_destroy(utilization);
+        return NULL;
+    }
+
+    item = pcmk__assert_alloc(1, sizeof(packed_item_t));
+    item->rsc = rsc;
+    item->current = find_bin(data, pcmk__current_node(rsc));
+
+    for (guint i = 0; i < data->bins->len; i++) {
+        packed_bin_t *bin = g_ptr_array_index(data->bins, i);
+        const pcmk_node_t *allowed = NULL;
+
+        allowed = g_hash_table_lookup(rsc->priv->allowed_nodes,
+                                      bin->node->priv->id);
+        if (!pcmk__node_available(allowed, true, false)
+            || (allowed->assign->score < best_score)) {
+            continue;
+        }
+        if (allowed->assign->score > best_score) {
+            best_score = allowed->assign->score;
+            g_list_free(item->bins);
+            item->bins = NULL;
+        }
+        item->bins = g_list_append(item->bins, bin);
+    }
+
+    if (item->bins == NULL) {
+        g_hash_table_destroy(utilization);
+        free(item);
+        return NULL;
+    }
+
+    // Keep the table until all attribute names are known
+    g_hash_table_foreach(utilization, index_attribute, data->attrs);
+    item->utilization = utilization;
+    return item;
+}
+
+/*!
+ * \internal
+ * \brief Free a packing item
+ *
+ * \param[in,out] data  Item to free
+ */
+static void
+free_packed_item(gpointer data)
+{
+    packed_item_t *item = data;
+
+    g_list_free(item->bins);
+    free(item->need);
+    if (item->utilization != NULL) {
+        g_hash_table_destroy(item->utilization);
+    }
+    free(item);
+}
+
+/*!
+ * \internal
+ * \brief Free a packing bin
+ *
+ * \param[in,out] data  Bin to free
+ */
+static void
+free_packed_bin(gpointer data)
+{
+    packed_bin_t *bin = data;
+
+    free(bin->free);
+    free(bin);
+}
+
+/*!
+ * \internal
+ * \brief Remove capacity used by active resources that won't be packed
+ *
+ * \param[in,out] data  Packing data
+ * \param[in]     rsc   Resource to check (along with its descendants)
+ */
+static void
+reserve_unpacked_capacity(struct packing_data *data,
+                          const pcmk_resource_t *rsc)
+{
+    if (pcmk__is_primitive(rsc)) {
+        packed_bin_t *bin = NULL;
+        int *need = NULL;
+
+        if (!pcmk_is_set(rsc->flags, pcmk__rsc_unassigned)) {
+            return; // Already consumed from the node's capacity
+        }
+        bin = find_bin(data, pcmk__current_node(rsc));
+        if (bin == NULL) {
+            return;
+        }
+        need = utilization_array(data, rsc->priv->utilization);
+        for (guint a = 0; a < g_hash_table_size(data->attrs); a++) {
+            bin->free[a] -= need[a];
+        }
+        free(need);
+        return;
+    }
+
+    for (const GList *iter = rsc->priv->children;
+         iter != NULL; iter = iter->next) {
+        reserve_unpacked_capacity(data,
+                                  (const pcmk_resource_t *) iter->data);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Check whether a bin has enough free capacity for an item
+ *
+ * \param[in] data   Packing data
+ * \param[in] item   Item to check
+ * \param[in] bin    Bin to check
+ * \param[in] extra  If not \c NULL, count this item's capacity as free
+ *
+ * \return \c true if \p item fits in \p bin, otherwise \c false
+ */
+static bool
+item_fits(const struct packing_data *data, const packed_item_t *item,
+          const packed_bin_t *bin, const packed_item_t *extra)
+{
+    for (guint a = 0; a < g_hash_table_size(data->attrs); a++) {
+        long long available = bin->free[a];
+
+        if (extra != NULL) {
+            available += extra->need[a];
+        }
+        if (item->need[a] > available) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Get the free capacity a bin would have left after adding an item
+ *
+ * \param[in] data  Packing data
+ * \param[in] item  Item to add
+ * \param[in] bin   Bin to check
+ *
+ * \return Sum of shares of total cluster capacity left free in \p bin
+ */
+static double
+slack_after(const struct packing_data *data, const packed_item_t *item,
+            const packed_bin_t *bin)
+{
+    double slack = 0.0;
+
+    for (guint a = 0; a < g_hash_table_size(data->attrs); a++) {
+        if (data->total[a] > 0.0) {
+            slack += (bin->free[a] - item->need[a]) / data->total[a];
+        }
+    }
+    return slack;
+}
+
+/*!
+ * \internal
+ * \brief Plan (or unplan) an item in a bin, updating the bin's capacity
+ *
+ * \param[in]     data  Packing data
+ * \param[in,out] item  Item to plan
+ * \param[in,out] bin   Bin to plan \p item in (or \c NULL to unplan it)
+ */
+static void
+plan_item(const struct packing_data *data, packed_item_t *item,
+          packed_bin_t *bin)
+{
+    guint n_attrs = g_hash_table_size(data->attrs);
+
+    if (item->planned != NULL) {
+        for (guint a = 0; a < n_attrs; a++) {
+            item->planned->free[a] += item->need[a];
+        }
+    }
+    item->planned = bin;
+    if (bin != NULL) {
+        for (guint a = 0; a < n_attrs; a++) {
+            bin->free[a] -= item->need[a];
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Sort packing items by decreasing size
+ *
+ * \param[in] a  First item to compare
+ * \param[in] b  Second item to compare
+ *
+ * \return A negative number if \p a should be packed first, a positive number
+ *         if \p b should be packed first, or 0 if they are equal
+ */
+static gint
+cmp_packed_items(gconstpointer a, gconstpointer b)
+{
+    const packed_item_t *item1 = *(packed_item_t * const *) a;
+    const packed_item_t *item2 = *(packed_item_t * const *) b;
+
+    if (item1->size > item2->size) {
+        return -1;
+    }
+    if (item1->size < item2->size) {
+        return 1;
+    }
+    return strcmp(item1->rsc->id, item2->rsc->id);
+}
+
+/*!
+ * \internal
+ * \brief Plan each item in the fitting bin that leaves the least free capacity
+ *
+ * \param[in,out] data  Packing data (with items sorted by decreasing size)
+ */
+static void
+plan_best_fit(struct packing_data *data)
+{
+    for (guint i = 0; i < data->items->len; i++) {
+        packed_item_t *item = g_ptr_array_index(data->items, i);
+        packed_bin_t *best = NULL;
+        double best_slack = 0.0;
+
+        for (GList *iter = item->bins; iter != NULL; iter = iter->next) {
+            packed_bin_t *bin = iter->data;
+            double slack = 0.0;
+
+            if (!item_fits(data, item, bin, NULL)) {
+                continue;
+            }
+
+            // On a tie, prefer the current node, then the first one listed
+            slack = slack_after(data, item, bin);
+            if ((best == NULL) || (slack < best_slack)
+                || ((slack == best_slack) && (bin == item->current))) {
+                best = bin;
+                best_slack = slack;
+            }
+        }
+        plan_item(data, item, best);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Use one step of the search budget for a packed placement
+ *
+ * The budget counts candidate relocations rather than time, so the result is
+ * the same on every run regardless of machine speed or load.
+ *
+ * \param[in,out] data  Packing data
+ *
+ * \return \c true if the search should stop, otherwise \c false
+ */
+static bool
+out_of_steps(struct packing_data *data)
+{
+    if (!data->exhausted && (data->search_steps-- <= 0)) {
+        crm_info("Packed placement search budget exhausted");
+        data->exhausted = true;
+    }
+    return data->exhausted;
+}
+
+/*!
+ * \internal
+ * \brief Try to make room for an unplanned item by relocating a planned one
+ *
+ * \param[in,out] data  Packing data
+ * \param[in,out] item  Unplanned item to find room for
+ *
+ * \return \c true if \p item was planned, otherwise \c false
+ */
+static bool
+relocate_for(struct packing_data *data, packed_item_t *item)
+{
+    for (GList *iter = item->bins; iter != NULL; iter = iter->next) {
+        packed_bin_t *bin = iter->data;
+
+        for (guint i = 0; i < data->items->len; i++) {
+            packed_item_t *other = g_ptr_array_index(data->items, i);
+
+            if (out_of_steps(data)) {
+                return false;
+            }
+            if ((other->planned != bin)
+                || !item_fits(data, item, bin, other)) {
+                continue;
+            }
+
+            for (GList *dest = other->bins; dest != NULL; dest = dest->next) {
+                packed_bin_t *dest_bin = dest->data;
+
+                if ((dest_bin != bin)
+                    && item_fits(data, other, dest_bin, NULL)) {
+
+                    pcmk__rsc_trace(item->rsc,
+                                    "Relocating %s to %s to make room for %s",
+                                    other->rsc->id,
+                                    pcmk__node_name(dest_bin->node),
+                                    item->rsc->id);
+                    plan_item(data, other, dest_bin);
+                    plan_item(data, item, bin);
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/*!
+ * \internal
+ * \brief Plan items back on their current nodes where there is now room
+ *
+ * \param[in,out] data  Packing data
+ */
+static void
+avoid_moves(struct packing_data *data)
+{
+    for (guint i = 0; i < data->items->len; i++) {
+        packed_item_t *item = g_ptr_array_index(data->items, i);
+
+        if ((item->planned != NULL) && (item->current != NULL)
+            && (item->planned != item->current)
+            && (g_list_find(item->bins, item->current) != NULL)
+            && item_fits(data, item, item->current, NULL)) {
+            plan_item(data, item, item->current);
+        }
+    }
+}
+
+/*!
+ * \internal
+ * \brief Search for relocations that let more items be planned
+ *
+ * \param[in,out] data   Packing data
+ * \param[in]     limit  Maximum number of candidate relocations to consider
+ */
+static void
+search_packed_placement(struct packing_data *data, int limit)
+{
+    bool progress = false;
+
+    if (limit <= 0) {
+        return;
+    }
+    data->search_steps = limit;
+
+    // Each relocation plans one more item, so this always terminates
+    do {
+        progress = false;
+        for (guint i = 0; (i < data->items->len) && !data->exhausted; i++) {
+            packed_item_t *item = g_ptr_array_index(data->items, i);
+
+            if ((item->planned == NULL) && relocate_for(data, item)) {
+                progress = true;
+            }
+        }
+    } while (progress && !data->exhausted);
+}
+
+/*!
+ * \internal
+ * \brief Plan a packed placement of resources with utilization requirements
+ *
+ * When \c PCMK_OPT_PLACEMENT_STRATEGY is \c PCMK_VALUE_PACKED, treat the
+ * placement of all unassigned top-level primitives and groups as a
+ * multi-dimensional bin-packing problem. Resources are planned in order of
+ * decreasing size on the node that they fit most tightly, then planned
+ * resources are relocated to make room for any that did not fit, until no
+ * more can be planned or \c PCMK_OPT_PLACEMENT_SEARCH_LIMIT is reached.
+ * Finally, resources are kept on their current node wherever there is room.
+ *
+ * \param[in,out] scheduler  Scheduler data
+ *
+ * \return Newly allocated table mapping resource IDs to planned nodes, or
+ *         \c NULL if the packed strategy is not in use or there is nothing to
+ *         plan
+ * \note The plan is only a preference: a planned node is used when it is as
+ *       good as any other according to scores (so constraints and stickiness
+ *       still take precedence), and capacity is checked again during actual
+ *       assignment. The caller is responsible for freeing the result with
+ *       \c g_hash_table_destroy().
+ */
+GHashTable *
+pcmk__plan_packed_placement(pcmk_scheduler_t *scheduler)
+{
+    struct packing_data data = { NULL, };
+    GHashTable *plan = NULL;
+    GHashTable *packed_rscs = NULL;
+    guint n_attrs = 0;
+    int n_planned = 0;
+    int n_moves = 0;
+
+    if (!pcmk__str_eq(scheduler->priv->placement_strategy, PCMK_VALUE_PACKED,
+                      pcmk__str_casei)) {
+        return NULL;
+    }
+
+    data.attrs = pcmk__strkey_table(free, NULL);
+    data.bins = g_ptr_array_new_with_free_func(free_packed_bin);
+    data.items = g_ptr_array_new_with_free_func(free_packed_item);
+
+    for (const GList *iter = scheduler->nodes;
+         iter != NULL; iter = iter->next) {
+        pcmk_node_t *node = (pcmk_node_t *) iter->data;
+
+        if (pcmk__node_available(node, false, false)) {
+            packed_bin_t *bin = pcmk__assert_alloc(1, sizeof(packed_bin_t));
+
+            bin->node = node;
+            g_ptr_array_add(data.bins, bin);
+            g_hash_table_foreach(node->priv->utilization, index_attribute,
+                                 data.attrs);
+        }
+    }
+
+    packed_rscs = g_hash_table_new(NULL, NULL);
+    for (GList *iter = scheduler->priv->resources;
+         iter != NULL; iter = iter->next) {
+        packed_item_t *item = new_packed_item(&data, iter->data);
+
+        if (item != NULL) {
+            g_ptr_array_add(data.items, item);
+            g_hash_table_add(packed_rscs, item->rsc);
+        }
+    }
+
+    if (data.items->len == 0) {
+        goto done;
+    }
+
+    // Now that all attribute names are known, convert tables to arrays
+    n_attrs = g_hash_table_size(data.attrs);
+    data.total = pcmk__assert_alloc(n_attrs, sizeof(double));
+    for (guint i = 0; i < data.bins->len; i++) {
+        packed_bin_t *bin = g_ptr_array_index(data.bins, i);
+
+        bin->free = utilization_array(&data, bin->node->priv->utilization);
+        for (guint a = 0; a < n_attrs; a++) {
+            data.total[a] += QB_MAX(bin->free[a], 0);
+        }
+    }
+    for (guint i = 0; i < data.items->len; i++) {
+        packed_item_t *item = g_ptr_array_index(data.items, i);
+
+        item->need = utilization_array(&data, item->utilization);
+        g_hash_table_destroy(item->utilization);
+        item->utilization = NULL;
+        for (guint a = 0; a < n_attrs; a++) {
+            if (data.total[a] > 0.0) {
+                item->size += item->need[a] / data.total[a];
+            }
+        }
+    }
+
+    for (GList *iter = scheduler->priv->resources;
+         iter != NULL; iter = iter->next) {
+        if (!g_hash_table_contains(packed_rscs, iter->data)) {
+            reserve_unpacked_capacity(&data, iter->data);
+        }
+    }
+
+    g_ptr_array_sort(data.items, cmp_packed_items);
+    plan_best_fit(&data);
+    search_packed_placement(&data, scheduler->priv->placement_search_limit);
+    avoid_moves(&data);
+
+    plan = pcmk__strkey_table(NULL, NULL);
+    for (guint i = 0; i < data.items->len; i++) {
+        packed_item_t *item = g_ptr_array_index(data.items, i);
+
+        if (item->planned == NULL) {
+            pcmk__rsc_trace(item->rsc, "Packed placement found no room for %s",
+                            item->rsc->id);
+            continue;
+        }
+        pcmk__rsc_trace(item->rsc, "Packed placement planned %s on %s",
+                        item->rsc->id, pcmk__node_name(item->planned->node));
+        g_hash_table_insert(plan, item->rsc->id, item->planned->node);
+        n_planned++;
+        if ((item->current != NULL) && (item->current != item->planned)) {
+            n_moves++;
+        }
+    }
+    crm_info("Packed placement planned %d of %u resource%s on %u node%s "
+             "with %d move%s%s",
+             n_planned, data.items->len, pcmk__plural_s(data.items->len),
+             data.bins->len, pcmk__plural_s(data.bins->len),
+             n_moves, pcmk__plural_s(n_moves),
+             (data.exhausted? " (search budget exhausted)" : ""));
+
+done:
+    g_hash_table_destroy(packed_rscs);
+    g_ptr_array_free(data.items, TRUE);
+    g_ptr_array_free(data.bins, TRUE);
+    g_hash_table_destroy(data.attrs);
+    free(data.total);
+    return plan;
+}
+
+
+/*
+ * Other utilization-related functions
+ */
+
 /*!
  * \internal
  * \brief Create a new load_stopped pseudo-op for a node
@@ -289,6 +289,7 @@ static void
 assign_resources(pcmk_scheduler_t *scheduler)
 {
     GList *iter = NULL;
+    GHashTable *packed_plan = NULL;
 
     crm_trace("Assigning resources to nodes");
 
@@ -317,17 +318,35 @@ assign_resources(pcmk_scheduler_t *scheduler)
         }
     }
 
+    // With the packed strategy, plan preferred nodes for the rest up front
+    packed_plan = pcmk__plan_packed_placement(scheduler);
+
+    // Otherwise, independent sets of resources may be assigned in parallel
+    if ((packed_plan == NULL) && pcmk__assign_components(scheduler)) {
+        pcmk__show_node_capacities("Remaining", scheduler);
+        return;
+    }
+
     /* now do the rest of the resources */
     for (iter = scheduler->priv->resources; iter != NULL; iter = iter->next) {
         pcmk_resource_t *rsc = (pcmk_resource_t *) iter->data;
 
         if (!pcmk_is_set(rsc->flags, pcmk__rsc_is_remote_connection)) {
+            const pcmk_node_t *prefer = NULL;
+
+            if (packed_plan != NULL) {
+                prefer = g_hash_table_lookup(packed_plan, rsc->id);
+            }
             pcmk__rsc_trace(rsc, "Assigning %s resource '%s'",
                             rsc->priv->xml->name, rsc->id);
-            rsc->priv->cmds->assign(rsc, NULL, true);
+            rsc->priv->cmds->assign(rsc, prefer, true);
         }
     }
 
+    if (packed_plan != NULL) {
+        g_hash_table_destroy(packed_plan);
+    }
+
     pcmk__show_node_capacities("Remaining", scheduler);
 }
 
@@ -759,6 +778,72 @@ unpack_cib(xmlNode *cib, unsigned long long flags, pcmk_scheduler_t *scheduler)
     cluster_status(scheduler); // Sets pcmk__sched_have_status
 }
 
+// Time spent in each scheduling phase (microseconds)
+static pcmk__metric_t unpack_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_unpack_us",
+                 "Time spent unpacking scheduler input (microseconds)");
+static pcmk__metric_t constraints_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_constraints_us",
+                 "Time spent unpacking and applying constraints "
+                 "(microseconds)");
+static pcmk__metric_t assign_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_assign_us",
+                 "Time spent assigning resources (microseconds)");
+static pcmk__metric_t actions_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_actions_us",
+                 "Time spent scheduling resource actions (microseconds)");
+static pcmk__metric_t fencing_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_fencing_us",
+                 "Time spent scheduling fencing and shutdowns "
+                 "(microseconds)");
+static pcmk__metric_t orderings_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_orderings_us",
+                 "Time spent applying orderings (microseconds)");
+static pcmk__metric_t graph_metric =
+    PCMK__METRIC(pcmk__metric_histogram, "scheduler_graph_us",
+                 "Time spent creating the transition graph (microseconds)");
+
+/*!
+ * \internal
+ * \brief Record the duration of a scheduling phase and start timing the next
+ *
+ * \param[in,out] metric  Histogram for the phase just completed
+ * \param[in,out] start   Start time of phase just completed (will be reset)
+ */
+static void
+phase_done(pcmk__metric_t *metric, gint64 *start)
+{
+    gint64 now = g_get_monotonic_time();
+
+    pcmk__metric_observe(metric, (now > *start)? (uint64_t) (now - *start) : 0);
+    *start = now;
+}
+
+/*!
+ * \internal
+ * \brief Check whether the current scheduling run should be abandoned
+ *
+ * \param[in,out] scheduler  Scheduler data
+ * \param[in]     phase      Name of scheduling phase just completed (for logs)
+ *
+ * \return true if the caller-supplied cancellation check asked for the run to
+ *         be abandoned (in which case pcmk__sched_cancelled will be set),
+ *         otherwise false
+ */
+static bool
+sched_cancelled(pcmk_scheduler_t *scheduler, const char *phase)
+{
+    if ((scheduler->priv->cancel_check == NULL)
+        || !scheduler->priv->cancel_check(scheduler,
+                                          scheduler->priv->cancel_data)) {
+        return false;
+    }
+    crm_info("Abandoning scheduler run after %s because input was superseded",
+             phase);
+    pcmk__set_scheduler_flags(scheduler, pcmk__sched_cancelled);
+    return true;
+}
+
 /*!
  * \internal
  * \brief Run the scheduler for a given CIB
@@ -766,18 +851,33 @@ unpack_cib(xmlNode *cib, unsigned long long flags, pcmk_scheduler_t *scheduler)
  * \param[in,out] cib        CIB XML to use as scheduler input
  * \param[in]     flags      Scheduler flags to set in addition to defaults
  * \param[in,out] scheduler  Scheduler data
+ *
+ * \note If \p scheduler has a cancellation check set, it is called after each
+ *       scheduling phase. If it returns true, the remaining phases are skipped,
+ *       pcmk__sched_cancelled is set, and no transition graph is created. The
+ *       caller must still free \p scheduler as usual.
  */
 void
 pcmk__schedule_actions(xmlNode *cib, unsigned long long flags,
                        pcmk_scheduler_t *scheduler)
 {
+    gint64 start = g_get_monotonic_time();
+
     unpack_cib(cib, flags, scheduler);
+    phase_done(&unpack_metric, &start);
+    if (sched_cancelled(scheduler, "unpacking status")) {
+        return;
+    }
+
     pcmk__set_assignment_methods(scheduler);
     pcmk__apply_node_health(scheduler);
     pcmk__unpack_constraints(scheduler);
     if (pcmk_is_set(scheduler->flags, pcmk__sched_validate_only)) {
         return;
     }
+    if (sched_cancelled(scheduler, "unpacking constraints")) {
+        return;
+    }
 
     if (!pcmk_is_set(scheduler->flags, pcmk__sched_location_only)
         && pcmk__is_daemon) {
@@ -785,6 +885,7 @@ pcmk__schedule_actions(xmlNode *cib, unsigned long long flags,
     }
 
     apply_node_criteria(scheduler);
+    phase_done(&constraints_metric, &start);
 
     if (pcmk_is_set(scheduler->flags, pcmk__sched_location_only)) {
         return;
@@ -792,8 +893,21 @@ pcmk__schedule_actions(xmlNode *cib, unsigned long long flags,
 
     pcmk__create_internal_constraints(scheduler);
     pcmk__handle_rsc_config_changes(scheduler);
+    if (sched_cancelled(scheduler, "applying location criteria")) {
+        return;
+    }
+
     assign_resources(scheduler);
+    phase_done(&assign_metric, &start);
+    if (sched_cancelled(scheduler, "assigning resources")) {
+        return;
+    }
+
     schedule_resource_actions(scheduler);
+    phase_done(&actions_metric, &start);
+    if (sched_cancelled(scheduler, "scheduling resource actions")) {
+        return;
+    }
 
     /* Remote ordering constraints need to happen prior to calculating fencing
      * because it is one more place we can mark nodes as needing fencing.
@@ -801,9 +915,20 @@ pcmk__schedule_actions(xmlNode *cib, unsigned long long flags,
     pcmk__order_remote_connection_actions(scheduler);
 
     schedule_fencing_and_shutdowns(scheduler);
+    phase_done(&fencing_metric, &start);
+    if (sched_cancelled(scheduler, "scheduling fencing and shutdowns")) {
+        return;
+    }
+
     pcmk__apply_orderings(scheduler);
+    phase_done(&orderings_metric, &start);
+    if (sched_cancelled(scheduler, "applying orderings")) {
+        return;
+    }
+
     log_all_actions(scheduler);
     pcmk__create_graph(scheduler);
+    phase_done(&graph_metric, &start);
 
     if (get_crm_log_level() == LOG_TRACE) {
         log_unrunnable_actions(scheduler);
@@ -22,6 +22,18 @@
 #include <pacemaker.h>
 #include <pacemaker-internal.h>
 
+/* Output sections that show resource state or anything derived from it (node
+ * output includes each node's active resources, and counts include blocked
+ * resources). When none of these are shown, resource history isn't unpacked.
+ */
+#define SECTIONS_NEEDING_HISTORY (pcmk_section_counts                       \
+                                  |pcmk_section_nodes                       \
+                                  |pcmk_section_resources                   \
+                                  |pcmk_section_attributes                  \
+                                  |pcmk_section_failcounts                  \
+                                  |pcmk_section_operations                  \
+                                  |pcmk_section_failures)
+
 static stonith_t *
 fencing_connect(void)
 {
@@ -104,6 +116,9 @@ pcmk__output_cluster_status(pcmk_scheduler_t *scheduler, stonith_t *stonith,
 
     pe_reset_working_set(scheduler);
     scheduler->input = cib_copy;
+    if (!pcmk_any_flags_set(show, SECTIONS_NEEDING_HISTORY)) {
+        pcmk__set_scheduler_flags(scheduler, pcmk__sched_no_history);
+    }
     cluster_status(scheduler);
 
     /* Unpack constraints if any section will need them
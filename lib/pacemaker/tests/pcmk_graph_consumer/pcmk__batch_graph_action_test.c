@@ -0,0 +1,420 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+
+#include <pacemaker-internal.h>
+
+#define MAX_ACTIONS 64
+
+// A batch as seen by the send function
+struct sent_batch {
+    char *node;
+    guint count;        // Count passed to send function
+    guint ops;          // Number of children of the XML passed
+    GList *ids;         // IDs of actions passed (as GINT_TO_POINTER)
+};
+
+// Batches sent, in the order sent
+static GList *sent = NULL;
+
+// Actions sent, in the order sent (for simulated completion)
+static GList *sent_actions = NULL;
+
+static void
+free_sent_batch(gpointer data)
+{
+    struct sent_batch *batch = data;
+
+    free(batch->node);
+    g_list_free(batch->ids);
+    free(batch);
+}
+
+static int
+reset_sent(void **state)
+{
+    g_list_free_full(sent, free_sent_batch);
+    sent = NULL;
+    g_list_free(sent_actions);
+    sent_actions = NULL;
+    return 0;
+}
+
+static void
+record_batch(const char *node, xmlNode *ops, GList *actions, guint count,
+             void *user_data)
+{
+    struct sent_batch *batch = NULL;
+
+    assert_non_null(node);
+    assert_non_null(ops);
+    assert_true(pcmk__xe_is(ops, PCMK__XE_RSC_OPS));
+    assert_int_equal(g_list_length(actions), count);
+
+    batch = pcmk__assert_alloc(1, sizeof(struct sent_batch));
+    batch->node = pcmk__str_copy(node);
+    batch->count = count;
+    for (xmlNode *op = pcmk__xe_first_child(ops, NULL, NULL, NULL); op != NULL;
+         op = pcmk__xe_next(op, NULL)) {
+        batch->ops++;
+    }
+    for (GList *iter = actions; iter != NULL; iter = iter->next) {
+        pcmk__graph_action_t *action = iter->data;
+
+        batch->ids = g_list_append(batch->ids, GINT_TO_POINTER(action->id));
+        sent_actions = g_list_append(sent_actions, action);
+    }
+    sent = g_list_append(sent, batch);
+}
+
+static struct sent_batch *
+sent_batch(guint n)
+{
+    struct sent_batch *batch = g_list_nth_data(sent, n);
+
+    assert_non_null(batch);
+    assert_int_equal(batch->ops, batch->count);
+    return batch;
+}
+
+static int
+sent_id(const struct sent_batch *batch, guint n)
+{
+    return GPOINTER_TO_INT(g_list_nth_data(batch->ids, n));
+}
+
+// Create a standalone graph action for unit tests that don't need a graph
+static pcmk__graph_action_t *
+new_action(int id)
+{
+    pcmk__graph_action_t *action = NULL;
+
+    action = pcmk__assert_alloc(1, sizeof(pcmk__graph_action_t));
+    action->id = id;
+    action->type = pcmk__rsc_graph_action;
+    action->xml = pcmk__xe_create(NULL, PCMK__XE_RSC_OP);
+    crm_xml_add_int(action->xml, PCMK_XA_ID, id);
+    return action;
+}
+
+static void
+free_action(gpointer data)
+{
+    pcmk__graph_action_t *action = data;
+
+    pcmk__xml_free(action->xml);
+    free(action);
+}
+
+static void
+null_batches(void **state)
+{
+    pcmk__send_action_batches(NULL);
+    pcmk__action_batches_free(NULL);
+    assert_null(sent);
+}
+
+static void
+no_actions(void **state)
+{
+    pcmk__action_batches_t *batches = pcmk__action_batches_new(MAX_ACTIONS,
+                                                               record_batch,
+                                                               NULL);
+
+    pcmk__send_action_batches(batches);
+    assert_null(sent);
+    pcmk__action_batches_free(batches);
+}
+
+static void
+one_message_per_node(void **state)
+{
+    pcmk__action_batches_t *batches = pcmk__action_batches_new(MAX_ACTIONS,
+                                                               record_batch,
+                                                               NULL);
+    GList *actions = NULL;
+    const char *nodes[] = { "node2", "node1", "node3" };
+
+    for (int i = 0; i < 9; i++) {
+        pcmk__graph_action_t *action = new_action(i);
+
+        actions = g_list_append(actions, action);
+        pcmk__batch_graph_action(batches, nodes[i % 3], action);
+    }
+    assert_null(sent);
+
+    pcmk__send_action_batches(batches);
+
+    // Batches are sent by first use of node, with actions in order added
+    assert_int_equal(g_list_length(sent), 3);
+    assert_string_equal(sent_batch(0)->node, "node2");
+    assert_string_equal(sent_batch(1)->node, "node1");
+    assert_string_equal(sent_batch(2)->node, "node3");
+    for (guint n = 0; n < 3; n++) {
+        assert_int_equal(sent_batch(n)->count, 3);
+        assert_int_equal(sent_id(sent_batch(n), 0), n);
+        assert_int_equal(sent_id(sent_batch(n), 1), n + 3);
+        assert_int_equal(sent_id(sent_batch(n), 2), n + 6);
+    }
+
+    // Nothing is left to send afterward
+    reset_sent(NULL);
+    pcmk__send_action_batches(batches);
+    assert_null(sent);
+
+    pcmk__action_batches_free(batches);
+    g_list_free_full(actions, free_action);
+}
+
+static void
+exactly_full(void **state)
+{
+    pcmk__action_batches_t *batches = pcmk__action_batches_new(MAX_ACTIONS,
+                                                               record_batch,
+                                                               NULL);
+    GList *actions = NULL;
+
+    for (int i = 0; i < MAX_ACTIONS; i++) {
+        pcmk__graph_action_t *action = new_action(i);
+
+        actions = g_list_append(actions, action);
+        pcmk__batch_graph_action(batches, "node1", action);
+    }
+
+    // A full batch is not sent until another action is added or all are sent
+    assert_null(sent);
+    pcmk__send_action_batches(batches);
+    assert_int_equal(g_list_length(sent), 1);
+    assert_int_equal(sent_batch(0)->count, MAX_ACTIONS);
+
+    pcmk__action_batches_free(batches);
+    g_list_free_full(actions, free_action);
+}
+
+static void
+split_large_batch(void **state)
+{
+    pcmk__action_batches_t *batches = pcmk__action_batches_new(MAX_ACTIONS,
+                                                               record_batch,
+                                                               NULL);
+    GList *actions = NULL;
+
+    for (int i = 0; i < 150; i++) {
+        pcmk__graph_action_t *action = new_action(i);
+
+        actions = g_list_append(actions, action);
+        pcmk__batch_graph_action(batches, "node1", action);
+    }
+
+    // Full batches are sent as soon as another action needs to be added
+    assert_int_equal(g_list_length(sent), 2);
+
+    pcmk__send_action_batches(batches);
+    assert_int_equal(g_list_length(sent), 3);
+    assert_int_equal(sent_batch(0)->count, 64);
+    assert_int_equal(sent_batch(1)->count, 64);
+    assert_int_equal(sent_batch(2)->count, 22);
+    assert_int_equal(sent_id(sent_batch(0), 0), 0);
+    assert_int_equal(sent_id(sent_batch(1), 0), 64);
+    assert_int_equal(sent_id(sent_batch(2), 0), 128);
+    assert_int_equal(sent_id(sent_batch(2), 21), 149);
+
+    pcmk__action_batches_free(batches);
+    g_list_free_full(actions, free_action);
+}
+
+static void
+unlimited(void **state)
+{
+    pcmk__action_batches_t *batches = pcmk__action_batches_new(0, record_batch,
+                                                               NULL);
+    GList *actions = NULL;
+
+    for (int i = 0; i < 150; i++) {
+        pcmk__graph_action_t *action = new_action(i);
+
+        actions = g_list_append(actions, action);
+        pcmk__batch_graph_action(batches, "node1", action);
+    }
+    pcmk__send_action_batches(batches);
+    assert_int_equal(g_list_length(sent), 1);
+    assert_int_equal(sent_batch(0)->count, 150);
+
+    pcmk__action_batches_free(batches);
+    g_list_free_full(actions, free_action);
+}
+
+/*
+ * Simulated transition
+ */
+
+#define SIM_NODES       3
+#define SIM_STARTS      100     // Start actions per node (no inputs)
+#define SIM_MONITORS    3       // Monitor actions per node (after a start)
+
+static pcmk__action_batches_t *sim_batches = NULL;
+
+static int
+sim_confirm(pcmk__graph_t *graph, pcmk__graph_action_t *action)
+{
+    pcmk__set_graph_action_flags(action, pcmk__graph_action_confirmed);
+    pcmk__update_graph(graph, action);
+    return pcmk_rc_ok;
+}
+
+static int
+sim_batch_rsc(pcmk__graph_t *graph, pcmk__graph_action_t *action)
+{
+    const char *node = crm_element_value(action->xml, PCMK__META_ON_NODE);
+
+    assert_non_null(node);
+    pcmk__batch_graph_action(sim_batches, node, action);
+    return pcmk_rc_ok;
+}
+
+static pcmk__graph_functions_t sim_fns = {
+    sim_confirm,
+    sim_batch_rsc,
+    sim_confirm,
+    sim_confirm,
+};
+
+static xmlNode *
+add_rsc_op(xmlNode *parent, int id, const char *task, const char *node)
+{
+    xmlNode *op = pcmk__xe_create(parent, PCMK__XE_RSC_OP);
+
+    crm_xml_add_int(op, PCMK_XA_ID, id);
+    crm_xml_add(op, PCMK_XA_OPERATION, task);
+    crm_xml_add(op, PCMK__META_ON_NODE, node);
+    return op;
+}
+
+static xmlNode *
+add_synapse(xmlNode *graph, int id, int action_id, const char *task,
+            const char *node, int input_id)
+{
+    xmlNode *synapse = pcmk__xe_create(graph, PCMK__XE_SYNAPSE);
+    xmlNode *inputs = NULL;
+
+    crm_xml_add_int(synapse, PCMK_XA_ID, id);
+    add_rsc_op(pcmk__xe_create(synapse, PCMK__XE_ACTION_SET), action_id, task,
+               node);
+    inputs = pcmk__xe_create(synapse, PCMK__XE_INPUTS);
+    if (input_id >= 0) {
+        add_rsc_op(pcmk__xe_create(inputs, PCMK__XE_TRIGGER), input_id,
+                   PCMK_ACTION_START, node);
+    }
+    return synapse;
+}
+
+// Complete all actions that have been sent so far, as executors would
+static void
+complete_sent_actions(pcmk__graph_t *graph)
+{
+    for (GList *iter = sent_actions; iter != NULL; iter = iter->next) {
+        sim_confirm(graph, (pcmk__graph_action_t *) iter->data);
+    }
+    reset_sent(NULL);
+}
+
+static void
+simulated_transition(void **state)
+{
+    xmlNode *xml = pcmk__xe_create(NULL, PCMK__XE_TRANSITION_GRAPH);
+    pcmk__graph_t *graph = NULL;
+    int id = 0;
+
+    crm_xml_add(xml, "transition_id", "1");
+    crm_xml_add(xml, PCMK_OPT_CLUSTER_DELAY, "60s");
+
+    for (int n = 0; n < SIM_NODES; n++) {
+        char *node = crm_strdup_printf("node%d", n + 1);
+
+        for (int i = 0; i < SIM_STARTS; i++, id++) {
+            add_synapse(xml, id, id, PCMK_ACTION_START, node, -1);
+        }
+        for (int i = 0; i < SIM_MONITORS; i++, id++) {
+            add_synapse(xml, id, id, PCMK_ACTION_MONITOR, node,
+                        n * (SIM_STARTS + SIM_MONITORS));
+        }
+        free(node);
+    }
+
+    graph = pcmk__unpack_graph(xml, "simulated");
+    pcmk__xml_free(xml);
+    assert_non_null(graph);
+    assert_int_equal(graph->num_actions,
+                     SIM_NODES * (SIM_STARTS + SIM_MONITORS));
+
+    sim_batches = pcmk__action_batches_new(MAX_ACTIONS, record_batch, NULL);
+    pcmk__set_graph_functions(&sim_fns);
+
+    /* First pass: all starts are initiated, and each node gets one full batch
+     * plus one with the remainder, instead of one message per action. Each
+     * node's full batch is sent as soon as its next action is added, and the
+     * remainders when all batches are sent.
+     */
+    assert_int_equal(pcmk__execute_graph(graph), pcmk__graph_active);
+    assert_int_equal(g_list_length(sent), SIM_NODES);
+    pcmk__send_action_batches(sim_batches);
+    assert_int_equal(g_list_length(sent), SIM_NODES * 2);
+    for (guint n = 0; n < SIM_NODES; n++) {
+        char *node = crm_strdup_printf("node%u", n + 1);
+
+        assert_string_equal(sent_batch(n)->node, node);
+        assert_int_equal(sent_batch(n)->count, MAX_ACTIONS);
+        assert_string_equal(sent_batch(SIM_NODES + n)->node, node);
+        assert_int_equal(sent_batch(SIM_NODES + n)->count,
+                         SIM_STARTS - MAX_ACTIONS);
+        free(node);
+    }
+
+    // Nothing more can be initiated until the starts complete
+    assert_int_equal(g_list_length(sent_actions), SIM_NODES * SIM_STARTS);
+    complete_sent_actions(graph);
+
+    // Second pass: each node gets one message with all of its monitors
+    assert_int_equal(pcmk__execute_graph(graph), pcmk__graph_active);
+    pcmk__send_action_batches(sim_batches);
+    assert_int_equal(g_list_length(sent), SIM_NODES);
+    for (guint n = 0; n < SIM_NODES; n++) {
+        assert_int_equal(sent_batch(n)->count, SIM_MONITORS);
+    }
+    complete_sent_actions(graph);
+
+    // Final pass: the transition is complete, and nothing is sent
+    assert_int_equal(pcmk__execute_graph(graph), pcmk__graph_complete);
+    pcmk__send_action_batches(sim_batches);
+    assert_null(sent);
+
+    pcmk__action_batches_free(sim_batches);
+    sim_batches = NULL;
+    pcmk__free_graph(graph);
+}
+
+static int
+teardown(void **state)
+{
+    reset_sent(NULL);
+    return pcmk__xml_test_teardown_group(state);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, teardown,
+                cmocka_unit_test(null_batches),
+                cmocka_unit_test_setup(no_actions, reset_sent),
+                cmocka_unit_test_setup(one_message_per_node, reset_sent),
+                cmocka_unit_test_setup(exactly_full, reset_sent),
+                cmocka_unit_test_setup(split_large_batch, reset_sent),
+                cmocka_unit_test_setup(unlimited, reset_sent),
+                cmocka_unit_test_setup(simulated_transition, reset_sent))
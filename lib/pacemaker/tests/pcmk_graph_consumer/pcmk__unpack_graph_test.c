@@ -0,0 +1,134 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/xml.h>
+
+#include <pacemaker-internal.h>
+
+#define GRAPH                                                               \
+    "<" PCMK__XE_TRANSITION_GRAPH " transition_id=\"7\" "                   \
+        PCMK_OPT_CLUSTER_DELAY "=\"60s\" " PCMK_OPT_BATCH_LIMIT "=\"5\">"   \
+      "<" PCMK__XE_SYNAPSE " " PCMK_XA_ID "=\"0\">"                         \
+        "<" PCMK__XE_ACTION_SET ">"                                         \
+          "<" PCMK__XE_PSEUDO_EVENT " " PCMK_XA_ID "=\"10\"/>"              \
+          "<" PCMK__XE_PSEUDO_EVENT " " PCMK_XA_ID "=\"11\"/>"              \
+        "</" PCMK__XE_ACTION_SET ">"                                        \
+        "<" PCMK__XE_INPUTS "/>"                                            \
+      "</" PCMK__XE_SYNAPSE ">"                                             \
+      "<" PCMK__XE_SYNAPSE " " PCMK_XA_ID "=\"1\" "                         \
+          PCMK__XA_PRIORITY "=\"1000000\">"                                 \
+        "<" PCMK__XE_ACTION_SET ">"                                         \
+          "<" PCMK__XE_PSEUDO_EVENT " " PCMK_XA_ID "=\"12\"/>"              \
+        "</" PCMK__XE_ACTION_SET ">"                                        \
+        "<" PCMK__XE_INPUTS ">"                                             \
+          "<" PCMK__XE_TRIGGER ">"                                          \
+            "<" PCMK__XE_PSEUDO_EVENT " " PCMK_XA_ID "=\"10\"/>"            \
+          "</" PCMK__XE_TRIGGER ">"                                         \
+          "<" PCMK__XE_TRIGGER ">"                                          \
+            "<" PCMK__XE_PSEUDO_EVENT " " PCMK_XA_ID "=\"11\"/>"            \
+          "</" PCMK__XE_TRIGGER ">"                                         \
+        "</" PCMK__XE_INPUTS ">"                                            \
+      "</" PCMK__XE_SYNAPSE ">"                                             \
+      "<" PCMK__XE_SYNAPSE " " PCMK_XA_ID "=\"2\">"                         \
+        "<" PCMK__XE_ACTION_SET ">"                                         \
+          "<" PCMK__XE_PSEUDO_EVENT " " PCMK_XA_ID "=\"13\"/>"              \
+        "</" PCMK__XE_ACTION_SET ">"                                        \
+        "<" PCMK__XE_INPUTS "/>"                                            \
+      "</" PCMK__XE_SYNAPSE ">"                                             \
+    "</" PCMK__XE_TRANSITION_GRAPH ">"
+
+static int
+action_id(GList *actions, guint n)
+{
+    pcmk__graph_action_t *action = g_list_nth_data(actions, n);
+
+    assert_non_null(action);
+    return action->id;
+}
+
+static int
+synapse_id(const pcmk__graph_t *graph, guint n)
+{
+    pcmk__graph_synapse_t *synapse = g_list_nth_data(graph->synapses, n);
+
+    assert_non_null(synapse);
+    return synapse->id;
+}
+
+static void
+null_xml(void **state)
+{
+    pcmk__graph_t *graph = pcmk__unpack_graph(NULL, NULL);
+
+    assert_non_null(graph);
+    assert_string_equal(graph->source, "unknown");
+    assert_int_equal(graph->num_synapses, 0);
+    assert_int_equal(graph->num_actions, 0);
+    assert_null(graph->synapses);
+    pcmk__free_graph(graph);
+}
+
+static void
+missing_transition_id(void **state)
+{
+    xmlNode *xml = pcmk__xe_create(NULL, PCMK__XE_TRANSITION_GRAPH);
+
+    crm_xml_add(xml, PCMK_OPT_CLUSTER_DELAY, "60s");
+    assert_null(pcmk__unpack_graph(xml, "pe-input-1.bz2"));
+    pcmk__xml_free(xml);
+}
+
+static void
+unpack_in_order(void **state)
+{
+    xmlNode *xml = pcmk__xml_parse(GRAPH);
+    pcmk__graph_t *graph = pcmk__unpack_graph(xml, "pe-input-1.bz2");
+    pcmk__graph_synapse_t *synapse = NULL;
+
+    // The graph must not refer to the XML it was unpacked from
+    pcmk__xml_free(xml);
+
+    assert_non_null(graph);
+    assert_int_equal(graph->id, 7);
+    assert_string_equal(graph->source, "pe-input-1.bz2");
+    assert_int_equal(graph->network_delay, 60000);
+    assert_int_equal(graph->batch_limit, 5);
+    assert_int_equal(graph->num_synapses, 3);
+    assert_int_equal(graph->num_actions, 4);
+
+    // Synapses, actions, and inputs keep the order they have in the XML
+    assert_int_equal(g_list_length(graph->synapses), 3);
+    assert_int_equal(synapse_id(graph, 0), 0);
+    assert_int_equal(synapse_id(graph, 1), 1);
+    assert_int_equal(synapse_id(graph, 2), 2);
+
+    synapse = g_list_nth_data(graph->synapses, 0);
+    assert_int_equal(g_list_length(synapse->actions), 2);
+    assert_int_equal(action_id(synapse->actions, 0), 10);
+    assert_int_equal(action_id(synapse->actions, 1), 11);
+    assert_null(synapse->inputs);
+
+    synapse = g_list_nth_data(graph->synapses, 1);
+    assert_int_equal(synapse->priority, 1000000);
+    assert_int_equal(g_list_length(synapse->actions), 1);
+    assert_int_equal(action_id(synapse->actions, 0), 12);
+    assert_int_equal(g_list_length(synapse->inputs), 2);
+    assert_int_equal(action_id(synapse->inputs, 0), 10);
+    assert_int_equal(action_id(synapse->inputs, 1), 11);
+
+    pcmk__free_graph(graph);
+}
+
+PCMK__UNIT_TEST(pcmk__xml_test_setup_group, pcmk__xml_test_teardown_group,
+                cmocka_unit_test(null_xml),
+                cmocka_unit_test(missing_transition_id),
+                cmocka_unit_test(unpack_in_order))
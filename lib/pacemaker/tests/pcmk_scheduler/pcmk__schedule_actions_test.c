@@ -0,0 +1,163 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/scheduler.h>
+#include <crm/common/xml.h>
+#include <crm/pengine/status.h>
+
+#include <pacemaker-internal.h>
+
+// Number of phase boundaries at which pcmk__schedule_actions() checks
+#define NUM_PHASE_CHECKS 7
+
+static xmlNode *input = NULL;
+
+// Instrumentation for a scheduler run
+struct run_data {
+    int checks;     // Number of times the cancellation check was called
+    int cancel_at;  // Abandon the run at this check (or never if 0)
+};
+
+static bool
+instrumented_check(pcmk_scheduler_t *scheduler, void *user_data)
+{
+    struct run_data *run = user_data;
+
+    return ++(run->checks) == run->cancel_at;
+}
+
+static pcmk_scheduler_t *
+run_scheduler(struct run_data *run)
+{
+    pcmk_scheduler_t *scheduler = pe_new_working_set();
+
+    assert_non_null(scheduler);
+    scheduler->priv->cancel_check = instrumented_check;
+    scheduler->priv->cancel_data = run;
+
+    // pcmk__schedule_actions() takes ownership of the copy
+    pcmk__schedule_actions(pcmk__xml_copy(NULL, input), pcmk__sched_no_counts,
+                           scheduler);
+    return scheduler;
+}
+
+static int
+setup(void **state)
+{
+    char *path = NULL;
+
+    pcmk__xml_test_setup_group(state);
+
+    path = crm_strdup_printf("%s/crm_mon.xml", getenv("PCMK_CTS_CLI_DIR"));
+    input = pcmk__xml_read(path);
+    free(path);
+
+    return (input == NULL)? 1 : 0;
+}
+
+static int
+teardown(void **state)
+{
+    pcmk__xml_free(input);
+    input = NULL;
+    return pcmk__xml_test_teardown_group(state);
+}
+
+static void
+not_cancelled(void **state)
+{
+    struct run_data run = { 0, 0 };
+    pcmk_scheduler_t *scheduler = run_scheduler(&run);
+
+    assert_int_equal(run.checks, NUM_PHASE_CHECKS);
+    assert_false(pcmk_is_set(scheduler->flags, pcmk__sched_cancelled));
+    assert_non_null(scheduler->priv->graph);
+
+    pe_free_working_set(scheduler);
+}
+
+static void
+cancelled_at_each_phase(void **state)
+{
+    for (int i = 1; i <= NUM_PHASE_CHECKS; i++) {
+        struct run_data run = { 0, i };
+        pcmk_scheduler_t *scheduler = run_scheduler(&run);
+
+        // No further phases were run, and no graph was created
+        assert_int_equal(run.checks, i);
+        assert_true(pcmk_is_set(scheduler->flags, pcmk__sched_cancelled));
+        assert_null(scheduler->priv->graph);
+
+        pe_free_working_set(scheduler);
+    }
+}
+
+static void
+cancel_check_preserved_across_reset(void **state)
+{
+    struct run_data run = { 0, 0 };
+    pcmk_scheduler_t *scheduler = run_scheduler(&run);
+
+    pe_reset_working_set(scheduler);
+    assert_ptr_equal(scheduler->priv->cancel_check, instrumented_check);
+    assert_ptr_equal(scheduler->priv->cancel_data, &run);
+
+    pe_free_working_set(scheduler);
+}
+
+#ifdef HAVE_MALLINFO2
+static size_t
+bytes_in_use(void)
+{
+    return mallinfo2().uordblks;
+}
+#endif
+
+static void
+abandoned_runs_free_memory(void **state)
+{
+#ifdef HAVE_MALLINFO2
+    size_t baseline = 0;
+
+    /* Do one complete run and one abandoned run at each phase first, so that
+     * any one-time allocations (such as libxml2 and GLib caches) are made
+     * before the baseline is taken
+     */
+    for (int i = 0; i <= NUM_PHASE_CHECKS; i++) {
+        struct run_data run = { 0, i };
+
+        pe_free_working_set(run_scheduler(&run));
+    }
+    baseline = bytes_in_use();
+
+    for (int pass = 0; pass < 3; pass++) {
+        for (int i = 1; i <= NUM_PHASE_CHECKS; i++) {
+            struct run_data run = { 0, i };
+
+            pe_free_working_set(run_scheduler(&run));
+            assert_true(bytes_in_use() <= baseline);
+        }
+    }
+#else
+    skip();
+#endif
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(not_cancelled),
+                cmocka_unit_test(cancelled_at_each_phase),
+                cmocka_unit_test(cancel_check_preserved_across_reset),
+                cmocka_unit_test(abandoned_runs_free_memory))
@@ -1353,6 +1353,9 @@ pe_free_action(pcmk_action_t *action)
     }
     g_list_free_full(action->actions_before, free);
     g_list_free_full(action->actions_after, free);
+    if (action->after_flags != NULL) {
+        g_hash_table_destroy(action->after_flags);
+    }
     if (action->extra) {
         g_hash_table_destroy(action->extra);
     }
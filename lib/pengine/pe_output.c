@@ -225,6 +225,51 @@ last_changed_string(const char *last_written, const char *user,
     }
 }
 
+// Resource usage attributes of operation history entries, with display units
+static const struct {
+    const char *name;
+    const char *units;
+} op_rusage_attrs[] = {
+    { PCMK_XA_CPU_USER_TIME, "ms" },
+    { PCMK_XA_CPU_SYSTEM_TIME, "ms" },
+    { PCMK_XA_MAX_RSS, "KiB" },
+    { PCMK_XA_BLOCKS_IN, NULL },
+    { PCMK_XA_BLOCKS_OUT, NULL },
+};
+
+/*!
+ * \internal
+ * \brief Format an operation history entry's recorded resource usage
+ *
+ * \param[in] xml_op  Operation history entry XML
+ *
+ * \return Newly allocated string with usage as name=value pairs, each preceded
+ *         by a space (or NULL if no usage was recorded)
+ * \note The caller is responsible for freeing the result using g_free().
+ */
+static gchar *
+op_rusage_string(const xmlNode *xml_op)
+{
+    GString *str = NULL;
+
+    for (int i = 0; i < PCMK__NELEM(op_rusage_attrs); i++) {
+        const char *name = op_rusage_attrs[i].name;
+        const char *value = crm_element_value(xml_op, name);
+        char *pair = NULL;
+
+        if (value == NULL) {
+            continue;
+        }
+        if (str == NULL) {
+            str = g_string_sized_new(128);
+        }
+        pair = pcmk__format_nvpair(name, value, op_rusage_attrs[i].units);
+        pcmk__g_strcat(str, " ", pair, NULL);
+        free(pair);
+    }
+    return (str == NULL)? NULL : g_string_free(str, FALSE);
+}
+
 static char *
 op_history_string(xmlNode *xml_op, const char *task, const char *interval_ms_s,
                   int rc, bool print_timing) {
@@ -242,6 +287,7 @@ op_history_string(xmlNode *xml_op, const char *task, const char *interval_ms_s,
         char *last_change_str = NULL;
         char *exec_str = NULL;
         char *queue_str = NULL;
+        gchar *rusage_str = op_rusage_string(xml_op);
 
         const char *value = NULL;
 
@@ -272,11 +318,12 @@ op_history_string(xmlNode *xml_op, const char *task, const char *interval_ms_s,
             free(pair);
         }
 
-        buf = crm_strdup_printf("(%s) %s:%s%s%s%s rc=%d (%s)", call, task,
+        buf = crm_strdup_printf("(%s) %s:%s%s%s%s%s rc=%d (%s)", call, task,
                                 interval_str ? interval_str : "",
                                 last_change_str ? last_change_str : "",
                                 exec_str ? exec_str : "",
                                 queue_str ? queue_str : "",
+                                rusage_str ? rusage_str : "",
                                 rc, crm_exit_str(rc));
 
         if (last_change_str) {
@@ -290,6 +337,8 @@ op_history_string(xmlNode *xml_op, const char *task, const char *interval_ms_s,
         if (queue_str) {
             free(queue_str);
         }
+
+        g_free(rusage_str);
     } else {
         buf = crm_strdup_printf("(%s) %s%s%s", call, task,
                                 interval_str ? ":" : "",
@@ -2193,7 +2242,7 @@ node_and_op(pcmk__output_t *out, va_list args) {
 
     pcmk_resource_t *rsc = NULL;
     gchar *node_str = NULL;
-    char *last_change_str = NULL;
+    gchar *last_change_str = NULL;
 
     const char *op_rsc = crm_element_value(xml_op, PCMK_XA_RESOURCE);
     int status;
@@ -2223,11 +2272,22 @@ node_and_op(pcmk__output_t *out, va_list args) {
     if (crm_element_value_epoch(xml_op, PCMK_XA_LAST_RC_CHANGE,
                                 &last_change) == pcmk_ok) {
         const char *exec_time = crm_element_value(xml_op, PCMK_XA_EXEC_TIME);
+        GString *str = g_string_sized_new(256);
 
-        last_change_str = crm_strdup_printf(", %s='%s', exec=%sms",
-                                            PCMK_XA_LAST_RC_CHANGE,
-                                            pcmk__trim(ctime(&last_change)),
-                                            exec_time);
+        g_string_append_printf(str, ", %s='%s', exec=%sms",
+                               PCMK_XA_LAST_RC_CHANGE,
+                               pcmk__trim(ctime(&last_change)), exec_time);
+
+        for (int i = 0; i < PCMK__NELEM(op_rusage_attrs); i++) {
+            const char *name = op_rusage_attrs[i].name;
+            const char *value = crm_element_value(xml_op, name);
+
+            if (value != NULL) {
+                pcmk__g_strcat(str, ", ", name, "=", value,
+                               pcmk__s(op_rusage_attrs[i].units, ""), NULL);
+            }
+        }
+        last_change_str = g_string_free(str, FALSE);
     }
 
     out->list_item(out, NULL, "%s: %s (node=%s, call=%s, rc=%s%s): %s",
@@ -2239,7 +2299,7 @@ node_and_op(pcmk__output_t *out, va_list args) {
                    pcmk_exec_status_str(status));
 
     g_free(node_str);
-    free(last_change_str);
+    g_free(last_change_str);
     return pcmk_rc_ok;
 }
 
@@ -2302,6 +2362,12 @@ node_and_op_xml(pcmk__output_t *out, va_list args) {
                            PCMK_XA_LAST_RC_CHANGE, last_rc_change,
                            PCMK_XA_EXEC_TIME, exec_time,
                            NULL);
+
+        for (int i = 0; i < PCMK__NELEM(op_rusage_attrs); i++) {
+            const char *name = op_rusage_attrs[i].name;
+
+            crm_xml_add(node, name, crm_element_value(xml_op, name));
+        }
     }
 
     return pcmk_rc_ok;
@@ -2855,6 +2921,19 @@ op_history_xml(pcmk__output_t *out, va_list args) {
             crm_xml_add(node, PCMK_XA_QUEUE_TIME, s);
             free(s);
         }
+
+        for (int i = 0; i < PCMK__NELEM(op_rusage_attrs); i++) {
+            const char *name = op_rusage_attrs[i].name;
+
+            value = crm_element_value(xml_op, name);
+            if (value) {
+                char *s = crm_strdup_printf("%s%s", value,
+                                            pcmk__s(op_rusage_attrs[i].units,
+                                                    ""));
+                crm_xml_add(node, name, s);
+                free(s);
+            }
+        }
     }
 
     return pcmk_rc_ok;
@@ -373,6 +373,7 @@ cleanup_calculations(pcmk_scheduler_t *scheduler)
 
     pe__free_param_checks(scheduler);
     g_list_free(scheduler->priv->stop_needed);
+    g_list_free(scheduler->priv->lazy_history);
     crm_time_free(scheduler->priv->now);
     pcmk__xml_free(scheduler->input);
     pcmk__xml_free(scheduler->priv->failed);
@@ -421,6 +422,8 @@ set_working_set_defaults(pcmk_scheduler_t *scheduler)
     pcmk__scheduler_private_t *priv = scheduler->priv;
     pcmk__output_t *out = priv->out;
     char *local_node_name = scheduler->priv->local_node_name;
+    bool (*cancel_check)(pcmk_scheduler_t *, void *) = priv->cancel_check;
+    void *cancel_data = priv->cancel_data;
 
     // Wipe the main structs (any other members must have previously been freed)
     memset(scheduler, 0, sizeof(pcmk_scheduler_t));
@@ -430,6 +433,8 @@ set_working_set_defaults(pcmk_scheduler_t *scheduler)
     scheduler->priv = priv;
     scheduler->priv->out = out;
     scheduler->priv->local_node_name = local_node_name;
+    scheduler->priv->cancel_check = cancel_check;
+    scheduler->priv->cancel_data = cancel_data;
 
     // Set defaults for everything else
     scheduler->priv->next_ordering_id = 1;
@@ -0,0 +1,193 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/common/scheduler.h>
+#include <crm/common/xml.h>
+#include <crm/pengine/internal.h>
+#include <crm/pengine/status.h>
+
+// Scheduler data from the same input, unpacked fully and without history
+pcmk_scheduler_t *full = NULL;
+pcmk_scheduler_t *lazy = NULL;
+
+static pcmk_scheduler_t *
+unpack_input(const xmlNode *input, uint64_t flags)
+{
+    pcmk_scheduler_t *scheduler = pe_new_working_set();
+
+    if (scheduler != NULL) {
+        pcmk__set_scheduler_flags(scheduler, pcmk__sched_no_counts|flags);
+        scheduler->input = pcmk__xml_copy(NULL, input);
+        cluster_status(scheduler);
+    }
+    return scheduler;
+}
+
+static int
+setup(void **state)
+{
+    char *path = NULL;
+    xmlNode *input = NULL;
+
+    pcmk__xml_init();
+
+    path = crm_strdup_printf("%s/crm_mon.xml", getenv("PCMK_CTS_CLI_DIR"));
+    input = pcmk__xml_read(path);
+    free(path);
+
+    if (input == NULL) {
+        return 1;
+    }
+
+    full = unpack_input(input, pcmk__sched_none);
+    lazy = unpack_input(input, pcmk__sched_no_history);
+    pcmk__xml_free(input);
+
+    return ((full == NULL) || (lazy == NULL))? 1 : 0;
+}
+
+static int
+teardown(void **state)
+{
+    pe_free_working_set(full);
+    pe_free_working_set(lazy);
+    pcmk__xml_cleanup();
+    return 0;
+}
+
+static pcmk_resource_t *
+find_rsc(pcmk_scheduler_t *scheduler, const char *id)
+{
+    pcmk_resource_t *rsc = pe_find_resource(scheduler->priv->resources, id);
+
+    assert_non_null(rsc);
+    return rsc;
+}
+
+// Assert that a resource is active on the same nodes in both scheduler data
+static void
+assert_same_state(const char *id)
+{
+    const pcmk_resource_t *full_rsc = find_rsc(full, id);
+    const pcmk_resource_t *lazy_rsc = find_rsc(lazy, id);
+    const GList *lazy_iter = lazy_rsc->priv->active_nodes;
+
+    assert_int_equal(full_rsc->priv->orig_role, lazy_rsc->priv->orig_role);
+    assert_int_equal(g_list_length(full_rsc->priv->active_nodes),
+                     g_list_length(lazy_rsc->priv->active_nodes));
+
+    for (const GList *iter = full_rsc->priv->active_nodes; iter != NULL;
+         iter = iter->next) {
+
+        const pcmk_node_t *full_node = iter->data;
+        const pcmk_node_t *lazy_node = lazy_iter->data;
+
+        assert_string_equal(full_node->priv->name, lazy_node->priv->name);
+        lazy_iter = lazy_iter->next;
+    }
+}
+
+static void
+null_rsc_asserts(void **state)
+{
+    pcmk__assert_asserts(pe__unpack_rsc_history(NULL));
+}
+
+static void
+node_state_unpacked(void **state)
+{
+    for (const GList *iter = full->nodes; iter != NULL; iter = iter->next) {
+        const pcmk_node_t *full_node = iter->data;
+        const pcmk_node_t *lazy_node = pcmk_find_node(lazy,
+                                                      full_node->priv->name);
+
+        assert_non_null(lazy_node);
+        assert_int_equal(full_node->details->online,
+                         lazy_node->details->online);
+        assert_int_equal(full_node->details->unclean,
+                         lazy_node->details->unclean);
+        assert_int_equal(full_node->details->standby,
+                         lazy_node->details->standby);
+    }
+
+    // Guest nodes are online only if their connections' history is unpacked
+    assert_true(pcmk_find_node(lazy, "httpd-bundle-0")->details->online);
+}
+
+static void
+history_skipped(void **state)
+{
+    assert_non_null(find_rsc(full, "dummy")->priv->active_nodes);
+    assert_null(find_rsc(lazy, "dummy")->priv->active_nodes);
+    assert_null(find_rsc(lazy, "Public-IP")->priv->active_nodes);
+    assert_int_equal(xmlChildElementCount(lazy->priv->failed), 0);
+}
+
+static void
+primitive_history(void **state)
+{
+    pe__unpack_rsc_history(find_rsc(lazy, "dummy"));
+    assert_same_state("dummy");
+
+    // Unpacking again changes nothing
+    pe__unpack_rsc_history(find_rsc(lazy, "dummy"));
+    assert_same_state("dummy");
+
+    // Other resources are still skipped
+    assert_null(find_rsc(lazy, "Public-IP")->priv->active_nodes);
+}
+
+static void
+group_member_history(void **state)
+{
+    // Unpacking a member unpacks the entire group
+    pe__unpack_rsc_history(find_rsc(lazy, "Email"));
+    assert_same_state("exim-group");
+    assert_same_state("Public-IP");
+    assert_same_state("Email");
+}
+
+static void
+clone_history(void **state)
+{
+    const pcmk_resource_t *clone = find_rsc(lazy, "promotable-clone");
+
+    pe__unpack_rsc_history(find_rsc(lazy, "promotable-rsc"));
+
+    // Instances are numbered the same way as when unpacking everything
+    for (const GList *iter = clone->priv->children; iter != NULL;
+         iter = iter->next) {
+
+        const pcmk_resource_t *instance = iter->data;
+
+        assert_same_state(instance->id);
+    }
+}
+
+static void
+full_unpack_unaffected(void **state)
+{
+    pcmk_resource_t *rsc = find_rsc(full, "dummy");
+
+    pe__unpack_rsc_history(rsc);
+    assert_false(pcmk_is_set(rsc->flags, pcmk__rsc_history_unpacked));
+    assert_int_equal(g_list_length(rsc->priv->active_nodes), 1);
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(null_rsc_asserts),
+                cmocka_unit_test(node_state_unpacked),
+                cmocka_unit_test(history_skipped),
+                cmocka_unit_test(primitive_history),
+                cmocka_unit_test(group_member_history),
+                cmocka_unit_test(clone_history),
+                cmocka_unit_test(full_unpack_unaffected))
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2024 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/pengine/internal.h>
+
+static pcmk_action_t first = { .id = 1, .uuid = (char *) "first" };
+static pcmk_action_t then = { .id = 2, .uuid = (char *) "then" };
+static pcmk_action_t other = { .id = 3, .uuid = (char *) "other" };
+
+static void
+clear_orderings(pcmk_action_t *action)
+{
+    g_list_free_full(action->actions_before, free);
+    action->actions_before = NULL;
+    g_list_free_full(action->actions_after, free);
+    action->actions_after = NULL;
+    if (action->after_flags != NULL) {
+        g_hash_table_destroy(action->after_flags);
+        action->after_flags = NULL;
+    }
+}
+
+static int
+teardown(void **state)
+{
+    clear_orderings(&first);
+    clear_orderings(&then);
+    clear_orderings(&other);
+    return 0;
+}
+
+static void
+invalid_arguments(void **state)
+{
+    assert_false(order_actions(&first, &then, pcmk__ar_none));
+    assert_false(order_actions(NULL, &then, pcmk__ar_ordered));
+    assert_false(order_actions(&first, NULL, pcmk__ar_ordered));
+    assert_null(first.actions_after);
+    assert_null(then.actions_before);
+}
+
+static void
+new_ordering(void **state)
+{
+    pcmk__related_action_t *wrapper = NULL;
+
+    assert_true(order_actions(&first, &then, pcmk__ar_ordered));
+
+    assert_int_equal(g_list_length(first.actions_after), 1);
+    wrapper = first.actions_after->data;
+    assert_ptr_equal(wrapper->action, &then);
+    assert_int_equal(wrapper->flags, pcmk__ar_ordered);
+
+    assert_int_equal(g_list_length(then.actions_before), 1);
+    wrapper = then.actions_before->data;
+    assert_ptr_equal(wrapper->action, &first);
+    assert_int_equal(wrapper->flags, pcmk__ar_ordered);
+}
+
+static void
+duplicate_ordering(void **state)
+{
+    assert_true(order_actions(&first, &then,
+                              pcmk__ar_ordered|pcmk__ar_asymmetric));
+
+    // Any overlap with an existing ordering's flags is a duplicate
+    assert_false(order_actions(&first, &then, pcmk__ar_ordered));
+    assert_false(order_actions(&first, &then, pcmk__ar_asymmetric));
+    assert_false(order_actions(&first, &then,
+                               pcmk__ar_asymmetric
+                               |pcmk__ar_first_implies_then));
+    assert_int_equal(g_list_length(first.actions_after), 1);
+    assert_int_equal(g_list_length(then.actions_before), 1);
+}
+
+static void
+distinct_orderings(void **state)
+{
+    assert_true(order_actions(&first, &then, pcmk__ar_ordered));
+
+    // Orderings with no flags in common are kept separately
+    assert_true(order_actions(&first, &then, pcmk__ar_first_implies_then));
+    assert_int_equal(g_list_length(first.actions_after), 2);
+
+    // A later duplicate of either is detected
+    assert_false(order_actions(&first, &then, pcmk__ar_first_implies_then));
+    assert_false(order_actions(&first, &then, pcmk__ar_ordered));
+
+    // Orderings with other actions are independent
+    assert_true(order_actions(&first, &other, pcmk__ar_ordered));
+    assert_true(order_actions(&then, &first, pcmk__ar_ordered));
+    assert_int_equal(g_list_length(first.actions_after), 3);
+    assert_int_equal(g_list_length(first.actions_before), 1);
+}
+
+PCMK__UNIT_TEST(NULL, NULL,
+                cmocka_unit_test_teardown(invalid_arguments, teardown),
+                cmocka_unit_test_teardown(new_ordering, teardown),
+                cmocka_unit_test_teardown(duplicate_ordering, teardown),
+                cmocka_unit_test_teardown(distinct_orderings, teardown))
@@ -396,6 +396,11 @@ unpack_config(xmlNode *config, pcmk_scheduler_t *scheduler)
         pcmk__cluster_option(config_hash, PCMK_OPT_PLACEMENT_STRATEGY);
     crm_trace("Placement strategy: %s", scheduler->priv->placement_strategy);
 
+    value = pcmk__cluster_option(config_hash, PCMK_OPT_PLACEMENT_SEARCH_LIMIT);
+    pcmk__scan_min_int(value, &(scheduler->priv->placement_search_limit), 0);
+    crm_trace("Placement search limit is %d",
+              scheduler->priv->placement_search_limit);
+
     set_config_flag(scheduler, PCMK_OPT_SHUTDOWN_LOCK,
                     pcmk__sched_shutdown_lock);
     if (pcmk_is_set(scheduler->flags, pcmk__sched_shutdown_lock)) {
@@ -1368,6 +1373,14 @@ unpack_node_history(const xmlNode *status, bool fence,
         crm_trace("Unpacking resource history for %snode %s",
                   (fence? "unseen " : ""), id);
 
+        if (pcmk_is_set(scheduler->flags, pcmk__sched_no_history)) {
+            /* Remember the order, so that any history unpacked later assigns
+             * anonymous clone instances the same way a full unpack would
+             */
+            scheduler->priv->lazy_history =
+                g_list_append(scheduler->priv->lazy_history, (gpointer) state);
+        }
+
         pcmk__set_node_flags(this_node, pcmk__node_unpacked);
         unpack_node_lrm(this_node, state, scheduler);
 
@@ -1399,6 +1412,17 @@ unpack_status(xmlNode *status, pcmk_scheduler_t *scheduler)
                                    unpack_ticket_state, scheduler);
 
         } else if (pcmk__xe_is(state, PCMK__XE_NODE_STATE)) {
+            xmlNode *lrm = pcmk__xe_first_child(state, PCMK__XE_LRM, NULL,
+                                                NULL);
+
+            /* Convert any compact resource history to full format up front,
+             * so that unpack_rsc_op() and everything else that reads history
+             * entries (including by XPath) need to handle only one format
+             */
+            if (lrm != NULL) {
+                pcmk__expand_history(lrm,
+                                     crm_element_value(state, PCMK_XA_UNAME));
+            }
             unpack_node_state(state, scheduler);
         }
     }
@@ -2694,6 +2718,77 @@ unpack_shutdown_lock(const xmlNode *rsc_entry, pcmk_resource_t *rsc,
     }
 }
 
+/*!
+ * \internal
+ * \brief Find the resource that a resource history entry is for
+ *
+ * \param[in] rsc_id     ID of resource history entry
+ * \param[in] scheduler  Scheduler data
+ *
+ * \return Resource matching \p rsc_id or its base name (or NULL if none)
+ */
+static const pcmk_resource_t *
+find_history_rsc(const char *rsc_id, const pcmk_scheduler_t *scheduler)
+{
+    const pcmk_resource_t *rsc = NULL;
+    char *base = NULL;
+
+    rsc = pe_find_resource_with_flags(scheduler->priv->resources, rsc_id,
+                                      pcmk_rsc_match_history
+                                      |pcmk_rsc_match_basename);
+    if (rsc == NULL) {
+        // This could be a clone instance beyond the configured maximum
+        base = clone_strip(rsc_id);
+        rsc = pe_find_resource_with_flags(scheduler->priv->resources, base,
+                                          pcmk_rsc_match_history);
+        free(base);
+    }
+    return rsc;
+}
+
+/*!
+ * \internal
+ * \brief Check whether a resource's history is needed for node status
+ *
+ * \param[in] rsc  Resource to check
+ *
+ * \return true if \p rsc is a Pacemaker Remote connection or launches any
+ *         resources (such as a guest node connection), otherwise false
+ */
+static inline bool
+affects_node_status(const pcmk_resource_t *rsc)
+{
+    return pcmk_is_set(rsc->flags, pcmk__rsc_is_remote_connection)
+           || (rsc->priv->launched != NULL);
+}
+
+/*!
+ * \internal
+ * \brief Check whether a resource history entry should be unpacked now
+ *
+ * \param[in] rsc_id     ID of resource history entry
+ * \param[in] scheduler  Scheduler data
+ *
+ * \return true if the entry should be unpacked, otherwise false
+ */
+static bool
+history_wanted(const char *rsc_id, const pcmk_scheduler_t *scheduler)
+{
+    const pcmk_resource_t *rsc = NULL;
+
+    if (!pcmk_is_set(scheduler->flags, pcmk__sched_no_history)) {
+        return true;
+    }
+
+    rsc = find_history_rsc(rsc_id, scheduler);
+    if (rsc == NULL) {
+        return false; // Removed resources are shown only with full history
+    }
+    return affects_node_status(rsc)
+           || pcmk_is_set(pe__const_top_resource(rsc, true)->flags,
+                          pcmk__rsc_history_unpacked);
+}
+
 /*!
  * \internal
  * \brief Unpack one \c PCMK__XE_LRM_RESOURCE entry from a node's CIB status
@@ -2731,6 +2826,11 @@ unpack_lrm_resource(pcmk_node_t *node, const xmlNode *lrm_resource,
         crm_log_xml_info(lrm_resource, "missing-id");
         return NULL;
     }
+    if (!history_wanted(rsc_id, scheduler)) {
+        crm_trace("Skipping " PCMK__XE_LRM_RESOURCE " for %s on %s",
+                  rsc_id, pcmk__node_name(node));
+        return NULL;
+    }
     crm_trace("Unpacking " PCMK__XE_LRM_RESOURCE " for %s on %s",
               rsc_id, pcmk__node_name(node));
 
@@ -2851,6 +2951,69 @@ handle_removed_launched_resources(const xmlNode *lrm_rsc_list,
     }
 }
 
+/*!
+ * \internal
+ * \brief Unpack a resource's history if it was skipped earlier
+ *
+ * If resource history was skipped when unpacking the CIB status section
+ * (because \c pcmk__sched_no_history was set), unpack the history of a
+ * resource (including its entire collective resource, if any) on each node
+ * whose history was unpacked, in the same order. Nothing is done if the
+ * history has already been unpacked.
+ *
+ * \param[in,out] rsc  Resource whose history is needed
+ */
+void
+pe__unpack_rsc_history(pcmk_resource_t *rsc)
+{
+    pcmk_scheduler_t *scheduler = NULL;
+
+    pcmk__assert(rsc != NULL);
+
+    while (rsc->priv->parent != NULL) {
+        rsc = rsc->priv->parent;
+    }
+    scheduler = rsc->priv->scheduler;
+
+    if (!pcmk_is_set(scheduler->flags, pcmk__sched_no_history)
+        || pcmk_is_set(rsc->flags, pcmk__rsc_history_unpacked)) {
+        return;
+    }
+    pcmk__set_rsc_flags(rsc, pcmk__rsc_history_unpacked);
+
+    pcmk__rsc_trace(rsc, "Unpacking skipped resource history for %s",
+                    rsc->id);
+
+    for (GList *iter = scheduler->priv->lazy_history; iter != NULL;
+         iter = iter->next) {
+
+        const xmlNode *state = iter->data;
+        const xmlNode *xml = NULL;
+        pcmk_node_t *node = pe_find_node_any(scheduler->nodes,
+                                             pcmk__xe_id(state),
+                                             crm_element_value(state,
+                                                               PCMK_XA_UNAME));
+
+        xml = pcmk__xe_first_child(state, PCMK__XE_LRM, NULL, NULL);
+        xml = pcmk__xe_first_child(xml, PCMK__XE_LRM_RESOURCES, NULL, NULL);
+
+        for (const xmlNode *rsc_entry = pcmk__xe_first_child(xml,
+                                                             PCMK__XE_LRM_RESOURCE,
+                                                             NULL, NULL);
+             rsc_entry != NULL;
+             rsc_entry = pcmk__xe_next(rsc_entry, PCMK__XE_LRM_RESOURCE)) {
+
+            const pcmk_resource_t *match = NULL;
+
+            match = find_history_rsc(pcmk__xe_id(rsc_entry), scheduler);
+            if ((match != NULL) && !affects_node_status(match)
+                && (pe__const_top_resource(match, true) == rsc)) {
+                unpack_lrm_resource(node, rsc_entry, scheduler);
+            }
+        }
+    }
+}
+
 /*!
  * \internal
  * \brief Unpack one node's lrm status section
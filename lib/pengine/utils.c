@@ -463,9 +463,9 @@ get_target_role(const pcmk_resource_t *rsc, enum rsc_role_e *role)
 gboolean
 order_actions(pcmk_action_t *first, pcmk_action_t *then, uint32_t flags)
 {
-    GList *gIter = NULL;
     pcmk__related_action_t *wrapper = NULL;
     GList *list = NULL;
+    uint32_t existing = pcmk__ar_none;
 
     if (flags == pcmk__ar_none) {
         return FALSE;
@@ -481,16 +481,22 @@ order_actions(pcmk_action_t *first, pcmk_action_t *then, uint32_t flags)
     /* Ensure we never create a dependency on ourselves... it's happened */
     pcmk__assert(first != then);
 
-    /* Filter dups, otherwise update_action_states() has too much work to do */
-    gIter = first->actions_after;
-    for (; gIter != NULL; gIter = gIter->next) {
-        pcmk__related_action_t *after = gIter->data;
-
-        if ((after->action == then)
-            && pcmk_any_flags_set(after->flags, flags)) {
+    /* Filter dups, otherwise update_action_states() has too much work to do.
+     * Actions such as clone pseudo-actions and fencing can have thousands of
+     * orderings, so look up the combined flags of any existing orderings with
+     * "then" rather than scanning the list.
+     */
+    if (first->after_flags == NULL) {
+        first->after_flags = g_hash_table_new(NULL, NULL);
+    } else {
+        existing = GPOINTER_TO_UINT(g_hash_table_lookup(first->after_flags,
+                                                        then));
+        if (pcmk_any_flags_set(existing, flags)) {
             return FALSE;
         }
     }
+    g_hash_table_insert(first->after_flags, then,
+                        GUINT_TO_POINTER(existing|flags));
 
     wrapper = pcmk__assert_alloc(1, sizeof(pcmk__related_action_t));
     wrapper->action = then;
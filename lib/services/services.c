@@ -515,6 +515,10 @@ services_action_cleanup(svc_action_t * op)
     }
 #endif
 
+#if SUPPORT_SYSTEMD
+    services__systemd_cancel_reload_wait(op);
+#endif
+
     if (op->opaque->stderr_gsource) {
         mainloop_del_fd(op->opaque->stderr_gsource);
         op->opaque->stderr_gsource = NULL;
@@ -1319,6 +1323,21 @@ services__exit_reason(const svc_action_t *action)
     return action->opaque->exit_reason;
 }
 
+/*!
+ * \internal
+ * \brief Get the resource usage of an action's most recent execution
+ *
+ * \param[in] action  Action to check
+ *
+ * \return Resource usage of \p action's agent process (all zero if the action
+ *         did not run as a child process or usage is not available)
+ */
+const pcmk__rusage_t *
+services__rusage(const svc_action_t *action)
+{
+    return &(action->opaque->rusage);
+}
+
 /*!
  * \internal
  * \brief Steal stdout from an action
@@ -713,6 +713,8 @@ async_action_complete(mainloop_child_t *p, pid_t pid, int core, int signo,
 
     close_op_input(op);
 
+    op->opaque->rusage = *pcmk__mainloop_child_rusage(p);
+
     if (signo == 0) {
         crm_debug("%s[%d] exited with status %d", op->id, op->pid, exitcode);
         services__set_result(op, exitcode, PCMK_EXEC_DONE, NULL);
@@ -1084,7 +1086,8 @@ wait_for_sync_result(svc_action_t *op, struct sigchld_data_s *data)
 
             if ((fds[2].revents & POLLIN)
                 && sigchld_received(fds[2].fd, op->pid, data)) {
-                wait_rc = waitpid(op->pid, &status, WNOHANG);
+                wait_rc = pcmk__wait_rusage(op->pid, &status, WNOHANG,
+                                            &(op->opaque->rusage));
 
                 if ((wait_rc > 0) || ((wait_rc < 0) && (errno == ECHILD))) {
                     // Child process exited or doesn't exist
@@ -1207,12 +1210,21 @@ wait_for_sync_result(svc_action_t *op, struct sigchld_data_s *data)
 int
 services__execute_file(svc_action_t *op)
 {
+    static pcmk__metric_t fork_metric =
+        PCMK__METRIC(pcmk__metric_histogram, "services_fork_us",
+                     "Time taken by fork() when executing an agent "
+                     "(microseconds)");
+    static pcmk__metric_t fork_failures =
+        PCMK__METRIC(pcmk__metric_counter, "services_fork_failures_total",
+                     "Agent executions that could not fork");
+
     int stdout_fd[2];
     int stderr_fd[2];
     int stdin_fd[2] = {-1, -1};
     int rc;
     struct stat st;
     struct sigchld_data_s data = { .ignored = false };
+    gint64 fork_start = 0;
 
     // Catch common failure conditions early
     if (stat(op->opaque->exec, &st) != 0) {
@@ -1266,10 +1278,12 @@ services__execute_file(svc_action_t *op)
         goto done;
     }
 
+    fork_start = g_get_monotonic_time();
     op->pid = fork();
     switch (op->pid) {
         case -1:
             rc = errno;
+            pcmk__metric_add(&fork_failures, 1);
             close_pipe(stdin_fd);
             close_pipe(stdout_fd);
             close_pipe(stderr_fd);
@@ -1324,6 +1338,7 @@ services__execute_file(svc_action_t *op)
     }
 
     /* Only the parent reaches here */
+    pcmk__metric_observe_since(&fork_metric, fork_start);
     close(stdout_fd[1]);
     close(stderr_fd[1]);
     if (stdin_fd[0] >= 0) {
@@ -18,6 +18,7 @@
 #include <dbus/dbus.h>              // DBusPendingCall
 #endif
 
+#include <crm/common/internal.h>    // pcmk__rusage_t
 #include <crm/common/mainloop.h>    // mainloop_io_t 
 #include <crm/services.h>           // svc_action_t
 
@@ -45,9 +46,12 @@ struct svc_action_private_s {
     mainloop_io_t *stdout_gsource;
 
     int stdin_fd;
+
+    pcmk__rusage_t rusage;  // Resource usage of most recent execution
 #if HAVE_DBUS
     DBusPendingCall* pending;
     unsigned timerid;
+    gint64 reload_wait_start;   // When action began waiting for systemd reload
 #endif
 };
 
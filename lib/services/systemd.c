@@ -69,6 +69,24 @@ systemd_new_method(const char *method)
                                         method);
 }
 
+/* Writing or removing a unit override requires a systemd reload, which makes
+ * systemd re-parse every unit file on the system. When many systemd resources
+ * are started or stopped at once, reloading for each one would serialize them
+ * behind dozens of reloads. Instead, asynchronous actions that changed an
+ * override wait in reload_waiting, and one reload is sent for all of those that
+ * arrive within RELOAD_DELAY_MS. When it completes, each waiting action sends
+ * its unit method. Actions that arrive while a reload is in progress wait for
+ * the next one, because the one in progress might not see their override.
+ */
+#define RELOAD_DELAY_MS 50
+
+static GList *reload_waiting = NULL;        // Actions needing next reload
+static GList *reload_in_progress = NULL;    // Actions waiting on current reload
+static guint reload_timer = 0;              // Timer to send next reload
+static DBusPendingCall *reload_pending = NULL;  // Current reload, if any
+
+static gboolean send_coalesced_reload(gpointer user_data);
+
 /*
  * Functions to manage a static DBus connection
  */
@@ -133,6 +151,371 @@ systemd_call_simple_method(const char *method)
     return reply;
 }
 
+/*
+ * Unit state cache
+ *
+ * Each systemd monitor would otherwise need a LoadUnit and a GetProperty round
+ * trip to systemd. Instead, we subscribe to systemd's signals, remember the
+ * ActiveState of each unit we monitor, and keep it current from the
+ * PropertiesChanged signals systemd emits for the unit. Monitors are answered
+ * from the cache when it has a state for the unit, and queried from systemd
+ * otherwise (the first time, after the unit is unloaded, or after systemd or
+ * the bus connection goes away, all of which empty the cache).
+ */
+
+#define BUS_NAME_PROPERTIES "org.freedesktop.DBus.Properties"
+
+struct unit_state {
+    char *name;             // Unit name (with extension)
+    char *path;             // Unit's DBus object path
+    char *active_state;     // Unit's last known ActiveState (NULL if unknown)
+};
+
+static GHashTable *units_by_path = NULL;    // Path -> struct unit_state
+static GHashTable *units_by_name = NULL;    // Name -> same (not owned)
+static bool unit_signals_subscribed = false;
+
+static void request_unit_signals(void);
+
+static void
+free_unit_state(gpointer data)
+{
+    struct unit_state *unit = data;
+
+    free(unit->name);
+    free(unit->path);
+    free(unit->active_state);
+    free(unit);
+}
+
+// Forget everything in the unit state cache
+static void
+clear_unit_cache(void)
+{
+    if (units_by_name != NULL) {
+        g_hash_table_remove_all(units_by_name);
+    }
+    if (units_by_path != NULL) {
+        g_hash_table_remove_all(units_by_path);
+    }
+}
+
+// Forget one unit in the unit state cache
+static void
+forget_unit(struct unit_state *unit)
+{
+    crm_trace("Forgetting cached state of systemd unit %s", unit->name);
+    g_hash_table_remove(units_by_name, unit->name);
+    g_hash_table_remove(units_by_path, unit->path);
+}
+
+/*!
+ * \internal
+ * \brief Track the state of a unit in the cache
+ *
+ * \param[in] name  Unit name (with extension)
+ * \param[in] path  Unit's DBus object path
+ */
+static void
+remember_unit(const char *name, const char *path)
+{
+    struct unit_state *unit = NULL;
+
+    if (!unit_signals_subscribed) {
+        return;
+    }
+    if (units_by_path == NULL) {
+        units_by_path = pcmk__strkey_table(NULL, free_unit_state);
+        units_by_name = pcmk__strkey_table(NULL, NULL);
+    }
+
+    unit = g_hash_table_lookup(units_by_name, name);
+    if ((unit != NULL) && pcmk__str_eq(unit->path, path, pcmk__str_none)) {
+        return;
+    }
+    if (unit != NULL) {
+        forget_unit(unit);
+    }
+
+    unit = pcmk__assert_alloc(1, sizeof(struct unit_state));
+    unit->name = pcmk__str_copy(name);
+    unit->path = pcmk__str_copy(path);
+    g_hash_table_insert(units_by_path, unit->path, unit);
+    g_hash_table_insert(units_by_name, unit->name, unit);
+}
+
+/*!
+ * \internal
+ * \brief Update the cached ActiveState of a tracked unit
+ *
+ * \param[in,out] unit   Unit to update
+ * \param[in]     state  New ActiveState (or NULL if unknown)
+ */
+static void
+set_cached_state(struct unit_state *unit, const char *state)
+{
+    if (!pcmk__str_eq(unit->active_state, state, pcmk__str_null_matches)) {
+        crm_trace("Systemd unit %s is now %s",
+                  unit->name, pcmk__s(state, "unknown"));
+    }
+    pcmk__str_update(&(unit->active_state), state);
+}
+
+/*!
+ * \internal
+ * \brief Get the cached ActiveState of a unit
+ *
+ * \param[in] name  Unit name (with extension)
+ *
+ * \return Cached ActiveState of \p name (or NULL if not known)
+ */
+static const char *
+cached_state(const char *name)
+{
+    struct unit_state *unit = NULL;
+
+    if (!unit_signals_subscribed || (units_by_name == NULL)) {
+        return NULL;
+    }
+    unit = g_hash_table_lookup(units_by_name, name);
+    return (unit == NULL)? NULL : unit->active_state;
+}
+
+/*!
+ * \internal
+ * \brief Update the cache from a unit's PropertiesChanged signal
+ *
+ * \param[in,out] msg   Signal message
+ * \param[in,out] unit  Unit that signal is for
+ */
+static void
+process_properties_changed(DBusMessage *msg, struct unit_state *unit)
+{
+    DBusMessageIter args;
+    DBusMessageIter dict;
+    DBusMessageIter invalidated;
+
+    // Signature is (s interface, a{sv} changed, as invalidated)
+    if (!dbus_message_iter_init(msg, &args)
+        || !pcmk_dbus_type_check(msg, &args, DBUS_TYPE_STRING,
+                                 __func__, __LINE__)
+        || !dbus_message_iter_next(&args)
+        || !pcmk_dbus_type_check(msg, &args, DBUS_TYPE_ARRAY,
+                                 __func__, __LINE__)) {
+        forget_unit(unit);
+        return;
+    }
+
+    dbus_message_iter_recurse(&args, &dict);
+    while (dbus_message_iter_get_arg_type(&dict) == DBUS_TYPE_DICT_ENTRY) {
+        DBusMessageIter entry;
+        DBusMessageIter variant;
+        const char *property = NULL;
+        const char *value = NULL;
+
+        dbus_message_iter_recurse(&dict, &entry);
+        dbus_message_iter_get_basic(&entry, &property);
+        dbus_message_iter_next(&entry);
+        dbus_message_iter_recurse(&entry, &variant);
+
+        if (pcmk__str_eq(property, "ActiveState", pcmk__str_none)) {
+            if (dbus_message_iter_get_arg_type(&variant) == DBUS_TYPE_STRING) {
+                dbus_message_iter_get_basic(&variant, &value);
+            }
+            set_cached_state(unit, value);
+        }
+        dbus_message_iter_next(&dict);
+    }
+
+    if (!dbus_message_iter_next(&args)
+        || (dbus_message_iter_get_arg_type(&args) != DBUS_TYPE_ARRAY)) {
+        return;
+    }
+    dbus_message_iter_recurse(&args, &invalidated);
+    while (dbus_message_iter_get_arg_type(&invalidated) == DBUS_TYPE_STRING) {
+        const char *property = NULL;
+
+        dbus_message_iter_get_basic(&invalidated, &property);
+        if (pcmk__str_eq(property, "ActiveState", pcmk__str_none)) {
+            set_cached_state(unit, NULL);
+        }
+        dbus_message_iter_next(&invalidated);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Keep the unit state cache current from systemd signals
+ *
+ * \param[in]     connection  DBus connection that signal arrived on
+ * \param[in,out] msg         Message to check
+ * \param[in]     user_data   Ignored
+ *
+ * \return DBUS_HANDLER_RESULT_NOT_YET_HANDLED (so others may handle \p msg)
+ */
+static DBusHandlerResult
+unit_signal_filter(DBusConnection *connection, DBusMessage *msg,
+                   void *user_data)
+{
+    const char *path = dbus_message_get_path(msg);
+    struct unit_state *unit = NULL;
+
+    if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_SIGNAL) {
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+
+    /* Unit signals matter only once a unit is tracked, but a systemd restart
+     * must be noticed even before then
+     */
+    if (dbus_message_is_signal(msg, BUS_NAME_PROPERTIES, "PropertiesChanged")) {
+        if ((path != NULL) && (units_by_path != NULL)) {
+            unit = g_hash_table_lookup(units_by_path, path);
+        }
+        if (unit != NULL) {
+            process_properties_changed(msg, unit);
+        }
+
+    } else if (dbus_message_is_signal(msg, BUS_NAME_MANAGER, "UnitNew")
+               || dbus_message_is_signal(msg, BUS_NAME_MANAGER,
+                                         "UnitRemoved")) {
+        const char *name = NULL;
+        const char *unit_path = NULL;
+
+        /* A unit that was (re)loaded or unloaded has no state we can trust,
+         * so drop it and let the next monitor query systemd.
+         */
+        if ((units_by_name != NULL)
+            && dbus_message_get_args(msg, NULL,
+                                     DBUS_TYPE_STRING, &name,
+                                     DBUS_TYPE_OBJECT_PATH, &unit_path,
+                                     DBUS_TYPE_INVALID)) {
+            unit = g_hash_table_lookup(units_by_name, name);
+            if (unit != NULL) {
+                forget_unit(unit);
+            }
+        }
+
+    } else if (dbus_message_is_signal(msg, DBUS_INTERFACE_DBUS,
+                                      "NameOwnerChanged")) {
+        const char *name = NULL;
+        const char *old_owner = NULL;
+        const char *new_owner = NULL;
+
+        /* If systemd left the bus, nothing cached can be trusted. A new
+         * systemd instance knows nothing of our subscription, so subscribe
+         * again once it is on the bus.
+         */
+        if (dbus_message_get_args(msg, NULL,
+                                  DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_STRING, &old_owner,
+                                  DBUS_TYPE_STRING, &new_owner,
+                                  DBUS_TYPE_INVALID)
+            && pcmk__str_eq(name, BUS_NAME, pcmk__str_none)) {
+            crm_info("Systemd DBus owner changed, clearing unit state cache");
+            unit_signals_subscribed = false;
+            clear_unit_cache();
+            if (!pcmk__str_empty(new_owner)) {
+                request_unit_signals();
+            }
+        }
+    }
+    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+/*!
+ * \internal
+ * \brief Enable the unit state cache once systemd accepts our subscription
+ *
+ * \param[in,out] pending    Subscribe call
+ * \param[in]     user_data  Ignored
+ */
+static void
+subscribe_complete(DBusPendingCall *pending, void *user_data)
+{
+    DBusError error;
+    DBusMessage *reply = NULL;
+
+    dbus_error_init(&error);
+    if (pending != NULL) {
+        reply = dbus_pending_call_steal_reply(pending);
+    }
+
+    if (pcmk_dbus_find_error(pending, reply, &error)) {
+        crm_info("Not caching systemd unit states: %s", error.message);
+        dbus_error_free(&error);
+
+    } else {
+        crm_debug("Caching systemd unit states");
+        unit_signals_subscribed = true;
+    }
+
+    if (pending != NULL) {
+        dbus_pending_call_unref(pending);
+    }
+    if (reply != NULL) {
+        dbus_message_unref(reply);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Ask systemd to emit unit signals to us
+ *
+ * Systemd emits unit signals only to clients that have subscribed. The unit
+ * state cache is enabled once systemd accepts the subscription.
+ */
+static void
+request_unit_signals(void)
+{
+    DBusMessage *msg = systemd_new_method("Subscribe");
+
+    pcmk__assert(msg != NULL);
+    if (systemd_send(msg, subscribe_complete, NULL,
+                     DBUS_TIMEOUT_USE_DEFAULT) == NULL) {
+        crm_info("Not caching systemd unit states: could not subscribe");
+    }
+    dbus_message_unref(msg);
+}
+
+/*!
+ * \internal
+ * \brief Subscribe to the systemd signals that keep the unit state cache
+ *
+ * \param[in,out] connection  Newly established connection to system bus
+ */
+static void
+subscribe_unit_signals(DBusConnection *connection)
+{
+    unit_signals_subscribed = false;
+    clear_unit_cache();
+
+    // Without an error argument, these are sent without waiting for a reply
+    dbus_bus_add_match(connection,
+                       "type='signal',sender='" BUS_NAME "',"
+                       "interface='" BUS_NAME_PROPERTIES "',"
+                       "member='PropertiesChanged',"
+                       "arg0='" BUS_NAME_UNIT "'", NULL);
+    dbus_bus_add_match(connection,
+                       "type='signal',sender='" BUS_NAME "',"
+                       "interface='" BUS_NAME_MANAGER "',member='UnitNew'",
+                       NULL);
+    dbus_bus_add_match(connection,
+                       "type='signal',sender='" BUS_NAME "',"
+                       "interface='" BUS_NAME_MANAGER "',member='UnitRemoved'",
+                       NULL);
+    dbus_bus_add_match(connection,
+                       "type='signal',sender='" DBUS_SERVICE_DBUS "',"
+                       "interface='" DBUS_INTERFACE_DBUS "',"
+                       "member='NameOwnerChanged',arg0='" BUS_NAME "'", NULL);
+
+    if (!dbus_connection_add_filter(connection, unit_signal_filter, NULL,
+                                    NULL)) {
+        crm_info("Not caching systemd unit states: could not add filter");
+        return;
+    }
+    request_unit_signals();
+}
+
 static gboolean
 systemd_init(void)
 {
@@ -142,6 +525,8 @@ systemd_init(void)
     if (systemd_proxy
         && dbus_connection_get_is_connected(systemd_proxy) == FALSE) {
         crm_warn("Connection to System DBus is closed. Reconnecting...");
+        unit_signals_subscribed = false;
+        clear_unit_cache();
         pcmk_dbus_disconnect(systemd_proxy);
         systemd_proxy = NULL;
         need_init = 1;
@@ -150,6 +535,9 @@ systemd_init(void)
     if (need_init) {
         need_init = 0;
         systemd_proxy = pcmk_dbus_connect();
+        if (systemd_proxy != NULL) {
+            subscribe_unit_signals(systemd_proxy);
+        }
     }
     if (systemd_proxy == NULL) {
         return FALSE;
@@ -171,6 +559,30 @@ systemd_get_property(const char *unit, const char *name,
 void
 systemd_cleanup(void)
 {
+    if (reload_timer != 0) {
+        g_source_remove(reload_timer);
+        reload_timer = 0;
+    }
+    if (reload_pending != NULL) {
+        dbus_pending_call_cancel(reload_pending);
+        dbus_pending_call_unref(reload_pending);
+        reload_pending = NULL;
+    }
+    g_list_free(reload_waiting);
+    reload_waiting = NULL;
+    g_list_free(reload_in_progress);
+    reload_in_progress = NULL;
+
+    unit_signals_subscribed = false;
+    if (units_by_name != NULL) {
+        g_hash_table_destroy(units_by_name);
+        units_by_name = NULL;
+    }
+    if (units_by_path != NULL) {
+        g_hash_table_destroy(units_by_path);
+        units_by_path = NULL;
+    }
+
     if (systemd_proxy) {
         pcmk_dbus_disconnect(systemd_proxy);
         systemd_proxy = NULL;
@@ -277,19 +689,34 @@ systemd_daemon_reload_complete(DBusPendingCall *pending, void *user_data)
     }
 }
 
-static bool
-systemd_daemon_reload(int timeout)
+/*!
+ * \internal
+ * \brief Ask systemd to reload its unit files
+ *
+ * \param[in] timeout  Timeout (in milliseconds) for reload reply
+ * \param[in] done     Function to call with reply (which must accept the
+ *                     reload's sequence number as its user data argument)
+ *
+ * \return Pending call for reload (or NULL if it could not be sent)
+ */
+static DBusPendingCall *
+systemd_daemon_reload(int timeout,
+                      void (*done)(DBusPendingCall *pending, void *user_data))
 {
+    static pcmk__metric_t reloads =
+        PCMK__METRIC(pcmk__metric_counter, "services_systemd_reloads_total",
+                     "Reloads requested from systemd");
     static unsigned int reload_count = 0;
     DBusMessage *msg = systemd_new_method("Reload");
+    DBusPendingCall *pending = NULL;
 
     reload_count++;
+    pcmk__metric_add(&reloads, 1);
     pcmk__assert(msg != NULL);
-    systemd_send(msg, systemd_daemon_reload_complete,
-                 GUINT_TO_POINTER(reload_count), timeout);
+    pending = systemd_send(msg, done, GUINT_TO_POINTER(reload_count), timeout);
     dbus_message_unref(msg);
 
-    return TRUE;
+    return pending;
 }
 
 /*!
@@ -797,7 +1224,7 @@ unit_method_complete(DBusPendingCall *pending, void *user_data)
     }
 }
 
-#define SYSTEMD_OVERRIDE_ROOT "/run/systemd/system/"
+#define SYSTEMD_OVERRIDE_ROOT "/run/systemd/system"
 
 /* When the cluster manages a systemd resource, we create a unit file override
  * to order the service "before" pacemaker. The "before" relationship won't
@@ -827,11 +1254,37 @@ create_world_readable(const char *filename)
     return fp;
 }
 
+// Where unit overrides are written, if not SYSTEMD_OVERRIDE_ROOT (for testing)
+static char *override_root_dir = NULL;
+
+/*!
+ * \internal
+ * \brief Write unit overrides somewhere other than the systemd runtime directory
+ *
+ * \param[in] dir  Directory to use (or NULL to restore the default)
+ *
+ * \note This is for unit tests that cannot write to the real directory.
+ */
+void
+services__set_systemd_override_root(const char *dir)
+{
+    free(override_root_dir);
+    override_root_dir = pcmk__str_copy(dir);
+}
+
+// Get the directory where unit overrides are written
+static const char *
+override_root(void)
+{
+    return (override_root_dir == NULL)? SYSTEMD_OVERRIDE_ROOT
+                                      : override_root_dir;
+}
+
 static void
 create_override_dir(const char *agent)
 {
-    char *override_dir = crm_strdup_printf(SYSTEMD_OVERRIDE_ROOT
-                                           "/%s.service.d", agent);
+    char *override_dir = crm_strdup_printf("%s/%s.service.d",
+                                           override_root(), agent);
     int rc = pcmk__build_path(override_dir, 0755);
 
     if (rc != pcmk_rc_ok) {
@@ -844,15 +1297,25 @@ create_override_dir(const char *agent)
 static char *
 get_override_filename(const char *agent)
 {
-    return crm_strdup_printf(SYSTEMD_OVERRIDE_ROOT
-                             "/%s.service.d/50-pacemaker.conf", agent);
+    return crm_strdup_printf("%s/%s.service.d/50-pacemaker.conf",
+                             override_root(), agent);
 }
 
-static void
-systemd_create_override(const char *agent, int timeout)
+/*!
+ * \internal
+ * \brief Create a unit override for a cluster-managed systemd unit
+ *
+ * \param[in] agent  Systemd unit name (without ".service")
+ *
+ * \return true if the override was written (so systemd must be reloaded),
+ *         otherwise false
+ */
+static bool
+systemd_create_override(const char *agent)
 {
     FILE *file_strm = NULL;
     char *override_file = get_override_filename(agent);
+    bool written = false;
 
     create_override_dir(agent);
 
@@ -875,14 +1338,24 @@ systemd_create_override(const char *agent, int timeout)
         }
         fflush(file_strm);
         fclose(file_strm);
-        systemd_daemon_reload(timeout);
+        written = true;
     }
 
     free(override_file);
+    return written;
 }
 
-static void
-systemd_remove_override(const char *agent, int timeout)
+/*!
+ * \internal
+ * \brief Remove the unit override for a cluster-managed systemd unit
+ *
+ * \param[in] agent  Systemd unit name (without ".service")
+ *
+ * \return true if the override was removed (so systemd must be reloaded),
+ *         otherwise false
+ */
+static bool
+systemd_remove_override(const char *agent)
 {
     char *override_file = get_override_filename(agent);
     int rc = unlink(override_file);
@@ -891,10 +1364,36 @@ systemd_remove_override(const char *agent, int timeout)
         // Stop may be called when already stopped, which is fine
         crm_perror(LOG_DEBUG, "Cannot remove systemd override file %s",
                    override_file);
-    } else {
-        systemd_daemon_reload(timeout);
     }
     free(override_file);
+    return (rc == 0);
+}
+
+/*!
+ * \internal
+ * \brief Set a status action's result based on a unit's ActiveState
+ *
+ * \param[in,out] op     Status action to set result for
+ * \param[in]     state  Unit's ActiveState (or NULL if unknown)
+ */
+static void
+set_result_from_state(svc_action_t *op, const char *state)
+{
+    if (pcmk__str_eq(state, "active", pcmk__str_none)) {
+        services__set_result(op, PCMK_OCF_OK, PCMK_EXEC_DONE, NULL);
+
+    } else if (pcmk__str_eq(state, "reloading", pcmk__str_none)) {
+        services__set_result(op, PCMK_OCF_OK, PCMK_EXEC_DONE, NULL);
+
+    } else if (pcmk__str_eq(state, "activating", pcmk__str_none)) {
+        services__set_result(op, PCMK_OCF_UNKNOWN, PCMK_EXEC_PENDING, NULL);
+
+    } else if (pcmk__str_eq(state, "deactivating", pcmk__str_none)) {
+        services__set_result(op, PCMK_OCF_UNKNOWN, PCMK_EXEC_PENDING, NULL);
+
+    } else {
+        services__set_result(op, PCMK_OCF_NOT_RUNNING, PCMK_EXEC_DONE, state);
+    }
 }
 
 /*!
@@ -912,33 +1411,288 @@ static void
 parse_status_result(const char *name, const char *state, void *userdata)
 {
     svc_action_t *op = userdata;
+    char *unit_name = systemd_service_name(op->agent, false);
+    struct unit_state *unit = NULL;
 
     crm_trace("Resource %s has %s='%s'",
               pcmk__s(op->rsc, "(unspecified)"), name,
               pcmk__s(state, "<null>"));
 
-    if (pcmk__str_eq(state, "active", pcmk__str_none)) {
-        services__set_result(op, PCMK_OCF_OK, PCMK_EXEC_DONE, NULL);
+    // Cache the state if invoke_unit_by_path() started tracking the unit
+    if (units_by_name != NULL) {
+        unit = g_hash_table_lookup(units_by_name, unit_name);
+        if (unit != NULL) {
+            set_cached_state(unit, state);
+        }
+    }
+    free(unit_name);
 
-    } else if (pcmk__str_eq(state, "reloading", pcmk__str_none)) {
-        services__set_result(op, PCMK_OCF_OK, PCMK_EXEC_DONE, NULL);
+    set_result_from_state(op, state);
 
-    } else if (pcmk__str_eq(state, "activating", pcmk__str_none)) {
-        services__set_result(op, PCMK_OCF_UNKNOWN, PCMK_EXEC_PENDING, NULL);
+    if (!(op->synchronous)) {
+        services_set_op_pending(op, NULL);
+        services__finalize_async_op(op);
+    }
+}
 
-    } else if (pcmk__str_eq(state, "deactivating", pcmk__str_none)) {
-        services__set_result(op, PCMK_OCF_UNKNOWN, PCMK_EXEC_PENDING, NULL);
+/*!
+ * \internal
+ * \brief Answer a status action from the unit state cache, if possible
+ *
+ * \param[in,out] op  Action to check
+ *
+ * \return true if \p op is a status action whose result has been set from the
+ *         cache, otherwise false
+ */
+static bool
+status_from_cache(svc_action_t *op)
+{
+    static pcmk__metric_t hits =
+        PCMK__METRIC(pcmk__metric_counter,
+                     "services_systemd_state_cache_hits_total",
+                     "Systemd monitors answered from the unit state cache");
+    static pcmk__metric_t misses =
+        PCMK__METRIC(pcmk__metric_counter,
+                     "services_systemd_state_cache_misses_total",
+                     "Systemd monitors that had to query systemd");
+    char *unit_name = NULL;
+    const char *state = NULL;
+
+    if (!pcmk__str_any_of(op->action, PCMK_ACTION_MONITOR, PCMK_ACTION_STATUS,
+                          NULL)) {
+        return false;
+    }
+
+    unit_name = systemd_service_name(op->agent, false);
+    state = cached_state(unit_name);
+    free(unit_name);
+
+    if (state == NULL) {
+        pcmk__metric_add(&misses, 1);
+        return false;
+    }
+
+    pcmk__metric_add(&hits, 1);
+    crm_trace("Resource %s has cached ActiveState='%s'",
+              pcmk__s(op->rsc, "(unspecified)"), state);
+    set_result_from_state(op, state);
+    return true;
+}
+
+/*!
+ * \internal
+ * \brief Get the systemd method name for a start, stop, or restart action
+ *
+ * \param[in] op  Action to check
+ *
+ * \return Systemd method name for \p op, or NULL if not one of those actions
+ */
+static const char *
+unit_method_name(const svc_action_t *op)
+{
+    if (pcmk__str_eq(op->action, PCMK_ACTION_START, pcmk__str_none)) {
+        return "StartUnit";
+    }
+    if (pcmk__str_eq(op->action, PCMK_ACTION_STOP, pcmk__str_none)) {
+        return "StopUnit";
+    }
+    if (pcmk__str_eq(op->action, "restart", pcmk__str_none)) {
+        return "RestartUnit";
+    }
+    return NULL;
+}
+
+/*!
+ * \internal
+ * \brief Send the systemd method for a start, stop, or restart action
+ *
+ * \param[in,out] op       Action to execute
+ * \param[in]     timeout  Timeout (in milliseconds) for method reply
+ */
+static void
+send_unit_method(svc_action_t *op, int timeout)
+{
+    DBusMessage *msg = systemd_new_method(unit_method_name(op));
+    DBusMessage *reply = NULL;
+
+    pcmk__assert(msg != NULL);
+
+    /* (ss) */
+    {
+        const char *replace_s = "replace";
+        char *name = systemd_service_name(op->agent,
+                                          pcmk__str_eq(op->action,
+                                                       PCMK_ACTION_META_DATA,
+                                                       pcmk__str_none));
+
+        CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID));
+        CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &replace_s, DBUS_TYPE_INVALID));
+
+        free(name);
+    }
+
+    if (op->synchronous) {
+        reply = systemd_send_recv(msg, NULL, timeout);
+        dbus_message_unref(msg);
+        process_unit_method_reply(reply, op);
+        if (reply != NULL) {
+            dbus_message_unref(reply);
+        }
 
     } else {
-        services__set_result(op, PCMK_OCF_NOT_RUNNING, PCMK_EXEC_DONE, state);
+        DBusPendingCall *pending = systemd_send(msg, unit_method_complete, op,
+                                                timeout);
+
+        dbus_message_unref(msg);
+        if (pending == NULL) {
+            services__set_result(op, PCMK_OCF_UNKNOWN_ERROR, PCMK_EXEC_ERROR,
+                                 "Unable to send DBus message");
+            services__finalize_async_op(op);
+
+        } else {
+            services_set_op_pending(op, pending);
+        }
     }
+}
 
-    if (!(op->synchronous)) {
-        services_set_op_pending(op, NULL);
-        services__finalize_async_op(op);
+/*!
+ * \internal
+ * \brief Get how much of an action's timeout is left after a reload wait
+ *
+ * \param[in] op  Action waiting for a systemd reload
+ *
+ * \return Milliseconds left in \p op's timeout (or 0 if none)
+ */
+static int
+reload_wait_remaining(const svc_action_t *op)
+{
+    gint64 waited_ms = (g_get_monotonic_time()
+                        - op->opaque->reload_wait_start) / 1000;
+
+    return (int) QB_MAX(op->timeout - waited_ms, 0);
+}
+
+/*!
+ * \internal
+ * \brief Send unit methods for all actions waiting on a completed reload
+ *
+ * \param[in,out] pending    Completed reload call
+ * \param[in]     user_data  Reload sequence number
+ */
+static void
+coalesced_reload_complete(DBusPendingCall *pending, void *user_data)
+{
+    reload_pending = NULL;
+    systemd_daemon_reload_complete(pending, user_data);
+
+    /* Take one action at a time, because finalizing an action that fails can
+     * lead to other waiting actions being cancelled (and thus removed).
+     */
+    while (reload_in_progress != NULL) {
+        svc_action_t *op = reload_in_progress->data;
+        int timeout = reload_wait_remaining(op);
+
+        reload_in_progress = g_list_delete_link(reload_in_progress,
+                                                reload_in_progress);
+
+        // The time spent waiting for the reload counts against the action
+        if (timeout == 0) {
+            services__format_result(op, PCMK_OCF_UNKNOWN_ERROR,
+                                    PCMK_EXEC_TIMEOUT,
+                                    "%s action for systemd unit %s did not "
+                                    "complete in time (waiting for reload)",
+                                    op->action, op->agent);
+            services__finalize_async_op(op);
+            continue;
+        }
+        send_unit_method(op, timeout);
+    }
+
+    if ((reload_waiting != NULL) && (reload_timer == 0)) {
+        reload_timer = pcmk__create_timer(RELOAD_DELAY_MS,
+                                          send_coalesced_reload, NULL);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Send one reload on behalf of all actions waiting for one
+ *
+ * \param[in] user_data  Ignored
+ *
+ * \return G_SOURCE_REMOVE (to remove the timer that called this)
+ */
+static gboolean
+send_coalesced_reload(gpointer user_data)
+{
+    static pcmk__metric_t batch_size =
+        PCMK__METRIC(pcmk__metric_histogram,
+                     "services_systemd_reload_batch_size",
+                     "Systemd actions released by each coalesced reload");
+    int timeout = 0;
+
+    reload_timer = 0;
+    reload_in_progress = reload_waiting;
+    reload_waiting = NULL;
+
+    /* Allow the reload as long as the most patient waiting action has left.
+     * Each action gets only what remains of its own timeout afterward.
+     */
+    for (const GList *iter = reload_in_progress; iter != NULL;
+         iter = iter->next) {
+        timeout = QB_MAX(timeout, reload_wait_remaining(iter->data));
+    }
+
+    pcmk__metric_observe(&batch_size, g_list_length(reload_in_progress));
+    crm_debug("Reloading systemd for %u unit override change%s",
+              g_list_length(reload_in_progress),
+              pcmk__plural_s(g_list_length(reload_in_progress)));
+
+    if (timeout > 0) {
+        reload_pending = systemd_daemon_reload(timeout,
+                                               coalesced_reload_complete);
+    }
+    if (reload_pending == NULL) {
+        /* Proceed as if the reload finished (and failed), which also times out
+         * any actions with no time left
+         */
+        coalesced_reload_complete(NULL, NULL);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+/*!
+ * \internal
+ * \brief Make an asynchronous action wait for the next coalesced reload
+ *
+ * \param[in,out] op  Action whose unit override was changed
+ */
+static void
+wait_for_reload(svc_action_t *op)
+{
+    crm_trace("%s will wait for next systemd reload", op->id);
+    op->opaque->reload_wait_start = g_get_monotonic_time();
+    reload_waiting = g_list_append(reload_waiting, op);
+
+    if ((reload_timer == 0) && (reload_pending == NULL)) {
+        reload_timer = pcmk__create_timer(RELOAD_DELAY_MS,
+                                          send_coalesced_reload, NULL);
     }
 }
 
+/*!
+ * \internal
+ * \brief Stop an action from waiting for a systemd reload
+ *
+ * \param[in] op  Action being cancelled or freed
+ */
+void
+services__systemd_cancel_reload_wait(const svc_action_t *op)
+{
+    reload_waiting = g_list_remove(reload_waiting, op);
+    reload_in_progress = g_list_remove(reload_in_progress, op);
+}
+
 /*!
  * \internal
  * \brief Invoke a systemd unit, given its DBus object path
@@ -950,14 +1704,18 @@ static void
 invoke_unit_by_path(svc_action_t *op, const char *unit)
 {
     const char *method = NULL;
-    DBusMessage *msg = NULL;
-    DBusMessage *reply = NULL;
+    bool reload_needed = false;
 
     if (pcmk__str_any_of(op->action, PCMK_ACTION_MONITOR, PCMK_ACTION_STATUS,
                          NULL)) {
         DBusPendingCall *pending = NULL;
+        char *unit_name = systemd_service_name(op->agent, false);
         char *state;
 
+        // Track the unit, so its state can be cached from now on
+        remember_unit(unit_name, unit);
+        free(unit_name);
+
         state = systemd_get_property(unit, "ActiveState",
                                      (op->synchronous? NULL : parse_status_result),
                                      op, (op->synchronous? NULL : &pending),
@@ -976,19 +1734,10 @@ invoke_unit_by_path(svc_action_t *op, const char *unit)
             services_set_op_pending(op, pending);
         }
         return;
+    }
 
-    } else if (pcmk__str_eq(op->action, PCMK_ACTION_START, pcmk__str_none)) {
-        method = "StartUnit";
-        systemd_create_override(op->agent, op->timeout);
-
-    } else if (pcmk__str_eq(op->action, PCMK_ACTION_STOP, pcmk__str_none)) {
-        method = "StopUnit";
-        systemd_remove_override(op->agent, op->timeout);
-
-    } else if (pcmk__str_eq(op->action, "restart", pcmk__str_none)) {
-        method = "RestartUnit";
-
-    } else {
+    method = unit_method_name(op);
+    if (method == NULL) {
         services__format_result(op, PCMK_OCF_UNIMPLEMENT_FEATURE,
                                 PCMK_EXEC_ERROR,
                                 "Action %s not implemented "
@@ -1000,49 +1749,30 @@ invoke_unit_by_path(svc_action_t *op, const char *unit)
         return;
     }
 
+    if (pcmk__str_eq(op->action, PCMK_ACTION_START, pcmk__str_none)) {
+        reload_needed = systemd_create_override(op->agent);
+
+    } else if (pcmk__str_eq(op->action, PCMK_ACTION_STOP, pcmk__str_none)) {
+        reload_needed = systemd_remove_override(op->agent);
+    }
+
     crm_trace("Calling %s for unit path %s%s%s",
               method, unit,
               ((op->rsc == NULL)? "" : " for resource "), pcmk__s(op->rsc, ""));
 
-    msg = systemd_new_method(method);
-    pcmk__assert(msg != NULL);
-
-    /* (ss) */
-    {
-        const char *replace_s = "replace";
-        char *name = systemd_service_name(op->agent,
-                                          pcmk__str_eq(op->action,
-                                                       PCMK_ACTION_META_DATA,
-                                                       pcmk__str_none));
-
-        CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &name, DBUS_TYPE_INVALID));
-        CRM_LOG_ASSERT(dbus_message_append_args(msg, DBUS_TYPE_STRING, &replace_s, DBUS_TYPE_INVALID));
-
-        free(name);
+    if (reload_needed && !(op->synchronous)) {
+        wait_for_reload(op);
+        return;
     }
 
-    if (op->synchronous) {
-        reply = systemd_send_recv(msg, NULL, op->timeout);
-        dbus_message_unref(msg);
-        process_unit_method_reply(reply, op);
-        if (reply != NULL) {
-            dbus_message_unref(reply);
-        }
-
-    } else {
-        DBusPendingCall *pending = systemd_send(msg, unit_method_complete, op,
-                                                op->timeout);
-
-        dbus_message_unref(msg);
-        if (pending == NULL) {
-            services__set_result(op, PCMK_OCF_UNKNOWN_ERROR, PCMK_EXEC_ERROR,
-                                 "Unable to send DBus message");
-            services__finalize_async_op(op);
-
-        } else {
-            services_set_op_pending(op, pending);
-        }
+    if (reload_needed) {
+        /* Synchronous actions can't wait for the main loop. The reload is
+         * queued ahead of the unit method on the same connection, so systemd
+         * handles it first.
+         */
+        systemd_daemon_reload(op->timeout, systemd_daemon_reload_complete);
     }
+    send_unit_method(op, op->timeout);
 }
 
 static gboolean
@@ -1103,6 +1833,10 @@ services__execute_systemd(svc_action_t *op)
         goto done;
     }
 
+    if (status_from_cache(op)) {
+        goto done;
+    }
+
     /* invoke_unit_by_name() should always override these values, which are here
      * just as a fail-safe in case there are any code paths that neglect to
      */
@@ -28,6 +28,9 @@ enum ocf_exitcode services__systemd2ocf(int exit_status);
 G_GNUC_INTERNAL
 int services__execute_systemd(svc_action_t *op);
 
+G_GNUC_INTERNAL
+void services__systemd_cancel_reload_wait(const svc_action_t *op);
+
 G_GNUC_INTERNAL gboolean systemd_unit_exists(const gchar * name);
 G_GNUC_INTERNAL void systemd_cleanup(void);
 
@@ -0,0 +1,820 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <ctype.h>
+#include <errno.h>
+#include <ftw.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <dbus/dbus.h>
+
+#include <crm/services_internal.h>
+
+#include "mock_systemd.h"
+
+#define BUS_NAME            "org.freedesktop.systemd1"
+#define BUS_NAME_MANAGER    BUS_NAME ".Manager"
+#define BUS_NAME_UNIT       BUS_NAME ".Unit"
+#define BUS_PATH            "/org/freedesktop/systemd1"
+#define BUS_NAME_PROPERTIES "org.freedesktop.DBus.Properties"
+
+// Interface for the test to control and inspect the stand-in
+#define MOCK_INTERFACE      "org.pacemaker.MockSystemd"
+
+#define MAX_UNITS           64
+#define MAX_DEFERRED        64
+#define START_TIMEOUT_MS    5000
+
+/*
+ * Stand-in systemd (runs in a child process)
+ */
+
+struct mock_method {
+    const char *name;
+    unsigned int count;     // Number of calls received
+    int delay_ms;           // Reply delay (or -1 to never reply)
+};
+
+static struct mock_method methods[] = {
+    { "LoadUnit", 0, 0 },
+    { "Subscribe", 0, 0 },
+    { "Reload", 0, 0 },
+    { "StartUnit", 0, 0 },
+    { "StopUnit", 0, 0 },
+    { "RestartUnit", 0, 0 },
+    { "Get", 0, 0 },
+};
+
+struct mock_unit {
+    char *name;
+    char *path;
+    char *active_state;
+};
+
+static struct mock_unit units[MAX_UNITS];
+static int n_units = 0;
+
+struct deferred_reply {
+    DBusMessage *reply;
+    long long due_ms;
+};
+
+static struct deferred_reply deferred[MAX_DEFERRED];
+static int n_deferred = 0;
+
+static long long
+now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000);
+}
+
+static struct mock_method *
+find_method(const char *name)
+{
+    for (int i = 0; i < PCMK__NELEM(methods); i++) {
+        if (pcmk__str_eq(methods[i].name, name, pcmk__str_none)) {
+            return &methods[i];
+        }
+    }
+    return NULL;
+}
+
+// Escape a unit name into an object path the way systemd does
+static char *
+unit_path(const char *name)
+{
+    char *path = pcmk__assert_alloc(1, sizeof(BUS_PATH "/unit/")
+                                       + (3 * strlen(name)));
+    char *end = path + sizeof(BUS_PATH "/unit/") - 1;
+
+    strcpy(path, BUS_PATH "/unit/");
+
+    for (const char *c = name; *c != '\0'; c++) {
+        if (isalnum((unsigned char) *c)) {
+            *end++ = *c;
+        } else {
+            end += sprintf(end, "_%02x", (unsigned char) *c);
+        }
+    }
+    return path;
+}
+
+static struct mock_unit *
+find_unit(const char *name, const char *path)
+{
+    for (int i = 0; i < n_units; i++) {
+        if (pcmk__str_eq(units[i].name, name, pcmk__str_none)
+            || pcmk__str_eq(units[i].path, path, pcmk__str_none)) {
+            return &units[i];
+        }
+    }
+    return NULL;
+}
+
+static struct mock_unit *
+load_unit(const char *name)
+{
+    struct mock_unit *unit = find_unit(name, NULL);
+
+    if (unit == NULL) {
+        pcmk__assert(n_units < MAX_UNITS);
+        unit = &units[n_units++];
+        unit->name = pcmk__str_copy(name);
+        unit->path = unit_path(name);
+        unit->active_state = pcmk__str_copy("inactive");
+    }
+    return unit;
+}
+
+static void
+send_message(DBusConnection *conn, DBusMessage *msg)
+{
+    dbus_connection_send(conn, msg, NULL);
+    dbus_connection_flush(conn);
+    dbus_message_unref(msg);
+}
+
+// Emit a unit's PropertiesChanged signal for its ActiveState
+static void
+emit_active_state(DBusConnection *conn, const struct mock_unit *unit)
+{
+    DBusMessage *signal = dbus_message_new_signal(unit->path,
+                                                  BUS_NAME_PROPERTIES,
+                                                  "PropertiesChanged");
+    const char *interface = BUS_NAME_UNIT;
+    const char *property = "ActiveState";
+    DBusMessageIter args;
+    DBusMessageIter changed;
+    DBusMessageIter entry;
+    DBusMessageIter value;
+    DBusMessageIter invalidated;
+
+    dbus_message_iter_init_append(signal, &args);
+    dbus_message_iter_append_basic(&args, DBUS_TYPE_STRING, &interface);
+
+    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "{sv}", &changed);
+    dbus_message_iter_open_container(&changed, DBUS_TYPE_DICT_ENTRY, NULL,
+                                     &entry);
+    dbus_message_iter_append_basic(&entry, DBUS_TYPE_STRING, &property);
+    dbus_message_iter_open_container(&entry, DBUS_TYPE_VARIANT, "s", &value);
+    dbus_message_iter_append_basic(&value, DBUS_TYPE_STRING,
+                                   &(unit->active_state));
+    dbus_message_iter_close_container(&entry, &value);
+    dbus_message_iter_close_container(&changed, &entry);
+    dbus_message_iter_close_container(&args, &changed);
+
+    dbus_message_iter_open_container(&args, DBUS_TYPE_ARRAY, "s",
+                                     &invalidated);
+    dbus_message_iter_close_container(&args, &invalidated);
+
+    send_message(conn, signal);
+}
+
+static void
+set_active_state(DBusConnection *conn, struct mock_unit *unit,
+                 const char *state)
+{
+    pcmk__str_update(&(unit->active_state), state);
+    emit_active_state(conn, unit);
+}
+
+// Unload a unit, emitting UnitRemoved (it will be inactive if loaded again)
+static void
+remove_unit(DBusConnection *conn, struct mock_unit *unit)
+{
+    DBusMessage *signal = dbus_message_new_signal(BUS_PATH, BUS_NAME_MANAGER,
+                                                  "UnitRemoved");
+
+    dbus_message_append_args(signal, DBUS_TYPE_STRING, &(unit->name),
+                             DBUS_TYPE_OBJECT_PATH, &(unit->path),
+                             DBUS_TYPE_INVALID);
+    send_message(conn, signal);
+
+    free(unit->name);
+    free(unit->path);
+    free(unit->active_state);
+    *unit = units[--n_units];
+}
+
+static DBusMessage *
+error_reply(DBusMessage *msg, const char *name, const char *text)
+{
+    return dbus_message_new_error(msg, name, text);
+}
+
+// Handle LoadUnit(s name) -> o path
+static DBusMessage *
+handle_load_unit(DBusMessage *msg)
+{
+    const char *name = NULL;
+    DBusMessage *reply = NULL;
+    struct mock_unit *unit = NULL;
+
+    if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+                               DBUS_TYPE_INVALID)) {
+        return error_reply(msg, DBUS_ERROR_INVALID_ARGS, "Expected name");
+    }
+
+    unit = load_unit(name);
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &(unit->path),
+                             DBUS_TYPE_INVALID);
+    return reply;
+}
+
+// Handle StartUnit, StopUnit, or RestartUnit(s name, s mode) -> o job
+static DBusMessage *
+handle_unit_method(DBusConnection *conn, DBusMessage *msg, const char *state)
+{
+    static unsigned int job_id = 0;
+    const char *name = NULL;
+    const char *mode = NULL;
+    DBusMessage *reply = NULL;
+    char *job = NULL;
+
+    if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+                               DBUS_TYPE_STRING, &mode, DBUS_TYPE_INVALID)) {
+        return error_reply(msg, DBUS_ERROR_INVALID_ARGS,
+                           "Expected name and mode");
+    }
+
+    set_active_state(conn, load_unit(name), state);
+
+    job = crm_strdup_printf(BUS_PATH "/job/%u", ++job_id);
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_append_args(reply, DBUS_TYPE_OBJECT_PATH, &job,
+                             DBUS_TYPE_INVALID);
+    free(job);
+    return reply;
+}
+
+// Handle Properties.Get(s interface, s property) -> v value for a unit
+static DBusMessage *
+handle_get(DBusMessage *msg)
+{
+    const char *interface = NULL;
+    const char *property = NULL;
+    const char *value = NULL;
+    char *description = NULL;
+    struct mock_unit *unit = find_unit(NULL, dbus_message_get_path(msg));
+    DBusMessage *reply = NULL;
+    DBusMessageIter args;
+    DBusMessageIter variant;
+
+    if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &interface,
+                               DBUS_TYPE_STRING, &property,
+                               DBUS_TYPE_INVALID)) {
+        return error_reply(msg, DBUS_ERROR_INVALID_ARGS,
+                           "Expected interface and property");
+    }
+    if (unit == NULL) {
+        return error_reply(msg, DBUS_ERROR_UNKNOWN_OBJECT, "No such unit");
+    }
+
+    if (pcmk__str_eq(property, "ActiveState", pcmk__str_none)) {
+        value = unit->active_state;
+
+    } else if (pcmk__str_eq(property, "Description", pcmk__str_none)) {
+        description = crm_strdup_printf("Mock %s", unit->name);
+        value = description;
+
+    } else {
+        return error_reply(msg, DBUS_ERROR_UNKNOWN_PROPERTY, property);
+    }
+
+    reply = dbus_message_new_method_return(msg);
+    dbus_message_iter_init_append(reply, &args);
+    dbus_message_iter_open_container(&args, DBUS_TYPE_VARIANT, "s", &variant);
+    dbus_message_iter_append_basic(&variant, DBUS_TYPE_STRING, &value);
+    dbus_message_iter_close_container(&args, &variant);
+    free(description);
+    return reply;
+}
+
+// Handle a call from the test on the control interface
+static DBusMessage *
+handle_control(DBusConnection *conn, DBusMessage *msg)
+{
+    DBusMessage *reply = NULL;
+    const char *name = NULL;
+
+    if (dbus_message_is_method_call(msg, MOCK_INTERFACE, "Count")) {
+        struct mock_method *method = NULL;
+        dbus_uint32_t count = 0;
+
+        if (dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_INVALID)) {
+            method = find_method(name);
+        }
+        if (method == NULL) {
+            return error_reply(msg, DBUS_ERROR_INVALID_ARGS, "Unknown method");
+        }
+        count = method->count;
+        reply = dbus_message_new_method_return(msg);
+        dbus_message_append_args(reply, DBUS_TYPE_UINT32, &count,
+                                 DBUS_TYPE_INVALID);
+        return reply;
+    }
+
+    if (dbus_message_is_method_call(msg, MOCK_INTERFACE, "SetDelay")) {
+        struct mock_method *method = NULL;
+        dbus_int32_t delay_ms = 0;
+
+        if (dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_INT32, &delay_ms,
+                                  DBUS_TYPE_INVALID)) {
+            method = find_method(name);
+        }
+        if (method == NULL) {
+            return error_reply(msg, DBUS_ERROR_INVALID_ARGS, "Unknown method");
+        }
+        method->delay_ms = delay_ms;
+        return dbus_message_new_method_return(msg);
+    }
+
+    if (dbus_message_is_method_call(msg, MOCK_INTERFACE, "SetState")) {
+        const char *state = NULL;
+
+        if (!dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+                                   DBUS_TYPE_STRING, &state,
+                                   DBUS_TYPE_INVALID)) {
+            return error_reply(msg, DBUS_ERROR_INVALID_ARGS,
+                               "Expected unit and state");
+        }
+        set_active_state(conn, load_unit(name), state);
+        return dbus_message_new_method_return(msg);
+    }
+
+    if (dbus_message_is_method_call(msg, MOCK_INTERFACE, "RemoveUnit")) {
+        struct mock_unit *unit = NULL;
+
+        if (dbus_message_get_args(msg, NULL, DBUS_TYPE_STRING, &name,
+                                  DBUS_TYPE_INVALID)) {
+            unit = find_unit(name, NULL);
+        }
+        if (unit == NULL) {
+            return error_reply(msg, DBUS_ERROR_INVALID_ARGS, "Unknown unit");
+        }
+        remove_unit(conn, unit);
+        return dbus_message_new_method_return(msg);
+    }
+
+    return error_reply(msg, DBUS_ERROR_UNKNOWN_METHOD,
+                       dbus_message_get_member(msg));
+}
+
+static void
+handle_message(DBusConnection *conn, DBusMessage *msg)
+{
+    const char *member = dbus_message_get_member(msg);
+    struct mock_method *method = NULL;
+    DBusMessage *reply = NULL;
+
+    if (dbus_message_get_type(msg) != DBUS_MESSAGE_TYPE_METHOD_CALL) {
+        return;
+    }
+
+    if (dbus_message_has_interface(msg, MOCK_INTERFACE)) {
+        send_message(conn, handle_control(conn, msg));
+        return;
+    }
+
+    method = find_method(member);
+    if (method == NULL) {
+        send_message(conn, error_reply(msg, DBUS_ERROR_UNKNOWN_METHOD, member));
+        return;
+    }
+    method->count++;
+
+    if (dbus_message_is_method_call(msg, BUS_NAME_PROPERTIES, "Get")) {
+        reply = handle_get(msg);
+
+    } else if (dbus_message_is_method_call(msg, BUS_NAME_MANAGER, "LoadUnit")) {
+        reply = handle_load_unit(msg);
+
+    } else if (dbus_message_is_method_call(msg, BUS_NAME_MANAGER,
+                                           "StartUnit")
+               || dbus_message_is_method_call(msg, BUS_NAME_MANAGER,
+                                              "RestartUnit")) {
+        reply = handle_unit_method(conn, msg, "active");
+
+    } else if (dbus_message_is_method_call(msg, BUS_NAME_MANAGER,
+                                           "StopUnit")) {
+        reply = handle_unit_method(conn, msg, "inactive");
+
+    } else {
+        // Subscribe and Reload have no arguments or results
+        reply = dbus_message_new_method_return(msg);
+    }
+
+    if (method->delay_ms < 0) {
+        dbus_message_unref(reply);
+
+    } else if (method->delay_ms > 0) {
+        pcmk__assert(n_deferred < MAX_DEFERRED);
+        deferred[n_deferred].reply = reply;
+        deferred[n_deferred].due_ms = now_ms() + method->delay_ms;
+        n_deferred++;
+
+    } else {
+        send_message(conn, reply);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Send any delayed replies that are due
+ *
+ * \return Milliseconds until the next delayed reply is due (or -1 if none)
+ */
+static int
+send_deferred_replies(DBusConnection *conn)
+{
+    long long now = now_ms();
+    long long next = -1;
+    int i = 0;
+
+    while (i < n_deferred) {
+        if (deferred[i].due_ms <= now) {
+            send_message(conn, deferred[i].reply);
+            deferred[i] = deferred[--n_deferred];
+            continue;
+        }
+        if ((next < 0) || (deferred[i].due_ms - now < next)) {
+            next = deferred[i].due_ms - now;
+        }
+        i++;
+    }
+    return (int) next;
+}
+
+// Serve as systemd until killed or disconnected from the bus
+static void
+run_mock(void)
+{
+    DBusError error;
+    DBusConnection *conn = NULL;
+    int timeout_ms = -1;
+    int rc = 0;
+
+    dbus_error_init(&error);
+    conn = dbus_bus_get_private(DBUS_BUS_SYSTEM, &error);
+    if (conn == NULL) {
+        _exit(CRM_EX_UNAVAILABLE);
+    }
+    dbus_connection_set_exit_on_disconnect(conn, FALSE);
+
+    rc = dbus_bus_request_name(conn, BUS_NAME, DBUS_NAME_FLAG_DO_NOT_QUEUE,
+                               &error);
+    if (rc != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER) {
+        _exit(CRM_EX_UNAVAILABLE);
+    }
+
+    while (dbus_connection_read_write(conn, timeout_ms)) {
+        DBusMessage *msg = NULL;
+
+        while ((msg = dbus_connection_pop_message(conn)) != NULL) {
+            handle_message(conn, msg);
+            dbus_message_unref(msg);
+        }
+        timeout_ms = send_deferred_replies(conn);
+    }
+    _exit(CRM_EX_OK);
+}
+
+/*
+ * Test side (runs in the test process)
+ */
+
+static char *bus_dir = NULL;        // Temporary directory for bus and overrides
+static pid_t bus_pid = 0;           // Private bus daemon
+static pid_t mock_pid = 0;          // Stand-in systemd
+static DBusConnection *control = NULL;  // Test's own bus connection
+
+static void
+stop_child(pid_t *pid)
+{
+    if (*pid > 0) {
+        kill(*pid, SIGTERM);
+        waitpid(*pid, NULL, 0);
+        *pid = 0;
+    }
+}
+
+static int
+remove_entry(const char *path, const struct stat *sb, int type,
+             struct FTW *ftw)
+{
+    remove(path);
+    return 0;
+}
+
+static int
+write_bus_config(const char *config, const char *socket)
+{
+    FILE *fp = fopen(config, "w");
+
+    if (fp == NULL) {
+        return errno;
+    }
+    fprintf(fp,
+            "<!DOCTYPE busconfig PUBLIC "
+            "\"-//freedesktop//DTD D-Bus Bus Configuration 1.0//EN\" "
+            "\"http://www.freedesktop.org/standards/dbus/1.0/"
+            "busconfig.dtd\">\n"
+            "<busconfig>\n"
+            "  <type>custom</type>\n"
+            "  <listen>unix:path=%s</listen>\n"
+            "  <auth>EXTERNAL</auth>\n"
+            "  <policy context=\"default\">\n"
+            "    <allow user=\"*\"/>\n"
+            "    <allow own=\"*\"/>\n"
+            "    <allow send_destination=\"*\"/>\n"
+            "    <allow receive_sender=\"*\"/>\n"
+            "  </policy>\n"
+            "</busconfig>\n", socket);
+    fclose(fp);
+    return pcmk_rc_ok;
+}
+
+static void
+sleep_ms(int ms)
+{
+    struct timespec ts = { ms / 1000, (ms % 1000) * 1000000L };
+
+    nanosleep(&ts, NULL);
+}
+
+/*!
+ * \internal
+ * \brief Start a private system bus, and point the services library at it
+ *
+ * This also points the services library's systemd unit overrides at a
+ * temporary directory, so that starting and stopping units writes and removes
+ * overrides there.
+ *
+ * \return Standard Pacemaker return code
+ * \retval ENOENT  dbus-daemon is not available (the caller should skip tests)
+ */
+int
+mock_systemd_init(void)
+{
+    char *config = NULL;
+    char *socket = NULL;
+    char *address = NULL;
+    char *overrides = NULL;
+    int rc = pcmk_rc_ok;
+
+    bus_dir = pcmk__str_copy("/tmp/pcmk-mock-systemd-XXXXXX");
+    if (mkdtemp(bus_dir) == NULL) {
+        rc = errno;
+        free(bus_dir);
+        bus_dir = NULL;
+        return rc;
+    }
+
+    config = crm_strdup_printf("%s/bus.conf", bus_dir);
+    socket = crm_strdup_printf("%s/bus", bus_dir);
+    address = crm_strdup_printf("unix:path=%s", socket);
+    overrides = crm_strdup_printf("%s/overrides", bus_dir);
+
+    rc = write_bus_config(config, socket);
+    if (rc != pcmk_rc_ok) {
+        goto done;
+    }
+
+    bus_pid = fork();
+    if (bus_pid < 0) {
+        rc = errno;
+        bus_pid = 0;
+        goto done;
+    }
+    if (bus_pid == 0) {
+        execlp("dbus-daemon", "dbus-daemon", "--nofork", "--nopidfile",
+               "--nosyslog", "--config-file", config, (char *) NULL);
+        _exit(CRM_EX_NOT_INSTALLED);
+    }
+
+    setenv("DBUS_SYSTEM_BUS_ADDRESS", address, 1);
+    services__set_systemd_override_root(overrides);
+
+    // Wait for the bus to accept connections
+    rc = ENOENT;
+    for (int waited = 0; waited < START_TIMEOUT_MS; waited += 50) {
+        DBusError error;
+
+        if (waitpid(bus_pid, NULL, WNOHANG) == bus_pid) {
+            bus_pid = 0;
+            break;
+        }
+
+        dbus_error_init(&error);
+        control = dbus_bus_get_private(DBUS_BUS_SYSTEM, &error);
+        if (control != NULL) {
+            dbus_connection_set_exit_on_disconnect(control, FALSE);
+            rc = pcmk_rc_ok;
+            break;
+        }
+        dbus_error_free(&error);
+        sleep_ms(50);
+    }
+
+  done:
+    free(config);
+    free(socket);
+    free(address);
+    free(overrides);
+    if (rc != pcmk_rc_ok) {
+        mock_systemd_cleanup();
+    }
+    return rc;
+}
+
+/*!
+ * \internal
+ * \brief Stop the stand-in systemd and private bus, and remove their files
+ */
+void
+mock_systemd_cleanup(void)
+{
+    mock_systemd_stop();
+    if (control != NULL) {
+        dbus_connection_close(control);
+        dbus_connection_unref(control);
+        control = NULL;
+    }
+    stop_child(&bus_pid);
+    services__set_systemd_override_root(NULL);
+    if (bus_dir != NULL) {
+        nftw(bus_dir, remove_entry, 8, FTW_DEPTH|FTW_PHYS);
+        free(bus_dir);
+        bus_dir = NULL;
+    }
+}
+
+/*!
+ * \internal
+ * \brief Start the stand-in systemd (with no units) on the private bus
+ *
+ * \return Standard Pacemaker return code
+ */
+int
+mock_systemd_start(void)
+{
+    pcmk__assert((control != NULL) && (mock_pid == 0));
+
+    mock_pid = fork();
+    if (mock_pid < 0) {
+        mock_pid = 0;
+        return errno;
+    }
+    if (mock_pid == 0) {
+        run_mock();
+    }
+
+    for (int waited = 0; waited < START_TIMEOUT_MS; waited += 50) {
+        if (dbus_bus_name_has_owner(control, BUS_NAME, NULL)) {
+            return pcmk_rc_ok;
+        }
+        if (waitpid(mock_pid, NULL, WNOHANG) == mock_pid) {
+            break;
+        }
+        sleep_ms(50);
+    }
+    mock_systemd_stop();
+    return ETIMEDOUT;
+}
+
+/*!
+ * \internal
+ * \brief Stop the stand-in systemd, so it leaves the private bus
+ */
+void
+mock_systemd_stop(void)
+{
+    stop_child(&mock_pid);
+}
+
+// Call a method on the stand-in's control interface
+static DBusMessage *
+call_mock(DBusMessage *msg)
+{
+    DBusError error;
+    DBusMessage *reply = NULL;
+
+    dbus_error_init(&error);
+    reply = dbus_connection_send_with_reply_and_block(control, msg,
+                                                      START_TIMEOUT_MS,
+                                                      &error);
+    dbus_message_unref(msg);
+    if (dbus_error_is_set(&error)) {
+        fprintf(stderr, "Mock systemd call failed: %s\n", error.message);
+        dbus_error_free(&error);
+    }
+    pcmk__assert(reply != NULL);
+    return reply;
+}
+
+static DBusMessage *
+new_control_call(const char *method)
+{
+    return dbus_message_new_method_call(BUS_NAME, BUS_PATH, MOCK_INTERFACE,
+                                        method);
+}
+
+/*!
+ * \internal
+ * \brief Get how many calls of a method the stand-in systemd has received
+ *
+ * \param[in] method  Method name (such as "Reload" or "Get")
+ *
+ * \return Number of calls of \p method since the stand-in was started
+ */
+unsigned int
+mock_systemd_count(const char *method)
+{
+    DBusMessage *msg = new_control_call("Count");
+    DBusMessage *reply = NULL;
+    dbus_uint32_t count = 0;
+
+    dbus_message_append_args(msg, DBUS_TYPE_STRING, &method,
+                             DBUS_TYPE_INVALID);
+    reply = call_mock(msg);
+    dbus_message_get_args(reply, NULL, DBUS_TYPE_UINT32, &count,
+                          DBUS_TYPE_INVALID);
+    dbus_message_unref(reply);
+    return count;
+}
+
+/*!
+ * \internal
+ * \brief Make the stand-in systemd delay its replies to a method
+ *
+ * \param[in] method    Method name (such as "Reload")
+ * \param[in] delay_ms  How long to delay replies (0 for no delay, or -1 to
+ *                      never reply)
+ */
+void
+mock_systemd_set_delay(const char *method, int delay_ms)
+{
+    DBusMessage *msg = new_control_call("SetDelay");
+    dbus_int32_t delay = delay_ms;
+
+    dbus_message_append_args(msg, DBUS_TYPE_STRING, &method,
+                             DBUS_TYPE_INT32, &delay, DBUS_TYPE_INVALID);
+    dbus_message_unref(call_mock(msg));
+}
+
+/*!
+ * \internal
+ * \brief Change a unit's ActiveState, as if it started or stopped on its own
+ *
+ * \param[in] unit   Unit name (with extension)
+ * \param[in] state  New ActiveState (such as "active" or "failed")
+ *
+ * \note The stand-in emits PropertiesChanged for the unit before replying.
+ */
+void
+mock_systemd_set_state(const char *unit, const char *state)
+{
+    DBusMessage *msg = new_control_call("SetState");
+
+    dbus_message_append_args(msg, DBUS_TYPE_STRING, &unit,
+                             DBUS_TYPE_STRING, &state, DBUS_TYPE_INVALID);
+    dbus_message_unref(call_mock(msg));
+}
+
+/*!
+ * \internal
+ * \brief Unload a unit, as systemd does with units no longer referenced
+ *
+ * \param[in] unit  Unit name (with extension)
+ *
+ * \note The stand-in emits UnitRemoved for the unit before replying. If the
+ *       unit is loaded again, it starts out inactive.
+ */
+void
+mock_systemd_remove_unit(const char *unit)
+{
+    DBusMessage *msg = new_control_call("RemoveUnit");
+
+    dbus_message_append_args(msg, DBUS_TYPE_STRING, &unit, DBUS_TYPE_INVALID);
+    dbus_message_unref(call_mock(msg));
+}
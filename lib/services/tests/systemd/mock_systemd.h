@@ -0,0 +1,44 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#ifndef MOCK_SYSTEMD__H
+#define MOCK_SYSTEMD__H
+
+/* A private DBus system bus with a minimal systemd stand-in on it, for testing
+ * the services library's systemd support without a real systemd.
+ *
+ * The stand-in answers the Manager methods the library uses (LoadUnit,
+ * Subscribe, Reload, StartUnit, StopUnit, and RestartUnit) and Properties.Get
+ * for units, counting each call. Units are created by LoadUnit and start out
+ * inactive. Starting or stopping a unit changes its ActiveState and emits
+ * PropertiesChanged, as systemd does. The test can also change a unit's state
+ * or unload it directly, to make the stand-in emit PropertiesChanged or
+ * UnitRemoved.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int mock_systemd_init(void);
+void mock_systemd_cleanup(void);
+
+int mock_systemd_start(void);
+void mock_systemd_stop(void);
+
+unsigned int mock_systemd_count(const char *method);
+void mock_systemd_set_delay(const char *method, int delay_ms);
+void mock_systemd_set_state(const char *unit, const char *state);
+void mock_systemd_remove_unit(const char *unit);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MOCK_SYSTEMD__H
@@ -0,0 +1,196 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/services.h>
+#include <crm/services_internal.h>
+
+#include "mock_systemd.h"
+
+#define N_UNITS         5
+#define GIVE_UP_MS      60000
+
+static bool have_mock = false;
+static GMainLoop *loop = NULL;
+
+// Results of the most recent batch of actions
+static int actions_left = 0;
+static int actions_ok = 0;
+static gint64 started_us = 0;
+static gint64 elapsed_ms = 0;
+
+static void
+action_done(svc_action_t *op)
+{
+    if ((op->rc == PCMK_OCF_OK) && (op->status == PCMK_EXEC_DONE)) {
+        actions_ok++;
+    }
+    elapsed_ms = (g_get_monotonic_time() - started_us) / 1000;
+
+    if (--actions_left == 0) {
+        g_main_loop_quit(loop);
+    }
+}
+
+static gboolean
+give_up(gpointer user_data)
+{
+    g_main_loop_quit(loop);
+    return G_SOURCE_REMOVE;
+}
+
+/* Execute an action for several units at once, and wait for all of them to
+ * complete (agent names are pcmk-reload-test-<prefix>-<n>)
+ */
+static void
+run_actions(const char *prefix, const char *action, int n_units,
+            int timeout_ms)
+{
+    guint timer = 0;
+
+    actions_left = n_units;
+    actions_ok = 0;
+    started_us = g_get_monotonic_time();
+
+    for (int i = 0; i < n_units; i++) {
+        char *rsc = crm_strdup_printf("%s-%d", prefix, i);
+        char *agent = crm_strdup_printf("pcmk-reload-test-%s-%d", prefix, i);
+        svc_action_t *op = NULL;
+
+        op = services__create_resource_action(rsc, PCMK_RESOURCE_CLASS_SYSTEMD,
+                                              NULL, agent, action, 0,
+                                              timeout_ms, NULL, 0);
+        assert_non_null(op);
+        assert_true(services_action_async(op, action_done));
+        free(rsc);
+        free(agent);
+    }
+
+    // Actions that fail early complete before the loop runs
+    if (actions_left > 0) {
+        timer = pcmk__create_timer(GIVE_UP_MS, give_up, NULL);
+        g_main_loop_run(loop);
+        assert_int_equal(actions_left, 0);
+        g_source_remove(timer);
+    }
+}
+
+static void
+reloads_coalesced(void **state)
+{
+    if (!have_mock) {
+        skip();
+    }
+
+    // Writing each unit's override needs a reload, but one is enough for all
+    run_actions("coalesce", PCMK_ACTION_START, N_UNITS, 20000);
+    assert_int_equal(actions_ok, N_UNITS);
+    assert_int_equal(mock_systemd_count("StartUnit"), N_UNITS);
+    assert_int_equal(mock_systemd_count("Reload"), 1);
+
+    // Same for removing the overrides
+    run_actions("coalesce", PCMK_ACTION_STOP, N_UNITS, 20000);
+    assert_int_equal(actions_ok, N_UNITS);
+    assert_int_equal(mock_systemd_count("StopUnit"), N_UNITS);
+    assert_int_equal(mock_systemd_count("Reload"), 2);
+}
+
+static void
+no_reload_needed(void **state)
+{
+    if (!have_mock) {
+        skip();
+    }
+
+    // Stopping a unit with no override has nothing to reload
+    run_actions("no-override", PCMK_ACTION_STOP, 1, 20000);
+    assert_int_equal(actions_ok, 1);
+    assert_int_equal(mock_systemd_count("StopUnit"), 1);
+    assert_int_equal(mock_systemd_count("Reload"), 0);
+}
+
+static void
+reload_wait_counts_against_timeout(void **state)
+{
+    if (!have_mock) {
+        skip();
+    }
+
+    /* With a 3s timeout and a 1.5s reload, StartUnit may take only the
+     * remaining 1.5s, so the action fails at about 3s rather than 4.5s.
+     */
+    mock_systemd_set_delay("Reload", 1500);
+    mock_systemd_set_delay("StartUnit", -1);
+    run_actions("slow-start", PCMK_ACTION_START, 1, 3000);
+
+    assert_int_equal(actions_ok, 0);
+    assert_int_equal(mock_systemd_count("Reload"), 1);
+    assert_int_equal(mock_systemd_count("StartUnit"), 1);
+    assert_true(elapsed_ms >= 2900);
+    assert_true(elapsed_ms < 4000);
+}
+
+static void
+reload_outlasts_timeout(void **state)
+{
+    if (!have_mock) {
+        skip();
+    }
+
+    /* An action whose whole timeout went to the reload fails then, instead of
+     * getting another full timeout for StartUnit
+     */
+    mock_systemd_set_delay("Reload", 5000);
+    mock_systemd_set_delay("StartUnit", -1);
+    run_actions("slow-reload", PCMK_ACTION_START, 1, 1000);
+
+    assert_int_equal(actions_ok, 0);
+    assert_int_equal(mock_systemd_count("Reload"), 1);
+    assert_true(elapsed_ms < 1800);
+}
+
+// Give each test a fresh stand-in systemd
+static int
+restart_mock(void **state)
+{
+    if (have_mock) {
+        mock_systemd_stop();
+        assert_int_equal(mock_systemd_start(), pcmk_rc_ok);
+    }
+    return 0;
+}
+
+static int
+setup(void **state)
+{
+    // Skip the tests if the bus daemon is not available
+    have_mock = (mock_systemd_init() == pcmk_rc_ok);
+    loop = g_main_loop_new(NULL, FALSE);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    g_main_loop_unref(loop);
+    loop = NULL;
+    mock_systemd_cleanup();
+    return 0;
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test_setup(reloads_coalesced, restart_mock),
+                cmocka_unit_test_setup(no_reload_needed, restart_mock),
+                cmocka_unit_test_setup(reload_wait_counts_against_timeout,
+                                       restart_mock),
+                cmocka_unit_test_setup(reload_outlasts_timeout, restart_mock))
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2025 the Pacemaker project contributors
+ *
+ * The version control history for this file may have further details.
+ *
+ * This source code is licensed under the GNU General Public License version 2
+ * or later (GPLv2+) WITHOUT ANY WARRANTY.
+ */
+
+#include <crm_internal.h>
+
+#include <glib.h>
+
+#include <crm/common/unittest_internal.h>
+#include <crm/services.h>
+#include <crm/services_internal.h>
+
+#include "mock_systemd.h"
+
+#define GIVE_UP_MS      60000
+#define SIGNAL_WAIT_MS  5000
+#define PUMP_MS         20
+
+static bool have_mock = false;
+static GMainLoop *loop = NULL;
+
+static bool monitor_complete = false;
+static int monitor_rc = PCMK_OCF_UNKNOWN;
+
+static void
+monitor_done(svc_action_t *op)
+{
+    monitor_complete = true;
+    monitor_rc = op->rc;
+    if (g_main_loop_is_running(loop)) {
+        g_main_loop_quit(loop);
+    }
+}
+
+static gboolean
+quit_loop(gpointer user_data)
+{
+    g_main_loop_quit(loop);
+    return G_SOURCE_REMOVE;
+}
+
+// Let the services library handle whatever arrived on the bus meanwhile
+static void
+pump(int ms)
+{
+    pcmk__create_timer(ms, quit_loop, NULL);
+    g_main_loop_run(loop);
+}
+
+/* Monitor a unit and return the result (a monitor answered from the cache
+ * completes before the loop runs)
+ */
+static int
+monitor(const char *agent)
+{
+    svc_action_t *op = NULL;
+
+    op = services__create_resource_action(agent, PCMK_RESOURCE_CLASS_SYSTEMD,
+                                          NULL, agent, PCMK_ACTION_MONITOR, 0,
+                                          20000, NULL, 0);
+    assert_non_null(op);
+    monitor_complete = false;
+    monitor_rc = PCMK_OCF_UNKNOWN;
+    assert_true(services_action_async(op, monitor_done));
+
+    if (!monitor_complete) {
+        guint timer = pcmk__create_timer(GIVE_UP_MS, quit_loop, NULL);
+
+        g_main_loop_run(loop);
+        assert_true(monitor_complete);
+        g_source_remove(timer);
+    }
+    return monitor_rc;
+}
+
+// Monitor a unit until it has an expected result, allowing for signal delivery
+static bool
+monitor_until(const char *agent, int expected_rc)
+{
+    for (int waited = 0; waited < SIGNAL_WAIT_MS; waited += PUMP_MS) {
+        if (monitor(agent) == expected_rc) {
+            return true;
+        }
+        pump(PUMP_MS);
+    }
+    return false;
+}
+
+// Wait for the library to subscribe to the current stand-in systemd
+static void
+wait_for_subscribe(void)
+{
+    for (int waited = 0; (mock_systemd_count("Subscribe") == 0)
+                         && (waited < SIGNAL_WAIT_MS); waited += PUMP_MS) {
+        pump(PUMP_MS);
+    }
+}
+
+static void
+restarted_before_caching(void **state)
+{
+    svc_action_t *op = NULL;
+
+    if (!have_mock) {
+        skip();
+    }
+
+    // Connect to the bus without tracking any unit
+    op = services__create_resource_action("pcmk-cache-test-early",
+                                          PCMK_RESOURCE_CLASS_SYSTEMD, NULL,
+                                          "pcmk-cache-test-early",
+                                          PCMK_ACTION_META_DATA, 0, 20000,
+                                          NULL, 0);
+    assert_non_null(op);
+    services_action_sync(op);
+    services_action_free(op);
+
+    // A systemd restart must be noticed even with nothing cached yet
+    mock_systemd_stop();
+    assert_int_equal(mock_systemd_start(), pcmk_rc_ok);
+    wait_for_subscribe();
+    assert_int_equal(mock_systemd_count("Subscribe"), 1);
+}
+
+static void
+cache_hits(void **state)
+{
+    unsigned int loads = 0;
+    unsigned int gets = 0;
+
+    if (!have_mock) {
+        skip();
+    }
+    loads = mock_systemd_count("LoadUnit");
+    gets = mock_systemd_count("Get");
+
+    // The first monitor must ask systemd
+    assert_int_equal(monitor("pcmk-cache-test-hits"), PCMK_OCF_NOT_RUNNING);
+    assert_int_equal(mock_systemd_count("LoadUnit"), loads + 1);
+    assert_int_equal(mock_systemd_count("Get"), gets + 1);
+
+    // Later ones are answered from the cache
+    for (int i = 0; i < 3; i++) {
+        assert_int_equal(monitor("pcmk-cache-test-hits"),
+                         PCMK_OCF_NOT_RUNNING);
+    }
+    assert_int_equal(mock_systemd_count("LoadUnit"), loads + 1);
+    assert_int_equal(mock_systemd_count("Get"), gets + 1);
+}
+
+static void
+properties_changed(void **state)
+{
+    unsigned int gets = 0;
+
+    if (!have_mock) {
+        skip();
+    }
+
+    assert_int_equal(monitor("pcmk-cache-test-changed"), PCMK_OCF_NOT_RUNNING);
+    gets = mock_systemd_count("Get");
+
+    // The cache follows the unit's PropertiesChanged signals
+    mock_systemd_set_state("pcmk-cache-test-changed.service", "active");
+    assert_true(monitor_until("pcmk-cache-test-changed", PCMK_OCF_OK));
+
+    mock_systemd_set_state("pcmk-cache-test-changed.service", "failed");
+    assert_true(monitor_until("pcmk-cache-test-changed",
+                              PCMK_OCF_NOT_RUNNING));
+
+    assert_int_equal(mock_systemd_count("Get"), gets);
+}
+
+static void
+unit_removed(void **state)
+{
+    unsigned int gets = 0;
+
+    if (!have_mock) {
+        skip();
+    }
+
+    assert_int_equal(monitor("pcmk-cache-test-removed"), PCMK_OCF_NOT_RUNNING);
+    mock_systemd_set_state("pcmk-cache-test-removed.service", "active");
+    assert_true(monitor_until("pcmk-cache-test-removed", PCMK_OCF_OK));
+    gets = mock_systemd_count("Get");
+
+    /* Once the unit is unloaded, its cached state is dropped, so the next
+     * monitor asks systemd (which has the unit inactive once reloaded)
+     */
+    mock_systemd_remove_unit("pcmk-cache-test-removed.service");
+    assert_true(monitor_until("pcmk-cache-test-removed",
+                              PCMK_OCF_NOT_RUNNING));
+    assert_int_equal(mock_systemd_count("Get"), gets + 1);
+
+    // That result is cached again
+    assert_int_equal(monitor("pcmk-cache-test-removed"), PCMK_OCF_NOT_RUNNING);
+    assert_int_equal(mock_systemd_count("Get"), gets + 1);
+}
+
+static void
+systemd_restarted(void **state)
+{
+    if (!have_mock) {
+        skip();
+    }
+
+    assert_int_equal(monitor("pcmk-cache-test-restart"), PCMK_OCF_NOT_RUNNING);
+    mock_systemd_set_state("pcmk-cache-test-restart.service", "active");
+    assert_true(monitor_until("pcmk-cache-test-restart", PCMK_OCF_OK));
+
+    /* When systemd goes away and comes back, the library must forget the
+     * cached state and subscribe again
+     */
+    mock_systemd_stop();
+    assert_int_equal(mock_systemd_start(), pcmk_rc_ok);
+    wait_for_subscribe();
+    assert_int_equal(mock_systemd_count("Subscribe"), 1);
+
+    // The new systemd has the unit inactive, and must be asked
+    assert_int_equal(monitor("pcmk-cache-test-restart"), PCMK_OCF_NOT_RUNNING);
+    assert_int_equal(mock_systemd_count("LoadUnit"), 1);
+    assert_int_equal(mock_systemd_count("Get"), 1);
+
+    // The cache works again with the new subscription
+    assert_int_equal(monitor("pcmk-cache-test-restart"), PCMK_OCF_NOT_RUNNING);
+    assert_int_equal(mock_systemd_count("Get"), 1);
+
+    mock_systemd_set_state("pcmk-cache-test-restart.service", "active");
+    assert_true(monitor_until("pcmk-cache-test-restart", PCMK_OCF_OK));
+    assert_int_equal(mock_systemd_count("Get"), 1);
+}
+
+static int
+setup(void **state)
+{
+    // Skip the tests if the bus daemon is not available
+    have_mock = (mock_systemd_init() == pcmk_rc_ok)
+                && (mock_systemd_start() == pcmk_rc_ok);
+    loop = g_main_loop_new(NULL, FALSE);
+    return 0;
+}
+
+static int
+teardown(void **state)
+{
+    g_main_loop_unref(loop);
+    loop = NULL;
+    mock_systemd_cleanup();
+    return 0;
+}
+
+PCMK__UNIT_TEST(setup, teardown,
+                cmocka_unit_test(restarted_before_caching),
+                cmocka_unit_test(cache_hits),
+                cmocka_unit_test(properties_changed),
+                cmocka_unit_test(unit_removed),
+                cmocka_unit_test(systemd_restarted))
@@ -25,6 +25,9 @@ WRAPPED = abort 		\
 	  getpid		\
 	  getgrent		\
 	  getpwnam_r		\
+	  qb_ipcs_disconnect	\
+	  qb_ipcs_event_sendv	\
+	  qb_ipcs_response_sendv	\
 	  readlink		\
 	  realloc 		\
 	  setenv		\
@@ -40,6 +40,7 @@ static struct {
     char *cib_section;
     char *validate_with;
     gint message_timeout_sec;
+    gint stats_top;
     enum pcmk__acl_render_how acl_render_mode;
     gchar *cib_user;
     gchar *dest_node;
@@ -203,6 +204,9 @@ command_cb(const gchar *option_name, const gchar *optarg, gpointer data,
                                 NULL)) {
         options.cib_action = "md5-sum-versioned";
 
+    } else if (pcmk__str_eq(option_name, "--stats", pcmk__str_none)) {
+        options.cib_action = PCMK__CIB_REQUEST_STATS;
+
     } else {
         // Should be impossible
         return FALSE;
@@ -310,6 +314,14 @@ static GOptionEntry command_entries[] = {
     { "md5-sum-versioned", '6', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK,
       command_cb, "Calculate an on-the-wire versioned CIB digest", NULL },
 
+    { "stats", 0, G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, command_cb,
+      "Show the clients and operation types that used the most CIB manager "
+      "resources\n"
+      INDENT "(CPU time, bytes sent and received, and time spent checking ACLs, "
+      "creating diffs,\n"
+      INDENT "and sending notifications) during the last few minutes",
+      NULL },
+
     { NULL }
 };
 
@@ -340,6 +352,12 @@ static GOptionEntry addl_entries[] = {
       "Time (in seconds) to wait before declaring the operation failed",
       "value" },
 
+    { "top", 0, G_OPTION_FLAG_NONE, G_OPTION_ARG_INT, &options.stats_top,
+      "With --stats, show only this many of the most expensive clients and "
+      "operation types\n"
+      INDENT "(default: show all)",
+      "value" },
+
     { "user", 'U', G_OPTION_FLAG_NONE, G_OPTION_ARG_STRING, &options.cib_user,
       "Run the command with permissions of the named user (valid only for the "
       "root and " CRM_DAEMON_USER " accounts)", "value" },
@@ -597,6 +615,13 @@ main(int argc, char **argv)
         goto done;
     }
 
+    if (options.stats_top < 0) {
+        exit_code = CRM_EX_USAGE;
+        g_set_error(&error, PCMK__EXITC_ERROR, exit_code,
+                    "--top must be a non-negative integer");
+        goto done;
+    }
+
     if (cib_action_is_dangerous() && !options.force) {
         exit_code = CRM_EX_UNSAFE;
         g_set_error(&error, PCMK__EXITC_ERROR, exit_code,
@@ -769,6 +794,17 @@ main(int argc, char **argv)
          */
         cib__set_call_options(options.cmd_options, crm_system_name,
                               cib_score_update);
+
+    } else if (pcmk__str_eq(options.cib_action, PCMK__CIB_REQUEST_STATS,
+                            pcmk__str_none)) {
+        // Any input is replaced by the limit (if any)
+        pcmk__xml_free(input);
+        input = NULL;
+
+        if (options.stats_top > 0) {
+            input = pcmk__xe_create(NULL, PCMK__XE_CIB_STATS);
+            crm_xml_add_int(input, PCMK__XA_LIMIT, options.stats_top);
+        }
     }
 
     rc = do_init();
@@ -784,6 +820,17 @@ main(int argc, char **argv)
         goto done;
     }
 
+    if (pcmk__str_eq(options.cib_action, PCMK__CIB_REQUEST_STATS,
+                     pcmk__str_none)
+        && (the_cib->variant == cib_file)) {
+
+        exit_code = CRM_EX_UNIMPLEMENT_FEATURE;
+        g_set_error(&error, PCMK__EXITC_ERROR, exit_code,
+                    "Statistics are available only from a running CIB "
+                    "manager, not a CIB file");
+        goto done;
+    }
+
     rc = do_work(input, &output);
     if (!pcmk_is_set(options.cmd_options, cib_sync_call)
         && (the_cib->variant != cib_file)
@@ -1736,6 +1736,9 @@ handle_rsc_op(xmlNode *xml, void *userdata)
 
     id = pcmk__xe_history_key(rsc_op);
 
+    // The result may have been recorded in compact format
+    pcmk__expand_history_entry(rsc_op, NULL, NULL);
+
     magic = crm_element_value(rsc_op, PCMK__XA_TRANSITION_MAGIC);
     if (magic == NULL) {
         /* non-change */
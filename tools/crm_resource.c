@@ -987,6 +987,10 @@ initialize_scheduler_data(xmlNode **cib_xml_orig)
     }
 
     pcmk__set_scheduler_flags(scheduler, pcmk__sched_no_counts);
+    if (options.rsc_cmd == cmd_locate) {
+        // Only the located resource's history is needed (unpacked later)
+        pcmk__set_scheduler_flags(scheduler, pcmk__sched_no_history);
+    }
     scheduler->priv->out = out;
     rc = update_scheduler_input(out, scheduler, cib_conn, cib_xml_orig);
     if (rc != pcmk_rc_ok) {
@@ -1833,7 +1837,10 @@ main(int argc, char **argv)
             break;
 
         case cmd_locate: {
-            GList *nodes = cli_resource_search(rsc, options.rsc_id, scheduler);
+            GList *nodes = NULL;
+
+            pe__unpack_rsc_history(rsc);
+            nodes = cli_resource_search(rsc, options.rsc_id, scheduler);
             rc = out->message(out, "resource-search-list", nodes, options.rsc_id);
             g_list_free_full(nodes, free);
             break;
@@ -28,6 +28,7 @@
 #include <crm/common/output.h>
 #include <crm/common/util.h>
 #include <crm/common/iso8601.h>
+#include <crm/common/ipc_schedulerd.h>
 #include <crm/pengine/status.h>
 #include <crm/pengine/internal.h>
 #include <pacemaker-internal.h>
@@ -42,10 +43,12 @@ struct {
     pcmk_injections_t *injections;
     unsigned int flags;
     gchar *output_file;
+    int priority;
     long long repeat;
     gboolean store;
     gchar *test_dir;
     char *use_date;
+    gboolean use_daemon;
     char *xml_file;
 } options = {
     .flags = pcmk_sim_show_pending | pcmk_sim_sanitized,
@@ -165,6 +168,21 @@ save_graph_cb(const gchar *option_name, const gchar *optarg, gpointer data, GErr
     return TRUE;
 }
 
+static gboolean
+scheduler_priority_cb(const gchar *option_name, const gchar *optarg, gpointer data, GError **error) {
+    long long priority = 0LL;
+
+    if ((pcmk__scan_ll(optarg, &priority, 0LL) != pcmk_rc_ok)
+        || (priority < INT_MIN) || (priority > INT_MAX)) {
+        g_set_error(error, PCMK__EXITC_ERROR, CRM_EX_USAGE,
+                    "Invalid priority '%s' for --scheduler-priority", optarg);
+        return FALSE;
+    }
+    options.use_daemon = TRUE;
+    options.priority = (int) priority;
+    return TRUE;
+}
+
 static gboolean
 show_scores_cb(const gchar *option_name, const gchar *optarg, gpointer data, GError **error) {
     options.flags |= pcmk_sim_process | pcmk_sim_show_scores;
@@ -324,6 +342,11 @@ static GOptionEntry artifact_entries[] = {
     { "all-actions", 'a', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, all_actions_cb,
       "Display all possible actions in DOT graph (even if not part of transition)",
       NULL },
+    { "scheduler-priority", 0, 0, G_OPTION_ARG_CALLBACK, scheduler_priority_cb,
+      "With --save-graph, have the local scheduler daemon calculate the\n"
+      INDENT "transition graph instead, using this request priority (for testing;\n"
+      INDENT "a priority of " G_STRINGIFY(PCMK__SCHEDULER_PRIORITY_DC) " or more is treated as a DC request)",
+      "N" },
 
     { NULL }
 };
@@ -409,6 +432,137 @@ setup_input(pcmk__output_t *out, const char *input, const char *output,
     return rc;
 }
 
+// Result of a calculation requested from the scheduler daemon
+struct daemon_calc_s {
+    pcmk__output_t *out;
+    const char *graph_file;
+    int rc;                 // EAGAIN until a reply is received
+};
+
+static void
+scheduler_event_cb(pcmk_ipc_api_t *api, enum pcmk_ipc_event event_type,
+                   crm_exit_t status, void *event_data, void *user_data)
+{
+    pcmk_schedulerd_api_reply_t *reply = event_data;
+    struct daemon_calc_s *calc = user_data;
+
+    switch (event_type) {
+        case pcmk_ipc_event_disconnect:
+            if (calc->rc == EAGAIN) {
+                calc->out->err(calc->out, "Lost connection to %s",
+                               pcmk_ipc_name(api, true));
+                calc->rc = ENOTCONN;
+            }
+            return;
+
+        case pcmk_ipc_event_reply:
+            break;
+
+        default:
+            return;
+    }
+
+    if ((status != CRM_EX_OK) && (reply->data.graph.reference != NULL)) {
+        calc->out->err(calc->out, "Calculation %s failed: %s",
+                       reply->data.graph.reference, crm_exit_str(status));
+        calc->rc = pcmk_rc_error;
+
+    } else if (status != CRM_EX_OK) {
+        calc->out->err(calc->out, "Bad reply from %s: %s",
+                       pcmk_ipc_name(api, true), crm_exit_str(status));
+        calc->rc = pcmk_rc_error;
+
+    } else if (reply->reply_type == pcmk_schedulerd_reply_cancelled) {
+        calc->out->err(calc->out, "Calculation %s was cancelled",
+                       reply->data.graph.reference);
+        calc->rc = ECANCELED;
+
+    } else if (reply->data.graph.tgraph == NULL) {
+        calc->out->err(calc->out, "Calculation %s failed",
+                       reply->data.graph.reference);
+        calc->rc = ENODATA;
+
+    } else {
+        calc->rc = pcmk__xml_write_file(reply->data.graph.tgraph,
+                                        calc->graph_file, false);
+    }
+}
+
+/*!
+ * \internal
+ * \brief Have the local scheduler daemon calculate a transition graph
+ *
+ * \param[in,out] out         Output object
+ * \param[in]     input       File containing CIB to calculate graph for
+ * \param[in]     priority    Priority of calculation request
+ * \param[in]     graph_file  File to save transition graph to
+ *
+ * \return Standard Pacemaker return code
+ */
+static int
+calculate_with_daemon(pcmk__output_t *out, const char *input, int priority,
+                      const char *graph_file)
+{
+    pcmk_ipc_api_t *api = NULL;
+    xmlNode *cib = pcmk__xml_read(input);
+    struct daemon_calc_s calc = {
+        .out = out,
+        .graph_file = graph_file,
+        .rc = EAGAIN,
+    };
+    int rc = pcmk_rc_ok;
+
+    if (cib == NULL) {
+        out->err(out, "Could not read input from %s", input);
+        return pcmk_rc_bad_input;
+    }
+
+    rc = pcmk_new_ipc_api(&api, pcmk_ipc_schedulerd);
+    if (rc != pcmk_rc_ok) {
+        out->err(out, "Could not create scheduler IPC object: %s",
+                 pcmk_rc_str(rc));
+        goto done;
+    }
+    pcmk_register_ipc_callback(api, scheduler_event_cb, &calc);
+
+    rc = pcmk__connect_ipc(api, pcmk_ipc_dispatch_poll, 5);
+    if (rc != pcmk_rc_ok) {
+        out->err(out, "Could not connect to %s: %s",
+                 pcmk_ipc_name(api, true), pcmk_rc_str(rc));
+        goto done;
+    }
+
+    if (priority >= PCMK__SCHEDULER_PRIORITY_DC) {
+        rc = pcmk_schedulerd_api_graph(api, cib, NULL);
+    } else {
+        rc = pcmk__schedulerd_api_graph(api, cib, priority, NULL);
+    }
+    if (rc != pcmk_rc_ok) {
+        out->err(out, "Could not send request to %s: %s",
+                 pcmk_ipc_name(api, true), pcmk_rc_str(rc));
+        goto done;
+    }
+
+    while (calc.rc == EAGAIN) {
+        rc = pcmk_poll_ipc(api, -1);
+        if (rc != pcmk_rc_ok) {
+            out->err(out, "Could not poll %s: %s",
+                     pcmk_ipc_name(api, true), pcmk_rc_str(rc));
+            goto done;
+        }
+        pcmk_dispatch_ipc(api);
+    }
+    rc = calc.rc;
+
+done:
+    if (api != NULL) {
+        pcmk_disconnect_ipc(api);
+        pcmk_free_ipc_api(api);
+    }
+    pcmk__xml_free(cib);
+    return rc;
+}
+
 static GOptionContext *
 build_arg_context(pcmk__common_args_t *args, GOptionGroup **group) {
     GOptionContext *context = NULL;
@@ -540,6 +694,18 @@ main(int argc, char **argv)
         goto done;
     }
 
+    if (options.use_daemon) {
+        if (options.graph_file == NULL) {
+            rc = EINVAL;
+            g_set_error(&error, PCMK__EXITC_ERROR, CRM_EX_USAGE,
+                        "--scheduler-priority requires --save-graph");
+            goto done;
+        }
+        rc = calculate_with_daemon(out, getenv("CIB_file"), options.priority,
+                                   options.graph_file);
+        goto done;
+    }
+
     rc = pcmk__simulate(scheduler, out, options.injections, options.flags,
                         section_opts, options.use_date, options.input_file,
                         options.graph_file, options.dot_file);
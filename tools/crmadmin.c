@@ -29,6 +29,8 @@ static enum {
     cmd_whois_dc,
     cmd_list_nodes,
     cmd_pacemakerd_health,
+    cmd_log_control,
+    cmd_metrics,
 } command = cmd_none;
 
 struct {
@@ -37,6 +39,11 @@ struct {
     char *optarg;
     char *ipc_name;
     gboolean bash_export;
+    gchar *log_level;
+    gchar **trace;
+    gchar **untrace;
+    gboolean untrace_all;
+    guint ttl_ms;
 } options = {
     .timeout = 30000, // Default to 30 seconds
     .optarg = NULL,
@@ -71,6 +78,20 @@ static GOptionEntry command_options[] = {
       "\n                             Types: all (default), cluster, guest, remote",
       "TYPE"
     },
+    { "log-control", 0, 0, G_OPTION_ARG_CALLBACK, command_cb,
+      "Change or display the log settings of a running daemon on the local"
+      "\n                             node, without restarting it. DAEMON is a"
+      "\n                             daemon name such as pacemaker-fenced, or"
+      "\n                             \"all\". Without --log-level, --trace, or"
+      "\n                             --untrace[-all], display current settings.",
+      "DAEMON"
+    },
+    { "metrics", 0, 0, G_OPTION_ARG_CALLBACK, command_cb,
+      "Display the performance metrics of a running daemon on the local"
+      "\n                             node. DAEMON is a daemon name such as"
+      "\n                             pacemaker-based, or \"all\".",
+      "DAEMON"
+    },
     { "health", 'H', G_OPTION_FLAG_HIDDEN, G_OPTION_ARG_NONE, &options.health,
       NULL,
       NULL
@@ -94,6 +115,37 @@ static GOptionEntry additional_options[] = {
       "Name to use for ipc instead of 'crmadmin' (with -P/--pacemakerd).",
       "NAME"
     },
+    { "log-level", 0, 0, G_OPTION_ARG_STRING, &options.log_level,
+      "Set log level (emerg, alert, crit, error, warning,"
+      "\n                             notice, info, debug, or trace) of log"
+      "\n                             destinations other than syslog"
+      "\n                             (with --log-control)",
+      "LEVEL"
+    },
+    { "trace", 0, 0, G_OPTION_ARG_STRING_ARRAY, &options.trace,
+      "Log trace messages matching TYPE:NAME (with --log-control)."
+      "\n                             TYPE is function, file, format (text"
+      "\n                             contained in the message), or tag. This"
+      "\n                             option may be specified multiple times.",
+      "TYPE:NAME"
+    },
+    { "untrace", 0, 0, G_OPTION_ARG_STRING_ARRAY, &options.untrace,
+      "Stop logging trace messages matching TYPE:NAME"
+      "\n                             (with --log-control). This option may be"
+      "\n                             specified multiple times.",
+      "TYPE:NAME"
+    },
+    { "untrace-all", 0, 0, G_OPTION_ARG_NONE, &options.untrace_all,
+      "Remove all trace filters added with --trace"
+      "\n                             (with --log-control)",
+      NULL
+    },
+    { "ttl", 0, 0, G_OPTION_ARG_CALLBACK, command_cb,
+      "Automatically undo --log-level and --trace after"
+      "\n                             this long (with --log-control; default is"
+      "\n                             to keep them until the daemon exits)",
+      "DURATION"
+    },
 
     { NULL }
 };
@@ -118,6 +170,18 @@ command_cb(const gchar *option_name, const gchar *optarg, gpointer data, GError
         command = cmd_list_nodes;
     }
 
+    if (!strcmp(option_name, "--log-control")) {
+        command = cmd_log_control;
+    }
+
+    if (!strcmp(option_name, "--metrics")) {
+        command = cmd_metrics;
+    }
+
+    if (!strcmp(option_name, "--ttl")) {
+        return pcmk_parse_interval_spec(optarg, &options.ttl_ms) == pcmk_rc_ok;
+    }
+
     if (!strcmp(option_name, "--timeout") || !strcmp(option_name, "-t")) {
         return pcmk_parse_interval_spec(optarg, &options.timeout) == pcmk_rc_ok;
     }
@@ -245,6 +309,31 @@ main(int argc, char **argv)
             rc = pcmk__designated_controller(out,
                                              (unsigned int) options.timeout);
             break;
+        case cmd_log_control:
+            {
+                GList *trace = NULL;
+                GList *untrace = NULL;
+
+                for (gchar **s = options.trace; (s != NULL) && (*s != NULL);
+                     s++) {
+                    trace = g_list_append(trace, *s);
+                }
+                for (gchar **s = options.untrace; (s != NULL) && (*s != NULL);
+                     s++) {
+                    untrace = g_list_append(untrace, *s);
+                }
+                rc = pcmk__log_control(out, options.optarg, options.log_level,
+                                       trace, untrace, options.untrace_all,
+                                       pcmk__timeout_ms2s(options.ttl_ms),
+                                       (unsigned int) options.timeout);
+                g_list_free(trace);
+                g_list_free(untrace);
+            }
+            break;
+        case cmd_metrics:
+            rc = pcmk__daemon_metrics(out, options.optarg,
+                                      (unsigned int) options.timeout);
+            break;
         case cmd_none:
             rc = pcmk_rc_error;
             break;
@@ -256,6 +345,9 @@ main(int argc, char **argv)
     }
 
 done:
+    g_free(options.log_level);
+    g_strfreev(options.trace);
+    g_strfreev(options.untrace);
     g_strfreev(processed_args);
     pcmk__free_arg_context(context);
 